@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "batchTuner.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+
+// same prefix as tensorNet.h, which isn't included to keep this file free of TensorRT
+#ifndef LOG_TRT
+#define LOG_TRT "[TRT]   "
+#endif
+
+
+// Candidates
+std::vector<uint32_t> batchTuner::Candidates( uint32_t maxBatchSize )
+{
+	std::vector<uint32_t> sizes;
+
+	for( uint32_t n=1; n < maxBatchSize; n *= 2 )
+		sizes.push_back(n);
+
+	if( maxBatchSize > 0 )
+		sizes.push_back(maxBatchSize);
+
+	return sizes;
+}
+
+
+// Select
+uint32_t batchTuner::Select( const std::vector<batchProfile>& profiles, float latencyTarget )
+{
+	const batchProfile* best    = NULL;
+	const batchProfile* fastest = NULL;
+
+	for( size_t n=0; n < profiles.size(); n++ )
+	{
+		const batchProfile* p = &profiles[n];
+
+		if( !fastest || p->latencyP99 < fastest->latencyP99 )
+			fastest = p;
+
+		if( p->latencyP99 > latencyTarget )
+			continue;
+
+		if( !best || p->throughput > best->throughput )
+			best = p;
+	}
+
+	if( best != NULL )
+		return best->batchSize;
+
+	if( fastest != NULL )
+	{
+		printf(LOG_TRT "no batch size meets the latency target of %.2f ms (lowest p99 is %.2f ms at batch size %u)\n",
+			  latencyTarget, fastest->latencyP99, fastest->batchSize);
+
+		return fastest->batchSize;
+	}
+
+	return 0;
+}
+
+
+// FlushTimeout
+float batchTuner::FlushTimeout( const std::vector<batchProfile>& profiles, uint32_t batchSize, float latencyTarget )
+{
+	for( size_t n=0; n < profiles.size(); n++ )
+	{
+		if( profiles[n].batchSize != batchSize )
+			continue;
+
+		const float timeout = latencyTarget - profiles[n].latencyP99;
+		return (timeout > 0.0f) ? timeout : 0.0f;
+	}
+
+	return 0.0f;
+}
+
+
+// Save
+bool batchTuner::Save( const char* path, const char* key, const std::vector<batchProfile>& profiles )
+{
+	if( !path || !key )
+		return false;
+
+	FILE* file = fopen(path, "w");
+
+	if( !file )
+	{
+		printf(LOG_TRT "failed to open %s for writing\n", path);
+		return false;
+	}
+
+	fprintf(file, "%s\n", key);
+
+	for( size_t n=0; n < profiles.size(); n++ )
+		fprintf(file, "%u %f %f %f\n", profiles[n].batchSize, profiles[n].latencyMean, profiles[n].latencyP99, profiles[n].throughput);
+
+	fclose(file);
+	return true;
+}
+
+
+// Load
+bool batchTuner::Load( const char* path, const char* key, std::vector<batchProfile>& profiles )
+{
+	if( !path || !key )
+		return false;
+
+	FILE* file = fopen(path, "r");
+
+	if( !file )
+		return false;
+
+	char fileKey[512];
+
+	if( fscanf(file, "%511s", fileKey) != 1 || strcmp(fileKey, key) != 0 )
+	{
+		fclose(file);
+		return false;
+	}
+
+	std::vector<batchProfile> loaded;
+	batchProfile p;
+
+	while( fscanf(file, "%u %f %f %f", &p.batchSize, &p.latencyMean, &p.latencyP99, &p.throughput) == 4 )
+		loaded.push_back(p);
+
+	fclose(file);
+
+	if( loaded.size() == 0 )
+		return false;
+
+	profiles = loaded;
+	return true;
+}
+
+
+
+// ParseEngineSet
+bool batchTuner::ParseEngineSet( const char* str, std::vector<uint32_t>& batchSizes )
+{
+	if( !str )
+		return false;
+
+	const char* list = str;
+	std::vector<uint32_t> sizes;
+
+	while( *str != '\0' )
+	{
+		char* end = NULL;
+		const long size = strtol(str, &end, 10);
+
+		// a trailing comma is rejected like an empty entry in the middle of the list
+		if( end == str || size <= 0 || size > UINT32_MAX || (*end != ',' && *end != '\0') || (*end == ',' && end[1] == '\0') )
+		{
+			printf(LOG_TRT "invalid engine set '%s' (expected a list of batch sizes, i.e. 1,2,4,8)\n", list);
+			return false;
+		}
+
+		sizes.push_back(size);
+		str = (*end == ',') ? end + 1 : end;
+	}
+
+	if( sizes.size() == 0 )
+		return false;
+
+	batchSizes = sizes;
+	return true;
+}
+
+
+// EngineSet
+std::vector<uint32_t> batchTuner::EngineSet( const std::vector<uint32_t>& batchSizes, uint32_t maxBatchSize )
+{
+	std::vector<uint32_t> sizes;
+
+	for( size_t n=0; n < batchSizes.size(); n++ )
+	{
+		if( batchSizes[n] > 0 && batchSizes[n] < maxBatchSize )
+			sizes.push_back(batchSizes[n]);
+	}
+
+	std::sort(sizes.begin(), sizes.end());
+	sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+
+	if( maxBatchSize > 0 )
+		sizes.push_back(maxBatchSize);
+
+	return sizes;
+}
+
+
+// SelectEngine
+int batchTuner::SelectEngine( const std::vector<uint32_t>& engineSet, uint32_t batchSize )
+{
+	for( size_t n=0; n < engineSet.size(); n++ )
+	{
+		if( engineSet[n] >= batchSize )
+			return n;
+	}
+
+	return -1;
+}
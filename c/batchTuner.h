@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __BATCH_TUNER_H__
+#define __BATCH_TUNER_H__
+
+#include <stdint.h>
+#include <vector>
+
+
+/**
+ * Latency and throughput measured for one batch size.
+ * @see tensorNet::TuneBatchSize()
+ * @ingroup tensorNet
+ */
+struct batchProfile
+{
+	uint32_t batchSize;		/**< number of images per batch */
+	float    latencyMean;	/**< mean latency of a batch (in milliseconds) */
+	float    latencyP99;		/**< 99th percentile latency of a batch (in milliseconds) */
+	float    throughput;		/**< images per second */
+};
+
+
+/**
+ * Selection and persistence of the batch size that maximizes throughput
+ * while keeping the p99 latency of a batch under a target.
+ *
+ * The measurements themselves are made by tensorNet::TuneBatchSize(),
+ * and the selected batch size and flush timeout are used by the
+ * request batcher of inference-daemon.  It also selects the engine that
+ * runs a batch when a network loads an engine set (@see tensorNet::SetEngineSet()).
+ * This class doesn't depend on CUDA or TensorRT.
+ * @ingroup tensorNet
+ */
+class batchTuner
+{
+public:
+	/**
+	 * The batch sizes to measure -- powers of two up to the max batch size, and the max itself.
+	 */
+	static std::vector<uint32_t> Candidates( uint32_t maxBatchSize );
+
+	/**
+	 * Select the batch size with the highest throughput whose p99 latency is under the target.
+	 * If none of them meet the target, the one with the lowest p99 latency is returned.
+	 * @returns the batch size, or 0 if there are no profiles.
+	 */
+	static uint32_t Select( const std::vector<batchProfile>& profiles, float latencyTarget );
+
+	/**
+	 * Determine how long a partially-filled batch can wait for more requests before it
+	 * has to be run, which is the latency target minus the p99 latency of the batch size.
+	 * @returns the timeout in milliseconds (zero if there is no time left over).
+	 */
+	static float FlushTimeout( const std::vector<batchProfile>& profiles, uint32_t batchSize, float latencyTarget );
+
+	/**
+	 * Save the profiles to a file.
+	 * @param key identifies the TensorRT version and GPU that the profiles were measured on.
+	 */
+	static bool Save( const char* path, const char* key, const std::vector<batchProfile>& profiles );
+
+	/**
+	 * Load the profiles from a file, if it exists and was saved with the same key.
+	 */
+	static bool Load( const char* path, const char* key, std::vector<batchProfile>& profiles );
+
+	/**
+	 * Parse a comma-separated list of batch sizes (i.e. "1,2,4,8").
+	 * @returns false if the list is empty, has an empty entry (i.e. "1,,2" or "1,2,"),
+	 *          or contains a size that isn't a positive 32-bit integer.
+	 */
+	static bool ParseEngineSet( const char* str, std::vector<uint32_t>& batchSizes );
+
+	/**
+	 * Determine the batch sizes of the engines that a network loads -- the requested sizes
+	 * that are below the max batch size, sorted and without duplicates, followed by the max
+	 * batch size itself (the engine that the bindings are allocated for).
+	 */
+	static std::vector<uint32_t> EngineSet( const std::vector<uint32_t>& batchSizes, uint32_t maxBatchSize );
+
+	/**
+	 * Select the smallest engine of a set from EngineSet() that fits the batch.
+	 * @returns the index of the engine in the set, or -1 if the batch is larger than all of them.
+	 */
+	static int SelectEngine( const std::vector<uint32_t>& engineSet, uint32_t batchSize );
+};
+
+#endif
+
@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "dagExecutor.h"
+#include "tensorNet.h"
+#include "cudaUtility.h"
+#include "threadConfig.h"
+
+
+// constructor
+dagExecutor::dagExecutor( uint32_t maxStreams )
+{
+	mMaxStreams  = (maxStreams > 0) ? maxStreams : 1;
+	mFinalized   = false;
+	mArena       = NULL;
+	mFrame       = 0;
+	mStreamsDone = 0;
+	mFailed      = false;
+	mStop        = false;
+
+	pthread_mutex_init(&mMutex, NULL);
+	pthread_cond_init(&mCond, NULL);
+}
+
+
+// destructor
+dagExecutor::~dagExecutor()
+{
+	pthread_mutex_lock(&mMutex);
+	mStop = true;
+	pthread_cond_broadcast(&mCond);
+	pthread_mutex_unlock(&mMutex);
+
+	for( size_t n=0; n < mThreads.size(); n++ )
+		pthread_join(mThreads[n].handle, NULL);
+
+	for( size_t n=0; n < mEvents.size(); n++ )
+	{
+		if( mEvents[n] != NULL )
+			CUDA(cudaEventDestroy(mEvents[n]));
+	}
+
+	for( size_t n=0; n < mStreams.size(); n++ )
+		CUDA(cudaStreamDestroy(mStreams[n]));
+
+	if( mArena != NULL )
+		CUDA(cudaFree(mArena));
+
+	pthread_cond_destroy(&mCond);
+	pthread_mutex_destroy(&mMutex);
+}
+
+
+// Create
+dagExecutor* dagExecutor::Create( uint32_t maxStreams )
+{
+	return new dagExecutor(maxStreams);
+}
+
+
+// AddBuffer
+int dagExecutor::AddBuffer( const char* name, size_t size, bool external )
+{
+	if( mFinalized )
+	{
+		printf(LOG_DAG "can't add buffer '%s' after the graph was finalized\n", name);
+		return -1;
+	}
+
+	mBuffers.push_back(NULL);
+	return mPlanner.AddBuffer(name, size, external);
+}
+
+
+// AddKernel
+int dagExecutor::AddKernel( const char* name, dagFunction function, void* user, const std::vector<int>& inputs, const std::vector<int>& outputs )
+{
+	return AddNetwork(name, NULL, function, user, inputs, outputs);
+}
+
+
+// AddNetwork
+int dagExecutor::AddNetwork( const char* name, tensorNet* network, dagFunction function, void* user, const std::vector<int>& inputs, const std::vector<int>& outputs )
+{
+	if( mFinalized )
+	{
+		printf(LOG_DAG "can't add node '%s' after the graph was finalized\n", name);
+		return -1;
+	}
+
+	if( !function )
+	{
+		printf(LOG_DAG "node '%s' has a NULL function\n", name);
+		return -1;
+	}
+
+	const int index = mPlanner.AddNode(name, inputs, outputs);
+
+	if( index < 0 )
+		return -1;
+
+	node n;
+
+	n.function = function;
+	n.user     = user;
+	n.network  = network;
+
+	mNodes.push_back(n);
+	return index;
+}
+
+
+// Finalize
+bool dagExecutor::Finalize()
+{
+	if( mFinalized )
+		return true;
+
+	if( !mPlanner.Plan(mMaxStreams) )
+		return false;
+
+	const uint32_t numNodes   = mPlanner.GetNumNodes();
+	const uint32_t numStreams = mPlanner.GetNumStreams();
+
+	// allocate the intermediate buffers
+	if( mPlanner.GetArenaSize() > 0 && CUDA_FAILED(cudaMalloc((void**)&mArena, mPlanner.GetArenaSize())) )
+		return false;
+
+	for( uint32_t n=0; n < mPlanner.GetNumBuffers(); n++ )
+	{
+		if( !mPlanner.IsBufferExternal(n) )
+			mBuffers[n] = mArena + mPlanner.GetBufferOffset(n);
+	}
+
+	// create the streams, and events for the nodes that other streams wait on
+	mStreams.resize(numStreams, NULL);
+	mStreamNodes.resize(numStreams);
+
+	for( uint32_t s=0; s < numStreams; s++ )
+	{
+		if( CUDA_FAILED(cudaStreamCreateWithFlags(&mStreams[s], cudaStreamNonBlocking)) )
+			return false;
+	}
+
+	mEvents.resize(numNodes, NULL);
+	mNodeFrame.resize(numNodes, 0);
+
+	for( uint32_t n=0; n < numNodes; n++ )
+	{
+		if( mPlanner.IsNodeWaitedOn(n) && CUDA_FAILED(cudaEventCreateWithFlags(&mEvents[n], cudaEventDisableTiming)) )
+			return false;
+	}
+
+	const std::vector<int>& order = mPlanner.GetOrder();
+
+	for( size_t i=0; i < order.size(); i++ )
+	{
+		const int n = order[i];
+		const uint32_t stream = mPlanner.GetNodeStream(n);
+
+		mStreamNodes[stream].push_back(n);
+
+		if( mNodes[n].network != NULL )
+			mNodes[n].network->SetStream(mStreams[stream]);
+	}
+
+	// start a thread to drive each stream
+	mThreads.resize(numStreams);
+
+	for( uint32_t s=0; s < numStreams; s++ )
+	{
+		mThreads[s].executor = this;
+		mThreads[s].stream   = s;
+
+		if( pthread_create(&mThreads[s].handle, NULL, threadEntry, &mThreads[s]) != 0 )
+		{
+			printf(LOG_DAG "failed to create thread for stream %u\n", s);
+			mThreads.resize(s);
+			return false;
+		}
+	}
+
+	mFinalized = true;
+	mPlanner.Print();
+
+	return true;
+}
+
+
+// SetBuffer
+bool dagExecutor::SetBuffer( int buffer, void* ptr )
+{
+	if( buffer < 0 || buffer >= (int)mBuffers.size() || !mPlanner.IsBufferExternal(buffer) )
+	{
+		printf(LOG_DAG "SetBuffer() -- buffer %i isn't an external buffer\n", buffer);
+		return false;
+	}
+
+	pthread_mutex_lock(&mMutex);
+	mBuffers[buffer] = ptr;
+	pthread_mutex_unlock(&mMutex);
+
+	return true;
+}
+
+
+// GetBuffer
+void* dagExecutor::GetBuffer( int buffer ) const
+{
+	if( buffer < 0 || buffer >= (int)mBuffers.size() )
+		return NULL;
+
+	return mBuffers[buffer];
+}
+
+
+// Execute
+bool dagExecutor::Execute()
+{
+	if( !mFinalized )
+	{
+		printf(LOG_DAG "Execute() -- the graph hasn't been finalized\n");
+		return false;
+	}
+
+	pthread_mutex_lock(&mMutex);
+
+	for( size_t n=0; n < mBuffers.size(); n++ )
+	{
+		if( mBuffers[n] == NULL && mPlanner.GetBufferSize(n) > 0 )
+		{
+			printf(LOG_DAG "Execute() -- external buffer '%s' wasn't set\n", mPlanner.GetBufferName(n));
+			pthread_mutex_unlock(&mMutex);
+			return false;
+		}
+	}
+
+	mFrame++;
+	mFailed = false;
+	mStreamsDone = 0;
+
+	pthread_cond_broadcast(&mCond);
+
+	while( mStreamsDone < mStreams.size() )
+		pthread_cond_wait(&mCond, &mMutex);
+
+	const bool result = !mFailed;
+
+	pthread_mutex_unlock(&mMutex);
+	return result;
+}
+
+
+// threadEntry
+void* dagExecutor::threadEntry( void* param )
+{
+	thread* t = (thread*)param;
+
+	char name[16];
+	snprintf(name, sizeof(name), "dag-%u", t->stream);
+	threadConfig::ApplyStage("dag", name);
+
+	t->executor->runStream(t->stream);
+	return NULL;
+}
+
+
+// runStream
+void dagExecutor::runStream( uint32_t s )
+{
+	const cudaStream_t stream = mStreams[s];
+	const std::vector<int>& nodes = mStreamNodes[s];
+
+	std::vector<void*> inputs;
+	std::vector<void*> outputs;
+
+	uint64_t frame = 0;
+
+	pthread_mutex_lock(&mMutex);
+
+	while( true )
+	{
+		while( mFrame == frame && !mStop )
+			pthread_cond_wait(&mCond, &mMutex);
+
+		if( mStop )
+			break;
+
+		frame = mFrame;
+
+		for( size_t i=0; i < nodes.size(); i++ )
+		{
+			const int n = nodes[i];
+			const std::vector<int>& waits = mPlanner.GetNodeWaits(n);
+
+			// the other stream's event has to be recorded before it can be waited on
+			for( size_t w=0; w < waits.size(); w++ )
+			{
+				while( mNodeFrame[waits[w]] != frame )
+					pthread_cond_wait(&mCond, &mMutex);
+
+				CUDA(cudaStreamWaitEvent(stream, mEvents[waits[w]], 0));
+			}
+
+			const std::vector<int>& in  = mPlanner.GetNodeInputs(n);
+			const std::vector<int>& out = mPlanner.GetNodeOutputs(n);
+
+			inputs.resize(in.size());
+			outputs.resize(out.size());
+
+			for( size_t b=0; b < in.size(); b++ )
+				inputs[b] = mBuffers[in[b]];
+
+			for( size_t b=0; b < out.size(); b++ )
+				outputs[b] = mBuffers[out[b]];
+
+			pthread_mutex_unlock(&mMutex);
+
+			const bool result = mNodes[n].function(inputs.data(), outputs.data(), stream, mNodes[n].user);
+
+			if( mEvents[n] != NULL )
+				CUDA(cudaEventRecord(mEvents[n], stream));
+
+			pthread_mutex_lock(&mMutex);
+
+			if( !result )
+			{
+				printf(LOG_DAG "node '%s' failed\n", mPlanner.GetNodeName(n));
+				mFailed = true;
+			}
+
+			mNodeFrame[n] = frame;
+			pthread_cond_broadcast(&mCond);
+		}
+
+		pthread_mutex_unlock(&mMutex);
+		CUDA(cudaStreamSynchronize(stream));
+		pthread_mutex_lock(&mMutex);
+
+		mStreamsDone++;
+		pthread_cond_broadcast(&mCond);
+	}
+
+	pthread_mutex_unlock(&mMutex);
+}
+
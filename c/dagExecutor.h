@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __DAG_EXECUTOR_H__
+#define __DAG_EXECUTOR_H__
+
+
+#include "dagPlanner.h"
+
+#include <cuda_runtime.h>
+#include <pthread.h>
+
+
+class tensorNet;
+
+
+/**
+ * Function that queues the work of a node on a stream.
+ * @param inputs device pointers of the buffers that the node reads, in the order they were specified
+ * @param outputs device pointers of the buffers that the node writes, in the order they were specified
+ * @param stream the stream that the node was assigned to
+ * @param user the parameter that was passed when the node was added
+ * @returns false on error.
+ * @ingroup dag
+ */
+typedef bool (*dagFunction)( void** inputs, void** outputs, cudaStream_t stream, void* user );
+
+
+/**
+ * Runs a graph of network invocations and custom kernels each frame, with
+ * independent branches of the graph on separate streams.
+ *
+ * The graph is scheduled by dagPlanner.  Each stream is driven by its own
+ * thread, because the network processing functions (i.e. detectNet::Detect())
+ * wait for their stream to finish before returning -- so a network on one
+ * branch doesn't hold up the work queued on the other branches.  Dependencies
+ * that cross streams are waited for on the GPU with cudaStreamWaitEvent().
+ *
+ * The intermediate buffers are allocated from a single arena, where buffers
+ * whose lifetimes don't overlap share memory.  Their contents are only valid
+ * while the graph is running, so buffers that are read after Execute() should
+ * be added as external buffers and bound with SetBuffer().
+ *
+ * @ingroup dag
+ */
+class dagExecutor
+{
+public:
+	/**
+	 * Create an empty graph.
+	 * @param maxStreams maximum number of streams (and threads) to run the graph with
+	 */
+	static dagExecutor* Create( uint32_t maxStreams=4 );
+
+	/**
+	 * Destroy the executor, its streams and its arena.
+	 */
+	~dagExecutor();
+
+	/**
+	 * Add a buffer.
+	 * @param size size of the buffer in bytes
+	 * @param external if true, the buffer is provided with SetBuffer() instead of allocated from the arena
+	 * @returns the buffer's index, or -1 on error
+	 */
+	int AddBuffer( const char* name, size_t size, bool external=false );
+
+	/**
+	 * Add a node that runs custom kernels.
+	 * @returns the node's index, or -1 on error
+	 */
+	int AddKernel( const char* name, dagFunction function, void* user, const std::vector<int>& inputs, const std::vector<int>& outputs );
+
+	/**
+	 * Add a node that processes a network.  The network's stream is set to the
+	 * stream that the node is assigned to, so a network should only be used by
+	 * one node in the graph.
+	 * @returns the node's index, or -1 on error
+	 */
+	int AddNetwork( const char* name, tensorNet* network, dagFunction function, void* user, const std::vector<int>& inputs, const std::vector<int>& outputs );
+
+	/**
+	 * Plan the graph, allocate the arena and start the stream threads.
+	 * No more buffers or nodes can be added afterwards.
+	 */
+	bool Finalize();
+
+	/**
+	 * Bind the device memory of an external buffer (this may be changed between frames).
+	 */
+	bool SetBuffer( int buffer, void* ptr );
+
+	/**
+	 * Retrieve the device memory of a buffer (valid after Finalize()).
+	 */
+	void* GetBuffer( int buffer ) const;
+
+	/**
+	 * Run the graph once, returning after all of the streams have finished.
+	 * @returns false if any of the nodes failed.
+	 */
+	bool Execute();
+
+	/**
+	 * Retrieve the plan (i.e. to print it, or to inspect the stream assignment).
+	 */
+	inline const dagPlanner& GetPlan() const		{ return mPlanner; }
+
+protected:
+	dagExecutor( uint32_t maxStreams );
+
+	struct node
+	{
+		dagFunction function;
+		void*       user;
+		tensorNet*  network;
+	};
+
+	struct thread
+	{
+		dagExecutor* executor;
+		uint32_t     stream;
+		pthread_t    handle;
+	};
+
+	static void* threadEntry( void* param );
+	void runStream( uint32_t stream );
+
+	dagPlanner mPlanner;
+	uint32_t   mMaxStreams;
+	bool       mFinalized;
+
+	std::vector<node>  mNodes;
+	std::vector<void*> mBuffers;
+
+	uint8_t* mArena;
+
+	std::vector<cudaStream_t> mStreams;
+	std::vector<cudaEvent_t>  mEvents;			// per node, if another stream waits on it
+	std::vector< std::vector<int> > mStreamNodes;	// nodes of each stream, in order
+	std::vector<thread>       mThreads;
+
+	pthread_mutex_t mMutex;
+	pthread_cond_t  mCond;
+
+	uint64_t mFrame;
+	std::vector<uint64_t> mNodeFrame;			// last frame that each node completed
+	uint32_t mStreamsDone;
+	bool     mFailed;
+	bool     mStop;
+};
+
+
+#endif
@@ -0,0 +1,434 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "dagPlanner.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+
+// constructor
+dagPlanner::dagPlanner()
+{
+	mNumStreams = 0;
+	mArenaSize  = 0;
+	mAlignment  = 1;
+}
+
+
+// AddBuffer
+int dagPlanner::AddBuffer( const char* name, size_t size, bool external )
+{
+	buffer b;
+
+	b.name     = (name != NULL) ? name : "";
+	b.size     = size;
+	b.offset   = 0;
+	b.external = external;
+	b.producer = -1;
+
+	mBuffers.push_back(b);
+	return mBuffers.size() - 1;
+}
+
+
+// AddNode
+int dagPlanner::AddNode( const char* name, const std::vector<int>& inputs, const std::vector<int>& outputs )
+{
+	const int index = mNodes.size();
+	const int numBuffers = mBuffers.size();
+
+	for( size_t n=0; n < inputs.size(); n++ )
+	{
+		if( inputs[n] < 0 || inputs[n] >= numBuffers )
+		{
+			printf(LOG_DAG "node '%s' has an invalid input buffer (%i)\n", name, inputs[n]);
+			return -1;
+		}
+	}
+
+	for( size_t n=0; n < outputs.size(); n++ )
+	{
+		if( outputs[n] < 0 || outputs[n] >= numBuffers )
+		{
+			printf(LOG_DAG "node '%s' has an invalid output buffer (%i)\n", name, outputs[n]);
+			return -1;
+		}
+
+		if( mBuffers[outputs[n]].producer >= 0 )
+		{
+			printf(LOG_DAG "node '%s' writes buffer '%s', which is already written by node '%s'\n", name, 
+				  mBuffers[outputs[n]].name.c_str(), mNodes[mBuffers[outputs[n]].producer].name.c_str());
+			return -1;
+		}
+	}
+
+	node nd;
+
+	nd.name     = (name != NULL) ? name : "";
+	nd.inputs   = inputs;
+	nd.outputs  = outputs;
+	nd.stream   = 0;
+	nd.waitedOn = false;
+
+	for( size_t n=0; n < inputs.size(); n++ )
+		mBuffers[inputs[n]].consumers.push_back(index);
+
+	for( size_t n=0; n < outputs.size(); n++ )
+		mBuffers[outputs[n]].producer = index;
+
+	mNodes.push_back(nd);
+	return index;
+}
+
+
+// Plan
+bool dagPlanner::Plan( uint32_t maxStreams, size_t alignment )
+{
+	if( maxStreams == 0 )
+		maxStreams = 1;
+
+	if( alignment == 0 )
+		alignment = 1;
+
+	mAlignment = alignment;
+
+	if( !order() )
+		return false;
+
+	assignStreams(maxStreams);
+	packBuffers(alignment);
+
+	return true;
+}
+
+
+// order
+bool dagPlanner::order()
+{
+	const int numNodes = mNodes.size();
+
+	// the dependencies come from the producers of each node's inputs
+	for( int n=0; n < numNodes; n++ )
+	{
+		node& nd = mNodes[n];
+		nd.dependencies.clear();
+
+		for( size_t i=0; i < nd.inputs.size(); i++ )
+		{
+			const buffer& b = mBuffers[nd.inputs[i]];
+
+			if( b.producer < 0 )
+			{
+				if( !b.external )
+				{
+					printf(LOG_DAG "node '%s' reads buffer '%s', which is never written (should it be external?)\n", 
+						  nd.name.c_str(), b.name.c_str());
+					return false;
+				}
+
+				continue;
+			}
+
+			if( std::find(nd.dependencies.begin(), nd.dependencies.end(), b.producer) == nd.dependencies.end() )
+				nd.dependencies.push_back(b.producer);
+		}
+	}
+
+	// Kahn's algorithm, preferring the order that the nodes were added in
+	std::vector<int> remaining(numNodes);
+	std::vector<bool> issued(numNodes, false);
+
+	for( int n=0; n < numNodes; n++ )
+		remaining[n] = mNodes[n].dependencies.size();
+
+	mOrder.clear();
+
+	while( (int)mOrder.size() < numNodes )
+	{
+		int next = -1;
+
+		for( int n=0; n < numNodes; n++ )
+		{
+			if( !issued[n] && remaining[n] == 0 )
+			{
+				next = n;
+				break;
+			}
+		}
+
+		if( next < 0 )
+		{
+			printf(LOG_DAG "the graph has a cycle -- it can't be scheduled\n");
+			return false;
+		}
+
+		issued[next] = true;
+		mOrder.push_back(next);
+
+		for( int n=0; n < numNodes; n++ )
+		{
+			const std::vector<int>& deps = mNodes[n].dependencies;
+
+			if( std::find(deps.begin(), deps.end(), next) != deps.end() )
+				remaining[n]--;
+		}
+	}
+
+	// compute which nodes each node reaches, in reverse order
+	mReachable.assign(numNodes, std::vector<bool>(numNodes, false));
+
+	for( int i=numNodes-1; i >= 0; i-- )
+	{
+		const int n = mOrder[i];
+
+		for( int s=0; s < numNodes; s++ )
+		{
+			const std::vector<int>& deps = mNodes[s].dependencies;
+
+			if( std::find(deps.begin(), deps.end(), n) == deps.end() )
+				continue;
+
+			mReachable[n][s] = true;
+
+			for( int r=0; r < numNodes; r++ )
+			{
+				if( mReachable[s][r] )
+					mReachable[n][r] = true;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+// assignStreams
+void dagPlanner::assignStreams( uint32_t maxStreams )
+{
+	std::vector<int> tail;	// last node issued on each stream
+	uint32_t roundRobin = 0;
+
+	for( size_t i=0; i < mOrder.size(); i++ )
+	{
+		node& nd = mNodes[mOrder[i]];
+		int stream = -1;
+
+		// continue the chain of a dependency that's still the last node on its stream
+		for( size_t d=0; d < nd.dependencies.size() && stream < 0; d++ )
+		{
+			const int dep = nd.dependencies[d];
+
+			if( tail[mNodes[dep].stream] == dep )
+				stream = mNodes[dep].stream;
+		}
+
+		// otherwise fork a new stream
+		if( stream < 0 && tail.size() < maxStreams )
+		{
+			stream = tail.size();
+			tail.push_back(-1);
+		}
+
+		// otherwise share a stream whose work is already finished by the time this node runs
+		for( size_t s=0; s < tail.size() && stream < 0; s++ )
+		{
+			if( HappensBefore(tail[s], mOrder[i]) )
+				stream = s;
+		}
+
+		if( stream < 0 )
+			stream = (roundRobin++) % tail.size();
+
+		nd.stream = stream;
+		tail[stream] = mOrder[i];
+	}
+
+	mNumStreams = tail.size();
+
+	// dependencies on other streams are waited for with events
+	for( size_t n=0; n < mNodes.size(); n++ )
+	{
+		node& nd = mNodes[n];
+		nd.waits.clear();
+
+		for( size_t d=0; d < nd.dependencies.size(); d++ )
+		{
+			const int dep = nd.dependencies[d];
+
+			if( mNodes[dep].stream != nd.stream )
+			{
+				nd.waits.push_back(dep);
+				mNodes[dep].waitedOn = true;
+			}
+		}
+	}
+}
+
+
+// packBuffers
+void dagPlanner::packBuffers( size_t alignment )
+{
+	struct slot
+	{
+		size_t size;
+		size_t offset;
+		int    last;	// most recent buffer assigned to the slot
+	};
+
+	std::vector<slot> slots;
+	std::vector<int> bufferSlots(mBuffers.size(), -1);
+
+	// pack the buffers in the order that they're written
+	for( size_t i=0; i < mOrder.size(); i++ )
+	{
+		const int producer = mOrder[i];
+		const std::vector<int>& outputs = mNodes[producer].outputs;
+
+		for( size_t o=0; o < outputs.size(); o++ )
+		{
+			const buffer& b = mBuffers[outputs[o]];
+
+			if( b.external )
+				continue;
+
+			int best = -1;
+
+			for( size_t s=0; s < slots.size(); s++ )
+			{
+				// every use of the slot's last buffer has to finish before this one is written
+				const buffer& last = mBuffers[slots[s].last];
+				bool free = true;
+
+				if( last.consumers.size() == 0 )
+					free = HappensBefore(last.producer, producer);
+
+				for( size_t c=0; c < last.consumers.size() && free; c++ )
+					free = HappensBefore(last.consumers[c], producer);
+
+				if( !free )
+					continue;
+
+				// best fit -- the smallest slot that's big enough, or else the biggest slot
+				if( best < 0 )
+				{
+					best = s;
+				}
+				else
+				{
+					const bool fits = (slots[s].size >= b.size);
+					const bool bestFits = (slots[best].size >= b.size);
+
+					if( (fits && (!bestFits || slots[s].size < slots[best].size)) || 
+					    (!fits && !bestFits && slots[s].size > slots[best].size) )
+						best = s;
+				}
+			}
+
+			if( best < 0 )
+			{
+				slot s;
+
+				s.size   = 0;
+				s.offset = 0;
+				s.last   = -1;
+
+				slots.push_back(s);
+				best = slots.size() - 1;
+			}
+
+			slots[best].size = std::max(slots[best].size, b.size);
+			slots[best].last = outputs[o];
+
+			bufferSlots[outputs[o]] = best;
+		}
+	}
+
+	// lay the slots out in the arena
+	mArenaSize = 0;
+
+	for( size_t s=0; s < slots.size(); s++ )
+	{
+		slots[s].offset = mArenaSize;
+		mArenaSize += ((slots[s].size + alignment - 1) / alignment) * alignment;
+	}
+
+	for( size_t n=0; n < mBuffers.size(); n++ )
+		mBuffers[n].offset = (bufferSlots[n] >= 0) ? slots[bufferSlots[n]].offset : 0;
+}
+
+
+// GetUnpackedSize
+size_t dagPlanner::GetUnpackedSize() const
+{
+	size_t size = 0;
+
+	for( size_t n=0; n < mBuffers.size(); n++ )
+	{
+		if( !mBuffers[n].external && mBuffers[n].producer >= 0 )
+			size += ((mBuffers[n].size + mAlignment - 1) / mAlignment) * mAlignment;
+	}
+
+	return size;
+}
+
+
+// HappensBefore
+bool dagPlanner::HappensBefore( int a, int b ) const
+{
+	if( a < 0 || b < 0 || a >= (int)mReachable.size() || b >= (int)mReachable.size() )
+		return false;
+
+	return mReachable[a][b];
+}
+
+
+// Print
+void dagPlanner::Print() const
+{
+	printf(LOG_DAG "%zu nodes on %u streams\n", mOrder.size(), mNumStreams);
+
+	for( size_t i=0; i < mOrder.size(); i++ )
+	{
+		const node& nd = mNodes[mOrder[i]];
+		printf(LOG_DAG "  [stream %u]  %s", nd.stream, nd.name.c_str());
+
+		for( size_t w=0; w < nd.waits.size(); w++ )
+			printf("%s%s", (w == 0) ? "  (waits for " : ", ", mNodes[nd.waits[w]].name.c_str());
+
+		printf("%s\n", nd.waits.size() > 0 ? ")" : "");
+	}
+
+	for( size_t n=0; n < mBuffers.size(); n++ )
+	{
+		const buffer& b = mBuffers[n];
+
+		if( b.external )
+			printf(LOG_DAG "  buffer %-20s %10zu bytes  (external)\n", b.name.c_str(), b.size);
+		else
+			printf(LOG_DAG "  buffer %-20s %10zu bytes  at offset %zu\n", b.name.c_str(), b.size, b.offset);
+	}
+
+	printf(LOG_DAG "arena size %zu bytes (%zu bytes unpacked)\n", mArenaSize, GetUnpackedSize());
+}
+
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __DAG_PLANNER_H__
+#define __DAG_PLANNER_H__
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+
+/**
+ * Prefix used for tagging printed log output from the DAG planner and executor.
+ * @ingroup dag
+ */
+#define LOG_DAG "[dag]   "
+
+
+/**
+ * Schedules a graph of nodes that communicate through buffers, without
+ * depending on CUDA -- dagExecutor runs the plan on the GPU.
+ *
+ * Each buffer is written by a single node and read by any number of nodes,
+ * which defines the dependencies between the nodes.  Plan() then:
+ *
+ *   - orders the nodes topologically (failing if the graph has a cycle)
+ *
+ *   - assigns the nodes to streams, so that a chain of nodes stays on one
+ *     stream and each branch that forks from it starts a new stream (up to
+ *     the maximum number of streams, after which they're shared round-robin)
+ *
+ *   - determines which dependencies cross streams, and so need an event
+ *
+ *   - packs the intermediate buffers into one arena, where two buffers can
+ *     share memory if every use of the first one happens before the second
+ *     one is written -- by the dependencies, not just by the order, since
+ *     nodes on different streams may run concurrently
+ *
+ * External buffers (i.e. the graph's inputs, and outputs that are read
+ * after the graph runs) are provided by the caller and aren't packed.
+ *
+ * @ingroup dag
+ */
+class dagPlanner
+{
+public:
+	/**
+	 * Constructor.
+	 */
+	dagPlanner();
+
+	/**
+	 * Add a buffer.
+	 * @param size size of the buffer in bytes
+	 * @param external true if the buffer is provided by the caller instead of the arena
+	 * @returns the buffer's index
+	 */
+	int AddBuffer( const char* name, size_t size, bool external=false );
+
+	/**
+	 * Add a node.
+	 * @param inputs indices of the buffers that the node reads
+	 * @param outputs indices of the buffers that the node writes
+	 * @returns the node's index, or -1 if a buffer index is invalid
+	 *          or one of the outputs is already written by another node.
+	 */
+	int AddNode( const char* name, const std::vector<int>& inputs, const std::vector<int>& outputs );
+
+	/**
+	 * Plan the graph.
+	 * @param maxStreams the maximum number of streams to use
+	 * @param alignment alignment of the buffers within the arena, in bytes
+	 * @returns false if the graph has a cycle, or a buffer that's read is never written.
+	 */
+	bool Plan( uint32_t maxStreams=4, size_t alignment=256 );
+
+	/**
+	 * Retrieve the number of nodes.
+	 */
+	inline uint32_t GetNumNodes() const					{ return mNodes.size(); }
+
+	/**
+	 * Retrieve the number of buffers.
+	 */
+	inline uint32_t GetNumBuffers() const					{ return mBuffers.size(); }
+
+	/**
+	 * Retrieve the name of a node.
+	 */
+	inline const char* GetNodeName( int node ) const			{ return mNodes[node].name.c_str(); }
+
+	/**
+	 * Retrieve the buffers that a node reads.
+	 */
+	inline const std::vector<int>& GetNodeInputs( int node ) const	{ return mNodes[node].inputs; }
+
+	/**
+	 * Retrieve the buffers that a node writes.
+	 */
+	inline const std::vector<int>& GetNodeOutputs( int node ) const	{ return mNodes[node].outputs; }
+
+	/**
+	 * Retrieve the nodes that a node depends on directly.
+	 */
+	inline const std::vector<int>& GetNodeDependencies( int node ) const	{ return mNodes[node].dependencies; }
+
+	/**
+	 * Retrieve the dependencies of a node that are on other streams (which it must wait for with events).
+	 */
+	inline const std::vector<int>& GetNodeWaits( int node ) const	{ return mNodes[node].waits; }
+
+	/**
+	 * Retrieve the stream that a node was assigned to.
+	 */
+	inline uint32_t GetNodeStream( int node ) const			{ return mNodes[node].stream; }
+
+	/**
+	 * Check if another stream waits for the node (so it needs to record an event).
+	 */
+	inline bool IsNodeWaitedOn( int node ) const				{ return mNodes[node].waitedOn; }
+
+	/**
+	 * Retrieve the nodes in the order they're issued in (a topological order).
+	 */
+	inline const std::vector<int>& GetOrder() const			{ return mOrder; }
+
+	/**
+	 * Retrieve the number of streams used.
+	 */
+	inline uint32_t GetNumStreams() const					{ return mNumStreams; }
+
+	/**
+	 * Retrieve the name of a buffer.
+	 */
+	inline const char* GetBufferName( int buffer ) const		{ return mBuffers[buffer].name.c_str(); }
+
+	/**
+	 * Retrieve the size of a buffer, in bytes.
+	 */
+	inline size_t GetBufferSize( int buffer ) const			{ return mBuffers[buffer].size; }
+
+	/**
+	 * Check if a buffer is provided by the caller.
+	 */
+	inline bool IsBufferExternal( int buffer ) const			{ return mBuffers[buffer].external; }
+
+	/**
+	 * Retrieve the offset of a buffer within the arena (for buffers that aren't external).
+	 */
+	inline size_t GetBufferOffset( int buffer ) const			{ return mBuffers[buffer].offset; }
+
+	/**
+	 * Retrieve the size of the arena that the intermediate buffers are packed into.
+	 */
+	inline size_t GetArenaSize() const					{ return mArenaSize; }
+
+	/**
+	 * Retrieve the total size of the intermediate buffers if they weren't shared (with the same alignment).
+	 */
+	size_t GetUnpackedSize() const;
+
+	/**
+	 * Check if node a is guaranteed to complete before node b starts (valid after Plan()).
+	 */
+	bool HappensBefore( int a, int b ) const;
+
+	/**
+	 * Print the plan.
+	 */
+	void Print() const;
+
+protected:
+	struct node
+	{
+		std::string name;
+		std::vector<int> inputs;
+		std::vector<int> outputs;
+		std::vector<int> dependencies;
+		std::vector<int> waits;
+		uint32_t stream;
+		bool waitedOn;
+	};
+
+	struct buffer
+	{
+		std::string name;
+		size_t size;
+		size_t offset;
+		bool   external;
+		int    producer;
+		std::vector<int> consumers;
+	};
+
+	bool order();
+	void assignStreams( uint32_t maxStreams );
+	void packBuffers( size_t alignment );
+
+	std::vector<node>   mNodes;
+	std::vector<buffer> mBuffers;
+	std::vector<int>    mOrder;
+
+	std::vector< std::vector<bool> > mReachable;	// mReachable[a][b] if b depends on a, directly or not
+
+	uint32_t mNumStreams;
+	size_t   mArenaSize;
+	size_t   mAlignment;
+};
+
+
+#endif
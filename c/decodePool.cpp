@@ -0,0 +1,543 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "decodePool.h"
+#include "threadConfig.h"
+
+#include "cudaMappedMemory.h"
+#include "loadImage.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+
+
+// constructor
+decodePool::decodePool( decodeOrder order )
+{
+	mOrder     = order;
+	mSubmitted = 0;
+	mRetrieved = 0;
+	mNextIndex = 0;
+	mClosed    = false;
+	mStop      = false;
+
+	pthread_mutex_init(&mMutex, NULL);
+	pthread_cond_init(&mWorkerCond, NULL);
+	pthread_cond_init(&mConsumerCond, NULL);
+}
+
+
+// destructor
+decodePool::~decodePool()
+{
+	pthread_mutex_lock(&mMutex);
+	mStop = true;
+	pthread_cond_broadcast(&mWorkerCond);
+	pthread_mutex_unlock(&mMutex);
+
+	for( size_t n=0; n < mThreads.size(); n++ )
+		pthread_join(mThreads[n].handle, NULL);
+
+	for( size_t n=0; n < mBuffers.size(); n++ )
+	{
+		if( mBuffers[n].cpu != NULL )
+			CUDA(cudaFreeHost(mBuffers[n].cpu));
+	}
+
+	pthread_cond_destroy(&mConsumerCond);
+	pthread_cond_destroy(&mWorkerCond);
+	pthread_mutex_destroy(&mMutex);
+}
+
+
+// Create
+decodePool* decodePool::Create( uint32_t numThreads, uint32_t numBuffers, decodeOrder order )
+{
+	decodePool* pool = new decodePool(order);
+
+	if( !pool->init(numThreads, numBuffers) )
+	{
+		printf(LOG_DECODE "failed to create decode pool\n");
+		delete pool;
+		return NULL;
+	}
+
+	return pool;
+}
+
+
+// init
+bool decodePool::init( uint32_t numThreads, uint32_t numBuffers )
+{
+	if( numThreads == 0 )
+	{
+		const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		numThreads = (cores > 0) ? cores : 1;
+	}
+
+	if( numBuffers == 0 )
+		numBuffers = numThreads * 2;
+
+	// the buffers are allocated by the workers on first use, at the size of the image
+	mBuffers.resize(numBuffers);
+
+	for( uint32_t n=0; n < numBuffers; n++ )
+	{
+		mBuffers[n].cpu  = NULL;
+		mBuffers[n].gpu  = NULL;
+		mBuffers[n].size = 0;
+
+		mFreeBuffers.push_back(numBuffers - n - 1);
+	}
+
+	mThreads.resize(numThreads);
+
+	for( uint32_t n=0; n < numThreads; n++ )
+	{
+		mThreads[n].pool  = this;
+		mThreads[n].index = n;
+
+		if( pthread_create(&mThreads[n].handle, NULL, threadEntry, &mThreads[n]) != 0 )
+		{
+			printf(LOG_DECODE "failed to create worker thread %u\n", n);
+			mThreads.resize(n);
+			return false;
+		}
+	}
+
+	printf(LOG_DECODE "decode pool started with %u threads and %u buffers (%s)\n", numThreads, numBuffers,
+		  (mOrder == DECODE_ORDERED) ? "ordered" : "unordered");
+
+	return true;
+}
+
+
+// Submit
+uint64_t decodePool::Submit( const char* filename )
+{
+	pthread_mutex_lock(&mMutex);
+
+	job j;
+
+	j.index    = mSubmitted++;
+	j.filename = filename ? filename : "";
+
+	mJobs.push_back(j);
+
+	pthread_cond_signal(&mWorkerCond);
+	pthread_mutex_unlock(&mMutex);
+
+	return j.index;
+}
+
+
+// Submit
+void decodePool::Submit( const std::vector<std::string>& filenames )
+{
+	pthread_mutex_lock(&mMutex);
+
+	for( size_t n=0; n < filenames.size(); n++ )
+	{
+		job j;
+
+		j.index    = mSubmitted++;
+		j.filename = filenames[n];
+
+		mJobs.push_back(j);
+	}
+
+	pthread_cond_broadcast(&mWorkerCond);
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// Close
+void decodePool::Close()
+{
+	pthread_mutex_lock(&mMutex);
+	mClosed = true;
+	pthread_cond_broadcast(&mConsumerCond);
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// Next
+bool decodePool::Next( decodedImage* image, int64_t timeout )
+{
+	if( !image )
+		return false;
+
+	struct timespec deadline;
+
+	if( timeout >= 0 )
+	{
+		clock_gettime(CLOCK_REALTIME, &deadline);
+
+		deadline.tv_sec  += timeout / 1000;
+		deadline.tv_nsec += (timeout % 1000) * 1000000;
+
+		if( deadline.tv_nsec >= 1000000000 )
+		{
+			deadline.tv_sec  += 1;
+			deadline.tv_nsec -= 1000000000;
+		}
+	}
+
+	pthread_mutex_lock(&mMutex);
+
+	while( true )
+	{
+		if( mOrder == DECODE_ORDERED )
+		{
+			std::map<uint64_t, decodedImage>::iterator iter = mCompleteOrdered.find(mNextIndex);
+
+			if( iter != mCompleteOrdered.end() )
+			{
+				*image = iter->second;
+				mCompleteOrdered.erase(iter);
+				mNextIndex++;
+				break;
+			}
+		}
+		else if( mCompleteUnordered.size() > 0 )
+		{
+			*image = mCompleteUnordered.front();
+			mCompleteUnordered.pop_front();
+			break;
+		}
+
+		if( mClosed && mRetrieved == mSubmitted )
+		{
+			pthread_mutex_unlock(&mMutex);
+			return false;
+		}
+
+		if( timeout < 0 )
+			pthread_cond_wait(&mConsumerCond, &mMutex);
+		else if( pthread_cond_timedwait(&mConsumerCond, &mMutex, &deadline) == ETIMEDOUT )
+		{
+			pthread_mutex_unlock(&mMutex);
+			return false;
+		}
+	}
+
+	mRetrieved++;
+	pthread_mutex_unlock(&mMutex);
+
+	return true;
+}
+
+
+// Release
+void decodePool::Release( decodedImage* image )
+{
+	if( !image || image->buffer < 0 )
+		return;
+
+	pthread_mutex_lock(&mMutex);
+	mFreeBuffers.push_back(image->buffer);
+	pthread_cond_signal(&mWorkerCond);
+	pthread_mutex_unlock(&mMutex);
+
+	image->buffer = -1;
+	image->cpu    = NULL;
+	image->gpu    = NULL;
+}
+
+
+// threadEntry
+void* decodePool::threadEntry( void* param )
+{
+	worker* w = (worker*)param;
+
+	char name[16];
+	snprintf(name, sizeof(name), "decode-%u", w->index);
+	threadConfig::ApplyStage("decode", name);
+
+	w->pool->run(w->index);
+	return NULL;
+}
+
+
+// run
+void decodePool::run( uint32_t thread )
+{
+	imageDecoder decoder;
+
+	pthread_mutex_lock(&mMutex);
+
+	while( true )
+	{
+		// wait for an image and a free buffer to decode it into -- the jobs and
+		// buffers are paired in submission order, so that in ordered mode the
+		// next image the consumer waits on always has a buffer
+		while( !mStop && (mJobs.size() == 0 || mFreeBuffers.size() == 0) )
+			pthread_cond_wait(&mWorkerCond, &mMutex);
+
+		if( mStop )
+			break;
+
+		const job j = mJobs.front();
+		const int buffer = mFreeBuffers.back();
+
+		mJobs.pop_front();
+		mFreeBuffers.pop_back();
+
+		pthread_mutex_unlock(&mMutex);
+
+		decodedImage image;
+
+		image.index    = j.index;
+		image.filename = j.filename;
+		image.buffer   = buffer;
+		image.success  = decode(j.filename, buffer, decoder, &image);
+
+		pthread_mutex_lock(&mMutex);
+
+		if( mOrder == DECODE_ORDERED )
+			mCompleteOrdered[image.index] = image;
+		else
+			mCompleteUnordered.push_back(image);
+
+		pthread_cond_broadcast(&mConsumerCond);
+	}
+
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// decode
+bool decodePool::decode( const std::string& filename, int index, imageDecoder& decoder, decodedImage* image )
+{
+	buffer& buf = mBuffers[index];
+
+	image->cpu    = NULL;
+	image->gpu    = NULL;
+	image->width  = 0;
+	image->height = 0;
+
+	// the other formats are decoded by loadImageRGBA() into its own buffer, and copied
+	float4* fallbackCPU = NULL;
+	float4* fallbackGPU = NULL;
+	int     fallbackWidth = 0;
+	int     fallbackHeight = 0;
+
+	const bool native = decoder.Open(filename.c_str());
+
+	if( native )
+	{
+		image->width  = decoder.GetWidth();
+		image->height = decoder.GetHeight();
+	}
+	else
+	{
+		if( !loadImageRGBA(filename.c_str(), &fallbackCPU, &fallbackGPU, &fallbackWidth, &fallbackHeight) )
+			return false;
+
+		image->width  = fallbackWidth;
+		image->height = fallbackHeight;
+	}
+
+	// grow the buffer if this image is larger than the ones it held before
+	const size_t size = size_t(image->width) * size_t(image->height) * sizeof(float4);
+
+	if( size > buf.size )
+	{
+		if( buf.cpu != NULL )
+			CUDA(cudaFreeHost(buf.cpu));
+
+		buf.cpu  = NULL;
+		buf.gpu  = NULL;
+		buf.size = 0;
+
+		if( !cudaAllocMapped((void**)&buf.cpu, (void**)&buf.gpu, size) )
+		{
+			printf(LOG_DECODE "failed to allocate %zu bytes for '%s'\n", size, filename.c_str());
+
+			if( fallbackCPU != NULL )
+				CUDA(cudaFreeHost(fallbackCPU));
+
+			return false;
+		}
+
+		buf.size = size;
+	}
+
+	bool success = true;
+
+	if( native )
+	{
+		success = decoder.Decode((float*)buf.cpu);
+
+		if( !success )
+			printf(LOG_DECODE "failed to decode '%s'\n", filename.c_str());
+	}
+	else
+	{
+		memcpy(buf.cpu, fallbackCPU, size);
+		CUDA(cudaFreeHost(fallbackCPU));
+	}
+
+	if( success )
+	{
+		image->cpu = buf.cpu;
+		image->gpu = buf.gpu;
+	}
+
+	return success;
+}
+
+
+// return true if the file has one of the image extensions
+static bool isImageFile( const char* filename )
+{
+	static const char* extensions[] = { "jpg", "jpeg", "png", "bmp", "gif", "tga", "psd" };
+
+	const char* dot = strrchr(filename, '.');
+
+	if( !dot )
+		return false;
+
+	for( size_t n=0; n < sizeof(extensions) / sizeof(extensions[0]); n++ )
+	{
+		if( strcasecmp(dot + 1, extensions[n]) == 0 )
+			return true;
+	}
+
+	return false;
+}
+
+
+// return true if the file has the extension of a list of images
+static bool isListFile( const char* filename )
+{
+	const char* dot = strrchr(filename, '.');
+	return dot != NULL && (strcasecmp(dot, ".txt") == 0 || strcasecmp(dot, ".list") == 0);
+}
+
+
+// IsImageList
+bool decodePool::IsImageList( const char* path )
+{
+	if( !path )
+		return false;
+
+	struct stat info;
+
+	if( stat(path, &info) != 0 )
+		return false;
+
+	return S_ISDIR(info.st_mode) || isListFile(path);
+}
+
+
+// ListImages
+bool decodePool::ListImages( const char* path, std::vector<std::string>& filenames )
+{
+	if( !path )
+		return false;
+
+	struct stat info;
+
+	if( stat(path, &info) != 0 )
+	{
+		printf(LOG_DECODE "'%s' doesn't exist\n", path);
+		return false;
+	}
+
+	const size_t count = filenames.size();
+
+	if( S_ISDIR(info.st_mode) )
+	{
+		DIR* dir = opendir(path);
+
+		if( !dir )
+		{
+			printf(LOG_DECODE "failed to open directory '%s'\n", path);
+			return false;
+		}
+
+		std::vector<std::string> entries;
+		struct dirent* entry = NULL;
+
+		while( (entry = readdir(dir)) != NULL )
+		{
+			if( entry->d_name[0] != '.' && isImageFile(entry->d_name) )
+				entries.push_back(std::string(path) + "/" + entry->d_name);
+		}
+
+		closedir(dir);
+
+		std::sort(entries.begin(), entries.end());
+		filenames.insert(filenames.end(), entries.begin(), entries.end());
+	}
+	else
+	{
+		if( isListFile(path) )
+		{
+			FILE* file = fopen(path, "r");
+
+			if( !file )
+			{
+				printf(LOG_DECODE "failed to open list '%s'\n", path);
+				return false;
+			}
+
+			char line[4096];
+
+			while( fgets(line, sizeof(line), file) != NULL )
+			{
+				size_t length = strlen(line);
+
+				while( length > 0 && (line[length-1] == '\n' || line[length-1] == '\r' || line[length-1] == ' ') )
+					line[--length] = '\0';
+
+				if( length > 0 && line[0] != '#' )
+					filenames.push_back(line);
+			}
+
+			fclose(file);
+		}
+		else
+		{
+			filenames.push_back(path);
+		}
+	}
+
+	if( filenames.size() == count )
+	{
+		printf(LOG_DECODE "no images found in '%s'\n", path);
+		return false;
+	}
+
+	return true;
+}
+
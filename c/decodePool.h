@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __DECODE_POOL_H__
+#define __DECODE_POOL_H__
+
+#include "imageDecode.h"
+#include "cudaUtility.h"
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+
+
+/**
+ * Order in which the decoded images are returned by decodePool::Next()
+ * @ingroup decodePool
+ */
+enum decodeOrder
+{
+	DECODE_ORDERED = 0,		/**< in the order the images were submitted */
+	DECODE_UNORDERED		/**< as soon as each image is decoded */
+};
+
+
+/**
+ * An image decoded by decodePool, in float4 RGBA (0-255) shared CPU/GPU memory
+ * like loadImageRGBA() -- the GPU pointer can be passed directly to imageNet::Classify()
+ * or detectNet::Detect().  The buffer belongs to the pool, and is valid until the
+ * image is returned to it with decodePool::Release().
+ * @ingroup decodePool
+ */
+struct decodedImage
+{
+	float4*     cpu;		/**< CPU pointer to the image (NULL if it failed to decode) */
+	float4*     gpu;		/**< GPU pointer to the image (NULL if it failed to decode) */
+	uint32_t    width;		/**< width of the image, in pixels */
+	uint32_t    height;		/**< height of the image, in pixels */
+	uint64_t    index;		/**< submission index, as returned by decodePool::Submit() */
+	std::string filename;	/**< path of the image file */
+	bool        success;	/**< false if the file couldn't be read or decoded */
+	int         buffer;		/**< (internal) buffer of the pool that holds the image */
+};
+
+
+/**
+ * Decodes images from disk on a pool of worker threads, ahead of the consumer,
+ * into a recycled set of mapped (pinned) buffers that are ready for inference.
+ *
+ * Images are queued with Submit() and retrieved with Next(), either in submission
+ * order or as they complete.  Prefetching is bounded by the number of buffers --
+ * a worker only starts on an image when a buffer is free, and buffers are freed
+ * by Release() -- so the consumer must release each image when it's done with it.
+ * The buffers grow to the largest image decoded, so after the first few images
+ * there are no further allocations.
+ *
+ * JPEG and PNG are decoded with libjpeg-turbo and libpng (see imageDecoder), and
+ * the other formats with loadImageRGBA() into the pool's buffer.
+ *
+ * The workers apply the "decode" stage of threadConfig when they start.
+ * @ingroup decodePool
+ */
+class decodePool
+{
+public:
+	/**
+	 * Create a decode pool.
+	 * @param numThreads number of worker threads (0 for one per online core)
+	 * @param numBuffers number of buffers, which bounds the number of images decoded ahead
+	 *                   of the consumer (0 for twice the number of threads)
+	 * @param order whether Next() returns the images in the order they were submitted
+	 */
+	static decodePool* Create( uint32_t numThreads=0, uint32_t numBuffers=0, decodeOrder order=DECODE_ORDERED );
+
+	/**
+	 * Destructor -- stops the workers and frees the buffers.  Any images that
+	 * haven't been released are invalid afterwards.
+	 */
+	~decodePool();
+
+	/**
+	 * Queue an image file to be decoded.
+	 * @returns the index of the image (in submission order, starting from 0)
+	 */
+	uint64_t Submit( const char* filename );
+
+	/**
+	 * Queue a list of image files to be decoded.
+	 */
+	void Submit( const std::vector<std::string>& filenames );
+
+	/**
+	 * Indicate that no more images will be submitted, so that Next()
+	 * returns false once the queued images have been retrieved.
+	 */
+	void Close();
+
+	/**
+	 * Retrieve the next decoded image.  Images that failed to decode are
+	 * also returned (with decodedImage::success set to false).
+	 * @param timeout maximum time to wait in milliseconds (or -1 to wait indefinitely)
+	 * @returns false on timeout, or after Close() when all the submitted images were retrieved.
+	 */
+	bool Next( decodedImage* image, int64_t timeout=-1 );
+
+	/**
+	 * Return the buffer of an image retrieved with Next() to the pool.
+	 */
+	void Release( decodedImage* image );
+
+	/**
+	 * Number of worker threads.
+	 */
+	inline uint32_t GetNumThreads() const				{ return mThreads.size(); }
+
+	/**
+	 * Number of buffers (the bound on the images decoded ahead).
+	 */
+	inline uint32_t GetNumBuffers() const				{ return mBuffers.size(); }
+
+	/**
+	 * Completion order of the pool.
+	 */
+	inline decodeOrder GetOrder() const				{ return mOrder; }
+
+	/**
+	 * Expand a path into the image files it names, for the tools that process many images:
+	 * a directory (its JPEG, PNG, BMP, GIF, TGA and PSD files, sorted by name), a text file
+	 * with one filename per line (.txt or .list), or else the path itself.
+	 * @returns false if the path doesn't exist or no images were found.
+	 */
+	static bool ListImages( const char* path, std::vector<std::string>& filenames );
+
+	/**
+	 * Return true if the path is a directory or a list file, that ListImages() expands
+	 * to many images (as opposed to a single image).
+	 */
+	static bool IsImageList( const char* path );
+
+protected:
+	decodePool( decodeOrder order );
+	bool init( uint32_t numThreads, uint32_t numBuffers );
+
+	static void* threadEntry( void* param );
+	void run( uint32_t thread );
+	bool decode( const std::string& filename, int index, imageDecoder& decoder, decodedImage* image );
+
+	struct buffer
+	{
+		float4* cpu;
+		float4* gpu;
+		size_t  size;
+	};
+
+	struct job
+	{
+		uint64_t    index;
+		std::string filename;
+	};
+
+	struct worker
+	{
+		decodePool* pool;
+		uint32_t    index;
+		pthread_t   handle;
+	};
+
+	decodeOrder mOrder;
+
+	std::vector<buffer>  mBuffers;
+	std::vector<worker>  mThreads;
+
+	std::vector<int> mFreeBuffers;
+	std::deque<job>  mJobs;
+
+	std::map<uint64_t, decodedImage> mCompleteOrdered;
+	std::deque<decodedImage> mCompleteUnordered;
+
+	uint64_t mSubmitted;
+	uint64_t mRetrieved;
+	uint64_t mNextIndex;
+
+	bool mClosed;
+	bool mStop;
+
+	pthread_mutex_t mMutex;
+	pthread_cond_t  mWorkerCond;
+	pthread_cond_t  mConsumerCond;
+};
+
+
+#endif
+
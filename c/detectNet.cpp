@@ -22,6 +22,7 @@
 
 #include "detectNet.h"
 #include "imageNet.cuh"
+#include "hostPostProcess.h"
 
 #include "cudaMappedMemory.h"
 #include "cudaFont.h"
@@ -30,16 +31,17 @@
 #include "filesystem.h"
 
 
-#define OUTPUT_CVG  0	// Caffe has output coverage (confidence) heat map
-#define OUTPUT_BBOX 1	// Caffe has separate output layer for bounding box
-
-#define OUTPUT_UFF  0	// UFF has primary output containing detection results
-#define OUTPUT_NUM	1	// UFF has secondary output containing one detection count
-
 #define CHECK_NULL_STR(x)	(x != NULL) ? x : "NULL"
 //#define DEBUG_CLUSTERING
 
 
+// pre-processing of the models (shared by preProcess() and inputRange())
+static const float2 gUffRange   = make_float2(-1.0f, 1.0f);
+static const float2 gOnnxRange  = make_float2(0.0f, 1.0f);
+static const float3 gOnnxMean   = make_float3(0.485f, 0.456f, 0.406f);
+static const float3 gOnnxStdDev = make_float3(0.229f, 0.224f, 0.225f);
+
+
 // constructor
 detectNet::detectNet( float meanPixel ) : tensorNet()
 {
@@ -55,6 +57,23 @@ detectNet::detectNet( float meanPixel ) : tensorNet()
 	mDetectionSets[1] = NULL; // gpu ptr
 	mDetectionSet     = 0;
 	mMaxDetections    = 0;
+	mNumDetectionSets = DefaultNumDetectionSets;
+	mDecoder          = NULL;
+
+	mDeviceDetections  = NULL;
+	mDeviceCount       = NULL;
+	mDeviceCapacity    = 0;
+	mDeviceRows        = 0;
+	mDownloadCounts[0] = NULL;
+	mDownloadCounts[1] = NULL;
+
+	mPreview[0]    = NULL;
+	mPreview[1]    = NULL;
+	mPreviewWidth  = 0;
+	mPreviewHeight = 0;
+	mPreviewEvent  = NULL;
+
+	mBindingPrecisionSupported = true;
 }
 
 
@@ -76,6 +95,15 @@ detectNet::~detectNet()
 		mClassColors[0] = NULL;
 		mClassColors[1] = NULL;
 	}
+
+	if( mDecoder != NULL )
+	{
+		delete mDecoder;
+		mDecoder = NULL;
+	}
+
+	freeDeviceDetections();
+	SetPreview(0, 0);
 }
 
 
@@ -234,34 +262,112 @@ detectNet* detectNet::Create( const char* model, const char* class_labels, float
 // allocDetections
 bool detectNet::allocDetections()
 {
-	// determine max detections
-	if( IsModelType(MODEL_UFF) )	// TODO:  fixme
+	// select the default decoder of the outputs
+	const char* decoder = "detectnet";
+
+	if( IsModelType(MODEL_UFF) )
 	{
-		printf("W = %u  H = %u  C = %u\n", DIMS_W(mOutputs[OUTPUT_UFF].dims), DIMS_H(mOutputs[OUTPUT_UFF].dims), DIMS_C(mOutputs[OUTPUT_UFF].dims));
-		mMaxDetections = DIMS_H(mOutputs[OUTPUT_UFF].dims) * DIMS_C(mOutputs[OUTPUT_UFF].dims);
+		decoder = "ssd";
 	}
 	else if( IsModelType(MODEL_ONNX) )
 	{
-		mMaxDetections = 1;
-		mNumClasses = 1;
-		printf("detectNet -- using ONNX model\n");
+		if( mOutputs.size() >= 2 )
+			decoder = "anchor";
+		else if( DIMS_C(mOutputs[0].dims) * DIMS_H(mOutputs[0].dims) * DIMS_W(mOutputs[0].dims) == 4 )
+			decoder = "box";
+		else
+			decoder = "yolo";
 	}
-	else
+
+	return SetDecoder(decoder);
+}
+
+
+// SetDecoder
+bool detectNet::SetDecoder( const char* name )
+{
+	detectionDecoder* decoder = detectionDecoder::Create(name);
+
+	if( !decoder )
+		return false;
+
+	// describe the outputs to the decoder
+	std::vector<detectionTensor> outputs(mOutputs.size());
+
+	for( size_t n=0; n < mOutputs.size(); n++ )
 	{
-		mNumClasses = DIMS_C(mOutputs[OUTPUT_CVG].dims);
-		mMaxDetections = DIMS_W(mOutputs[OUTPUT_CVG].dims) * DIMS_H(mOutputs[OUTPUT_CVG].dims) /** DIMS_C(mOutputs[OUTPUT_CVG].dims)*/ * mNumClasses;
-		printf("detectNet -- number object classes:   %u\n", mNumClasses);
+		outputs[n].data    = NULL;
+		outputs[n].dims[0] = DIMS_C(mOutputs[n].dims);
+		outputs[n].dims[1] = DIMS_H(mOutputs[n].dims);
+		outputs[n].dims[2] = DIMS_W(mOutputs[n].dims);
 	}
 
-	printf("detectNet -- maximum bounding boxes:  %u\n", mMaxDetections);
+	if( !decoder->Configure(outputs, DIMS_W(mInputDims), DIMS_H(mInputDims)) )
+	{
+		printf("detectNet -- the outputs of the network don't fit the '%s' decoder\n", decoder->GetName());
+		delete decoder;
+		return false;
+	}
+
+	// make sure the ringbuffer can hold two full batches of results
+	if( mNumDetectionSets < mMaxBatchSize * 2 )
+		mNumDetectionSets = mMaxBatchSize * 2;
 
 	// allocate array to store detection results
-	const size_t det_size = sizeof(Detection) * mNumDetectionSets * mMaxDetections;
+	const uint32_t maxDetections = decoder->GetMaxDetections();
+	const size_t det_size = sizeof(Detection) * mNumDetectionSets * maxDetections;
 
-	if( !cudaAllocMapped((void**)&mDetectionSets[0], (void**)&mDetectionSets[1], det_size) )
+	Detection* detectionSets[] = { NULL, NULL };
+
+	if( !cudaAllocMapped((void**)&detectionSets[0], (void**)&detectionSets[1], det_size) )
+	{
+		delete decoder;
 		return false;
+	}
+
+	memset(detectionSets[0], 0, det_size);
+
+	if( mDetectionSets[0] != NULL )
+		CUDA(cudaFreeHost(mDetectionSets[0]));
+
+	if( mDecoder != NULL )
+		delete mDecoder;
+
+	freeDeviceDetections();	// reallocated for the new decoder by DetectDevice()
+
+	mDecoder          = decoder;
+	mDecoderOutputs   = outputs;
+	mDetectionSets[0] = detectionSets[0];
+	mDetectionSets[1] = detectionSets[1];
+	mDetectionSet     = 0;
+	mMaxDetections    = maxDetections;
+
+	printf("detectNet -- using the '%s' decoder\n", mDecoder->GetName());
+	printf("detectNet -- maximum bounding boxes:  %u\n", mMaxDetections);
+
+	// update the number of classes (unless the outputs don't encode it, then it's from the class labels)
+	const uint32_t numClasses = mDecoder->GetNumClasses();
+
+	if( numClasses > 0 && numClasses != mNumClasses )
+	{
+		mNumClasses = numClasses;
+		printf("detectNet -- number object classes:   %u\n", mNumClasses);
+
+		// if the network was already initialized, reset the class info and colors
+		if( mClassColors[0] != NULL )
+		{
+			defaultClassDesc();
+
+			CUDA(cudaFreeHost(mClassColors[0]));
+
+			mClassColors[0] = NULL;
+			mClassColors[1] = NULL;
+
+			if( !defaultColors() )
+				return false;
+		}
+	}
 
-	memset(mDetectionSets[0], 0, det_size);
 	return true;
 }
 
@@ -346,41 +452,7 @@ bool detectNet::loadClassDesc( const char* filename )
 	}
 
 	// read class descriptions
-	char str[512];
-
-	while( fgets(str, 512, f) != NULL )
-	{
-		const int syn = 9;  // length of synset prefix (in characters)
-		const int len = strlen(str);
-
-		if( len > syn && str[0] == 'n' && str[syn] == ' ' )
-		{
-			str[syn]   = 0;
-			str[len-1] = 0;
-
-			const std::string a = str;
-			const std::string b = (str + syn + 1);
-
-			//printf("a=%s b=%s\n", a.c_str(), b.c_str());
-
-			mClassSynset.push_back(a);
-			mClassDesc.push_back(b);
-		}
-		else if( len > 0 )	// no 9-character synset prefix (i.e. from DIGITS snapshot)
-		{
-			char a[10];
-			sprintf(a, "n%08u", mCustomClasses);
-
-			//printf("a=%s b=%s (custom non-synset)\n", a, str);
-			mCustomClasses++;
-
-			if( str[len-1] == '\n' )
-				str[len-1] = 0;
-
-			mClassSynset.push_back(a);
-			mClassDesc.push_back(str);
-		}
-	}
+	readClassInfo(f, mClassDesc, mClassSynset, &mCustomClasses);
 
 	fclose(f);
 
@@ -392,7 +464,7 @@ bool detectNet::loadClassDesc( const char* filename )
 	if( mClassDesc.size() == 0 )
 		return false;
 
-	if( IsModelType(MODEL_UFF) )
+	if( mDecoder != NULL && mDecoder->GetNumClasses() == 0 )	// the outputs don't encode the classes (i.e. SSD)
 		mNumClasses = mClassDesc.size();
 
 	printf("detectNet -- number of object classes:  %u\n", mNumClasses);
@@ -519,6 +591,8 @@ detectNet* detectNet::Create( int argc, char** argv )
 	if( maxBatchSize < 1 )
 		maxBatchSize = DEFAULT_MAX_BATCH_SIZE;
 
+	const precisionType precision = precisionTypeFromStr(cmdLine.GetString("precision", "fastest"));
+
 	//if( argc > 3 )
 	//	modelName = argv[3];
 
@@ -539,6 +613,8 @@ detectNet* detectNet::Create( int argc, char** argv )
 	else if( strcasecmp(modelName, "coco-dog") == 0 || strcasecmp(modelName, "dog") == 0 )
 		type = detectNet::COCO_DOG;
 	else*/
+	detectNet* net = NULL;
+
 	if( type == detectNet::CUSTOM )
 	{
 		const char* prototxt     = cmdLine.GetString("prototxt");
@@ -559,12 +635,98 @@ detectNet* detectNet::Create( int argc, char** argv )
 
 		float meanPixel = cmdLine.GetFloat("mean_pixel");
 
-		return detectNet::Create(prototxt, modelName, meanPixel, class_labels, threshold, input,
-							out_blob ? NULL : out_cvg, out_blob ? out_blob : out_bbox, maxBatchSize);
+		net = detectNet::Create(prototxt, modelName, meanPixel, class_labels, threshold, input,
+						    out_blob ? NULL : out_cvg, out_blob ? out_blob : out_bbox, maxBatchSize);
+	}
+	else
+	{
+		// create detectNet from pretrained model
+		net = detectNet::Create(type, threshold, maxBatchSize, precision);
 	}
 
-	// create segnet from pretrained model
-	return detectNet::Create(type, threshold, maxBatchSize);
+	if( !net )
+		return NULL;
+
+	// select the decoder of the outputs
+	const char* decoder = cmdLine.GetString("decoder");
+
+	if( decoder != NULL && !net->SetDecoder(decoder) )
+	{
+		delete net;
+		return NULL;
+	}
+
+	// render the overlay onto a downscaled preview
+	const char* preview = cmdLine.GetString("preview");
+
+	if( preview != NULL )
+	{
+		uint32_t previewWidth  = 0;
+		uint32_t previewHeight = 0;
+
+		if( sscanf(preview, "%ux%u", &previewWidth, &previewHeight) != 2 || !net->SetPreview(previewWidth, previewHeight) )
+		{
+			printf(LOG_TRT "detectNet -- invalid preview size '%s' (expected WIDTHxHEIGHT)\n", preview);
+			delete net;
+			return NULL;
+		}
+	}
+
+	// run the network on synthetic frames until its latency converges
+	if( cmdLine.GetFlag("warmup") && !net->Warmup(cmdLine.GetInt("warmup", WARMUP_DEFAULT_ITERATIONS)) )
+	{
+		delete net;
+		return NULL;
+	}
+
+	// record the outputs for offline replay
+	const char* recording = cmdLine.GetString("record");
+
+	if( recording != NULL && !net->EnableRecording(recording) )
+	{
+		delete net;
+		return NULL;
+	}
+
+	return net;
+}
+
+
+// inputRange
+float detectNet::inputRange() const
+{
+	if( IsModelType(MODEL_UFF) )
+		return cudaPreImageNetNormRange(gUffRange);
+	else if( IsModelType(MODEL_ONNX) )
+		return cudaPreImageNetNormMeanRange(gOnnxRange, gOnnxMean, gOnnxStdDev);
+	else if( mMeanPixel != 0.0f )
+		return cudaPreImageNetMeanRange(make_float3(mMeanPixel, mMeanPixel, mMeanPixel));
+
+	return cudaPreImageNetRange();
+}
+
+
+// warmupIteration
+bool detectNet::warmupIteration( float* rgba, uint32_t width, uint32_t height )
+{
+	Detection* detections = NULL;
+	const int numDetections = Detect(rgba, width, height, &detections, OVERLAY_NONE);
+
+	if( numDetections < 0 || !detections )
+		return false;
+
+	// the synthetic image rarely has objects in it, so overlay one to run the visualization kernel
+	if( numDetections == 0 )
+	{
+		memset(detections, 0, sizeof(Detection));
+
+		detections[0].Left   = width * 0.25f;
+		detections[0].Right  = width * 0.75f;
+		detections[0].Top    = height * 0.25f;
+		detections[0].Bottom = height * 0.75f;
+	}
+
+	return Overlay(rgba, rgba, width, height, detections, (numDetections > 0) ? numDetections : 1, OVERLAY_BOX);
 }
 
 
@@ -580,19 +742,28 @@ inline static bool rectOverlap(const float6& r1, const float6& r2)
 #endif
 
 
-// Detect
-int detectNet::Detect( float* input, uint32_t width, uint32_t height, Detection** detections, uint32_t overlay )
+// nextDetectionSet
+detectNet::Detection* detectNet::nextDetectionSet()
 {
 	Detection* det = mDetectionSets[0] + mDetectionSet * GetMaxDetections();
 
-	if( detections != NULL )
-		*detections = det;
-
 	mDetectionSet++;
 
 	if( mDetectionSet >= mNumDetectionSets )
 		mDetectionSet = 0;
 
+	return det;
+}
+
+
+// Detect
+int detectNet::Detect( float* input, uint32_t width, uint32_t height, Detection** detections, uint32_t overlay )
+{
+	Detection* det = nextDetectionSet();
+
+	if( detections != NULL )
+		*detections = det;
+
 	return Detect(input, width, height, det, overlay);
 }
 
@@ -608,25 +779,143 @@ int detectNet::Detect( float* rgba, uint32_t width, uint32_t height, Detection*
 
 	PROFILER_BEGIN(PROFILER_PREPROCESS);
 
+	if( !preProcess(rgba, width, height, 0) )
+		return -1;
+
+	PROFILER_END(PROFILER_PREPROCESS);
+	PROFILER_BEGIN(PROFILER_NETWORK);
+
+	// process with TensorRT
+	void* inferenceBuffers[] = { mInputCUDA, mOutputs[0].CUDA, (mOutputs.size() > 1) ? mOutputs[1].CUDA : NULL };
+
+	if( !selectContext(1)->execute(1, inferenceBuffers) )
+	{
+		printf(LOG_TRT "detectNet::Detect() -- failed to execute TensorRT context\n");
+		return -1;
+	}
+
+	convertOutputs(1);
+
+	PROFILER_END(PROFILER_NETWORK);
+	PROFILER_BEGIN(PROFILER_POSTPROCESS);
+
+	// post-processing / clustering
+	const int numDetections = postProcess(detections, width, height, 0);
+
+	PROFILER_END(PROFILER_POSTPROCESS);
+
+	recordOutputs(width, height, 1);
+
+	// render the overlay
+	if( overlay != 0 && mPreview[1] != NULL && numDetections >= 0 )
+	{
+		if( !OverlayPreview(rgba, width, height, detections, numDetections, overlay) )
+			printf(LOG_TRT "detectNet::Detect() -- failed to render preview\n");
+	}
+	else if( overlay != 0 && numDetections > 0 )
+	{
+		if( !Overlay(rgba, rgba, width, height, detections, numDetections, overlay) )
+			printf(LOG_TRT "detectNet::Detect() -- failed to render overlay\n");
+	}
+
+	return numDetections;
+}
+
+
+// DetectBatch
+bool detectNet::DetectBatch( float** rgba, uint32_t width, uint32_t height, uint32_t batchSize, Detection** detections, int* numDetections, uint32_t overlay )
+{
+	if( !rgba || width == 0 || height == 0 || !detections || !numDetections )
+	{
+		printf(LOG_TRT "detectNet::DetectBatch( 0x%p, %u, %u ) -> invalid parameters\n", rgba, width, height);
+		return false;
+	}
+
+	if( batchSize == 0 || batchSize > mMaxBatchSize )
+	{
+		printf(LOG_TRT "detectNet::DetectBatch() -- invalid batch size %u (max batch size is %u)\n", batchSize, mMaxBatchSize);
+		return false;
+	}
+
+	// pre-process each image into its entry of the input tensor
+	PROFILER_BEGIN(PROFILER_PREPROCESS);
+
+	for( uint32_t n=0; n < batchSize; n++ )
+	{
+		if( !rgba[n] || !preProcess(rgba[n], width, height, n) )
+		{
+			printf(LOG_TRT "detectNet::DetectBatch() -- failed to pre-process image %u of the batch\n", n);
+			return false;
+		}
+	}
+
+	PROFILER_END(PROFILER_PREPROCESS);
+	PROFILER_BEGIN(PROFILER_NETWORK);
+
+	// process the whole batch with TensorRT
+	void* inferenceBuffers[] = { mInputCUDA, mOutputs[0].CUDA, (mOutputs.size() > 1) ? mOutputs[1].CUDA : NULL };
+
+	if( !selectContext(batchSize)->execute(batchSize, inferenceBuffers) )
+	{
+		printf(LOG_TRT "detectNet::DetectBatch() -- failed to execute TensorRT context\n");
+		return false;
+	}
+
+	convertOutputs(batchSize);
+
+	PROFILER_END(PROFILER_NETWORK);
+	PROFILER_BEGIN(PROFILER_POSTPROCESS);
+
+	// post-processing / clustering of each entry in the batch
+	for( uint32_t n=0; n < batchSize; n++ )
+	{
+		detections[n]    = nextDetectionSet();
+		numDetections[n] = postProcess(detections[n], width, height, n);
+	}
+
+	PROFILER_END(PROFILER_POSTPROCESS);
+
+	recordOutputs(width, height, batchSize);
+
+	// render the overlays
+	if( overlay != 0 )
+	{
+		for( uint32_t n=0; n < batchSize; n++ )
+		{
+			if( numDetections[n] <= 0 )
+				continue;
+
+			if( !Overlay(rgba[n], rgba[n], width, height, detections[n], numDetections[n], overlay) )
+				printf(LOG_TRT "detectNet::DetectBatch() -- failed to render overlay\n");
+		}
+	}
+
+	return true;
+}
+
+
+// preProcess
+bool detectNet::preProcess( float* rgba, uint32_t width, uint32_t height, uint32_t batchIndex )
+{
+	float* input = GetInputBatch(batchIndex);
+
 	if( IsModelType(MODEL_UFF) )
 	{
-		if( CUDA_FAILED(cudaPreImageNetNormBGR((float4*)rgba, width, height, mInputCUDA, mWidth, mHeight,
-										  make_float2(-1.0f, 1.0f), GetStream())) )
+		if( CUDA_FAILED(cudaPreImageNetNormBGR((float4*)rgba, width, height, input, mWidth, mHeight,
+										  gUffRange, GetStream(), GetInputType())) )
 		{
 			printf(LOG_TRT "detectNet::Detect() -- cudaPreImageNetNorm() failed\n");
-			return -1;
+			return false;
 		}
 	}
 	else if( IsModelType(MODEL_ONNX) )
 	{
 		// downsample, convert to band-sequential RGB, and apply pixel normalization, mean pixel subtraction and standard deviation
-		if( CUDA_FAILED(cudaPreImageNetNormMeanRGB((float4*)rgba, width, height, mInputCUDA, mWidth, mHeight,
-										   make_float2(0.0f, 1.0f),
-										   make_float3(0.485f, 0.456f, 0.406f),
-										   make_float3(0.229f, 0.224f, 0.225f),
-										   GetStream())) )
+		if( CUDA_FAILED(cudaPreImageNetNormMeanRGB((float4*)rgba, width, height, input, mWidth, mHeight,
+										   gOnnxRange, gOnnxMean, gOnnxStdDev,
+										   GetStream(), GetInputType())) )
 		{
-			printf(LOG_TRT "imageNet::PreProcess() -- cudaPreImageNetNormMeanRGB() failed\n");
+			printf(LOG_TRT "detectNet::Detect() -- cudaPreImageNetNormMeanRGB() failed\n");
 			return false;
 		}
 	}
@@ -634,203 +923,232 @@ int detectNet::Detect( float* rgba, uint32_t width, uint32_t height, Detection*
 	{
 		if( mMeanPixel != 0.0f )
 		{
-			if( CUDA_FAILED(cudaPreImageNetMeanBGR((float4*)rgba, width, height, mInputCUDA, mWidth, mHeight,
-										  make_float3(mMeanPixel, mMeanPixel, mMeanPixel), GetStream())) )
+			if( CUDA_FAILED(cudaPreImageNetMeanBGR((float4*)rgba, width, height, input, mWidth, mHeight,
+										  make_float3(mMeanPixel, mMeanPixel, mMeanPixel), GetStream(), GetInputType())) )
 			{
 				printf(LOG_TRT "detectNet::Detect() -- cudaPreImageNetMean() failed\n");
-				return -1;
+				return false;
 			}
 		}
 		else
 		{
-			if( CUDA_FAILED(cudaPreImageNetBGR((float4*)rgba, width, height, mInputCUDA, mWidth, mHeight, GetStream())) )
+			if( CUDA_FAILED(cudaPreImageNetBGR((float4*)rgba, width, height, input, mWidth, mHeight, GetStream(), GetInputType())) )
 			{
 				printf(LOG_TRT "detectNet::Detect() -- cudaPreImageNet() failed\n");
-				return -1;
+				return false;
 			}
 		}
 	}
 
-	PROFILER_END(PROFILER_PREPROCESS);
-	PROFILER_BEGIN(PROFILER_NETWORK);
+	return true;
+}
 
-	// process with TensorRT
-	void* inferenceBuffers[] = { mInputCUDA, mOutputs[0].CUDA, mOutputs[1].CUDA };
 
-	if( !mContext->execute(1, inferenceBuffers) )
+// PostProcess
+int detectNet::PostProcess( uint32_t width, uint32_t height, Detection** detections, uint32_t batchIndex )
+{
+	if( width == 0 || height == 0 || !detections || batchIndex >= mMaxBatchSize )
 	{
-		printf(LOG_TRT "detectNet::Detect() -- failed to execute TensorRT context\n");
+		printf(LOG_TRT "detectNet::PostProcess( %u, %u ) -> invalid parameters\n", width, height);
 		return -1;
 	}
 
-	PROFILER_END(PROFILER_NETWORK);
+	*detections = nextDetectionSet();
+
 	PROFILER_BEGIN(PROFILER_POSTPROCESS);
+	const int numDetections = postProcess(*detections, width, height, batchIndex);
+	PROFILER_END(PROFILER_POSTPROCESS);
 
-	// post-processing / clustering
-	int numDetections = 0;
+	return numDetections;
+}
 
-	if( IsModelType(MODEL_UFF) )
-	{
-		const int rawDetections = *(int*)mOutputs[OUTPUT_NUM].CPU;
-		const int rawParameters = DIMS_W(mOutputs[OUTPUT_UFF].dims);
 
-#ifdef DEBUG_CLUSTERING
-		printf(LOG_TRT "detectNet::Detect() -- %i unfiltered detections\n", rawDetections);
-#endif
+// postProcess
+int detectNet::postProcess( Detection* detections, uint32_t width, uint32_t height, uint32_t batchIndex )
+{
+	for( size_t n=0; n < mDecoderOutputs.size(); n++ )
+		mDecoderOutputs[n].data = GetOutputBatch(n, batchIndex);
+
+	const int numDetections = mDecoder->Decode(mDecoderOutputs, width, height, mCoverageThreshold, detections);
 
-		// filter the raw detections by thresholding the confidence
-		for( int n=0; n < rawDetections; n++ )
+	for( int n=0; n < numDetections; n++ )
+	{
+		if( detections[n].ClassID >= mNumClasses )
 		{
-			float* object_data = mOutputs[OUTPUT_UFF].CPU + n * rawParameters;
+			printf(LOG_TRT "detectNet::Detect() -- detected object has invalid classID (%u)\n", detections[n].ClassID);
+			detections[n].ClassID = 0;
+		}
+	}
 
-			if( object_data[2] < mCoverageThreshold )
-				continue;
+	return numDetections;
+}
 
-			detections[numDetections].Instance   = numDetections; //(uint32_t)object_data[0];
-			detections[numDetections].ClassID    = (uint32_t)object_data[1];
-			detections[numDetections].Confidence = object_data[2];
-			detections[numDetections].Left       = object_data[3] * width;
-			detections[numDetections].Top        = object_data[4] * height;
-			detections[numDetections].Right      = object_data[5] * width;
-			detections[numDetections].Bottom	  = object_data[6] * height;
 
-			if( detections[numDetections].ClassID >= mNumClasses )
-			{
-				printf(LOG_TRT "detectNet::Detect() -- detected object has invalid classID (%u)\n", detections[numDetections].ClassID);
-				detections[numDetections].ClassID = 0;
-			}
+// from detectNet.cu
+cudaError_t cudaDetectionOverlay( float4* input, float4* output, uint32_t width, uint32_t height, detectNet::Detection* detections, int numDetections, float4* colors );
+cudaError_t cudaDetectionOverlay( float4* input, float4* output, uint32_t width, uint32_t height, detectNet::Detection* detections, const int* count, uint32_t capacity, float4* colors, cudaStream_t stream );
+cudaError_t cudaDetectionPreview( float4* input, uint32_t width, uint32_t height, float4* output, uint32_t previewWidth, uint32_t previewHeight,
+						    detectNet::Detection* detections, int numDetections, float4* colors, cudaStream_t stream );
+
+cudaError_t cudaDetectionDecode( const char* decoder, void** outputs, const uint32_t* params, float threshold, uint32_t numClasses,
+						   float overlapThreshold, uint32_t width, uint32_t height, detectNet::Detection* detections,
+						   int* count, uint32_t capacity, detectNet::Detection* scratch, int* scratchCount, uint32_t rows,
+						   cudaStream_t stream );
 
-			numDetections++;
-		}
-	}
-	else if( IsModelType(MODEL_ONNX) )
-	{
-		float* coord = mOutputs[0].CPU;
 
-		coord[0] = ((coord[0] + 1.0f) * 0.5f) * float(width);
-		coord[1] = ((coord[1] + 1.0f) * 0.5f) * float(height);
-		coord[2] = ((coord[2] + 1.0f) * 0.5f) * float(width);
-		coord[3] = ((coord[3] + 1.0f) * 0.5f) * float(height);
+// allocDeviceDetections
+bool detectNet::allocDeviceDetections()
+{
+	if( mDeviceDetections != NULL )
+		return true;
+
+	const uint32_t capacity = (mMaxDetections < DETECTNET_DEVICE_CAPACITY) ? mMaxDetections : DETECTNET_DEVICE_CAPACITY;
+	const uint32_t rows     = (mDecoder->GetMaxDetections() > 0) ? mDecoder->GetMaxDetections() : 1;
+
+	// the results are followed by scratch space for sorting them, and a candidate for every row of the outputs
+	// (so that the candidates above the threshold are never dropped before they're sorted)
+	if( CUDA_FAILED(cudaMalloc((void**)&mDeviceDetections, (capacity * 2 + rows) * sizeof(Detection))) )
+		return false;
 
-		printf(LOG_TRT "detectNet::Detect() -- ONNX -- coord (%f, %f) (%f, %f)  image %ux%u\n", coord[0], coord[1], coord[2], coord[3], width, height);
+	// the number of results, followed by the number of candidates
+	if( CUDA_FAILED(cudaMalloc((void**)&mDeviceCount, sizeof(int) * 2)) )
+		return false;
+
+	if( !cudaAllocMapped((void**)&mDownloadCounts[0], (void**)&mDownloadCounts[1], mNumDetectionSets * sizeof(int)) )
+		return false;
+
+	mDeviceCapacity = capacity;
+	mDeviceRows     = rows;
+	return true;
+}
+
+
+// freeDeviceDetections
+void detectNet::freeDeviceDetections()
+{
+	if( mDeviceDetections != NULL )
+		CUDA(cudaFree(mDeviceDetections));
 
-		detections[numDetections].Instance   = numDetections;
-		detections[numDetections].ClassID    = 0;
-		detections[numDetections].Confidence = 1;
-		detections[numDetections].Left       = coord[0];
-		detections[numDetections].Top        = coord[1];
-		detections[numDetections].Right      = coord[2];
-		detections[numDetections].Bottom	  = coord[3];
+	if( mDeviceCount != NULL )
+		CUDA(cudaFree(mDeviceCount));
 
-		numDetections++;
+	if( mDownloadCounts[0] != NULL )
+		CUDA(cudaFreeHost(mDownloadCounts[0]));
+
+	mDeviceDetections  = NULL;
+	mDeviceCount       = NULL;
+	mDeviceCapacity    = 0;
+	mDeviceRows        = 0;
+	mDownloadCounts[0] = NULL;
+	mDownloadCounts[1] = NULL;
+}
+
+
+// DetectDevice
+bool detectNet::DetectDevice( float* rgba, uint32_t width, uint32_t height, DeviceDetections* results )
+{
+	if( !rgba || width == 0 || height == 0 || !results )
+	{
+		printf(LOG_TRT "detectNet::DetectDevice( 0x%p, %u, %u ) -> invalid parameters\n", rgba, width, height);
+		return false;
 	}
-	else
+
+	if( !allocDeviceDetections() )
 	{
-		// cluster detections
-		numDetections = clusterDetections(detections, width, height);
+		printf(LOG_TRT "detectNet::DetectDevice() -- failed to allocate device memory for the results\n");
+		return false;
 	}
 
-	PROFILER_END(PROFILER_POSTPROCESS);
+	results->detections = mDeviceDetections;
+	results->count      = mDeviceCount;
+	results->capacity   = mDeviceCapacity;
 
-	// render the overlay
-	if( overlay != 0 && numDetections > 0 )
+	// the decoder parameters of the kernels, in the order that cudaDetectionDecode() expects
+	const char* decoder = mDecoder->GetName();
+	uint32_t params[4] = { mDecoder->GetMaxDetections(), mDecoder->GetNumClasses(), DIMS_W(mInputDims), DIMS_H(mInputDims) };
+
+	if( strcasecmp(decoder, "ssd") == 0 )
+		params[1] = mDecoderOutputs[0].Columns();
+
+	const bool deviceDecoder = (strcasecmp(decoder, "ssd") == 0 || strcasecmp(decoder, "anchor") == 0 ||
+						   strcasecmp(decoder, "yolo") == 0 || strcasecmp(decoder, "box") == 0);
+
+	if( !deviceDecoder || GetOutputType(0) != TYPE_FP32 )	// the kernels read float outputs
 	{
-		if( !Overlay(rgba, rgba, width, height, detections, numDetections, overlay) )
-			printf(LOG_TRT "detectNet::Detect() -- failed to render overlay\n");
-	}
+		// decode on the CPU and upload the results
+		Detection* detections = NULL;
+		const int numDetections = Detect(rgba, width, height, &detections, OVERLAY_NONE);
 
-	return numDetections;
-}
+		if( numDetections < 0 )
+			return false;
 
+		const int count = (numDetections < (int)mDeviceCapacity) ? numDetections : mDeviceCapacity;
 
+		if( CUDA_FAILED(cudaMemcpyAsync(mDeviceDetections, detections, count * sizeof(Detection), cudaMemcpyHostToDevice, GetStream())) ||
+		    CUDA_FAILED(cudaMemcpyAsync(mDeviceCount, &count, sizeof(int), cudaMemcpyHostToDevice, GetStream())) )
+			return false;
 
-// clusterDetections
-int detectNet::clusterDetections( Detection* detections, uint32_t width, uint32_t height )
-{
-	// cluster detection bboxes
-	float* net_cvg   = mOutputs[OUTPUT_CVG].CPU;
-	float* net_rects = mOutputs[OUTPUT_BBOX].CPU;
+		return true;
+	}
 
-	const int ow  = DIMS_W(mOutputs[OUTPUT_BBOX].dims);	// number of columns in bbox grid in X dimension
-	const int oh  = DIMS_H(mOutputs[OUTPUT_BBOX].dims);	// number of rows in bbox grid in Y dimension
-	const int owh = ow * oh;							// total number of bbox in grid
-	const int cls = GetNumClasses();					// number of object classes in coverage map
+	PROFILER_BEGIN(PROFILER_PREPROCESS);
+
+	if( !preProcess(rgba, width, height, 0) )
+		return false;
 
-	const float cell_width  = /*width*/ DIMS_W(mInputDims) / ow;
-	const float cell_height = /*height*/ DIMS_H(mInputDims) / oh;
+	PROFILER_END(PROFILER_PREPROCESS);
+	PROFILER_BEGIN(PROFILER_NETWORK);
 
-	const float scale_x = float(width) / float(DIMS_W(mInputDims));
-	const float scale_y = float(height) / float(DIMS_H(mInputDims));
+	// queue the network without waiting for it
+	void* inferenceBuffers[] = { mInputCUDA, mOutputs[0].CUDA, (mOutputs.size() > 1) ? mOutputs[1].CUDA : NULL };
 
-#ifdef DEBUG_CLUSTERING
-	printf("input width %i height %i\n", (int)DIMS_W(mInputDims), (int)DIMS_H(mInputDims));
-	printf("cells x %i  y %i\n", ow, oh);
-	printf("cell width %f  height %f\n", cell_width, cell_height);
-	printf("scale x %f  y %f\n", scale_x, scale_y);
-#endif
+	if( !selectContext(1)->enqueue(1, inferenceBuffers, GetStream(), NULL) )
+	{
+		printf(LOG_TRT "detectNet::DetectDevice() -- failed to enqueue TensorRT context\n");
+		return false;
+	}
+
+	PROFILER_END(PROFILER_NETWORK);
+	PROFILER_BEGIN(PROFILER_POSTPROCESS);
 
-	// extract and cluster the raw bounding boxes that meet the coverage threshold
-	int numDetections = 0;
+	// decode the outputs into the device array
+	void* outputs[] = { mOutputs[0].CUDA, (mOutputs.size() > 1) ? mOutputs[1].CUDA : NULL };
 
-	for( uint32_t z=0; z < cls; z++ )	// z = current object class
+	if( CUDA_FAILED(cudaDetectionDecode(decoder, outputs, params, mCoverageThreshold, mNumClasses,
+								 mDecoder->GetOverlapThreshold(), width, height,
+								 mDeviceDetections, mDeviceCount, mDeviceCapacity,
+								 mDeviceDetections + mDeviceCapacity, mDeviceCount + 1, mDeviceRows, GetStream())) )
 	{
-		for( uint32_t y=0; y < oh; y++ )
-		{
-			for( uint32_t x=0; x < ow; x++)
-			{
-				const float coverage = net_cvg[z * owh + y * ow + x];
-
-				if( coverage > mCoverageThreshold )
-				{
-					const float mx = x * cell_width;
-					const float my = y * cell_height;
-
-					const float x1 = (net_rects[0 * owh + y * ow + x] + mx) * scale_x;	// left
-					const float y1 = (net_rects[1 * owh + y * ow + x] + my) * scale_y;	// top
-					const float x2 = (net_rects[2 * owh + y * ow + x] + mx) * scale_x;	// right
-					const float y2 = (net_rects[3 * owh + y * ow + x] + my) * scale_y;	// bottom
-
-				#ifdef DEBUG_CLUSTERING
-					printf("rect x=%u y=%u  cvg=%f  %f %f   %f %f \n", x, y, coverage, x1, x2, y1, y2);
-				#endif
-
-					// merge with list, checking for overlaps
-					bool detectionMerged = false;
-
-					for( uint32_t n=0; n < numDetections; n++ )
-					{
-						if( detections[n].ClassID == z && detections[n].Expand(x1, y1, x2, y2) )
-						{
-							detectionMerged = true;
-							break;
-						}
-					}
-
-					// create new entry if the detection wasn't merged with another detection
-					if( !detectionMerged )
-					{
-						detections[numDetections].Instance   = numDetections;
-						detections[numDetections].ClassID    = z;
-						detections[numDetections].Confidence = coverage;
-
-						detections[numDetections].Left   = x1;
-						detections[numDetections].Top    = y1;
-						detections[numDetections].Right  = x2;
-						detections[numDetections].Bottom = y2;
-
-						numDetections++;
-					}
-				}
-			}
-		}
+		printf(LOG_TRT "detectNet::DetectDevice() -- failed to decode the outputs with the '%s' decoder\n", decoder);
+		return false;
 	}
 
-	return numDetections;
+	PROFILER_END(PROFILER_POSTPROCESS);
+	return true;
 }
 
 
-// from detectNet.cu
-cudaError_t cudaDetectionOverlay( float4* input, float4* output, uint32_t width, uint32_t height, detectNet::Detection* detections, int numDetections, float4* colors );
+// DownloadDetections
+bool detectNet::DownloadDetections( Detection** detections, int** numDetections )
+{
+	if( !detections || !numDetections || !mDeviceDetections )
+	{
+		printf(LOG_TRT "detectNet::DownloadDetections() -- invalid parameters, or DetectDevice() wasn't called\n");
+		return false;
+	}
+
+	Detection* det = nextDetectionSet();
+	int* count = mDownloadCounts[0] + (det - mDetectionSets[0]) / GetMaxDetections();
+
+	if( CUDA_FAILED(cudaMemcpyAsync(det, mDeviceDetections, mDeviceCapacity * sizeof(Detection), cudaMemcpyDeviceToHost, GetStream())) ||
+	    CUDA_FAILED(cudaMemcpyAsync(count, mDeviceCount, sizeof(int), cudaMemcpyDeviceToHost, GetStream())) )
+		return false;
+
+	*detections    = det;
+	*numDetections = count;
+
+	return true;
+}
 
 // Overlay
 bool detectNet::Overlay( float* input, float* output, uint32_t width, uint32_t height, Detection* detections, uint32_t numDetections, uint32_t flags )
@@ -853,32 +1171,143 @@ bool detectNet::Overlay( float* input, float* output, uint32_t width, uint32_t h
 	// class label overlay
 	if( flags & OVERLAY_LABEL )
 	{
-		static cudaFont* font = NULL;
+		if( !overlayLabels(input, width, height, detections, numDetections) )
+			return false;
+	}
 
-		// make sure the font object is created
-		if( !font )
-		{
-			font = cudaFont::Create();
+	PROFILER_END(PROFILER_VISUALIZE);
+	return true;
+}
 
-			if( !font )
-			{
-				printf(LOG_TRT "detectNet -- Overlay() was called with OVERLAY_FONT, but failed to create cudaFont()\n");
-				return false;
-			}
-		}
 
-		// draw each object's description
-		std::vector< std::pair< std::string, int2 > > labels;
+// overlayLabels
+bool detectNet::overlayLabels( float* image, uint32_t width, uint32_t height, Detection* detections, uint32_t numDetections, float scale_x, float scale_y )
+{
+	static cudaFont* font = NULL;
+
+	// make sure the font object is created
+	if( !font )
+	{
+		font = cudaFont::Create();
 
-		for( uint32_t n=0; n < numDetections; n++ )
+		if( !font )
 		{
-			labels.push_back( std::pair<std::string, int2>( GetClassDesc(detections[n].ClassID),
-												   make_int2(detections[n].Left, detections[n].Top) ) );
+			printf(LOG_TRT "detectNet -- Overlay() was called with OVERLAY_FONT, but failed to create cudaFont()\n");
+			return false;
 		}
+	}
+
+	// draw each object's description
+	std::vector< std::pair< std::string, int2 > > labels;
+
+	for( uint32_t n=0; n < numDetections; n++ )
+	{
+		labels.push_back( std::pair<std::string, int2>( GetClassDesc(detections[n].ClassID),
+											   make_int2(detections[n].Left * scale_x, detections[n].Top * scale_y) ) );
+	}
+
+	font->OverlayText((float4*)image, width, height, labels, make_float4(255,255,255,255));
+	return true;
+}
+
+
+// SetPreview
+bool detectNet::SetPreview( uint32_t width, uint32_t height )
+{
+	if( width == mPreviewWidth && height == mPreviewHeight )
+		return true;
+
+	if( mPreview[0] != NULL )
+	{
+		CUDA(cudaFreeHost(mPreview[0]));
+
+		mPreview[0] = NULL;
+		mPreview[1] = NULL;
+	}
 
-		font->OverlayText((float4*)input, width, height, labels, make_float4(255,255,255,255));
+	if( mPreviewEvent != NULL )
+	{
+		CUDA(cudaEventDestroy(mPreviewEvent));
+		mPreviewEvent = NULL;
 	}
 
+	mPreviewWidth  = 0;
+	mPreviewHeight = 0;
+
+	if( width == 0 || height == 0 )
+		return true;
+
+	if( !cudaAllocMapped((void**)&mPreview[0], (void**)&mPreview[1], width * height * sizeof(float4)) )
+	{
+		printf(LOG_TRT "detectNet -- failed to allocate the %ux%u preview\n", width, height);
+		return false;
+	}
+
+	// orders the labels (drawn on the default stream) after the preview kernel
+	if( CUDA_FAILED(cudaEventCreateWithFlags(&mPreviewEvent, cudaEventDisableTiming)) )
+	{
+		CUDA(cudaFreeHost(mPreview[0]));
+
+		mPreview[0]   = NULL;
+		mPreview[1]   = NULL;
+		mPreviewEvent = NULL;
+
+		return false;
+	}
+
+	mPreviewWidth  = width;
+	mPreviewHeight = height;
+
+	return true;
+}
+
+
+// OverlayPreview
+bool detectNet::OverlayPreview( float* input, uint32_t width, uint32_t height, Detection* detections, uint32_t numDetections, uint32_t flags )
+{
+	if( !mPreview[1] )
+	{
+		printf(LOG_TRT "detectNet -- OverlayPreview() was called without a preview (@see SetPreview())\n");
+		return false;
+	}
+
+	PROFILER_BEGIN(PROFILER_VISUALIZE);
+
+	// resample the input and draw the bounding boxes in the same pass
+	if( CUDA_FAILED(cudaDetectionPreview((float4*)input, width, height, (float4*)mPreview[1], mPreviewWidth, mPreviewHeight,
+								  detections, (flags & OVERLAY_BOX) ? numDetections : 0, (float4*)mClassColors[1], GetStream())) )
+		return false;
+
+	// the labels are drawn onto the preview by cudaFont on the default stream, which doesn't
+	// wait for a non-blocking stream, so the passes are ordered with an event both ways
+	if( (flags & OVERLAY_LABEL) && numDetections > 0 )
+	{
+		if( CUDA_FAILED(cudaEventRecord(mPreviewEvent, GetStream())) || CUDA_FAILED(cudaStreamWaitEvent(NULL, mPreviewEvent, 0)) )
+			return false;
+
+		if( !overlayLabels(mPreview[1], mPreviewWidth, mPreviewHeight, detections, numDetections,
+					    float(mPreviewWidth) / float(width), float(mPreviewHeight) / float(height)) )
+			return false;
+
+		// the next frame's preview (and whatever reads it on the stream) waits for the labels
+		if( CUDA_FAILED(cudaEventRecord(mPreviewEvent, NULL)) || CUDA_FAILED(cudaStreamWaitEvent(GetStream(), mPreviewEvent, 0)) )
+			return false;
+	}
+
+	PROFILER_END(PROFILER_VISUALIZE);
+	return true;
+}
+
+
+// Overlay
+bool detectNet::Overlay( float* input, float* output, uint32_t width, uint32_t height, const DeviceDetections& results )
+{
+	PROFILER_BEGIN(PROFILER_VISUALIZE);
+
+	if( CUDA_FAILED(cudaDetectionOverlay((float4*)input, (float4*)output, width, height, results.detections, results.count,
+								  results.capacity, (float4*)mClassColors[1], GetStream())) )
+		return false;
+
 	PROFILER_END(PROFILER_VISUALIZE);
 	return true;
 }
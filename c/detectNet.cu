@@ -23,6 +23,8 @@
 #include "detectNet.h"
 #include "cudaUtility.h"
 
+#include <strings.h>
+
 
 
 template<typename T>
@@ -75,3 +77,419 @@ cudaError_t cudaDetectionOverlay( float4* input, float4* output, uint32_t width,
 	return cudaGetLastError();
 }
 
+
+// gpuDetectionOverlayDevice
+template<typename T>
+__global__ void gpuDetectionOverlayDevice( T* input, T* output, int width, int height, detectNet::Detection* detections, const int* count, int capacity, float4* colors ) 
+{
+	const int x = blockIdx.x * blockDim.x + threadIdx.x;
+	const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+	if( x >= width || y >= height )
+		return;
+
+	const int numDetections = min(*count, capacity);
+
+	T px_out = input[ y * width + x ];
+	
+	const float fx = x;
+	const float fy = y;
+	
+	for( int n=0; n < numDetections; n++ )
+	{
+		const detectNet::Detection det = detections[n];
+
+		// check if this pixel is inside the bounding box
+		if( fx >= det.Left && fx <= det.Right && fy >= det.Top && fy <= det.Bottom )
+		{
+			const float4 color = colors[det.ClassID];	
+
+			const float alpha = color.w / 255.0f;
+			const float ialph = 1.0f - alpha;
+
+			px_out.x = alpha * color.x + ialph * px_out.x;
+			px_out.y = alpha * color.y + ialph * px_out.y;
+			px_out.z = alpha * color.z + ialph * px_out.z;
+		}
+	}
+	
+	output[y * width + x] = px_out;	 
+}
+
+cudaError_t cudaDetectionOverlay( float4* input, float4* output, uint32_t width, uint32_t height, detectNet::Detection* detections, const int* count, uint32_t capacity, float4* colors, cudaStream_t stream )
+{
+	if( !input || !output || width == 0 || height == 0 || !detections || !count || !colors )
+		return cudaErrorInvalidValue;
+
+	// launch kernel
+	const dim3 blockDim(8, 8);
+	const dim3 gridDim(iDivUp(width,blockDim.x), iDivUp(height,blockDim.y));
+
+	gpuDetectionOverlayDevice<float4><<<gridDim, blockDim, 0, stream>>>(input, output, width, height, detections, count, capacity, colors); 
+
+	return cudaGetLastError();
+}
+
+
+// gpuDetectionPreview
+__global__ void gpuDetectionPreview( float4* input, int inputWidth, int inputHeight, float4* output, int outputWidth, int outputHeight,
+							  float2 scale, detectNet::Detection* detections, int numDetections, float4* colors )
+{
+	const int x = blockIdx.x * blockDim.x + threadIdx.x;
+	const int y = blockIdx.y * blockDim.y + threadIdx.y;
+
+	if( x >= outputWidth || y >= outputHeight )
+		return;
+
+	// bilinear sample of the input, at the center of the output pixel
+	const float fx = (x + 0.5f) * scale.x;
+	const float fy = (y + 0.5f) * scale.y;
+
+	const float sx = fminf(fmaxf(fx - 0.5f, 0.0f), inputWidth - 1);
+	const float sy = fminf(fmaxf(fy - 0.5f, 0.0f), inputHeight - 1);
+
+	const int x0 = (int)sx;
+	const int y0 = (int)sy;
+	const int x1 = min(x0 + 1, inputWidth - 1);
+	const int y1 = min(y0 + 1, inputHeight - 1);
+
+	const float ax = sx - x0;
+	const float ay = sy - y0;
+
+	const float4 p00 = input[y0 * inputWidth + x0];
+	const float4 p01 = input[y0 * inputWidth + x1];
+	const float4 p10 = input[y1 * inputWidth + x0];
+	const float4 p11 = input[y1 * inputWidth + x1];
+
+	float4 px_out;
+
+	px_out.x = (1.0f - ay) * ((1.0f - ax) * p00.x + ax * p01.x) + ay * ((1.0f - ax) * p10.x + ax * p11.x);
+	px_out.y = (1.0f - ay) * ((1.0f - ax) * p00.y + ax * p01.y) + ay * ((1.0f - ax) * p10.y + ax * p11.y);
+	px_out.z = (1.0f - ay) * ((1.0f - ax) * p00.z + ax * p01.z) + ay * ((1.0f - ax) * p10.z + ax * p11.z);
+	px_out.w = (1.0f - ay) * ((1.0f - ax) * p00.w + ax * p01.w) + ay * ((1.0f - ax) * p10.w + ax * p11.w);
+
+	// the bounding boxes are in the coordinates of the input
+	for( int n=0; n < numDetections; n++ )
+	{
+		const detectNet::Detection det = detections[n];
+
+		if( fx >= det.Left && fx <= det.Right && fy >= det.Top && fy <= det.Bottom )
+		{
+			const float4 color = colors[det.ClassID];	
+
+			const float alpha = color.w / 255.0f;
+			const float ialph = 1.0f - alpha;
+
+			px_out.x = alpha * color.x + ialph * px_out.x;
+			px_out.y = alpha * color.y + ialph * px_out.y;
+			px_out.z = alpha * color.z + ialph * px_out.z;
+		}
+	}
+
+	output[y * outputWidth + x] = px_out;
+}
+
+cudaError_t cudaDetectionPreview( float4* input, uint32_t width, uint32_t height, float4* output, uint32_t previewWidth, uint32_t previewHeight,
+						    detectNet::Detection* detections, int numDetections, float4* colors, cudaStream_t stream )
+{
+	if( !input || !output || width == 0 || height == 0 || previewWidth == 0 || previewHeight == 0 || !colors )
+		return cudaErrorInvalidValue;
+
+	if( numDetections > 0 && !detections )
+		return cudaErrorInvalidValue;
+
+	const float2 scale = make_float2(float(width) / float(previewWidth), float(height) / float(previewHeight));
+
+	// launch kernel
+	const dim3 blockDim(8, 8);
+	const dim3 gridDim(iDivUp(previewWidth,blockDim.x), iDivUp(previewHeight,blockDim.y));
+
+	gpuDetectionPreview<<<gridDim, blockDim, 0, stream>>>(input, width, height, output, previewWidth, previewHeight,
+											    scale, detections, numDetections, colors);
+
+	return cudaGetLastError();
+}
+
+
+//---------------------------------------------------------------------
+// device-side decoding of the network outputs (@see detectNet::DetectDevice())
+//---------------------------------------------------------------------
+
+// publishDetection (the candidate array holds every row, so none are dropped)
+__device__ inline void publishDetection( detectNet::Detection* detections, int* count, int capacity, int row, uint32_t classID, uint32_t numClasses, 
+								 float confidence, float left, float top, float right, float bottom )
+{
+	const int n = atomicAdd(count, 1);
+
+	if( n >= capacity )
+		return;
+
+	detectNet::Detection* det = detections + n;
+
+	det->Instance   = row;	// breaks ties in confidence, so the order doesn't depend on the scheduling
+	det->ClassID    = (numClasses > 0 && classID >= numClasses) ? 0 : classID;
+	det->Confidence = confidence;
+	det->Left       = left;
+	det->Top        = top;
+	det->Right      = right;
+	det->Bottom     = bottom;
+}
+
+
+// gpuDecodeSSD
+__global__ void gpuDecodeSSD( const float* rows, const int* rowCount, int maxRows, int columns, float threshold, uint32_t numClasses,
+						float width, float height, detectNet::Detection* detections, int* count, int capacity )
+{
+	const int r = blockIdx.x * blockDim.x + threadIdx.x;
+
+	if( r >= min(*rowCount, maxRows) )
+		return;
+
+	const float* row = rows + r * columns;
+
+	if( !(row[2] >= threshold) )
+		return;
+
+	publishDetection(detections, count, capacity, r, (uint32_t)row[1], numClasses, row[2],
+				  row[3] * width, row[4] * height, row[5] * width, row[6] * height);
+}
+
+
+// gpuDecodeAnchor
+__global__ void gpuDecodeAnchor( const float* scores, const float* boxes, int numAnchors, int numClasses, float threshold,
+						   float width, float height, detectNet::Detection* detections, int* count, int capacity )
+{
+	const int a = blockIdx.x * blockDim.x + threadIdx.x;
+
+	if( a >= numAnchors )
+		return;
+
+	const float* s = scores + a * numClasses;
+
+	float best = s[1];
+	int classID = 1;
+
+	for( int k=2; k < numClasses; k++ )
+	{
+		if( s[k] > best )
+		{
+			best = s[k];
+			classID = k;
+		}
+	}
+
+	if( !(best >= threshold) )
+		return;
+
+	const float* box = boxes + a * 4;
+
+	publishDetection(detections, count, capacity, a, classID, numClasses, best,
+				  box[0] * width, box[1] * height, box[2] * width, box[3] * height);
+}
+
+
+// gpuDecodeYOLO
+__global__ void gpuDecodeYOLO( const float* rows, int numRows, int numClasses, float threshold, float2 scale,
+						 float width, float height, detectNet::Detection* detections, int* count, int capacity )
+{
+	const int r = blockIdx.x * blockDim.x + threadIdx.x;
+
+	if( r >= numRows )
+		return;
+
+	const float* row = rows + r * (numClasses + 5);
+
+	if( !(row[4] >= threshold) )
+		return;
+
+	float best = row[5];
+	int classID = 0;
+
+	for( int k=1; k < numClasses; k++ )
+	{
+		if( row[5+k] > best )
+		{
+			best = row[5+k];
+			classID = k;
+		}
+	}
+
+	const float confidence = row[4] * best;
+
+	if( !(confidence >= threshold) )
+		return;
+
+	const float cx = row[0] * scale.x;
+	const float cy = row[1] * scale.y;
+	const float hw = row[2] * scale.x * 0.5f;
+	const float hh = row[3] * scale.y * 0.5f;
+
+	publishDetection(detections, count, capacity, r, classID, numClasses, confidence,
+				  fmaxf(cx - hw, 0.0f), fmaxf(cy - hh, 0.0f), fminf(cx + hw, width), fminf(cy + hh, height));
+}
+
+
+// gpuDecodeBox
+__global__ void gpuDecodeBox( const float* coord, float threshold, float width, float height, detectNet::Detection* detections, int* count, int capacity )
+{
+	// the network always outputs a box, so its confidence is 1
+	const float confidence = 1.0f;
+
+	if( !(confidence >= threshold) )
+		return;
+
+	publishDetection(detections, count, capacity, 0, 0, 1, confidence,
+				  ((coord[0] + 1.0f) * 0.5f) * width, ((coord[1] + 1.0f) * 0.5f) * height,
+				  ((coord[2] + 1.0f) * 0.5f) * width, ((coord[3] + 1.0f) * 0.5f) * height);
+}
+
+
+// detectionIOU
+__device__ inline float detectionIOU( const detectNet::Detection& a, const detectNet::Detection& b )
+{
+	const float w = fminf(a.Right, b.Right) - fmaxf(a.Left, b.Left);
+	const float h = fminf(a.Bottom, b.Bottom) - fmaxf(a.Top, b.Top);
+
+	if( w <= 0.0f || h <= 0.0f )
+		return 0.0f;
+
+	const float i = w * h;
+	return i / ((a.Right - a.Left) * (a.Bottom - a.Top) + (b.Right - b.Left) * (b.Bottom - b.Top) - i);
+}
+
+
+// gpuDetectionSelect
+__global__ void gpuDetectionSelect( const detectNet::Detection* candidates, const int* candidateCount, detectNet::Detection* sorted, int capacity )
+{
+	const int i = blockIdx.x * blockDim.x + threadIdx.x;
+	const int n = *candidateCount;
+
+	if( i >= n )
+		return;
+
+	// rank by confidence, then by row -- only the top entries up to the capacity are kept
+	const float c = candidates[i].Confidence;
+	const int row = candidates[i].Instance;
+
+	int rank = 0;
+
+	for( int j=0; j < n && rank < capacity; j++ )
+	{
+		const float d = candidates[j].Confidence;
+		rank += (d > c || (d == c && candidates[j].Instance < row));
+	}
+
+	if( rank < capacity )
+		sorted[rank] = candidates[i];
+}
+
+
+// gpuDetectionSuppress (single block, the entries are already sorted by gpuDetectionSelect())
+__global__ void gpuDetectionSuppress( detectNet::Detection* detections, const detectNet::Detection* sorted, int* count, const int* candidateCount, int capacity, float overlapThreshold )
+{
+	__shared__ int keep[DETECTNET_DEVICE_CAPACITY];
+
+	const int n = min(*candidateCount, capacity);
+
+	for( int i=threadIdx.x; i < n; i += blockDim.x )
+		keep[i] = 1;
+
+	__syncthreads();
+
+	// greedy suppression in order of confidence (entry i is final once the ones before it were processed)
+	for( int i=0; i < n; i++ )
+	{
+		if( keep[i] )
+		{
+			const detectNet::Detection det = sorted[i];
+
+			for( int j=i+1+threadIdx.x; j < n; j += blockDim.x )
+			{
+				if( keep[j] && sorted[j].ClassID == det.ClassID && detectionIOU(det, sorted[j]) > overlapThreshold )
+					keep[j] = 0;
+			}
+		}
+
+		__syncthreads();
+	}
+
+	// compact the remaining entries
+	if( threadIdx.x == 0 )
+	{
+		int numKept = 0;
+
+		for( int i=0; i < n; i++ )
+		{
+			if( !keep[i] )
+				continue;
+
+			detections[numKept] = sorted[i];
+			detections[numKept].Instance = numKept;
+			numKept++;
+		}
+
+		*count = numKept;
+	}
+}
+
+
+// cudaDetectionDecode
+cudaError_t cudaDetectionDecode( const char* decoder, void** outputs, const uint32_t* params, float threshold, uint32_t numClasses,
+						   float overlapThreshold, uint32_t width, uint32_t height, detectNet::Detection* detections,
+						   int* count, uint32_t capacity, detectNet::Detection* scratch, int* scratchCount, uint32_t rows,
+						   cudaStream_t stream )
+{
+	if( !decoder || !outputs || !params || !detections || !count || capacity == 0 || capacity > DETECTNET_DEVICE_CAPACITY )
+		return cudaErrorInvalidValue;
+
+	const bool box = (strcasecmp(decoder, "box") == 0);
+
+	if( !scratch || !scratchCount || rows == 0 || (!box && rows < params[0]) )
+		return cudaErrorInvalidValue;
+
+	// the scratch space holds the sorted entries, followed by a candidate for every row of the outputs
+	detectNet::Detection* sorted     = scratch;
+	detectNet::Detection* candidates = scratch + capacity;
+
+	if( CUDA_FAILED(cudaMemsetAsync(scratchCount, 0, sizeof(int), stream)) )
+		return cudaErrorInvalidValue;
+
+	const dim3 blockDim(128);
+
+	if( strcasecmp(decoder, "ssd") == 0 )
+	{
+		// params:  rows, columns
+		gpuDecodeSSD<<<iDivUp(params[0], blockDim.x), blockDim, 0, stream>>>((const float*)outputs[0], (const int*)outputs[1], params[0], params[1],
+													threshold, numClasses, width, height, candidates, scratchCount, rows);
+
+		overlapThreshold = 2.0f;	// already suppressed by the network, only sort
+	}
+	else if( strcasecmp(decoder, "anchor") == 0 )
+	{
+		// params:  anchors, classes
+		gpuDecodeAnchor<<<iDivUp(params[0], blockDim.x), blockDim, 0, stream>>>((const float*)outputs[0], (const float*)outputs[1], params[0], params[1],
+													   threshold, width, height, candidates, scratchCount, rows);
+	}
+	else if( strcasecmp(decoder, "yolo") == 0 )
+	{
+		// params:  rows, classes, input width, input height
+		const float2 scale = make_float2(float(width) / float(params[2]), float(height) / float(params[3]));
+
+		gpuDecodeYOLO<<<iDivUp(params[0], blockDim.x), blockDim, 0, stream>>>((const float*)outputs[0], params[0], params[1], threshold, scale,
+													 width, height, candidates, scratchCount, rows);
+	}
+	else if( box )
+	{
+		gpuDecodeBox<<<1, 1, 0, stream>>>((const float*)outputs[0], threshold, width, height, candidates, scratchCount, rows);
+	}
+	else
+	{
+		return cudaErrorInvalidValue;
+	}
+
+	// keep the candidates with the highest confidence, in a deterministic order
+	gpuDetectionSelect<<<iDivUp(rows, blockDim.x), blockDim, 0, stream>>>(candidates, scratchCount, sorted, capacity);
+	gpuDetectionSuppress<<<1, 256, 0, stream>>>(detections, sorted, count, scratchCount, capacity, overlapThreshold);
+
+	return cudaGetLastError();
+}
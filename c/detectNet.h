@@ -25,6 +25,7 @@
 
 
 #include "tensorNet.h"
+#include "detectionDecoder.h"
 
 
 /**
@@ -51,6 +52,12 @@
  */
 #define DETECTNET_DEFAULT_THRESHOLD 0.5f
 
+/**
+ * Maximum number of detections that detectNet::DetectDevice() keeps in device memory.
+ * @ingroup detectNet
+ */
+#define DETECTNET_DEVICE_CAPACITY 1024
+
 /**
  * Command-line options able to be passed to imageNet::Create()
  * @ingroup imageNet
@@ -74,8 +81,16 @@
 		  "  --input_blob INPUT    name of the input layer (default is '" DETECTNET_DEFAULT_INPUT "')\n" 			\
 		  "  --output_cvg COVERAGE name of the coverge output layer (default is '" DETECTNET_DEFAULT_COVERAGE "')\n" 	\
 		  "  --output_bbox BOXES   name of the bounding output layer (default is '" DETECTNET_DEFAULT_BBOX "')\n" 	\
+		  "  --decoder DECODER     decoder of the detection head: detectnet, ssd, anchor, yolo or box\n"		\
+		  "                        (the default is selected from the model format and outputs)\n"		\
 		  "  --mean_pixel PIXEL    mean pixel value to subtract from input (default is 0.0)\n"					\
-		  "  --batch_size BATCH    maximum batch size (default is 1)\n"
+		  "  --batch_size BATCH    maximum batch size (default is 1)\n"						\
+		  "  --record FILE         record the raw output tensors of each frame, for offline replay\n"		\
+		  "  --precision TYPE      fp32, fp16, int8, fastest (default) or autotune\n"		\
+		  "  --preview WxH         render the overlay onto a preview of this size (i.e. 640x360),\n"	\
+		  "                        instead of onto the full-resolution image\n"			\
+		  "  --warmup[=N]          run the network on synthetic frames after loading, until its\n"	\
+		  "                        latency converges (or for up to N iterations, default 50)\n"
 
 
 /**
@@ -86,53 +101,18 @@ class detectNet : public tensorNet
 {
 public:
 	/**
-	 * Object Detection result.
+	 * Object Detection result (@see detectionResult).
 	 */
-	struct Detection
-	{
-		// Object Info
-		uint32_t Instance;	/**< Index of this unique object instance */
-		uint32_t ClassID;	/**< Class index of the detected object. */
-		float Confidence;	/**< Confidence value of the detected object. */
-
-		// Bounding Box Coordinates
-		float Left;		/**< Left bounding box coordinate (in pixels) */
-		float Right;		/**< Right bounding box coordinate (in pixels) */
-		float Top;		/**< Top bounding box cooridnate (in pixels) */
-		float Bottom;		/**< Bottom bounding box coordinate (in pixels) */
-
-		/**< Calculate the width of the object */
-		inline float Width() const						{ return Right - Left; }
-
-		/**< Calculate the height of the object */
-		inline float Height() const						{ return Bottom - Top; }
-
-		/**< Calculate the area of the object */
-		inline float Area() const						{ return Width() * Height(); }
+	typedef detectionResult Detection;
 
-		/**< Return the center of the object */
-		inline void Center( float* x, float* y ) const		{ if(x) *x = Left + Width() * 0.5f; if(y) *y = Top + Height() * 0.5f; }
-
-		/**< Return true if the coordinate is inside the bounding box */
-		inline bool Contains( float x, float y ) const		{ return x >= Left && x <= Right && y >= Top && y <= Bottom; }
-
-		/**< Return true if the bounding boxes overlap */
-		inline bool Overlaps( const Detection& det ) const	{ return !(det.Left > Right || det.Right < Left || det.Top > Bottom || det.Bottom < Top); }
-		
-		/**< Return true if the bounding boxes overlap */
-		inline bool Overlaps( float x1, float y1, float x2, float y2 ) const	{ return !(x1 > Right || x2 < Left || y1 > Bottom || y2 < Top); }
-		
-		/**< Expand the bounding box if they overlap (return true if so) */
-		inline bool Expand( float x1, float y1, float x2, float y2 ) 	     { if(!Overlaps(x1, y1, x2, y2)) return false; Left = fminf(x1, Left); Top = fminf(y1, Top); Right = fmaxf(x2, Right); Bottom = fmaxf(y2, Bottom); return true; }
-		
-		/**< Expand the bounding box if they overlap (return true if so) */
-		inline bool Expand( const Detection& det )      		{ if(!Overlaps(det)) return false; Left = fminf(det.Left, Left); Top = fminf(det.Top, Top); Right = fmaxf(det.Right, Right); Bottom = fmaxf(det.Bottom, Bottom); return true; }
-		
-		/**< Reset all member variables to zero */
-		inline void Reset()								{ Instance = 0; ClassID = 0; Confidence = 0; Left = 0; Right = 0; Top = 0; Bottom = 0; } 								
-		
-		/**< Default constructor */
-		inline Detection()								{ Reset(); }
+	/**
+	 * Detection results that reside in device memory (@see DetectDevice()).
+	 */
+	struct DeviceDetections
+	{
+		Detection* detections;	/**< Device array of up to capacity results, sorted by confidence */
+		int*       count;		/**< Device memory holding the number of results */
+		uint32_t   capacity;	/**< Maximum number of results */
 	};
 
 	/**
@@ -281,6 +261,64 @@ public:
 	 * @returns    The number of detected objects, 0 if there were no detected objects, and -1 if an error was encountered.
 	 */
 	int Detect( float* input, uint32_t width, uint32_t height, Detection* detections, uint32_t overlay=OVERLAY_BOX );
+
+	/**
+	 * Detect object locations in a batch of RGBA images, processing the network once for the whole batch.
+	 * The images are pre-processed into consecutive entries of the input tensor, so batchSize must not
+	 * exceed the maxBatchSize that the network was loaded with (@see GetMaxBatchSize()).
+	 * @param[in]  input array of float4 RGBA input images in CUDA device memory.
+	 * @param[in]  width width of the input images in pixels.
+	 * @param[in]  height height of the input images in pixels.
+	 * @param[in]  batchSize the number of images in the batch.
+	 * @param[out] detections array of batchSize pointers that will be set to the detection results of each image
+	 *                        (residing in shared CPU/GPU memory, from the same ringbuffer that Detect() uses).
+	 * @param[out] numDetections array of batchSize entries filled with the number of objects detected in each image.
+	 * @param[in]  overlay bitwise OR combination of overlay flags (@see OverlayFlags and @see Overlay()), or OVERLAY_NONE.
+	 * @returns    true on success, false if an error was encountered.
+	 */
+	bool DetectBatch( float** input, uint32_t width, uint32_t height, uint32_t batchSize, Detection** detections, int* numDetections, uint32_t overlay=OVERLAY_BOX );
+
+	/**
+	 * Detect object locations in an RGBA image, leaving the results in device memory for consumers on the GPU.
+	 *
+	 * The pre-processing, the network and the decoding are queued on the network's stream (@see GetStream())
+	 * without synchronizing the host, so kernels that are queued afterwards on the same stream can consume
+	 * the results directly, reading their count from device memory.  Copying them to CPU memory is optional
+	 * (@see DownloadDetections()).  The results remain valid until the next call to DetectDevice().
+	 *
+	 * The "ssd", "anchor", "yolo" and "box" decoders run on the GPU.  Every row of the outputs above the
+	 * threshold is a candidate, and the DETECTNET_DEVICE_CAPACITY (or max detections) candidates with the
+	 * highest confidence are kept for non-maximum suppression, ranked by row when their confidence is equal.  The other decoders (i.e. the clustering of "detectnet") run
+	 * on the CPU and their results are uploaded, which synchronizes the host.
+	 *
+	 * @param[in]  input float4 RGBA input image in CUDA device memory.
+	 * @param[in]  width width of the input image in pixels.
+	 * @param[in]  height height of the input image in pixels.
+	 * @param[out] results set to the device memory of the results.
+	 * @returns    true on success, false if an error was encountered.
+	 */
+	bool DetectDevice( float* input, uint32_t width, uint32_t height, DeviceDetections* results );
+
+	/**
+	 * Queue an asynchronous copy of the results of DetectDevice() to CPU memory, on the network's stream.
+	 * They can be read after the stream is synchronized (i.e. with cudaStreamSynchronize(GetStream())).
+	 * @param[out] detections set to the next detection set of the ringbuffer that Detect() uses (in shared CPU/GPU memory).
+	 * @param[out] numDetections set to the number of results (in shared CPU/GPU memory).
+	 * @returns    true on success, false if an error was encountered.
+	 */
+	bool DownloadDetections( Detection** detections, int** numDetections );
+
+	/**
+	 * Decode the detections of an entry in the batch from the current outputs, without running the network.
+	 * This replays the post-processing on outputs that were loaded with tensorNet::ReplayOutputs(), so that
+	 * it can be profiled on recorded field data (@see tensorRecorder).
+	 * @param[in]  width width of the image that the outputs were produced from (tensorFrame::inputWidth).
+	 * @param[in]  height height of the image that the outputs were produced from (tensorFrame::inputHeight).
+	 * @param[out] detections pointer that will be set to the array of detection results (from the same ringbuffer that Detect() uses).
+	 * @param[in]  batchIndex index of the entry in the batch of the outputs.
+	 * @returns    The number of detected objects, or -1 if an error was encountered.
+	 */
+	int PostProcess( uint32_t width, uint32_t height, Detection** detections, uint32_t batchIndex=0 );
 	
 	/**
 	 * Draw the detected bounding boxes overlayed on an RGBA image.
@@ -290,6 +328,51 @@ public:
 	 * @param detections Array of detections allocated in CUDA device memory.
 	 */
 	bool Overlay( float* input, float* output, uint32_t width, uint32_t height, Detection* detections, uint32_t numDetections, uint32_t flags=OVERLAY_BOX );
+
+	/**
+	 * Draw the bounding boxes of the results of DetectDevice() overlayed on an RGBA image, on the network's stream.
+	 * @note the labels aren't drawn, because they require the results in CPU memory.
+	 */
+	bool Overlay( float* input, float* output, uint32_t width, uint32_t height, const DeviceDetections& results );
+
+	/**
+	 * Render the overlay of Detect() onto a downscaled preview of the image, instead of onto the image itself.
+	 * The preview is resampled from the image and annotated in the same kernel pass, so the full-resolution
+	 * image is only sampled at the preview's resolution and is never written, and the display reads the
+	 * smaller preview instead of the full image.
+	 * @param width width of the preview (0 disables the preview, and Detect() draws on the image again)
+	 * @param height height of the preview
+	 */
+	bool SetPreview( uint32_t width, uint32_t height );
+
+	/**
+	 * Render the preview of an image with the detections overlayed (called by Detect() when the preview is set).
+	 * The preview is rendered even if there are no detections, so that it can always be displayed.
+	 * @param input float4 RGBA input image in CUDA device memory.
+	 * @param detections Array of detections allocated in CUDA device memory (in the coordinates of the input).
+	 */
+	bool OverlayPreview( float* input, uint32_t width, uint32_t height, Detection* detections, uint32_t numDetections, uint32_t flags=OVERLAY_BOX );
+
+	/**
+	 * Retrieve the preview in CUDA device memory, or NULL if the preview isn't set.
+	 * It's overwritten by the next call to Detect() or OverlayPreview().
+	 */
+	inline float* GetPreview() const							{ return mPreview[1]; }
+
+	/**
+	 * Retrieve the preview in CPU memory (the same shared memory as GetPreview()).
+	 */
+	inline float* GetPreviewCPU() const						{ return mPreview[0]; }
+
+	/**
+	 * Retrieve the width of the preview.
+	 */
+	inline uint32_t GetPreviewWidth() const					{ return mPreviewWidth; }
+
+	/**
+	 * Retrieve the height of the preview.
+	 */
+	inline uint32_t GetPreviewHeight() const					{ return mPreviewHeight; }
 	
 	/**
 	 * Retrieve the minimum threshold for detection.
@@ -307,6 +390,21 @@ public:
 	 * Knowing this is useful for allocating the buffers to store the output detection results.
 	 */
 	inline uint32_t GetMaxDetections() const					{ return mMaxDetections; } 
+
+	/**
+	 * Select the decoder of the network's outputs by name (@see detectionDecoder for the built-in decoders).
+	 * A default decoder is selected when the network is loaded, based on the model format and its outputs
+	 * (caffe uses "detectnet", UFF uses "ssd", and ONNX uses "anchor" with two outputs, "box" with a single
+	 * box, or otherwise "yolo").  If the number of classes changes, the class colors are reset to the defaults.
+	 * @returns false if the decoder wasn't found or doesn't fit the network's outputs, in which case the
+	 *          previous decoder remains in use.
+	 */
+	bool SetDecoder( const char* name );
+
+	/**
+	 * Retrieve the decoder of the network's outputs.
+	 */
+	inline detectionDecoder* GetDecoder() const					{ return mDecoder; }
 		
 	/**
 	 * Retrieve the number of object classes supported in the detector
@@ -340,15 +438,23 @@ protected:
 	detectNet( float meanPixel=0.0f );
 
 	bool allocDetections();
+	bool allocDeviceDetections();
+	void freeDeviceDetections();
 	bool defaultColors();
 	void defaultClassDesc();
+
+	virtual bool warmupIteration( float* rgba, uint32_t width, uint32_t height );
+	virtual float inputRange() const;
 	bool loadClassDesc( const char* filename );
 
 	bool init( const char* prototxt_path, const char* model_path, const char* mean_binary, const char* class_labels, 
 			 float threshold, const char* input, const char* coverage, const char* bboxes, uint32_t maxBatchSize, 
 			 precisionType precision, deviceType device, bool allowGPUFallback );
 	
-	int clusterDetections( Detection* detections, uint32_t width, uint32_t height );
+	bool preProcess( float* rgba, uint32_t width, uint32_t height, uint32_t batchIndex );
+	int  postProcess( Detection* detections, uint32_t width, uint32_t height, uint32_t batchIndex );
+	bool overlayLabels( float* image, uint32_t width, uint32_t height, Detection* detections, uint32_t numDetections, float scale_x=1.0f, float scale_y=1.0f );
+	Detection* nextDetectionSet();
 
 	float  mCoverageThreshold;
 	float* mClassColors[2];
@@ -364,8 +470,23 @@ protected:
 	Detection* mDetectionSets[2];	// list of detections, mNumDetectionSets * mMaxDetections
 	uint32_t   mDetectionSet;	// index of next detection set to use
 	uint32_t	 mMaxDetections;	// number of raw detections in the grid
+	uint32_t   mNumDetectionSets;	// size of detection ringbuffer (at least two batches worth)
+
+	detectionDecoder* mDecoder;
+	std::vector<detectionTensor> mDecoderOutputs;
+
+	Detection* mDeviceDetections;	// results of DetectDevice(), followed by scratch space for sorting them and the candidates
+	int*       mDeviceCount;		// number of results of DetectDevice()
+	uint32_t   mDeviceCapacity;
+	uint32_t   mDeviceRows;		// candidates in the scratch space, one per row of the decoder's outputs
+	int*       mDownloadCounts[2];	// counts downloaded by DownloadDetections(), one per detection set
+
+	float*     mPreview[2];		// preview rendered by OverlayPreview() (cpu, gpu)
+	uint32_t   mPreviewWidth;
+	uint32_t   mPreviewHeight;
+	cudaEvent_t mPreviewEvent;	// orders the label pass of OverlayPreview() with the stream
 
-	static const uint32_t mNumDetectionSets = 16; // size of detection ringbuffer
+	static const uint32_t DefaultNumDetectionSets = 16;
 };
 
 
@@ -0,0 +1,601 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "detectionDecoder.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <algorithm>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+
+// same prefix as tensorNet.h, which isn't included to keep this file free of TensorRT
+#ifndef LOG_TRT
+#define LOG_TRT "[TRT]   "
+#endif
+
+
+// constructor
+detectionDecoder::detectionDecoder()
+{
+	mMaxDetections    = 0;
+	mNumClasses       = 0;
+	mInputWidth       = 0;
+	mInputHeight      = 0;
+	mOverlapThreshold = 0.45f;
+}
+
+
+// destructor
+detectionDecoder::~detectionDecoder()
+{
+
+}
+
+
+// compareConfidence
+static bool compareConfidence( const detectionResult& a, const detectionResult& b )
+{
+	return a.Confidence > b.Confidence;
+}
+
+
+// Suppress
+int detectionDecoder::Suppress( detectionResult* detections, int numDetections, float overlapThreshold )
+{
+	if( !detections || numDetections <= 1 )
+		return numDetections;
+
+	std::stable_sort(detections, detections + numDetections, compareConfidence);
+
+	int numKept = 0;
+
+	for( int n=0; n < numDetections; n++ )
+	{
+		bool suppressed = false;
+
+		for( int k=0; k < numKept; k++ )
+		{
+			if( detections[k].ClassID == detections[n].ClassID && detections[k].IOU(detections[n]) > overlapThreshold )
+			{
+				suppressed = true;
+				break;
+			}
+		}
+
+		if( suppressed )
+			continue;
+
+		detections[numKept] = detections[n];
+		detections[numKept].Instance = numKept;
+		numKept++;
+	}
+
+	return numKept;
+}
+
+
+// rowMax
+static inline float rowMax( const float* row, uint32_t count )
+{
+	// a NaN entry is skipped like the scalar (row[k] > best) comparison does,
+	// unless it's the first entry, which the caller then rejects
+	float best = row[0];
+	uint32_t k = 1;
+
+#if defined(__SSE__)
+	if( count >= 5 )
+	{
+		__m128 max = _mm_set1_ps(best);
+
+		for( ; k + 4 <= count; k += 4 )
+			max = _mm_max_ps(_mm_loadu_ps(row + k), max);	// returns the second operand for NaN
+
+		max  = _mm_max_ps(_mm_movehl_ps(max, max), max);
+		max  = _mm_max_ss(_mm_shuffle_ps(max, max, 1), max);
+		best = _mm_cvtss_f32(max);
+	}
+#elif defined(__aarch64__)
+	if( count >= 5 && best == best )
+	{
+		float32x4_t max = vdupq_n_f32(best);
+
+		for( ; k + 4 <= count; k += 4 )
+			max = vmaxnmq_f32(max, vld1q_f32(row + k));	// returns the number for NaN
+
+		best = vmaxnmvq_f32(max);
+	}
+#endif
+
+	for( ; k < count; k++ )
+		best = (row[k] > best) ? row[k] : best;
+
+	return best;
+}
+
+
+//---------------------------------------------------------------------
+// DetectNet coverage and bounding-box grids (caffe)
+//---------------------------------------------------------------------
+class detectNetDecoder : public detectionDecoder
+{
+public:
+	static detectionDecoder* Create()	{ return new detectNetDecoder(); }
+
+	virtual const char* GetName() const	{ return "detectnet"; }
+
+	virtual bool Configure( const std::vector<detectionTensor>& outputs, uint32_t inputWidth, uint32_t inputHeight )
+	{
+		if( outputs.size() < 2 )
+			return false;
+
+		const detectionTensor& cvg  = outputs[0];
+		const detectionTensor& bbox = outputs[1];
+
+		if( bbox.dims[0] < 4 || bbox.dims[1] != cvg.dims[1] || bbox.dims[2] != cvg.dims[2] )
+			return false;
+
+		mNumClasses    = cvg.dims[0];
+		mMaxDetections = cvg.dims[2] * cvg.dims[1] * mNumClasses;
+		mInputWidth    = inputWidth;
+		mInputHeight   = inputHeight;
+
+		return true;
+	}
+
+	virtual int Decode( const std::vector<detectionTensor>& outputs, uint32_t width, uint32_t height, float threshold, detectionResult* detections )
+	{
+		const float* net_cvg   = outputs[0].data;
+		const float* net_rects = outputs[1].data;
+
+		const int ow  = outputs[1].dims[2];	// number of columns in bbox grid in X dimension
+		const int oh  = outputs[1].dims[1];	// number of rows in bbox grid in Y dimension
+		const int owh = ow * oh;			// total number of bbox in grid
+		const int cls = mNumClasses;		// number of object classes in coverage map
+
+		const float cell_width  = mInputWidth / ow;
+		const float cell_height = mInputHeight / oh;
+
+		const float scale_x = float(width) / float(mInputWidth);
+		const float scale_y = float(height) / float(mInputHeight);
+
+		// extract and cluster the raw bounding boxes that meet the coverage threshold
+		int numDetections = 0;
+
+		for( int z=0; z < cls; z++ )	// z = current object class
+		{
+			for( int y=0; y < oh; y++ )
+			{
+				for( int x=0; x < ow; x++)
+				{
+					const float coverage = net_cvg[z * owh + y * ow + x];
+
+					if( coverage <= threshold )
+						continue;
+
+					const float mx = x * cell_width;
+					const float my = y * cell_height;
+
+					const float x1 = (net_rects[0 * owh + y * ow + x] + mx) * scale_x;	// left
+					const float y1 = (net_rects[1 * owh + y * ow + x] + my) * scale_y;	// top
+					const float x2 = (net_rects[2 * owh + y * ow + x] + mx) * scale_x;	// right
+					const float y2 = (net_rects[3 * owh + y * ow + x] + my) * scale_y;	// bottom
+
+					// merge with list, checking for overlaps
+					bool detectionMerged = false;
+
+					for( int n=0; n < numDetections; n++ )
+					{
+						if( detections[n].ClassID == (uint32_t)z && detections[n].Expand(x1, y1, x2, y2) )
+						{
+							detectionMerged = true;
+							break;
+						}
+					}
+
+					// create new entry if the detection wasn't merged with another detection
+					if( !detectionMerged )
+					{
+						detections[numDetections].Instance   = numDetections;
+						detections[numDetections].ClassID    = z;
+						detections[numDetections].Confidence = coverage;
+
+						detections[numDetections].Left   = x1;
+						detections[numDetections].Top    = y1;
+						detections[numDetections].Right  = x2;
+						detections[numDetections].Bottom = y2;
+
+						numDetections++;
+					}
+				}
+			}
+		}
+
+		return numDetections;
+	}
+};
+
+
+//---------------------------------------------------------------------
+// SSD rows of [image, class, confidence, left, top, right, bottom] (UFF)
+//---------------------------------------------------------------------
+class ssdDecoder : public detectionDecoder
+{
+public:
+	static detectionDecoder* Create()	{ return new ssdDecoder(); }
+
+	virtual const char* GetName() const	{ return "ssd"; }
+
+	virtual bool Configure( const std::vector<detectionTensor>& outputs, uint32_t inputWidth, uint32_t inputHeight )
+	{
+		if( outputs.size() < 2 || outputs[0].Columns() < 7 )
+			return false;
+
+		mNumClasses    = 0;	// from the class labels
+		mMaxDetections = outputs[0].Rows();
+		mInputWidth    = inputWidth;
+		mInputHeight   = inputHeight;
+
+		return true;
+	}
+
+	virtual int Decode( const std::vector<detectionTensor>& outputs, uint32_t width, uint32_t height, float threshold, detectionResult* detections )
+	{
+		const int rawDetections = std::min(*(const int*)outputs[1].data, (int)mMaxDetections);
+		const int rawParameters = outputs[0].Columns();
+
+		int numDetections = 0;
+
+		// filter the raw detections by thresholding the confidence
+		for( int n=0; n < rawDetections; n++ )
+		{
+			const float* object_data = outputs[0].data + n * rawParameters;
+
+			if( object_data[2] < threshold )
+				continue;
+
+			detections[numDetections].Instance   = numDetections;
+			detections[numDetections].ClassID    = (uint32_t)object_data[1];
+			detections[numDetections].Confidence = object_data[2];
+			detections[numDetections].Left       = object_data[3] * width;
+			detections[numDetections].Top        = object_data[4] * height;
+			detections[numDetections].Right      = object_data[5] * width;
+			detections[numDetections].Bottom     = object_data[6] * height;
+
+			numDetections++;
+		}
+
+		return numDetections;
+	}
+};
+
+
+//---------------------------------------------------------------------
+// per-anchor class scores [N,classes] and corner boxes [N,4] (ONNX)
+//---------------------------------------------------------------------
+class anchorDecoder : public detectionDecoder
+{
+public:
+	static detectionDecoder* Create()	{ return new anchorDecoder(); }
+
+	virtual const char* GetName() const	{ return "anchor"; }
+
+	virtual bool Configure( const std::vector<detectionTensor>& outputs, uint32_t inputWidth, uint32_t inputHeight )
+	{
+		if( outputs.size() < 2 )
+			return false;
+
+		const detectionTensor& scores = outputs[0];
+		const detectionTensor& boxes  = outputs[1];
+
+		if( scores.Columns() < 2 || boxes.Columns() != 4 || boxes.Rows() != scores.Rows() )
+			return false;
+
+		mNumClasses    = scores.Columns();	// including the background
+		mMaxDetections = scores.Rows();
+		mInputWidth    = inputWidth;
+		mInputHeight   = inputHeight;
+
+		return true;
+	}
+
+	virtual int Decode( const std::vector<detectionTensor>& outputs, uint32_t width, uint32_t height, float threshold, detectionResult* detections )
+	{
+		const float* scores = outputs[0].data;
+		const float* boxes  = outputs[1].data;
+
+		const uint32_t numAnchors = mMaxDetections;
+		const uint32_t numClasses = mNumClasses;
+
+		int numDetections = 0;
+
+		for( uint32_t a=0; a < numAnchors; a++ )
+		{
+			const float* s = scores + a * numClasses;
+
+			// the max of the row (skipping the background) rejects most anchors
+			// before the class is searched for
+			const float best = rowMax(s + 1, numClasses - 1);
+
+			if( !(best >= threshold) )	// also rejects NaN
+				continue;
+
+			uint32_t classID = 1;
+
+			while( s[classID] != best )
+				classID++;
+
+			const float* box = boxes + a * 4;
+
+			detections[numDetections].Instance   = numDetections;
+			detections[numDetections].ClassID    = classID;
+			detections[numDetections].Confidence = best;
+			detections[numDetections].Left       = box[0] * width;
+			detections[numDetections].Top        = box[1] * height;
+			detections[numDetections].Right      = box[2] * width;
+			detections[numDetections].Bottom     = box[3] * height;
+
+			numDetections++;
+		}
+
+		return Suppress(detections, numDetections, mOverlapThreshold);
+	}
+};
+
+
+//---------------------------------------------------------------------
+// YOLO rows of [cx, cy, w, h, objectness, class scores...] (ONNX)
+//---------------------------------------------------------------------
+class yoloDecoder : public detectionDecoder
+{
+public:
+	static detectionDecoder* Create()	{ return new yoloDecoder(); }
+
+	virtual const char* GetName() const	{ return "yolo"; }
+
+	virtual bool Configure( const std::vector<detectionTensor>& outputs, uint32_t inputWidth, uint32_t inputHeight )
+	{
+		if( outputs.size() < 1 || outputs[0].Columns() < 6 )
+			return false;
+
+		mNumClasses    = outputs[0].Columns() - 5;
+		mMaxDetections = outputs[0].Rows();
+		mInputWidth    = inputWidth;
+		mInputHeight   = inputHeight;
+
+		return true;
+	}
+
+	virtual int Decode( const std::vector<detectionTensor>& outputs, uint32_t width, uint32_t height, float threshold, detectionResult* detections )
+	{
+		const uint32_t numRows    = mMaxDetections;
+		const uint32_t numClasses = mNumClasses;
+		const uint32_t numColumns = numClasses + 5;
+
+		const float scale_x = float(width) / float(mInputWidth);
+		const float scale_y = float(height) / float(mInputHeight);
+
+		int numDetections = 0;
+
+		for( uint32_t r=0; r < numRows; r++ )
+		{
+			const float* row = outputs[0].data + r * numColumns;
+
+			// the confidence is objectness * class score, so it can't exceed the objectness
+			const float objectness = row[4];
+
+			if( !(objectness >= threshold) )	// also rejects NaN
+				continue;
+
+			// max of the class scores, then the class that has it
+			const float* s = row + 5;
+			const float best = rowMax(s, numClasses);
+
+			const float confidence = objectness * best;
+
+			if( !(confidence >= threshold) )
+				continue;
+
+			uint32_t classID = 0;
+
+			while( s[classID] != best )
+				classID++;
+
+			const float cx = row[0] * scale_x;
+			const float cy = row[1] * scale_y;
+			const float hw = row[2] * scale_x * 0.5f;
+			const float hh = row[3] * scale_y * 0.5f;
+
+			detections[numDetections].Instance   = numDetections;
+			detections[numDetections].ClassID    = classID;
+			detections[numDetections].Confidence = confidence;
+			detections[numDetections].Left       = fmaxf(cx - hw, 0.0f);
+			detections[numDetections].Top        = fmaxf(cy - hh, 0.0f);
+			detections[numDetections].Right      = fminf(cx + hw, float(width));
+			detections[numDetections].Bottom     = fminf(cy + hh, float(height));
+
+			numDetections++;
+		}
+
+		return Suppress(detections, numDetections, mOverlapThreshold);
+	}
+};
+
+
+//---------------------------------------------------------------------
+// single box in [-1,1] coordinates (ONNX)
+//---------------------------------------------------------------------
+class boxDecoder : public detectionDecoder
+{
+public:
+	static detectionDecoder* Create()	{ return new boxDecoder(); }
+
+	virtual const char* GetName() const	{ return "box"; }
+
+	virtual bool Configure( const std::vector<detectionTensor>& outputs, uint32_t inputWidth, uint32_t inputHeight )
+	{
+		if( outputs.size() < 1 || outputs[0].Volume() < 4 )
+			return false;
+
+		mNumClasses    = 1;
+		mMaxDetections = 1;
+		mInputWidth    = inputWidth;
+		mInputHeight   = inputHeight;
+
+		return true;
+	}
+
+	virtual int Decode( const std::vector<detectionTensor>& outputs, uint32_t width, uint32_t height, float threshold, detectionResult* detections )
+	{
+		const float* coord = outputs[0].data;
+
+		// the network always outputs a box, so its confidence is 1
+		const float confidence = 1.0f;
+
+		if( !(confidence >= threshold) )
+			return 0;
+
+		detections[0].Instance   = 0;
+		detections[0].ClassID    = 0;
+		detections[0].Confidence = confidence;
+		detections[0].Left       = ((coord[0] + 1.0f) * 0.5f) * float(width);
+		detections[0].Top        = ((coord[1] + 1.0f) * 0.5f) * float(height);
+		detections[0].Right      = ((coord[2] + 1.0f) * 0.5f) * float(width);
+		detections[0].Bottom     = ((coord[3] + 1.0f) * 0.5f) * float(height);
+
+		return 1;
+	}
+};
+
+
+//---------------------------------------------------------------------
+
+// builtinDecoders
+static std::vector< std::pair<std::string, detectionDecoder::Factory> > builtinDecoders()
+{
+	std::vector< std::pair<std::string, detectionDecoder::Factory> > decoders;
+
+	decoders.push_back(std::make_pair("detectnet", detectNetDecoder::Create));
+	decoders.push_back(std::make_pair("ssd", ssdDecoder::Create));
+	decoders.push_back(std::make_pair("anchor", anchorDecoder::Create));
+	decoders.push_back(std::make_pair("yolo", yoloDecoder::Create));
+	decoders.push_back(std::make_pair("box", boxDecoder::Create));
+
+	return decoders;
+}
+
+
+// registered decoders, initialized with the built-in ones on first use
+// (the initialization of a function-local static is thread-safe, but
+//  any access after that must hold gRegistryMutex)
+static std::vector< std::pair<std::string, detectionDecoder::Factory> >& decoderRegistry()
+{
+	static std::vector< std::pair<std::string, detectionDecoder::Factory> > registry = builtinDecoders();
+	return registry;
+}
+
+static pthread_mutex_t gRegistryMutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+// Register
+void detectionDecoder::Register( const char* name, Factory factory )
+{
+	if( !name || !factory )
+		return;
+
+	std::vector< std::pair<std::string, Factory> >& registry = decoderRegistry();
+
+	pthread_mutex_lock(&gRegistryMutex);
+
+	for( size_t n=0; n < registry.size(); n++ )
+	{
+		if( strcasecmp(registry[n].first.c_str(), name) == 0 )
+		{
+			registry[n].second = factory;
+			pthread_mutex_unlock(&gRegistryMutex);
+			return;
+		}
+	}
+
+	registry.push_back(std::make_pair(std::string(name), factory));
+	pthread_mutex_unlock(&gRegistryMutex);
+}
+
+
+// Create
+detectionDecoder* detectionDecoder::Create( const char* name )
+{
+	if( !name )
+		return NULL;
+
+	const std::vector< std::pair<std::string, Factory> >& registry = decoderRegistry();
+	Factory factory = NULL;
+
+	pthread_mutex_lock(&gRegistryMutex);
+
+	for( size_t n=0; n < registry.size(); n++ )
+	{
+		if( strcasecmp(registry[n].first.c_str(), name) == 0 )
+		{
+			factory = registry[n].second;
+			break;
+		}
+	}
+
+	if( !factory )
+	{
+		printf(LOG_TRT "detection decoder '%s' was not found, the registered decoders are:\n", name);
+
+		for( size_t n=0; n < registry.size(); n++ )
+			printf(LOG_TRT "   * %s\n", registry[n].first.c_str());
+	}
+
+	pthread_mutex_unlock(&gRegistryMutex);
+
+	// the factory runs outside of the lock, so it may itself use the registry
+	return factory ? factory() : NULL;
+}
+
+
+// List
+std::vector<std::string> detectionDecoder::List()
+{
+	const std::vector< std::pair<std::string, Factory> >& registry = decoderRegistry();
+	std::vector<std::string> names;
+
+	pthread_mutex_lock(&gRegistryMutex);
+
+	for( size_t n=0; n < registry.size(); n++ )
+		names.push_back(registry[n].first);
+
+	pthread_mutex_unlock(&gRegistryMutex);
+	return names;
+}
+
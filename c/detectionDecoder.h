@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __DETECTION_DECODER_H__
+#define __DETECTION_DECODER_H__
+
+#include <stdint.h>
+#include <math.h>
+
+#include <string>
+#include <vector>
+
+
+/**
+ * Object detection result.
+ * @see detectNet::Detection
+ * @ingroup detectNet
+ */
+struct detectionResult
+{
+	// Object Info
+	uint32_t Instance;	/**< Index of this unique object instance */
+	uint32_t ClassID;	/**< Class index of the detected object. */
+	float Confidence;	/**< Confidence value of the detected object. */
+
+	// Bounding Box Coordinates
+	float Left;		/**< Left bounding box coordinate (in pixels) */
+	float Right;		/**< Right bounding box coordinate (in pixels) */
+	float Top;		/**< Top bounding box cooridnate (in pixels) */
+	float Bottom;		/**< Bottom bounding box coordinate (in pixels) */
+
+	/**< Calculate the width of the object */
+	inline float Width() const						{ return Right - Left; }
+
+	/**< Calculate the height of the object */
+	inline float Height() const						{ return Bottom - Top; }
+
+	/**< Calculate the area of the object */
+	inline float Area() const						{ return Width() * Height(); }
+
+	/**< Return the center of the object */
+	inline void Center( float* x, float* y ) const		{ if(x) *x = Left + Width() * 0.5f; if(y) *y = Top + Height() * 0.5f; }
+
+	/**< Return true if the coordinate is inside the bounding box */
+	inline bool Contains( float x, float y ) const		{ return x >= Left && x <= Right && y >= Top && y <= Bottom; }
+
+	/**< Return true if the bounding boxes overlap */
+	inline bool Overlaps( const detectionResult& det ) const	{ return !(det.Left > Right || det.Right < Left || det.Top > Bottom || det.Bottom < Top); }
+	
+	/**< Return true if the bounding boxes overlap */
+	inline bool Overlaps( float x1, float y1, float x2, float y2 ) const	{ return !(x1 > Right || x2 < Left || y1 > Bottom || y2 < Top); }
+	
+	/**< Expand the bounding box if they overlap (return true if so) */
+	inline bool Expand( float x1, float y1, float x2, float y2 ) 	     { if(!Overlaps(x1, y1, x2, y2)) return false; Left = fminf(x1, Left); Top = fminf(y1, Top); Right = fmaxf(x2, Right); Bottom = fmaxf(y2, Bottom); return true; }
+	
+	/**< Expand the bounding box if they overlap (return true if so) */
+	inline bool Expand( const detectionResult& det )      	{ if(!Overlaps(det)) return false; Left = fminf(det.Left, Left); Top = fminf(det.Top, Top); Right = fmaxf(det.Right, Right); Bottom = fmaxf(det.Bottom, Bottom); return true; }
+	
+	/**< Calculate the intersection-over-union with another bounding box */
+	inline float IOU( const detectionResult& det ) const	{ const float w = fminf(Right, det.Right) - fmaxf(Left, det.Left); const float h = fminf(Bottom, det.Bottom) - fmaxf(Top, det.Top); if( w <= 0.0f || h <= 0.0f ) return 0.0f; const float i = w * h; return i / (Area() + det.Area() - i); }
+
+	/**< Reset all member variables to zero */
+	inline void Reset()								{ Instance = 0; ClassID = 0; Confidence = 0; Left = 0; Right = 0; Top = 0; Bottom = 0; } 								
+	
+	/**< Default constructor */
+	inline detectionResult()							{ Reset(); }
+};
+
+
+/**
+ * One entry of the batch of a network output, as seen by a detectionDecoder.
+ * The dimensions are the ones reported by TensorRT (without the batch), padded with 1's.
+ * @ingroup detectNet
+ */
+struct detectionTensor
+{
+	const float* data;	/**< CPU memory of the tensor (NULL while configuring) */
+	uint32_t dims[3];	/**< dimensions (C, H, W) */
+
+	/**< Number of elements in the tensor */
+	inline uint32_t Volume() const					{ return dims[0] * dims[1] * dims[2]; }
+
+	/**< Length of the innermost dimension that isn't 1 (i.e. the values of one box) */
+	inline uint32_t Columns() const					{ return (dims[2] > 1) ? dims[2] : (dims[1] > 1) ? dims[1] : dims[0]; }
+
+	/**< Number of rows of Columns() values (i.e. the number of boxes) */
+	inline uint32_t Rows() const						{ return Volume() / Columns(); }
+};
+
+
+/**
+ * Interface for decoding the outputs of a detection network's head into bounding boxes.
+ *
+ * detectNet selects a decoder when the network is loaded, based on the model format and
+ * its outputs, or by name with detectNet::SetDecoder() (or --decoder on the command line).
+ * The built-in decoders are:
+ *
+ *   - "detectnet"  DetectNet coverage grid [C,H,W] and bounding-box grid [4,H,W], which
+ *                  are clustered (the caffe models)
+ *   - "ssd"        rows of [image, class, confidence, left, top, right, bottom] normalized
+ *                  to the image, and the number of rows (the UFF SSD models)
+ *   - "anchor"     per-anchor class scores [N,classes] (class 0 is the background) and
+ *                  boxes [N,4] in normalized corner coordinates, as exported to ONNX from
+ *                  SSD-style anchor detectors -- the best class of each anchor is kept
+ *   - "yolo"       rows of [cx, cy, w, h, objectness, class scores...] over the flattened
+ *                  grid, in pixels of the network input (as exported to ONNX from YOLO)
+ *   - "box"        a single box in [-1,1] coordinates
+ *
+ * The "anchor" and "yolo" decoders apply non-maximum suppression between the boxes of
+ * each class (@see SetOverlapThreshold()).  Additional decoders can be added with Register().
+ * This file doesn't depend on CUDA or TensorRT.
+ *
+ * @ingroup detectNet
+ */
+class detectionDecoder
+{
+public:
+	/**
+	 * Function that creates a new instance of a decoder.
+	 */
+	typedef detectionDecoder* (*Factory)();
+
+	/**
+	 * Create a new instance of a decoder by name.
+	 * @returns the decoder, or NULL if no decoder was registered by that name.
+	 */
+	static detectionDecoder* Create( const char* name );
+
+	/**
+	 * Register a decoder, replacing any existing decoder of the same name.
+	 * This may be called from any thread, including while networks are being created.
+	 */
+	static void Register( const char* name, Factory factory );
+
+	/**
+	 * Retrieve the names of the registered decoders.
+	 */
+	static std::vector<std::string> List();
+
+	/**
+	 * Suppress the boxes that overlap a box of the same class with higher confidence.
+	 * The remaining detections are sorted by confidence and renumbered.
+	 * @returns the number of remaining detections.
+	 */
+	static int Suppress( detectionResult* detections, int numDetections, float overlapThreshold );
+
+	/**
+	 * Destructor
+	 */
+	virtual ~detectionDecoder();
+
+	/**
+	 * Retrieve the name that the decoder was registered with.
+	 */
+	virtual const char* GetName() const = 0;
+
+	/**
+	 * Check that the network's outputs fit the decoder, and determine the maximum number
+	 * of detections and the number of classes.
+	 * @param outputs the network outputs, in the order they were loaded (data is NULL)
+	 * @param inputWidth width of the network input (in pixels)
+	 * @param inputHeight height of the network input (in pixels)
+	 * @returns false if the outputs aren't the ones the decoder expects.
+	 */
+	virtual bool Configure( const std::vector<detectionTensor>& outputs, uint32_t inputWidth, uint32_t inputHeight ) = 0;
+
+	/**
+	 * Decode the outputs of one entry of the batch into bounding boxes.
+	 * @param outputs the network outputs of the entry, as passed to Configure()
+	 * @param width width of the image that was processed (in pixels)
+	 * @param height height of the image that was processed (in pixels)
+	 * @param threshold minimum confidence of a detection
+	 * @param detections array of GetMaxDetections() entries that is filled with the results
+	 * @returns the number of detections.
+	 */
+	virtual int Decode( const std::vector<detectionTensor>& outputs, uint32_t width, uint32_t height, float threshold, detectionResult* detections ) = 0;
+
+	/**
+	 * Retrieve the maximum number of detections that Decode() can return.
+	 */
+	inline uint32_t GetMaxDetections() const				{ return mMaxDetections; }
+
+	/**
+	 * Retrieve the number of classes that the outputs encode (or 0 if they don't, i.e. "ssd").
+	 */
+	inline uint32_t GetNumClasses() const					{ return mNumClasses; }
+
+	/**
+	 * Retrieve the intersection-over-union above which overlapping boxes are suppressed.
+	 */
+	inline float GetOverlapThreshold() const				{ return mOverlapThreshold; }
+
+	/**
+	 * Set the intersection-over-union above which overlapping boxes are suppressed (default is 0.45).
+	 */
+	inline void SetOverlapThreshold( float threshold )		{ mOverlapThreshold = threshold; }
+
+protected:
+	detectionDecoder();
+
+	uint32_t mMaxDetections;
+	uint32_t mNumClasses;
+	uint32_t mInputWidth;
+	uint32_t mInputHeight;
+	float    mOverlapThreshold;
+};
+
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "frameSink.h"
+#include "videoFile.h"
+
+#include "glDisplay.h"
+#include "commandLine.h"
+
+
+/*
+ * frameSink that renders to an OpenGL window
+ */
+class displaySink : public frameSink
+{
+public:
+	displaySink( glDisplay* display )			{ mDisplay = display; }
+	virtual ~displaySink()					{ delete mDisplay; }
+
+	virtual void RenderOnce( float* image, uint32_t width, uint32_t height )	{ mDisplay->RenderOnce(image, width, height); }
+
+	virtual void SetTitle( const char* title )	{ mDisplay->SetTitle(title); }
+	virtual bool IsClosed() const				{ return mDisplay->IsClosed(); }
+	virtual float GetFPS() const				{ return mDisplay->GetFPS(); }
+
+private:
+	glDisplay* mDisplay;
+};
+
+
+// Create
+frameSink* frameSink::Create( int argc, char** argv )
+{
+	commandLine cmdLine(argc, argv);
+
+	const char* output = cmdLine.GetString("output");
+
+	if( output != NULL || cmdLine.GetFlag("headless") )
+		return videoSink::Create(output, cmdLine.GetFloat("output-fps", 30.0f));
+
+	glDisplay* display = glDisplay::Create();
+
+	if( !display )
+		return NULL;
+
+	return new displaySink(display);
+}
+
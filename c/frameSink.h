@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __FRAME_SINK_H__
+#define __FRAME_SINK_H__
+
+#include <stdint.h>
+
+
+/**
+ * Command-line usage string of frameSink::Create()
+ * @ingroup frameSink
+ */
+#define FRAMESINK_USAGE_STRING  "frameSink arguments: \n"								\
+		  "  --output FILE         encode the rendered frames to a video file (with ffmpeg) or\n"	\
+		  "                        to a raw RGBA dump (.rgba) instead of an OpenGL window\n"		\
+		  "  --output-fps FPS      frame rate of the encoded video (default is 30)\n"			\
+		  "  --headless            don't open an OpenGL window, and discard the frames\n"
+
+
+/**
+ * Destination of the rendered RGBA frames of the camera examples, with the same
+ * interface as glDisplay -- either an OpenGL window, or a headless sink that encodes
+ * the frames to a file (@see videoSink) so that the examples can run in containers.
+ * @ingroup frameSink
+ */
+class frameSink
+{
+public:
+	/**
+	 * Create the sink selected by the command line -- a video file if --output was
+	 * given, a sink that discards the frames with --headless, or else an OpenGL window.
+	 * @returns NULL on error.
+	 */
+	static frameSink* Create( int argc, char** argv );
+
+	/**
+	 * Destructor
+	 */
+	virtual ~frameSink()			{ }
+
+	/**
+	 * Render a float4 RGBA frame (0-255) that's in CUDA memory.  Any GPU work
+	 * that writes to the frame must be complete beforehand.
+	 */
+	virtual void RenderOnce( float* image, uint32_t width, uint32_t height ) = 0;
+
+	/**
+	 * Set the title of the window (headless sinks print it periodically).
+	 */
+	virtual void SetTitle( const char* title ) = 0;
+
+	/**
+	 * Return true if the window was closed, or the output failed.
+	 */
+	virtual bool IsClosed() const = 0;
+
+	/**
+	 * Rate that frames are being rendered at, in frames per second.
+	 */
+	virtual float GetFPS() const = 0;
+
+	/**
+	 * Usage string for command line arguments to Create()
+	 */
+	static inline const char* Usage() 	{ return FRAMESINK_USAGE_STRING; }
+};
+
+
+#endif
+
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "frameSource.h"
+#include "videoFile.h"
+
+#include "gstCamera.h"
+#include "commandLine.h"
+
+
+/*
+ * frameSource that captures from a gstCamera (MIPI CSI or V4L2)
+ */
+class cameraSource : public frameSource
+{
+public:
+	cameraSource( gstCamera* camera )			{ mCamera = camera; }
+	virtual ~cameraSource()					{ delete mCamera; }
+
+	virtual bool Open()						{ return mCamera->Open(); }
+	virtual void Close()					{ mCamera->Close(); }
+
+	virtual bool CaptureRGBA( float** image, uint64_t timeout, bool zeroCopy )	{ return mCamera->CaptureRGBA(image, timeout, zeroCopy); }
+
+	virtual uint32_t GetWidth() const			{ return mCamera->GetWidth(); }
+	virtual uint32_t GetHeight() const			{ return mCamera->GetHeight(); }
+	virtual uint32_t GetPixelDepth() const		{ return mCamera->GetPixelDepth(); }
+
+private:
+	gstCamera* mCamera;
+};
+
+
+// Create
+frameSource* frameSource::Create( int argc, char** argv )
+{
+	commandLine cmdLine(argc, argv);
+
+	const char* input = cmdLine.GetString("input");
+
+	if( input != NULL )
+	{
+		return videoSource::Create(input, cmdLine.GetInt("width", 0), cmdLine.GetInt("height", 0),
+							  cmdLine.GetFloat("input-fps", 0.0f), cmdLine.GetFlag("input-loop"));
+	}
+
+	gstCamera* camera = gstCamera::Create(cmdLine.GetInt("width", gstCamera::DefaultWidth),
+								   cmdLine.GetInt("height", gstCamera::DefaultHeight),
+								   cmdLine.GetString("camera"));
+
+	if( !camera )
+		return NULL;
+
+	return new cameraSource(camera);
+}
+
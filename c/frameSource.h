@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __FRAME_SOURCE_H__
+#define __FRAME_SOURCE_H__
+
+#include <stdint.h>
+#include <limits.h>
+
+
+/**
+ * Command-line usage string of frameSource::Create()
+ * @ingroup frameSource
+ */
+#define FRAMESOURCE_USAGE_STRING  "frameSource arguments: \n"								\
+		  "  --camera CAMERA       index of the MIPI CSI camera to use (NULL for CSI camera 0),\n"	\
+		  "                        or for V4L2 cameras the /dev/video node to use (/dev/video0)\n"	\
+		  "  --width WIDTH         desired width of the stream (default is 1280 pixels, or the\n"		\
+		  "                        size of the video file)\n"								\
+		  "  --height HEIGHT       desired height of the stream (default is 720 pixels, or the\n"	\
+		  "                        size of the video file)\n"								\
+		  "  --input FILE          decode a video file (with ffmpeg) or a raw RGBA dump (.rgba)\n"	\
+		  "                        instead of capturing from a camera\n"						\
+		  "  --input-fps FPS       deliver the frames of the file at FPS, dropping the ones that\n"	\
+		  "                        aren't captured in time like a camera would (default is 0,\n"	\
+		  "                        every frame as fast as they're captured)\n"					\
+		  "  --input-loop          restart the file when it reaches the end\n"
+
+
+/**
+ * Source of RGBA frames for the camera examples, with the same capture interface
+ * as gstCamera -- either a live camera, or a recorded video file (@see videoSource)
+ * so that the examples can run and be profiled without a camera attached.
+ * @ingroup frameSource
+ */
+class frameSource
+{
+public:
+	/**
+	 * Create the source selected by the command line -- a video file if --input
+	 * was given, otherwise the camera from --camera, --width and --height.
+	 * @returns NULL on error.
+	 */
+	static frameSource* Create( int argc, char** argv );
+
+	/**
+	 * Destructor
+	 */
+	virtual ~frameSource()			{ }
+
+	/**
+	 * Start streaming.
+	 */
+	virtual bool Open() = 0;
+
+	/**
+	 * Stop streaming.
+	 */
+	virtual void Close() = 0;
+
+	/**
+	 * Capture the next frame as float4 RGBA, in CUDA memory.  The frame is valid
+	 * until the next call to CaptureRGBA().
+	 * @param image receives the pointer to the frame
+	 * @param timeout maximum time to wait for a frame, in milliseconds
+	 * @param zeroCopy if true, the frame is in memory that's mapped to both the CPU and GPU
+	 * @returns false on timeout or error, or once the end of the stream was reached.
+	 */
+	virtual bool CaptureRGBA( float** image, uint64_t timeout=ULONG_MAX, bool zeroCopy=false ) = 0;
+
+	/**
+	 * Width of the frames, in pixels.
+	 */
+	virtual uint32_t GetWidth() const = 0;
+
+	/**
+	 * Height of the frames, in pixels.
+	 */
+	virtual uint32_t GetHeight() const = 0;
+
+	/**
+	 * Bits per pixel of the frames, as captured.
+	 */
+	virtual uint32_t GetPixelDepth() const = 0;
+
+	/**
+	 * Return true once the end of a video file was reached (never for cameras).
+	 */
+	virtual bool IsEOS() const		{ return false; }
+
+	/**
+	 * Usage string for command line arguments to Create()
+	 */
+	static inline const char* Usage() 	{ return FRAMESOURCE_USAGE_STRING; }
+};
+
+
+#endif
+
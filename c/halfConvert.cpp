@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "halfConvert.h"
+
+#include <string.h>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+
+// halfToFloat
+float halfToFloat( uint16_t value )
+{
+	const uint32_t sign     = (uint32_t)(value & 0x8000) << 16;
+	const uint32_t exponent = (value >> 10) & 0x1F;
+	uint32_t mantissa       = value & 0x3FF;
+	uint32_t bits           = 0;
+
+	if( exponent == 0x1F )
+	{
+		// infinity or NaN
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else if( exponent != 0 )
+	{
+		// normalized
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else if( mantissa != 0 )
+	{
+		// denormalized -- shift the mantissa up until it's normalized
+		uint32_t e = 113;
+
+		while( !(mantissa & 0x400) )
+		{
+			mantissa <<= 1;
+			e--;
+		}
+
+		bits = sign | (e << 23) | ((mantissa & 0x3FF) << 13);
+	}
+	else
+	{
+		// zero
+		bits = sign;
+	}
+
+	float result;
+	memcpy(&result, &bits, sizeof(float));
+	return result;
+}
+
+
+// floatToHalf
+uint16_t floatToHalf( float value )
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(float));
+
+	const uint16_t sign = (bits >> 16) & 0x8000;
+	const uint32_t absolute = bits & 0x7FFFFFFF;
+
+	// infinity or NaN (keep NaN's quiet)
+	if( absolute >= 0x7F800000 )
+		return sign | 0x7C00 | ((absolute > 0x7F800000) ? (0x200 | ((absolute >> 13) & 0x3FF)) : 0);
+
+	// overflow to infinity
+	if( absolute >= 0x477FF000 )
+		return sign | 0x7C00;
+
+	// normalized
+	if( absolute >= 0x38800000 )
+	{
+		const uint32_t rounded = absolute + 0xFFF + ((absolute >> 13) & 1);
+		return sign | ((rounded - 0x38000000) >> 13);
+	}
+
+	// denormalized or underflow to zero
+	if( absolute < 0x33000000 )
+		return sign;
+
+	const uint32_t exponent = absolute >> 23;
+	const uint32_t mantissa = (absolute & 0x7FFFFF) | 0x800000;
+	const uint32_t shift    = 126 - exponent;	// 14..24
+
+	uint32_t half = mantissa >> shift;
+	const uint32_t remainder = mantissa & ((1 << shift) - 1);
+	const uint32_t midpoint  = 1 << (shift - 1);
+
+	if( remainder > midpoint || (remainder == midpoint && (half & 1)) )
+		half++;
+
+	return sign | half;
+}
+
+
+// halfToFloat
+void halfToFloat( const uint16_t* input, float* output, size_t count )
+{
+	size_t n = 0;
+
+#if defined(__F16C__)
+	for( ; n + 8 <= count; n += 8 )
+		_mm256_storeu_ps(output + n, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(input + n))));
+#elif defined(__aarch64__)
+	for( ; n + 4 <= count; n += 4 )
+		vst1q_f32(output + n, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(input + n))));
+#endif
+
+	for( ; n < count; n++ )
+		output[n] = halfToFloat(input[n]);
+}
+
+
+// floatToHalf
+void floatToHalf( const float* input, uint16_t* output, size_t count )
+{
+	size_t n = 0;
+
+#if defined(__F16C__)
+	for( ; n + 8 <= count; n += 8 )
+		_mm_storeu_si128((__m128i*)(output + n), _mm256_cvtps_ph(_mm256_loadu_ps(input + n), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(__aarch64__)
+	for( ; n + 4 <= count; n += 4 )
+		vst1_u16(output + n, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(input + n))));
+#endif
+
+	for( ; n < count; n++ )
+		output[n] = floatToHalf(input[n]);
+}
+
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __HALF_CONVERT_H__
+#define __HALF_CONVERT_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/**
+ * Convert an array of IEEE 754 half-precision values to single-precision.
+ *
+ * Used to read the outputs of networks whose output bindings are FP16
+ * (@see tensorNet::SetBindingPrecision()).  The conversion is vectorized
+ * with F16C on x86 and NEON on aarch64, and is exact for every value
+ * (including denormals, infinities and NaN).  This file doesn't depend
+ * on CUDA or TensorRT.
+ * @ingroup tensorNet
+ */
+void halfToFloat( const uint16_t* input, float* output, size_t count );
+
+/**
+ * Convert an array of single-precision values to IEEE 754 half-precision,
+ * rounding to the nearest even value.
+ * @ingroup tensorNet
+ */
+void floatToHalf( const float* input, uint16_t* output, size_t count );
+
+/**
+ * Convert one half-precision value to single-precision.
+ * @ingroup tensorNet
+ */
+float halfToFloat( uint16_t value );
+
+/**
+ * Convert one single-precision value to half-precision.
+ * @ingroup tensorNet
+ */
+uint16_t floatToHalf( float value );
+
+#endif
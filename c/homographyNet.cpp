@@ -26,6 +26,7 @@
 #include "cudaUtility.h"
 
 #include "mat33.h"
+#include "hostPostProcess.h"
 
 #ifdef HAS_HOMOGRAPHY_NET
 #include <opencv2/calib3d.hpp>
@@ -192,16 +193,16 @@ homographyNet* homographyNet::Create( int argc, char** argv )
 	const char* model = cmdLine.GetString("network");
 
 	if( !model )
-	{
 		model = cmdLine.GetString("model");
 
-		if( !model )
-			return homographyNet::Create();
-	}
-
 	homographyNet::NetworkType type = NetworkTypeFromStr(model);
+	homographyNet* net = NULL;
 
-	if( type == homographyNet::CUSTOM )
+	if( !model )
+	{
+		net = homographyNet::Create();
+	}
+	else if( type == homographyNet::CUSTOM )
 	{
 		const char* input    = cmdLine.GetString("input_blob");
 		const char* output   = cmdLine.GetString("output_blob");
@@ -214,11 +215,33 @@ homographyNet* homographyNet::Create( int argc, char** argv )
 		if( maxBatchSize < 1 )
 			maxBatchSize = 1;
 
-		return homographyNet::Create(model, input, output, maxBatchSize);
+		net = homographyNet::Create(model, input, output, maxBatchSize);
 	}
+	else
+	{
+		// create from pretrained model
+		net = homographyNet::Create(type);
+	}
+
+	if( !net )
+		return NULL;
 
-	// create from pretrained model
-	return homographyNet::Create(type);
+	// run the network on synthetic frames until its latency converges
+	if( cmdLine.GetFlag("warmup") && !net->Warmup(cmdLine.GetInt("warmup", WARMUP_DEFAULT_ITERATIONS)) )
+	{
+		delete net;
+		return NULL;
+	}
+
+	return net;
+}
+
+
+// warmupIteration
+bool homographyNet::warmupIteration( float* rgba, uint32_t width, uint32_t height )
+{
+	float H[3][3];
+	return FindHomography(rgba, rgba, width, height, H);
 }
 
 
@@ -230,14 +253,27 @@ cudaError_t cudaPreHomographyNet( float4* inputA, float4* inputB, size_t inputWi
 
 // FindDisplacement
 bool homographyNet::FindDisplacement( float* imageA, float* imageB, uint32_t width, uint32_t height, float displacement[8] )
+{
+	return FindDisplacementBatch(&imageA, &imageB, width, height, 1, (float(*)[8])displacement);
+}
+
+
+// FindDisplacementBatch
+bool homographyNet::FindDisplacementBatch( float** imagesA, float** imagesB, uint32_t width, uint32_t height, uint32_t batchSize, float (*displacements)[8] )
 {
 #ifdef HAS_HOMOGRAPHY_NET
-	if( !imageA || !imageB || width == 0 || height == 0 )
+	if( !imagesA || !imagesB || !displacements || width == 0 || height == 0 )
 	{
 		printf(LOG_TRT "homographyNet::Process() -- invalid user inputs\n");
 		return false;
 	}
 
+	if( batchSize == 0 || batchSize > mMaxBatchSize )
+	{
+		printf(LOG_TRT "homographyNet::Process() -- invalid batch size %u (max batch size is %u)\n", batchSize, mMaxBatchSize);
+		return false;
+	}
+
 	//printf("user input width=%u height=%u\n", width, height);
 	//printf("homg input width=%u height=%u\n", mWidth, mHeight);
 
@@ -246,11 +282,20 @@ bool homographyNet::FindDisplacement( float* imageA, float* imageB, uint32_t wid
 	/*
 	 * convert/rescale the individual RGBA images into grayscale planar format
 	 */
-	if( CUDA_FAILED(cudaPreHomographyNet((float4*)imageA, (float4*)imageB, width, height,
-								  mInputCUDA, mWidth, mHeight, GetStream())) )
+	for( uint32_t n=0; n < batchSize; n++ )
 	{
-		printf(LOG_TRT "homographyNet::Process() -- cudaPreHomographyNet() failed\n");
-		return false;
+		if( !imagesA[n] || !imagesB[n] )
+		{
+			printf(LOG_TRT "homographyNet::Process() -- invalid user inputs\n");
+			return false;
+		}
+
+		if( CUDA_FAILED(cudaPreHomographyNet((float4*)imagesA[n], (float4*)imagesB[n], width, height,
+									  GetInputBatch(n), mWidth, mHeight, GetStream())) )
+		{
+			printf(LOG_TRT "homographyNet::Process() -- cudaPreHomographyNet() failed\n");
+			return false;
+		}
 	}
 
 	PROFILER_END(PROFILER_PREPROCESS);
@@ -260,42 +305,63 @@ bool homographyNet::FindDisplacement( float* imageA, float* imageB, uint32_t wid
 	 * perform the inferencing
  	 */
 	void* bindBuffers[] = { mInputCUDA, mOutputs[0].CUDA };	
+	cudaStream_t stream = GetStream();
 
-	if( !mContext->execute(1, bindBuffers) )
+	if( !stream )
 	{
-		printf(LOG_TRT "homographyNet::Process() -- failed to execute TensorRT network\n");
-		return false;
+		if( !selectContext(batchSize)->execute(batchSize, bindBuffers) )
+		{
+			printf(LOG_TRT "homographyNet::Process() -- failed to execute TensorRT network\n");
+			return false;
+		}
 	}
+	else
+	{
+		const bool result = selectContext(batchSize)->enqueue(batchSize, bindBuffers, stream, NULL);
 
-	PROFILER_END(PROFILER_NETWORK);
-
-	const uint32_t numOutputs = DIMS_C(mOutputs[0].dims);
+		CUDA(cudaStreamSynchronize(stream));
 
-#ifdef DEBUG_HOMOGRAPHY
-	printf("raw " );
+		if( !result )
+		{
+			printf(LOG_TRT "homographyNet::Process() -- failed to enqueue TensorRT network\n");
+			return false;
+		}
+	}
 
-	for( uint32_t n=0; n < numOutputs; n++ )
-		printf("%f ", mOutputs[0].CPU[n]);
+	PROFILER_END(PROFILER_NETWORK);
 
-	printf("\n");
-#endif
+	const uint32_t numOutputs = DIMS_C(mOutputs[0].dims);
 
 	/*
 	 * rescale the raw outputs
 	 */
 	const float scale = 32.0f;
 
-	for( uint32_t n=0; n < numOutputs; n++ )
-		displacement[n] = mOutputs[0].CPU[n] * scale;
+	for( uint32_t b=0; b < batchSize; b++ )
+	{
+		const float* output = GetOutputBatch(0, b);
 
-#ifdef DEBUG_HOMOGRAPHY
-	printf("*32 " );
+	#ifdef DEBUG_HOMOGRAPHY
+		printf("raw " );
 
-	for( uint32_t n=0; n < numOutputs; n++ )
-		printf("%f ", displacement[n]);
+		for( uint32_t n=0; n < numOutputs; n++ )
+			printf("%f ", output[n]);
 
-	printf("\n");
-#endif
+		printf("\n");
+	#endif
+
+		for( uint32_t n=0; n < numOutputs; n++ )
+			displacements[b][n] = output[n] * scale;
+
+	#ifdef DEBUG_HOMOGRAPHY
+		printf("*32 " );
+
+		for( uint32_t n=0; n < numOutputs; n++ )
+			printf("%f ", displacements[b][n]);
+
+		printf("\n");
+	#endif
+	}
 
 	return true;
 #else
@@ -311,64 +377,8 @@ bool homographyNet::ComputeHomography( const float displacement[8], float H[3][3
 #ifdef HAS_HOMOGRAPHY_NET
 	PROFILER_BEGIN(PROFILER_POSTPROCESS);
 
-	/*
-	 * translate the x/y displacements back into corner points
-	 */
-	std::vector<cv::Point2f> pts1;
-	std::vector<cv::Point2f> pts2;
-
-	pts1.resize(4);
-	pts2.resize(4);
-
-	pts1[0].x = 0.0f;    pts1[0].y = 0.0f;
-	pts1[1].x = mWidth;  pts1[1].y = 0.0f;
-	pts1[2].x = mWidth;  pts1[2].y = mHeight;
-	pts1[3].x = 0.0f;    pts1[3].y = mHeight;
-
-	for( uint32_t n=0; n < 4; n++ )
-	{
-		pts2[n].x = pts1[n].x + displacement[n*2+0];
-		pts2[n].y = pts1[n].y + displacement[n*2+1];
-	}
-
-#ifdef DEBUG_HOMOGRAPHY
-	for( uint32_t n=0; n < 4; n++ )
-		printf("pts1[%u]  x=%f  y=%f\n", n, pts1[n].x, pts1[n].y);
-
-	for( uint32_t n=0; n < 4; n++ )
-		printf("pts2[%u]  x=%f  y=%f\n", n, pts2[n].x, pts2[n].y);
-#endif
-
-	/*
-	 * estimate the homography using DLT
-	 */
-	cv::Mat H_cv = cv::findHomography(pts1, pts2);
-
-	if( H_cv.cols * H_cv.rows != 9 )
-	{
-		printf("homographyNet::Process() -- OpenCV matrix is unexpected size (%ix%i)\n", H_cv.cols, H_cv.rows);
+	if( !computeHomography(displacement, mWidth, mHeight, H, H_inv) )
 		return false;
-	}
-
-
-	/*
-	 * compute the homography's inverse
-	 */
-	double* H_ptr = H_cv.ptr<double>();
-
-	//double H[3][3];
-	//double H_inv[3][3];
-
-	for( uint32_t i=0; i < 3; i++ )
-		for( uint32_t k=0; k < 3; k++ )
-			H[i][k] = H_ptr[i*3+k];
-
-	mat33_inverse(H_inv, H);
-
-#ifdef DEBUG_HOMOGRAPHY
-	mat33_print(H, "H");	
-	mat33_print(H_inv, "H_inv");
-#endif
 
 	PROFILER_END(PROFILER_POSTPROCESS);
 	//PROFILER_REPORT();
@@ -409,6 +419,30 @@ bool homographyNet::FindHomography( float* imageA, float* imageB, uint32_t width
 }
 
 
+// FindHomographyBatch
+bool homographyNet::FindHomographyBatch( float** imagesA, float** imagesB, uint32_t width, uint32_t height, uint32_t batchSize, float (*H)[3][3], float (*H_inv)[3][3] )
+{
+	if( !H || batchSize == 0 || batchSize > mMaxBatchSize )
+		return false;
+
+	std::vector<float> displacements(batchSize * 8);
+	float (*displacement)[8] = (float(*)[8])&displacements[0];
+
+	if( !FindDisplacementBatch(imagesA, imagesB, width, height, batchSize, displacement) )
+		return false;
+
+	for( uint32_t n=0; n < batchSize; n++ )
+	{
+		float inv[3][3];
+
+		if( !ComputeHomography(displacement[n], H[n], H_inv != NULL ? H_inv[n] : inv) )
+			return false;
+	}
+
+	return true;
+}
+
+
 	
 #if 0
 	/*
@@ -111,6 +111,16 @@ public:
 	 * @returns True if the image was processed without error, false if an error was encountered.
 	 */
 	bool FindDisplacement( float* imageA, float* imageB, uint32_t width, uint32_t height, float displacement[8] );
+
+	/**
+	 * Find the displacements for a batch of image pairs, processing the network once for the whole batch.
+	 * @param imagesA array of batchSize RGBA images (in CUDA memory)
+	 * @param imagesB array of batchSize RGBA images (in CUDA memory), with the same dimensions as imagesA
+	 * @param batchSize the number of image pairs, up to the max batch size that the network was loaded with.
+	 * @param displacements output array of batchSize displacements from imagesA[n] to imagesB[n]
+	 * @returns True if the batch was processed without error, false if an error was encountered.
+	 */
+	bool FindDisplacementBatch( float** imagesA, float** imagesB, uint32_t width, uint32_t height, uint32_t batchSize, float (*displacements)[8] );
 	
 	/**
 	 * Find the homography that warps imageA to imageB.
@@ -124,6 +134,14 @@ public:
 	 */
 	bool FindHomography( float* imageA, float* imageB, uint32_t width, uint32_t height, float H[3][3], float H_inv[3][3] );
 
+	/**
+	 * Find the homographies (and their inverses) for a batch of image pairs, processing the network once for the whole batch.
+	 * @param H output array of batchSize homographies that warp imagesA[n] to imagesB[n]
+	 * @param H_inv output array of batchSize inverse homographies (may be NULL)
+	 * @returns True if the batch was processed without error, false if an error was encountered.
+	 */
+	bool FindHomographyBatch( float** imagesA, float** imagesB, uint32_t width, uint32_t height, uint32_t batchSize, float (*H)[3][3], float (*H_inv)[3][3]=NULL );
+
 	/**
 	 * Given the displacement from FindDisplacement(), compute the homography.
 	 * @returns True if the image was processed without error, false if an error was encountered.
@@ -141,6 +159,8 @@ protected:
 
 	// constructor
 	homographyNet();
+
+	virtual bool warmupIteration( float* rgba, uint32_t width, uint32_t height );
 };
 
 #endif
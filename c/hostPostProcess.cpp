@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "hostPostProcess.h"
+
+#include "mat33.h"
+
+#include <string.h>
+
+#ifdef HAS_OPENCV
+#include <opencv2/calib3d.hpp>
+#endif
+
+
+// classifyScores
+int classifyScores( const float* scores, uint32_t numClasses, float* confidence )
+{
+	int classIndex = -1;
+	float classMax = -1.0f;
+
+	for( uint32_t n=0; n < numClasses; n++ )
+	{
+		const float value = scores[n];
+
+		if( value > classMax )
+		{
+			classIndex = n;
+			classMax   = value;
+		}
+	}
+	
+	if( confidence != NULL )
+		*confidence = classMax;
+
+	return classIndex;
+}
+
+
+// classifyGrid
+void classifyGrid( const float* scores, uint32_t width, uint32_t height, uint32_t numClasses, int ignoreClass, uint8_t* classMap )
+{
+	for( uint32_t y=0; y < height; y++ )
+	{
+		for( uint32_t x=0; x < width; x++ )
+		{
+			float p_max = -100000.0f;
+			int   c_max = -1;
+
+			for( int c=0; c < (int)numClasses; c++ )
+			{
+				// skip ignoreClass
+				if( c == ignoreClass )
+					continue;
+
+				// check if this class score is higher
+				const float p = scores[c * width * height + y * width + x];
+
+				if( c_max < 0 || p > p_max )
+				{
+					p_max = p;
+					c_max = c;
+				}
+			}
+
+			classMap[y * width + x] = c_max;
+		}
+	}
+}
+
+
+// resizeClassMap
+void resizeClassMap( const uint8_t* classMap, uint32_t gridWidth, uint32_t gridHeight, uint8_t* output, uint32_t width, uint32_t height )
+{
+	const float s_x = float(gridWidth) / float(width);
+	const float s_y = float(gridHeight) / float(height);
+
+	for( uint32_t y=0; y < height; y++ )
+	{
+		for( uint32_t x=0; x < width; x++ )
+		{
+			const int cx = float(x) * s_x;
+			const int cy = float(y) * s_y;
+
+			output[y * width + x] = classMap[cy * gridWidth + cx];
+		}
+	}
+}
+
+
+// readClassInfo
+uint32_t readClassInfo( FILE* file, std::vector<std::string>& descriptions, std::vector<std::string>& synsets, uint32_t* customClasses )
+{
+	const size_t numLoaded = descriptions.size();
+	char str[512];
+
+	while( fgets(str, 512, file) != NULL )
+	{
+		const int syn = 9;  // length of synset prefix (in characters)
+		const int len = strlen(str);
+		
+		if( len > syn && str[0] == 'n' && str[syn] == ' ' )
+		{
+			str[syn]   = 0;
+			str[len-1] = 0;
+	
+			const std::string a = str;
+			const std::string b = (str + syn + 1);
+	
+			synsets.push_back(a);
+			descriptions.push_back(b);
+		}
+		else if( len > 0 )	// no 9-character synset prefix (i.e. from DIGITS snapshot)
+		{
+			char a[10];
+			sprintf(a, "n%08u", *customClasses);
+
+			(*customClasses)++;
+
+			if( str[len-1] == '\n' )
+				str[len-1] = 0;
+
+			synsets.push_back(a);
+			descriptions.push_back(str);
+		}
+	}
+
+	return descriptions.size() - numLoaded;
+}
+
+
+// computeHomography
+bool computeHomography( const float displacement[8], float width, float height, float H[3][3], float H_inv[3][3] )
+{
+#ifdef HAS_OPENCV
+	/*
+	 * translate the x/y displacements back into corner points
+	 */
+	std::vector<cv::Point2f> pts1;
+	std::vector<cv::Point2f> pts2;
+
+	pts1.resize(4);
+	pts2.resize(4);
+
+	pts1[0].x = 0.0f;   pts1[0].y = 0.0f;
+	pts1[1].x = width;  pts1[1].y = 0.0f;
+	pts1[2].x = width;  pts1[2].y = height;
+	pts1[3].x = 0.0f;   pts1[3].y = height;
+
+	for( uint32_t n=0; n < 4; n++ )
+	{
+		pts2[n].x = pts1[n].x + displacement[n*2+0];
+		pts2[n].y = pts1[n].y + displacement[n*2+1];
+	}
+
+#ifdef DEBUG_HOMOGRAPHY
+	for( uint32_t n=0; n < 4; n++ )
+		printf("pts1[%u]  x=%f  y=%f\n", n, pts1[n].x, pts1[n].y);
+
+	for( uint32_t n=0; n < 4; n++ )
+		printf("pts2[%u]  x=%f  y=%f\n", n, pts2[n].x, pts2[n].y);
+#endif
+
+	/*
+	 * estimate the homography using DLT
+	 */
+	cv::Mat H_cv = cv::findHomography(pts1, pts2);
+
+	if( H_cv.cols * H_cv.rows != 9 )
+	{
+		printf("homographyNet::Process() -- OpenCV matrix is unexpected size (%ix%i)\n", H_cv.cols, H_cv.rows);
+		return false;
+	}
+
+	/*
+	 * compute the homography's inverse
+	 */
+	double* H_ptr = H_cv.ptr<double>();
+
+	for( uint32_t i=0; i < 3; i++ )
+		for( uint32_t k=0; k < 3; k++ )
+			H[i][k] = H_ptr[i*3+k];
+
+	mat33_inverse(H_inv, H);
+
+#ifdef DEBUG_HOMOGRAPHY
+	mat33_print(H, "H");	
+	mat33_print(H_inv, "H_inv");
+#endif
+
+	return true;
+#else
+	printf("homographyNet -- computing the homography requires OpenCV\n");
+	return false;
+#endif
+}
+
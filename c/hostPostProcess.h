@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __HOST_POST_PROCESS_H__
+#define __HOST_POST_PROCESS_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+
+/**
+ * Find the class with the highest score (the post-processing of imageNet).
+ * @param scores the score of each class
+ * @param numClasses the number of classes
+ * @param confidence optional pointer that's set to the score of the class
+ * @returns the index of the class, or -1 if there are no scores above -1.0
+ * @ingroup tensorNet
+ */
+int classifyScores( const float* scores, uint32_t numClasses, float* confidence=NULL );
+
+/**
+ * Find the class with the highest score in each cell of a grid (the argmax classification of segNet).
+ * @param scores band-sequential scores of the grid [numClasses,height,width]
+ * @param width width of the grid
+ * @param height height of the grid
+ * @param numClasses the number of classes
+ * @param ignoreClass the class to skip (or -1 to consider all of the classes)
+ * @param classMap output of width*height class indices
+ * @ingroup tensorNet
+ */
+void classifyGrid( const float* scores, uint32_t width, uint32_t height, uint32_t numClasses, int ignoreClass, uint8_t* classMap );
+
+/**
+ * Resize a grid of class indices to the output resolution, with nearest-neighbor sampling (segNet's binary mask).
+ * @ingroup tensorNet
+ */
+void resizeClassMap( const uint8_t* classMap, uint32_t gridWidth, uint32_t gridHeight, uint8_t* output, uint32_t width, uint32_t height );
+
+/**
+ * Read the class labels from a text file, with one class per line, optionally prefixed by
+ * a 9-character synset (i.e. 'n01440764 tench').  The classes without a synset are assigned
+ * one from the number of custom classes read so far (i.e. 'n00000000').
+ * @param file the open file to read from
+ * @param descriptions the description of each class is appended to this
+ * @param synsets the synset of each class is appended to this
+ * @param customClasses the number of classes read without a synset, which is incremented for each one
+ * @returns the number of classes read.
+ * @ingroup tensorNet
+ */
+uint32_t readClassInfo( FILE* file, std::vector<std::string>& descriptions, std::vector<std::string>& synsets, uint32_t* customClasses );
+
+/**
+ * Estimate the homography between an image and its corners displaced by the offsets
+ * predicted by homographyNet, and its inverse.  Requires OpenCV (HAS_OPENCV).
+ * @param displacement the x/y displacement of each corner (top-left, top-right, bottom-right, bottom-left)
+ * @param width width of the image
+ * @param height height of the image
+ * @returns false on error, or if OpenCV isn't available.
+ * @ingroup homographyNet
+ */
+bool computeHomography( const float displacement[8], float width, float height, float H[3][3], float H_inv[3][3] );
+
+#endif
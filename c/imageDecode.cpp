@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "imageDecode.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <setjmp.h>
+
+#ifdef HAS_LIBJPEG
+#include <jpeglib.h>
+#endif
+
+#ifdef HAS_LIBPNG
+#include <png.h>
+#endif
+
+
+// expand 8-bit pixels with 1, 3 or 4 channels to float4 RGBA
+static inline void expandRGBA( const uint8_t* in, uint32_t channels, float* out, uint32_t count )
+{
+	if( channels == 4 )
+	{
+		for( uint32_t n=0; n < count * 4; n++ )
+			out[n] = in[n];
+	}
+	else if( channels == 3 )
+	{
+		for( uint32_t n=0; n < count; n++, in += 3, out += 4 )
+		{
+			out[0] = in[0];
+			out[1] = in[1];
+			out[2] = in[2];
+			out[3] = 255.0f;
+		}
+	}
+	else
+	{
+		for( uint32_t n=0; n < count; n++, out += 4 )
+		{
+			const float v = in[n];
+
+			out[0] = v;
+			out[1] = v;
+			out[2] = v;
+			out[3] = 255.0f;
+		}
+	}
+}
+
+
+// return true if the filename ends with the extension
+static inline bool hasExtension( const char* filename, const char* ext )
+{
+	const char* dot = strrchr(filename, '.');
+	return dot != NULL && strcasecmp(dot + 1, ext) == 0;
+}
+
+
+// constructor
+imageDecoder::imageDecoder()
+{
+	mEncoding = ENCODING_UNKNOWN;
+	mWidth    = 0;
+	mHeight   = 0;
+	mChannels = 0;
+}
+
+
+// destructor
+imageDecoder::~imageDecoder()
+{
+
+}
+
+
+// IsSupported
+bool imageDecoder::IsSupported( const char* filename )
+{
+	if( !filename )
+		return false;
+
+#ifdef HAS_LIBJPEG
+	if( hasExtension(filename, "jpg") || hasExtension(filename, "jpeg") )
+		return true;
+#endif
+
+#ifdef HAS_LIBPNG
+	if( hasExtension(filename, "png") )
+		return true;
+#endif
+
+	return false;
+}
+
+
+// GetFormat
+const char* imageDecoder::GetFormat() const
+{
+	if( mEncoding == ENCODING_JPEG )
+		return "jpeg";
+	else if( mEncoding == ENCODING_PNG )
+		return "png";
+
+	return "unknown";
+}
+
+
+// readFile
+bool imageDecoder::readFile( const char* filename )
+{
+	FILE* file = fopen(filename, "rb");
+
+	if( !file )
+		return false;
+
+	bool success = false;
+
+	if( fseek(file, 0, SEEK_END) == 0 )
+	{
+		const long size = ftell(file);
+
+		if( size > 0 && fseek(file, 0, SEEK_SET) == 0 )
+		{
+			mFile.resize(size);
+			success = (fread(mFile.data(), 1, size, file) == (size_t)size);
+		}
+	}
+
+	fclose(file);
+	return success;
+}
+
+
+// Open
+bool imageDecoder::Open( const char* filename )
+{
+	mEncoding = ENCODING_UNKNOWN;
+	mWidth    = 0;
+	mHeight   = 0;
+	mChannels = 0;
+
+	if( !filename || !readFile(filename) || mFile.size() < 8 )
+		return false;
+
+	// identify the format by its signature rather than the extension
+	static const uint8_t jpegSignature[] = { 0xFF, 0xD8, 0xFF };
+	static const uint8_t pngSignature[]  = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+	if( memcmp(mFile.data(), jpegSignature, sizeof(jpegSignature)) == 0 )
+		return openJPEG();
+	else if( memcmp(mFile.data(), pngSignature, sizeof(pngSignature)) == 0 )
+		return openPNG();
+
+	return false;
+}
+
+
+// Decode
+bool imageDecoder::Decode( float* rgba )
+{
+	if( !rgba )
+		return false;
+
+	if( mEncoding == ENCODING_JPEG )
+		return decodeJPEG(rgba);
+	else if( mEncoding == ENCODING_PNG )
+		return decodePNG(rgba);
+
+	return false;
+}
+
+
+#ifdef HAS_LIBJPEG
+
+// libjpeg reports errors through a callback that mustn't return
+struct jpegErrorManager
+{
+	struct jpeg_error_mgr mgr;
+	jmp_buf jump;
+	char message[JMSG_LENGTH_MAX];
+};
+
+static void jpegErrorExit( j_common_ptr cinfo )
+{
+	jpegErrorManager* err = (jpegErrorManager*)cinfo->err;
+	(*cinfo->err->format_message)(cinfo, err->message);
+	longjmp(err->jump, 1);
+}
+
+static void jpegOutputMessage( j_common_ptr cinfo )
+{
+	// warnings about recoverable corruption are ignored, like the other decoders
+}
+
+#endif
+
+
+// openJPEG
+bool imageDecoder::openJPEG()
+{
+#ifdef HAS_LIBJPEG
+	struct jpeg_decompress_struct cinfo;
+	jpegErrorManager err;
+
+	cinfo.err = jpeg_std_error(&err.mgr);
+	err.mgr.error_exit = jpegErrorExit;
+	err.mgr.output_message = jpegOutputMessage;
+
+	if( setjmp(err.jump) )
+	{
+		jpeg_destroy_decompress(&cinfo);
+		return false;
+	}
+
+	jpeg_create_decompress(&cinfo);
+	jpeg_mem_src(&cinfo, (unsigned char*)mFile.data(), mFile.size());
+
+	const bool success = (jpeg_read_header(&cinfo, TRUE) == JPEG_HEADER_OK) &&
+					 (cinfo.jpeg_color_space == JCS_GRAYSCALE ||
+					  cinfo.jpeg_color_space == JCS_YCbCr ||
+					  cinfo.jpeg_color_space == JCS_RGB);	// CMYK is left to the fallback
+
+	if( success )
+	{
+		mEncoding = ENCODING_JPEG;
+		mWidth    = cinfo.image_width;
+		mHeight   = cinfo.image_height;
+		mChannels = (cinfo.jpeg_color_space == JCS_GRAYSCALE) ? 1 : 3;
+	}
+
+	jpeg_destroy_decompress(&cinfo);
+	return success;
+#else
+	return false;
+#endif
+}
+
+
+// decodeJPEG
+bool imageDecoder::decodeJPEG( float* rgba )
+{
+#ifdef HAS_LIBJPEG
+	struct jpeg_decompress_struct cinfo;
+	jpegErrorManager err;
+
+	cinfo.err = jpeg_std_error(&err.mgr);
+	err.mgr.error_exit = jpegErrorExit;
+	err.mgr.output_message = jpegOutputMessage;
+
+	if( setjmp(err.jump) )
+	{
+		printf(LOG_DECODE "failed to decode JPEG (%s)\n", err.message);
+		jpeg_destroy_decompress(&cinfo);
+		return false;
+	}
+
+	jpeg_create_decompress(&cinfo);
+	jpeg_mem_src(&cinfo, (unsigned char*)mFile.data(), mFile.size());
+	jpeg_read_header(&cinfo, TRUE);
+
+	cinfo.out_color_space = (mChannels == 1) ? JCS_GRAYSCALE : JCS_RGB;
+
+	jpeg_start_decompress(&cinfo);
+
+	// decode a few scanlines at a time into the scratch buffer, and expand them to float4
+	const uint32_t rowSize = cinfo.output_width * cinfo.output_components;
+	const uint32_t maxRows = 4;
+
+	mScratch.resize(rowSize * maxRows);
+
+	JSAMPROW rows[4];
+
+	for( uint32_t n=0; n < maxRows; n++ )
+		rows[n] = mScratch.data() + n * rowSize;
+
+	while( cinfo.output_scanline < cinfo.output_height )
+	{
+		const uint32_t y = cinfo.output_scanline;
+		const uint32_t numRows = jpeg_read_scanlines(&cinfo, rows, maxRows);
+
+		for( uint32_t n=0; n < numRows; n++ )
+			expandRGBA(rows[n], cinfo.output_components, rgba + size_t(y + n) * mWidth * 4, mWidth);
+	}
+
+	jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+// openPNG
+bool imageDecoder::openPNG()
+{
+#ifdef HAS_LIBPNG
+	png_image image;
+
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+
+	if( !png_image_begin_read_from_memory(&image, mFile.data(), mFile.size()) )
+		return false;
+
+	mEncoding = ENCODING_PNG;
+	mWidth    = image.width;
+	mHeight   = image.height;
+	mChannels = 4;
+
+	png_image_free(&image);
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+// decodePNG
+bool imageDecoder::decodePNG( float* rgba )
+{
+#ifdef HAS_LIBPNG
+	png_image image;
+
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+
+	if( !png_image_begin_read_from_memory(&image, mFile.data(), mFile.size()) )
+	{
+		printf(LOG_DECODE "failed to decode PNG (%s)\n", image.message);
+		return false;
+	}
+
+	// libpng converts every color type and bit depth to 8-bit RGBA
+	image.format = PNG_FORMAT_RGBA;
+	mScratch.resize(PNG_IMAGE_SIZE(image));
+
+	if( !png_image_finish_read(&image, NULL, mScratch.data(), 0, NULL) )
+	{
+		printf(LOG_DECODE "failed to decode PNG (%s)\n", image.message);
+		png_image_free(&image);
+		return false;
+	}
+
+	expandRGBA(mScratch.data(), 4, rgba, mWidth * mHeight);
+	return true;
+#else
+	return false;
+#endif
+}
+
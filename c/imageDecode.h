@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __IMAGE_DECODE_H__
+#define __IMAGE_DECODE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+
+/**
+ * Prefix used for logging image decoding messages.
+ * @ingroup decodePool
+ */
+#define LOG_DECODE "[decode] "
+
+
+/**
+ * Decodes JPEG (libjpeg/libjpeg-turbo) and PNG (libpng) images into a buffer
+ * that's provided by the caller, in the same float4 RGBA layout as loadImageRGBA()
+ * (each channel is 0-255, and alpha is 255 for images without an alpha channel).
+ *
+ * The file is read and its header parsed by Open(), so that the caller can
+ * size the output buffer before Decode().  Each decoder keeps its file and
+ * scanline buffers between images, so a thread should reuse one decoder.
+ * A decoder isn't thread-safe -- use one per thread.
+ *
+ * The formats are only available if the libraries were found at build time
+ * (HAS_LIBJPEG and HAS_LIBPNG).  Open() returns false for the other formats, and
+ * the caller is expected to fall back to loadImageRGBA() for them.
+ * This file doesn't depend on CUDA.
+ * @ingroup decodePool
+ */
+class imageDecoder
+{
+public:
+	/**
+	 * Constructor
+	 */
+	imageDecoder();
+
+	/**
+	 * Destructor
+	 */
+	~imageDecoder();
+
+	/**
+	 * Read an image file and parse its dimensions.
+	 * @returns false if the file couldn't be read, or isn't a supported format.
+	 */
+	bool Open( const char* filename );
+
+	/**
+	 * Decode the image that was opened into a float4 RGBA buffer of
+	 * at least GetWidth() * GetHeight() * 4 floats.
+	 * @returns false if the image is corrupt.
+	 */
+	bool Decode( float* rgba );
+
+	/**
+	 * Width of the image that was opened, in pixels.
+	 */
+	inline uint32_t GetWidth() const			{ return mWidth; }
+
+	/**
+	 * Height of the image that was opened, in pixels.
+	 */
+	inline uint32_t GetHeight() const			{ return mHeight; }
+
+	/**
+	 * Size of the decoded image in bytes (float4 RGBA).
+	 */
+	inline size_t GetSize() const				{ return size_t(mWidth) * size_t(mHeight) * sizeof(float) * 4; }
+
+	/**
+	 * Name of the format of the image that was opened ("jpeg" or "png").
+	 */
+	const char* GetFormat() const;
+
+	/**
+	 * Return true if the decoder was built with support for the format of the file
+	 * extension (.jpg, .jpeg, .png).  The file itself is identified by its contents.
+	 */
+	static bool IsSupported( const char* filename );
+
+protected:
+	enum encoding
+	{
+		ENCODING_UNKNOWN = 0,
+		ENCODING_JPEG,
+		ENCODING_PNG
+	};
+
+	bool readFile( const char* filename );
+	bool openJPEG();
+	bool openPNG();
+	bool decodeJPEG( float* rgba );
+	bool decodePNG( float* rgba );
+
+	std::vector<uint8_t> mFile;		// contents of the file
+	std::vector<uint8_t> mScratch;	// scanlines (JPEG) or the whole image (PNG) before conversion
+
+	encoding mEncoding;
+	uint32_t mWidth;
+	uint32_t mHeight;
+	uint32_t mChannels;
+};
+
+
+#endif
+
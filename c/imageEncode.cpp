@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "imageEncode.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <setjmp.h>
+
+#ifdef HAS_LIBJPEG
+#include <jpeglib.h>
+#endif
+
+#ifdef HAS_LIBPNG
+#include <png.h>
+#endif
+
+
+// clamp a float channel to 8 bits
+static inline uint8_t clampPixel( float v )
+{
+	return (v <= 0.0f) ? 0 : (v >= 255.0f) ? 255 : (uint8_t)(v + 0.5f);
+}
+
+
+// return the extension of a filename (without the dot), or an empty string
+static inline const char* fileExtension( const char* filename )
+{
+	const char* dot = strrchr(filename, '.');
+	return (dot != NULL) ? dot + 1 : "";
+}
+
+
+// constructor
+imageEncoder::imageEncoder( int quality )
+{
+	mQuality = (quality < 1) ? 1 : (quality > 100) ? 100 : quality;
+}
+
+
+// destructor
+imageEncoder::~imageEncoder()
+{
+
+}
+
+
+// IsSupported
+bool imageEncoder::IsSupported( const char* filename )
+{
+	if( !filename )
+		return false;
+
+	const char* ext = fileExtension(filename);
+
+#ifdef HAS_LIBJPEG
+	if( strcasecmp(ext, "jpg") == 0 || strcasecmp(ext, "jpeg") == 0 )
+		return true;
+#endif
+
+#ifdef HAS_LIBPNG
+	if( strcasecmp(ext, "png") == 0 )
+		return true;
+#endif
+
+	return strcasecmp(ext, "raw") == 0;
+}
+
+
+// Encode
+bool imageEncoder::Encode( const char* filename, const float* rgba, uint32_t width, uint32_t height )
+{
+	if( !filename || !rgba || width == 0 || height == 0 )
+		return false;
+
+	const char* ext = fileExtension(filename);
+
+	if( strcasecmp(ext, "jpg") == 0 || strcasecmp(ext, "jpeg") == 0 )
+		return encodeJPEG(filename, rgba, width, height);
+	else if( strcasecmp(ext, "png") == 0 )
+		return encodePNG(filename, rgba, width, height);
+	else if( strcasecmp(ext, "raw") == 0 )
+		return encodeRaw(filename, rgba, width, height);
+
+	return false;
+}
+
+
+// encodeRaw
+bool imageEncoder::encodeRaw( const char* filename, const float* rgba, uint32_t width, uint32_t height )
+{
+	FILE* file = fopen(filename, "wb");
+
+	if( !file )
+	{
+		printf(LOG_WRITER "failed to open '%s' for writing\n", filename);
+		return false;
+	}
+
+	const size_t count = size_t(width) * size_t(height) * 4;
+	const bool success = (fwrite(rgba, sizeof(float), count, file) == count);
+
+	if( fclose(file) != 0 || !success )
+	{
+		printf(LOG_WRITER "failed to write '%s'\n", filename);
+		return false;
+	}
+
+	return true;
+}
+
+
+#ifdef HAS_LIBJPEG
+
+// libjpeg reports errors through a callback that mustn't return
+struct jpegErrorManager
+{
+	struct jpeg_error_mgr mgr;
+	jmp_buf jump;
+	char message[JMSG_LENGTH_MAX];
+};
+
+static void jpegErrorExit( j_common_ptr cinfo )
+{
+	jpegErrorManager* err = (jpegErrorManager*)cinfo->err;
+	(*cinfo->err->format_message)(cinfo, err->message);
+	longjmp(err->jump, 1);
+}
+
+#endif
+
+
+// encodeJPEG
+bool imageEncoder::encodeJPEG( const char* filename, const float* rgba, uint32_t width, uint32_t height )
+{
+#ifdef HAS_LIBJPEG
+	FILE* file = fopen(filename, "wb");
+
+	if( !file )
+	{
+		printf(LOG_WRITER "failed to open '%s' for writing\n", filename);
+		return false;
+	}
+
+	struct jpeg_compress_struct cinfo;
+	jpegErrorManager err;
+
+	cinfo.err = jpeg_std_error(&err.mgr);
+	err.mgr.error_exit = jpegErrorExit;
+
+	if( setjmp(err.jump) )
+	{
+		printf(LOG_WRITER "failed to encode '%s' (%s)\n", filename, err.message);
+		jpeg_destroy_compress(&cinfo);
+		fclose(file);
+		return false;
+	}
+
+	jpeg_create_compress(&cinfo);
+	jpeg_stdio_dest(&cinfo, file);
+
+	cinfo.image_width      = width;
+	cinfo.image_height     = height;
+	cinfo.input_components = 3;
+	cinfo.in_color_space   = JCS_RGB;
+
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, mQuality, TRUE);
+	jpeg_start_compress(&cinfo, TRUE);
+
+	// convert and compress one scanline at a time (alpha is dropped)
+	mScratch.resize(width * 3);
+
+	while( cinfo.next_scanline < cinfo.image_height )
+	{
+		const float* in = rgba + size_t(cinfo.next_scanline) * width * 4;
+		uint8_t* out = mScratch.data();
+
+		for( uint32_t x=0; x < width; x++, in += 4, out += 3 )
+		{
+			out[0] = clampPixel(in[0]);
+			out[1] = clampPixel(in[1]);
+			out[2] = clampPixel(in[2]);
+		}
+
+		JSAMPROW row = mScratch.data();
+		jpeg_write_scanlines(&cinfo, &row, 1);
+	}
+
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+
+	if( fclose(file) != 0 )
+	{
+		printf(LOG_WRITER "failed to write '%s'\n", filename);
+		return false;
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+// encodePNG
+bool imageEncoder::encodePNG( const char* filename, const float* rgba, uint32_t width, uint32_t height )
+{
+#ifdef HAS_LIBPNG
+	const size_t count = size_t(width) * size_t(height) * 4;
+
+	mScratch.resize(count);
+
+	for( size_t n=0; n < count; n++ )
+		mScratch[n] = clampPixel(rgba[n]);
+
+	png_image image;
+
+	memset(&image, 0, sizeof(image));
+
+	image.version = PNG_IMAGE_VERSION;
+	image.width   = width;
+	image.height  = height;
+	image.format  = PNG_FORMAT_RGBA;
+
+	if( !png_image_write_to_file(&image, filename, 0, mScratch.data(), 0, NULL) )
+	{
+		printf(LOG_WRITER "failed to write '%s' (%s)\n", filename, image.message);
+		return false;
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __IMAGE_ENCODE_H__
+#define __IMAGE_ENCODE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+
+/**
+ * Prefix used for logging image writing messages.
+ * @ingroup imageWriter
+ */
+#define LOG_WRITER "[writer] "
+
+
+/**
+ * Encodes float4 RGBA images (0-255, the layout of loadImageRGBA()) to JPEG with
+ * libjpeg(-turbo), to PNG with libpng, or to a raw dump of the buffer, and writes
+ * them to disk.  The format is chosen by the extension of the filename:
+ *
+ *    .jpg .jpeg   JPEG at the given quality (requires HAS_LIBJPEG)
+ *    .png         8-bit RGBA PNG (requires HAS_LIBPNG)
+ *    .raw         the float4 buffer as-is, with no header (the fastest to write)
+ *
+ * An encoder keeps its conversion buffer between images, so a thread should reuse
+ * one encoder.  It isn't thread-safe -- use one per thread.  Encode() returns false
+ * for the other formats, and the caller is expected to fall back to saveImageRGBA().
+ * This file doesn't depend on CUDA.
+ * @ingroup imageWriter
+ */
+class imageEncoder
+{
+public:
+	/**
+	 * Constructor
+	 * @param quality JPEG quality (1-100)
+	 */
+	imageEncoder( int quality=95 );
+
+	/**
+	 * Destructor
+	 */
+	~imageEncoder();
+
+	/**
+	 * Encode an image and write it to a file.
+	 * @returns false if the format isn't supported, or the file couldn't be written.
+	 */
+	bool Encode( const char* filename, const float* rgba, uint32_t width, uint32_t height );
+
+	/**
+	 * Return true if the encoder supports the format of the file extension.
+	 */
+	static bool IsSupported( const char* filename );
+
+protected:
+	bool encodeJPEG( const char* filename, const float* rgba, uint32_t width, uint32_t height );
+	bool encodePNG( const char* filename, const float* rgba, uint32_t width, uint32_t height );
+	bool encodeRaw( const char* filename, const float* rgba, uint32_t width, uint32_t height );
+
+	std::vector<uint8_t> mScratch;	// 8-bit pixels before compression
+
+	int mQuality;
+};
+
+
+#endif
+
@@ -22,6 +22,7 @@
  
 #include "imageNet.h"
 #include "imageNet.cuh"
+#include "hostPostProcess.h"
 
 #include "cudaMappedMemory.h"
 #include "cudaResize.h"
@@ -30,11 +31,21 @@
 #include "filesystem.h"
 
 
+// pre-processing of the models (shared by preProcess() and inputRange())
+static const float2 gInceptionRange = make_float2(-1.0f, 1.0f);
+static const float2 gOnnxRange      = make_float2(0.0f, 1.0f);
+static const float3 gOnnxMean       = make_float3(0.485f, 0.456f, 0.406f);
+static const float3 gOnnxStdDev     = make_float3(0.229f, 0.224f, 0.225f);
+static const float3 gCaffeMean      = make_float3(104.0069879317889f, 116.66876761696767f, 122.6789143406786f);
+
+
 // constructor
 imageNet::imageNet() : tensorNet()
 {
 	mOutputClasses = 0;
 	mNetworkType   = CUSTOM;
+
+	mBindingPrecisionSupported = true;
 }
 
 
@@ -239,6 +250,7 @@ imageNet* imageNet::Create( int argc, char** argv )
 	//	modelName = argv[3];	
 
 	const imageNet::NetworkType type = NetworkTypeFromStr(modelName);
+	imageNet* net = NULL;
 
 	if( type == imageNet::CUSTOM )
 	{
@@ -255,11 +267,45 @@ imageNet* imageNet::Create( int argc, char** argv )
 		if( maxBatchSize < 1 )
 			maxBatchSize = DEFAULT_MAX_BATCH_SIZE;
 
-		return imageNet::Create(prototxt, modelName, NULL, labels, input, output, maxBatchSize);
+		net = imageNet::Create(prototxt, modelName, NULL, labels, input, output, maxBatchSize);
+	}
+	else
+	{
+		// create from pretrained model
+		const precisionType precision = precisionTypeFromStr(cmdLine.GetString("precision", "fastest"));
+		net = imageNet::Create(type, DEFAULT_MAX_BATCH_SIZE, precision);
+	}
+
+	if( !net )
+		return NULL;
+
+	// run the network on synthetic frames until its latency converges
+	if( cmdLine.GetFlag("warmup") && !net->Warmup(cmdLine.GetInt("warmup", WARMUP_DEFAULT_ITERATIONS)) )
+	{
+		delete net;
+		return NULL;
 	}
 
-	// create from pretrained model
-	return imageNet::Create(type);
+	return net;
+}
+
+
+// inputRange
+float imageNet::inputRange() const
+{
+	if( mNetworkType == imageNet::INCEPTION_V4 )
+		return cudaPreImageNetNormRange(gInceptionRange);
+	else if( IsModelType(MODEL_ONNX) )
+		return cudaPreImageNetNormMeanRange(gOnnxRange, gOnnxMean, gOnnxStdDev);
+
+	return cudaPreImageNetMeanRange(gCaffeMean);
+}
+
+
+// warmupIteration
+bool imageNet::warmupIteration( float* rgba, uint32_t width, uint32_t height )
+{
+	return Classify(rgba, width, height) >= 0;
 }
 
 
@@ -291,43 +337,9 @@ bool imageNet::LoadClassInfo( const char* filename, std::vector<std::string>& de
 	synsets.clear();
 
 	// read class descriptions
-	char str[512];
 	uint32_t customClasses = 0;
+	readClassInfo(f, descriptions, synsets, &customClasses);
 
-	while( fgets(str, 512, f) != NULL )
-	{
-		const int syn = 9;  // length of synset prefix (in characters)
-		const int len = strlen(str);
-		
-		if( len > syn && str[0] == 'n' && str[syn] == ' ' )
-		{
-			str[syn]   = 0;
-			str[len-1] = 0;
-	
-			const std::string a = str;
-			const std::string b = (str + syn + 1);
-	
-			//printf("a=%s b=%s\n", a.c_str(), b.c_str());
-
-			synsets.push_back(a);
-			descriptions.push_back(b);
-		}
-		else if( len > 0 )	// no 9-character synset prefix (i.e. from DIGITS snapshot)
-		{
-			char a[10];
-			sprintf(a, "n%08u", customClasses);
-
-			//printf("a=%s b=%s (custom non-synset)\n", a, str);
-			customClasses++;
-
-			if( str[len-1] == '\n' )
-				str[len-1] = 0;
-
-			synsets.push_back(a);
-			descriptions.push_back(str);
-		}
-	}
-	
 	fclose(f);
 	
 	printf("imageNet -- loaded %zu class info entries\n", synsets.size());
@@ -395,50 +407,64 @@ bool imageNet::PreProcess( float* rgba, uint32_t width, uint32_t height )
 
 	PROFILER_BEGIN(PROFILER_PREPROCESS);
 
+	if( !preProcess(rgba, width, height, 0) )
+		return false;
+
+	PROFILER_END(PROFILER_PREPROCESS);
+	return true;
+}
+
+
+// preProcess
+bool imageNet::preProcess( float* rgba, uint32_t width, uint32_t height, uint32_t batchIndex )
+{
+	float* input = GetInputBatch(batchIndex);
+
 	if( mNetworkType == imageNet::INCEPTION_V4 )
 	{
 		// downsample, convert to band-sequential RGB, and apply pixel normalization
-		if( CUDA_FAILED(cudaPreImageNetNormRGB((float4*)rgba, width, height, mInputCUDA, mWidth, mHeight, 
-									    make_float2(-1.0f, 1.0f), 
-									    GetStream())) )
+		if( CUDA_FAILED(cudaPreImageNetNormRGB((float4*)rgba, width, height, input, mWidth, mHeight, 
+									    gInceptionRange, GetStream(), GetInputType())) )
 		{
-			printf(LOG_TRT "imageNet::PreProcess() -- cudaPreImageNetNormRGB() failed\n");
+			printf(LOG_TRT "imageNet::preProcess() -- cudaPreImageNetNormRGB() failed\n");
 			return false;
 		}
 	}
 	else if( IsModelType(MODEL_ONNX) )
 	{
 		// downsample, convert to band-sequential RGB, and apply pixel normalization, mean pixel subtraction and standard deviation
-		if( CUDA_FAILED(cudaPreImageNetNormMeanRGB((float4*)rgba, width, height, mInputCUDA, mWidth, mHeight, 
-										   make_float2(0.0f, 1.0f), 
-										   make_float3(0.485f, 0.456f, 0.406f),
-										   make_float3(0.229f, 0.224f, 0.225f), 
-										   GetStream())) )
+		if( CUDA_FAILED(cudaPreImageNetNormMeanRGB((float4*)rgba, width, height, input, mWidth, mHeight, 
+										   gOnnxRange, gOnnxMean, gOnnxStdDev,
+										   GetStream(), GetInputType())) )
 		{
-			printf(LOG_TRT "imageNet::PreProcess() -- cudaPreImageNetNormMeanRGB() failed\n");
+			printf(LOG_TRT "imageNet::preProcess() -- cudaPreImageNetNormMeanRGB() failed\n");
 			return false;
 		}
 	}
 	else
 	{
 		// downsample, convert to band-sequential BGR, and apply mean pixel subtraction 
-		if( CUDA_FAILED(cudaPreImageNetMeanBGR((float4*)rgba, width, height, mInputCUDA, mWidth, mHeight,
-									    make_float3(104.0069879317889f, 116.66876761696767f, 122.6789143406786f),
-									    GetStream())) )
+		if( CUDA_FAILED(cudaPreImageNetMeanBGR((float4*)rgba, width, height, input, mWidth, mHeight,
+									    gCaffeMean, GetStream(), GetInputType())) )
 		{
-			printf(LOG_TRT "imageNet::PreProcess() -- cudaPreImageNetMeanBGR() failed\n");
+			printf(LOG_TRT "imageNet::preProcess() -- cudaPreImageNetMeanBGR() failed\n");
 			return false;
 		}
 	}
 
-	PROFILER_END(PROFILER_PREPROCESS);
 	return true;
 }
 
 
 // Process
-bool imageNet::Process()
+bool imageNet::Process( uint32_t batchSize )
 {
+	if( batchSize == 0 || batchSize > mMaxBatchSize )
+	{
+		printf(LOG_TRT "imageNet::Process() -- invalid batch size %u (max batch size is %u)\n", batchSize, mMaxBatchSize);
+		return false;
+	}
+
 	void* bindBuffers[] = { mInputCUDA, mOutputs[0].CUDA };	
 	cudaStream_t stream = GetStream();
 
@@ -449,13 +475,13 @@ bool imageNet::Process()
 		//const timespec cpu_begin = timestamp();
 
 	#if 1
-		if( !mContext->execute(1, bindBuffers) )
+		if( !selectContext(batchSize)->execute(batchSize, bindBuffers) )
 		{
 			printf(LOG_TRT "imageNet::Process() -- failed to execute TensorRT network\n");
 			return false;
 		}
 	#else
-		const bool result = mContext->enqueue(1, bindBuffers, NULL, NULL);
+		const bool result = selectContext(batchSize)->enqueue(batchSize, bindBuffers, NULL, NULL);
 
 		CUDA(cudaDeviceSynchronize());
 
@@ -482,7 +508,7 @@ bool imageNet::Process()
 		//CUDA(cudaEventRecord(mEvents[0], stream));
 		
 		// queue the inference processing kernels
-		const bool result = mContext->enqueue(1, bindBuffers, stream, NULL);
+		const bool result = selectContext(batchSize)->enqueue(batchSize, bindBuffers, stream, NULL);
 
 		//CUDA(cudaEventRecord(mEvents[1], stream));
 		//CUDA(cudaEventSynchronize(mEvents[1]));
@@ -495,6 +521,8 @@ bool imageNet::Process()
 		}	
 	}
 
+	convertOutputs(batchSize);
+
 	PROFILER_END(PROFILER_NETWORK);
 	return true;
 }
@@ -533,31 +561,73 @@ int imageNet::Classify( float* confidence )
 	
 	PROFILER_BEGIN(PROFILER_POSTPROCESS);
 
-	// determine the maximum class
-	int classIndex = -1;
-	float classMax = -1.0f;
-	
-	//const float valueScale = IsModelType(MODEL_ONNX) ? 0.01f : 1.0f;
-
 	for( size_t n=0; n < mOutputClasses; n++ )
 	{
-		const float value = mOutputs[0].CPU[n] /** valueScale*/;
+		const float value = mOutputs[0].CPU[n];
 		
 		if( value >= 0.01f )
 			printf("class %04zu - %f  (%s)\n", n, value, mClassDesc[n].c_str());
-	
-		if( value > classMax )
-		{
-			classIndex = n;
-			classMax   = value;
-		}
 	}
-	
-	if( confidence != NULL )
-		*confidence = classMax;
-	
+
+	// determine the maximum class
+	const int classIndex = classify(0, confidence);
+
 	//printf("\nmaximum class:  #%i  (%f) (%s)\n", classIndex, classMax, mClassDesc[classIndex].c_str());
 	PROFILER_END(PROFILER_POSTPROCESS);	
 	return classIndex;
 }
 
+
+// ClassifyBatch
+bool imageNet::ClassifyBatch( float** rgba, uint32_t width, uint32_t height, uint32_t batchSize, int* classIndex, float* confidence )
+{
+	// verify parameters
+	if( !rgba || width == 0 || height == 0 || !classIndex )
+	{
+		printf(LOG_TRT "imageNet::ClassifyBatch( 0x%p, %u, %u ) -> invalid parameters\n", rgba, width, height);
+		return false;
+	}
+
+	if( batchSize == 0 || batchSize > mMaxBatchSize )
+	{
+		printf(LOG_TRT "imageNet::ClassifyBatch() -- invalid batch size %u (max batch size is %u)\n", batchSize, mMaxBatchSize);
+		return false;
+	}
+
+	// downsample and convert each image into its entry of the input tensor
+	PROFILER_BEGIN(PROFILER_PREPROCESS);
+
+	for( uint32_t n=0; n < batchSize; n++ )
+	{
+		if( !rgba[n] || !preProcess(rgba[n], width, height, n) )
+		{
+			printf(LOG_TRT "imageNet::ClassifyBatch() -- failed to pre-process image %u of the batch\n", n);
+			return false;
+		}
+	}
+
+	PROFILER_END(PROFILER_PREPROCESS);
+
+	// process the whole batch with TRT
+	if( !Process(batchSize) )
+	{
+		printf(LOG_TRT "imageNet::Process() failed\n");
+		return false;
+	}
+
+	PROFILER_BEGIN(PROFILER_POSTPROCESS);
+
+	for( uint32_t n=0; n < batchSize; n++ )
+		classIndex[n] = classify(n, (confidence != NULL) ? confidence + n : NULL);
+
+	PROFILER_END(PROFILER_POSTPROCESS);
+	return true;
+}
+
+
+// classify
+int imageNet::classify( uint32_t batchIndex, float* confidence )
+{
+	return classifyScores(GetOutputBatch(0, batchIndex), mOutputClasses, confidence);
+}
+
@@ -21,10 +21,56 @@
  */
  
 #include "cudaUtility.h"
+#include "tensorNet.h"
+
+#include <cuda_fp16.h>
+
+
+// castOutput (INT8 is quantized symmetrically, with quantize = 127 / the range of the pre-processing)
+template<typename T> __device__ inline T castOutput( float value, float quantize )	{ return value; }
+template<> __device__ inline __half castOutput<__half>( float value, float quantize )	{ return __float2half(value); }
+template<> __device__ inline int8_t castOutput<int8_t>( float value, float quantize )	{ return (int8_t)fminf(fmaxf(rintf(value * quantize), -127.0f), 127.0f); }
+
+
+// cudaPreImageNetRange
+float cudaPreImageNetRange()
+{
+	return 255.0f;
+}
+
+
+// cudaPreImageNetMeanRange
+float cudaPreImageNetMeanRange( const float3& mean )
+{
+	const float3 range = make_float3(fmaxf(fabsf(mean.x), fabsf(255.0f - mean.x)),
+							   fmaxf(fabsf(mean.y), fabsf(255.0f - mean.y)),
+							   fmaxf(fabsf(mean.z), fabsf(255.0f - mean.z)));
+
+	return fmaxf(fmaxf(range.x, range.y), range.z);
+}
+
+
+// cudaPreImageNetNormRange
+float cudaPreImageNetNormRange( const float2& range )
+{
+	return fmaxf(fabsf(range.x), fabsf(range.y));
+}
+
+
+// cudaPreImageNetNormMeanRange
+float cudaPreImageNetNormMeanRange( const float2& range, const float3& mean, const float3& stdDev )
+{
+	const float3 channels = make_float3(fmaxf(fabsf(range.x - mean.x), fabsf(range.y - mean.x)) / stdDev.x,
+								 fmaxf(fabsf(range.x - mean.y), fabsf(range.y - mean.y)) / stdDev.y,
+								 fmaxf(fabsf(range.x - mean.z), fabsf(range.y - mean.z)) / stdDev.z);
+
+	return fmaxf(fmaxf(channels.x, channels.y), channels.z);
+}
 
 
 // gpuPreImageNetRGB
-__global__ void gpuPreImageNetRGB( float2 scale, float4* input, int iWidth, float* output, int oWidth, int oHeight )
+template<typename T>
+__global__ void gpuPreImageNetRGB( float2 scale, float4* input, int iWidth, T* output, int oWidth, int oHeight, float quantize )
 {
 	const int x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -41,16 +87,16 @@ __global__ void gpuPreImageNetRGB( float2 scale, float4* input, int iWidth, floa
 	const float4 px  = input[ dy * iWidth + dx ];
 	const float3 bgr = make_float3(px.x, px.y, px.z);
 	
-	output[n * 0 + m] = bgr.x;
-	output[n * 1 + m] = bgr.y;
-	output[n * 2 + m] = bgr.z;
+	output[n * 0 + m] = castOutput<T>(bgr.x, quantize);
+	output[n * 1 + m] = castOutput<T>(bgr.y, quantize);
+	output[n * 2 + m] = castOutput<T>(bgr.z, quantize);
 }
 
 
 // cudaPreImageNetRGB
 cudaError_t cudaPreImageNetRGB( float4* input, size_t inputWidth, size_t inputHeight,
-				            float* output, size_t outputWidth, size_t outputHeight,
-					       cudaStream_t stream )
+				            void* output, size_t outputWidth, size_t outputHeight,
+					       cudaStream_t stream, precisionType outputType )
 {
 	if( !input || !output )
 		return cudaErrorInvalidDevicePointer;
@@ -61,18 +107,26 @@ cudaError_t cudaPreImageNetRGB( float4* input, size_t inputWidth, size_t inputHe
 	const float2 scale = make_float2( float(inputWidth) / float(outputWidth),
 							    float(inputHeight) / float(outputHeight) );
 
+	const float quantize = 127.0f / cudaPreImageNetRange();
+
 	// launch kernel
 	const dim3 blockDim(8, 8);
 	const dim3 gridDim(iDivUp(outputWidth,blockDim.x), iDivUp(outputHeight,blockDim.y));
 
-	gpuPreImageNetRGB<<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, output, outputWidth, outputHeight);
+	if( outputType == TYPE_FP16 )
+		gpuPreImageNetRGB<__half><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (__half*)output, outputWidth, outputHeight, quantize);
+	else if( outputType == TYPE_INT8 )
+		gpuPreImageNetRGB<int8_t><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (int8_t*)output, outputWidth, outputHeight, quantize);
+	else
+		gpuPreImageNetRGB<float><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (float*)output, outputWidth, outputHeight, quantize);
 
 	return CUDA(cudaGetLastError());
 }
 
 
 // gpuPreImageNetBGR
-__global__ void gpuPreImageNetBGR( float2 scale, float4* input, int iWidth, float* output, int oWidth, int oHeight )
+template<typename T>
+__global__ void gpuPreImageNetBGR( float2 scale, float4* input, int iWidth, T* output, int oWidth, int oHeight, float quantize )
 {
 	const int x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -89,16 +143,16 @@ __global__ void gpuPreImageNetBGR( float2 scale, float4* input, int iWidth, floa
 	const float4 px  = input[ dy * iWidth + dx ];
 	const float3 bgr = make_float3(px.z, px.y, px.x);
 	
-	output[n * 0 + m] = bgr.x;
-	output[n * 1 + m] = bgr.y;
-	output[n * 2 + m] = bgr.z;
+	output[n * 0 + m] = castOutput<T>(bgr.x, quantize);
+	output[n * 1 + m] = castOutput<T>(bgr.y, quantize);
+	output[n * 2 + m] = castOutput<T>(bgr.z, quantize);
 }
 
 
 // cudaPreImageNetBGR
 cudaError_t cudaPreImageNetBGR( float4* input, size_t inputWidth, size_t inputHeight,
-				            float* output, size_t outputWidth, size_t outputHeight,
-					       cudaStream_t stream )
+				            void* output, size_t outputWidth, size_t outputHeight,
+					       cudaStream_t stream, precisionType outputType )
 {
 	if( !input || !output )
 		return cudaErrorInvalidDevicePointer;
@@ -109,18 +163,26 @@ cudaError_t cudaPreImageNetBGR( float4* input, size_t inputWidth, size_t inputHe
 	const float2 scale = make_float2( float(inputWidth) / float(outputWidth),
 							    float(inputHeight) / float(outputHeight) );
 
+	const float quantize = 127.0f / cudaPreImageNetRange();
+
 	// launch kernel
 	const dim3 blockDim(8, 8);
 	const dim3 gridDim(iDivUp(outputWidth,blockDim.x), iDivUp(outputHeight,blockDim.y));
 
-	gpuPreImageNetBGR<<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, output, outputWidth, outputHeight);
+	if( outputType == TYPE_FP16 )
+		gpuPreImageNetBGR<__half><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (__half*)output, outputWidth, outputHeight, quantize);
+	else if( outputType == TYPE_INT8 )
+		gpuPreImageNetBGR<int8_t><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (int8_t*)output, outputWidth, outputHeight, quantize);
+	else
+		gpuPreImageNetBGR<float><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (float*)output, outputWidth, outputHeight, quantize);
 
 	return CUDA(cudaGetLastError());
 }
 
 
 // gpuPreImageNetMeanRGB
-__global__ void gpuPreImageNetMeanRGB( float2 scale, float4* input, int iWidth, float* output, int oWidth, int oHeight, float3 mean_value )
+template<typename T>
+__global__ void gpuPreImageNetMeanRGB( float2 scale, float4* input, int iWidth, T* output, int oWidth, int oHeight, float3 mean_value, float quantize )
 {
 	const int x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -137,16 +199,16 @@ __global__ void gpuPreImageNetMeanRGB( float2 scale, float4* input, int iWidth,
 	const float4 px  = input[ dy * iWidth + dx ];
 	const float3 bgr = make_float3(px.x - mean_value.x, px.y - mean_value.y, px.z - mean_value.z);
 	
-	output[n * 0 + m] = bgr.x;
-	output[n * 1 + m] = bgr.y;
-	output[n * 2 + m] = bgr.z;
+	output[n * 0 + m] = castOutput<T>(bgr.x, quantize);
+	output[n * 1 + m] = castOutput<T>(bgr.y, quantize);
+	output[n * 2 + m] = castOutput<T>(bgr.z, quantize);
 }
 
 
 // cudaPreImageNetMeanRGB
 cudaError_t cudaPreImageNetMeanRGB( float4* input, size_t inputWidth, size_t inputHeight,
-				                float* output, size_t outputWidth, size_t outputHeight, 
-						      const float3& mean_value, cudaStream_t stream )
+				                void* output, size_t outputWidth, size_t outputHeight, 
+						      const float3& mean_value, cudaStream_t stream, precisionType outputType )
 {
 	if( !input || !output )
 		return cudaErrorInvalidDevicePointer;
@@ -157,18 +219,26 @@ cudaError_t cudaPreImageNetMeanRGB( float4* input, size_t inputWidth, size_t inp
 	const float2 scale = make_float2( float(inputWidth) / float(outputWidth),
 							    float(inputHeight) / float(outputHeight) );
 
+	const float quantize = 127.0f / cudaPreImageNetMeanRange(mean_value);
+
 	// launch kernel
 	const dim3 blockDim(8, 8);
 	const dim3 gridDim(iDivUp(outputWidth,blockDim.x), iDivUp(outputHeight,blockDim.y));
 
-	gpuPreImageNetMeanRGB<<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, output, outputWidth, outputHeight, mean_value);
+	if( outputType == TYPE_FP16 )
+		gpuPreImageNetMeanRGB<__half><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (__half*)output, outputWidth, outputHeight, mean_value, quantize);
+	else if( outputType == TYPE_INT8 )
+		gpuPreImageNetMeanRGB<int8_t><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (int8_t*)output, outputWidth, outputHeight, mean_value, quantize);
+	else
+		gpuPreImageNetMeanRGB<float><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (float*)output, outputWidth, outputHeight, mean_value, quantize);
 
 	return CUDA(cudaGetLastError());
 }
 
 
 // gpuPreImageNetMeanBGR
-__global__ void gpuPreImageNetMeanBGR( float2 scale, float4* input, int iWidth, float* output, int oWidth, int oHeight, float3 mean_value )
+template<typename T>
+__global__ void gpuPreImageNetMeanBGR( float2 scale, float4* input, int iWidth, T* output, int oWidth, int oHeight, float3 mean_value, float quantize )
 {
 	const int x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -185,16 +255,16 @@ __global__ void gpuPreImageNetMeanBGR( float2 scale, float4* input, int iWidth,
 	const float4 px  = input[ dy * iWidth + dx ];
 	const float3 bgr = make_float3(px.z - mean_value.x, px.y - mean_value.y, px.x - mean_value.z);
 	
-	output[n * 0 + m] = bgr.x;
-	output[n * 1 + m] = bgr.y;
-	output[n * 2 + m] = bgr.z;
+	output[n * 0 + m] = castOutput<T>(bgr.x, quantize);
+	output[n * 1 + m] = castOutput<T>(bgr.y, quantize);
+	output[n * 2 + m] = castOutput<T>(bgr.z, quantize);
 }
 
 
 // cudaPreImageNetMeanBGR
 cudaError_t cudaPreImageNetMeanBGR( float4* input, size_t inputWidth, size_t inputHeight,
-				                float* output, size_t outputWidth, size_t outputHeight, 
-						      const float3& mean_value, cudaStream_t stream )
+				                void* output, size_t outputWidth, size_t outputHeight, 
+						      const float3& mean_value, cudaStream_t stream, precisionType outputType )
 {
 	if( !input || !output )
 		return cudaErrorInvalidDevicePointer;
@@ -205,18 +275,26 @@ cudaError_t cudaPreImageNetMeanBGR( float4* input, size_t inputWidth, size_t inp
 	const float2 scale = make_float2( float(inputWidth) / float(outputWidth),
 							    float(inputHeight) / float(outputHeight) );
 
+	const float quantize = 127.0f / cudaPreImageNetMeanRange(mean_value);
+
 	// launch kernel
 	const dim3 blockDim(8, 8);
 	const dim3 gridDim(iDivUp(outputWidth,blockDim.x), iDivUp(outputHeight,blockDim.y));
 
-	gpuPreImageNetMeanBGR<<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, output, outputWidth, outputHeight, mean_value);
+	if( outputType == TYPE_FP16 )
+		gpuPreImageNetMeanBGR<__half><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (__half*)output, outputWidth, outputHeight, mean_value, quantize);
+	else if( outputType == TYPE_INT8 )
+		gpuPreImageNetMeanBGR<int8_t><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (int8_t*)output, outputWidth, outputHeight, mean_value, quantize);
+	else
+		gpuPreImageNetMeanBGR<float><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (float*)output, outputWidth, outputHeight, mean_value, quantize);
 
 	return CUDA(cudaGetLastError());
 }
 
 
 // gpuPreImageNetNormRGB
-__global__ void gpuPreImageNetNormRGB( float2 scale, float4* input, int iWidth, float* output, int oWidth, int oHeight, float multiplier, float min_value )
+template<typename T>
+__global__ void gpuPreImageNetNormRGB( float2 scale, float4* input, int iWidth, T* output, int oWidth, int oHeight, float multiplier, float min_value, float quantize )
 {
 	const int x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -233,16 +311,16 @@ __global__ void gpuPreImageNetNormRGB( float2 scale, float4* input, int iWidth,
 	const float4 px  = input[ dy * iWidth + dx ];
 	const float3 bgr = make_float3(px.x, px.y, px.z);
 	
-	output[n * 0 + m] = bgr.x * multiplier + min_value;
-	output[n * 1 + m] = bgr.y * multiplier + min_value;
-	output[n * 2 + m] = bgr.z * multiplier + min_value;
+	output[n * 0 + m] = castOutput<T>(bgr.x * multiplier + min_value, quantize);
+	output[n * 1 + m] = castOutput<T>(bgr.y * multiplier + min_value, quantize);
+	output[n * 2 + m] = castOutput<T>(bgr.z * multiplier + min_value, quantize);
 }
 
 
 // cudaPreImageNetNormRGB
 cudaError_t cudaPreImageNetNormRGB( float4* input, size_t inputWidth, size_t inputHeight,
-							 float* output, size_t outputWidth, size_t outputHeight,
-							 const float2& range, cudaStream_t stream )
+							 void* output, size_t outputWidth, size_t outputHeight,
+							 const float2& range, cudaStream_t stream, precisionType outputType )
 {
 	if( !input || !output )
 		return cudaErrorInvalidDevicePointer;
@@ -257,18 +335,26 @@ cudaError_t cudaPreImageNetNormRGB( float4* input, size_t inputWidth, size_t inp
 	
 	//printf("cudaPreImageNetNorm([%f, %f])  multiplier=%f\n", range.x, range.y, multiplier);
 	
+	const float quantize = 127.0f / cudaPreImageNetNormRange(range);
+
 	// launch kernel
 	const dim3 blockDim(8, 8);
 	const dim3 gridDim(iDivUp(outputWidth,blockDim.x), iDivUp(outputHeight,blockDim.y));
 
-	gpuPreImageNetNormRGB<<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, output, outputWidth, outputHeight, multiplier, range.x);
+	if( outputType == TYPE_FP16 )
+		gpuPreImageNetNormRGB<__half><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (__half*)output, outputWidth, outputHeight, multiplier, range.x, quantize);
+	else if( outputType == TYPE_INT8 )
+		gpuPreImageNetNormRGB<int8_t><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (int8_t*)output, outputWidth, outputHeight, multiplier, range.x, quantize);
+	else
+		gpuPreImageNetNormRGB<float><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (float*)output, outputWidth, outputHeight, multiplier, range.x, quantize);
 
 	return CUDA(cudaGetLastError());
 }
 
 
 // gpuPreImageNetNormBGR
-__global__ void gpuPreImageNetNormBGR( float2 scale, float4* input, int iWidth, float* output, int oWidth, int oHeight, float multiplier, float min_value )
+template<typename T>
+__global__ void gpuPreImageNetNormBGR( float2 scale, float4* input, int iWidth, T* output, int oWidth, int oHeight, float multiplier, float min_value, float quantize )
 {
 	const int x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -285,16 +371,16 @@ __global__ void gpuPreImageNetNormBGR( float2 scale, float4* input, int iWidth,
 	const float4 px  = input[ dy * iWidth + dx ];
 	const float3 bgr = make_float3(px.z, px.y, px.x);
 	
-	output[n * 0 + m] = bgr.x * multiplier + min_value;
-	output[n * 1 + m] = bgr.y * multiplier + min_value;
-	output[n * 2 + m] = bgr.z * multiplier + min_value;
+	output[n * 0 + m] = castOutput<T>(bgr.x * multiplier + min_value, quantize);
+	output[n * 1 + m] = castOutput<T>(bgr.y * multiplier + min_value, quantize);
+	output[n * 2 + m] = castOutput<T>(bgr.z * multiplier + min_value, quantize);
 }
 
 
 // cudaPreImageNetNorm
 cudaError_t cudaPreImageNetNormBGR( float4* input, size_t inputWidth, size_t inputHeight,
-								 float* output, size_t outputWidth, size_t outputHeight,
-								 const float2& range, cudaStream_t stream )
+								 void* output, size_t outputWidth, size_t outputHeight,
+								 const float2& range, cudaStream_t stream, precisionType outputType )
 {
 	if( !input || !output )
 		return cudaErrorInvalidDevicePointer;
@@ -309,11 +395,18 @@ cudaError_t cudaPreImageNetNormBGR( float4* input, size_t inputWidth, size_t inp
 	
 	//printf("cudaPreImageNetNorm([%f, %f])  multiplier=%f\n", range.x, range.y, multiplier);
 	
+	const float quantize = 127.0f / cudaPreImageNetNormRange(range);
+
 	// launch kernel
 	const dim3 blockDim(8, 8);
 	const dim3 gridDim(iDivUp(outputWidth,blockDim.x), iDivUp(outputHeight,blockDim.y));
 
-	gpuPreImageNetNormBGR<<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, output, outputWidth, outputHeight, multiplier, range.x);
+	if( outputType == TYPE_FP16 )
+		gpuPreImageNetNormBGR<__half><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (__half*)output, outputWidth, outputHeight, multiplier, range.x, quantize);
+	else if( outputType == TYPE_INT8 )
+		gpuPreImageNetNormBGR<int8_t><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (int8_t*)output, outputWidth, outputHeight, multiplier, range.x, quantize);
+	else
+		gpuPreImageNetNormBGR<float><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (float*)output, outputWidth, outputHeight, multiplier, range.x, quantize);
 
 	return CUDA(cudaGetLastError());
 }
@@ -321,7 +414,8 @@ cudaError_t cudaPreImageNetNormBGR( float4* input, size_t inputWidth, size_t inp
 
 
 // gpuPreImageNetNormMeanRGB
-__global__ void gpuPreImageNetNormMeanRGB( float2 scale, float4* input, int iWidth, float* output, int oWidth, int oHeight, float multiplier, float min_value, const float3 mean, const float3 stdDev )
+template<typename T>
+__global__ void gpuPreImageNetNormMeanRGB( float2 scale, float4* input, int iWidth, T* output, int oWidth, int oHeight, float multiplier, float min_value, const float3 mean, const float3 stdDev, float quantize )
 {
 	const int x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -338,14 +432,14 @@ __global__ void gpuPreImageNetNormMeanRGB( float2 scale, float4* input, int iWid
 	const float4 px  = input[ dy * iWidth + dx ];
 	const float3 bgr = make_float3(px.x * multiplier + min_value, px.y * multiplier + min_value, px.z * multiplier + min_value);
 	
-	output[n * 0 + m] = (bgr.x - mean.x) / stdDev.x;
-	output[n * 1 + m] = (bgr.y - mean.y) / stdDev.y;
-	output[n * 2 + m] = (bgr.z - mean.z) / stdDev.z;
+	output[n * 0 + m] = castOutput<T>((bgr.x - mean.x) / stdDev.x, quantize);
+	output[n * 1 + m] = castOutput<T>((bgr.y - mean.y) / stdDev.y, quantize);
+	output[n * 2 + m] = castOutput<T>((bgr.z - mean.z) / stdDev.z, quantize);
 }
 
 
 // cudaPreImageNetNormMeanRGB
-cudaError_t cudaPreImageNetNormMeanRGB( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float2& range, const float3& mean, const float3& stdDev, cudaStream_t stream )
+cudaError_t cudaPreImageNetNormMeanRGB( float4* input, size_t inputWidth, size_t inputHeight, void* output, size_t outputWidth, size_t outputHeight, const float2& range, const float3& mean, const float3& stdDev, cudaStream_t stream, precisionType outputType )
 {
 	if( !input || !output )
 		return cudaErrorInvalidDevicePointer;
@@ -358,18 +452,26 @@ cudaError_t cudaPreImageNetNormMeanRGB( float4* input, size_t inputWidth, size_t
 
 	const float multiplier = (range.y - range.x) / 255.0f;
 	
+	const float quantize = 127.0f / cudaPreImageNetNormMeanRange(range, mean, stdDev);
+
 	// launch kernel
 	const dim3 blockDim(8, 8);
 	const dim3 gridDim(iDivUp(outputWidth,blockDim.x), iDivUp(outputHeight,blockDim.y));
 
-	gpuPreImageNetNormMeanRGB<<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, output, outputWidth, outputHeight, multiplier, range.x, mean, stdDev);
+	if( outputType == TYPE_FP16 )
+		gpuPreImageNetNormMeanRGB<__half><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (__half*)output, outputWidth, outputHeight, multiplier, range.x, mean, stdDev, quantize);
+	else if( outputType == TYPE_INT8 )
+		gpuPreImageNetNormMeanRGB<int8_t><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (int8_t*)output, outputWidth, outputHeight, multiplier, range.x, mean, stdDev, quantize);
+	else
+		gpuPreImageNetNormMeanRGB<float><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (float*)output, outputWidth, outputHeight, multiplier, range.x, mean, stdDev, quantize);
 
 	return CUDA(cudaGetLastError());
 }
 
 
 // gpuPreImageNetNormMeanBGR
-__global__ void gpuPreImageNetNormMeanBGR( float2 scale, float4* input, int iWidth, float* output, int oWidth, int oHeight, float multiplier, float min_value, const float3 mean, const float3 stdDev )
+template<typename T>
+__global__ void gpuPreImageNetNormMeanBGR( float2 scale, float4* input, int iWidth, T* output, int oWidth, int oHeight, float multiplier, float min_value, const float3 mean, const float3 stdDev, float quantize )
 {
 	const int x = blockIdx.x * blockDim.x + threadIdx.x;
 	const int y = blockIdx.y * blockDim.y + threadIdx.y;
@@ -386,14 +488,14 @@ __global__ void gpuPreImageNetNormMeanBGR( float2 scale, float4* input, int iWid
 	const float4 px  = input[ dy * iWidth + dx ];
 	const float3 bgr = make_float3(px.z * multiplier + min_value, px.y * multiplier + min_value, px.x * multiplier + min_value);
 	
-	output[n * 0 + m] = (bgr.x - mean.x) / stdDev.x;
-	output[n * 1 + m] = (bgr.y - mean.y) / stdDev.y;
-	output[n * 2 + m] = (bgr.z - mean.z) / stdDev.z;
+	output[n * 0 + m] = castOutput<T>((bgr.x - mean.x) / stdDev.x, quantize);
+	output[n * 1 + m] = castOutput<T>((bgr.y - mean.y) / stdDev.y, quantize);
+	output[n * 2 + m] = castOutput<T>((bgr.z - mean.z) / stdDev.z, quantize);
 }
 
 
 // cudaPreImageNetNormMeanBGR
-cudaError_t cudaPreImageNetNormMeanBGR( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float2& range, const float3& mean, const float3& stdDev, cudaStream_t stream )
+cudaError_t cudaPreImageNetNormMeanBGR( float4* input, size_t inputWidth, size_t inputHeight, void* output, size_t outputWidth, size_t outputHeight, const float2& range, const float3& mean, const float3& stdDev, cudaStream_t stream, precisionType outputType )
 {
 	if( !input || !output )
 		return cudaErrorInvalidDevicePointer;
@@ -406,11 +508,18 @@ cudaError_t cudaPreImageNetNormMeanBGR( float4* input, size_t inputWidth, size_t
 
 	const float multiplier = (range.y - range.x) / 255.0f;
 	
+	const float quantize = 127.0f / cudaPreImageNetNormMeanRange(range, mean, stdDev);
+
 	// launch kernel
 	const dim3 blockDim(8, 8);
 	const dim3 gridDim(iDivUp(outputWidth,blockDim.x), iDivUp(outputHeight,blockDim.y));
 
-	gpuPreImageNetNormMeanBGR<<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, output, outputWidth, outputHeight, multiplier, range.x, mean, stdDev);
+	if( outputType == TYPE_FP16 )
+		gpuPreImageNetNormMeanBGR<__half><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (__half*)output, outputWidth, outputHeight, multiplier, range.x, mean, stdDev, quantize);
+	else if( outputType == TYPE_INT8 )
+		gpuPreImageNetNormMeanBGR<int8_t><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (int8_t*)output, outputWidth, outputHeight, multiplier, range.x, mean, stdDev, quantize);
+	else
+		gpuPreImageNetNormMeanBGR<float><<<gridDim, blockDim, 0, stream>>>(scale, input, inputWidth, (float*)output, outputWidth, outputHeight, multiplier, range.x, mean, stdDev, quantize);
 
 	return CUDA(cudaGetLastError());
 }
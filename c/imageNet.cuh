@@ -25,31 +25,52 @@
 
 
 #include "cudaUtility.h"
+#include "tensorNet.h"
+
+
+/*
+ * The output is written in the data type of the network's input binding
+ * (TYPE_FP32, TYPE_FP16 or TYPE_INT8), @see tensorNet::GetInputType()
+ *
+ * INT8 is quantized symmetrically over the range of values that the function
+ * writes, which is returned by the matching cudaPreImageNet*Range() below.
+ * That range is also the dynamic range of the network's INT8 input binding
+ * (@see tensorNet::inputRange()).  TensorRT's INT8 tensors have no zero-point,
+ * so a range of [0, 255] is quantized as [-255, 255].
+ */
 
 
 /*
  * Downsample to RGB or BGR, NCHW format
  */
-cudaError_t cudaPreImageNetRGB( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, cudaStream_t stream );
-cudaError_t cudaPreImageNetBGR( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, cudaStream_t stream );
+cudaError_t cudaPreImageNetRGB( float4* input, size_t inputWidth, size_t inputHeight, void* output, size_t outputWidth, size_t outputHeight, cudaStream_t stream, precisionType outputType=TYPE_FP32 );
+cudaError_t cudaPreImageNetBGR( float4* input, size_t inputWidth, size_t inputHeight, void* output, size_t outputWidth, size_t outputHeight, cudaStream_t stream, precisionType outputType=TYPE_FP32 );
 
 /*
  * Downsample and apply mean pixel subtraction, NCHW format
  */
-cudaError_t cudaPreImageNetMeanRGB( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value, cudaStream_t stream );
-cudaError_t cudaPreImageNetMeanBGR( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float3& mean_value, cudaStream_t stream );
+cudaError_t cudaPreImageNetMeanRGB( float4* input, size_t inputWidth, size_t inputHeight, void* output, size_t outputWidth, size_t outputHeight, const float3& mean_value, cudaStream_t stream, precisionType outputType=TYPE_FP32 );
+cudaError_t cudaPreImageNetMeanBGR( float4* input, size_t inputWidth, size_t inputHeight, void* output, size_t outputWidth, size_t outputHeight, const float3& mean_value, cudaStream_t stream, precisionType outputType=TYPE_FP32 );
 
 /*
  * Downsample and apply pixel normalization, NCHW format
  */
-cudaError_t cudaPreImageNetNormRGB( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float2& range, cudaStream_t stream );
-cudaError_t cudaPreImageNetNormBGR( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float2& range, cudaStream_t stream );
+cudaError_t cudaPreImageNetNormRGB( float4* input, size_t inputWidth, size_t inputHeight, void* output, size_t outputWidth, size_t outputHeight, const float2& range, cudaStream_t stream, precisionType outputType=TYPE_FP32 );
+cudaError_t cudaPreImageNetNormBGR( float4* input, size_t inputWidth, size_t inputHeight, void* output, size_t outputWidth, size_t outputHeight, const float2& range, cudaStream_t stream, precisionType outputType=TYPE_FP32 );
 
 /*
  * Downsample and apply pixel normalization, mean pixel subtraction and standard deviation, NCHW format
  */
-cudaError_t cudaPreImageNetNormMeanRGB( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float2& range, const float3& mean, const float3& stdDev, cudaStream_t stream );
-cudaError_t cudaPreImageNetNormMeanBGR( float4* input, size_t inputWidth, size_t inputHeight, float* output, size_t outputWidth, size_t outputHeight, const float2& range, const float3& mean, const float3& stdDev, cudaStream_t stream );
+cudaError_t cudaPreImageNetNormMeanRGB( float4* input, size_t inputWidth, size_t inputHeight, void* output, size_t outputWidth, size_t outputHeight, const float2& range, const float3& mean, const float3& stdDev, cudaStream_t stream, precisionType outputType=TYPE_FP32 );
+cudaError_t cudaPreImageNetNormMeanBGR( float4* input, size_t inputWidth, size_t inputHeight, void* output, size_t outputWidth, size_t outputHeight, const float2& range, const float3& mean, const float3& stdDev, cudaStream_t stream, precisionType outputType=TYPE_FP32 );
+
+/*
+ * The largest magnitude of the values written by each of the functions above
+ */
+float cudaPreImageNetRange();
+float cudaPreImageNetMeanRange( const float3& mean );
+float cudaPreImageNetNormRange( const float2& range );
+float cudaPreImageNetNormMeanRange( const float2& range, const float3& mean, const float3& stdDev );
 
 
 #endif
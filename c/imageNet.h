@@ -61,7 +61,10 @@
 		  "  --labels LABELS      path to text file containing the labels for each class\n" 				\
 		  "  --input_blob INPUT   name of the input layer (default is '" IMAGENET_DEFAULT_INPUT "')\n" 	\
 		  "  --output_blob OUTPUT name of the output layer (default is '" IMAGENET_DEFAULT_OUTPUT "')\n" 	\
-		  "  --batch_size BATCH   maximum batch size (default is 1)\n"
+		  "  --batch_size BATCH   maximum batch size (default is 1)\n"						\
+		  "  --precision TYPE     fp32, fp16, int8, fastest (default) or autotune\n"		\
+		  "  --warmup[=N]         run the network on synthetic frames after loading, until its\n"	\
+		  "                       latency converges (or for up to N iterations, default 50)\n"
 
 
 /**
@@ -160,6 +163,21 @@ public:
 	 */
 	int Classify( float* confidence=NULL );
 
+	/**
+	 * Determine the maximum likelihood class of a batch of images.
+	 * The images are pre-processed into consecutive entries of the input tensor and
+	 * the network is executed once for the whole batch, so batchSize must not exceed
+	 * the maxBatchSize that the network was loaded with (@see GetMaxBatchSize()).
+	 * @param rgba array of float4 input images in CUDA device memory.
+	 * @param width width of the input images in pixels.
+	 * @param height height of the input images in pixels.
+	 * @param batchSize the number of images in the batch.
+	 * @param classIndex array of batchSize entries filled with the index of the maximum class.
+	 * @param confidence optional array of batchSize entries filled with the confidence values.
+	 * @returns true on success, false on error.
+	 */
+	bool ClassifyBatch( float** rgba, uint32_t width, uint32_t height, uint32_t batchSize, int* classIndex, float* confidence=NULL );
+
 	/**
 	 * Perform pre-processing on the image to apply mean-value subtraction and
 	 * to organize the data into NCHW format and BGR colorspace that the networks expect.
@@ -170,8 +188,9 @@ public:
 	/**
 	 * Process the network, without determining the classification argmax.
 	 * To perform the actual classification via post-processing, Classify() should be used instead.
+	 * @param batchSize the number of entries in the input tensor to process.
 	 */
-	bool Process();
+	bool Process( uint32_t batchSize=1 );
 
 	/**
 	 * Retrieve the number of image recognition classes (typically 1000)
@@ -219,6 +238,12 @@ protected:
 	bool init( NetworkType networkType, uint32_t maxBatchSize, precisionType precision, deviceType device, bool allowGPUFallback );
 	bool init(const char* prototxt_path, const char* model_path, const char* mean_binary, const char* class_path, const char* input, const char* output, uint32_t maxBatchSize, precisionType precision, deviceType device, bool allowGPUFallback );
 	bool loadClassInfo( const char* filename, int expectedClasses=-1 );
+
+	bool preProcess( float* rgba, uint32_t width, uint32_t height, uint32_t batchIndex );
+	int  classify( uint32_t batchIndex, float* confidence );
+
+	virtual bool warmupIteration( float* rgba, uint32_t width, uint32_t height );
+	virtual float inputRange() const;
 	
 	uint32_t mOutputClasses;
 	
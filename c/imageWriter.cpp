@@ -0,0 +1,442 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "imageWriter.h"
+#include "threadConfig.h"
+
+#include "cudaMappedMemory.h"
+#include "loadImage.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+
+// current time in seconds
+static inline double timeSeconds()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+
+// constructor
+imageWriter::imageWriter( int quality )
+{
+	mQuality    = quality;
+	mActive     = 0;
+	mStop       = false;
+	mWritten    = 0;
+	mFailed     = 0;
+	mMaxQueued  = 0;
+	mWriterTime = 0.0;
+	mWaitTime   = 0.0;
+
+	pthread_mutex_init(&mMutex, NULL);
+	pthread_cond_init(&mWorkerCond, NULL);
+	pthread_cond_init(&mProducerCond, NULL);
+}
+
+
+// destructor
+imageWriter::~imageWriter()
+{
+	Flush();
+
+	pthread_mutex_lock(&mMutex);
+	mStop = true;
+	pthread_cond_broadcast(&mWorkerCond);
+	pthread_mutex_unlock(&mMutex);
+
+	for( size_t n=0; n < mThreads.size(); n++ )
+		pthread_join(mThreads[n].handle, NULL);
+
+	for( size_t n=0; n < mBuffers.size(); n++ )
+	{
+		if( mBuffers[n].cpu != NULL )
+			CUDA(cudaFreeHost(mBuffers[n].cpu));
+	}
+
+	pthread_cond_destroy(&mProducerCond);
+	pthread_cond_destroy(&mWorkerCond);
+	pthread_mutex_destroy(&mMutex);
+}
+
+
+// Create
+imageWriter* imageWriter::Create( uint32_t numThreads, uint32_t numBuffers, int quality )
+{
+	imageWriter* writer = new imageWriter(quality);
+
+	if( !writer->init(numThreads, numBuffers) )
+	{
+		printf(LOG_WRITER "failed to create image writer\n");
+		delete writer;
+		return NULL;
+	}
+
+	return writer;
+}
+
+
+// init
+bool imageWriter::init( uint32_t numThreads, uint32_t numBuffers )
+{
+	if( numThreads == 0 )
+		numThreads = 1;
+
+	if( numBuffers == 0 )
+		numBuffers = numThreads * 2;
+
+	// the buffers are allocated on first use, at the size of the image
+	mBuffers.resize(numBuffers);
+
+	for( uint32_t n=0; n < numBuffers; n++ )
+	{
+		mBuffers[n].cpu  = NULL;
+		mBuffers[n].gpu  = NULL;
+		mBuffers[n].size = 0;
+		mBuffers[n].busy = false;
+	}
+
+	mThreads.resize(numThreads);
+
+	for( uint32_t n=0; n < numThreads; n++ )
+	{
+		mThreads[n].writer = this;
+		mThreads[n].index  = n;
+
+		if( pthread_create(&mThreads[n].handle, NULL, threadEntry, &mThreads[n]) != 0 )
+		{
+			printf(LOG_WRITER "failed to create writer thread %u\n", n);
+			mThreads.resize(n);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+// Acquire
+bool imageWriter::Acquire( uint32_t width, uint32_t height, float4** cpu, float4** gpu )
+{
+	if( !cpu || !gpu || width == 0 || height == 0 )
+		return false;
+
+	const size_t size = size_t(width) * size_t(height) * sizeof(float4);
+
+	pthread_mutex_lock(&mMutex);
+
+	int index = -1;
+	double waitBegin = 0.0;
+
+	while( true )
+	{
+		// prefer a free buffer that's already large enough
+		for( size_t n=0; n < mBuffers.size(); n++ )
+		{
+			if( mBuffers[n].busy )
+				continue;
+
+			if( index < 0 || (mBuffers[n].size >= size && mBuffers[index].size < size) )
+				index = n;
+		}
+
+		if( index >= 0 )
+			break;
+
+		// every buffer is queued -- wait for a writer to finish one
+		if( waitBegin == 0.0 )
+			waitBegin = timeSeconds();
+
+		pthread_cond_wait(&mProducerCond, &mMutex);
+	}
+
+	if( waitBegin != 0.0 )
+		mWaitTime += timeSeconds() - waitBegin;
+
+	buffer& buf = mBuffers[index];
+	buf.busy = true;
+
+	pthread_mutex_unlock(&mMutex);
+
+	// grow the buffer outside of the lock (it's marked busy, so no one else uses it)
+	if( size > buf.size )
+	{
+		if( buf.cpu != NULL )
+			CUDA(cudaFreeHost(buf.cpu));
+
+		buf.cpu  = NULL;
+		buf.gpu  = NULL;
+		buf.size = 0;
+
+		if( !cudaAllocMapped((void**)&buf.cpu, (void**)&buf.gpu, size) )
+		{
+			printf(LOG_WRITER "failed to allocate %ux%u frame buffer\n", width, height);
+
+			pthread_mutex_lock(&mMutex);
+			buf.busy = false;
+			pthread_cond_signal(&mProducerCond);
+			pthread_mutex_unlock(&mMutex);
+
+			return false;
+		}
+
+		buf.size = size;
+	}
+
+	*cpu = buf.cpu;
+	*gpu = buf.gpu;
+
+	return true;
+}
+
+
+// Write
+bool imageWriter::Write( const char* filename, float4* cpu, uint32_t width, uint32_t height )
+{
+	if( !filename || !cpu )
+		return false;
+
+	pthread_mutex_lock(&mMutex);
+
+	int index = -1;
+
+	for( size_t n=0; n < mBuffers.size(); n++ )
+	{
+		if( mBuffers[n].cpu == cpu && mBuffers[n].busy )
+		{
+			index = n;
+			break;
+		}
+	}
+
+	if( index < 0 || size_t(width) * size_t(height) * sizeof(float4) > mBuffers[index].size )
+	{
+		pthread_mutex_unlock(&mMutex);
+		printf(LOG_WRITER "Write() was called with a buffer that wasn't acquired from the writer ('%s')\n", filename);
+		return false;
+	}
+
+	job j;
+
+	j.buffer   = index;
+	j.filename = filename;
+	j.width    = width;
+	j.height   = height;
+
+	mJobs.push_back(j);
+
+	if( mJobs.size() > mMaxQueued )
+		mMaxQueued = mJobs.size();
+
+	pthread_cond_signal(&mWorkerCond);
+	pthread_mutex_unlock(&mMutex);
+
+	return true;
+}
+
+
+// Discard
+void imageWriter::Discard( float4* cpu )
+{
+	if( !cpu )
+		return;
+
+	pthread_mutex_lock(&mMutex);
+
+	for( size_t n=0; n < mBuffers.size(); n++ )
+	{
+		if( mBuffers[n].cpu == cpu && mBuffers[n].busy )
+		{
+			mBuffers[n].busy = false;
+			pthread_cond_signal(&mProducerCond);
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// WriteCopy
+bool imageWriter::WriteCopy( const char* filename, const float4* image, uint32_t width, uint32_t height )
+{
+	if( !filename || !image )
+		return false;
+
+	float4* cpu = NULL;
+	float4* gpu = NULL;
+
+	if( !Acquire(width, height, &cpu, &gpu) )
+		return false;
+
+	memcpy(cpu, image, size_t(width) * size_t(height) * sizeof(float4));
+	return Write(filename, cpu, width, height);
+}
+
+
+// Flush
+void imageWriter::Flush()
+{
+	pthread_mutex_lock(&mMutex);
+
+	const double waitBegin = timeSeconds();
+
+	while( mJobs.size() > 0 || mActive > 0 )
+		pthread_cond_wait(&mProducerCond, &mMutex);
+
+	mWaitTime += timeSeconds() - waitBegin;
+
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// threadEntry
+void* imageWriter::threadEntry( void* param )
+{
+	worker* w = (worker*)param;
+
+	char name[16];
+	snprintf(name, sizeof(name), "writer-%u", w->index);
+	threadConfig::ApplyStage("writer", name);
+
+	w->writer->run(w->index);
+	return NULL;
+}
+
+
+// run
+void imageWriter::run( uint32_t thread )
+{
+	imageEncoder encoder(mQuality);
+
+	pthread_mutex_lock(&mMutex);
+
+	while( true )
+	{
+		while( !mStop && mJobs.size() == 0 )
+			pthread_cond_wait(&mWorkerCond, &mMutex);
+
+		// the queue is drained before stopping
+		if( mJobs.size() == 0 )
+			break;
+
+		const job j = mJobs.front();
+		mJobs.pop_front();
+		mActive++;
+
+		const buffer& buf = mBuffers[j.buffer];
+
+		pthread_mutex_unlock(&mMutex);
+
+		const double begin = timeSeconds();
+		bool success = false;
+
+		if( imageEncoder::IsSupported(j.filename.c_str()) )
+			success = encoder.Encode(j.filename.c_str(), (float*)buf.cpu, j.width, j.height);
+		else
+			success = saveImageRGBA(j.filename.c_str(), buf.cpu, j.width, j.height);
+
+		const double elapsed = timeSeconds() - begin;
+
+		if( !success )
+			printf(LOG_WRITER "failed to write '%s'\n", j.filename.c_str());
+
+		pthread_mutex_lock(&mMutex);
+
+		mBuffers[j.buffer].busy = false;
+		mActive--;
+
+		mWriterTime += elapsed;
+
+		if( success )
+			mWritten++;
+		else
+			mFailed++;
+
+		pthread_cond_broadcast(&mProducerCond);
+	}
+
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// PrintStats
+void imageWriter::PrintStats() const
+{
+	pthread_mutex_lock(&mMutex);
+
+	const uint64_t images = mWritten + mFailed;
+	const double hidden = (mWriterTime > mWaitTime) ? mWriterTime - mWaitTime : 0.0;
+
+	printf(LOG_WRITER "wrote %llu images (%llu failed) with %zu threads and %zu buffers, up to %u queued\n",
+		  (unsigned long long)mWritten, (unsigned long long)mFailed, mThreads.size(), mBuffers.size(), mMaxQueued);
+
+	printf(LOG_WRITER "encode and write time %.3f s (%.2f ms per image), producer waited %.3f s\n",
+		  mWriterTime, (images > 0) ? mWriterTime * 1000.0 / images : 0.0, mWaitTime);
+
+	printf(LOG_WRITER "%.3f s of writer time hidden behind the producer (%.1f%%)\n",
+		  hidden, (mWriterTime > 0.0) ? hidden / mWriterTime * 100.0 : 0.0);
+
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// OutputPath
+std::string imageWriter::OutputPath( const char* directory, const char* inputFilename, const char* extension )
+{
+	if( !inputFilename )
+		return "";
+
+	std::string name = inputFilename;
+
+	const size_t slash = name.find_last_of('/');
+
+	if( slash != std::string::npos )
+		name = name.substr(slash + 1);
+
+	if( extension != NULL )
+	{
+		const size_t dot = name.find_last_of('.');
+
+		if( dot != std::string::npos )
+			name = name.substr(0, dot);
+
+		name += ".";
+		name += extension;
+	}
+
+	if( !directory || directory[0] == '\0' )
+		return name;
+
+	if( mkdir(directory, 0755) != 0 && errno != EEXIST )
+		printf(LOG_WRITER "failed to create directory '%s'\n", directory);
+
+	return std::string(directory) + "/" + name;
+}
+
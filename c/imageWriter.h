@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __IMAGE_WRITER_H__
+#define __IMAGE_WRITER_H__
+
+#include "imageEncode.h"
+#include "cudaUtility.h"
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <deque>
+
+
+/**
+ * Asynchronous sink that encodes and writes images to disk on a pool of writer
+ * threads, so that the encoding and disk time overlaps with inference.
+ *
+ * The writer owns a pool of mapped (pinned) frame buffers.  The producer either
+ * acquires a buffer with Acquire(), renders the output into it (i.e. with the GPU
+ * pointer) and hands it back with Write(), or copies a finished image into the
+ * pool with WriteCopy().  After the file is written, the buffer is returned to
+ * the pool for reuse.  When every buffer is queued or being written, Acquire()
+ * blocks -- this bounds the queue and pushes back on a producer that outruns the disk.
+ *
+ * The files are encoded by imageEncoder (JPEG, PNG or raw, by the extension) and
+ * the other formats by saveImageRGBA().  PrintStats() reports how much of the
+ * writers' time was hidden behind the producer, versus how long the producer
+ * waited on them.  The writers apply the "writer" stage of threadConfig.
+ * @ingroup imageWriter
+ */
+class imageWriter
+{
+public:
+	/**
+	 * Create an image writer.
+	 * @param numThreads number of writer threads
+	 * @param numBuffers number of frame buffers, which bounds the queue (0 for twice the number of threads)
+	 * @param quality JPEG quality (1-100)
+	 */
+	static imageWriter* Create( uint32_t numThreads=2, uint32_t numBuffers=0, int quality=95 );
+
+	/**
+	 * Destructor -- waits for the queued images to be written.
+	 */
+	~imageWriter();
+
+	/**
+	 * Acquire a free frame buffer of at least width * height float4 pixels,
+	 * blocking until one is available.  The buffer must be passed to Write().
+	 * @returns false if the buffer couldn't be allocated.
+	 */
+	bool Acquire( uint32_t width, uint32_t height, float4** cpu, float4** gpu );
+
+	/**
+	 * Queue a buffer from Acquire() to be written to a file.  The writer takes
+	 * ownership of the buffer, and returns it to the pool once it's written.
+	 * Any GPU work that writes to the buffer must be complete beforehand.
+	 * @returns false if the buffer doesn't belong to the writer.
+	 */
+	bool Write( const char* filename, float4* cpu, uint32_t width, uint32_t height );
+
+	/**
+	 * Return a buffer from Acquire() to the pool without writing it.
+	 */
+	void Discard( float4* cpu );
+
+	/**
+	 * Copy an image into a frame buffer and queue it to be written to a file
+	 * (blocking while the queue is full).  The image may be reused when this returns.
+	 */
+	bool WriteCopy( const char* filename, const float4* image, uint32_t width, uint32_t height );
+
+	/**
+	 * Wait until every queued image has been written.
+	 */
+	void Flush();
+
+	/**
+	 * Print the number of images written, the time the writers spent encoding and
+	 * writing them, and how much of that time was hidden from the producer.
+	 */
+	void PrintStats() const;
+
+	/**
+	 * Number of writer threads.
+	 */
+	inline uint32_t GetNumThreads() const			{ return mThreads.size(); }
+
+	/**
+	 * Number of frame buffers (the bound on the queue).
+	 */
+	inline uint32_t GetNumBuffers() const			{ return mBuffers.size(); }
+
+	/**
+	 * Build the path of an output file in a directory, from the name of the input
+	 * file and optionally a different extension (i.e. "jpg", "png" or "raw").
+	 * The directory is created if it doesn't exist.
+	 */
+	static std::string OutputPath( const char* directory, const char* inputFilename, const char* extension=NULL );
+
+protected:
+	imageWriter( int quality );
+	bool init( uint32_t numThreads, uint32_t numBuffers );
+
+	static void* threadEntry( void* param );
+	void run( uint32_t thread );
+
+	struct buffer
+	{
+		float4* cpu;
+		float4* gpu;
+		size_t  size;
+		bool    busy;
+	};
+
+	struct job
+	{
+		int         buffer;
+		std::string filename;
+		uint32_t    width;
+		uint32_t    height;
+	};
+
+	struct worker
+	{
+		imageWriter* writer;
+		uint32_t     index;
+		pthread_t    handle;
+	};
+
+	int mQuality;
+
+	std::vector<buffer> mBuffers;
+	std::vector<worker> mThreads;
+	std::deque<job>     mJobs;
+
+	uint32_t mActive;		// images being written
+	bool     mStop;
+
+	// statistics
+	uint64_t mWritten;
+	uint64_t mFailed;
+	uint32_t mMaxQueued;
+	double   mWriterTime;		// seconds the writers spent encoding and writing
+	double   mWaitTime;		// seconds the producer was blocked in Acquire() and Flush()
+
+	mutable pthread_mutex_t mMutex;
+	pthread_cond_t mWorkerCond;
+	pthread_cond_t mProducerCond;
+};
+
+
+#endif
+
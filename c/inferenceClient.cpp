@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "inferenceClient.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+
+// createSharedMemory
+static int createSharedMemory( size_t size )
+{
+	int fd = -1;
+
+#ifdef SYS_memfd_create
+	fd = syscall(SYS_memfd_create, "jetson-inference", 0);
+#endif
+
+	// fall back to an unlinked POSIX shared-memory object on older kernels
+	if( fd < 0 )
+	{
+		char name[64];
+		sprintf(name, "/jetson-inference-%i", (int)getpid());
+
+		fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+
+		if( fd < 0 )
+		{
+			printf(LOG_INFERENCE_IPC "failed to create shared memory (%s)\n", strerror(errno));
+			return -1;
+		}
+
+		shm_unlink(name);
+	}
+
+	if( ftruncate(fd, size) != 0 )
+	{
+		printf(LOG_INFERENCE_IPC "failed to allocate %zu bytes of shared memory (%s)\n", size, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+
+// constructor
+inferenceClient::inferenceClient()
+{
+	mSocket    = -1;
+	mMemory    = -1;
+	mMapping   = NULL;
+	mSlotSize  = 0;
+	mNumSlots  = 0;
+	mMaxWidth  = 0;
+	mMaxHeight = 0;
+	mSequence  = 0;
+	mPending   = 0;
+}
+
+
+// destructor
+inferenceClient::~inferenceClient()
+{
+	if( mSocket >= 0 )
+		close(mSocket);
+
+	if( mMapping != NULL )
+		munmap(mMapping, mSlotSize * mNumSlots);
+
+	if( mMemory >= 0 )
+		close(mMemory);
+}
+
+
+// Create
+inferenceClient* inferenceClient::Create( uint32_t maxWidth, uint32_t maxHeight, uint32_t numSlots, const char* socketPath )
+{
+	inferenceClient* client = new inferenceClient();
+
+	if( !client->init(maxWidth, maxHeight, numSlots, socketPath) )
+	{
+		printf(LOG_INFERENCE_IPC "failed to connect to inference daemon at %s\n", socketPath);
+		delete client;
+		return NULL;
+	}
+
+	return client;
+}
+
+
+// init
+bool inferenceClient::init( uint32_t maxWidth, uint32_t maxHeight, uint32_t numSlots, const char* socketPath )
+{
+	if( maxWidth == 0 || maxHeight == 0 || numSlots == 0 || !socketPath )
+		return false;
+
+	mMaxWidth  = maxWidth;
+	mMaxHeight = maxHeight;
+	mNumSlots  = numSlots;
+	mSlotSize  = inferenceSlotSize(maxWidth, maxHeight);
+
+	// allocate and map the ring
+	const size_t size = mSlotSize * mNumSlots;
+
+	mMemory = createSharedMemory(size);
+
+	if( mMemory < 0 )
+		return false;
+
+	void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, mMemory, 0);
+
+	if( mapping == MAP_FAILED )
+	{
+		printf(LOG_INFERENCE_IPC "failed to map %zu bytes of shared memory (%s)\n", size, strerror(errno));
+		return false;
+	}
+
+	mMapping = (uint8_t*)mapping;
+
+	// connect to the daemon
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+
+	if( strlen(socketPath) >= sizeof(addr.sun_path) )
+	{
+		printf(LOG_INFERENCE_IPC "socket path is too long (%s)\n", socketPath);
+		return false;
+	}
+
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socketPath);
+
+	mSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if( mSocket < 0 || connect(mSocket, (struct sockaddr*)&addr, sizeof(addr)) != 0 )
+	{
+		printf(LOG_INFERENCE_IPC "failed to connect to %s (%s)\n", socketPath, strerror(errno));
+		return false;
+	}
+
+	// pass the ring to the daemon
+	inferenceMessage msg;
+	memset(&msg, 0, sizeof(msg));
+
+	msg.magic    = INFERENCE_PROTOCOL_MAGIC;
+	msg.type     = INFERENCE_MSG_ATTACH;
+	msg.sequence = mSequence++;
+	msg.width    = maxWidth;
+	msg.height   = maxHeight;
+	msg.numSlots = numSlots;
+	msg.slotSize = mSlotSize;
+
+	if( !inferenceSendMessage(mSocket, msg, mMemory) )
+		return false;
+
+	if( !inferenceRecvMessage(mSocket, &msg) || msg.type != INFERENCE_MSG_ATTACH_REPLY )
+		return false;
+
+	if( msg.status != 0 )
+	{
+		printf(LOG_INFERENCE_IPC "inference daemon failed to attach shared memory (%s)\n", strerror(-msg.status));
+		return false;
+	}
+
+	printf(LOG_INFERENCE_IPC "connected to %s (%u slots of %zu bytes)\n", socketPath, mNumSlots, mSlotSize);
+	return true;
+}
+
+
+// GetImage
+float* inferenceClient::GetImage( uint32_t slot ) const
+{
+	if( slot >= mNumSlots )
+		return NULL;
+
+	return (float*)(mMapping + mSlotSize * slot + INFERENCE_IMAGE_OFFSET);
+}
+
+
+// GetResults
+const inferenceResult* inferenceClient::GetResults( uint32_t slot ) const
+{
+	if( slot >= mNumSlots )
+		return NULL;
+
+	return (const inferenceResult*)(mMapping + mSlotSize * slot);
+}
+
+
+// Submit
+bool inferenceClient::Submit( uint32_t slot, inferenceNetwork network, uint32_t width, uint32_t height, uint32_t flags )
+{
+	if( slot >= mNumSlots || width == 0 || height == 0 || width > mMaxWidth || height > mMaxHeight )
+	{
+		printf(LOG_INFERENCE_IPC "inferenceClient::Submit() -- invalid slot %u or frame size %ux%u\n", slot, width, height);
+		return false;
+	}
+
+	inferenceMessage msg;
+	memset(&msg, 0, sizeof(msg));
+
+	msg.magic    = INFERENCE_PROTOCOL_MAGIC;
+	msg.type     = INFERENCE_MSG_REQUEST;
+	msg.sequence = mSequence++;
+	msg.slot     = slot;
+	msg.network  = network;
+	msg.width    = width;
+	msg.height   = height;
+	msg.flags    = flags;
+
+	if( !inferenceSendMessage(mSocket, msg) )
+		return false;
+
+	mPending++;
+	return true;
+}
+
+
+// Receive
+int inferenceClient::Receive( uint32_t* slot )
+{
+	if( mPending == 0 )
+	{
+		printf(LOG_INFERENCE_IPC "inferenceClient::Receive() -- no requests are pending\n");
+		return -1;
+	}
+
+	inferenceMessage msg;
+
+	if( !inferenceRecvMessage(mSocket, &msg) || msg.type != INFERENCE_MSG_RESPONSE )
+	{
+		printf(LOG_INFERENCE_IPC "inferenceClient::Receive() -- lost connection to the inference daemon\n");
+		return -1;
+	}
+
+	mPending--;
+
+	if( slot != NULL )
+		*slot = msg.slot;
+
+	if( msg.status != 0 )
+	{
+		printf(LOG_INFERENCE_IPC "inferenceClient::Receive() -- request failed (%s)\n", strerror(-msg.status));
+		return -1;
+	}
+
+	return msg.numResults;
+}
+
+
+// Process
+int inferenceClient::Process( uint32_t slot, inferenceNetwork network, uint32_t width, uint32_t height, uint32_t flags )
+{
+	if( mPending != 0 )
+	{
+		printf(LOG_INFERENCE_IPC "inferenceClient::Process() -- can't be mixed with pending Submit() requests\n");
+		return -1;
+	}
+
+	if( !Submit(slot, network, width, height, flags) )
+		return -1;
+
+	return Receive(NULL);
+}
+
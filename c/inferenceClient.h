@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __INFERENCE_CLIENT_H__
+#define __INFERENCE_CLIENT_H__
+
+#include "inferenceProtocol.h"
+
+
+/**
+ * Client of inference-daemon, which lets several processes share the networks
+ * that the daemon has loaded instead of each loading their own copy.
+ *
+ * Frames are exchanged through a ring of shared-memory slots that the client
+ * allocates (with memfd) and passes to the daemon over the Unix socket.  To
+ * process a frame, write it into a slot with GetImage(), then call Process()
+ * (or Submit() and Receive() to keep several frames in flight).  The daemon
+ * runs the network directly on the shared memory and writes the results back
+ * into the same slot, so neither the frame nor the results are copied.
+ *
+ * inferenceClient only depends on the C library, so it can be linked into
+ * processes that don't use CUDA.
+ * @ingroup inferenceDaemon
+ */
+class inferenceClient
+{
+public:
+	/**
+	 * Connect to the daemon and attach a shared-memory ring.
+	 * @param maxWidth maximum width of the frames (in pixels)
+	 * @param maxHeight maximum height of the frames (in pixels)
+	 * @param numSlots number of slots in the ring (the max number of frames in flight)
+	 * @param socketPath path to the daemon's socket
+	 */
+	static inferenceClient* Create( uint32_t maxWidth, uint32_t maxHeight, uint32_t numSlots=4,
+							  const char* socketPath=INFERENCE_DEFAULT_SOCKET );
+
+	/**
+	 * Destroy, disconnecting from the daemon.
+	 */
+	~inferenceClient();
+
+	/**
+	 * Retrieve the RGBA float4 image of a slot, to write the frame into.
+	 */
+	float* GetImage( uint32_t slot ) const;
+
+	/**
+	 * Retrieve the results of a slot, after Process() or Receive() has returned.
+	 */
+	const inferenceResult* GetResults( uint32_t slot ) const;
+
+	/**
+	 * Process the frame in a slot and wait for the results.
+	 * @returns the number of results, or -1 on error.
+	 */
+	int Process( uint32_t slot, inferenceNetwork network, uint32_t width, uint32_t height, uint32_t flags=0 );
+
+	/**
+	 * Queue the frame in a slot for processing, without waiting.
+	 * The slot shouldn't be modified until it's returned by Receive().
+	 */
+	bool Submit( uint32_t slot, inferenceNetwork network, uint32_t width, uint32_t height, uint32_t flags=0 );
+
+	/**
+	 * Wait for the next response (the daemon replies in the order the requests were submitted).
+	 * @param slot returns the slot that was processed
+	 * @returns the number of results, or -1 on error.
+	 */
+	int Receive( uint32_t* slot );
+
+	/**
+	 * Retrieve the number of slots in the ring.
+	 */
+	inline uint32_t GetNumSlots() const			{ return mNumSlots; }
+
+	/**
+	 * Retrieve the maximum width of the frames (in pixels).
+	 */
+	inline uint32_t GetMaxWidth() const			{ return mMaxWidth; }
+
+	/**
+	 * Retrieve the maximum height of the frames (in pixels).
+	 */
+	inline uint32_t GetMaxHeight() const			{ return mMaxHeight; }
+
+	/**
+	 * Retrieve the number of requests that have been submitted and not yet received.
+	 */
+	inline uint32_t GetPending() const			{ return mPending; }
+
+protected:
+	inferenceClient();
+
+	bool init( uint32_t maxWidth, uint32_t maxHeight, uint32_t numSlots, const char* socketPath );
+
+	int      mSocket;
+	int      mMemory;
+	uint8_t* mMapping;
+	size_t   mSlotSize;
+	uint32_t mNumSlots;
+	uint32_t mMaxWidth;
+	uint32_t mMaxHeight;
+	uint32_t mSequence;
+	uint32_t mPending;
+};
+
+#endif
+
@@ -0,0 +1,548 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "inferenceMetrics.h"
+#include "profilerHistogram.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <poll.h>
+
+#include <algorithm>
+#include <vector>
+
+
+// registered metric
+struct metricEntry
+{
+	std::string name;
+	std::string help;
+	std::string labels;
+
+	metricCounter* counter;
+	metricGauge*   gauge;
+};
+
+static bool compareEntries( const metricEntry* a, const metricEntry* b )
+{
+	return a->name < b->name;
+}
+
+
+// process-wide state of the exporter (constructed on first use)
+struct metricsState
+{
+	metricsState()
+	{
+		pthread_mutex_init(&mutex, NULL);
+
+		serverSocket  = -1;
+		serverPort    = 0;
+		serverStarted = false;
+		fileStarted   = false;
+		fileInterval  = 0;
+		stop          = false;
+	}
+
+	pthread_mutex_t mutex;
+
+	std::vector<metricEntry*> entries;
+	std::vector< std::pair<inferenceMetrics::Collector, void*> > collectors;
+
+	pthread_t serverThread;
+	int       serverSocket;
+	uint16_t  serverPort;
+	bool      serverStarted;
+
+	pthread_t   fileThread;
+	std::string filePath;
+	uint32_t    fileInterval;
+	bool        fileStarted;
+
+	std::atomic<bool> stop;
+};
+
+static metricsState& state()
+{
+	static metricsState* s = new metricsState();	// never destroyed, counters stay valid during exit
+	return *s;
+}
+
+
+// findEntry
+static metricEntry* findEntry( const char* name, const char* help, const char* labels, bool gauge )
+{
+	if( !name )
+		return NULL;
+
+	metricsState& s = state();
+	metricEntry* entry = NULL;
+
+	pthread_mutex_lock(&s.mutex);
+
+	for( size_t n=0; n < s.entries.size(); n++ )
+	{
+		if( s.entries[n]->name == name && s.entries[n]->labels == (labels != NULL ? labels : "") )
+		{
+			entry = s.entries[n];
+			break;
+		}
+	}
+
+	if( !entry )
+	{
+		entry = new metricEntry();
+
+		entry->name    = name;
+		entry->help    = (help != NULL) ? help : "";
+		entry->labels  = (labels != NULL) ? labels : "";
+		entry->counter = gauge ? NULL : new metricCounter();
+		entry->gauge   = gauge ? new metricGauge() : NULL;
+
+		s.entries.push_back(entry);
+	}
+
+	pthread_mutex_unlock(&s.mutex);
+
+	if( (gauge && !entry->gauge) || (!gauge && !entry->counter) )
+	{
+		printf(LOG_METRICS "metric '%s' was already registered as a %s\n", name, gauge ? "counter" : "gauge");
+		return NULL;
+	}
+
+	return entry;
+}
+
+
+// Counter
+metricCounter* inferenceMetrics::Counter( const char* name, const char* help, const char* labels )
+{
+	metricEntry* entry = findEntry(name, help, labels, false);
+	return (entry != NULL) ? entry->counter : NULL;
+}
+
+
+// Gauge
+metricGauge* inferenceMetrics::Gauge( const char* name, const char* help, const char* labels )
+{
+	metricEntry* entry = findEntry(name, help, labels, true);
+	return (entry != NULL) ? entry->gauge : NULL;
+}
+
+
+// AddCollector
+void inferenceMetrics::AddCollector( Collector collector, void* user )
+{
+	if( !collector )
+		return;
+
+	metricsState& s = state();
+
+	pthread_mutex_lock(&s.mutex);
+	s.collectors.push_back(std::make_pair(collector, user));
+	pthread_mutex_unlock(&s.mutex);
+}
+
+
+// RemoveCollector
+void inferenceMetrics::RemoveCollector( Collector collector, void* user )
+{
+	metricsState& s = state();
+
+	pthread_mutex_lock(&s.mutex);
+
+	for( size_t n=0; n < s.collectors.size(); n++ )
+	{
+		if( s.collectors[n].first == collector && s.collectors[n].second == user )
+		{
+			s.collectors.erase(s.collectors.begin() + n);
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&s.mutex);
+}
+
+
+// FormatHeader
+void inferenceMetrics::FormatHeader( std::string& output, const char* name, const char* help, const char* type )
+{
+	output += "# HELP ";
+	output += name;
+	output += " ";
+	output += help;
+	output += "\n# TYPE ";
+	output += name;
+	output += " ";
+	output += type;
+	output += "\n";
+}
+
+
+// FormatValue
+void inferenceMetrics::FormatValue( std::string& output, const char* name, const char* labels, double value )
+{
+	char str[64];
+	snprintf(str, sizeof(str), " %.9g\n", value);
+
+	output += name;
+
+	if( labels != NULL && labels[0] != '\0' )
+	{
+		output += "{";
+		output += labels;
+		output += "}";
+	}
+
+	output += str;
+}
+
+
+// FormatHistogram
+void inferenceMetrics::FormatHistogram( std::string& output, const char* name, const char* labels, const profilerHistogram& histogram )
+{
+	const std::string bucketName = std::string(name) + "_bucket";
+	const std::string prefix = (labels != NULL && labels[0] != '\0') ? std::string(labels) + "," : std::string();
+
+	// the count is read first, so the buckets (read after) are never less than it implies
+	const uint64_t count = histogram.GetCount();
+	uint64_t cumulative = 0;
+
+	// export one boundary per octave to keep the output compact (the last bucket is the overflow)
+	for( uint32_t n=0; n < profilerHistogram::NumBuckets - 1; n++ )
+	{
+		cumulative += histogram.GetBucketCount(n);
+
+		if( (n % 4) != 3 )
+			continue;
+
+		char le[64];
+		snprintf(le, sizeof(le), "le=\"%g\"", profilerHistogram::GetBucketLimit(n) * 0.001);
+
+		FormatValue(output, bucketName.c_str(), (prefix + le).c_str(), std::min(cumulative, count));
+	}
+
+	FormatValue(output, bucketName.c_str(), (prefix + "le=\"+Inf\"").c_str(), count);
+	FormatValue(output, (std::string(name) + "_sum").c_str(), labels, histogram.GetMean() * count * 0.001);
+	FormatValue(output, (std::string(name) + "_count").c_str(), labels, count);
+}
+
+
+// Format
+std::string inferenceMetrics::Format()
+{
+	metricsState& s = state();
+	std::string output;
+
+	pthread_mutex_lock(&s.mutex);
+
+	// group the samples of each family under one header
+	std::vector<metricEntry*> entries = s.entries;
+	std::stable_sort(entries.begin(), entries.end(), compareEntries);
+
+	for( size_t n=0; n < entries.size(); n++ )
+	{
+		const metricEntry* entry = entries[n];
+
+		if( n == 0 || entries[n-1]->name != entry->name )
+			FormatHeader(output, entry->name.c_str(), entry->help.c_str(), entry->counter != NULL ? "counter" : "gauge");
+
+		FormatValue(output, entry->name.c_str(), entry->labels.c_str(), 
+				  entry->counter != NULL ? (double)entry->counter->Get() : (double)entry->gauge->Get());
+	}
+
+	// collectors are called with the lock held, so RemoveCollector() waits for them
+	for( size_t n=0; n < s.collectors.size(); n++ )
+		s.collectors[n].first(output, s.collectors[n].second);
+
+	pthread_mutex_unlock(&s.mutex);
+	return output;
+}
+
+
+// WriteTextfile
+bool inferenceMetrics::WriteTextfile( const char* path )
+{
+	if( !path )
+		return false;
+
+	const std::string output = Format();
+	const std::string tmpPath = std::string(path) + ".tmp";
+
+	FILE* file = fopen(tmpPath.c_str(), "w");
+
+	if( !file )
+	{
+		printf(LOG_METRICS "failed to open %s for writing (%s)\n", tmpPath.c_str(), strerror(errno));
+		return false;
+	}
+
+	const bool written = (fwrite(output.data(), 1, output.size(), file) == output.size());
+
+	if( fclose(file) != 0 || !written || rename(tmpPath.c_str(), path) != 0 )
+	{
+		printf(LOG_METRICS "failed to write %s (%s)\n", path, strerror(errno));
+		unlink(tmpPath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+
+// respond to one HTTP request
+static void serveRequest( int sock )
+{
+	// read the request line and headers (the body of a GET is empty)
+	char request[2048];
+	size_t size = 0;
+
+	while( size < sizeof(request) - 1 )
+	{
+		struct pollfd pfd;
+
+		pfd.fd      = sock;
+		pfd.events  = POLLIN;
+		pfd.revents = 0;
+
+		if( poll(&pfd, 1, 1000) <= 0 )
+			return;
+
+		const ssize_t bytes = recv(sock, request + size, sizeof(request) - 1 - size, 0);
+
+		if( bytes <= 0 )
+			return;
+
+		size += bytes;
+		request[size] = '\0';
+
+		if( strstr(request, "\r\n\r\n") != NULL || strstr(request, "\n\n") != NULL )
+			break;
+	}
+
+	std::string body;
+	const char* status = "200 OK";
+
+	if( strncmp(request, "GET ", 4) != 0 )
+	{
+		status = "405 Method Not Allowed";
+		body   = "only GET is supported\n";
+	}
+	else
+	{
+		body = inferenceMetrics::Format();
+	}
+
+	char header[256];
+
+	snprintf(header, sizeof(header), "HTTP/1.0 %s\r\n"
+			 "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+			 "Content-Length: %zu\r\n"
+			 "Connection: close\r\n\r\n", status, body.size());
+
+	const std::string response = header + body;
+	size_t sent = 0;
+
+	while( sent < response.size() )
+	{
+		const ssize_t bytes = send(sock, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+
+		if( bytes <= 0 )
+			break;
+
+		sent += bytes;
+	}
+}
+
+
+// HTTP server thread
+static void* serverThread( void* param )
+{
+	metricsState& s = state();
+
+	while( !s.stop )
+	{
+		struct pollfd pfd;
+
+		pfd.fd      = s.serverSocket;
+		pfd.events  = POLLIN;
+		pfd.revents = 0;
+
+		if( poll(&pfd, 1, 250) <= 0 )
+			continue;
+
+		const int sock = accept(s.serverSocket, NULL, NULL);
+
+		if( sock < 0 )
+			continue;
+
+		serveRequest(sock);
+		close(sock);
+	}
+
+	return NULL;
+}
+
+
+// textfile thread
+static void* textfileThread( void* param )
+{
+	metricsState& s = state();
+
+	while( !s.stop )
+	{
+		inferenceMetrics::WriteTextfile(s.filePath.c_str());
+
+		// sleep in small steps so that Stop() returns promptly
+		for( uint32_t ms=0; ms < s.fileInterval && !s.stop; ms += 100 )
+			usleep(100 * 1000);
+	}
+
+	return NULL;
+}
+
+
+// StartServer
+bool inferenceMetrics::StartServer( uint16_t port, const char* address )
+{
+	metricsState& s = state();
+
+	if( s.serverStarted )
+	{
+		printf(LOG_METRICS "HTTP server is already running on port %u\n", s.serverPort);
+		return false;
+	}
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+
+	addr.sin_family = AF_INET;
+	addr.sin_port   = htons(port);
+
+	if( inet_pton(AF_INET, address != NULL ? address : "127.0.0.1", &addr.sin_addr) != 1 )
+	{
+		printf(LOG_METRICS "invalid address '%s'\n", address);
+		return false;
+	}
+
+	const int sock = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if( sock < 0 )
+		return false;
+
+	const int reuse = 1;
+	setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	socklen_t addrLen = sizeof(addr);
+
+	if( bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(sock, 8) != 0 ||
+	    getsockname(sock, (struct sockaddr*)&addr, &addrLen) != 0 )
+	{
+		printf(LOG_METRICS "failed to listen on %s:%u (%s)\n", address, port, strerror(errno));
+		close(sock);
+		return false;
+	}
+
+	s.stop         = false;
+	s.serverSocket = sock;
+	s.serverPort   = ntohs(addr.sin_port);
+
+	if( pthread_create(&s.serverThread, NULL, serverThread, NULL) != 0 )
+	{
+		printf(LOG_METRICS "failed to start HTTP server thread\n");
+		close(sock);
+		s.serverSocket = -1;
+		s.serverPort   = 0;
+		return false;
+	}
+
+	s.serverStarted = true;
+
+	printf(LOG_METRICS "serving metrics at http://%s:%u/metrics\n", address, s.serverPort);
+	return true;
+}
+
+
+// StartTextfile
+bool inferenceMetrics::StartTextfile( const char* path, uint32_t intervalMS )
+{
+	metricsState& s = state();
+
+	if( !path || s.fileStarted )
+		return false;
+
+	s.stop         = false;
+	s.filePath     = path;
+	s.fileInterval = intervalMS;
+
+	if( pthread_create(&s.fileThread, NULL, textfileThread, NULL) != 0 )
+	{
+		printf(LOG_METRICS "failed to start textfile thread\n");
+		return false;
+	}
+
+	s.fileStarted = true;
+
+	printf(LOG_METRICS "writing metrics to %s every %u ms\n", path, intervalMS);
+	return true;
+}
+
+
+// Stop
+void inferenceMetrics::Stop()
+{
+	metricsState& s = state();
+
+	s.stop = true;
+
+	if( s.serverStarted )
+	{
+		pthread_join(s.serverThread, NULL);
+		close(s.serverSocket);
+
+		s.serverSocket  = -1;
+		s.serverPort    = 0;
+		s.serverStarted = false;
+	}
+
+	if( s.fileStarted )
+	{
+		pthread_join(s.fileThread, NULL);
+		s.fileStarted = false;
+	}
+}
+
+
+// GetServerPort
+uint16_t inferenceMetrics::GetServerPort()
+{
+	return state().serverPort;
+}
+
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __INFERENCE_METRICS_H__
+#define __INFERENCE_METRICS_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+class profilerHistogram;
+
+
+/**
+ * Prefix used for tagging printed log output from the metrics exporter.
+ * @ingroup metrics
+ */
+#define LOG_METRICS "[metrics] "
+
+
+/**
+ * Monotonically increasing counter, updated lock-free from the hot path.
+ * Created with inferenceMetrics::Counter() and valid for the life of the process.
+ * @ingroup metrics
+ */
+class metricCounter
+{
+public:
+	metricCounter() : mValue(0)				{ }
+
+	inline void Increment( uint64_t n=1 )		{ mValue.fetch_add(n, std::memory_order_relaxed); }
+	inline uint64_t Get() const				{ return mValue.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<uint64_t> mValue;
+};
+
+
+/**
+ * Value that can go up and down (i.e. a queue depth), updated lock-free from the hot path.
+ * Created with inferenceMetrics::Gauge() and valid for the life of the process.
+ * @ingroup metrics
+ */
+class metricGauge
+{
+public:
+	metricGauge() : mValue(0)				{ }
+
+	inline void Set( int64_t value )			{ mValue.store(value, std::memory_order_relaxed); }
+	inline void Add( int64_t n=1 )			{ mValue.fetch_add(n, std::memory_order_relaxed); }
+	inline int64_t Get() const				{ return mValue.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<int64_t> mValue;
+};
+
+
+/**
+ * Exporter of inference statistics in the Prometheus text format, either
+ * served over HTTP from a background thread (StartServer()) or written to
+ * a file periodically for the node_exporter textfile collector (StartTextfile()).
+ *
+ * Metrics come from two sources:
+ *
+ *   - counters and gauges created by name with Counter() and Gauge(),
+ *     which the hot path updates with a single atomic operation
+ *   - collectors registered with AddCollector(), which are called at scrape
+ *     time to format values that already exist elsewhere (for example the
+ *     profiler histograms of each tensorNet, and the memory usage)
+ *
+ * The exporter itself doesn't depend on CUDA or TensorRT.
+ * @ingroup metrics
+ */
+class inferenceMetrics
+{
+public:
+	/**
+	 * Function called at scrape time, that appends metrics in the text format to the output.
+	 */
+	typedef void (*Collector)( std::string& output, void* user );
+
+	/**
+	 * Find or create a counter.
+	 * @param name metric name, i.e. "jetson_inference_engine_cache_hits_total"
+	 * @param help description of the metric
+	 * @param labels optional labels, i.e. "source=\"daemon\""
+	 */
+	static metricCounter* Counter( const char* name, const char* help, const char* labels=NULL );
+
+	/**
+	 * Find or create a gauge.
+	 * @see Counter() for the parameters.
+	 */
+	static metricGauge* Gauge( const char* name, const char* help, const char* labels=NULL );
+
+	/**
+	 * Register a collector that's called every time the metrics are formatted.
+	 */
+	static void AddCollector( Collector collector, void* user );
+
+	/**
+	 * Unregister a collector.  After this returns, the collector won't be called again.
+	 */
+	static void RemoveCollector( Collector collector, void* user );
+
+	/**
+	 * Format all of the metrics in the Prometheus text exposition format.
+	 */
+	static std::string Format();
+
+	/**
+	 * Write the metrics to a file (atomically, by renaming a temporary file).
+	 */
+	static bool WriteTextfile( const char* path );
+
+	/**
+	 * Serve the metrics over HTTP (at any URL, conventionally /metrics) from a background thread.
+	 * @param port TCP port to listen on, or 0 to pick a free port (@see GetServerPort())
+	 * @param address IP address to bind to (only the local host by default)
+	 */
+	static bool StartServer( uint16_t port, const char* address="127.0.0.1" );
+
+	/**
+	 * Write the metrics to a file every interval from a background thread.
+	 */
+	static bool StartTextfile( const char* path, uint32_t intervalMS=5000 );
+
+	/**
+	 * Stop the HTTP server and textfile threads.
+	 */
+	static void Stop();
+
+	/**
+	 * Retrieve the TCP port that the HTTP server is listening on (or 0 if it isn't running).
+	 */
+	static uint16_t GetServerPort();
+
+	/**
+	 * Append the header lines of a metric family (# HELP and # TYPE).
+	 */
+	static void FormatHeader( std::string& output, const char* name, const char* help, const char* type );
+
+	/**
+	 * Append a single sample.
+	 */
+	static void FormatValue( std::string& output, const char* name, const char* labels, double value );
+
+	/**
+	 * Append the samples of a histogram (the header should be appended separately with the "histogram" type).
+	 * The bucket boundaries are converted from milliseconds to seconds.
+	 */
+	static void FormatHistogram( std::string& output, const char* name, const char* labels, const profilerHistogram& histogram );
+};
+
+#endif
+
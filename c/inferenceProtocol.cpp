@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "inferenceProtocol.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+
+
+// inferenceSendMessage
+bool inferenceSendMessage( int sock, const inferenceMessage& msg, int fd )
+{
+	struct iovec iov;
+
+	iov.iov_base = (void*)&msg;
+	iov.iov_len  = sizeof(inferenceMessage);
+
+	struct msghdr hdr;
+	memset(&hdr, 0, sizeof(hdr));
+
+	hdr.msg_iov    = &iov;
+	hdr.msg_iovlen = 1;
+
+	// attach the file descriptor as ancillary data
+	char control[CMSG_SPACE(sizeof(int))];
+
+	if( fd >= 0 )
+	{
+		memset(control, 0, sizeof(control));
+
+		hdr.msg_control    = control;
+		hdr.msg_controllen = sizeof(control);
+
+		struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type  = SCM_RIGHTS;
+		cmsg->cmsg_len   = CMSG_LEN(sizeof(int));
+
+		memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+	}
+
+	while( true )
+	{
+		const ssize_t sent = sendmsg(sock, &hdr, MSG_NOSIGNAL);
+
+		if( sent == (ssize_t)sizeof(inferenceMessage) )
+			return true;
+
+		if( sent < 0 && errno == EINTR )
+			continue;
+
+		if( sent < 0 && errno != EPIPE && errno != ECONNRESET )
+			printf(LOG_INFERENCE_IPC "sendmsg() failed (%s)\n", strerror(errno));
+
+		return false;
+	}
+}
+
+
+// inferenceRecvMessage
+bool inferenceRecvMessage( int sock, inferenceMessage* msg, int* fd )
+{
+	if( !msg )
+		return false;
+
+	if( fd != NULL )
+		*fd = -1;
+
+	struct iovec iov;
+
+	iov.iov_base = msg;
+	iov.iov_len  = sizeof(inferenceMessage);
+
+	struct msghdr hdr;
+	memset(&hdr, 0, sizeof(hdr));
+
+	char control[CMSG_SPACE(sizeof(int))];
+
+	hdr.msg_iov        = &iov;
+	hdr.msg_iovlen     = 1;
+	hdr.msg_control    = control;
+	hdr.msg_controllen = sizeof(control);
+
+	ssize_t received = 0;
+
+	do
+	{
+		received = recvmsg(sock, &hdr, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+	}
+	while( received < 0 && errno == EINTR );
+
+	if( received == 0 )
+		return false;	// connection closed
+
+	if( received < 0 )
+	{
+		if( errno != ECONNRESET )
+			printf(LOG_INFERENCE_IPC "recvmsg() failed (%s)\n", strerror(errno));
+
+		return false;
+	}
+
+	// extract the file descriptor (if one was passed)
+	for( struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&hdr, cmsg) )
+	{
+		if( cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS )
+			continue;
+
+		int passed = -1;
+		memcpy(&passed, CMSG_DATA(cmsg), sizeof(int));
+
+		if( fd != NULL )
+			*fd = passed;
+		else
+			close(passed);
+	}
+
+	if( received != (ssize_t)sizeof(inferenceMessage) || msg->magic != INFERENCE_PROTOCOL_MAGIC )
+	{
+		printf(LOG_INFERENCE_IPC "received invalid message (%zi bytes)\n", received);
+
+		if( fd != NULL && *fd >= 0 )
+		{
+			close(*fd);
+			*fd = -1;
+		}
+
+		return false;
+	}
+
+	return true;
+}
+
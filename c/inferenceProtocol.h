@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __INFERENCE_PROTOCOL_H__
+#define __INFERENCE_PROTOCOL_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/**
+ * Default path of the Unix domain socket that inference-daemon listens on.
+ * @ingroup inferenceDaemon
+ */
+#define INFERENCE_DEFAULT_SOCKET  "/tmp/jetson-inference.sock"
+
+/**
+ * Magic number at the start of every message ('JINF').
+ * @ingroup inferenceDaemon
+ */
+#define INFERENCE_PROTOCOL_MAGIC  0x4a494e46
+
+/**
+ * Maximum number of results that are returned for each frame.
+ * @ingroup inferenceDaemon
+ */
+#define INFERENCE_MAX_RESULTS     128
+
+/**
+ * Offset of the RGBA image inside of a shared-memory slot (the results come first).
+ * @ingroup inferenceDaemon
+ */
+#define INFERENCE_IMAGE_OFFSET    4096
+
+/**
+ * Prefix used for tagging printed log output from the daemon and its clients.
+ * @ingroup inferenceDaemon
+ */
+#define LOG_INFERENCE_IPC  "[ipc]   "
+
+
+/**
+ * Message types exchanged over the socket.
+ * @ingroup inferenceDaemon
+ */
+enum inferenceMessageType
+{
+	INFERENCE_MSG_ATTACH = 1,	/**< client -> daemon, carries the shared-memory fd (numSlots, slotSize) */
+	INFERENCE_MSG_ATTACH_REPLY,	/**< daemon -> client, status of the attach */
+	INFERENCE_MSG_REQUEST,		/**< client -> daemon, process the frame in a slot (slot, network, width, height, flags) */
+	INFERENCE_MSG_RESPONSE		/**< daemon -> client, results were written to the slot (slot, numResults) */
+};
+
+/**
+ * Networks that the daemon can serve.
+ * @ingroup inferenceDaemon
+ */
+enum inferenceNetwork
+{
+	INFERENCE_CLASSIFY = 0,		/**< imageNet -- one result with the class and confidence */
+	INFERENCE_DETECT,			/**< detectNet -- one result per detected object */
+	INFERENCE_NUM_NETWORKS
+};
+
+/**
+ * Request flags.
+ * @ingroup inferenceDaemon
+ */
+enum inferenceRequestFlags
+{
+	INFERENCE_FLAG_OVERLAY = (1 << 0)	/**< render the detection overlay into the frame (in place) */
+};
+
+/**
+ * Fixed-size message sent in both directions over the socket.
+ * All fields are in host byte order, as the socket is local.
+ * @ingroup inferenceDaemon
+ */
+struct inferenceMessage
+{
+	uint32_t magic;		/**< INFERENCE_PROTOCOL_MAGIC */
+	uint32_t type;			/**< inferenceMessageType */
+	uint32_t sequence;		/**< echoed back in the reply */
+	int32_t  status;		/**< 0 on success, or a negative errno value */
+	uint32_t slot;			/**< index of the shared-memory slot */
+	uint32_t network;		/**< inferenceNetwork */
+	uint32_t width;		/**< width of the frame (in pixels) */
+	uint32_t height;		/**< height of the frame (in pixels) */
+	uint32_t flags;		/**< inferenceRequestFlags */
+	uint32_t numResults;	/**< number of results written to the slot */
+	uint32_t numSlots;		/**< number of slots in the shared-memory ring */
+	uint32_t reserved;
+	uint64_t slotSize;		/**< size of each slot (in bytes) */
+};
+
+/**
+ * Result record written to the start of a slot by the daemon.
+ * For classification the bounding box covers the whole frame.
+ * @ingroup inferenceDaemon
+ */
+struct inferenceResult
+{
+	int32_t classID;
+	float   confidence;
+	float   left;
+	float   top;
+	float   right;
+	float   bottom;
+};
+
+/**
+ * Size of a shared-memory slot that holds an RGBA float4 frame of the given size (rounded up to a page).
+ * @ingroup inferenceDaemon
+ */
+inline size_t inferenceSlotSize( uint32_t width, uint32_t height )
+{
+	const size_t size = INFERENCE_IMAGE_OFFSET + (size_t)width * height * sizeof(float) * 4;
+	return (size + 4095) & ~((size_t)4095);
+}
+
+/**
+ * Send a message, optionally passing a file descriptor with SCM_RIGHTS.
+ * @ingroup inferenceDaemon
+ */
+bool inferenceSendMessage( int sock, const inferenceMessage& msg, int fd=-1 );
+
+/**
+ * Receive a message, and the file descriptor that was passed with it (if fd isn't NULL).
+ * @returns false if the connection was closed or the message was invalid.
+ * @ingroup inferenceDaemon
+ */
+bool inferenceRecvMessage( int sock, inferenceMessage* msg, int* fd=NULL );
+
+#endif
+
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "layerPlacement.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+// same prefix as tensorNet.h, which isn't included to keep this file free of TensorRT
+#ifndef LOG_TRT
+#define LOG_TRT "[TRT]   "
+#endif
+
+
+// Count
+uint32_t placementReport::Count( const std::vector<layerPlacement>& layers, bool dla )
+{
+	uint32_t count = 0;
+
+	for( size_t n=0; n < layers.size(); n++ )
+	{
+		if( layers[n].dla == dla )
+			count++;
+	}
+
+	return count;
+}
+
+
+// Attribute
+void placementReport::Attribute( const std::vector<layerPlacement>& layers, std::vector<layerTiming>& timings )
+{
+	for( size_t t=0; t < timings.size(); t++ )
+	{
+		size_t longest = 0;
+		timings[t].dla = false;
+
+		for( size_t n=0; n < layers.size(); n++ )
+		{
+			const size_t length = layers[n].name.size();
+
+			if( length <= longest || timings[t].name.find(layers[n].name) == std::string::npos )
+				continue;
+
+			timings[t].dla = layers[n].dla;
+			longest = length;
+		}
+	}
+}
+
+
+// Print
+void placementReport::Print( const std::vector<layerPlacement>& layers, uint32_t transitions, const std::vector<layerTiming>& timings )
+{
+	printf(LOG_TRT "----------------------------------------------\n");
+	printf(LOG_TRT "Layer Placement\n");
+	printf(LOG_TRT "----------------------------------------------\n");
+
+	if( layers.size() == 0 )
+	{
+		printf(LOG_TRT "no placement was recorded (the engine wasn't built for the DLA)\n");
+	}
+	else
+	{
+		for( size_t n=0; n < layers.size(); n++ )
+			printf(LOG_TRT "%-4s  %s\n", layers[n].dla ? "DLA" : "GPU", layers[n].name.c_str());
+
+		printf(LOG_TRT "----------------------------------------------\n");
+		printf(LOG_TRT "layers on DLA   %u\n", Count(layers, true));
+		printf(LOG_TRT "layers on GPU   %u\n", Count(layers, false));
+		printf(LOG_TRT "transitions     %u  (tensors passed between the DLA and GPU)\n", transitions);
+	}
+
+	if( timings.size() > 0 )
+	{
+		float totalDLA = 0.0f;
+		float totalGPU = 0.0f;
+
+		printf(LOG_TRT "----------------------------------------------\n");
+		printf(LOG_TRT "Layer Timings (mean)\n");
+		printf(LOG_TRT "----------------------------------------------\n");
+
+		for( size_t n=0; n < timings.size(); n++ )
+		{
+			const float mean = (timings[n].calls > 0) ? timings[n].total / timings[n].calls : 0.0f;
+
+			if( timings[n].dla )
+				totalDLA += mean;
+			else
+				totalGPU += mean;
+
+			printf(LOG_TRT "%-4s  %8.4fms  %s\n", timings[n].dla ? "DLA" : "GPU", mean, timings[n].name.c_str());
+		}
+
+		printf(LOG_TRT "----------------------------------------------\n");
+		printf(LOG_TRT "DLA time  %8.4fms\n", totalDLA);
+		printf(LOG_TRT "GPU time  %8.4fms\n", totalGPU);
+	}
+
+	printf(LOG_TRT "----------------------------------------------\n\n");
+}
+
+
+// Save
+bool placementReport::Save( const char* path, const char* key, const std::vector<layerPlacement>& layers, uint32_t transitions )
+{
+	if( !path || !key )
+		return false;
+
+	FILE* file = fopen(path, "w");
+
+	if( !file )
+	{
+		printf(LOG_TRT "failed to open %s for writing\n", path);
+		return false;
+	}
+
+	fprintf(file, "%s\n", key);
+	fprintf(file, "%u\n", transitions);
+
+	// the name is last, since it can contain spaces
+	for( size_t n=0; n < layers.size(); n++ )
+		fprintf(file, "%s %s\n", layers[n].dla ? "DLA" : "GPU", layers[n].name.c_str());
+
+	fclose(file);
+	return true;
+}
+
+
+// Load
+bool placementReport::Load( const char* path, const char* key, std::vector<layerPlacement>& layers, uint32_t* transitions )
+{
+	if( !path || !key )
+		return false;
+
+	FILE* file = fopen(path, "r");
+
+	if( !file )
+		return false;
+
+	char fileKey[512];
+	uint32_t fileTransitions = 0;
+
+	if( fscanf(file, "%511s %u", fileKey, &fileTransitions) != 2 || strcmp(fileKey, key) != 0 )
+	{
+		fclose(file);
+		return false;
+	}
+
+	std::vector<layerPlacement> loaded;
+	char line[1024];
+
+	while( fgets(line, sizeof(line), file) != NULL )
+	{
+		size_t length = strlen(line);
+
+		while( length > 0 && (line[length-1] == '\n' || line[length-1] == '\r') )
+			line[--length] = '\0';
+
+		if( length < 5 || line[3] != ' ' )
+			continue;	// the remainder of the transitions line, or a malformed line
+
+		layerPlacement layer;
+
+		if( strncmp(line, "DLA", 3) == 0 )
+			layer.dla = true;
+		else if( strncmp(line, "GPU", 3) == 0 )
+			layer.dla = false;
+		else
+			continue;
+
+		layer.name = line + 4;
+		loaded.push_back(layer);
+	}
+
+	fclose(file);
+
+	if( loaded.size() == 0 )
+		return false;
+
+	layers = loaded;
+
+	if( transitions != NULL )
+		*transitions = fileTransitions;
+
+	return true;
+}
+
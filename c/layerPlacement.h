@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __LAYER_PLACEMENT_H__
+#define __LAYER_PLACEMENT_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+/**
+ * Device that a layer of the network was placed on when the engine was built.
+ * @see tensorNet::GetLayerPlacement()
+ * @ingroup tensorNet
+ */
+struct layerPlacement
+{
+	std::string name;	/**< name of the layer in the network definition */
+	bool dla;		/**< true if the layer runs on the DLA, false if it runs on (or fell back to) the GPU */
+};
+
+
+/**
+ * Time spent in a layer of the engine, as reported by the layer profiler.
+ * The engine's layers may be fusions of several layers of the network.
+ * @see tensorNet::GetLayerTimings()
+ * @ingroup tensorNet
+ */
+struct layerTiming
+{
+	std::string name;	/**< name of the layer in the engine */
+	bool dla;		/**< true if the layer was attributed to the DLA */
+	float total;		/**< total time spent in the layer (in milliseconds) */
+	uint32_t calls;	/**< number of times that the layer was run */
+};
+
+
+/**
+ * Persistence and reporting of which layers of a network were placed on the DLA
+ * and which fell back to the GPU, along with the number of transitions between them.
+ *
+ * The placement is captured by tensorNet::ProfileModel() when the engine is built,
+ * and is saved next to the engine cache (with the .placement extension) so that it's
+ * also available when the engine is loaded from the cache.  This class doesn't depend
+ * on CUDA or TensorRT.
+ * @ingroup tensorNet
+ */
+class placementReport
+{
+public:
+	/**
+	 * Count the layers that were placed on the DLA (or on the GPU, if dla is false).
+	 */
+	static uint32_t Count( const std::vector<layerPlacement>& layers, bool dla );
+
+	/**
+	 * Attribute each of the engine's layers to the device of the network layer
+	 * whose name it contains (the longest one, since fused layers combine names).
+	 * Layers that don't match any network layer are attributed to the GPU.
+	 */
+	static void Attribute( const std::vector<layerPlacement>& layers, std::vector<layerTiming>& timings );
+
+	/**
+	 * Print the placement of the layers, the transitions, and the layer timings (if any).
+	 */
+	static void Print( const std::vector<layerPlacement>& layers, uint32_t transitions, const std::vector<layerTiming>& timings );
+
+	/**
+	 * Save the placement to a file.
+	 * @param key identifies the TensorRT version and GPU that the engine was built on.
+	 */
+	static bool Save( const char* path, const char* key, const std::vector<layerPlacement>& layers, uint32_t transitions );
+
+	/**
+	 * Load the placement from a file, if it exists and was saved with the same key.
+	 */
+	static bool Load( const char* path, const char* key, std::vector<layerPlacement>& layers, uint32_t* transitions );
+};
+
+#endif
+
@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "modelManager.h"
+#include "inferenceMetrics.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+
+// convert bytes to megabytes for printing
+static inline float toMB( size_t bytes )
+{
+	return bytes / (1024.0f * 1024.0f);
+}
+
+
+// constructor
+modelManager::modelManager( size_t memoryBudget, modelBackend* backend )
+{
+	mBackend      = backend;
+	mMemoryBudget = memoryBudget;
+	mMemoryUsage  = 0;
+	mClock        = 0;
+
+	pthread_mutex_init(&mMutex, NULL);
+	pthread_cond_init(&mCond, NULL);
+
+	inferenceMetrics::Gauge("jetson_inference_model_memory_budget_bytes", "Memory budget of the model manager")->Set(memoryBudget);
+}
+
+
+// destructor
+modelManager::~modelManager()
+{
+	pthread_mutex_lock(&mMutex);
+
+	for( std::map<std::string, model>::iterator iter = mModels.begin(); iter != mModels.end(); iter++ )
+	{
+		if( iter->second.network != NULL )
+		{
+			mBackend->Unload(iter->first.c_str(), iter->second.network);
+			iter->second.memory->Set(0);
+		}
+	}
+
+	mModels.clear();
+	pthread_mutex_unlock(&mMutex);
+
+	delete mBackend;
+
+	pthread_cond_destroy(&mCond);
+	pthread_mutex_destroy(&mMutex);
+}
+
+
+// Create
+modelManager* modelManager::Create( size_t memoryBudget, modelBackend* backend )
+{
+	if( !backend )
+	{
+		printf(LOG_MODEL "modelManager::Create() -- backend was NULL\n");
+		return NULL;
+	}
+
+	printf(LOG_MODEL "created model manager with a budget of %.1f MB\n", toMB(memoryBudget));
+	return new modelManager(memoryBudget, backend);
+}
+
+
+// findModel
+modelManager::model* modelManager::findModel( const std::string& name )
+{
+	std::map<std::string, model>::iterator iter = mModels.find(name);
+
+	if( iter != mModels.end() )
+		return &iter->second;
+
+	model m;
+	memset(&m, 0, sizeof(model));
+
+	// label the metrics with the model's name
+	std::string label = name;
+
+	for( size_t n=0; n < label.size(); n++ )
+	{
+		if( label[n] == '"' || label[n] == '\\' )
+			label[n] = '_';
+	}
+
+	label = "model=\"" + label + "\"";
+
+	m.hits      = inferenceMetrics::Counter("jetson_inference_model_hits_total", "Number of times a model was acquired while it was already loaded", label.c_str());
+	m.loads     = inferenceMetrics::Counter("jetson_inference_model_loads_total", "Number of times a model was loaded", label.c_str());
+	m.evictions = inferenceMetrics::Counter("jetson_inference_model_evictions_total", "Number of times a model was unloaded", label.c_str());
+	m.memory    = inferenceMetrics::Gauge("jetson_inference_model_memory_bytes", "Memory held by each loaded model", label.c_str());
+
+	return &(mModels[name] = m);
+}
+
+
+// unloadModel
+void modelManager::unloadModel( const std::string& name, model* m )
+{
+	printf(LOG_MODEL "evicting '%s' (%.1f MB, idle for %llu requests)\n", name.c_str(), toMB(m->reserved), 
+		  (unsigned long long)(mClock - m->lastUse));
+
+	mBackend->Unload(name.c_str(), m->network);
+
+	mMemoryUsage -= m->reserved;
+
+	m->network  = NULL;
+	m->reserved = 0;
+
+	m->stats.evictions++;
+	m->stats.memoryUsage = 0;
+
+	m->evictions->Increment();
+	m->memory->Set(0);
+}
+
+
+// makeRoom
+void modelManager::makeRoom( size_t required, const model* keep )
+{
+	if( mMemoryBudget == 0 )
+		return;
+
+	while( mMemoryUsage + required > mMemoryBudget )
+	{
+		// find the least-recently used model that's loaded and idle
+		std::map<std::string, model>::iterator lru = mModels.end();
+
+		for( std::map<std::string, model>::iterator iter = mModels.begin(); iter != mModels.end(); iter++ )
+		{
+			const model& m = iter->second;
+
+			if( &m == keep || m.network == NULL || m.references > 0 || m.loading )
+				continue;
+
+			if( lru == mModels.end() || m.lastUse < lru->second.lastUse )
+				lru = iter;
+		}
+
+		if( lru == mModels.end() )
+		{
+			printf(LOG_MODEL "warning:  %.1f MB in use exceeds the budget of %.1f MB, but no idle models are left to evict\n", 
+				  toMB(mMemoryUsage + required), toMB(mMemoryBudget));
+			break;
+		}
+
+		unloadModel(lru->first, &lru->second);
+	}
+}
+
+
+// Acquire
+tensorNet* modelManager::Acquire( const char* name )
+{
+	if( !name )
+		return NULL;
+
+	pthread_mutex_lock(&mMutex);
+
+	model* m = findModel(name);
+	m->lastUse = ++mClock;
+
+	// another thread may be loading the model already
+	while( m->loading )
+		pthread_cond_wait(&mCond, &mMutex);
+
+	if( m->network != NULL )
+	{
+		m->references++;
+		m->stats.hits++;
+		m->hits->Increment();
+
+		tensorNet* network = m->network;
+		pthread_mutex_unlock(&mMutex);
+		return network;
+	}
+
+	// reserve the size from the last time the model was loaded (if any) and
+	// evict ahead of loading, then load it without holding the lock
+	m->loading = true;
+	m->references++;
+
+	makeRoom(m->lastSize, m);
+
+	m->reserved = m->lastSize;
+	mMemoryUsage += m->reserved;
+
+	pthread_mutex_unlock(&mMutex);
+
+	timespec begin;
+	timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	tensorNet* network = mBackend->Load(name);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	const float loadTime = (end.tv_sec - begin.tv_sec) * 1000.0f + (end.tv_nsec - begin.tv_nsec) * 0.000001f;
+
+	pthread_mutex_lock(&mMutex);
+
+	m->loading = false;
+	mMemoryUsage -= m->reserved;
+	m->reserved = 0;
+
+	if( !network )
+	{
+		printf(LOG_MODEL "failed to load '%s'\n", name);
+
+		m->references--;
+		m->stats.failures++;
+
+		pthread_cond_broadcast(&mCond);
+		pthread_mutex_unlock(&mMutex);
+		return NULL;
+	}
+
+	const size_t size = mBackend->GetMemoryUsage(network);
+
+	m->network  = network;
+	m->lastSize = size;
+	m->reserved = size;
+	mMemoryUsage += size;
+
+	m->stats.loads++;
+	m->stats.loadTime += loadTime;
+	m->stats.memoryUsage = size;
+
+	m->loads->Increment();
+	m->memory->Set(size);
+
+	// now that the actual size is known, trim back under the budget
+	makeRoom(0, m);
+
+	printf(LOG_MODEL "loaded '%s' (%.1f MB) in %.1f ms, %.1f / %.1f MB in use\n", 
+		  name, toMB(size), loadTime, toMB(mMemoryUsage), toMB(mMemoryBudget));
+
+	pthread_cond_broadcast(&mCond);
+	pthread_mutex_unlock(&mMutex);
+	return network;
+}
+
+
+// Release
+void modelManager::Release( const char* name )
+{
+	if( !name )
+		return;
+
+	pthread_mutex_lock(&mMutex);
+
+	std::map<std::string, model>::iterator iter = mModels.find(name);
+
+	if( iter == mModels.end() || iter->second.references == 0 )
+		printf(LOG_MODEL "warning:  '%s' was released more times than it was acquired\n", name);
+	else if( --iter->second.references == 0 )
+		makeRoom(0, NULL);	// trim what couldn't be evicted while every model was acquired
+
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// Evict
+bool modelManager::Evict( const char* name )
+{
+	if( !name )
+		return false;
+
+	pthread_mutex_lock(&mMutex);
+
+	std::map<std::string, model>::iterator iter = mModels.find(name);
+	bool result = true;
+
+	if( iter != mModels.end() )
+	{
+		model* m = &iter->second;
+
+		if( m->references > 0 || m->loading )
+			result = false;
+		else if( m->network != NULL )
+			unloadModel(iter->first, m);
+	}
+
+	pthread_mutex_unlock(&mMutex);
+	return result;
+}
+
+
+// IsLoaded
+bool modelManager::IsLoaded( const char* name )
+{
+	if( !name )
+		return false;
+
+	pthread_mutex_lock(&mMutex);
+
+	std::map<std::string, model>::iterator iter = mModels.find(name);
+	const bool loaded = (iter != mModels.end() && iter->second.network != NULL);
+
+	pthread_mutex_unlock(&mMutex);
+	return loaded;
+}
+
+
+// SetMemoryBudget
+void modelManager::SetMemoryBudget( size_t memoryBudget )
+{
+	pthread_mutex_lock(&mMutex);
+
+	mMemoryBudget = memoryBudget;
+	makeRoom(0, NULL);
+
+	pthread_mutex_unlock(&mMutex);
+
+	inferenceMetrics::Gauge("jetson_inference_model_memory_budget_bytes", "Memory budget of the model manager")->Set(memoryBudget);
+}
+
+
+// GetMemoryUsage
+size_t modelManager::GetMemoryUsage()
+{
+	pthread_mutex_lock(&mMutex);
+	const size_t usage = mMemoryUsage;
+	pthread_mutex_unlock(&mMutex);
+
+	return usage;
+}
+
+
+// GetStats
+modelStats modelManager::GetStats()
+{
+	modelStats total;
+	memset(&total, 0, sizeof(modelStats));
+
+	pthread_mutex_lock(&mMutex);
+
+	for( std::map<std::string, model>::iterator iter = mModels.begin(); iter != mModels.end(); iter++ )
+	{
+		const modelStats& s = iter->second.stats;
+
+		total.hits        += s.hits;
+		total.loads       += s.loads;
+		total.evictions   += s.evictions;
+		total.failures    += s.failures;
+		total.loadTime    += s.loadTime;
+		total.memoryUsage += s.memoryUsage;
+	}
+
+	pthread_mutex_unlock(&mMutex);
+	return total;
+}
+
+
+// GetStats
+bool modelManager::GetStats( const char* name, modelStats* stats )
+{
+	if( !name || !stats )
+		return false;
+
+	pthread_mutex_lock(&mMutex);
+
+	std::map<std::string, model>::iterator iter = mModels.find(name);
+	const bool found = (iter != mModels.end());
+
+	if( found )
+		*stats = iter->second.stats;
+
+	pthread_mutex_unlock(&mMutex);
+	return found;
+}
+
+
+// PrintStats
+void modelManager::PrintStats()
+{
+	pthread_mutex_lock(&mMutex);
+
+	printf(LOG_MODEL "%-24s %8s %8s %8s %10s %10s\n", "model", "hits", "loads", "evicted", "load (ms)", "memory (MB)");
+
+	for( std::map<std::string, model>::iterator iter = mModels.begin(); iter != mModels.end(); iter++ )
+	{
+		const modelStats& s = iter->second.stats;
+
+		printf(LOG_MODEL "%-24s %8llu %8llu %8llu %10.1f %10.1f\n", iter->first.c_str(), (unsigned long long)s.hits, 
+			  (unsigned long long)s.loads, (unsigned long long)s.evictions, s.loadTime, toMB(s.memoryUsage));
+	}
+
+	printf(LOG_MODEL "%.1f / %.1f MB in use\n", toMB(mMemoryUsage), toMB(mMemoryBudget));
+	pthread_mutex_unlock(&mMutex);
+}
+
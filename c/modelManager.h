@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __MODEL_MANAGER_H__
+#define __MODEL_MANAGER_H__
+
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <map>
+
+
+class tensorNet;
+class metricCounter;
+class metricGauge;
+
+
+/**
+ * Prefix used for tagging printed log output from modelManager.
+ * @ingroup modelManager
+ */
+#define LOG_MODEL "[model] "
+
+
+/**
+ * Interface used by modelManager to load and unload networks.
+ * The manager never dereferences the networks itself, so a fake backend
+ * may be used to exercise the scheduling and eviction policy without a GPU.
+ * @see tensorNetBackend for the implementation that loads real networks.
+ * @ingroup modelManager
+ */
+class modelBackend
+{
+public:
+	virtual ~modelBackend()		{ }
+
+	/**
+	 * Load the named network.
+	 * @returns the network, or NULL on error.
+	 */
+	virtual tensorNet* Load( const char* name ) = 0;
+
+	/**
+	 * Release a network that was returned by Load().
+	 */
+	virtual void Unload( const char* name, tensorNet* network ) = 0;
+
+	/**
+	 * Retrieve the memory held by a loaded network, in bytes.
+	 */
+	virtual size_t GetMemoryUsage( tensorNet* network ) = 0;
+};
+
+
+/**
+ * Load, hit and eviction statistics of a model (or of all the models).
+ * @ingroup modelManager
+ */
+struct modelStats
+{
+	uint64_t hits;			/**< requests for the model while it was already loaded */
+	uint64_t loads;		/**< times that the model was loaded */
+	uint64_t evictions;		/**< times that the model was unloaded to stay under the budget (or by Evict()) */
+	uint64_t failures;		/**< loads that failed */
+	float    loadTime;		/**< total time spent loading (in milliseconds) */
+	size_t   memoryUsage;	/**< memory currently held (in bytes) */
+};
+
+
+/**
+ * Hosts more networks than fit in memory at once, under a global memory budget.
+ *
+ * Networks are loaded lazily the first time that they're acquired.  When the
+ * memory in use would exceed the budget, the least-recently used networks that
+ * aren't currently acquired are unloaded to make room.  A network that has been
+ * loaded before reserves its last measured size before loading, so eviction
+ * happens ahead of the load instead of after it.
+ *
+ * Acquire() and Release() bracket each use of a network, and may be called from
+ * any thread.  Loading a network doesn't block the other networks from being
+ * acquired in the meantime.
+ *
+ * @ingroup modelManager
+ */
+class modelManager
+{
+public:
+	/**
+	 * Create a manager.
+	 * @param memoryBudget maximum memory of all the loaded networks (in bytes), or 0 for no limit
+	 * @param backend loads and unloads the networks (the manager takes ownership of it)
+	 */
+	static modelManager* Create( size_t memoryBudget, modelBackend* backend );
+
+	/**
+	 * Destroy the manager, unloading all of the networks.
+	 */
+	~modelManager();
+
+	/**
+	 * Retrieve a network, loading it first if it isn't already loaded.
+	 * The network won't be evicted until it has been released the same number of
+	 * times that it was acquired, so it's safe to use in between.
+	 * @returns the network, or NULL if it failed to load.
+	 */
+	tensorNet* Acquire( const char* name );
+
+	/**
+	 * Release a network that was acquired, so it becomes eligible for eviction.
+	 * If the memory in use is still over the budget (because every network was
+	 * acquired when the last one was loaded), the idle networks are evicted now.
+	 */
+	void Release( const char* name );
+
+	/**
+	 * Unload a network now, even if memory is under the budget.
+	 * @returns false if the network is acquired (or being loaded), true otherwise.
+	 */
+	bool Evict( const char* name );
+
+	/**
+	 * Check if a network is currently loaded.
+	 */
+	bool IsLoaded( const char* name );
+
+	/**
+	 * Change the memory budget (in bytes, or 0 for no limit), evicting idle networks if needed.
+	 */
+	void SetMemoryBudget( size_t memoryBudget );
+
+	/**
+	 * Retrieve the memory budget (in bytes).
+	 */
+	inline size_t GetMemoryBudget() const		{ return mMemoryBudget; }
+
+	/**
+	 * Retrieve the memory held by the loaded networks (in bytes).
+	 */
+	size_t GetMemoryUsage();
+
+	/**
+	 * Retrieve the statistics of all the models combined.
+	 */
+	modelStats GetStats();
+
+	/**
+	 * Retrieve the statistics of a model.
+	 * @returns false if the model has never been acquired.
+	 */
+	bool GetStats( const char* name, modelStats* stats );
+
+	/**
+	 * Print the statistics of each model.
+	 */
+	void PrintStats();
+
+protected:
+	modelManager( size_t memoryBudget, modelBackend* backend );
+
+	struct model
+	{
+		tensorNet* network;
+		uint32_t   references;	// number of Acquire() calls that haven't been released
+		uint64_t   lastUse;		// value of mClock when the model was last acquired
+		size_t     lastSize;	// memory measured the last time the model was loaded
+		size_t     reserved;	// memory counted in mMemoryUsage for the model
+		bool       loading;
+		modelStats stats;
+
+		metricCounter* hits;
+		metricCounter* loads;
+		metricCounter* evictions;
+		metricGauge*   memory;
+	};
+
+	model* findModel( const std::string& name );
+	void unloadModel( const std::string& name, model* m );
+	void makeRoom( size_t required, const model* keep );
+
+	modelBackend* mBackend;
+	size_t        mMemoryBudget;
+	size_t        mMemoryUsage;
+	uint64_t      mClock;
+
+	std::map<std::string, model> mModels;
+
+	pthread_mutex_t mMutex;
+	pthread_cond_t  mCond;		// signalled when a model finishes loading
+};
+
+
+#endif
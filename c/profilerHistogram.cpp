@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "profilerHistogram.h"
+
+#include <math.h>
+
+
+// lower limit of the first bucket, and the number of buckets per octave
+#define BUCKET_BASE_MS      0.001f
+#define BUCKETS_PER_OCTAVE  4
+
+
+// constructor
+profilerHistogram::profilerHistogram()
+{
+	Reset();
+}
+
+
+// Reset
+void profilerHistogram::Reset()
+{
+	for( uint32_t n=0; n < NumBuckets; n++ )
+		mBuckets[n].store(0, std::memory_order_relaxed);
+
+	mCount.store(0, std::memory_order_relaxed);
+	mSumUS.store(0, std::memory_order_relaxed);
+	mMaxUS.store(0, std::memory_order_relaxed);
+}
+
+
+// GetBucket
+uint32_t profilerHistogram::GetBucket( float ms )
+{
+	if( !(ms > BUCKET_BASE_MS) )	// also catches NaN
+		return 0;
+
+	const float bucket = floorf(log2f(ms / BUCKET_BASE_MS) * BUCKETS_PER_OCTAVE);
+
+	if( bucket >= (float)(NumBuckets - 1) )
+		return NumBuckets - 1;
+
+	return (uint32_t)bucket;
+}
+
+
+// GetBucketLimit
+float profilerHistogram::GetBucketLimit( uint32_t bucket )
+{
+	return BUCKET_BASE_MS * exp2f((float)(bucket + 1) / (float)BUCKETS_PER_OCTAVE);
+}
+
+
+// Add
+void profilerHistogram::Add( float ms )
+{
+	if( !(ms >= 0.0f) )
+		return;
+
+	const uint64_t us = (uint64_t)(ms * 1000.0f + 0.5f);
+
+	mBuckets[GetBucket(ms)].fetch_add(1, std::memory_order_relaxed);
+	mSumUS.fetch_add(us, std::memory_order_relaxed);
+	mCount.fetch_add(1, std::memory_order_relaxed);
+
+	uint64_t max = mMaxUS.load(std::memory_order_relaxed);
+
+	while( us > max && !mMaxUS.compare_exchange_weak(max, us, std::memory_order_relaxed) )
+		;
+}
+
+
+// GetMean
+float profilerHistogram::GetMean() const
+{
+	const uint64_t count = GetCount();
+
+	if( count == 0 )
+		return 0.0f;
+
+	return (mSumUS.load(std::memory_order_relaxed) * 0.001) / count;
+}
+
+
+// GetPercentile
+float profilerHistogram::GetPercentile( float percentile ) const
+{
+	const uint64_t count = GetCount();
+
+	if( count == 0 )
+		return 0.0f;
+
+	if( percentile < 0.0f )
+		percentile = 0.0f;
+	else if( percentile > 1.0f )
+		percentile = 1.0f;
+
+	// the rank of the sample, counting from 1
+	uint64_t rank = (uint64_t)ceilf(percentile * count);
+
+	if( rank == 0 )
+		rank = 1;
+
+	uint64_t total = 0;
+
+	for( uint32_t n=0; n < NumBuckets; n++ )
+	{
+		total += GetBucketCount(n);
+
+		if( total >= rank )
+		{
+			// the bucket limit can't exceed the largest sample seen
+			const float limit = GetBucketLimit(n);
+			const float max   = GetMax();
+
+			return (max > 0.0f && max < limit) ? max : limit;
+		}
+	}
+
+	return GetMax();
+}
+
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __PROFILER_HISTOGRAM_H__
+#define __PROFILER_HISTOGRAM_H__
+
+#include <stdint.h>
+#include <atomic>
+
+
+/**
+ * Lock-free histogram of timing samples (in milliseconds), used by tensorNet
+ * to keep the distribution of each profiler query across many runs.
+ *
+ * Samples are binned into buckets that are a quarter-octave wide, starting
+ * at 1 microsecond and covering up to ~16 seconds, so percentiles are
+ * accurate to within ~19%.  All counters are atomic, so Add() may be called
+ * from the thread running the network while another thread reads the stats.
+ * @ingroup tensorNet
+ */
+class profilerHistogram
+{
+public:
+	/**
+	 * The number of buckets in the histogram.
+	 */
+	static const uint32_t NumBuckets = 96;
+
+	/**
+	 * Constructor
+	 */
+	profilerHistogram();
+
+	/**
+	 * Add a sample (in milliseconds) to the histogram.
+	 */
+	void Add( float ms );
+
+	/**
+	 * Clear all of the samples.
+	 */
+	void Reset();
+
+	/**
+	 * Retrieve the number of samples recorded.
+	 */
+	inline uint64_t GetCount() const						{ return mCount.load(std::memory_order_relaxed); }
+
+	/**
+	 * Retrieve the mean of the samples (in milliseconds).
+	 */
+	float GetMean() const;
+
+	/**
+	 * Retrieve the maximum sample (in milliseconds).
+	 */
+	inline float GetMax() const							{ return mMaxUS.load(std::memory_order_relaxed) * 0.001f; }
+
+	/**
+	 * Retrieve the approximate percentile (between 0.0 and 1.0) of the samples, in milliseconds.
+	 * The value returned is the upper limit of the bucket containing the percentile.
+	 */
+	float GetPercentile( float percentile ) const;
+
+	/**
+	 * Retrieve the number of samples in a bucket.
+	 */
+	inline uint64_t GetBucketCount( uint32_t bucket ) const	{ return mBuckets[bucket].load(std::memory_order_relaxed); }
+
+	/**
+	 * Retrieve the upper limit of a bucket (in milliseconds).
+	 */
+	static float GetBucketLimit( uint32_t bucket );
+
+	/**
+	 * Find the bucket that a sample (in milliseconds) belongs to.
+	 */
+	static uint32_t GetBucket( float ms );
+
+private:
+	profilerHistogram( const profilerHistogram& );
+	profilerHistogram& operator=( const profilerHistogram& );
+
+	std::atomic<uint64_t> mBuckets[NumBuckets];
+	std::atomic<uint64_t> mCount;
+	std::atomic<uint64_t> mSumUS;	// microseconds
+	std::atomic<uint64_t> mMaxUS;	// microseconds
+};
+
+#endif
+
@@ -22,6 +22,7 @@
 
 #include "segNet.h"
 #include "imageNet.cuh"
+#include "hostPostProcess.h"
 
 #include "cudaMappedMemory.h"
 #include "cudaOverlay.h"
@@ -34,7 +35,6 @@
 // constructor
 segNet::segNet() : tensorNet()
 {
-	mLastInputImg    = NULL;
 	mLastInputWidth  = 0;
 	mLastInputHeight = 0;
 
@@ -45,6 +45,8 @@ segNet::segNet() : tensorNet()
 	mClassMap[1] = NULL;
 
 	mNetworkType = SEGNET_CUSTOM;
+
+	mBindingPrecisionSupported = true;
 }
 
 
@@ -143,6 +145,7 @@ segNet* segNet::Create( int argc, char** argv )
 	commandLine cmdLine(argc, argv);
 
 	const char* modelName = cmdLine.GetString("model");
+	segNet* net = NULL;
 
 	if( !modelName )
 	{
@@ -177,7 +180,7 @@ segNet* segNet::Create( int argc, char** argv )
 			type = segNet::FCN_ALEXNET_AERIAL_FPV_720p_21ch;*/
 
 		// create segnet from pretrained model
-		return segNet::Create(type);
+		net = segNet::Create(type);
 	}
 	else
 	{
@@ -195,8 +198,43 @@ segNet* segNet::Create( int argc, char** argv )
 		if( maxBatchSize < 1 )
 			maxBatchSize = DEFAULT_MAX_BATCH_SIZE;
 
-		return segNet::Create(prototxt, modelName, labels, colors, input, output, maxBatchSize);
+		net = segNet::Create(prototxt, modelName, labels, colors, input, output, maxBatchSize);
 	}
+
+	if( !net )
+		return NULL;
+
+	// run the network on synthetic frames until its latency converges
+	if( cmdLine.GetFlag("warmup") && !net->Warmup(cmdLine.GetInt("warmup", WARMUP_DEFAULT_ITERATIONS)) )
+	{
+		delete net;
+		return NULL;
+	}
+
+	// record the outputs for offline replay
+	const char* recording = cmdLine.GetString("record");
+
+	if( recording != NULL && !net->EnableRecording(recording) )
+	{
+		delete net;
+		return NULL;
+	}
+
+	return net;
+}
+
+
+// inputRange
+float segNet::inputRange() const
+{
+	return cudaPreImageNetRange();	// raw BGR pixels (@see cudaPreImageNetBGR())
+}
+
+
+// warmupIteration
+bool segNet::warmupIteration( float* rgba, uint32_t width, uint32_t height )
+{
+	return Process(rgba, width, height) && Overlay(rgba, width, height);
 }
 
 
@@ -257,7 +295,7 @@ segNet* segNet::Create( const char* prototxt, const char* model, const char* lab
 
 	printf(LOG_TRT "segNet outputs -- s_w %i  s_h %i  s_c %i\n", s_w, s_h, s_c);
 
-	if( !cudaAllocMapped((void**)&net->mClassMap[0], (void**)&net->mClassMap[1], s_w * s_h * sizeof(uint8_t)) )
+	if( !cudaAllocMapped((void**)&net->mClassMap[0], (void**)&net->mClassMap[1], s_w * s_h * net->GetMaxBatchSize() * sizeof(uint8_t)) )
 		return NULL;
 
 	// load class info
@@ -439,7 +477,7 @@ bool segNet::Process( float* rgba, uint32_t width, uint32_t height, const char*
 	PROFILER_BEGIN(PROFILER_PREPROCESS);
 
 	// downsample and convert to band-sequential BGR
-	if( CUDA_FAILED(cudaPreImageNetBGR((float4*)rgba, width, height, mInputCUDA, mWidth, mHeight, GetStream())) )
+	if( CUDA_FAILED(cudaPreImageNetBGR((float4*)rgba, width, height, mInputCUDA, mWidth, mHeight, GetStream(), GetInputType())) )
 	{
 		printf("segNet::Process() -- cudaPreImageNet failed\n");
 		return false;
@@ -451,12 +489,14 @@ bool segNet::Process( float* rgba, uint32_t width, uint32_t height, const char*
 	// process with TensorRT
 	void* inferenceBuffers[] = { mInputCUDA, mOutputs[0].CUDA };
 
-	if( !mContext->execute(1, inferenceBuffers) )
+	if( !selectContext(1)->execute(1, inferenceBuffers) )
 	{
 		printf(LOG_TRT "segNet::Process() -- failed to execute TensorRT context\n");
 		return false;
 	}
 
+	convertOutputs(1);
+
 	PROFILER_END(PROFILER_NETWORK);
 	PROFILER_BEGIN(PROFILER_POSTPROCESS);
 
@@ -466,8 +506,74 @@ bool segNet::Process( float* rgba, uint32_t width, uint32_t height, const char*
 
 	PROFILER_END(PROFILER_POSTPROCESS);
 
+	recordOutputs(width, height, 1);
+
 	// cache pointer to last image processed
-	mLastInputImg = rgba;
+	mLastInputImgs.assign(1, rgba);
+	mLastInputWidth = width;
+	mLastInputHeight = height;
+
+	return true;
+}
+
+
+// ProcessBatch
+bool segNet::ProcessBatch( float** rgba, uint32_t width, uint32_t height, uint32_t batchSize, const char* ignore_class )
+{
+	if( !rgba || width == 0 || height == 0 )
+	{
+		printf("segNet::ProcessBatch( 0x%p, %u, %u ) -> invalid parameters\n", rgba, width, height);
+		return false;
+	}
+
+	if( batchSize == 0 || batchSize > mMaxBatchSize )
+	{
+		printf("segNet::ProcessBatch() -- invalid batch size %u (max batch size is %u)\n", batchSize, mMaxBatchSize);
+		return false;
+	}
+
+	PROFILER_BEGIN(PROFILER_PREPROCESS);
+
+	// downsample and convert each image to band-sequential BGR in its entry of the batch
+	for( uint32_t n=0; n < batchSize; n++ )
+	{
+		if( !rgba[n] || CUDA_FAILED(cudaPreImageNetBGR((float4*)rgba[n], width, height, GetInputBatch(n), mWidth, mHeight, GetStream(), GetInputType())) )
+		{
+			printf("segNet::ProcessBatch() -- cudaPreImageNet failed for image %u of the batch\n", n);
+			return false;
+		}
+	}
+
+	PROFILER_END(PROFILER_PREPROCESS);
+	PROFILER_BEGIN(PROFILER_NETWORK);
+
+	// process the whole batch with TensorRT
+	void* inferenceBuffers[] = { mInputCUDA, mOutputs[0].CUDA };
+
+	if( !selectContext(batchSize)->execute(batchSize, inferenceBuffers) )
+	{
+		printf(LOG_TRT "segNet::ProcessBatch() -- failed to execute TensorRT context\n");
+		return false;
+	}
+
+	convertOutputs(batchSize);
+
+	PROFILER_END(PROFILER_NETWORK);
+	PROFILER_BEGIN(PROFILER_POSTPROCESS);
+
+	// generate argmax classification map of each entry
+	for( uint32_t n=0; n < batchSize; n++ )
+	{
+		if( !classify(ignore_class, n) )
+			return false;
+	}
+
+	PROFILER_END(PROFILER_POSTPROCESS);
+
+	recordOutputs(width, height, batchSize);
+
+	// cache pointers to the images processed
+	mLastInputImgs.assign(rgba, rgba + batchSize);
 	mLastInputWidth = width;
 	mLastInputHeight = height;
 
@@ -475,11 +581,30 @@ bool segNet::Process( float* rgba, uint32_t width, uint32_t height, const char*
 }
 
 
+// Classify
+bool segNet::Classify( const char* ignore_class, uint32_t batchIndex )
+{
+	if( batchIndex >= mMaxBatchSize )
+	{
+		printf("segNet::Classify() -- invalid batch index %u (max batch size is %u)\n", batchIndex, mMaxBatchSize);
+		return false;
+	}
+
+	PROFILER_BEGIN(PROFILER_POSTPROCESS);
+
+	if( !classify(ignore_class, batchIndex) )
+		return false;
+
+	PROFILER_END(PROFILER_POSTPROCESS);
+	return true;
+}
+
+
 // argmax classification
-bool segNet::classify( const char* ignore_class )
+bool segNet::classify( const char* ignore_class, uint32_t batchIndex )
 {
 	// retrieve scores
-	float* scores = mOutputs[0].CPU;
+	float* scores = GetOutputBatch(0, batchIndex);
 
 	const int s_w = DIMS_W(mOutputs[0].dims);
 	const int s_h = DIMS_H(mOutputs[0].dims);
@@ -499,43 +624,16 @@ bool segNet::classify( const char* ignore_class )
 
 
 	// find the argmax-classified class of each tile
-	uint8_t* classMap = mClassMap[0];
-
-	for( uint32_t y=0; y < s_h; y++ )
-	{
-		for( uint32_t x=0; x < s_w; x++ )
-		{
-			float p_max = -100000.0f;
-			int   c_max = -1;
-
-			for( int c=0; c < s_c; c++ )
-			{
-				// skip ignoreID
-				if( c == ignoreID )
-					continue;
-
-				// check if this class score is higher
-				const float p = scores[c * s_w * s_h + y * s_w + x];
-
-				if( c_max < 0 || p > p_max )
-				{
-					p_max = p;
-					c_max = c;
-				}
-			}
-
-			classMap[y * s_w + x] = c_max;
-		}
-	}
+	classifyGrid(scores, s_w, s_h, s_c, ignoreID, mClassMap[0] + batchIndex * s_w * s_h);
 
 	return true;
 }
 
 
 // Mask (binary)
-bool segNet::Mask( uint8_t* output, uint32_t out_width, uint32_t out_height )
+bool segNet::Mask( uint8_t* output, uint32_t out_width, uint32_t out_height, uint32_t batchIndex )
 {
-	if( !output || out_width == 0 || out_height == 0 )
+	if( !output || out_width == 0 || out_height == 0 || batchIndex >= mMaxBatchSize )
 	{
 		printf("segNet::Mask( 0x%p, %u, %u ) -> invalid parameters\n", output, out_width, out_height);
 		return false;
@@ -543,31 +641,11 @@ bool segNet::Mask( uint8_t* output, uint32_t out_width, uint32_t out_height )
 
 	PROFILER_BEGIN(PROFILER_VISUALIZE);
 
-	// retrieve classification map
-	uint8_t* classMap = mClassMap[0];
-
 	const int s_w = DIMS_W(mOutputs[0].dims);
 	const int s_h = DIMS_H(mOutputs[0].dims);
 
-	const float s_x = float(s_w) / float(out_width);
-	const float s_y = float(s_h) / float(out_height);
-
-
-	// overlay pixels onto original
-	for( uint32_t y=0; y < out_height; y++ )
-	{
-		for( uint32_t x=0; x < out_width; x++ )
-		{
-			const int cx = float(x) * s_x;
-			const int cy = float(y) * s_y;
-
-			// get the class ID of this cell
-			const uint8_t classIdx = classMap[cy * s_w + cx];
-
-			// output the pixel
-			output[y * out_width + x] = classIdx;
-		}
-	}
+	// resize the classification map to the output
+	resizeClassMap(mClassMap[0] + batchIndex * s_w * s_h, s_w, s_h, output, out_width, out_height);
 
 	PROFILER_END(PROFILER_VISUALIZE);
 	return true;
@@ -575,9 +653,9 @@ bool segNet::Mask( uint8_t* output, uint32_t out_width, uint32_t out_height )
 
 
 // Mask (colorized)
-bool segNet::Mask( float* output, uint32_t width, uint32_t height, FilterMode filter )
+bool segNet::Mask( float* output, uint32_t width, uint32_t height, FilterMode filter, uint32_t batchIndex )
 {
-	if( !output || width == 0 || height == 0 )
+	if( !output || width == 0 || height == 0 || batchIndex >= mMaxBatchSize )
 	{
 		printf("segNet::Mask( 0x%p, %u, %u ) -> invalid parameters\n", output, width, height);
 		return false;
@@ -585,16 +663,16 @@ bool segNet::Mask( float* output, uint32_t width, uint32_t height, FilterMode fi
 
 	// filter in point or linear
 	if( filter == FILTER_POINT )
-		return overlayPoint(NULL, 0, 0, output, width, height, true);
+		return overlayPoint(NULL, 0, 0, output, width, height, true, batchIndex);
 	else if( filter == FILTER_LINEAR )
-		return overlayLinear(NULL, 0, 0, output, width, height, true);
+		return overlayLinear(NULL, 0, 0, output, width, height, true, batchIndex);
 
 	return false;
 }
 
 
 // Overlay
-bool segNet::Overlay( float* output, uint32_t width, uint32_t height, FilterMode filter )
+bool segNet::Overlay( float* output, uint32_t width, uint32_t height, FilterMode filter, uint32_t batchIndex )
 {
 	if( !output || width == 0 || height == 0 )
 	{
@@ -602,17 +680,19 @@ bool segNet::Overlay( float* output, uint32_t width, uint32_t height, FilterMode
 		return false;
 	}
 
-	if( !mLastInputImg )
+	if( batchIndex >= mLastInputImgs.size() )
 	{
 		printf(LOG_TRT "segNet -- Process() must be called before Overlay()\n");
 		return false;
 	}
 
+	float* input = mLastInputImgs[batchIndex];
+
 	// filter in point or linear
 	if( filter == FILTER_POINT )
-		return overlayPoint(mLastInputImg, mLastInputWidth, mLastInputHeight, output, width, height, false);
+		return overlayPoint(input, mLastInputWidth, mLastInputHeight, output, width, height, false, batchIndex);
 	else if( filter == FILTER_LINEAR )
-		return overlayLinear(mLastInputImg, mLastInputWidth, mLastInputHeight, output, width, height, false);
+		return overlayLinear(input, mLastInputWidth, mLastInputHeight, output, width, height, false, batchIndex);
 
 	return false;
 }
@@ -628,14 +708,16 @@ cudaError_t cudaSegOverlay( float4* input, uint32_t in_width, uint32_t in_height
 
 
 // overlayLinear
-bool segNet::overlayPoint( float* input, uint32_t in_width, uint32_t in_height, float* output, uint32_t out_width, uint32_t out_height, bool mask_only )
+bool segNet::overlayPoint( float* input, uint32_t in_width, uint32_t in_height, float* output, uint32_t out_width, uint32_t out_height, bool mask_only, uint32_t batchIndex )
 {
 	PROFILER_BEGIN(PROFILER_VISUALIZE);
 
+	const uint32_t classMapOffset = batchIndex * DIMS_W(mOutputs[0].dims) * DIMS_H(mOutputs[0].dims);
+
 #ifdef OVERLAY_CUDA
 	// generate overlay on the GPU
 	if( CUDA_FAILED(cudaSegOverlay((float4*)input, in_width, in_height, (float4*)output, out_width, out_height,
-							 (float4*)mClassColors[1], mClassMap[1], make_int2(DIMS_W(mOutputs[0].dims), DIMS_H(mOutputs[0].dims)),
+							 (float4*)mClassColors[1], mClassMap[1] + classMapOffset, make_int2(DIMS_W(mOutputs[0].dims), DIMS_H(mOutputs[0].dims)),
 							 false, mask_only, GetStream())) )
 	{
 		printf(LOG_TRT "segNet -- failed to process %ux%u overlay/mask with CUDA\n", out_width, out_height);
@@ -643,7 +725,7 @@ bool segNet::overlayPoint( float* input, uint32_t in_width, uint32_t in_height,
 	}
 #else
 	// retrieve classification map
-	uint8_t* classMap = mClassMap[0];
+	uint8_t* classMap = mClassMap[0] + classMapOffset;
 
 	const int s_w = DIMS_W(mOutputs[0].dims);
 	const int s_h = DIMS_H(mOutputs[0].dims);
@@ -702,14 +784,16 @@ bool segNet::overlayPoint( float* input, uint32_t in_width, uint32_t in_height,
 
 
 // overlayLinear
-bool segNet::overlayLinear( float* input, uint32_t in_width, uint32_t in_height, float* output, uint32_t out_width, uint32_t out_height, bool mask_only )
+bool segNet::overlayLinear( float* input, uint32_t in_width, uint32_t in_height, float* output, uint32_t out_width, uint32_t out_height, bool mask_only, uint32_t batchIndex )
 {
 	PROFILER_BEGIN(PROFILER_VISUALIZE);
 
+	const uint32_t classMapOffset = batchIndex * DIMS_W(mOutputs[0].dims) * DIMS_H(mOutputs[0].dims);
+
 #ifdef OVERLAY_CUDA
 	// generate overlay on the GPU
 	if( CUDA_FAILED(cudaSegOverlay((float4*)input, in_width, in_height, (float4*)output, out_width, out_height,
-							 (float4*)mClassColors[1], mClassMap[1], make_int2(DIMS_W(mOutputs[0].dims), DIMS_H(mOutputs[0].dims)),
+							 (float4*)mClassColors[1], mClassMap[1] + classMapOffset, make_int2(DIMS_W(mOutputs[0].dims), DIMS_H(mOutputs[0].dims)),
 							 true, mask_only, GetStream())) )
 	{
 		printf(LOG_TRT "segNet -- failed to process %ux%u overlay/mask with CUDA\n", out_width, out_height);
@@ -717,7 +801,7 @@ bool segNet::overlayLinear( float* input, uint32_t in_width, uint32_t in_height,
 	}
 #else
 	// retrieve classification map
-	uint8_t* classMap = mClassMap[0];
+	uint8_t* classMap = mClassMap[0] + classMapOffset;
 
 	const int s_w = DIMS_W(mOutputs[0].dims);
 	const int s_h = DIMS_H(mOutputs[0].dims);
@@ -146,16 +146,40 @@ public:
 	 */
 	bool Process( float* input, uint32_t width, uint32_t height, const char* ignore_class="void" );
 
+	/**
+ 	 * Perform the inferencing processing portion of the segmentation on a batch of images,
+	 * executing the network once for the whole batch.  batchSize must not exceed the
+	 * maxBatchSize that the network was loaded with (@see GetMaxBatchSize()).
+	 * The results of each image can then be visualized by passing its index in the
+	 * batch to the Overlay() and Mask() functions.
+	 * @param input array of float4 input images in CUDA device memory, RGBA colorspace with values 0-255.
+	 * @param width width of the input images in pixels.
+	 * @param height height of the input images in pixels.
+	 * @param batchSize the number of images in the batch.
+	 * @param ignore_class label name of class to ignore in the classification (or NULL to process all).
+	 */
+	bool ProcessBatch( float** input, uint32_t width, uint32_t height, uint32_t batchSize, const char* ignore_class="void" );
+
+	/**
+	 * Generate the argmax classification of an entry in the batch from the current outputs, without running
+	 * the network.  This replays the post-processing on outputs that were loaded with tensorNet::ReplayOutputs(),
+	 * so that it can be profiled on recorded field data (@see tensorRecorder).  The classification can then be
+	 * retrieved with Mask() (the overlays need the input image, which isn't recorded).
+	 * @param ignore_class label name of class to ignore in the classification (or NULL to process all).
+	 * @param batchIndex index of the entry in the batch of the outputs.
+	 */
+	bool Classify( const char* ignore_class="void", uint32_t batchIndex=0 );
+
 	/**
 	 * Produce a grayscale binary segmentation mask, where the pixel values
 	 * correspond to the class ID of the corresponding class type.
 	 */
-	bool Mask( uint8_t* output, uint32_t width, uint32_t height );
+	bool Mask( uint8_t* output, uint32_t width, uint32_t height, uint32_t batchIndex=0 );
 
 	/**
 	 * Produce a colorized RGBA segmentation mask.
 	 */
-	bool Mask( float* output, uint32_t width, uint32_t height, FilterMode filter=FILTER_LINEAR );
+	bool Mask( float* output, uint32_t width, uint32_t height, FilterMode filter=FILTER_LINEAR, uint32_t batchIndex=0 );
 
 	/**
 	 * Produce the segmentation overlay alpha blended on top of the original image.
@@ -163,11 +187,11 @@ public:
 	 * @param output float4 output image in CUDA device memory, RGBA colorspace with values 0-255.
 	 * @param width width of the input image in pixels.
 	 * @param height height of the input image in pixels.
-	 * @param ignore_class label name of class to ignore in the classification (or NULL to process all).
-	 * @param type overlay visualization options
+	 * @param filter the filtering mode used to upsample the classification grid.
+	 * @param batchIndex index of the image in the batch given to ProcessBatch() (or 0 after Process())
 	 * @returns true on success, false on error.
 	 */
-	bool Overlay( float* output, uint32_t width, uint32_t height, FilterMode filter=FILTER_LINEAR );
+	bool Overlay( float* output, uint32_t width, uint32_t height, FilterMode filter=FILTER_LINEAR, uint32_t batchIndex=0 );
 
 	/**
 	 * Find the ID of a particular class (by label name).
@@ -231,10 +255,13 @@ public:
 protected:
 	segNet();
 
-	bool classify( const char* ignore_class );
+	bool classify( const char* ignore_class, uint32_t batchIndex=0 );
+
+	virtual bool warmupIteration( float* rgba, uint32_t width, uint32_t height );
+	virtual float inputRange() const;
 
-	bool overlayPoint( float* input, uint32_t in_width, uint32_t in_height, float* output, uint32_t out_width, uint32_t out_height, bool mask_only );
-	bool overlayLinear( float* input, uint32_t in_width, uint32_t in_height, float* output, uint32_t out_width, uint32_t out_height, bool mask_only );
+	bool overlayPoint( float* input, uint32_t in_width, uint32_t in_height, float* output, uint32_t out_width, uint32_t out_height, bool mask_only, uint32_t batchIndex=0 );
+	bool overlayLinear( float* input, uint32_t in_width, uint32_t in_height, float* output, uint32_t out_width, uint32_t out_height, bool mask_only, uint32_t batchIndex=0 );
 
 	bool loadClassColors( const char* filename );
 	bool loadClassLabels( const char* filename );
@@ -243,9 +270,9 @@ protected:
 	std::string mClassPath;
 
 	float*   mClassColors[2];	/**< array of overlay colors in shared CPU/GPU memory */
-	uint8_t* mClassMap[2];		/**< runtime buffer for the argmax-classified class index of each tile */
+	uint8_t* mClassMap[2];		/**< runtime buffer for the argmax-classified class index of each tile (one grid per batch entry) */
 
-	float*   mLastInputImg;		/**< last input image to be processed, stored for overlay */
+	std::vector<float*> mLastInputImgs;	/**< last input images to be processed (one per batch entry), stored for overlay */
 	uint32_t mLastInputWidth;	/**< width in pixels of last input image to be processed */
 	uint32_t mLastInputHeight;	/**< height in pixels of last input image to be processed */
 
@@ -109,11 +109,27 @@ bool superResNet::UpscaleRGBA( float* input, uint32_t inputWidth, uint32_t input
 	 * perform the inferencing
  	 */
 	void* bindBuffers[] = { mInputCUDA, mOutputs[0].CUDA };	
+	cudaStream_t stream = GetStream();
 
-	if( !mContext->execute(1, bindBuffers) )
+	if( !stream )
 	{
-		printf(LOG_TRT "superResNet::UpscaleRGBA() -- failed to execute TensorRT network\n");
-		return false;
+		if( !selectContext(1)->execute(1, bindBuffers) )
+		{
+			printf(LOG_TRT "superResNet::UpscaleRGBA() -- failed to execute TensorRT network\n");
+			return false;
+		}
+	}
+	else
+	{
+		const bool result = selectContext(1)->enqueue(1, bindBuffers, stream, NULL);
+
+		CUDA(cudaStreamSynchronize(stream));
+
+		if( !result )
+		{
+			printf(LOG_TRT "superResNet::UpscaleRGBA() -- failed to enqueue TensorRT network\n");
+			return false;
+		}
 	}
 
 	PROFILER_END(PROFILER_NETWORK);
@@ -22,9 +22,11 @@
  
 #include "tensorNet.h"
 #include "randInt8Calibrator.h"
+#include "inferenceMetrics.h"
 #include "cudaMappedMemory.h"
 #include "cudaResize.h"
 #include "filesystem.h"
+#include "halfConvert.h"
 
 #include "NvCaffeParser.h"
 
@@ -36,8 +38,12 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 #include <map>
 
+#include <pthread.h>
+#include <unistd.h>
+
 
 #if NV_TENSORRT_MAJOR > 1
 	#define CREATE_INFER_BUILDER nvinfer1::createInferBuilder
@@ -53,6 +59,43 @@
 					   "           $ ./download-models.sh\n"
 
 
+// networks that are exported by tensorNet::collectMetrics()
+static std::vector<tensorNet*> gMetricsNetworks;
+static pthread_mutex_t gMetricsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static metricCounter* gMetricsCacheHits = inferenceMetrics::Counter("jetson_inference_engine_cache_hits_total", "Networks loaded from a serialized engine cache");
+static metricCounter* gMetricsCacheMisses = inferenceMetrics::Counter("jetson_inference_engine_cache_misses_total", "Networks that were built because no engine cache was found");
+
+
+// native precisions of each device, probed once per process (and optionally persisted)
+static std::vector<precisionType> gNativePrecisions[NUM_DEVICES];
+static bool gNativePrecisionsCached[NUM_DEVICES] = { false };
+static std::string gCapabilityCachePath;
+static bool gCapabilityCacheLoaded = false;
+static pthread_mutex_t gCapabilityMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// options for TYPE_AUTOTUNE
+static float    gAutoTuneTolerance  = 0.05f;
+static uint32_t gAutoTuneIterations = 50;
+
+// data types of the bindings (@see tensorNet::SetBindingPrecision())
+static precisionType gBindingInputType  = TYPE_FP32;
+static precisionType gBindingOutputType = TYPE_FP32;
+
+// batch sizes of the additional engines (@see tensorNet::SetEngineSet())
+static std::vector<uint32_t> gEngineSet;
+
+
+// return the milliseconds elapsed since the beginning of a load stage, and begin the next stage
+static float loadStageTime( timespec* begin )
+{
+	const timespec now = timestamp();
+	const float ms = timeFloat(timeDiff(*begin, now));
+	*begin = now;
+	return ms;
+}
+
+
 //---------------------------------------------------------------------
 const char* precisionTypeToStr( precisionType type )
 {
@@ -63,6 +106,7 @@ const char* precisionTypeToStr( precisionType type )
 		case TYPE_FP32:	return "FP32";
 		case TYPE_FP16:	return "FP16";
 		case TYPE_INT8:	return "INT8";
+		case TYPE_AUTOTUNE:	return "AUTOTUNE";
 	}
 }
 
@@ -240,6 +284,41 @@ const char* profilerQueryToStr( profilerQuery query )
 	}
 }
 
+// profilerQueryFromStr
+profilerQuery profilerQueryFromStr( const char* str )
+{
+	if( !str )
+		return PROFILER_TOTAL;
+
+	for( int n=0; n < PROFILER_TOTAL; n++ )
+	{
+		const char* name = profilerQueryToStr((profilerQuery)n);
+
+		if( strcasecmp(str, name) == 0 )
+			return (profilerQuery)n;
+
+		// also accept the names without the dash (i.e. "preprocess")
+		const char* dash = strchr(name, '-');
+
+		if( dash != NULL && strlen(str) == strlen(name) - 1 && strncasecmp(str, name, dash - name) == 0 && strcasecmp(str + (dash - name), dash + 1) == 0 )
+			return (profilerQuery)n;
+	}
+
+	return PROFILER_TOTAL;
+}
+
+// profilerDeviceToStr
+const char* profilerDeviceToStr( profilerDevice device )
+{
+	switch(device)
+	{
+		case PROFILER_CPU:  return "CPU";
+		case PROFILER_CUDA: return "CUDA";
+	}
+
+	return NULL;
+}
+
 //---------------------------------------------------------------------
 
 // constructor
@@ -256,6 +335,7 @@ tensorNet::tensorNet()
 	mMaxBatchSize   = 0;
 	mInputCPU       = NULL;
 	mInputCUDA      = NULL;
+	mEngineSize     = 0;
 	mEnableDebug    = false;
 	mEnableProfiler = false;
 
@@ -264,12 +344,18 @@ tensorNet::tensorNet()
 	mDevice    	   = DEVICE_GPU;
 	mAllowGPUFallback = false;
 
+	mBindingPrecisionSupported = false;
+	mEngineSetEnabled = true;
+	mRecorder = NULL;
+
+	mLayerTransitions    = 0;
+	mWarmedUp            = false;
 	mProfilerQueriesUsed = 0;
-	mProfilerQueriesDone = 0;
+	mProfilerRequest     = 0;
+	mProfilerRecord      = NULL;
 
-	memset(mEventsCPU, 0, sizeof(mEventsCPU));
-	memset(mEventsGPU, 0, sizeof(mEventsGPU));
 	memset(mProfilerTimes, 0, sizeof(mProfilerTimes));
+	memset(&mLoadReport, 0, sizeof(mLoadReport));
 
 #if NV_TENSORRT_MAJOR < 2
 	memset(&mInputDims, 0, sizeof(Dims3));
@@ -280,6 +366,28 @@ tensorNet::tensorNet()
 // Destructor
 tensorNet::~tensorNet()
 {
+	pthread_mutex_lock(&gMetricsMutex);
+	gMetricsNetworks.erase(std::remove(gMetricsNetworks.begin(), gMetricsNetworks.end(), this), gMetricsNetworks.end());
+	pthread_mutex_unlock(&gMetricsMutex);
+
+	DisableRecording();
+
+	for( size_t n=0; n < mEngineSet.size(); n++ )
+	{
+		if( mEngineSet[n].context != NULL )
+			mEngineSet[n].context->destroy();
+
+		mEngineSet[n].engine->destroy();
+	}
+
+	mEngineSet.clear();
+
+	if( mContext != NULL )
+	{
+		mContext->destroy();
+		mContext = NULL;
+	}
+
 	if( mEngine != NULL )
 	{
 		mEngine->destroy();
@@ -291,768 +399,2598 @@ tensorNet::~tensorNet()
 		mInfer->destroy();
 		mInfer = NULL;
 	}
+
+	for( size_t n=0; n < mInputs.size(); n++ )
+		CUDA(cudaFreeHost(mInputs[n].CPU));
+
+	mInputCPU  = NULL;
+	mInputCUDA = NULL;
+
+	for( size_t n=0; n < mOutputs.size(); n++ )
+	{
+		if( mOutputs[n].CPU != mOutputs[n].mapped )
+			free(mOutputs[n].CPU);
+
+		CUDA(cudaFreeHost(mOutputs[n].mapped));
+	}
+
+	for( size_t n=0; n < mProfilerRecords.size(); n++ )
+	{
+		for( int e=0; e < PROFILER_TOTAL * 2; e++ )
+			CUDA(cudaEventDestroy(mProfilerRecords[n]->eventsGPU[e]));
+
+		delete mProfilerRecords[n];
+	}
 }
 
 
-// EnableProfiler
-void tensorNet::EnableLayerProfiler()
+// validateBinding
+static bool validateBinding( const char* name, const Dims3& expectedDims, size_t expectedSize, precisionType expectedType, const Dims3& dims, size_t size, precisionType type )
 {
-	mEnableProfiler = true;
+	if( DIMS_C(dims) != DIMS_C(expectedDims) || DIMS_H(dims) != DIMS_H(expectedDims) || DIMS_W(dims) != DIMS_W(expectedDims) )
+	{
+		printf(LOG_TRT "binding %s has dims (c=%u h=%u w=%u), but the network expects (c=%u h=%u w=%u)\n", name,
+			  DIMS_C(dims), DIMS_H(dims), DIMS_W(dims), DIMS_C(expectedDims), DIMS_H(expectedDims), DIMS_W(expectedDims));
+		return false;
+	}
 
-	if( mContext != NULL )
-		mContext->setProfiler(&gProfiler);
+	if( type != expectedType )
+	{
+		printf(LOG_TRT "binding %s has type %s, but the network expects %s\n", name, precisionTypeToStr(type), precisionTypeToStr(expectedType));
+		return false;
+	}
+
+	if( size < expectedSize )
+	{
+		printf(LOG_TRT "binding %s is %zu bytes, but the network expects at least %zu bytes\n", name, size, expectedSize);
+		return false;
+	}
+
+	return true;
 }
 
 
-// EnableDebug
-void tensorNet::EnableDebug()
+// SetInputBinding
+bool tensorNet::SetInputBinding( uint32_t input, void* buffer, const Dims3& dims, size_t size, precisionType type )
 {
-	mEnableDebug = true;
+	if( input >= mInputs.size() )
+	{
+		printf(LOG_TRT "SetInputBinding() -- invalid input %u (the network has %zu inputs)\n", input, mInputs.size());
+		return false;
+	}
+
+	if( buffer != NULL && !validateBinding(mInputs[input].name.c_str(), mInputs[input].dims, mInputs[input].size, mInputs[input].type, dims, size, type) )
+		return false;
+
+	mInputs[input].binding = buffer;
+	mBindings[mInputs[input].index] = GetInputBinding(input);
+
+	return true;
 }
 
 
-// DetectNativePrecisions()
-std::vector<precisionType> tensorNet::DetectNativePrecisions( deviceType device )
+// SetOutputBinding
+bool tensorNet::SetOutputBinding( uint32_t output, void* buffer, const Dims3& dims, size_t size, precisionType type )
 {
-	std::vector<precisionType> types;
-	Logger logger;
-
-	// create a temporary builder for querying the supported types
-	nvinfer1::IBuilder* builder = CREATE_INFER_BUILDER(logger);
-		
-	if( !builder )
+	if( output >= mOutputs.size() )
 	{
-		printf(LOG_TRT "QueryNativePrecisions() failed to create TensorRT IBuilder instance\n");
-		return types;
+		printf(LOG_TRT "SetOutputBinding() -- invalid output %u (the network has %zu outputs)\n", output, mOutputs.size());
+		return false;
 	}
 
-#if NV_TENSORRT_MAJOR >= 5
-	if( device == DEVICE_DLA_0 || device == DEVICE_DLA_1 )
-		builder->setFp16Mode(true);
-
-	builder->setDefaultDeviceType( deviceTypeToTRT(device) );
-#endif
+	if( buffer != NULL && !validateBinding(mOutputs[output].name.c_str(), mOutputs[output].dims, mOutputs[output].size, mOutputs[output].type, dims, size, type) )
+		return false;
 
-	// FP32 is supported on all platforms
-	types.push_back(TYPE_FP32);
+	mOutputs[output].binding = buffer;
+	mBindings[mOutputs[output].index] = GetOutputBinding(output);
 
-	// detect fast (native) FP16
-	if( builder->platformHasFastFp16() )
-		types.push_back(TYPE_FP16);
+	return true;
+}
 
-#if NV_TENSORRT_MAJOR >= 4
-	// detect fast (native) INT8
-	if( builder->platformHasFastInt8() )
-		types.push_back(TYPE_INT8);
-#endif
 
-	// print out supported precisions (optional)
-	const uint32_t numTypes = types.size();
+// FindInput
+int tensorNet::FindInput( const char* name ) const
+{
+	if( !name )
+		return -1;
 
-	printf(LOG_TRT "native precisions detected for %s:  ", deviceTypeToStr(device));
- 
-	for( uint32_t n=0; n < numTypes; n++ )
+	for( size_t n=0; n < mInputs.size(); n++ )
 	{
-		printf("%s", precisionTypeToStr(types[n]));
-
-		if( n < numTypes - 1 )
-			printf(", ");
+		if( mInputs[n].name == name )
+			return n;
 	}
 
-	printf("\n");
-	builder->destroy();
-	return types;
+	return -1;
 }
 
 
-// DetectNativePrecision
-bool tensorNet::DetectNativePrecision( const std::vector<precisionType>& types, precisionType type )
+// FindOutput
+int tensorNet::FindOutput( const char* name ) const
 {
-	const uint32_t numTypes = types.size();
+	if( !name )
+		return -1;
 
-	for( uint32_t n=0; n < numTypes; n++ )
+	for( size_t n=0; n < mOutputs.size(); n++ )
 	{
-		if( types[n] == type )
-			return true;
+		if( mOutputs[n].name == name )
+			return n;
 	}
 
-	return false;
+	return -1;
 }
 
 
-// DetectNativePrecision
-bool tensorNet::DetectNativePrecision( precisionType precision, deviceType device )
+// getBindings
+void tensorNet::getBindings( std::vector<void*>& bindings, bool bound ) const
 {
-	std::vector<precisionType> types = DetectNativePrecisions(device);
-	return DetectNativePrecision(types, precision);
+	bindings.assign(mEngine->getNbBindings(), NULL);
+
+	for( size_t n=0; n < mInputs.size(); n++ )
+		bindings[mInputs[n].index] = bound ? GetInputBinding(n) : mInputs[n].CUDA;
+
+	for( size_t n=0; n < mOutputs.size(); n++ )
+		bindings[mOutputs[n].index] = bound ? GetOutputBinding(n) : mOutputs[n].CUDA;
 }
 
 
-// FindFastestPrecision
-precisionType tensorNet::FindFastestPrecision( deviceType device, bool allowInt8 )
+// convertOutputs
+void tensorNet::convertOutputs( uint32_t batchSize )
 {
-	std::vector<precisionType> types = DetectNativePrecisions(device);
+	for( size_t n=0; n < mOutputs.size(); n++ )
+	{
+		if( mOutputs[n].type == TYPE_FP16 && mOutputs[n].binding == NULL )
+			halfToFloat((uint16_t*)mOutputs[n].mapped, mOutputs[n].CPU, batchSize * mOutputs[n].volume);
+	}
+}
 
-	if( allowInt8 && DetectNativePrecision(types, TYPE_INT8) )
-		return TYPE_INT8;
-	else if( DetectNativePrecision(types, TYPE_FP16) )
-		return TYPE_FP16;
-	else
-		return TYPE_FP32;
+
+// recordOutputs
+void tensorNet::recordOutputs( uint32_t inputWidth, uint32_t inputHeight, uint32_t batchSize )
+{
+	if( !mRecorder )
+		return;
+
+	tensorRecord tensors[TENSOR_RECORD_MAX_TENSORS];
+	const uint32_t numTensors = mOutputs.size();
+
+	for( uint32_t n=0; n < numTensors; n++ )
+	{
+		// outputs bound to caller memory aren't copied to the CPU
+		if( mOutputs[n].binding != NULL )
+			return;
+
+		tensors[n].name    = mOutputs[n].name.c_str();
+		tensors[n].data    = mOutputs[n].CPU;
+		tensors[n].dims[0] = DIMS_C(mOutputs[n].dims);
+		tensors[n].dims[1] = DIMS_H(mOutputs[n].dims);
+		tensors[n].dims[2] = DIMS_W(mOutputs[n].dims);
+	}
+
+	if( !mRecorder->Write(inputWidth, inputHeight, batchSize, tensors, numTensors) )
+	{
+		printf(LOG_TRT "failed to record the outputs of %s, disabling the recording\n", GetModelPath());
+		DisableRecording();
+	}
 }
 
 
-// Create an optimized GIE network from caffe prototxt and model file
-bool tensorNet::ProfileModel(const std::string& deployFile,			   // name for caffe prototxt
-					    const std::string& modelFile,			   // name for model 
-					    const char* input, const Dims3& inputDims,
-					    const std::vector<std::string>& outputs,    // network outputs
-					    unsigned int maxBatchSize,			   // batch size - NB must be at least as large as the batch we want to run with
-					    precisionType precision, 
-					    deviceType device, bool allowGPUFallback,
-					    nvinfer1::IInt8Calibrator* calibrator, 	
-					    std::ostream& gieModelStream)			   // output stream for the GIE model
+// EnableRecording
+bool tensorNet::EnableRecording( const char* path )
 {
-	// create API root class - must span the lifetime of the engine usage
-	nvinfer1::IBuilder* builder = CREATE_INFER_BUILDER(gLogger);
-	nvinfer1::INetworkDefinition* network = builder->createNetwork();
+	if( mOutputs.size() > TENSOR_RECORD_MAX_TENSORS )
+	{
+		printf(LOG_TRT "EnableRecording() -- the network has %zu outputs, only %u can be recorded\n", mOutputs.size(), TENSOR_RECORD_MAX_TENSORS);
+		return false;
+	}
 
-	builder->setDebugSync(mEnableDebug);
-	builder->setMinFindIterations(3);	// allow time for TX1 GPU to spin up
-	builder->setAverageFindIterations(2);
+	tensorRecorder* recorder = tensorRecorder::Open(path);
 
-	//mEnableFP16 = (mOverride16 == true) ? false : builder->platformHasFastFp16();
-	//printf(LOG_TRT "platform %s fast FP16 support\n", mEnableFP16 ? "has" : "does not have");
-	printf(LOG_TRT "device %s, loading %s %s\n", deviceTypeToStr(device), deployFile.c_str(), modelFile.c_str());
-	
+	if( !recorder )
+		return false;
 
-	// parse the different types of model formats
-	if( mModelType == MODEL_CAFFE )
+	DisableRecording();
+	mRecorder = recorder;
+
+	return true;
+}
+
+
+// DisableRecording
+void tensorNet::DisableRecording()
+{
+	if( mRecorder != NULL )
 	{
-		// parse the caffe model to populate the network, then set the outputs
-		nvcaffeparser1::ICaffeParser* parser = nvcaffeparser1::createCaffeParser();
+		delete mRecorder;
+		mRecorder = NULL;
+	}
+}
 
-		nvinfer1::DataType modelDataType = (precision == TYPE_FP16) ? nvinfer1::DataType::kHALF : nvinfer1::DataType::kFLOAT; // import INT8 weights as FP32
-		const nvcaffeparser1::IBlobNameToTensor* blobNameToTensor =
-			parser->parse(deployFile.c_str(),		// caffe deploy file
-						  modelFile.c_str(),	// caffe model file
-						 *network,			// network definition that the parser will populate
-						  modelDataType);
 
-		if( !blobNameToTensor )
+// ReplayOutputs
+bool tensorNet::ReplayOutputs( const tensorFrame& frame )
+{
+	if( frame.numTensors != mOutputs.size() || frame.batchSize == 0 || frame.batchSize > mMaxBatchSize )
+	{
+		printf(LOG_TRT "ReplayOutputs() -- the frame has %u outputs with batch size %u, but the network has %zu outputs with max batch size %u\n",
+			  frame.numTensors, frame.batchSize, mOutputs.size(), mMaxBatchSize);
+		return false;
+	}
+
+	for( uint32_t n=0; n < frame.numTensors; n++ )
+	{
+		const tensorRecord& tensor = frame.tensors[n];
+
+		if( tensor.dims[0] != DIMS_C(mOutputs[n].dims) || tensor.dims[1] != DIMS_H(mOutputs[n].dims) || tensor.dims[2] != DIMS_W(mOutputs[n].dims) )
 		{
-			printf(LOG_TRT "device %s, failed to parse caffe network\n", deviceTypeToStr(device));
+			printf(LOG_TRT "ReplayOutputs() -- recorded output '%s' has dims (c=%u h=%u w=%u), but output '%s' of the network has (c=%u h=%u w=%u)\n",
+				  tensor.name, tensor.dims[0], tensor.dims[1], tensor.dims[2], mOutputs[n].name.c_str(),
+				  DIMS_C(mOutputs[n].dims), DIMS_H(mOutputs[n].dims), DIMS_W(mOutputs[n].dims));
 			return false;
 		}
+	}
 
-		// the caffe file has no notion of outputs, so we need to manually say which tensors the engine should generate	
-		const size_t num_outputs = outputs.size();
-		
-		for( size_t n=0; n < num_outputs; n++ )
-		{
-			nvinfer1::ITensor* tensor = blobNameToTensor->find(outputs[n].c_str());
-		
-			if( !tensor )
-				printf(LOG_TRT "failed to retrieve tensor for Output \"%s\"\n", outputs[n].c_str());
-			else
-			{
-			#if NV_TENSORRT_MAJOR >= 4
-				nvinfer1::Dims3 dims = static_cast<nvinfer1::Dims3&&>(tensor->getDimensions());
-				printf(LOG_TRT "retrieved Output tensor \"%s\":  %ix%ix%i\n", tensor->getName(), dims.d[0], dims.d[1], dims.d[2]);
-			#endif
-			}
+	for( uint32_t n=0; n < frame.numTensors; n++ )
+		memcpy(mOutputs[n].CPU, frame.tensors[n].data, frame.batchSize * mOutputs[n].volume * sizeof(float));
 
-			network->markOutput(*tensor);
-		}
+	return true;
+}
 
-		//parser->destroy();
-	}
-#if NV_TENSORRT_MAJOR >= 5
-	else if( mModelType == MODEL_ONNX )
+
+// ProcessBindings
+bool tensorNet::ProcessBindings( uint32_t batchSize )
+{
+	if( !mContext || batchSize == 0 || batchSize > mMaxBatchSize )
 	{
-		nvonnxparser::IParser* parser = nvonnxparser::createParser(*network, gLogger);
+		printf(LOG_TRT "ProcessBindings() -- invalid batch size %u (the max batch size is %u)\n", batchSize, mMaxBatchSize);
+		return false;
+	}
 
-		if( !parser )
+	PROFILER_BEGIN(PROFILER_NETWORK);
+
+	if( !mStream )
+	{
+		if( !selectContext(batchSize)->execute(batchSize, mBindings.data()) )
 		{
-			printf(LOG_TRT "failed to create nvonnxparser::IParser instance\n");
+			printf(LOG_TRT "ProcessBindings() -- failed to execute TensorRT network\n");
 			return false;
 		}
+	}
+	else
+	{
+		const bool result = selectContext(batchSize)->enqueue(batchSize, mBindings.data(), mStream, NULL);
 
-		if( !parser->parseFromFile(modelFile.c_str(), (int)nvinfer1::ILogger::Severity::kWARNING) )
+		CUDA(cudaStreamSynchronize(mStream));
+
+		if( !result )
 		{
-			printf(LOG_TRT "failed to parse ONNX model '%s'\n", modelFile.c_str());
+			printf(LOG_TRT "ProcessBindings() -- failed to enqueue TensorRT network\n");
 			return false;
 		}
-
-		//parser->destroy();
 	}
-	else if( mModelType == MODEL_UFF )
-	{
-		// create parser instance
-		nvuffparser::IUffParser* parser = nvuffparser::createUffParser();
-		
+
+	convertOutputs(batchSize);
+
+	PROFILER_END(PROFILER_NETWORK);
+	return true;
+}
+
+
+// GetMemoryUsage
+size_t tensorNet::GetMemoryUsage() const
+{
+	size_t size = mEngineSize;
+
+	for( size_t n=0; n < mInputs.size(); n++ )
+		size += mInputs[n].size;
+
+	for( size_t n=0; n < mOutputs.size(); n++ )
+		size += mOutputs[n].size;
+
+#if NV_TENSORRT_MAJOR >= 5
+	if( mEngine != NULL )
+		size += mEngine->getDeviceMemorySize();
+#endif
+
+	// the smaller engines of the set each have their own weights and activation memory
+	for( size_t n=0; n < mEngineSet.size(); n++ )
+	{
+		size += mEngineSet[n].size;
+	#if NV_TENSORRT_MAJOR >= 5
+		size += mEngineSet[n].engine->getDeviceMemorySize();
+	#endif
+	}
+
+	return size;
+}
+
+
+// beginProfilerRecord
+bool tensorNet::beginProfilerRecord()
+{
+	// the previous request was issued, so it waits on the GPU to be collected
+	if( mProfilerRecord != NULL )
+	{
+		if( mProfilerRecord->ended != 0 )
+			mProfilerPending.push_back(mProfilerRecord);
+		else
+			mProfilerFree.push_back(mProfilerRecord);
+
+		mProfilerRecord = NULL;
+	}
+
+	collectProfilerRecords();
+
+	// when every record is still in flight, wait for the oldest one (it's many requests behind)
+	if( mProfilerFree.size() == 0 && mProfilerRecords.size() >= PROFILER_RECORDS_MAX && mProfilerPending.size() > 0 )
+	{
+		collectProfilerRecord(mProfilerPending.front(), true);
+		collectProfilerRecords();
+	}
+
+	profilerRecord* record = NULL;
+
+	if( mProfilerFree.size() > 0 )
+	{
+		record = mProfilerFree.back();
+		mProfilerFree.pop_back();
+	}
+	else
+	{
+		record = new profilerRecord;
+
+		for( int n=0; n < PROFILER_TOTAL * 2; n++ )
+		{
+			if( CUDA_FAILED(cudaEventCreate(&record->eventsGPU[n])) )
+			{
+				printf(LOG_TRT "failed to create the CUDA events of a profiling record\n");
+
+				for( int e=0; e < n; e++ )
+					CUDA(cudaEventDestroy(record->eventsGPU[e]));
+
+				delete record;
+				return false;
+			}
+		}
+
+		mProfilerRecords.push_back(record);
+	}
+
+	record->request   = mProfilerRequest++;
+	record->queries   = 0;
+	record->ended     = 0;
+	record->collected = 0;
+
+	memset(record->eventsCPU, 0, sizeof(record->eventsCPU));
+	memset(record->times, 0, sizeof(record->times));
+
+	mProfilerRecord = record;
+	return true;
+}
+
+
+// collectProfilerRecord
+bool tensorNet::collectProfilerRecord( profilerRecord* record, bool wait )
+{
+	for( uint32_t n=0; n < PROFILER_TOTAL; n++ )
+	{
+		const uint32_t flag = (1 << n);
+
+		if( !(record->ended & flag) || (record->collected & flag) )
+			continue;
+
+		const cudaEvent_t end = record->eventsGPU[n*2+1];
+
+		if( wait )
+			CUDA(cudaEventSynchronize(end));
+		else if( cudaEventQuery(end) == cudaErrorNotReady )
+			return false;
+
+		float cuda_time = 0.0f;
+		CUDA(cudaEventElapsedTime(&cuda_time, record->eventsGPU[n*2], end));
+
+		record->times[n].y = cuda_time;
+		record->collected |= flag;
+
+		mProfilerTimes[n].y = cuda_time;
+
+		// the CPU time is added here too, once the stage is done for the request
+		mProfilerHistograms[n][PROFILER_CPU].Add(record->times[n].x);
+		mProfilerHistograms[n][PROFILER_CUDA].Add(cuda_time);
+	}
+
+	return true;
+}
+
+
+// collectProfilerRecords
+void tensorNet::collectProfilerRecords( bool wait )
+{
+	// the requests complete on the GPU in order, so stop at the first one that's still running
+	while( mProfilerPending.size() > 0 )
+	{
+		profilerRecord* record = mProfilerPending.front();
+
+		if( !collectProfilerRecord(record, wait) )
+			return;
+
+		mProfilerPending.pop_front();
+
+		profilerResult result;
+		memset(&result, 0, sizeof(result));
+
+		result.request = record->request;
+		result.queries = record->ended;
+
+		for( uint32_t n=0; n < PROFILER_TOTAL; n++ )
+		{
+			if( !(record->ended & (1 << n)) )
+				continue;
+
+			if( result.timestamp.tv_sec == 0 && result.timestamp.tv_nsec == 0 )
+				result.timestamp = record->eventsCPU[n*2];
+
+			result.times[n] = record->times[n];
+			result.times[PROFILER_TOTAL].x += record->times[n].x;
+			result.times[PROFILER_TOTAL].y += record->times[n].y;
+		}
+
+		mProfilerResults.push_back(result);
+
+		if( mProfilerResults.size() > PROFILER_RESULTS_MAX )
+			mProfilerResults.pop_front();
+
+		mProfilerFree.push_back(record);
+	}
+
+	if( mProfilerRecord != NULL )
+		collectProfilerRecord(mProfilerRecord, wait);
+}
+
+
+// GetProfilerResults
+uint32_t tensorNet::GetProfilerResults( std::vector<profilerResult>& results )
+{
+	collectProfilerRecords();
+
+	const uint32_t count = mProfilerResults.size();
+
+	results.insert(results.end(), mProfilerResults.begin(), mProfilerResults.end());
+	mProfilerResults.clear();
+
+	return count;
+}
+
+
+// EnableProfiler
+void tensorNet::EnableLayerProfiler( bool print )
+{
+	mEnableProfiler = true;
+	gProfiler.print = print;
+
+	if( mContext != NULL )
+		mContext->setProfiler(&gProfiler);
+
+	for( size_t n=0; n < mEngineSet.size(); n++ )
+		mEngineSet[n].context->setProfiler(&gProfiler);
+}
+
+
+// EnableDebug
+void tensorNet::EnableDebug()
+{
+	mEnableDebug = true;
+}
+
+
+// capabilityCacheKey
+static std::string capabilityCacheKey()
+{
+	// the precisions depend on the TensorRT version and the GPU
+	char key[512];
+	cudaDeviceProp props;
+	int gpu = 0;
+
+	if( CUDA_FAILED(cudaGetDevice(&gpu)) || CUDA_FAILED(cudaGetDeviceProperties(&props, gpu)) )
+		return std::string();
+
+	sprintf(key, "TensorRT-%u.%u.%u/%s/sm%i%i", NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR, NV_TENSORRT_PATCH, props.name, props.major, props.minor);
+
+	for( char* c=key; *c != '\0'; c++ )
+	{
+		if( *c == ' ' )
+			*c = '_';
+	}
+
+	return key;
+}
+
+
+// loadCapabilityCache (called with gCapabilityMutex held)
+static void loadCapabilityCache()
+{
+	if( gCapabilityCacheLoaded || gCapabilityCachePath.size() == 0 )
+		return;
+
+	gCapabilityCacheLoaded = true;
+
+	FILE* file = fopen(gCapabilityCachePath.c_str(), "r");
+
+	if( !file )
+		return;
+
+	const std::string key = capabilityCacheKey();
+	char line[1024];
+
+	while( fgets(line, sizeof(line), file) != NULL )
+	{
+		// <key> <device> <precision>,<precision>,...
+		char lineKey[512];
+		char lineDevice[64];
+		char linePrecisions[256];
+
+		if( sscanf(line, "%511s %63s %255s", lineKey, lineDevice, linePrecisions) != 3 || key != lineKey )
+			continue;
+
+		int device = -1;
+
+		for( int n=0; n < NUM_DEVICES; n++ )
+		{
+			if( strcasecmp(lineDevice, deviceTypeToStr((deviceType)n)) == 0 )
+				device = n;
+		}
+
+		if( device < 0 )
+			continue;
+
+		gNativePrecisions[device].clear();
+
+		for( char* str = strtok(linePrecisions, ","); str != NULL; str = strtok(NULL, ",") )
+		{
+			const precisionType type = precisionTypeFromStr(str);
+
+			if( type != TYPE_DISABLED )
+				gNativePrecisions[device].push_back(type);
+		}
+
+		gNativePrecisionsCached[device] = (gNativePrecisions[device].size() > 0);
+	}
+
+	fclose(file);
+}
+
+
+// saveCapabilityCache (called with gCapabilityMutex held)
+static void saveCapabilityCache( deviceType device )
+{
+	if( gCapabilityCachePath.size() == 0 )
+		return;
+
+	const std::string key = capabilityCacheKey();
+
+	if( key.size() == 0 )
+		return;
+
+	// entries are appended, and the last matching one wins when loading
+	FILE* file = fopen(gCapabilityCachePath.c_str(), "a");
+
+	if( !file )
+	{
+		printf(LOG_TRT "failed to open capability cache %s for writing\n", gCapabilityCachePath.c_str());
+		return;
+	}
+
+	fprintf(file, "%s %s ", key.c_str(), deviceTypeToStr(device));
+
+	for( size_t n=0; n < gNativePrecisions[device].size(); n++ )
+		fprintf(file, "%s%s", (n > 0) ? "," : "", precisionTypeToStr(gNativePrecisions[device][n]));
+
+	fprintf(file, "\n");
+	fclose(file);
+}
+
+
+// SetCapabilityCache
+void tensorNet::SetCapabilityCache( const char* path )
+{
+	pthread_mutex_lock(&gCapabilityMutex);
+
+	gCapabilityCachePath   = (path != NULL) ? path : "";
+	gCapabilityCacheLoaded = false;
+
+	pthread_mutex_unlock(&gCapabilityMutex);
+}
+
+
+// SetAutoTuneOptions
+void tensorNet::SetAutoTuneOptions( float tolerance, uint32_t iterations )
+{
+	gAutoTuneTolerance  = tolerance;
+	gAutoTuneIterations = (iterations > 0) ? iterations : 1;
+}
+
+
+// SetBindingPrecision
+bool tensorNet::SetBindingPrecision( precisionType input, precisionType output )
+{
+	if( input != TYPE_FP32 && input != TYPE_FP16 && input != TYPE_INT8 )
+	{
+		printf(LOG_TRT "SetBindingPrecision() -- input bindings can't be %s (valid types are FP32, FP16 and INT8)\n", precisionTypeToStr(input));
+		return false;
+	}
+
+	if( output != TYPE_FP32 && output != TYPE_FP16 )
+	{
+		printf(LOG_TRT "SetBindingPrecision() -- output bindings can't be %s (valid types are FP32 and FP16)\n", precisionTypeToStr(output));
+		return false;
+	}
+
+#if NV_TENSORRT_MAJOR < 6
+	if( input != TYPE_FP32 || output != TYPE_FP32 )
+		printf(LOG_TRT "warning:  %s bindings require TensorRT 6 or newer, the bindings will stay FP32\n", precisionTypeToStr(input != TYPE_FP32 ? input : output));
+#endif
+
+	gBindingInputType  = input;
+	gBindingOutputType = output;
+
+	return true;
+}
+
+
+// SetEngineSet
+void tensorNet::SetEngineSet( const std::vector<uint32_t>& batchSizes )
+{
+	gEngineSet = batchSizes;
+}
+
+
+// bindingPrecision
+static void bindingPrecision( bool supported, precisionType precision, float inputRange, precisionType* input, precisionType* output )
+{
+#if NV_TENSORRT_MAJOR >= 6
+	*input  = supported ? gBindingInputType : TYPE_FP32;
+	*output = supported ? gBindingOutputType : TYPE_FP32;
+
+	// INT8 inputs are quantized over the range of the pre-processing, so it has to be known,
+	// and only INT8 engines take them -- FP16 engines take an FP16 input, and FP32 engines FP32
+	if( *input == TYPE_INT8 && (inputRange <= 0.0f || precision != TYPE_INT8) )
+		*input = (precision == TYPE_FP16) ? TYPE_FP16 : TYPE_FP32;
+#else
+	*input  = TYPE_FP32;
+	*output = TYPE_FP32;
+#endif
+}
+
+
+// bindingType
+static precisionType bindingType( nvinfer1::DataType type )
+{
+#if NV_TENSORRT_MAJOR > 1
+	if( type == nvinfer1::DataType::kHALF )
+		return TYPE_FP16;
+	else if( type == nvinfer1::DataType::kINT8 )
+		return TYPE_INT8;
+#endif
+	return TYPE_FP32;	// kINT32 outputs are also 4 bytes, and are read as-is
+}
+
+
+// bindingTypeSize
+static size_t bindingTypeSize( precisionType type )
+{
+	if( type == TYPE_FP16 )
+		return sizeof(uint16_t);
+	else if( type == TYPE_INT8 )
+		return sizeof(int8_t);
+
+	return sizeof(float);
+}
+
+
+// DetectNativePrecisions()
+std::vector<precisionType> tensorNet::DetectNativePrecisions( deviceType device )
+{
+	std::vector<precisionType> types;
+
+	if( device < 0 || device >= NUM_DEVICES )
+		return types;
+
+	// the builder is only created the first time each device is queried
+	pthread_mutex_lock(&gCapabilityMutex);
+	loadCapabilityCache();
+
+	if( gNativePrecisionsCached[device] )
+	{
+		types = gNativePrecisions[device];
+		pthread_mutex_unlock(&gCapabilityMutex);
+		return types;
+	}
+
+	Logger logger;
+
+	// create a temporary builder for querying the supported types
+	nvinfer1::IBuilder* builder = CREATE_INFER_BUILDER(logger);
+		
+	if( !builder )
+	{
+		pthread_mutex_unlock(&gCapabilityMutex);
+		printf(LOG_TRT "QueryNativePrecisions() failed to create TensorRT IBuilder instance\n");
+		return types;
+	}
+
+#if NV_TENSORRT_MAJOR >= 5
+	if( device == DEVICE_DLA_0 || device == DEVICE_DLA_1 )
+		builder->setFp16Mode(true);
+
+	builder->setDefaultDeviceType( deviceTypeToTRT(device) );
+#endif
+
+	// FP32 is supported on all platforms
+	types.push_back(TYPE_FP32);
+
+	// detect fast (native) FP16
+	if( builder->platformHasFastFp16() )
+		types.push_back(TYPE_FP16);
+
+#if NV_TENSORRT_MAJOR >= 4
+	// detect fast (native) INT8
+	if( builder->platformHasFastInt8() )
+		types.push_back(TYPE_INT8);
+#endif
+
+	// print out supported precisions (optional)
+	const uint32_t numTypes = types.size();
+
+	printf(LOG_TRT "native precisions detected for %s:  ", deviceTypeToStr(device));
+ 
+	for( uint32_t n=0; n < numTypes; n++ )
+	{
+		printf("%s", precisionTypeToStr(types[n]));
+
+		if( n < numTypes - 1 )
+			printf(", ");
+	}
+
+	printf("\n");
+	builder->destroy();
+
+	gNativePrecisions[device] = types;
+	gNativePrecisionsCached[device] = true;
+	saveCapabilityCache(device);
+
+	pthread_mutex_unlock(&gCapabilityMutex);
+	return types;
+}
+
+
+// DetectNativePrecision
+bool tensorNet::DetectNativePrecision( const std::vector<precisionType>& types, precisionType type )
+{
+	const uint32_t numTypes = types.size();
+
+	for( uint32_t n=0; n < numTypes; n++ )
+	{
+		if( types[n] == type )
+			return true;
+	}
+
+	return false;
+}
+
+
+// DetectNativePrecision
+bool tensorNet::DetectNativePrecision( precisionType precision, deviceType device )
+{
+	std::vector<precisionType> types = DetectNativePrecisions(device);
+	return DetectNativePrecision(types, precision);
+}
+
+
+// FindFastestPrecision
+precisionType tensorNet::FindFastestPrecision( deviceType device, bool allowInt8 )
+{
+	std::vector<precisionType> types = DetectNativePrecisions(device);
+
+	if( allowInt8 && DetectNativePrecision(types, TYPE_INT8) )
+		return TYPE_INT8;
+	else if( DetectNativePrecision(types, TYPE_FP16) )
+		return TYPE_FP16;
+	else
+		return TYPE_FP32;
+}
+
+
+// Create an optimized GIE network from caffe prototxt and model file
+bool tensorNet::ProfileModel(const std::string& deployFile,			   // name for caffe prototxt
+					    const std::string& modelFile,			   // name for model 
+					    const std::vector<std::string>& inputs,	   // network inputs
+					    const std::vector<Dims3>& inputDims,	   // dims of the inputs (for UFF)
+					    const std::vector<std::string>& outputs,    // network outputs
+					    unsigned int maxBatchSize,			   // batch size - NB must be at least as large as the batch we want to run with
+					    precisionType precision, 
+					    deviceType device, bool allowGPUFallback,
+					    nvinfer1::IInt8Calibrator* calibrator, 	
+					    std::ostream& gieModelStream)			   // output stream for the GIE model
+{
+	// create API root class - must span the lifetime of the engine usage
+	nvinfer1::IBuilder* builder = CREATE_INFER_BUILDER(gLogger);
+	nvinfer1::INetworkDefinition* network = builder->createNetwork();
+
+	builder->setDebugSync(mEnableDebug);
+	builder->setMinFindIterations(3);	// allow time for TX1 GPU to spin up
+	builder->setAverageFindIterations(2);
+
+	//mEnableFP16 = (mOverride16 == true) ? false : builder->platformHasFastFp16();
+	//printf(LOG_TRT "platform %s fast FP16 support\n", mEnableFP16 ? "has" : "does not have");
+	printf(LOG_TRT "device %s, loading %s %s\n", deviceTypeToStr(device), deployFile.c_str(), modelFile.c_str());
+	
+	timespec stage = timestamp();
+
+	// parse the different types of model formats
+	if( mModelType == MODEL_CAFFE )
+	{
+		// parse the caffe model to populate the network, then set the outputs
+		nvcaffeparser1::ICaffeParser* parser = nvcaffeparser1::createCaffeParser();
+
+		nvinfer1::DataType modelDataType = (precision == TYPE_FP16) ? nvinfer1::DataType::kHALF : nvinfer1::DataType::kFLOAT; // import INT8 weights as FP32
+		const nvcaffeparser1::IBlobNameToTensor* blobNameToTensor =
+			parser->parse(deployFile.c_str(),		// caffe deploy file
+						  modelFile.c_str(),	// caffe model file
+						 *network,			// network definition that the parser will populate
+						  modelDataType);
+
+		if( !blobNameToTensor )
+		{
+			printf(LOG_TRT "device %s, failed to parse caffe network\n", deviceTypeToStr(device));
+			return false;
+		}
+
+		// the caffe file has no notion of outputs, so we need to manually say which tensors the engine should generate	
+		const size_t num_outputs = outputs.size();
+		
+		for( size_t n=0; n < num_outputs; n++ )
+		{
+			nvinfer1::ITensor* tensor = blobNameToTensor->find(outputs[n].c_str());
+		
+			if( !tensor )
+				printf(LOG_TRT "failed to retrieve tensor for Output \"%s\"\n", outputs[n].c_str());
+			else
+			{
+			#if NV_TENSORRT_MAJOR >= 4
+				nvinfer1::Dims3 dims = static_cast<nvinfer1::Dims3&&>(tensor->getDimensions());
+				printf(LOG_TRT "retrieved Output tensor \"%s\":  %ix%ix%i\n", tensor->getName(), dims.d[0], dims.d[1], dims.d[2]);
+			#endif
+			}
+
+			network->markOutput(*tensor);
+		}
+
+		//parser->destroy();
+	}
+#if NV_TENSORRT_MAJOR >= 5
+	else if( mModelType == MODEL_ONNX )
+	{
+		nvonnxparser::IParser* parser = nvonnxparser::createParser(*network, gLogger);
+
+		if( !parser )
+		{
+			printf(LOG_TRT "failed to create nvonnxparser::IParser instance\n");
+			return false;
+		}
+
+		if( !parser->parseFromFile(modelFile.c_str(), (int)nvinfer1::ILogger::Severity::kWARNING) )
+		{
+			printf(LOG_TRT "failed to parse ONNX model '%s'\n", modelFile.c_str());
+			return false;
+		}
+
+		//parser->destroy();
+	}
+	else if( mModelType == MODEL_UFF )
+	{
+		// create parser instance
+		nvuffparser::IUffParser* parser = nvuffparser::createUffParser();
+		
 		if( !parser )
 		{
-			printf(LOG_TRT "failed to create UFF parser\n");
+			printf(LOG_TRT "failed to create UFF parser\n");
+			return false;
+		}
+		
+		// register inputs
+		for( size_t n=0; n < inputs.size(); n++ )
+		{
+			if( !parser->registerInput(inputs[n].c_str(), inputDims[n], nvuffparser::UffInputOrder::kNCHW) )
+			{
+				printf(LOG_TRT "failed to register input '%s' for UFF model '%s'\n", inputs[n].c_str(), modelFile.c_str());
+				return false;
+			}
+		}
+		
+		// register outputs
+		/*const size_t numOutputs = outputs.size();
+		
+		for( uint32_t n=0; n < numOutputs; n++ )
+		{
+			if( !parser->registerOutput(outputs[n].c_str()) )
+				printf(LOG_TRT "failed to register output '%s' for UFF model '%s'\n", outputs[n].c_str(), modelFile.c_str());
+		}*/
+
+		if( !parser->registerOutput("MarkOutput_0") )
+			printf(LOG_TRT "failed to register output '%s' for UFF model '%s'\n", "MarkOutput_0", modelFile.c_str());
+
+		
+		// parse network
+		if( !parser->parse(modelFile.c_str(), *network, nvinfer1::DataType::kFLOAT) )
+		{
+			printf(LOG_TRT "failed to parse UFF model '%s'\n", modelFile.c_str());
+			return false;
+		}
+		
+		//parser->destroy();
+	}
+#endif
+
+	
+#if NV_TENSORRT_MAJOR >= 4
+	// extract the dimensions of the network input blobs
+	std::map<std::string, nvinfer1::Dims3> inputDimensions;
+
+	for( int i=0, n=network->getNbInputs(); i < n; i++ )
+	{
+		nvinfer1::Dims3 dims = static_cast<nvinfer1::Dims3&&>(network->getInput(i)->getDimensions());
+		inputDimensions.insert(std::make_pair(network->getInput(i)->getName(), dims));
+		std::cout << LOG_TRT << "retrieved Input tensor \"" << network->getInput(i)->getName() << "\":  " << dims.d[0] << "x" << dims.d[1] << "x" << dims.d[2] << std::endl;
+	}
+#endif
+
+
+	// set the data types of the bindings, so the engine doesn't reformat them
+	precisionType inputType  = TYPE_FP32;
+	precisionType outputType = TYPE_FP32;
+
+	bindingPrecision(mBindingPrecisionSupported, precision, inputRange(), &inputType, &outputType);
+
+#if NV_TENSORRT_MAJOR >= 6
+	if( inputType != TYPE_FP32 )
+	{
+		for( int i=0, n=network->getNbInputs(); i < n; i++ )
+		{
+			nvinfer1::ITensor* tensor = network->getInput(i);
+
+			tensor->setType((inputType == TYPE_FP16) ? nvinfer1::DataType::kHALF : nvinfer1::DataType::kINT8);
+			tensor->setAllowedFormats(1U << (int)nvinfer1::TensorFormat::kLINEAR);
+
+			// INT8 is symmetric, so the range of the pre-processing is mapped to [-127, 127]
+			if( inputType == TYPE_INT8 )
+				tensor->setDynamicRange(-inputRange(), inputRange());
+
+			printf(LOG_TRT "device %s, input binding %s is %s\n", deviceTypeToStr(device), tensor->getName(), precisionTypeToStr(inputType));
+		}
+	}
+
+	if( outputType != TYPE_FP32 )
+	{
+		for( int i=0, n=network->getNbOutputs(); i < n; i++ )
+		{
+			nvinfer1::ITensor* tensor = network->getOutput(i);
+
+			if( tensor->getType() != nvinfer1::DataType::kFLOAT )
+				continue;	// leave integer outputs (i.e. counts) alone
+
+			tensor->setType(nvinfer1::DataType::kHALF);
+			tensor->setAllowedFormats(1U << (int)nvinfer1::TensorFormat::kLINEAR);
+
+			printf(LOG_TRT "device %s, output binding %s is %s\n", deviceTypeToStr(device), tensor->getName(), precisionTypeToStr(outputType));
+		}
+	}
+#endif
+
+
+	mLoadReport.parse = loadStageTime(&stage);
+
+	// build the engine
+	printf(LOG_TRT "device %s, configuring CUDA engine\n", deviceTypeToStr(device));
+		
+	builder->setMaxBatchSize(maxBatchSize);
+	builder->setMaxWorkspaceSize(16 << 20);
+
+
+	// set up the builder for the desired precision
+	if( precision == TYPE_INT8 )
+	{
+	#if NV_TENSORRT_MAJOR >= 4
+		builder->setInt8Mode(true);
+		//builder->setFp16Mode(true);		// TODO:  experiment for benefits of both INT8/FP16
+		
+		if( !calibrator )
+		{
+			calibrator = new randInt8Calibrator(1, mCacheCalibrationPath, inputDimensions);
+			printf(LOG_TRT "warning:  device %s using INT8 precision with RANDOM calibration\n", deviceTypeToStr(device));
+		}
+
+		builder->setInt8Calibrator(calibrator);
+	#else
+		printf(LOG_TRT "INT8 precision requested, and TensorRT %u.%u doesn't meet minimum version for INT8\n", NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR);
+		printf(LOG_TRT "please use minumum version of TensorRT 4.0 or newer for INT8 support\n");
+
+		return false;
+	#endif
+	}
+	else if( precision == TYPE_FP16 )
+	{
+	#if NV_TENSORRT_MAJOR < 4
+		builder->setHalf2Mode(true);
+	#else
+		builder->setFp16Mode(true);
+	#endif
+	}
+	
+
+	// set the default device type
+#if NV_TENSORRT_MAJOR >= 5
+	builder->setDefaultDeviceType(deviceTypeToTRT(device));
+
+	if( allowGPUFallback )
+		builder->allowGPUFallback(true);
+	
+#if !(NV_TENSORRT_MAJOR == 5 && NV_TENSORRT_MINOR == 0 && NV_TENSORRT_PATCH == 0)
+	if( device == DEVICE_DLA_0 )
+		builder->setDLACore(0);
+	else if( device == DEVICE_DLA_1 )
+		builder->setDLACore(1);
+#endif
+#else
+	if( device != DEVICE_GPU )
+	{
+		printf(LOG_TRT "device %s is not supported in TensorRT %u.%u\n", deviceTypeToStr(device), NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR);
+		return false;
+	}
+#endif
+
+	// record which layers run on the DLA, and which of them fall back to the GPU
+	mLayerPlacement.clear();
+	mLayerTransitions = 0;
+
+#if NV_TENSORRT_MAJOR >= 5
+	if( device == DEVICE_DLA_0 || device == DEVICE_DLA_1 )
+	{
+		std::map<std::string, bool> tensorDLA;	// device of the layer that produces each tensor
+
+		for( int i=0, n=network->getNbLayers(); i < n; i++ )
+		{
+			nvinfer1::ILayer* layer = network->getLayer(i);
+
+			layerPlacement placement;
+
+			placement.name = layer->getName();
+			placement.dla  = (builder->getDeviceType(layer) != nvinfer1::DeviceType::kGPU) && builder->canRunOnDLA(layer);
+
+			// a tensor that's produced on one device and consumed on the other is a transition
+			for( int j=0, m=layer->getNbInputs(); j < m; j++ )
+			{
+				nvinfer1::ITensor* tensor = layer->getInput(j);
+
+				if( !tensor )
+					continue;
+
+				std::map<std::string, bool>::const_iterator producer = tensorDLA.find(tensor->getName());
+
+				if( producer != tensorDLA.end() && producer->second != placement.dla )
+					mLayerTransitions++;
+			}
+
+			for( int j=0, m=layer->getNbOutputs(); j < m; j++ )
+				tensorDLA[layer->getOutput(j)->getName()] = placement.dla;
+
+			mLayerPlacement.push_back(placement);
+		}
+
+		printf(LOG_TRT "device %s, %u layers on DLA, %u layers on GPU, %u DLA/GPU transitions\n", deviceTypeToStr(device),
+			  placementReport::Count(mLayerPlacement, true), placementReport::Count(mLayerPlacement, false), mLayerTransitions);
+	}
+#endif
+
+	// build CUDA engine
+	printf(LOG_TRT "device %s, building FP16:  %s\n", deviceTypeToStr(device), isFp16Enabled(builder) ? "ON" : "OFF"); 
+	printf(LOG_TRT "device %s, building INT8:  %s\n", deviceTypeToStr(device), isInt8Enabled(builder) ? "ON" : "OFF"); 
+	printf(LOG_TRT "device %s, building CUDA engine (this may take a few minutes the first time a network is loaded)\n", deviceTypeToStr(device));
+
+	nvinfer1::ICudaEngine* engine = builder->buildCudaEngine(*network);
+	
+	if( !engine )
+	{
+		printf(LOG_TRT "device %s, failed to build CUDA engine\n", deviceTypeToStr(device));
+		return false;
+	}
+
+	printf(LOG_TRT "device %s, completed building CUDA engine\n", deviceTypeToStr(device));
+	mLoadReport.build = loadStageTime(&stage);
+
+	// we don't need the network definition any more, and we can destroy the parser
+	network->destroy();
+	//parser->destroy();
+
+	// serialize the engine, then close everything down
+#if NV_TENSORRT_MAJOR > 1
+	nvinfer1::IHostMemory* serMem = engine->serialize();
+
+	if( !serMem )
+	{
+		printf(LOG_TRT "device %s, failed to serialize CUDA engine\n", deviceTypeToStr(device));
+		return false;
+	}
+
+	gieModelStream.write((const char*)serMem->data(), serMem->size());
+#else
+	engine->serialize(gieModelStream);
+#endif
+
+	engine->destroy();
+	builder->destroy();
+
+	mLoadReport.serialize = loadStageTime(&stage);
+	return true;
+}
+
+
+// LoadNetwork
+bool tensorNet::LoadNetwork( const char* prototxt_path, const char* model_path, const char* mean_path, 
+					    const char* input_blob, const char* output_blob, uint32_t maxBatchSize,
+					    precisionType precision, deviceType device, bool allowGPUFallback,
+					    nvinfer1::IInt8Calibrator* calibrator, cudaStream_t stream )
+{
+	std::vector<std::string> outputs;
+	outputs.push_back(output_blob);
+	
+	return LoadNetwork(prototxt_path, model_path, mean_path, input_blob, outputs, maxBatchSize, precision, device, allowGPUFallback );
+}
+
+
+// LoadNetwork
+bool tensorNet::LoadNetwork( const char* prototxt_path_, const char* model_path_, const char* mean_path, 
+					    const char* input_blob, const std::vector<std::string>& output_blobs, 
+					    uint32_t maxBatchSize, precisionType precision,
+				   	    deviceType device, bool allowGPUFallback,
+					    nvinfer1::IInt8Calibrator* calibrator, cudaStream_t stream )
+{
+	return LoadNetwork(prototxt_path_, model_path_, mean_path,
+					   input_blob, Dims3(1,1,1), output_blobs,
+					   maxBatchSize, precision, device,
+					   allowGPUFallback, calibrator, stream);
+}
+
+					   
+// LoadNetwork
+bool tensorNet::LoadNetwork( const char* prototxt_path_, const char* model_path_, const char* mean_path, 
+					    const char* input_blob, const Dims3& input_dims,
+					    const std::vector<std::string>& output_blobs, 
+					    uint32_t maxBatchSize, precisionType precision,
+				   	    deviceType device, bool allowGPUFallback,
+					    nvinfer1::IInt8Calibrator* calibrator, cudaStream_t stream )
+{
+	std::vector<std::string> inputs;
+	std::vector<Dims3> inputDims;
+
+	inputs.push_back(input_blob);
+	inputDims.push_back(input_dims);
+
+	return LoadNetwork(prototxt_path_, model_path_, mean_path,
+					   inputs, inputDims, output_blobs,
+					   maxBatchSize, precision, device,
+					   allowGPUFallback, calibrator, stream);
+}
+
+
+// LoadNetwork
+bool tensorNet::LoadNetwork( const char* prototxt_path_, const char* model_path_, const char* mean_path, 
+					    const std::vector<std::string>& input_blobs, const std::vector<Dims3>& input_dims,
+					    const std::vector<std::string>& output_blobs, 
+					    uint32_t maxBatchSize, precisionType precision,
+				   	    deviceType device, bool allowGPUFallback,
+					    nvinfer1::IInt8Calibrator* calibrator, cudaStream_t stream )
+{
+	if( input_blobs.size() == 0 || input_blobs.size() != input_dims.size() )
+	{
+		printf(LOG_TRT "LoadNetwork() -- %zu input blobs were specified with %zu dims\n", input_blobs.size(), input_dims.size());
+		return false;
+	}
+
+	if( /*!prototxt_path_ ||*/ !model_path_ )
+		return false;
+
+	memset(&mLoadReport, 0, sizeof(mLoadReport));
+
+	const timespec loadBegin = timestamp();
+	timespec stage = loadBegin;
+
+#if NV_TENSORRT_MAJOR >= 4
+	printf(LOG_TRT "TensorRT version %u.%u.%u\n", NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR, NV_TENSORRT_PATCH);
+#else
+	printf(LOG_TRT "TensorRT version %u.%u\n", NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR);
+#endif
+
+	/*
+	 * load NV inference plugins
+	 */
+#if NV_TENSORRT_MAJOR > 4
+	static bool loadedPlugins = false;
+
+	if( !loadedPlugins )
+	{
+		printf(LOG_TRT "loading NVIDIA plugins...\n");
+
+		loadedPlugins = initLibNvInferPlugins(&gLogger, "");
+
+		if( !loadedPlugins )
+			printf(LOG_TRT "failed to load NVIDIA plugins\n");
+		else
+			printf(LOG_TRT "completed loading NVIDIA plugins.\n");
+	}
+#endif
+
+	mLoadReport.plugins = loadStageTime(&stage);
+
+	/*
+	 * verify the prototxt and model paths
+	 */
+	const std::string model_path    = locateFile(model_path_);
+	const std::string prototxt_path = locateFile(prototxt_path_ != NULL ? prototxt_path_ : "");
+	
+	const std::string model_ext = fileExtension(model_path_);
+	const modelType   model_fmt = modelTypeFromStr(model_ext.c_str());
+
+	printf(LOG_TRT "detected model format - %s  (extension '.%s')\n", modelTypeToStr(model_fmt), model_ext.c_str());
+
+	if( model_fmt == MODEL_CUSTOM )
+	{
+		printf(LOG_TRT "model format '%s' not supported by jetson-inference\n", modelTypeToStr(model_fmt));
+		return false;
+	}
+#if NV_TENSORRT_MAJOR < 5
+	else if( model_fmt == MODEL_ONNX )
+	{
+		printf(LOG_TRT "importing ONNX models is not supported in TensorRT %u.%u (version >= 5.0 required)\n", NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR);
+		return false;
+	}
+	else if( model_fmt == MODEL_UFF )
+	{
+		printf(LOG_TRT "importing UFF models is not supported in TensorRT %u.%u (version >= 5.0 required)\n", NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR);
+		return false;
+	}
+#endif
+	else if( model_fmt == MODEL_CAFFE && !prototxt_path_ )
+	{
+		printf(LOG_TRT "attempted to load caffe model without specifying prototxt file\n");
+		return false;
+	}
+
+	mModelType = model_fmt;
+	mLoadReport.locate = loadStageTime(&stage);
+
+
+	/*
+	 * if the precision is left unspecified, detect the fastest
+	 */
+	printf(LOG_TRT "desired precision specified for %s: %s\n", deviceTypeToStr(device), precisionTypeToStr(precision));
+
+	pthread_mutex_lock(&gCapabilityMutex);
+	loadCapabilityCache();
+	mLoadReport.capabilityCached = gNativePrecisionsCached[device];
+	pthread_mutex_unlock(&gCapabilityMutex);
+
+	if( precision == TYPE_DISABLED )
+	{
+		printf(LOG_TRT "skipping network specified with precision TYPE_DISABLE\n");
+		printf(LOG_TRT "please specify a valid precision to create the network\n");
+
+		return false;
+	}
+	else if( precision == TYPE_AUTOTUNE )
+	{
+		if( !autoTune(prototxt_path_, model_path_, mean_path, input_blobs, input_dims, output_blobs,
+				    maxBatchSize, calibrator, &precision, &device, &allowGPUFallback) )
+		{
+			printf(LOG_TRT "failed to auto-tune the precision and device of %s\n", model_path_);
+			return false;
+		}
+
+		mLoadReport.autotune = loadStageTime(&stage);
+		printf(LOG_TRT "auto-tuning selected %s on device %s\n", precisionTypeToStr(precision), deviceTypeToStr(device));
+	}
+	else if( precision == TYPE_FASTEST )
+	{
+		if( !calibrator )
+			printf(LOG_TRT "requested fasted precision for device %s without providing valid calibrator, disabling INT8\n", deviceTypeToStr(device));
+
+		precision = FindFastestPrecision(device, (calibrator != NULL));
+		printf(LOG_TRT "selecting fastest native precision for %s:  %s\n", deviceTypeToStr(device), precisionTypeToStr(precision));
+	}
+	else
+	{
+		if( !DetectNativePrecision(precision, device) )
+		{
+			printf(LOG_TRT "precision %s is not supported for device %s\n", precisionTypeToStr(precision), deviceTypeToStr(device));
+			return false;
+		}
+
+		if( precision == TYPE_INT8 && !calibrator )
+			printf(LOG_TRT "warning:  device %s using INT8 precision with RANDOM calibration\n", deviceTypeToStr(device));
+	}
+
+
+	mLoadReport.precision = loadStageTime(&stage);
+
+
+	/*
+	 * attempt to load network from cache before profiling with tensorRT
+	 */
+	std::stringstream gieModelStream;
+	gieModelStream.seekg(0, gieModelStream.beg);
+
+	char cache_prefix[512];
+	char cache_path[512];
+
+	sprintf(cache_prefix, "%s.%u.%u.%s.%s", model_path.c_str(), maxBatchSize, (uint32_t)allowGPUFallback, deviceTypeToStr(device), precisionTypeToStr(precision));
+
+	// engines with FP16/INT8 bindings are cached separately from those with FP32 bindings
+	precisionType inputType  = TYPE_FP32;
+	precisionType outputType = TYPE_FP32;
+
+	bindingPrecision(mBindingPrecisionSupported, precision, inputRange(), &inputType, &outputType);
+
+	if( inputType != TYPE_FP32 || outputType != TYPE_FP32 )
+		sprintf(cache_prefix + strlen(cache_prefix), ".io-%s-%s", precisionTypeToStr(inputType), precisionTypeToStr(outputType));
+
+	// the dynamic range of an INT8 input is part of the engine
+	if( inputType == TYPE_INT8 )
+		sprintf(cache_prefix + strlen(cache_prefix), "-%g", inputRange());
+#if NV_TENSORRT_MAJOR >= 6
+	else if( mBindingPrecisionSupported && gBindingInputType == TYPE_INT8 && precision != TYPE_INT8 )
+		printf(LOG_TRT "the %s engine of %s uses an %s input binding, as INT8 inputs are only used by INT8 engines\n", precisionTypeToStr(precision), model_path.c_str(), precisionTypeToStr(inputType));
+	else if( mBindingPrecisionSupported && gBindingInputType == TYPE_INT8 )
+		printf(LOG_TRT "warning:  the input range of %s isn't known, so its input binding stays FP32 instead of INT8\n", model_path.c_str());
+#endif
+	sprintf(cache_path, "%s.calibration", cache_prefix);
+	mCacheCalibrationPath = cache_path;
+	
+	sprintf(cache_path, "%s.engine", cache_prefix);
+	mCacheEnginePath = cache_path;	
+	printf(LOG_TRT "attempting to open engine cache file %s\n", mCacheEnginePath.c_str());
+	
+	std::ifstream cache( mCacheEnginePath );
+
+	if( !cache )
+	{
+		printf(LOG_TRT "cache file not found, profiling network model on device %s\n", deviceTypeToStr(device));
+		gMetricsCacheMisses->Increment();
+	
+		if( model_path.size() == 0 )
+		{
+			printf("\nerror:  model file '%s' was not found.\n", model_path_);
+			printf("%s\n", LOG_DOWNLOADER_TOOL);
+			return 0;
+		}
+
+		mLoadReport.cacheRead = loadStageTime(&stage);
+
+		if( !ProfileModel(prototxt_path, model_path, input_blobs, input_dims,
+						 output_blobs, maxBatchSize, precision, device, 
+						 allowGPUFallback, calibrator, gieModelStream) )
+		{
+			printf(LOG_TRT "device %s, failed to load %s\n", deviceTypeToStr(device), model_path_);
+			return 0;
+		}
+	
+		stage = timestamp();	// ProfileModel() records the parse, build and serialize times
+		printf(LOG_TRT "network profiling complete, writing engine cache to %s\n", mCacheEnginePath.c_str());
+		std::ofstream outFile;
+		outFile.open(mCacheEnginePath);
+		outFile << gieModelStream.rdbuf();
+		outFile.close();
+		gieModelStream.seekg(0, gieModelStream.beg);
+		printf(LOG_TRT "device %s, completed writing engine cache to %s\n", deviceTypeToStr(device), mCacheEnginePath.c_str());
+
+		if( mLayerPlacement.size() > 0 )
+			placementReport::Save(cacheSidecarPath(".placement").c_str(), capabilityCacheKey().c_str(), mLayerPlacement, mLayerTransitions);
+
+		mLoadReport.cacheWrite = loadStageTime(&stage);
+	}
+	else
+	{
+		printf(LOG_TRT "loading network profile from engine cache... %s\n", mCacheEnginePath.c_str());
+		gMetricsCacheHits->Increment();
+		gieModelStream << cache.rdbuf();
+		cache.close();
+
+		// the layer placement was saved when the engine was built
+		if( device == DEVICE_DLA_0 || device == DEVICE_DLA_1 )
+			placementReport::Load(cacheSidecarPath(".placement").c_str(), capabilityCacheKey().c_str(), mLayerPlacement, &mLayerTransitions);
+
+		mLoadReport.cacheRead = loadStageTime(&stage);
+		mLoadReport.cacheHit  = true;
+
+		// test for half FP16 support
+		/*nvinfer1::IBuilder* builder = CREATE_INFER_BUILDER(gLogger);
+		
+		if( builder != NULL )
+		{
+			mEnableFP16 = !mOverride16 && builder->platformHasFastFp16();
+			printf(LOG_TRT "platform %s fast FP16 support\n", mEnableFP16 ? "has" : "does not have");
+			builder->destroy();	
+		}*/
+	}
+
+	printf(LOG_TRT "device %s, %s loaded\n", deviceTypeToStr(device), model_path.c_str());
+	
+
+	/*
+	 * create runtime inference engine execution context
+	 */
+	nvinfer1::IRuntime* infer = CREATE_INFER_RUNTIME(gLogger);
+	
+	if( !infer )
+	{
+		printf(LOG_TRT "device %s, failed to create InferRuntime\n", deviceTypeToStr(device));
+		return 0;
+	}
+
+#if NV_TENSORRT_MAJOR >= 5 
+#if !(NV_TENSORRT_MAJOR == 5 && NV_TENSORRT_MINOR == 0 && NV_TENSORRT_PATCH == 0)
+	// if using DLA, set the desired core before deserialization occurs
+	if( device == DEVICE_DLA_0 )
+	{
+		printf(LOG_TRT "device %s, enabling DLA core 0\n", deviceTypeToStr(device));
+		infer->setDLACore(0);
+	}
+	else if( device == DEVICE_DLA_1 )
+	{
+		printf(LOG_TRT "device %s, enabling DLA core 1\n", deviceTypeToStr(device));
+		infer->setDLACore(1);
+	}
+#endif
+#endif
+
+#if NV_TENSORRT_MAJOR > 1
+	// support for stringstream deserialization was deprecated in TensorRT v2
+	// instead, read the stringstream into a memory buffer and pass that to TRT.
+	gieModelStream.seekg(0, std::ios::end);
+	const int modelSize = gieModelStream.tellg();
+	gieModelStream.seekg(0, std::ios::beg);
+
+	void* modelMem = malloc(modelSize);
+
+	if( !modelMem )
+	{
+		printf(LOG_TRT "failed to allocate %i bytes to deserialize model\n", modelSize);
+		return 0;
+	}
+
+	gieModelStream.read((char*)modelMem, modelSize);
+	nvinfer1::ICudaEngine* engine = infer->deserializeCudaEngine(modelMem, modelSize, NULL);
+	free(modelMem);
+	mEngineSize = modelSize;
+#else
+	// TensorRT v1 can deserialize directly from stringstream
+	nvinfer1::ICudaEngine* engine = infer->deserializeCudaEngine(gieModelStream);
+#endif
+
+	if( !engine )
+	{
+		printf(LOG_TRT "device %s, failed to create CUDA engine\n", deviceTypeToStr(device));
+		return 0;
+	}
+	
+	mLoadReport.deserialize = loadStageTime(&stage);
+
+	nvinfer1::IExecutionContext* context = engine->createExecutionContext();
+	
+	if( !context )
+	{
+		printf(LOG_TRT "device %s, failed to create execution context\n", deviceTypeToStr(device));
+		return 0;
+	}
+
+	if( mEnableDebug )
+	{
+		printf(LOG_TRT "device %s, enabling context debug sync.\n", deviceTypeToStr(device));
+		context->setDebugSync(true);
+	}
+
+	if( mEnableProfiler )
+		context->setProfiler(&gProfiler);
+
+	printf(LOG_TRT "device %s, CUDA engine context initialized with %u bindings\n", deviceTypeToStr(device), engine->getNbBindings());
+	
+	mInfer   = infer;
+	mEngine  = engine;
+	mContext = context;
+	
+	SetStream(stream);	// set default device stream
+
+	mLoadReport.context = loadStageTime(&stage);
+
+
+#if NV_TENSORRT_MAJOR >= 4
+	/*
+	 * print out binding info
+	 */
+	const int numBindings = engine->getNbBindings();
+	
+	for( int n=0; n < numBindings; n++ )
+	{
+		printf(LOG_TRT "binding -- index   %i\n", n);
+
+		const char* bind_name = engine->getBindingName(n);
+
+		printf("               -- name    '%s'\n", bind_name);
+		printf("               -- type    %s\n", dataTypeToStr(engine->getBindingDataType(n)));
+		printf("               -- in/out  %s\n", engine->bindingIsInput(n) ? "INPUT" : "OUTPUT");
+
+		const nvinfer1::Dims bind_dims = engine->getBindingDimensions(n);
+
+		printf("               -- # dims  %i\n", bind_dims.nbDims);
+		
+		for( int i=0; i < bind_dims.nbDims; i++ )
+			printf("               -- dim #%i  %i (%s)\n", i, bind_dims.d[i], dimensionTypeToStr(bind_dims.type[i]));
+	}
+#endif
+
+	/*
+	 * setup network input buffers
+	 */
+	const int numInputs = input_blobs.size();
+
+	for( int n=0; n < numInputs; n++ )
+	{
+		const int inputIndex = engine->getBindingIndex(input_blobs[n].c_str());
+		printf(LOG_TRT "binding to input %i %s  binding index:  %i\n", n, input_blobs[n].c_str(), inputIndex);
+
+		if( inputIndex < 0 )
+		{
+			printf(LOG_TRT "failed to find input %s in the network\n", input_blobs[n].c_str());
 			return false;
 		}
-		
-		// register input
-		if( !parser->registerInput(input, inputDims, nvuffparser::UffInputOrder::kNCHW) )
+
+	#if NV_TENSORRT_MAJOR > 1
+		nvinfer1::Dims inputDims = validateDims(engine->getBindingDimensions(inputIndex));
+	#else
+		Dims3 inputDims = engine->getBindingDimensions(inputIndex);
+	#endif
+
+	#if NV_TENSORRT_MAJOR > 1
+		const precisionType inputType = bindingType(engine->getBindingDataType(inputIndex));
+	#else
+		const precisionType inputType = TYPE_FP32;
+	#endif
+
+		const size_t inputVolume = DIMS_C(inputDims) * DIMS_H(inputDims) * DIMS_W(inputDims);
+		const size_t inputSize   = maxBatchSize * inputVolume * bindingTypeSize(inputType);
+
+		printf(LOG_TRT "binding to input %i %s  dims (b=%u c=%u h=%u w=%u) type=%s size=%zu\n", n, input_blobs[n].c_str(), maxBatchSize, DIMS_C(inputDims), DIMS_H(inputDims), DIMS_W(inputDims), precisionTypeToStr(inputType), inputSize);
+
+		// allocate input memory
+		void* inputCPU  = NULL;
+		void* inputCUDA = NULL;
+
+		if( !cudaAllocMapped((void**)&inputCPU, (void**)&inputCUDA, inputSize) )
 		{
-			printf(LOG_TRT "failed to register input '%s' for UFF model '%s'\n", input, modelFile.c_str());
+			printf(LOG_TRT "failed to alloc CUDA mapped memory for tensor input, %zu bytes\n", inputSize);
 			return false;
 		}
-		
-		// register outputs
-		/*const size_t numOutputs = outputs.size();
-		
-		for( uint32_t n=0; n < numOutputs; n++ )
+
+		layerBinding l;
+
+		l.CPU     = (float*)inputCPU;
+		l.CUDA    = (float*)inputCUDA;
+		l.mapped  = inputCPU;
+		l.size    = inputSize;
+		l.volume  = inputVolume;
+		l.type    = inputType;
+		l.binding = NULL;
+		l.index   = inputIndex;
+
+	#if NV_TENSORRT_MAJOR > 1
+		DIMS_W(l.dims) = DIMS_W(inputDims);
+		DIMS_H(l.dims) = DIMS_H(inputDims);
+		DIMS_C(l.dims) = DIMS_C(inputDims);
+	#else
+		l.dims = inputDims;
+	#endif
+
+		l.name = input_blobs[n];
+		mInputs.push_back(l);
+	}
+
+	// the first input is the one that the derived networks pre-process images into
+	mInputCPU     = mInputs[0].CPU;
+	mInputCUDA    = mInputs[0].CUDA;
+	mInputSize    = mInputs[0].size;
+	mInputDims    = mInputs[0].dims;
+	mWidth        = DIMS_W(mInputs[0].dims);
+	mHeight       = DIMS_H(mInputs[0].dims);
+	mMaxBatchSize = maxBatchSize;
+	
+
+	/*
+	 * setup network output buffers
+	 */
+	const int numOutputs = output_blobs.size();
+	
+	for( int n=0; n < numOutputs; n++ )
+	{
+		const int outputIndex = engine->getBindingIndex(output_blobs[n].c_str());
+		printf(LOG_TRT "binding to output %i %s  binding index:  %i\n", n, output_blobs[n].c_str(), outputIndex);
+
+		if( outputIndex < 0 )
 		{
-			if( !parser->registerOutput(outputs[n].c_str()) )
-				printf(LOG_TRT "failed to register output '%s' for UFF model '%s'\n", outputs[n].c_str(), modelFile.c_str());
-		}*/
+			printf(LOG_TRT "failed to find output %s in the network\n", output_blobs[n].c_str());
+			return false;
+		}
 
-		if( !parser->registerOutput("MarkOutput_0") )
-			printf(LOG_TRT "failed to register output '%s' for UFF model '%s'\n", "MarkOutput_0", modelFile.c_str());
+	#if NV_TENSORRT_MAJOR > 1
+		nvinfer1::Dims outputDims = validateDims(engine->getBindingDimensions(outputIndex));
+	#else
+		Dims3 outputDims = engine->getBindingDimensions(outputIndex);
+	#endif
+
+	#if NV_TENSORRT_MAJOR > 1
+		const precisionType outputType = bindingType(engine->getBindingDataType(outputIndex));
+	#else
+		const precisionType outputType = TYPE_FP32;
+	#endif
+
+		const size_t outputVolume = DIMS_C(outputDims) * DIMS_H(outputDims) * DIMS_W(outputDims);
+		const size_t outputSize   = maxBatchSize * outputVolume * bindingTypeSize(outputType);
 
+		printf(LOG_TRT "binding to output %i %s  dims (b=%u c=%u h=%u w=%u) type=%s size=%zu\n", n, output_blobs[n].c_str(), maxBatchSize, DIMS_C(outputDims), DIMS_H(outputDims), DIMS_W(outputDims), precisionTypeToStr(outputType), outputSize);
+	
+		// allocate output memory 
+		void* outputCPU  = NULL;
+		void* outputCUDA = NULL;
 		
-		// parse network
-		if( !parser->parse(modelFile.c_str(), *network, nvinfer1::DataType::kFLOAT) )
+		//if( CUDA_FAILED(cudaMalloc((void**)&outputCUDA, outputSize)) )
+		if( !cudaAllocMapped((void**)&outputCPU, (void**)&outputCUDA, outputSize) )
 		{
-			printf(LOG_TRT "failed to parse UFF model '%s'\n", modelFile.c_str());
+			printf(LOG_TRT "failed to alloc CUDA mapped memory for tensor output, %zu bytes\n", outputSize);
 			return false;
 		}
+	
+		layerBinding l;
 		
-		//parser->destroy();
+		l.CPU     = (float*)outputCPU;
+		l.CUDA    = (float*)outputCUDA;
+		l.mapped  = outputCPU;
+		l.size    = outputSize;
+		l.volume  = outputVolume;
+		l.type    = outputType;
+		l.binding = NULL;
+
+		// the post-processing reads FP16 outputs after they're converted to float
+		if( outputType == TYPE_FP16 )
+		{
+			l.CPU = (float*)malloc(maxBatchSize * outputVolume * sizeof(float));
+
+			if( !l.CPU )
+			{
+				printf(LOG_TRT "failed to allocate memory for converting tensor output, %zu bytes\n", maxBatchSize * outputVolume * sizeof(float));
+				CUDA(cudaFreeHost(outputCPU));
+				return false;
+			}
+		}
+		l.index   = outputIndex;
+
+	#if NV_TENSORRT_MAJOR > 1
+		DIMS_W(l.dims) = DIMS_W(outputDims);
+		DIMS_H(l.dims) = DIMS_H(outputDims);
+		DIMS_C(l.dims) = DIMS_C(outputDims);
+	#else
+		l.dims = outputDims;
+	#endif
+
+		l.name = output_blobs[n];
+		mOutputs.push_back(l);
 	}
-#endif
+	
+
+	mLoadReport.buffers = loadStageTime(&stage);
+
 
+	getBindings(mBindings, true);
+
+	mPrototxtPath     = prototxt_path;
+	mModelPath        = model_path;
+	mInputBlobName    = input_blobs[0];
+	mPrecision        = precision;
+	mDevice           = device;
+	mAllowGPUFallback = allowGPUFallback;
+
+	if( mean_path != NULL )
+		mMeanPath = mean_path;
+
+	if( !loadEngineSet(prototxt_path, model_path, input_blobs, input_dims, output_blobs, precision, device, allowGPUFallback, calibrator) )
+		return false;
+
+	mLoadReport.engineSet = loadStageTime(&stage);
 	
-#if NV_TENSORRT_MAJOR >= 4
-	// extract the dimensions of the network input blobs
-	std::map<std::string, nvinfer1::Dims3> inputDimensions;
 
-	for( int i=0, n=network->getNbInputs(); i < n; i++ )
+	/*
+	 * export the network's statistics
+	 */
+	static bool registeredMetrics = false;
+
+	pthread_mutex_lock(&gMetricsMutex);
+	gMetricsNetworks.push_back(this);
+
+	if( !registeredMetrics )
 	{
-		nvinfer1::Dims3 dims = static_cast<nvinfer1::Dims3&&>(network->getInput(i)->getDimensions());
-		inputDimensions.insert(std::make_pair(network->getInput(i)->getName(), dims));
-		std::cout << LOG_TRT << "retrieved Input tensor \"" << network->getInput(i)->getName() << "\":  " << dims.d[0] << "x" << dims.d[1] << "x" << dims.d[2] << std::endl;
+		inferenceMetrics::AddCollector(collectMetrics, NULL);
+		registeredMetrics = true;
 	}
-#endif
 
+	pthread_mutex_unlock(&gMetricsMutex);
 
-	// build the engine
-	printf(LOG_TRT "device %s, configuring CUDA engine\n", deviceTypeToStr(device));
-		
-	builder->setMaxBatchSize(maxBatchSize);
-	builder->setMaxWorkspaceSize(16 << 20);
+	mLoadReport.total = timeFloat(timeDiff(loadBegin, timestamp()));
 
+	printf("device %s, %s initialized.\n", deviceTypeToStr(device), mModelPath.c_str());
+	PrintLoadReport();
+	return true;
+}
 
-	// set up the builder for the desired precision
-	if( precision == TYPE_INT8 )
-	{
-	#if NV_TENSORRT_MAJOR >= 4
-		builder->setInt8Mode(true);
-		//builder->setFp16Mode(true);		// TODO:  experiment for benefits of both INT8/FP16
-		
-		if( !calibrator )
-		{
-			calibrator = new randInt8Calibrator(1, mCacheCalibrationPath, inputDimensions);
-			printf(LOG_TRT "warning:  device %s using INT8 precision with RANDOM calibration\n", deviceTypeToStr(device));
-		}
 
-		builder->setInt8Calibrator(calibrator);
-	#else
-		printf(LOG_TRT "INT8 precision requested, and TensorRT %u.%u doesn't meet minimum version for INT8\n", NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR);
-		printf(LOG_TRT "please use minumum version of TensorRT 4.0 or newer for INT8 support\n");
+// sameBinding
+static bool sameBinding( nvinfer1::ICudaEngine* a, nvinfer1::ICudaEngine* b, int index )
+{
+#if NV_TENSORRT_MAJOR > 1
+	if( a->getBindingDataType(index) != b->getBindingDataType(index) )
+		return false;
+
+	const nvinfer1::Dims dimsA = a->getBindingDimensions(index);
+	const nvinfer1::Dims dimsB = b->getBindingDimensions(index);
 
+	if( dimsA.nbDims != dimsB.nbDims )
 		return false;
-	#endif
-	}
-	else if( precision == TYPE_FP16 )
+
+	for( int n=0; n < dimsA.nbDims; n++ )
 	{
-	#if NV_TENSORRT_MAJOR < 4
-		builder->setHalf2Mode(true);
-	#else
-		builder->setFp16Mode(true);
-	#endif
+		if( dimsA.d[n] != dimsB.d[n] )
+			return false;
 	}
-	
 
-	// set the default device type
-#if NV_TENSORRT_MAJOR >= 5
-	builder->setDefaultDeviceType(deviceTypeToTRT(device));
+	return true;
+#else
+	const Dims3 dimsA = a->getBindingDimensions(index);
+	const Dims3 dimsB = b->getBindingDimensions(index);
 
-	if( allowGPUFallback )
-		builder->allowGPUFallback(true);
-	
-#if !(NV_TENSORRT_MAJOR == 5 && NV_TENSORRT_MINOR == 0 && NV_TENSORRT_PATCH == 0)
-	if( device == DEVICE_DLA_0 )
-		builder->setDLACore(0);
-	else if( device == DEVICE_DLA_1 )
-		builder->setDLACore(1);
+	return DIMS_C(dimsA) == DIMS_C(dimsB) && DIMS_H(dimsA) == DIMS_H(dimsB) && DIMS_W(dimsA) == DIMS_W(dimsB);
 #endif
-#else
-	if( device != DEVICE_GPU )
+}
+
+
+// loadEngineSet
+bool tensorNet::loadEngineSet( const std::string& prototxt_path, const std::string& model_path,
+						 const std::vector<std::string>& input_blobs, const std::vector<Dims3>& input_dims,
+						 const std::vector<std::string>& output_blobs, precisionType precision,
+						 deviceType device, bool allowGPUFallback, nvinfer1::IInt8Calibrator* calibrator )
+{
+	mEngineBatchSizes = batchTuner::EngineSet(mEngineSetEnabled ? gEngineSet : std::vector<uint32_t>(), mMaxBatchSize);
+
+	if( mEngineBatchSizes.size() <= 1 )
+		return true;
+
+#if NV_TENSORRT_MAJOR > 1
+	// the engines are cached under their own batch size, with the rest of the cache filename the same
+	char prefix[512];
+	sprintf(prefix, "%s.%u.", model_path.c_str(), mMaxBatchSize);
+
+	const size_t prefixLength = strlen(prefix);
+
+	if( mCacheEnginePath.compare(0, prefixLength, prefix) != 0 )
 	{
-		printf(LOG_TRT "device %s is not supported in TensorRT %u.%u\n", deviceTypeToStr(device), NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR);
+		printf(LOG_TRT "engine set -- unexpected engine cache path %s\n", mCacheEnginePath.c_str());
 		return false;
 	}
-#endif
 
-	// build CUDA engine
-	printf(LOG_TRT "device %s, building FP16:  %s\n", deviceTypeToStr(device), isFp16Enabled(builder) ? "ON" : "OFF"); 
-	printf(LOG_TRT "device %s, building INT8:  %s\n", deviceTypeToStr(device), isInt8Enabled(builder) ? "ON" : "OFF"); 
-	printf(LOG_TRT "device %s, building CUDA engine (this may take a few minutes the first time a network is loaded)\n", deviceTypeToStr(device));
+	// building an engine replaces the layer placement and the load times of the max batch size
+	const tensorLoadReport loadReport = mLoadReport;
+	const std::vector<layerPlacement> placement = mLayerPlacement;
+	const uint32_t transitions = mLayerTransitions;
+
+	bool success = true;
+
+	for( size_t n=0; n < mEngineBatchSizes.size() - 1 && success; n++ )
+	{
+		const uint32_t batchSize = mEngineBatchSizes[n];
+
+		char cache_path[512];
+		sprintf(cache_path, "%s.%u.%s", model_path.c_str(), batchSize, mCacheEnginePath.c_str() + prefixLength);
+
+		std::stringstream modelStream;
+		std::ifstream cache(cache_path);
+
+		if( !cache )
+		{
+			printf(LOG_TRT "engine set -- cache file not found, building the engine for batch size %u\n", batchSize);
+			gMetricsCacheMisses->Increment();
+
+			if( !ProfileModel(prototxt_path, model_path, input_blobs, input_dims, output_blobs, batchSize,
+						   precision, device, allowGPUFallback, calibrator, modelStream) )
+			{
+				printf(LOG_TRT "engine set -- failed to build the engine for batch size %u\n", batchSize);
+				success = false;
+				break;
+			}
+
+			std::ofstream outFile(cache_path);
+			outFile << modelStream.rdbuf();
+			outFile.close();
+			printf(LOG_TRT "engine set -- completed writing engine cache to %s\n", cache_path);
+		}
+		else
+		{
+			gMetricsCacheHits->Increment();
+			modelStream << cache.rdbuf();
+			cache.close();
+		}
+
+		const std::string model = modelStream.str();
+		nvinfer1::ICudaEngine* engine = mInfer->deserializeCudaEngine(model.data(), model.size(), NULL);
+
+		if( !engine )
+		{
+			printf(LOG_TRT "engine set -- failed to create the CUDA engine for batch size %u\n", batchSize);
+			success = false;
+			break;
+		}
+
+		batchEngine e;
+
+		e.batchSize = batchSize;
+		e.size      = model.size();
+		e.engine    = engine;
+		e.context   = NULL;
+
+		mEngineSet.push_back(e);
+
+		// the engines share the buffers of the max batch size, so their bindings must have
+		// the same indices, data types and dimensions (which exclude the batch size)
+		bool sameBindings = (engine->getNbBindings() == mEngine->getNbBindings());
 
-	nvinfer1::ICudaEngine* engine = builder->buildCudaEngine(*network);
-	
-	if( !engine )
-	{
-		printf(LOG_TRT "device %s, failed to build CUDA engine\n", deviceTypeToStr(device));
-		return false;
-	}
+		for( size_t i=0; i < mInputs.size(); i++ )
+			sameBindings = sameBindings && (engine->getBindingIndex(mInputs[i].name.c_str()) == mInputs[i].index);
 
-	printf(LOG_TRT "device %s, completed building CUDA engine\n", deviceTypeToStr(device));
+		for( size_t i=0; i < mOutputs.size(); i++ )
+			sameBindings = sameBindings && (engine->getBindingIndex(mOutputs[i].name.c_str()) == mOutputs[i].index);
 
-	// we don't need the network definition any more, and we can destroy the parser
-	network->destroy();
-	//parser->destroy();
+		for( int i=0; i < mEngine->getNbBindings() && sameBindings; i++ )
+			sameBindings = sameBinding(engine, mEngine, i);
 
-	// serialize the engine, then close everything down
-#if NV_TENSORRT_MAJOR > 1
-	nvinfer1::IHostMemory* serMem = engine->serialize();
+		if( !sameBindings )
+		{
+			printf(LOG_TRT "engine set -- the bindings of batch size %u don't match batch size %u\n", batchSize, mMaxBatchSize);
+			success = false;
+			break;
+		}
 
-	if( !serMem )
-	{
-		printf(LOG_TRT "device %s, failed to serialize CUDA engine\n", deviceTypeToStr(device));
-		return false;
+		mEngineSet.back().context = engine->createExecutionContext();
+
+		if( !mEngineSet.back().context )
+		{
+			printf(LOG_TRT "engine set -- failed to create the execution context for batch size %u\n", batchSize);
+			success = false;
+			break;
+		}
+
+		if( mEnableDebug )
+			mEngineSet.back().context->setDebugSync(true);
+
+		if( mEnableProfiler )
+			mEngineSet.back().context->setProfiler(&gProfiler);
+
+		printf(LOG_TRT "engine set -- loaded the engine for batch size %u (%zu bytes)\n", batchSize, model.size());
 	}
 
-	gieModelStream.write((const char*)serMem->data(), serMem->size());
+	mLoadReport       = loadReport;
+	mLayerPlacement   = placement;
+	mLayerTransitions = transitions;
+
+	return success;
 #else
-	engine->serialize(gieModelStream);
+	printf(LOG_TRT "engine sets require TensorRT 2 or newer, only the engine for batch size %u is loaded\n", mMaxBatchSize);
+	mEngineBatchSizes = batchTuner::EngineSet(std::vector<uint32_t>(), mMaxBatchSize);
+	return true;
 #endif
+}
 
-	engine->destroy();
-	builder->destroy();
-	return true;
+
+// selectContext
+nvinfer1::IExecutionContext* tensorNet::selectContext( uint32_t batchSize ) const
+{
+	const int n = batchTuner::SelectEngine(mEngineBatchSizes, batchSize);
+
+	if( n < 0 || n >= (int)mEngineSet.size() )
+		return mContext;
+
+	return mEngineSet[n].context;
 }
 
 
-// LoadNetwork
-bool tensorNet::LoadNetwork( const char* prototxt_path, const char* model_path, const char* mean_path, 
-					    const char* input_blob, const char* output_blob, uint32_t maxBatchSize,
-					    precisionType precision, deviceType device, bool allowGPUFallback,
-					    nvinfer1::IInt8Calibrator* calibrator, cudaStream_t stream )
+// PrintLoadReport
+void tensorNet::PrintLoadReport() const
 {
-	std::vector<std::string> outputs;
-	outputs.push_back(output_blob);
-	
-	return LoadNetwork(prototxt_path, model_path, mean_path, input_blob, outputs, maxBatchSize, precision, device, allowGPUFallback );
+	printf("\n");
+	printf(LOG_TRT "----------------------------------------------\n");
+	printf(LOG_TRT "Load Report %s\n", GetModelPath());
+	printf(LOG_TRT "----------------------------------------------\n");
+	printf(LOG_TRT "plugins       %10.3fms\n", mLoadReport.plugins);
+	printf(LOG_TRT "locate        %10.3fms\n", mLoadReport.locate);
+	printf(LOG_TRT "precision     %10.3fms  (%s)\n", mLoadReport.precision, mLoadReport.capabilityCached ? "cached" : "probed");
+	printf(LOG_TRT "autotune      %10.3fms\n", mLoadReport.autotune);
+	printf(LOG_TRT "cache read    %10.3fms  (%s)\n", mLoadReport.cacheRead, mLoadReport.cacheHit ? "hit" : "miss");
+	printf(LOG_TRT "parse         %10.3fms\n", mLoadReport.parse);
+	printf(LOG_TRT "build         %10.3fms\n", mLoadReport.build);
+	printf(LOG_TRT "serialize     %10.3fms\n", mLoadReport.serialize);
+	printf(LOG_TRT "cache write   %10.3fms\n", mLoadReport.cacheWrite);
+	printf(LOG_TRT "deserialize   %10.3fms\n", mLoadReport.deserialize);
+	printf(LOG_TRT "context       %10.3fms\n", mLoadReport.context);
+	printf(LOG_TRT "buffers       %10.3fms\n", mLoadReport.buffers);
+	printf(LOG_TRT "engine set    %10.3fms  (%zu engines)\n", mLoadReport.engineSet, mEngineBatchSizes.size());
+	printf(LOG_TRT "total         %10.3fms\n", mLoadReport.total);
+	printf(LOG_TRT "----------------------------------------------\n\n");
 }
 
 
-// LoadNetwork
-bool tensorNet::LoadNetwork( const char* prototxt_path_, const char* model_path_, const char* mean_path, 
-					    const char* input_blob, const std::vector<std::string>& output_blobs, 
-					    uint32_t maxBatchSize, precisionType precision,
-				   	    deviceType device, bool allowGPUFallback,
-					    nvinfer1::IInt8Calibrator* calibrator, cudaStream_t stream )
+// GetLayerTimings
+std::vector<layerTiming> tensorNet::GetLayerTimings() const
 {
-	return LoadNetwork(prototxt_path_, model_path_, mean_path,
-					   input_blob, Dims3(1,1,1), output_blobs,
-					   maxBatchSize, precision, device,
-					   allowGPUFallback, calibrator, stream);
+	std::vector<layerTiming> timings = gProfiler.layers;
+	placementReport::Attribute(mLayerPlacement, timings);
+	return timings;
 }
 
-					   
-// LoadNetwork
-bool tensorNet::LoadNetwork( const char* prototxt_path_, const char* model_path_, const char* mean_path, 
-					    const char* input_blob, const Dims3& input_dims,
-					    const std::vector<std::string>& output_blobs, 
-					    uint32_t maxBatchSize, precisionType precision,
-				   	    deviceType device, bool allowGPUFallback,
-					    nvinfer1::IInt8Calibrator* calibrator, cudaStream_t stream )
+
+// PrintLayerPlacement
+void tensorNet::PrintLayerPlacement() const
 {
-	if( /*!prototxt_path_ ||*/ !model_path_ )
-		return false;
+	printf("\n");
+	printf(LOG_TRT "%s on %s\n", GetModelPath(), deviceTypeToStr(mDevice));
+	placementReport::Print(mLayerPlacement, mLayerTransitions, GetLayerTimings());
+}
 
-#if NV_TENSORRT_MAJOR >= 4
-	printf(LOG_TRT "TensorRT version %u.%u.%u\n", NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR, NV_TENSORRT_PATCH);
-#else
-	printf(LOG_TRT "TensorRT version %u.%u\n", NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR);
-#endif
 
-	/*
-	 * load NV inference plugins
-	 */
-#if NV_TENSORRT_MAJOR > 4
-	static bool loadedPlugins = false;
+// cacheSidecarPath
+std::string tensorNet::cacheSidecarPath( const char* extension ) const
+{
+	std::string path = mCacheEnginePath;
+	const size_t ext = path.rfind(".engine");
 
-	if( !loadedPlugins )
-	{
-		printf(LOG_TRT "loading NVIDIA plugins...\n");
+	if( ext != std::string::npos )
+		path.erase(ext);
 
-		loadedPlugins = initLibNvInferPlugins(&gLogger, "");
+	path += extension;
+	return path;
+}
 
-		if( !loadedPlugins )
-			printf(LOG_TRT "failed to load NVIDIA plugins\n");
-		else
-			printf(LOG_TRT "completed loading NVIDIA plugins.\n");
-	}
-#endif
 
-	/*
-	 * verify the prototxt and model paths
-	 */
-	const std::string model_path    = locateFile(model_path_);
-	const std::string prototxt_path = locateFile(prototxt_path_ != NULL ? prototxt_path_ : "");
-	
-	const std::string model_ext = fileExtension(model_path_);
-	const modelType   model_fmt = modelTypeFromStr(model_ext.c_str());
+// collectMetrics
+void tensorNet::collectMetrics( std::string& output, void* user )
+{
+	static const char* stageName = "jetson_inference_stage_seconds";
+	static const char* execName  = "jetson_inference_executions_total";
+	static const char* bufName   = "jetson_inference_network_buffer_bytes";
+	static const char* loadName  = "jetson_inference_load_seconds";
 
-	printf(LOG_TRT "detected model format - %s  (extension '.%s')\n", modelTypeToStr(model_fmt), model_ext.c_str());
+	pthread_mutex_lock(&gMetricsMutex);
 
-	if( model_fmt == MODEL_CUSTOM )
-	{
-		printf(LOG_TRT "model format '%s' not supported by jetson-inference\n", modelTypeToStr(model_fmt));
-		return false;
-	}
-#if NV_TENSORRT_MAJOR < 5
-	else if( model_fmt == MODEL_ONNX )
-	{
-		printf(LOG_TRT "importing ONNX models is not supported in TensorRT %u.%u (version >= 5.0 required)\n", NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR);
-		return false;
-	}
-	else if( model_fmt == MODEL_UFF )
+	const size_t numNetworks = gMetricsNetworks.size();
+	std::vector<std::string> labels(numNetworks);
+
+	for( size_t n=0; n < numNetworks; n++ )
 	{
-		printf(LOG_TRT "importing UFF models is not supported in TensorRT %u.%u (version >= 5.0 required)\n", NV_TENSORRT_MAJOR, NV_TENSORRT_MINOR);
-		return false;
+		const tensorNet* net = gMetricsNetworks[n];
+
+		// label the network with the model's filename
+		const size_t slash = net->mModelPath.find_last_of('/');
+		std::string model = (slash != std::string::npos) ? net->mModelPath.substr(slash + 1) : net->mModelPath;
+		std::replace(model.begin(), model.end(), '"', '_');
+		std::replace(model.begin(), model.end(), '\\', '_');
+
+		char str[512];
+		snprintf(str, sizeof(str), "network=\"%s\",device=\"%s\",precision=\"%s\",instance=\"%zu\"",
+			    model.c_str(), deviceTypeToStr(net->mDevice), precisionTypeToStr(net->mPrecision), n);
+
+		labels[n] = str;
 	}
-#endif
-	else if( model_fmt == MODEL_CAFFE && !prototxt_path_ )
+
+	// per-stage latency histograms
+	inferenceMetrics::FormatHeader(output, stageName, "Latency of each processing stage, per network", "histogram");
+
+	for( size_t n=0; n < numNetworks; n++ )
 	{
-		printf(LOG_TRT "attempted to load caffe model without specifying prototxt file\n");
-		return false;
+		tensorNet* net = gMetricsNetworks[n];
+
+		for( uint32_t q=0; q < PROFILER_TOTAL; q++ )
+		{
+			for( uint32_t d=0; d < 2; d++ )
+			{
+				const profilerHistogram& histogram = net->mProfilerHistograms[q][d];
+
+				if( histogram.GetCount() == 0 )
+					continue;
+
+				const std::string stageLabels = labels[n] + ",stage=\"" + profilerQueryToStr((profilerQuery)q) + 
+										  "\",timer=\"" + profilerDeviceToStr((profilerDevice)d) + "\"";
+
+				inferenceMetrics::FormatHistogram(output, stageName, stageLabels.c_str(), histogram);
+			}
+		}
 	}
 
-	mModelType = model_fmt;
+	// throughput, counted from the network stage
+	inferenceMetrics::FormatHeader(output, execName, "Number of times each network was executed", "counter");
 
+	for( size_t n=0; n < numNetworks; n++ )
+		inferenceMetrics::FormatValue(output, execName, labels[n].c_str(), gMetricsNetworks[n]->mProfilerHistograms[PROFILER_NETWORK][PROFILER_CPU].GetCount());
 
-	/*
-	 * if the precision is left unspecified, detect the fastest
-	 */
-	printf(LOG_TRT "desired precision specified for %s: %s\n", deviceTypeToStr(device), precisionTypeToStr(precision));
+	// memory of the input/output bindings
+	inferenceMetrics::FormatHeader(output, bufName, "Size of the input and output tensors allocated by each network", "gauge");
 
-	if( precision == TYPE_DISABLED )
+	for( size_t n=0; n < numNetworks; n++ )
 	{
-		printf(LOG_TRT "skipping network specified with precision TYPE_DISABLE\n");
-		printf(LOG_TRT "please specify a valid precision to create the network\n");
+		const tensorNet* net = gMetricsNetworks[n];
+		size_t size = 0;
 
-		return false;
+		for( size_t i=0; i < net->mInputs.size(); i++ )
+			size += net->mInputs[i].size;
+
+		for( size_t o=0; o < net->mOutputs.size(); o++ )
+			size += net->mOutputs[o].size;
+
+		inferenceMetrics::FormatValue(output, bufName, labels[n].c_str(), size);
 	}
-	else if( precision == TYPE_FASTEST )
-	{
-		if( !calibrator )
-			printf(LOG_TRT "requested fasted precision for device %s without providing valid calibrator, disabling INT8\n", deviceTypeToStr(device));
 
-		precision = FindFastestPrecision(device, (calibrator != NULL));
-		printf(LOG_TRT "selecting fastest native precision for %s:  %s\n", deviceTypeToStr(device), precisionTypeToStr(precision));
+	// startup time
+	inferenceMetrics::FormatHeader(output, loadName, "Time spent loading each network", "gauge");
+
+	for( size_t n=0; n < numNetworks; n++ )
+		inferenceMetrics::FormatValue(output, loadName, labels[n].c_str(), gMetricsNetworks[n]->mLoadReport.total * 0.001);
+
+	pthread_mutex_unlock(&gMetricsMutex);
+
+	// device and process memory
+	size_t memFree  = 0;
+	size_t memTotal = 0;
+
+	if( cudaMemGetInfo(&memFree, &memTotal) == cudaSuccess )
+	{
+		inferenceMetrics::FormatHeader(output, "jetson_inference_device_memory_bytes", "Free and total memory of the CUDA device", "gauge");
+		inferenceMetrics::FormatValue(output, "jetson_inference_device_memory_bytes", "type=\"free\"", memFree);
+		inferenceMetrics::FormatValue(output, "jetson_inference_device_memory_bytes", "type=\"total\"", memTotal);
 	}
-	else
+
+	FILE* statm = fopen("/proc/self/statm", "r");
+
+	if( statm != NULL )
 	{
-		if( !DetectNativePrecision(precision, device) )
+		unsigned long pages = 0;
+		unsigned long resident = 0;
+
+		if( fscanf(statm, "%lu %lu", &pages, &resident) == 2 )
 		{
-			printf(LOG_TRT "precision %s is not supported for device %s\n", precisionTypeToStr(precision), deviceTypeToStr(device));
-			return false;
+			inferenceMetrics::FormatHeader(output, "jetson_inference_process_resident_bytes", "Resident memory of the process", "gauge");
+			inferenceMetrics::FormatValue(output, "jetson_inference_process_resident_bytes", NULL, (double)resident * sysconf(_SC_PAGESIZE));
 		}
 
-		if( precision == TYPE_INT8 && !calibrator )
-			printf(LOG_TRT "warning:  device %s using INT8 precision with RANDOM calibration\n", deviceTypeToStr(device));
+		fclose(statm);
 	}
+}
 
 
-	/*
-	 * attempt to load network from cache before profiling with tensorRT
-	 */
-	std::stringstream gieModelStream;
-	gieModelStream.seekg(0, gieModelStream.beg);
+// benchmark
+float tensorNet::benchmark( uint32_t iterations, uint32_t batchSize, profilerHistogram* histogram )
+{
+	if( !mContext || !mInputCPU || batchSize > mMaxBatchSize )
+		return -1.0f;
 
-	char cache_prefix[512];
-	char cache_path[512];
+	if( batchSize == 0 )
+		batchSize = mMaxBatchSize;
 
-	sprintf(cache_prefix, "%s.%u.%u.%s.%s", model_path.c_str(), maxBatchSize, (uint32_t)allowGPUFallback, deviceTypeToStr(device), precisionTypeToStr(precision));
-	sprintf(cache_path, "%s.calibration", cache_prefix);
-	mCacheCalibrationPath = cache_path;
-	
-	sprintf(cache_path, "%s.engine", cache_prefix);
-	mCacheEnginePath = cache_path;	
-	printf(LOG_TRT "attempting to open engine cache file %s\n", mCacheEnginePath.c_str());
-	
-	std::ifstream cache( mCacheEnginePath );
+	// the same pseudo-random input is used for every candidate, so their outputs can be compared,
+	// spanning the range of the pre-processing (which is the dynamic range of INT8 inputs)
+	const float range = (inputRange() > 0.0f) ? inputRange() : 1.0f;
+	uint32_t seed = 1;
 
-	if( !cache )
+	for( size_t i=0; i < mInputs.size(); i++ )
 	{
-		printf(LOG_TRT "cache file not found, profiling network model on device %s\n", deviceTypeToStr(device));
-	
-		if( model_path.size() == 0 )
-		{
-			printf("\nerror:  model file '%s' was not found.\n", model_path_);
-			printf("%s\n", LOG_DOWNLOADER_TOOL);
-			return 0;
-		}
+		const size_t inputElements = mMaxBatchSize * mInputs[i].volume;
 
-		if( !ProfileModel(prototxt_path, model_path, input_blob, input_dims,
-						 output_blobs, maxBatchSize, precision, device, 
-						 allowGPUFallback, calibrator, gieModelStream) )
+		for( size_t n=0; n < inputElements; n++ )
 		{
-			printf(LOG_TRT "device %s, failed to load %s\n", deviceTypeToStr(device), model_path_);
-			return 0;
+			seed = seed * 1664525 + 1013904223;
+			const float value = (float)(seed >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+
+			if( mInputs[i].type == TYPE_FP16 )
+				((uint16_t*)mInputs[i].mapped)[n] = floatToHalf(value * range);
+			else if( mInputs[i].type == TYPE_INT8 )
+				((int8_t*)mInputs[i].mapped)[n] = (int8_t)rintf(value * 127.0f);
+			else
+				mInputs[i].CPU[n] = value * range;
 		}
-	
-		printf(LOG_TRT "network profiling complete, writing engine cache to %s\n", mCacheEnginePath.c_str());
-		std::ofstream outFile;
-		outFile.open(mCacheEnginePath);
-		outFile << gieModelStream.rdbuf();
-		outFile.close();
-		gieModelStream.seekg(0, gieModelStream.beg);
-		printf(LOG_TRT "device %s, completed writing engine cache to %s\n", deviceTypeToStr(device), mCacheEnginePath.c_str());
 	}
-	else
+
+	std::vector<void*> bindings;
+	getBindings(bindings, false);
+
+	// warm up the clocks and the allocator
+	for( uint32_t n=0; n < 5; n++ )
 	{
-		printf(LOG_TRT "loading network profile from engine cache... %s\n", mCacheEnginePath.c_str());
-		gieModelStream << cache.rdbuf();
-		cache.close();
+		if( !selectContext(batchSize)->execute(batchSize, bindings.data()) )
+			return -1.0f;
+	}
 
-		// test for half FP16 support
-		/*nvinfer1::IBuilder* builder = CREATE_INFER_BUILDER(gLogger);
-		
-		if( builder != NULL )
+	const timespec begin = timestamp();
+	timespec runBegin = begin;
+
+	for( uint32_t n=0; n < iterations; n++ )
+	{
+		if( !selectContext(batchSize)->execute(batchSize, bindings.data()) )
+			return -1.0f;
+
+		if( histogram != NULL )
 		{
-			mEnableFP16 = !mOverride16 && builder->platformHasFastFp16();
-			printf(LOG_TRT "platform %s fast FP16 support\n", mEnableFP16 ? "has" : "does not have");
-			builder->destroy();	
-		}*/
+			const timespec runEnd = timestamp();
+			histogram->Add(timeFloat(timeDiff(runBegin, runEnd)));
+			runBegin = runEnd;
+		}
+	}
+
+	const float time = timeFloat(timeDiff(begin, timestamp())) / iterations;
+
+	convertOutputs(batchSize);
+	return time;
+}
+
+
+// warmupConverged
+static bool warmupConverged( const std::vector<float>& curve, float tolerance )
+{
+	if( curve.size() < WARMUP_WINDOW )
+		return false;
+
+	std::vector<float> window(curve.end() - WARMUP_WINDOW, curve.end());
+	std::sort(window.begin(), window.end());
+
+	const float median = window[WARMUP_WINDOW / 2];
+
+	return (window.back() - median) <= median * tolerance && (median - window.front()) <= median * tolerance;
+}
+
+
+// inputRange
+float tensorNet::inputRange() const
+{
+	return 0.0f;
+}
+
+
+// warmupIteration
+bool tensorNet::warmupIteration( float* rgba, uint32_t width, uint32_t height )
+{
+	return ProcessBindings(1);
+}
+
+
+// Warmup
+uint32_t tensorNet::Warmup( uint32_t iterations, float tolerance )
+{
+	if( !mContext || mWidth == 0 || mHeight == 0 || iterations == 0 )
+		return 0;
+
+	// synthetic RGBA image of the network's input size
+	float* imgCPU  = NULL;
+	float* imgCUDA = NULL;
+
+	if( !cudaAllocMapped((void**)&imgCPU, (void**)&imgCUDA, mWidth * mHeight * sizeof(float) * 4) )
+	{
+		printf(LOG_TRT "Warmup() -- failed to allocate the synthetic image (%ux%u)\n", mWidth, mHeight);
+		return 0;
 	}
 
-	printf(LOG_TRT "device %s, %s loaded\n", deviceTypeToStr(device), model_path.c_str());
-	
+	uint32_t seed = 1;
 
-	/*
-	 * create runtime inference engine execution context
-	 */
-	nvinfer1::IRuntime* infer = CREATE_INFER_RUNTIME(gLogger);
-	
-	if( !infer )
+	for( uint32_t n=0; n < mWidth * mHeight; n++ )
 	{
-		printf(LOG_TRT "device %s, failed to create InferRuntime\n", deviceTypeToStr(device));
-		return 0;
+		for( uint32_t c=0; c < 3; c++ )
+		{
+			seed = seed * 1664525 + 1013904223;
+			imgCPU[n*4+c] = (float)(seed >> 24);
+		}
+
+		imgCPU[n*4+3] = 255.0f;
 	}
 
-#if NV_TENSORRT_MAJOR >= 5 
-#if !(NV_TENSORRT_MAJOR == 5 && NV_TENSORRT_MINOR == 0 && NV_TENSORRT_PATCH == 0)
-	// if using DLA, set the desired core before deserialization occurs
-	if( device == DEVICE_DLA_0 )
+	// the synthetic frames aren't recorded
+	tensorRecorder* recorder = mRecorder;
+	mRecorder = NULL;
+
+	mWarmupCurve.clear();
+	mWarmedUp = false;
+
+	bool success = true;
+
+	for( uint32_t n=0; n < iterations && !mWarmedUp; n++ )
 	{
-		printf(LOG_TRT "device %s, enabling DLA core 0\n", deviceTypeToStr(device));
-		infer->setDLACore(0);
+		const timespec begin = timestamp();
+
+		if( !warmupIteration(imgCUDA, mWidth, mHeight) )
+		{
+			printf(LOG_TRT "Warmup() -- iteration %u failed\n", n);
+			success = false;
+			break;
+		}
+
+		CUDA(cudaStreamSynchronize(mStream));
+
+		mWarmupCurve.push_back(timeFloat(timeDiff(begin, timestamp())));
+		mWarmedUp = warmupConverged(mWarmupCurve, tolerance);
 	}
-	else if( device == DEVICE_DLA_1 )
+
+	// the iterations run the engine for batch size 1, so warm up the rest of the engine set too
+	std::vector<float> engineSetTimes;
+
+	for( size_t n=1; n < mEngineBatchSizes.size() && success; n++ )
 	{
-		printf(LOG_TRT "device %s, enabling DLA core 1\n", deviceTypeToStr(device));
-		infer->setDLACore(1);
+		float time = 0.0f;
+
+		for( uint32_t i=0; i < WARMUP_WINDOW && success; i++ )
+		{
+			const timespec begin = timestamp();
+			success = ProcessBindings(mEngineBatchSizes[n]);
+			time = timeFloat(timeDiff(begin, timestamp()));
+		}
+
+		if( !success )
+			printf(LOG_TRT "Warmup() -- the engine for batch size %u failed\n", mEngineBatchSizes[n]);
+
+		engineSetTimes.push_back(time);
 	}
-#endif
-#endif
 
-#if NV_TENSORRT_MAJOR > 1
-	// support for stringstream deserialization was deprecated in TensorRT v2
-	// instead, read the stringstream into a memory buffer and pass that to TRT.
-	gieModelStream.seekg(0, std::ios::end);
-	const int modelSize = gieModelStream.tellg();
-	gieModelStream.seekg(0, std::ios::beg);
+	mRecorder = recorder;
+	CUDA(cudaFreeHost(imgCPU));
 
-	void* modelMem = malloc(modelSize);
+	// the synthetic frames aren't part of the statistics
+	collectProfilerRecords(true);
+	mProfilerResults.clear();
+	ResetProfilerHistograms();
 
-	if( !modelMem )
-	{
-		printf(LOG_TRT "failed to allocate %i bytes to deserialize model\n", modelSize);
+	if( !success )
+		return 0;
+
+	// print the convergence curve
+	printf("\n");
+	printf(LOG_TRT "----------------------------------------------\n");
+	printf(LOG_TRT "Warmup Report %s\n", GetModelPath());
+	printf(LOG_TRT "----------------------------------------------\n");
+
+	for( size_t n=0; n < mWarmupCurve.size(); n++ )
+		printf(LOG_TRT "iteration %3zu  %10.3fms\n", n + 1, mWarmupCurve[n]);
+
+	printf(LOG_TRT "----------------------------------------------\n");
+
+	if( mWarmedUp )
+		printf(LOG_TRT "converged after %zu iterations (first %.3fms, steady state %.3fms)\n",
+			  mWarmupCurve.size(), mWarmupCurve.front(), mWarmupCurve.back());
+	else
+		printf(LOG_TRT "did not converge within %u iterations (first %.3fms, last %.3fms)\n",
+			  iterations, mWarmupCurve.front(), mWarmupCurve.back());
+
+	for( size_t n=0; n < engineSetTimes.size(); n++ )
+		printf(LOG_TRT "engine for batch size %-3u %10.3fms (after %u iterations)\n", mEngineBatchSizes[n+1], engineSetTimes[n], WARMUP_WINDOW);
+
+	printf(LOG_TRT "----------------------------------------------\n\n");
+	return mWarmupCurve.size();
+}
+
+
+// TuneBatchSize
+uint32_t tensorNet::TuneBatchSize( float latencyTarget, bool retune )
+{
+	if( !mContext || mCacheEnginePath.size() == 0 )
 		return 0;
+
+	// save the measurements next to the engine cache
+	const std::string path = cacheSidecarPath(".batch");
+	std::string key = capabilityCacheKey();
+
+	// the measurements depend on which engines run the batches
+	if( mEngineBatchSizes.size() > 1 )
+	{
+		key += "/engines";
+
+		for( size_t n=0; n < mEngineBatchSizes.size(); n++ )
+		{
+			char size[16];
+			sprintf(size, "-%u", mEngineBatchSizes[n]);
+			key += size;
+		}
 	}
 
-	gieModelStream.read((char*)modelMem, modelSize);
-	nvinfer1::ICudaEngine* engine = infer->deserializeCudaEngine(modelMem, modelSize, NULL);
-	free(modelMem);
-#else
-	// TensorRT v1 can deserialize directly from stringstream
-	nvinfer1::ICudaEngine* engine = infer->deserializeCudaEngine(gieModelStream);
-#endif
+	if( retune || !batchTuner::Load(path.c_str(), key.c_str(), mBatchProfiles) )
+	{
+		printf(LOG_TRT "measuring batch sizes up to %u for %s\n", mMaxBatchSize, mModelPath.c_str());
 
-	if( !engine )
+		// the batch sizes of the engine set are measured in addition to the candidates
+		std::vector<uint32_t> sizes = batchTuner::Candidates(mMaxBatchSize);
+		sizes.insert(sizes.end(), mEngineBatchSizes.begin(), mEngineBatchSizes.end());
+		sizes = batchTuner::EngineSet(sizes, mMaxBatchSize);
+
+		mBatchProfiles.clear();
+
+		for( size_t n=0; n < sizes.size(); n++ )
+		{
+			profilerHistogram histogram;
+			const float latency = benchmark(gAutoTuneIterations, sizes[n], &histogram);
+
+			if( latency <= 0.0f )
+			{
+				printf(LOG_TRT "failed to measure batch size %u\n", sizes[n]);
+				return 0;
+			}
+
+			batchProfile profile;
+
+			profile.batchSize   = sizes[n];
+			profile.latencyMean = latency;
+			profile.latencyP99  = histogram.GetPercentile(0.99f);
+			profile.throughput  = sizes[n] * 1000.0f / latency;
+
+			mBatchProfiles.push_back(profile);
+		}
+
+		batchTuner::Save(path.c_str(), key.c_str(), mBatchProfiles);
+	}
+	else
 	{
-		printf(LOG_TRT "device %s, failed to create CUDA engine\n", deviceTypeToStr(device));
-		return 0;
+		printf(LOG_TRT "loaded batch size measurements from %s\n", path.c_str());
 	}
-	
-	nvinfer1::IExecutionContext* context = engine->createExecutionContext();
-	
-	if( !context )
+
+	const uint32_t selected = batchTuner::Select(mBatchProfiles, latencyTarget);
+
+	for( size_t n=0; n < mBatchProfiles.size(); n++ )
 	{
-		printf(LOG_TRT "device %s, failed to create execution context\n", deviceTypeToStr(device));
-		return 0;
+		const batchProfile& p = mBatchProfiles[n];
+
+		printf(LOG_TRT "batch %3u  mean %8.3f ms  p99 %8.3f ms  %9.1f images/sec %s\n", p.batchSize, p.latencyMean,
+			  p.latencyP99, p.throughput, (p.batchSize == selected) ? "(selected)" : "");
 	}
 
-	if( mEnableDebug )
+	return selected;
+}
+
+
+// autoTuneCandidate
+class autoTuneCandidate : public tensorNet
+{
+public:
+	// the candidates bind their inputs and outputs the same way as the network being tuned
+	autoTuneCandidate( bool bindingPrecisionSupported, float range )
 	{
-		printf(LOG_TRT "device %s, enabling context debug sync.\n", deviceTypeToStr(device));
-		context->setDebugSync(true);
+		mBindingPrecisionSupported = bindingPrecisionSupported;
+		mEngineSetEnabled = false;	// the candidates are only benchmarked at the max batch size
+		mInputRange = range;
 	}
 
-	if( mEnableProfiler )
-		context->setProfiler(&gProfiler);
+protected:
+	virtual float inputRange() const	{ return mInputRange; }
 
-	printf(LOG_TRT "device %s, CUDA engine context initialized with %u bindings\n", deviceTypeToStr(device), engine->getNbBindings());
-	
-	mInfer   = infer;
-	mEngine  = engine;
-	mContext = context;
-	
-	SetStream(stream);	// set default device stream
+	float mInputRange;
+};
+
+
+// autoTune
+bool tensorNet::autoTune( const char* prototxt_path, const char* model_path, const char* mean_path,
+					 const std::vector<std::string>& input_blobs, const std::vector<Dims3>& input_dims, 
+					 const std::vector<std::string>& output_blobs, uint32_t maxBatchSize, nvinfer1::IInt8Calibrator* calibrator,
+					 precisionType* precision, deviceType* device, bool* allowGPUFallback )
+{
+	const std::string located = locateFile(model_path);
+
+	if( located.size() == 0 )
+		return false;
+
+	// the decision depends on the requested bindings (those of an INT8 engine, the others
+	// use FP16/FP32 inputs instead) and on whether INT8 was a candidate
+	precisionType inputType  = TYPE_FP32;
+	precisionType outputType = TYPE_FP32;
+
+	bindingPrecision(mBindingPrecisionSupported, TYPE_INT8, inputRange(), &inputType, &outputType);
+
+	char config[128];
+	sprintf(config, ".io-%s-%s", precisionTypeToStr(inputType), precisionTypeToStr(outputType));
+
+	if( inputType == TYPE_INT8 )
+		sprintf(config + strlen(config), "-%g", inputRange());
+
+	if( calibrator != NULL )
+		strcat(config, ".calibrated");
+
+	std::string key = capabilityCacheKey();
+
+	if( key.size() > 0 )
+		key += config;
+
+	char decision_path[512];
+	sprintf(decision_path, "%s.%u%s.autotune", located.c_str(), maxBatchSize, config);
 
 
-#if NV_TENSORRT_MAJOR >= 4
 	/*
-	 * print out binding info
+	 * use the previous decision if it was made with the same TensorRT and GPU
 	 */
-	const int numBindings = engine->getNbBindings();
-	
-	for( int n=0; n < numBindings; n++ )
+	FILE* file = fopen(decision_path, "r");
+
+	if( file != NULL )
 	{
-		printf(LOG_TRT "binding -- index   %i\n", n);
+		char fileKey[512];
+		char fileDevice[64];
+		char filePrecision[64];
 
-		const char* bind_name = engine->getBindingName(n);
+		const bool valid = (fscanf(file, "%511s %63s %63s", fileKey, fileDevice, filePrecision) == 3) && (key == fileKey);
 
-		printf("               -- name    '%s'\n", bind_name);
-		printf("               -- type    %s\n", dataTypeToStr(engine->getBindingDataType(n)));
-		printf("               -- in/out  %s\n", engine->bindingIsInput(n) ? "INPUT" : "OUTPUT");
+		fclose(file);
 
-		const nvinfer1::Dims bind_dims = engine->getBindingDimensions(n);
+		if( valid )
+		{
+			*precision = precisionTypeFromStr(filePrecision);
+			*device    = deviceTypeFromStr(fileDevice);
 
-		printf("               -- # dims  %i\n", bind_dims.nbDims);
-		
-		for( int i=0; i < bind_dims.nbDims; i++ )
-			printf("               -- dim #%i  %i (%s)\n", i, bind_dims.d[i], dimensionTypeToStr(bind_dims.type[i]));
+			if( *precision != TYPE_DISABLED && *precision != TYPE_FASTEST && *precision != TYPE_AUTOTUNE )
+			{
+				*allowGPUFallback = (*device != DEVICE_GPU);
+				printf(LOG_TRT "using auto-tuning decision from %s\n", decision_path);
+				return true;
+			}
+		}
 	}
-#endif
+
 
 	/*
-	 * determine dimensions of network input bindings
+	 * gather the candidates
 	 */
-	const int inputIndex = engine->getBindingIndex(input_blob);
-	
-	printf(LOG_TRT "binding to input 0 %s  binding index:  %i\n", input_blob, inputIndex);
-	
-#if NV_TENSORRT_MAJOR > 1
-	nvinfer1::Dims inputDims = validateDims(engine->getBindingDimensions(inputIndex));
-#else
-	Dims3 inputDims = engine->getBindingDimensions(inputIndex);
-#endif
+	std::vector< std::pair<precisionType, deviceType> > candidates;
+	const std::vector<precisionType> gpuTypes = DetectNativePrecisions(DEVICE_GPU);
 
-	size_t inputSize = maxBatchSize * DIMS_C(inputDims) * DIMS_H(inputDims) * DIMS_W(inputDims) * sizeof(float);
-	printf(LOG_TRT "binding to input 0 %s  dims (b=%u c=%u h=%u w=%u) size=%zu\n", input_blob, maxBatchSize, DIMS_C(inputDims), DIMS_H(inputDims), DIMS_W(inputDims), inputSize);
-	
+	// FP32 is first, as the reference for the other outputs
+	candidates.push_back(std::make_pair(TYPE_FP32, DEVICE_GPU));
 
-	/*
-	 * allocate memory to hold the input buffer
-	 */
-	if( !cudaAllocMapped((void**)&mInputCPU, (void**)&mInputCUDA, inputSize) )
+	if( DetectNativePrecision(gpuTypes, TYPE_FP16) )
+		candidates.push_back(std::make_pair(TYPE_FP16, DEVICE_GPU));
+
+	if( calibrator != NULL && DetectNativePrecision(gpuTypes, TYPE_INT8) )
+		candidates.push_back(std::make_pair(TYPE_INT8, DEVICE_GPU));
+
+#if NV_TENSORRT_MAJOR >= 5
+	nvinfer1::IRuntime* runtime = CREATE_INFER_RUNTIME(gLogger);
+
+	if( runtime != NULL )
 	{
-		printf(LOG_TRT "failed to alloc CUDA mapped memory for tensor input, %zu bytes\n", inputSize);
-		return false;
+		if( runtime->getNbDLACores() > 0 )
+			candidates.push_back(std::make_pair(TYPE_FP16, DEVICE_DLA_0));
+
+		runtime->destroy();
 	}
-	
-	mInputSize    = inputSize;
-	mWidth        = DIMS_W(inputDims);
-	mHeight       = DIMS_H(inputDims);
-	mMaxBatchSize = maxBatchSize;
-	
+#endif
+
+	printf(LOG_TRT "auto-tuning %s across %zu candidates\n", located.c_str(), candidates.size());
+
 
 	/*
-	 * setup network output buffers
+	 * benchmark each candidate
 	 */
-	const int numOutputs = output_blobs.size();
-	
-	for( int n=0; n < numOutputs; n++ )
+	std::vector<float> reference;
+
+	float bestTime = 0.0f;
+	int   bestCandidate = -1;
+
+	for( size_t n=0; n < candidates.size(); n++ )
 	{
-		const int outputIndex = engine->getBindingIndex(output_blobs[n].c_str());
-		printf(LOG_TRT "binding to output %i %s  binding index:  %i\n", n, output_blobs[n].c_str(), outputIndex);
+		const precisionType candidatePrecision = candidates[n].first;
+		const deviceType    candidateDevice    = candidates[n].second;
 
-	#if NV_TENSORRT_MAJOR > 1
-		nvinfer1::Dims outputDims = validateDims(engine->getBindingDimensions(outputIndex));
-	#else
-		Dims3 outputDims = engine->getBindingDimensions(outputIndex);
-	#endif
+		tensorNet* net = new autoTuneCandidate(mBindingPrecisionSupported, inputRange());
 
-		size_t outputSize = maxBatchSize * DIMS_C(outputDims) * DIMS_H(outputDims) * DIMS_W(outputDims) * sizeof(float);
-		printf(LOG_TRT "binding to output %i %s  dims (b=%u c=%u h=%u w=%u) size=%zu\n", n, output_blobs[n].c_str(), maxBatchSize, DIMS_C(outputDims), DIMS_H(outputDims), DIMS_W(outputDims), outputSize);
-	
-		// allocate output memory 
-		void* outputCPU  = NULL;
-		void* outputCUDA = NULL;
-		
-		//if( CUDA_FAILED(cudaMalloc((void**)&outputCUDA, outputSize)) )
-		if( !cudaAllocMapped((void**)&outputCPU, (void**)&outputCUDA, outputSize) )
+		if( !net->LoadNetwork(prototxt_path, model_path, mean_path, input_blobs, input_dims, output_blobs,
+						  maxBatchSize, candidatePrecision, candidateDevice, candidateDevice != DEVICE_GPU,
+						  candidatePrecision == TYPE_INT8 ? calibrator : NULL, NULL) )
 		{
-			printf(LOG_TRT "failed to alloc CUDA mapped memory for tensor output, %zu bytes\n", outputSize);
-			return false;
+			printf(LOG_TRT "auto-tuning:  %s on %s failed to load\n", precisionTypeToStr(candidatePrecision), deviceTypeToStr(candidateDevice));
+			delete net;
+
+			// without the FP32 reference, the accuracy of the other candidates can't be checked
+			if( n == 0 )
+				return false;
+
+			continue;
 		}
-	
-		outputLayer l;
-		
-		l.CPU  = (float*)outputCPU;
-		l.CUDA = (float*)outputCUDA;
-		l.size = outputSize;
 
-	#if NV_TENSORRT_MAJOR > 1
-		DIMS_W(l.dims) = DIMS_W(outputDims);
-		DIMS_H(l.dims) = DIMS_H(outputDims);
-		DIMS_C(l.dims) = DIMS_C(outputDims);
-	#else
-		l.dims = outputDims;
-	#endif
+		const float time = net->benchmark(gAutoTuneIterations);
 
-		l.name = output_blobs[n];
-		mOutputs.push_back(l);
+		if( time < 0.0f )
+		{
+			printf(LOG_TRT "auto-tuning:  %s on %s failed to execute\n", precisionTypeToStr(candidatePrecision), deviceTypeToStr(candidateDevice));
+			delete net;
+
+			if( n == 0 )
+				return false;
+
+			continue;
+		}
+
+		// compare the outputs against FP32
+		std::vector<float> outputs;
+
+		for( size_t o=0; o < net->mOutputs.size(); o++ )
+			outputs.insert(outputs.end(), net->mOutputs[o].CPU, net->mOutputs[o].CPU + net->mMaxBatchSize * net->mOutputs[o].volume);
+
+		delete net;
+
+		float error = 0.0f;
+
+		if( n == 0 )
+		{
+			reference = outputs;
+		}
+		else if( outputs.size() != reference.size() )
+		{
+			error = INFINITY;	// the outputs can't be compared, so the candidate is rejected
+		}
+		else if( gAutoTuneTolerance > 0.0f )
+		{
+			float maxDiff = 0.0f;
+			float maxRef  = 1e-6f;
+
+			for( size_t i=0; i < outputs.size(); i++ )
+			{
+				maxDiff = fmaxf(maxDiff, fabsf(outputs[i] - reference[i]));
+				maxRef  = fmaxf(maxRef, fabsf(reference[i]));
+			}
+
+			error = maxDiff / maxRef;
+		}
+
+		const bool accepted = (error <= gAutoTuneTolerance || (gAutoTuneTolerance <= 0.0f && error == 0.0f));
+
+		printf(LOG_TRT "auto-tuning:  %-4s on %-5s  %8.3f ms  error %.4f  %s\n", precisionTypeToStr(candidatePrecision), 
+			  deviceTypeToStr(candidateDevice), time, error, accepted ? "" : "(rejected)");
+
+		if( accepted && (bestCandidate < 0 || time < bestTime) )
+		{
+			bestTime      = time;
+			bestCandidate = n;
+		}
 	}
-	
+
+	if( bestCandidate < 0 )
+		return false;
+
+	*precision        = candidates[bestCandidate].first;
+	*device           = candidates[bestCandidate].second;
+	*allowGPUFallback = (*device != DEVICE_GPU);
+
 
 	/*
-	 * create events for timing
+	 * record the decision next to the engine cache
 	 */
-	for( int n=0; n < PROFILER_TOTAL * 2; n++ )
-		CUDA(cudaEventCreate(&mEventsGPU[n]));
+	file = fopen(decision_path, "w");
 
+	if( file != NULL )
+	{
+		fprintf(file, "%s %s %s %.4f\n", key.size() > 0 ? key.c_str() : "unknown", deviceTypeToStr(*device), precisionTypeToStr(*precision), bestTime);
+		fclose(file);
+	}
+	else
+	{
+		printf(LOG_TRT "failed to save auto-tuning decision to %s\n", decision_path);
+	}
 
-#if NV_TENSORRT_MAJOR > 1
-	DIMS_W(mInputDims) = DIMS_W(inputDims);
-	DIMS_H(mInputDims) = DIMS_H(inputDims);
-	DIMS_C(mInputDims) = DIMS_C(inputDims);
-#else
-	mInputDims        = inputDims;
-#endif
-	mPrototxtPath     = prototxt_path;
-	mModelPath        = model_path;
-	mInputBlobName    = input_blob;
-	mPrecision        = precision;
-	mDevice           = device;
-	mAllowGPUFallback = allowGPUFallback;
-
-	if( mean_path != NULL )
-		mMeanPath = mean_path;
-	
-	printf("device %s, %s initialized.\n", deviceTypeToStr(device), mModelPath.c_str());
 	return true;
 }
 
@@ -32,7 +32,14 @@ namespace nvinfer1 { class IInt8Calibrator; }
 #include <jetson-utils/cudaUtility.h>
 #include <jetson-utils/timespec.h>
 
+#include "profilerHistogram.h"
+#include "batchTuner.h"
+#include "tensorRecord.h"
+#include "layerPlacement.h"
+
 #include <vector>
+#include <deque>
+#include <map>
 #include <sstream>
 #include <math.h>
 
@@ -64,6 +71,18 @@ typedef nvinfer1::Dims3 Dims3;
  */
 #define DEFAULT_MAX_BATCH_SIZE  1
 
+/**
+ * Default maximum number of iterations run by tensorNet::Warmup()
+ * @ingroup tensorNet
+ */
+#define WARMUP_DEFAULT_ITERATIONS  50
+
+/**
+ * Number of consecutive iterations whose latencies must agree for tensorNet::Warmup() to converge
+ * @ingroup tensorNet
+ */
+#define WARMUP_WINDOW  5
+
 /**
  * Prefix used for tagging printed log output from TensorRT.
  * @ingroup tensorNet
@@ -83,6 +102,7 @@ enum precisionType
 	TYPE_FP32,		/**< 32-bit floating-point precision (FP32) */
 	TYPE_FP16,		/**< 16-bit floating-point half precision (FP16) */
 	TYPE_INT8,		/**< 8-bit integer precision (INT8) */
+	TYPE_AUTOTUNE,		/**< Benchmark the native precisions on each device and use the fastest (@see tensorNet::SetAutoTuneOptions()) */
 	NUM_PRECISIONS		/**< Number of precision types defined */
 };
 
@@ -169,6 +189,13 @@ enum profilerQuery
  */
 const char* profilerQueryToStr( profilerQuery query );
 
+/**
+ * Parse the profiler query from a string (i.e. "network" or "post-process").
+ * @returns the profilerQuery, or PROFILER_TOTAL on an invalid string.
+ * @ingroup tensorNet
+ */
+profilerQuery profilerQueryFromStr( const char* str );
+
 /**
  * Profiler device
  * @ingroup tensorNet
@@ -179,6 +206,72 @@ enum profilerDevice
 	PROFILER_CUDA,		/**< CUDA kernel time */ 
 };
 
+/**
+ * Stringize function that returns profilerDevice in text.
+ * @ingroup tensorNet
+ */
+const char* profilerDeviceToStr( profilerDevice device );
+
+/**
+ * Maximum number of profiling records that a network keeps in flight.
+ * When they're all waiting on the GPU, the oldest one is synchronized.
+ * @ingroup tensorNet
+ */
+#define PROFILER_RECORDS_MAX 16
+
+/**
+ * Maximum number of completed profiling results that are kept until they're
+ * retrieved with tensorNet::GetProfilerResults() (the oldest are dropped).
+ * @ingroup tensorNet
+ */
+#define PROFILER_RESULTS_MAX 256
+
+/**
+ * Profiler times of one request through a network.  A request begins with its
+ * pre-processing, or with the network if it wasn't pre-processed.  The stages after
+ * the network may run several times per request (i.e. segNet's Overlay() and Mask()),
+ * in which case their CPU times are summed and their CUDA time spans from the first
+ * run to the last.
+ * @see tensorNet::GetProfilerResults()
+ * @ingroup tensorNet
+ */
+struct profilerResult
+{
+	uint64_t request;	/**< ID of the request (@see tensorNet::SetProfilerRequest()) */
+	timespec timestamp;	/**< CPU time when the request began */
+	uint32_t queries;	/**< bitmask of the queries that were run, (1 << profilerQuery) */
+	float2   times[PROFILER_TOTAL + 1];	/**< CPU (x) and CUDA (y) times in milliseconds, PROFILER_TOTAL is their sum */
+};
+
+
+/**
+ * Breakdown of the time spent loading a network, in milliseconds.
+ * Stages that didn't run (i.e. parsing and building when the engine
+ * was loaded from the cache) are left at zero.
+ * @see tensorNet::GetLoadReport()
+ * @ingroup tensorNet
+ */
+struct tensorLoadReport
+{
+	float plugins;		/**< initializing the TensorRT plugins (only the first network) */
+	float locate;		/**< locating the model files */
+	float precision;	/**< probing the native precisions of the device */
+	float autotune;	/**< benchmarking the candidates for TYPE_AUTOTUNE (zero if the decision was cached) */
+	float cacheRead;	/**< reading the engine cache */
+	float parse;		/**< parsing the model */
+	float build;		/**< building the CUDA engine */
+	float serialize;	/**< serializing the CUDA engine */
+	float cacheWrite;	/**< writing the engine cache */
+	float deserialize;	/**< deserializing the CUDA engine */
+	float context;		/**< creating the execution context */
+	float buffers;		/**< allocating the input/output buffers */
+	float engineSet;	/**< loading (or building) the smaller engines of the engine set */
+	float total;		/**< total time spent in LoadNetwork() */
+
+	bool cacheHit;			/**< true if the engine was loaded from the cache */
+	bool capabilityCached;	/**< true if the native precisions were already known */
+};
+
 
 /**
  * Abstract class for loading a tensor network with TensorRT.
@@ -241,10 +334,31 @@ public:
 				   deviceType device=DEVICE_GPU, bool allowGPUFallback=true,
 				   nvinfer1::IInt8Calibrator* calibrator=NULL, cudaStream_t stream=NULL );
 
+	/**
+	 * Load a new network instance with multiple input and output layers
+	 * @param prototxt File path to the deployable network prototxt
+	 * @param model File path to the caffemodel 
+	 * @param mean File path to the mean value binary proto (NULL if none)
+	 * @param input_blobs List of names of the input blobs to the network.
+	 * @param input_dims The dimensions of each input blob (used for UFF).
+	 * @param output_blobs List of names of the output blobs from the network.
+	 * @param maxBatchSize The maximum batch size that the network will be optimized for.
+	 */
+	bool LoadNetwork( const char* prototxt, const char* model, const char* mean,
+				   const std::vector<std::string>& input_blobs, 
+				   const std::vector<Dims3>& input_dims, 
+				   const std::vector<std::string>& output_blobs,
+				   uint32_t maxBatchSize=DEFAULT_MAX_BATCH_SIZE, 
+				   precisionType precision=TYPE_FASTEST,
+				   deviceType device=DEVICE_GPU, bool allowGPUFallback=true,
+				   nvinfer1::IInt8Calibrator* calibrator=NULL, cudaStream_t stream=NULL );
+
 	/**
 	 * Manually enable layer profiling times.	
+	 * The times are accumulated per layer (@see GetLayerTimings()), and if print
+	 * is true, each layer's time is also printed as it's reported.
 	 */
-	void EnableLayerProfiler();
+	void EnableLayerProfiler( bool print=true );
 
 	/**
 	 * Manually enable debug messages and synchronization.
@@ -256,6 +370,17 @@ public:
 	 */
 	inline bool AllowGPUFallback() const				{ return mAllowGPUFallback; }
 
+	/**
+	 * Retrieve the maximum batch size that the network was loaded with.
+	 */
+	inline uint32_t GetMaxBatchSize() const				{ return mMaxBatchSize; }
+
+	/**
+	 * Retrieve the batch sizes of the engines that the network loaded, in increasing order
+	 * (the last one is the max batch size).  @see SetEngineSet()
+	 */
+	inline const std::vector<uint32_t>& GetEngineSet() const	{ return mEngineBatchSizes; }
+
 	/**
  	 * Retrieve the device being used for execution.
 	 */
@@ -291,6 +416,81 @@ public:
 	 */
 	static bool DetectNativePrecision( precisionType precision, deviceType device=DEVICE_GPU );
 
+	/**
+	 * Persist the native precisions detected for each device to a file, so that
+	 * later processes can skip creating a TensorRT builder to probe them.
+	 * The precisions are always cached in memory, once per device per process.
+	 * Entries are keyed by the TensorRT version and the GPU, so the same file
+	 * may be shared by different systems.
+	 * @param path file to load the cached capabilities from and save them to, or NULL to disable
+	 */
+	static void SetCapabilityCache( const char* path );
+
+	/**
+	 * Configure how networks loaded with TYPE_AUTOTUNE select their precision and device.
+	 *
+	 * Each candidate (FP32, FP16 and INT8 when a calibrator is provided on the GPU,
+	 * plus FP16 on DLA with GPU fallback when DLA cores are present) is built or loaded
+	 * from its engine cache with the same bindings as the network (@see SetBindingPrecision()),
+	 * then timed over a number of runs at the max batch size.  Candidates whose outputs
+	 * differ from FP32 by more than the tolerance are rejected, and tuning fails if FP32
+	 * itself can't be run.  The decision is saved next to the engine cache
+	 * (model.<batch>.io-<input>-<output>.autotune, with .calibrated when a calibrator was
+	 * provided), so that tuning only happens once -- delete that file to tune again.
+	 *
+	 * @param tolerance maximum difference of the outputs from FP32, relative to the largest
+	 *                  FP32 output magnitude (0 disables the check)
+	 * @param iterations number of timed runs of each candidate (after warmup), which is
+	 *                   also the number of runs of each batch size in TuneBatchSize()
+	 */
+	static void SetAutoTuneOptions( float tolerance=0.05f, uint32_t iterations=50 );
+
+	/**
+	 * Set the data types of the input and output bindings of networks loaded afterwards.
+	 *
+	 * By default the bindings are FP32, so engines built in FP16 or INT8 reformat the tensors
+	 * at both ends, and twice (or four times) the bytes are transferred.  With FP16 bindings
+	 * the pre-processing kernels write half directly, and the outputs are converted to float
+	 * on the CPU (with vectorized conversion) before post-processing.
+	 *
+	 * @note FP16 outputs halve the bytes that the engine writes and that are transferred from
+	 *       the GPU, but not the bytes that the post-processing reads -- the whole output is
+	 *       expanded into a float copy first (@see convertOutputs()), so the CPU reads the half
+	 *       tensor once and then the float copy.  The post-processors aren't converted per row.
+	 *
+	 * An INT8 input binding
+	 * is quantized symmetrically over the range of values that the network's pre-processing
+	 * writes (@see inputRange()), which is also set as its dynamic range -- the networks whose
+	 * range isn't known keep an FP32 input.  It's only used by engines built for TYPE_INT8,
+	 * as the other engines don't run in INT8 mode:  FP16 engines get an FP16 input instead,
+	 * and FP32 engines (including the FP32 reference of TYPE_AUTOTUNE) an FP32 input.
+	 *
+	 * Only networks whose pre- and post-processing handle the types use them (imageNet,
+	 * detectNet and segNet) -- the others keep FP32 bindings.  Requires TensorRT 6 or newer.
+	 * The data types are part of the engine cache filename.
+	 *
+	 * @param input type of the input bindings (TYPE_FP32, TYPE_FP16 or TYPE_INT8)
+	 * @param output type of the output bindings (TYPE_FP32 or TYPE_FP16)
+	 * @returns false if a type isn't supported for the binding.
+	 */
+	static bool SetBindingPrecision( precisionType input=TYPE_FP32, precisionType output=TYPE_FP32 );
+
+	/**
+	 * Set the batch sizes of the engines that networks loaded afterwards build in addition to
+	 * the engine for their max batch size (i.e. 1, 2 and 4 for a max batch size of 8).
+	 *
+	 * An engine built for a large max batch size is slower than a small one when only a few
+	 * images are pending, so each batch is run by the smallest engine of the set that fits it
+	 * (@see batchTuner::SelectEngine()).  All the engines share the bindings, which are allocated
+	 * for the max batch size.  Each engine is cached under its own batch size, the batch size
+	 * measurements of TuneBatchSize() are keyed by the set, and Warmup() and GetMemoryUsage()
+	 * cover every engine of the set.
+	 *
+	 * @param batchSizes batch sizes of the additional engines (the sizes that aren't below the
+	 *                   max batch size of a network are ignored), or an empty set to disable
+	 */
+	static void SetEngineSet( const std::vector<uint32_t>& batchSizes );
+
 	/**
 	 * Retrieve the stream that the device is operating on.
 	 */
@@ -326,6 +526,163 @@ public:
 	 */
 	inline bool IsModelType( modelType type ) const		{ return (mModelType == type); }
 
+	/**
+	 * Bind caller-owned device memory as an input tensor, in place of the buffer that the
+	 * network allocated.  The memory should hold an already-normalized NCHW tensor, which
+	 * ProcessBindings() runs the network on directly without any pre-processing -- for example
+	 * the output binding of another network (@see GetOutputBinding()), for zero-copy chaining.
+	 * @note the processing functions of the derived networks (i.e. imageNet::Classify()) always
+	 *       pre-process into the network's own buffers, and only ProcessBindings() uses the bindings.
+	 * @param input index of the input (@see FindInput() to look it up by name)
+	 * @param buffer device memory of the tensor, or NULL to restore the network's own buffer
+	 * @param dims dimensions of one image in the tensor, which must match the network (@see GetInputDims())
+	 * @param size size of the buffer in bytes, which must hold GetMaxBatchSize() images
+	 * @param type data type of the tensor, which must match the binding (@see GetInputType())
+	 * @returns false if the dimensions, size or type don't match the network.
+	 */
+	bool SetInputBinding( uint32_t input, void* buffer, const Dims3& dims, size_t size, precisionType type=TYPE_FP32 );
+
+	/**
+	 * Bind caller-owned device memory as the first input tensor.
+	 * @see SetInputBinding() for the parameters.
+	 */
+	inline bool SetInputBinding( void* buffer, const Dims3& dims, size_t size, precisionType type=TYPE_FP32 )	{ return SetInputBinding(0, buffer, dims, size, type); }
+
+	/**
+	 * Bind caller-owned device memory as an output tensor, in place of the buffer that the network allocated.
+	 * @see SetInputBinding() for the parameters.
+	 */
+	bool SetOutputBinding( uint32_t output, void* buffer, const Dims3& dims, size_t size, precisionType type=TYPE_FP32 );
+
+	/**
+	 * Find the index of an input by the name of its blob.
+	 * @returns the index, or -1 if the network has no input by that name.
+	 */
+	int FindInput( const char* name ) const;
+
+	/**
+	 * Find the index of an output by the name of its blob.
+	 * @returns the index, or -1 if the network has no output by that name.
+	 */
+	int FindOutput( const char* name ) const;
+
+	/**
+	 * Retrieve the device memory that's currently bound as an input tensor.
+	 */
+	inline void* GetInputBinding( uint32_t input=0 ) const	{ return (mInputs[input].binding != NULL) ? mInputs[input].binding : mInputs[input].CUDA; }
+
+	/**
+	 * Retrieve the device memory that's currently bound as an output tensor.
+	 */
+	inline void* GetOutputBinding( uint32_t output ) const	{ return (mOutputs[output].binding != NULL) ? mOutputs[output].binding : mOutputs[output].CUDA; }
+
+	/**
+	 * Retrieve the network's own buffer of an input tensor (in CPU memory, mapped to the GPU).
+	 */
+	inline float* GetInputCPU( uint32_t input=0 ) const	{ return mInputs[input].CPU; }
+
+	/**
+	 * Retrieve the name of an input blob.
+	 */
+	inline const char* GetInputName( uint32_t input=0 ) const	{ return mInputs[input].name.c_str(); }
+
+	/**
+	 * Retrieve the name of an output blob.
+	 */
+	inline const char* GetOutputName( uint32_t output ) const	{ return mOutputs[output].name.c_str(); }
+
+	/**
+	 * Retrieve the dimensions of one image of an input tensor.
+	 */
+	inline const Dims3& GetInputDims( uint32_t input=0 ) const	{ return mInputs[input].dims; }
+
+	/**
+	 * Retrieve the dimensions of one image of an output tensor.
+	 */
+	inline const Dims3& GetOutputDims( uint32_t output ) const	{ return mOutputs[output].dims; }
+
+	/**
+	 * Retrieve the data type of an input binding (@see SetBindingPrecision()).
+	 */
+	inline precisionType GetInputType( uint32_t input=0 ) const	{ return mInputs[input].type; }
+
+	/**
+	 * Retrieve the data type of an output binding in device memory (@see SetBindingPrecision()).
+	 * @note the outputs in CPU memory (@see GetOutputBatch()) are always converted to float.
+	 */
+	inline precisionType GetOutputType( uint32_t output ) const	{ return mOutputs[output].type; }
+
+	/**
+	 * Retrieve the size of an input tensor (for the max batch size), in bytes.
+	 */
+	inline size_t GetInputSize( uint32_t input=0 ) const	{ return mInputs[input].size; }
+
+	/**
+	 * Retrieve the size of an output tensor (for the max batch size), in bytes.
+	 */
+	inline size_t GetOutputSize( uint32_t output ) const	{ return mOutputs[output].size; }
+
+	/**
+	 * Retrieve the number of input tensors.
+	 */
+	inline uint32_t GetNumInputs() const				{ return mInputs.size(); }
+
+	/**
+	 * Retrieve the number of output tensors.
+	 */
+	inline uint32_t GetNumOutputs() const				{ return mOutputs.size(); }
+
+	/**
+	 * Run the network on the tensors that are currently bound, with no pre- or post-processing.
+	 * The bindings are passed to TensorRT from a table indexed by the engine's binding indices,
+	 * which is updated whenever a binding changes.  When an output isn't bound to caller
+	 * memory, its results can be read from GetOutputBatch().
+	 * @param batchSize number of images in the input tensor to process
+	 * @returns false on error.
+	 */
+	bool ProcessBindings( uint32_t batchSize=1 );
+
+	/**
+	 * Record the raw output tensors of each frame that the network processes to a file,
+	 * so that the post-processing can be replayed and profiled offline (@see tensorRecorder
+	 * and ReplayOutputs()).  If the recording already exists, the frames are appended to it.
+	 * The outputs are recorded by detectNet and segNet, except for the outputs bound to
+	 * caller memory and detectNet::DetectDevice() (which doesn't copy the outputs to the CPU).
+	 * @returns false if the recording couldn't be opened.
+	 */
+	bool EnableRecording( const char* path );
+
+	/**
+	 * Stop recording the output tensors, and close the recording.
+	 */
+	void DisableRecording();
+
+	/**
+	 * Return true if the output tensors are being recorded.
+	 */
+	inline bool IsRecording() const					{ return mRecorder != NULL; }
+
+	/**
+	 * Load recorded output tensors in place of running the network, so that the
+	 * post-processing of the derived network can be run on them (for example with
+	 * detectNet::PostProcess() or segNet::Classify()).  The tensors are copied to
+	 * the outputs in CPU memory, and must match the network's outputs.
+	 * @returns false if the frame wasn't recorded from this network.
+	 */
+	bool ReplayOutputs( const tensorFrame& frame );
+
+	/**
+	 * Retrieve the path to the serialized engine cache that the network was loaded from.
+	 */
+	inline const char* GetCacheEnginePath() const		{ return mCacheEnginePath.c_str(); }
+
+	/**
+	 * Estimate the memory held by the network -- the serialized engine (as an
+	 * approximation of its weights), the engine's activation memory, and the
+	 * input/output tensors.  These are all released when the network is deleted.
+	 */
+	size_t GetMemoryUsage() const;
+
 	/**
 	 * Retrieve the network runtime (in milliseconds).
 	 */
@@ -340,7 +697,119 @@ public:
 	 * Retrieve the profiler runtime (in milliseconds).
 	 */
 	inline float GetProfilerTime( profilerQuery query, profilerDevice device ) { PROFILER_QUERY(query); return (device == PROFILER_CPU) ? mProfilerTimes[query].x : mProfilerTimes[query].y; }
+
+	/**
+	 * Retrieve the histogram of a profiler query's runtimes (in milliseconds) over every request.
+	 * @note PROFILER_TOTAL isn't accumulated, and its histogram is always empty.
+	 */
+	inline const profilerHistogram& GetProfilerHistogram( profilerQuery query, profilerDevice device )	{ PROFILER_QUERY(query); return mProfilerHistograms[query][device]; }
+
+	/**
+	 * Set the ID that the next request through the network is recorded under.
+	 * The following requests are numbered sequentially from it.
+	 */
+	inline void SetProfilerRequest( uint64_t request )			{ mProfilerRequest = request; }
+
+	/**
+	 * Retrieve the profiler times of the requests that completed on the GPU since the
+	 * last call, oldest first.  This never waits for the GPU, so the requests that are
+	 * still in flight are returned by a later call.
+	 * @returns the number of results appended to the vector.
+	 */
+	uint32_t GetProfilerResults( std::vector<profilerResult>& results );
+
+	/**
+	 * Clear the profiler histograms.
+	 */
+	inline void ResetProfilerHistograms()
+	{
+		for( uint32_t n=0; n <= PROFILER_TOTAL; n++ )
+		{
+			mProfilerHistograms[n][PROFILER_CPU].Reset();
+			mProfilerHistograms[n][PROFILER_CUDA].Reset();
+		}
+	}
 	
+	/**
+	 * Measure the latency and throughput of batch sizes up to the max batch size, and select
+	 * the one with the highest throughput whose p99 latency is under the target.
+	 * The measurements are saved next to the engine cache (with the .batch extension) and
+	 * reused the next time, as long as the TensorRT version and GPU are the same.
+	 * @note the batches are run on the engine that would run them (the engine built for the
+	 *       max batch size, or the smallest engine of the set that fits @see SetEngineSet()),
+	 *       with synthetic input data -- call this before processing images, as it overwrites
+	 *       the input tensor.  Each batch size is timed over the number of runs set with
+	 *       SetAutoTuneOptions().
+	 * @param latencyTarget maximum p99 latency of a batch (in milliseconds)
+	 * @param retune if true, measure again even if saved measurements exist
+	 * @returns the selected batch size, or 0 on error.
+	 */
+	uint32_t TuneBatchSize( float latencyTarget, bool retune=false );
+
+	/**
+	 * Retrieve the measurements made by TuneBatchSize().
+	 */
+	inline const std::vector<batchProfile>& GetBatchProfiles() const	{ return mBatchProfiles; }
+
+	/**
+	 * Run the network on a synthetic image until the latency of an iteration converges,
+	 * so that the first real frame doesn't pay for lazy allocations, clock ramp-up, or the
+	 * initialization of libraries inside plugins.  The derived networks run their pre/post-
+	 * processing and visualization kernels as well as the engine (@see warmupIteration()).
+	 * Warmup is converged when the latencies of the last WARMUP_WINDOW iterations are all
+	 * within the tolerance of their median.  The synthetic frames aren't recorded, and the
+	 * profiler histograms are reset afterwards, so call this before processing images.
+	 * @param iterations maximum number of iterations to run
+	 * @param tolerance maximum difference of the latencies from their median (relative)
+	 * @returns the number of iterations that were run, or 0 on error.
+	 */
+	uint32_t Warmup( uint32_t iterations=WARMUP_DEFAULT_ITERATIONS, float tolerance=0.1f );
+
+	/**
+	 * Retrieve the latency of each iteration of the last Warmup() (in milliseconds).
+	 */
+	inline const std::vector<float>& GetWarmupCurve() const		{ return mWarmupCurve; }
+
+	/**
+	 * Returns true if the last Warmup() converged within its iterations.
+	 */
+	inline bool IsWarmedUp() const						{ return mWarmedUp; }
+
+	/**
+	 * Retrieve the breakdown of the time spent loading the network.
+	 */
+	inline const tensorLoadReport& GetLoadReport() const	{ return mLoadReport; }
+
+	/**
+	 * Print the breakdown of the time spent loading the network.
+	 */
+	void PrintLoadReport() const;
+
+	/**
+	 * Retrieve the device that each layer of the network was placed on when the engine
+	 * was built for the DLA (with GPU fallback, the layers that the DLA doesn't support
+	 * run on the GPU instead).  The placement is saved next to the engine cache.
+	 * @returns the layers, or an empty vector if the engine wasn't built for the DLA.
+	 */
+	inline const std::vector<layerPlacement>& GetLayerPlacement() const	{ return mLayerPlacement; }
+
+	/**
+	 * Retrieve the number of tensors that are passed between the DLA and GPU
+	 * (each of these transitions costs a synchronization and a copy).
+	 */
+	inline uint32_t GetLayerTransitions() const		{ return mLayerTransitions; }
+
+	/**
+	 * Retrieve the time spent in each layer of the engine, attributed to the
+	 * DLA or GPU by their placement (@see EnableLayerProfiler()).
+	 */
+	std::vector<layerTiming> GetLayerTimings() const;
+
+	/**
+	 * Print the layer placement, the DLA/GPU transitions, and the layer timings.
+	 */
+	void PrintLayerPlacement() const;
+
 	/**
 	 * Print the profiler times (in millseconds).
 	 */
@@ -390,11 +859,73 @@ protected:
 	 * @param modelStream output model stream
 	 */
 	bool ProfileModel( const std::string& deployFile, const std::string& modelFile,
-					const char* input, const Dims3& inputDims,
+					const std::vector<std::string>& inputs, const std::vector<Dims3>& inputDims,
 				    const std::vector<std::string>& outputs, uint32_t maxBatchSize, 
 				    precisionType precision, deviceType device, bool allowGPUFallback,
 				    nvinfer1::IInt8Calibrator* calibrator, std::ostream& modelStream);
 
+	/**
+	 * Benchmark the candidate precisions and devices, and select the fastest (used for TYPE_AUTOTUNE).
+	 */
+	bool autoTune( const char* prototxt_path, const char* model_path, const char* mean_path,
+				const std::vector<std::string>& input_blobs, const std::vector<Dims3>& input_dims, 
+				const std::vector<std::string>& output_blobs, uint32_t maxBatchSize, nvinfer1::IInt8Calibrator* calibrator,
+				precisionType* precision, deviceType* device, bool* allowGPUFallback );
+
+	/**
+	 * Load (or build) the engines of the engine set that are smaller than the max batch size,
+	 * after the engine for the max batch size was loaded and the bindings were allocated.
+	 */
+	bool loadEngineSet( const std::string& prototxt_path, const std::string& model_path,
+					const std::vector<std::string>& input_blobs, const std::vector<Dims3>& input_dims,
+					const std::vector<std::string>& output_blobs, precisionType precision,
+					deviceType device, bool allowGPUFallback, nvinfer1::IInt8Calibrator* calibrator );
+
+	/**
+	 * Select the execution context of the smallest engine that fits the batch.
+	 * The derived networks run their batches on it instead of mContext.
+	 */
+	nvinfer1::IExecutionContext* selectContext( uint32_t batchSize ) const;
+
+	/**
+	 * Gather the device memory of the inputs and outputs by their binding index in the engine.
+	 * @param bound if true, use the buffers bound by the caller where set, otherwise only the network's own
+	 */
+	void getBindings( std::vector<void*>& bindings, bool bound ) const;
+
+	/**
+	 * Convert the FP16 outputs of the batch to float in CPU memory, after the network has run.
+	 * This should be called by the derived networks before post-processing the outputs.
+	 * The whole batch of each FP16 output is expanded into its float copy (GetOutputBatch()),
+	 * which the post-processing reads instead of the half tensor.
+	 */
+	void convertOutputs( uint32_t batchSize );
+
+	/**
+	 * Append the outputs of the batch to the recording, if one is enabled (@see EnableRecording()).
+	 * This should be called by the derived networks after convertOutputs().
+	 */
+	void recordOutputs( uint32_t inputWidth, uint32_t inputHeight, uint32_t batchSize );
+
+	/**
+	 * Run the network on a synthetic input.
+	 * @param iterations number of timed runs (after warmup)
+	 * @param batchSize batch size to run (0 for the max batch size)
+	 * @param histogram optional histogram to add the time of each run to
+	 * @returns the average time per run in milliseconds, or a negative value on error.
+	 */
+	float benchmark( uint32_t iterations, uint32_t batchSize=0, profilerHistogram* histogram=NULL );
+
+	/**
+	 * Retrieve the input tensor (in CUDA memory) of an entry in the batch.
+	 */
+	inline float* GetInputBatch( uint32_t batchIndex ) const				{ return (float*)((uint8_t*)mInputCUDA + batchIndex * (mInputSize / mMaxBatchSize)); }
+
+	/**
+	 * Retrieve an output tensor (in CPU memory) of an entry in the batch.
+	 */
+	inline float* GetOutputBatch( uint32_t output, uint32_t batchIndex ) const	{ return mOutputs[output].CPU + batchIndex * mOutputs[output].volume; }
+
 	/**
 	 * Logger class for GIE info/warning/errors
 	 */
@@ -413,18 +944,58 @@ protected:
 	class Profiler : public nvinfer1::IProfiler
 	{
 	public:
-		Profiler() : timingAccumulator(0.0f)	{ }
+		Profiler() : timingAccumulator(0.0f), print(true)	{ }
 		
 		virtual void reportLayerTime(const char* layerName, float ms)
 		{
-			printf(LOG_TRT "layer %s - %f ms\n", layerName, ms);
+			if( print )
+				printf(LOG_TRT "layer %s - %f ms\n", layerName, ms);
+
 			timingAccumulator += ms;
+
+			// accumulate the layers in the order that the engine runs them
+			std::map<std::string, uint32_t>::iterator iter = layerIndex.find(layerName);
+
+			if( iter == layerIndex.end() )
+			{
+				layerTiming timing;
+
+				timing.name  = layerName;
+				timing.dla   = false;
+				timing.total = 0.0f;
+				timing.calls = 0;
+
+				iter = layerIndex.insert(std::make_pair(timing.name, (uint32_t)layers.size())).first;
+				layers.push_back(timing);
+			}
+
+			layers[iter->second].total += ms;
+			layers[iter->second].calls++;
 		}
 		
 		float timingAccumulator;
+		bool  print;
+
+		std::vector<layerTiming> layers;
+		std::map<std::string, uint32_t> layerIndex;
 		
 	} gProfiler;
 
+	/**
+	 * Per-request profiling state, allocated from a pool so that the events of a
+	 * request that's still running on the GPU aren't reused by the next one.
+	 */
+	struct profilerRecord
+	{
+		uint64_t    request;
+		uint32_t    queries;		// queries that were begun
+		uint32_t    ended;		// queries that were ended (and not begun again since)
+		uint32_t    collected;	// queries whose CUDA time was collected
+		cudaEvent_t eventsGPU[PROFILER_TOTAL * 2];
+		timespec    eventsCPU[PROFILER_TOTAL * 2];
+		float2      times[PROFILER_TOTAL];
+	};
+
 	/**
 	 * Begin a profiling query, before network is run
 	 */
@@ -433,11 +1004,30 @@ protected:
 		const uint32_t evt = query*2; 
 		const uint32_t flag = (1 << query);
 
-		CUDA(cudaEventRecord(mEventsGPU[evt], mStream)); 
-		timestamp(&mEventsCPU[evt]); 
+		// a new request starts with the pre-processing, or with the network when it's run
+		// again without pre-processing (i.e. ProcessBindings()) -- the later stages add to it
+		if( !mProfilerRecord || (query == PROFILER_PREPROCESS && mProfilerRecord->queries != 0) ||
+		    (query == PROFILER_NETWORK && (mProfilerRecord->queries & ~(flag - 1))) )
+		{
+			if( !beginProfilerRecord() )
+				return;
+		}
+
+		// a stage that already ran in this request keeps the CUDA event of its first run
+		if( mProfilerRecord->ended & flag )
+		{
+			mProfilerRecord->ended &= ~flag;
+			mProfilerRecord->collected &= ~flag;
+		}
+		else
+		{
+			CUDA(cudaEventRecord(mProfilerRecord->eventsGPU[evt], mStream)); 
+		}
+
+		timestamp(&mProfilerRecord->eventsCPU[evt]); 
 
+		mProfilerRecord->queries |= flag;
 		mProfilerQueriesUsed |= flag;
-		mProfilerQueriesDone &= ~flag;
 	}
 
 	/**
@@ -446,14 +1036,20 @@ protected:
 	inline void PROFILER_END( profilerQuery query )		
 	{ 
 		const uint32_t evt = query*2+1; 
+		const uint32_t flag = (1 << query);
 
-		CUDA(cudaEventRecord(mEventsGPU[evt])); 
-		timestamp(&mEventsCPU[evt]); 
+		if( !mProfilerRecord || !(mProfilerRecord->queries & flag) || (mProfilerRecord->ended & flag) )
+			return;
+
+		CUDA(cudaEventRecord(mProfilerRecord->eventsGPU[evt], mStream)); 
+		timestamp(&mProfilerRecord->eventsCPU[evt]); 
 		timespec cpuTime; 
-		timeDiff(mEventsCPU[evt-1], mEventsCPU[evt], &cpuTime);
-		mProfilerTimes[query].x = timeFloat(cpuTime);
+		timeDiff(mProfilerRecord->eventsCPU[evt-1], mProfilerRecord->eventsCPU[evt], &cpuTime);
+		mProfilerRecord->times[query].x += timeFloat(cpuTime);
+		mProfilerRecord->ended |= flag;
+		mProfilerTimes[query].x = mProfilerRecord->times[query].x;
 
-		if( mEnableProfiler && query == PROFILER_NETWORK ) 
+		if( mEnableProfiler && gProfiler.print && query == PROFILER_NETWORK ) 
 		{ 
 			printf(LOG_TRT "layer network time - %f ms\n", gProfiler.timingAccumulator); 
 			gProfiler.timingAccumulator = 0.0f; 
@@ -463,7 +1059,9 @@ protected:
 	}
 	
 	/**
-	 * Query the CUDA part of a profiler query.
+	 * Query the CUDA part of a profiler query.  The completed requests are collected
+	 * without waiting, except for the current one, which is waited on so that its
+	 * times are returned (the caller asked for them, so it's done with the request).
 	 */
 	inline bool PROFILER_QUERY( profilerQuery query )
 	{
@@ -487,24 +1085,58 @@ protected:
 		}
 		else if( mProfilerQueriesUsed & flag )
 		{
-			if( !(mProfilerQueriesDone & flag) )
-			{
-				const uint32_t evt = query*2;
-				float cuda_time = 0.0f;
-				CUDA(cudaEventElapsedTime(&cuda_time, mEventsGPU[evt], mEventsGPU[evt+1]));
-				mProfilerTimes[query].y = cuda_time;
-				mProfilerQueriesDone |= flag;
-				//mProfilerQueriesUsed &= ~flag;
-			}
-
+			collectProfilerRecords(true);
 			return true;
 		}
 
 		return false;
 	}
 
+	/**
+	 * Retire the current profiling record and start a new one (called by PROFILER_BEGIN).
+	 */
+	bool beginProfilerRecord();
+
+	/**
+	 * Collect the CUDA times of the requests that completed on the GPU, in order.
+	 * If wait is true, the current request is synchronized first.
+	 */
+	void collectProfilerRecords( bool wait=false );
+
+	/**
+	 * Collect the CUDA times of the queries of a record that have completed.
+	 * @returns true if every query that was ended has been collected.
+	 */
+	bool collectProfilerRecord( profilerRecord* record, bool wait );
+
 protected:
 
+	/**
+	 * Run one iteration of Warmup() on a synthetic RGBA image of the network's input size.
+	 * The default only runs the engine, and the derived networks override it to also run
+	 * their pre/post-processing the way that a real frame would.
+	 */
+	virtual bool warmupIteration( float* rgba, uint32_t width, uint32_t height );
+
+	/**
+	 * Retrieve the largest magnitude of the values that the pre-processing writes to the input
+	 * tensor, which is the dynamic range of an INT8 input binding (@see SetBindingPrecision()).
+	 * It's called while the network is loaded, after the model type is known, and has to match
+	 * the pre-processing that the network selects.  The default of 0 means the range isn't
+	 * known, and the input binding stays FP32 instead of INT8.
+	 */
+	virtual float inputRange() const;
+
+	/**
+	 * Path of a file that's saved next to the engine cache, with the given extension.
+	 */
+	std::string cacheSidecarPath( const char* extension ) const;
+
+	/**
+	 * Append the metrics of all the loaded networks (called by inferenceMetrics at scrape time).
+	 */
+	static void collectMetrics( std::string& output, void* user );
+
 	/* Member Variables */
 	std::string mPrototxtPath;
 	std::string mModelPath;
@@ -517,8 +1149,6 @@ protected:
 	precisionType mPrecision;
 	modelType     mModelType;
 	cudaStream_t  mStream;
-	cudaEvent_t   mEventsGPU[PROFILER_TOTAL * 2];
-	timespec      mEventsCPU[PROFILER_TOTAL * 2];
 
 	nvinfer1::IRuntime* mInfer;
 	nvinfer1::ICudaEngine* mEngine;
@@ -529,26 +1159,60 @@ protected:
 	uint32_t mInputSize;
 	float*   mInputCPU;
 	float*   mInputCUDA;
+	size_t   mEngineSize;
 	float2   mProfilerTimes[PROFILER_TOTAL + 1];
+	profilerHistogram mProfilerHistograms[PROFILER_TOTAL + 1][2];
+	tensorLoadReport mLoadReport;
+	tensorRecorder*  mRecorder;
+	std::vector<batchProfile> mBatchProfiles;
+	std::vector<layerPlacement> mLayerPlacement;
+	uint32_t mLayerTransitions;
+	std::vector<float> mWarmupCurve;
+	bool     mWarmedUp;
 	uint32_t mProfilerQueriesUsed;
-	uint32_t mProfilerQueriesDone;
+	uint64_t mProfilerRequest;
+	profilerRecord* mProfilerRecord;	// current request
+	std::vector<profilerRecord*> mProfilerRecords;	// every record in the pool
+	std::vector<profilerRecord*> mProfilerFree;
+	std::deque<profilerRecord*>  mProfilerPending;	// retired, waiting on the GPU
+	std::deque<profilerResult>   mProfilerResults;
 	uint32_t mMaxBatchSize;
 	bool	    mEnableProfiler;
 	bool     mEnableDebug;
 	bool	    mAllowGPUFallback;
+	bool     mBindingPrecisionSupported;	// set by derived networks that handle FP16/INT8 bindings
 
 	Dims3 mInputDims;
+
+	struct batchEngine
+	{
+		uint32_t batchSize;
+		size_t   size;		// size of the serialized engine
+		nvinfer1::ICudaEngine* engine;
+		nvinfer1::IExecutionContext* context;
+	};
+
+	std::vector<batchEngine> mEngineSet;	// the engines smaller than the max batch size (mEngine), in increasing order
+	std::vector<uint32_t> mEngineBatchSizes;	// batch sizes of mEngineSet followed by mMaxBatchSize
+	bool mEngineSetEnabled;			// false for the candidates of autoTune()
 	
-	struct outputLayer
+	struct layerBinding
 	{
 		std::string name;
 		Dims3 dims;
-		uint32_t size;
-		float* CPU;
+		uint32_t size;		// size of the binding in bytes (for the max batch size)
+		uint32_t volume;	// number of elements in one entry of the batch
+		precisionType type;	// data type of the binding (TYPE_FP32, TYPE_FP16 or TYPE_INT8)
+		float* CPU;		// for FP16 outputs, the float conversion of the mapped memory
 		float* CUDA;
+		void*  mapped;		// CPU address of the mapped memory (the same as CPU, except for FP16 outputs)
+		void*  binding;	// caller-owned memory bound with SetInputBinding() or SetOutputBinding()
+		int    index;		// binding index in the engine
 	};
 	
-	std::vector<outputLayer> mOutputs;
+	std::vector<layerBinding> mInputs;	// the first input is also accessible as mInputCPU/mInputCUDA
+	std::vector<layerBinding> mOutputs;
+	std::vector<void*> mBindings;		// indexed by the engine's binding index, used by ProcessBindings()
 };
 
 #endif
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "tensorNetBackend.h"
+#include "tensorNet.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+// constructor
+tensorNetBackend::tensorNetBackend()
+{
+	pthread_mutex_init(&mMutex, NULL);
+}
+
+
+// destructor
+tensorNetBackend::~tensorNetBackend()
+{
+	for( std::map<std::string, model>::iterator iter = mModels.begin(); iter != mModels.end(); iter++ )
+		unmapCache(&iter->second);
+
+	pthread_mutex_destroy(&mMutex);
+}
+
+
+// Register
+bool tensorNetBackend::Register( const char* name, LoadFunction function, void* user )
+{
+	if( !name || !function )
+		return false;
+
+	pthread_mutex_lock(&mMutex);
+
+	if( mModels.find(name) != mModels.end() )
+	{
+		printf(LOG_MODEL "'%s' is already registered\n", name);
+		pthread_mutex_unlock(&mMutex);
+		return false;
+	}
+
+	model m;
+
+	m.function  = function;
+	m.user      = user;
+	m.cache     = NULL;
+	m.cacheSize = 0;
+
+	mModels[name] = m;
+
+	pthread_mutex_unlock(&mMutex);
+	return true;
+}
+
+
+// unmapCache
+void tensorNetBackend::unmapCache( model* m )
+{
+	if( m->cache != NULL )
+		munmap(m->cache, m->cacheSize);
+
+	m->cache     = NULL;
+	m->cacheSize = 0;
+}
+
+
+// Load
+tensorNet* tensorNetBackend::Load( const char* name )
+{
+	pthread_mutex_lock(&mMutex);
+
+	std::map<std::string, model>::iterator iter = mModels.find(name);
+
+	if( iter == mModels.end() )
+	{
+		printf(LOG_MODEL "'%s' hasn't been registered\n", name);
+		pthread_mutex_unlock(&mMutex);
+		return NULL;
+	}
+
+	const LoadFunction function = iter->second.function;
+	void* user = iter->second.user;
+
+	pthread_mutex_unlock(&mMutex);
+
+	// the engine cache is read from the mapping (if any) while the network loads
+	tensorNet* network = function(name, user);
+
+	pthread_mutex_lock(&mMutex);
+
+	if( network != NULL )
+		unmapCache(&mModels[name]);
+
+	pthread_mutex_unlock(&mMutex);
+	return network;
+}
+
+
+// Unload
+void tensorNetBackend::Unload( const char* name, tensorNet* network )
+{
+	if( !network )
+		return;
+
+	const std::string cachePath = network->GetCacheEnginePath();
+	delete network;
+
+	if( cachePath.size() == 0 )
+		return;
+
+	// keep the serialized engine resident for a fast reload
+	const int fd = open(cachePath.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if( fd < 0 )
+		return;
+
+	struct stat info;
+	void* mapping = MAP_FAILED;
+
+	if( fstat(fd, &info) == 0 && info.st_size > 0 )
+		mapping = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+
+	close(fd);
+
+	if( mapping == MAP_FAILED )
+		return;
+
+	madvise(mapping, info.st_size, MADV_WILLNEED);
+
+	pthread_mutex_lock(&mMutex);
+
+	model* m = &mModels[name];
+
+	unmapCache(m);
+
+	m->cache     = mapping;
+	m->cacheSize = info.st_size;
+
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// GetMemoryUsage
+size_t tensorNetBackend::GetMemoryUsage( tensorNet* network )
+{
+	return (network != NULL) ? network->GetMemoryUsage() : 0;
+}
+
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __TENSOR_NET_BACKEND_H__
+#define __TENSOR_NET_BACKEND_H__
+
+
+#include "modelManager.h"
+
+#include <string>
+#include <map>
+
+
+/**
+ * modelBackend that creates networks with registered functions (i.e. a
+ * call to detectNet::Create() with the model's parameters).
+ *
+ * When a network is unloaded, its serialized engine cache stays mapped into
+ * memory, so that when it's loaded again the engine is read from the page
+ * cache instead of storage.  The mapping is released once the network is
+ * reloaded, since the engine is then held by TensorRT.
+ *
+ * @ingroup modelManager
+ */
+class tensorNetBackend : public modelBackend
+{
+public:
+	/**
+	 * Function that creates a network.
+	 */
+	typedef tensorNet* (*LoadFunction)( const char* name, void* user );
+
+	/**
+	 * Constructor.
+	 */
+	tensorNetBackend();
+
+	/**
+	 * Destructor, releasing the mapped engine caches.
+	 */
+	virtual ~tensorNetBackend();
+
+	/**
+	 * Register the function that creates a network.
+	 * @returns false if a model is already registered under the name.
+	 */
+	bool Register( const char* name, LoadFunction function, void* user=NULL );
+
+	/**
+	 * @see modelBackend::Load()
+	 */
+	virtual tensorNet* Load( const char* name );
+
+	/**
+	 * @see modelBackend::Unload()
+	 */
+	virtual void Unload( const char* name, tensorNet* network );
+
+	/**
+	 * @see modelBackend::GetMemoryUsage()
+	 */
+	virtual size_t GetMemoryUsage( tensorNet* network );
+
+protected:
+	struct model
+	{
+		LoadFunction function;
+		void*        user;
+		void*        cache;		// mapping of the engine cache while the network is unloaded
+		size_t       cacheSize;
+	};
+
+	void unmapCache( model* m );
+
+	std::map<std::string, model> mModels;
+	pthread_mutex_t mMutex;
+};
+
+
+#endif
@@ -0,0 +1,508 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "tensorRecord.h"
+
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+#ifndef LOG_TRT
+#define LOG_TRT "[TRT]   "
+#endif
+
+#define RECORD_MAGIC   "TENSREC"
+#define INDEX_MAGIC    "TENSIDX"
+#define RECORD_VERSION 1
+#define FRAME_MAGIC    0x4D524654	// 'TFRM'
+#define RECORD_ALIGN   16
+
+
+// header at the beginning of the data file
+struct recordHeader
+{
+	char     magic[8];
+	uint32_t version;
+	uint32_t headerSize;
+	uint64_t reserved[2];
+};
+
+// header at the beginning of the index
+struct indexHeader
+{
+	char     magic[8];
+	uint32_t version;
+	uint32_t reserved;
+};
+
+// header of each frame in the data file, followed by numTensors tensors
+struct frameHeader
+{
+	uint32_t magic;
+	uint32_t numTensors;
+	uint32_t inputWidth;
+	uint32_t inputHeight;
+	uint32_t batchSize;
+	uint32_t reserved;
+	uint64_t timestamp;
+	uint64_t size;		// size of the frame in bytes, including this header
+	uint64_t reserved2;
+};
+
+// header of each tensor, followed by its data (padded to RECORD_ALIGN)
+struct tensorHeader
+{
+	char     name[TENSOR_RECORD_MAX_NAME];
+	uint32_t dims[3];
+	uint32_t reserved;
+	uint64_t bytes;		// size of the data, without padding
+	uint64_t reserved2;
+};
+
+static_assert(sizeof(recordHeader) % RECORD_ALIGN == 0, "recordHeader must be aligned");
+static_assert(sizeof(frameHeader) % RECORD_ALIGN == 0, "frameHeader must be aligned");
+static_assert(sizeof(tensorHeader) % RECORD_ALIGN == 0, "tensorHeader must be aligned");
+
+
+// alignSize
+static inline uint64_t alignSize( uint64_t size )
+{
+	return (size + RECORD_ALIGN - 1) & ~(uint64_t)(RECORD_ALIGN - 1);
+}
+
+// indexPath
+static inline std::string indexPath( const std::string& path )
+{
+	return path + ".idx";
+}
+
+
+//-----------------------------------------------------------------------------
+// constructor
+tensorRecorder::tensorRecorder()
+{
+	mData      = NULL;
+	mIndex     = NULL;
+	mOffset    = 0;
+	mNumFrames = 0;
+}
+
+
+// destructor
+tensorRecorder::~tensorRecorder()
+{
+	if( mData != NULL )
+		fclose(mData);
+
+	if( mIndex != NULL )
+		fclose(mIndex);
+}
+
+
+// Open
+tensorRecorder* tensorRecorder::Open( const char* path )
+{
+	if( !path )
+		return NULL;
+
+	tensorRecorder* rec = new tensorRecorder();
+
+	rec->mPath = path;
+
+	// if the recording already exists, find the frames that were completed
+	std::vector<uint64_t> frames;
+	uint64_t end = sizeof(recordHeader);
+
+	struct stat st;
+
+	if( stat(path, &st) == 0 && st.st_size > 0 )
+	{
+		tensorRecording* existing = tensorRecording::Open(path);
+
+		if( !existing )
+		{
+			printf(LOG_TRT "tensorRecorder -- '%s' exists and isn't a recording, not overwriting it\n", path);
+			delete rec;
+			return NULL;
+		}
+
+		const uint32_t numFrames = existing->GetNumFrames();
+
+		for( uint32_t n=0; n < numFrames; n++ )
+			frames.push_back(existing->mFrames[n]);
+
+		if( numFrames > 0 )
+			end = frames[numFrames-1] + ((const frameHeader*)(existing->mData + frames[numFrames-1]))->size;
+
+		delete existing;
+
+		// drop a frame that was only partially written
+		if( (uint64_t)st.st_size > end && truncate(path, end) != 0 )
+		{
+			printf(LOG_TRT "tensorRecorder -- failed to truncate the incomplete frame at the end of '%s'\n", path);
+			delete rec;
+			return NULL;
+		}
+
+		rec->mData = fopen(path, "ab");
+	}
+	else
+	{
+		rec->mData = fopen(path, "wb");
+
+		if( rec->mData != NULL )
+		{
+			recordHeader header;
+			memset(&header, 0, sizeof(header));
+			memcpy(header.magic, RECORD_MAGIC, sizeof(header.magic));
+
+			header.version    = RECORD_VERSION;
+			header.headerSize = sizeof(recordHeader);
+
+			if( fwrite(&header, sizeof(header), 1, rec->mData) != 1 )
+			{
+				fclose(rec->mData);
+				rec->mData = NULL;
+			}
+		}
+	}
+
+	if( !rec->mData )
+	{
+		printf(LOG_TRT "tensorRecorder -- failed to open '%s' for writing\n", path);
+		delete rec;
+		return NULL;
+	}
+
+	// rewrite the index, so that it matches the data file
+	const std::string idxPath = indexPath(rec->mPath);
+
+	rec->mIndex = fopen(idxPath.c_str(), "wb");
+
+	if( !rec->mIndex )
+	{
+		printf(LOG_TRT "tensorRecorder -- failed to open '%s' for writing\n", idxPath.c_str());
+		delete rec;
+		return NULL;
+	}
+
+	indexHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+	header.version = RECORD_VERSION;
+
+	if( fwrite(&header, sizeof(header), 1, rec->mIndex) != 1 || 
+	    (frames.size() > 0 && fwrite(frames.data(), sizeof(uint64_t), frames.size(), rec->mIndex) != frames.size()) ||
+	    fflush(rec->mData) != 0 || fflush(rec->mIndex) != 0 )
+	{
+		printf(LOG_TRT "tensorRecorder -- failed to write '%s'\n", idxPath.c_str());
+		delete rec;
+		return NULL;
+	}
+
+	rec->mOffset    = end;
+	rec->mNumFrames = frames.size();
+
+	printf(LOG_TRT "tensorRecorder -- recording outputs to '%s' (%llu frames already recorded)\n", path, (unsigned long long)rec->mNumFrames);
+	return rec;
+}
+
+
+// Write
+bool tensorRecorder::Write( uint32_t inputWidth, uint32_t inputHeight, uint32_t batchSize,
+					   const tensorRecord* tensors, uint32_t numTensors )
+{
+	if( !tensors || numTensors == 0 || numTensors > TENSOR_RECORD_MAX_TENSORS || batchSize == 0 )
+	{
+		printf(LOG_TRT "tensorRecorder::Write() -- invalid parameters\n");
+		return false;
+	}
+
+	// determine the size of the frame
+	uint64_t size = sizeof(frameHeader);
+
+	for( uint32_t n=0; n < numTensors; n++ )
+	{
+		if( !tensors[n].data )
+		{
+			printf(LOG_TRT "tensorRecorder::Write() -- tensor %u has NULL data\n", n);
+			return false;
+		}
+
+		size += sizeof(tensorHeader) + alignSize((uint64_t)tensors[n].Volume() * batchSize * sizeof(float));
+	}
+
+	// write the frame header
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+
+	frameHeader frame;
+	memset(&frame, 0, sizeof(frame));
+
+	frame.magic       = FRAME_MAGIC;
+	frame.numTensors  = numTensors;
+	frame.inputWidth  = inputWidth;
+	frame.inputHeight = inputHeight;
+	frame.batchSize   = batchSize;
+	frame.timestamp   = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+	frame.size        = size;
+
+	bool success = (fwrite(&frame, sizeof(frame), 1, mData) == 1);
+
+	// write each tensor, followed by its data
+	static const uint8_t padding[RECORD_ALIGN] = {0};
+
+	for( uint32_t n=0; n < numTensors && success; n++ )
+	{
+		const uint64_t bytes = (uint64_t)tensors[n].Volume() * batchSize * sizeof(float);
+
+		tensorHeader header;
+		memset(&header, 0, sizeof(header));
+
+		if( tensors[n].name != NULL )
+			strncpy(header.name, tensors[n].name, sizeof(header.name) - 1);
+
+		memcpy(header.dims, tensors[n].dims, sizeof(header.dims));
+		header.bytes = bytes;
+
+		const size_t pad = alignSize(bytes) - bytes;
+
+		success = fwrite(&header, sizeof(header), 1, mData) == 1 &&
+			     fwrite(tensors[n].data, 1, bytes, mData) == bytes &&
+			     (pad == 0 || fwrite(padding, 1, pad, mData) == pad);
+	}
+
+	// the frame must reach the data file before it's added to the index
+	success = success && fflush(mData) == 0 &&
+		     fwrite(&mOffset, sizeof(uint64_t), 1, mIndex) == 1 &&
+		     fflush(mIndex) == 0;
+
+	if( !success )
+	{
+		printf(LOG_TRT "tensorRecorder::Write() -- failed to write frame %llu to '%s'\n", (unsigned long long)mNumFrames, mPath.c_str());
+		return false;
+	}
+
+	mOffset += size;
+	mNumFrames++;
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// constructor
+tensorRecording::tensorRecording()
+{
+	mData = NULL;
+	mSize = 0;
+}
+
+
+// destructor
+tensorRecording::~tensorRecording()
+{
+	if( mData != NULL )
+		munmap((void*)mData, mSize);
+}
+
+
+// Open
+tensorRecording* tensorRecording::Open( const char* path )
+{
+	if( !path )
+		return NULL;
+
+	const int fd = open(path, O_RDONLY);
+
+	if( fd < 0 )
+	{
+		printf(LOG_TRT "tensorRecording -- failed to open '%s'\n", path);
+		return NULL;
+	}
+
+	struct stat st;
+
+	if( fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(recordHeader) )
+	{
+		printf(LOG_TRT "tensorRecording -- '%s' is too small to be a recording\n", path);
+		close(fd);
+		return NULL;
+	}
+
+	void* data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if( data == MAP_FAILED )
+	{
+		printf(LOG_TRT "tensorRecording -- failed to map '%s'\n", path);
+		return NULL;
+	}
+
+	tensorRecording* rec = new tensorRecording();
+
+	rec->mPath = path;
+	rec->mData = (const uint8_t*)data;
+	rec->mSize = st.st_size;
+
+	const recordHeader* header = (const recordHeader*)rec->mData;
+
+	if( memcmp(header->magic, RECORD_MAGIC, sizeof(header->magic)) != 0 || header->version != RECORD_VERSION || header->headerSize != sizeof(recordHeader) )
+	{
+		printf(LOG_TRT "tensorRecording -- '%s' isn't a recording, or is from a different version\n", path);
+		delete rec;
+		return NULL;
+	}
+
+	// find the frames from the index, then scan for any that it's missing
+	if( !rec->readIndex() )
+		printf(LOG_TRT "tensorRecording -- the index of '%s' is missing or invalid, scanning the frames\n", path);
+
+	rec->scanFrames();
+	return rec;
+}
+
+
+// readIndex
+bool tensorRecording::readIndex()
+{
+	FILE* file = fopen(indexPath(mPath).c_str(), "rb");
+
+	if( !file )
+		return false;
+
+	indexHeader header;
+
+	if( fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0 || header.version != RECORD_VERSION )
+	{
+		fclose(file);
+		return false;
+	}
+
+	uint64_t offset = 0;
+
+	while( fread(&offset, sizeof(offset), 1, file) == 1 )
+	{
+		// the frames must follow each other, so a stale index is detected
+		const uint64_t expected = mFrames.empty() ? sizeof(recordHeader) : mFrames.back() + ((const frameHeader*)(mData + mFrames.back()))->size;
+
+		if( offset != expected || !validFrame(offset) )
+			break;
+
+		mFrames.push_back(offset);
+	}
+
+	fclose(file);
+	return true;
+}
+
+
+// scanFrames
+bool tensorRecording::scanFrames()
+{
+	uint64_t offset = mFrames.empty() ? sizeof(recordHeader) : mFrames.back() + ((const frameHeader*)(mData + mFrames.back()))->size;
+
+	while( validFrame(offset) )
+	{
+		mFrames.push_back(offset);
+		offset += ((const frameHeader*)(mData + offset))->size;
+	}
+
+	return true;
+}
+
+
+// validFrame
+bool tensorRecording::validFrame( uint64_t offset ) const
+{
+	if( offset % RECORD_ALIGN != 0 || offset + sizeof(frameHeader) > mSize )
+		return false;
+
+	const frameHeader* frame = (const frameHeader*)(mData + offset);
+
+	if( frame->magic != FRAME_MAGIC || frame->numTensors == 0 || frame->numTensors > TENSOR_RECORD_MAX_TENSORS || frame->batchSize == 0 )
+		return false;
+
+	if( frame->size < sizeof(frameHeader) || frame->size % RECORD_ALIGN != 0 || frame->size > mSize - offset )
+		return false;
+
+	// check that the tensors lie within the frame
+	uint64_t tensorOffset = sizeof(frameHeader);
+
+	for( uint32_t n=0; n < frame->numTensors; n++ )
+	{
+		if( tensorOffset + sizeof(tensorHeader) > frame->size )
+			return false;
+
+		const tensorHeader* tensor = (const tensorHeader*)(mData + offset + tensorOffset);
+		const uint64_t volume = (uint64_t)tensor->dims[0] * tensor->dims[1] * tensor->dims[2];
+
+		if( tensor->bytes > frame->size || tensor->bytes != volume * frame->batchSize * sizeof(float) || tensor->name[TENSOR_RECORD_MAX_NAME-1] != 0 )
+			return false;
+
+		tensorOffset += sizeof(tensorHeader) + alignSize(tensor->bytes);
+
+		if( tensorOffset > frame->size )
+			return false;
+	}
+
+	return tensorOffset == frame->size;
+}
+
+
+// GetFrame
+bool tensorRecording::GetFrame( uint32_t index, tensorFrame* frame ) const
+{
+	if( index >= mFrames.size() || !frame )
+		return false;
+
+	const uint64_t offset = mFrames[index];
+	const frameHeader* header = (const frameHeader*)(mData + offset);
+
+	frame->timestamp   = header->timestamp;
+	frame->inputWidth  = header->inputWidth;
+	frame->inputHeight = header->inputHeight;
+	frame->batchSize   = header->batchSize;
+	frame->numTensors  = header->numTensors;
+
+	uint64_t tensorOffset = offset + sizeof(frameHeader);
+
+	for( uint32_t n=0; n < header->numTensors; n++ )
+	{
+		const tensorHeader* tensor = (const tensorHeader*)(mData + tensorOffset);
+
+		frame->tensors[n].name = tensor->name;
+		frame->tensors[n].data = (const float*)(mData + tensorOffset + sizeof(tensorHeader));
+
+		memcpy(frame->tensors[n].dims, tensor->dims, sizeof(tensor->dims));
+
+		tensorOffset += sizeof(tensorHeader) + alignSize(tensor->bytes);
+	}
+
+	return true;
+}
+
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __TENSOR_RECORD_H__
+#define __TENSOR_RECORD_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+
+/**
+ * Maximum number of output tensors that can be recorded per frame.
+ * @ingroup tensorNet
+ */
+#define TENSOR_RECORD_MAX_TENSORS 8
+
+/**
+ * Maximum length of a tensor name (including the NULL terminator) kept in a recording.
+ * @ingroup tensorNet
+ */
+#define TENSOR_RECORD_MAX_NAME 48
+
+
+/**
+ * One output tensor of a recorded frame, with the entries of the whole batch.
+ * The data is single-precision, in the same layout as tensorNet's outputs in CPU memory.
+ * @ingroup tensorNet
+ */
+struct tensorRecord
+{
+	const char*  name;		/**< name of the output layer */
+	const float* data;		/**< batchSize * Volume() elements */
+	uint32_t     dims[3];	/**< CHW dimensions of one entry of the batch */
+
+	/** Number of elements in one entry of the batch */
+	inline uint32_t Volume() const	{ return dims[0] * dims[1] * dims[2]; }
+};
+
+
+/**
+ * The outputs of the network for one frame, as read from a tensorRecording.
+ * The tensors point directly into the memory-mapped file.
+ * @ingroup tensorNet
+ */
+struct tensorFrame
+{
+	uint64_t timestamp;		/**< CLOCK_REALTIME of the recording, in nanoseconds */
+	uint32_t inputWidth;	/**< width of the image that the network processed */
+	uint32_t inputHeight;	/**< height of the image that the network processed */
+	uint32_t batchSize;		/**< number of entries in the batch */
+	uint32_t numTensors;	/**< number of output tensors */
+
+	tensorRecord tensors[TENSOR_RECORD_MAX_TENSORS];
+};
+
+
+/**
+ * Append-only recorder of the raw output tensors of a network, one frame at a time
+ * (@see tensorNet::EnableRecording()).  Together with tensorRecording, this allows
+ * the post-processing of field data to be replayed and profiled offline.
+ *
+ * The recording consists of two files:
+ *
+ *   - the data file at the path given, with a small header followed by the frames.
+ *     Each frame is a header with the input dimensions and batch size, then each
+ *     tensor's name and dimensions followed by its data.  Every part is 16-byte
+ *     aligned, so the file can be memory-mapped and read in place.
+ *
+ *   - the index at the same path plus ".idx", with the file offset of each frame.
+ *
+ * A frame is written to the data file before its offset is appended to the index,
+ * so a recording interrupted at any point can still be read up to the last frame
+ * that was completed.  Opening an existing recording continues appending to it.
+ * The values are stored in the byte order of the recording device (little-endian
+ * on Jetson and x86).  This file doesn't depend on CUDA or TensorRT.
+ * @ingroup tensorNet
+ */
+class tensorRecorder
+{
+public:
+	/**
+	 * Create or open a recording to append frames to.
+	 * @returns the recorder, or NULL on error.
+	 */
+	static tensorRecorder* Open( const char* path );
+
+	/**
+	 * Destructor (flushes and closes the files).
+	 */
+	~tensorRecorder();
+
+	/**
+	 * Append the output tensors of a frame.
+	 * @param inputWidth width of the image the network processed
+	 * @param inputHeight height of the image the network processed
+	 * @param batchSize number of entries in the batch (each tensor holds batchSize entries)
+	 * @param tensors the output tensors
+	 * @param numTensors number of output tensors (up to TENSOR_RECORD_MAX_TENSORS)
+	 */
+	bool Write( uint32_t inputWidth, uint32_t inputHeight, uint32_t batchSize,
+			  const tensorRecord* tensors, uint32_t numTensors );
+
+	/**
+	 * Retrieve the number of frames in the recording (including any that were there before it was opened).
+	 */
+	inline uint64_t GetNumFrames() const		{ return mNumFrames; }
+
+	/**
+	 * Retrieve the path of the data file.
+	 */
+	inline const char* GetPath() const			{ return mPath.c_str(); }
+
+protected:
+	tensorRecorder();
+
+	FILE* mData;
+	FILE* mIndex;
+
+	std::string mPath;
+	uint64_t    mOffset;		// size of the data file
+	uint64_t    mNumFrames;
+};
+
+
+/**
+ * Reader of a recording made by tensorRecorder.  The data file is memory-mapped,
+ * and the frames are read in place without copying.
+ * If the index is missing or shorter than the data file (for example when the
+ * recording was copied while it was being made), the frames are found by scanning
+ * the data file instead.
+ * @ingroup tensorNet
+ */
+class tensorRecording
+{
+public:
+	/**
+	 * Open a recording for reading.
+	 * @returns the recording, or NULL on error.
+	 */
+	static tensorRecording* Open( const char* path );
+
+	/**
+	 * Destructor (unmaps the file).
+	 */
+	~tensorRecording();
+
+	/**
+	 * Retrieve the number of complete frames in the recording.
+	 */
+	inline uint32_t GetNumFrames() const		{ return mFrames.size(); }
+
+	/**
+	 * Retrieve a frame.  The tensors remain valid until the recording is closed.
+	 */
+	bool GetFrame( uint32_t index, tensorFrame* frame ) const;
+
+	/**
+	 * Retrieve the path of the data file.
+	 */
+	inline const char* GetPath() const			{ return mPath.c_str(); }
+
+protected:
+	friend class tensorRecorder;
+
+	tensorRecording();
+
+	bool readIndex();
+	bool scanFrames();
+	bool validFrame( uint64_t offset ) const;
+
+	std::string mPath;
+	std::vector<uint64_t> mFrames;	// file offset of each frame
+
+	const uint8_t* mData;
+	uint64_t       mSize;
+};
+
+#endif
@@ -0,0 +1,637 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "threadConfig.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+
+// the configuration of each stage, and the threads that applied them
+struct threadStage
+{
+	std::string  stage;
+	threadConfig config;
+};
+
+struct threadRecord
+{
+	std::string  stage;
+	pid_t        tid;
+	threadConfig requested;
+	threadConfig effective;
+	bool         success;
+};
+
+static pthread_mutex_t gThreadMutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<threadStage>  gThreadStages;
+static std::vector<threadRecord> gThreadRecords;
+
+
+// thread ID of the calling thread
+static inline pid_t currentThreadID()
+{
+	return (pid_t)syscall(SYS_gettid);
+}
+
+
+// policyFromStr
+static int policyFromStr( const char* str )
+{
+	if( strcasecmp(str, "other") == 0 || strcasecmp(str, "default") == 0 )
+		return SCHED_OTHER;
+	else if( strcasecmp(str, "batch") == 0 )
+		return SCHED_BATCH;
+	else if( strcasecmp(str, "idle") == 0 )
+		return SCHED_IDLE;
+	else if( strcasecmp(str, "fifo") == 0 )
+		return SCHED_FIFO;
+	else if( strcasecmp(str, "rr") == 0 )
+		return SCHED_RR;
+
+	return -1;
+}
+
+
+// policyToStr
+static const char* policyToStr( int policy )
+{
+	switch(policy)
+	{
+		case SCHED_OTHER:	return "other";
+		case SCHED_BATCH:	return "batch";
+		case SCHED_IDLE:	return "idle";
+		case SCHED_FIFO:	return "fifo";
+		case SCHED_RR:		return "rr";
+	}
+
+	return "unknown";
+}
+
+
+// parseInt
+static bool parseInt( const char* str, int* value )
+{
+	char* end = NULL;
+	const long v = strtol(str, &end, 10);
+
+	if( end == str || *end != 0 )
+		return false;
+
+	*value = (int)v;
+	return true;
+}
+
+
+// parseCores (i.e. "2,4-5")
+static bool parseCores( const char* str, std::vector<int>& cores )
+{
+	std::vector<int> list;
+
+	while( *str != 0 )
+	{
+		char* end = NULL;
+		const long first = strtol(str, &end, 10);
+
+		if( end == str || first < 0 || first >= CPU_SETSIZE )
+			return false;
+
+		long last = first;
+		str = end;
+
+		if( *str == '-' )
+		{
+			last = strtol(str + 1, &end, 10);
+
+			if( end == str + 1 || last < first || last >= CPU_SETSIZE )
+				return false;
+
+			str = end;
+		}
+
+		for( long n=first; n <= last; n++ )
+			list.push_back(n);
+
+		if( *str == ',' )
+			str++;
+		else if( *str != 0 )
+			return false;
+	}
+
+	if( list.size() == 0 )
+		return false;
+
+	cores = list;
+	return true;
+}
+
+
+// coresToStr (i.e. "2,4-5")
+static std::string coresToStr( const std::vector<int>& cores )
+{
+	std::string str;
+	char buffer[32];
+
+	for( size_t n=0; n < cores.size(); )
+	{
+		size_t end = n;
+
+		while( end + 1 < cores.size() && cores[end+1] == cores[end] + 1 )
+			end++;
+
+		if( end > n )
+			sprintf(buffer, "%s%i-%i", str.empty() ? "" : ",", cores[n], cores[end]);
+		else
+			sprintf(buffer, "%s%i", str.empty() ? "" : ",", cores[n]);
+
+		str += buffer;
+		n = end + 1;
+	}
+
+	return str;
+}
+
+
+// constructor
+threadConfig::threadConfig()
+{
+	policy   = -1;
+	priority = 0;
+	nice     = 0;
+	hasNice  = false;
+}
+
+
+// Parse
+bool threadConfig::Parse( const char* spec )
+{
+	if( !spec )
+		return false;
+
+	std::string str = spec;
+
+	for( size_t n=0; n < str.size(); n++ )
+	{
+		if( str[n] == ';' || isspace(str[n]) )
+			str[n] = ' ';
+	}
+
+	char* save = NULL;
+	char* token = strtok_r((char*)str.c_str(), " ", &save);
+
+	while( token != NULL )
+	{
+		char* value = strchr(token, '=');
+
+		if( !value )
+		{
+			printf(LOG_THREAD "invalid setting '%s' (expected KEY=VALUE)\n", token);
+			return false;
+		}
+
+		*value++ = 0;
+		bool valid = true;
+
+		if( strcasecmp(token, "name") == 0 )
+		{
+			name = std::string(value).substr(0, 15);	// limit of the kernel
+		}
+		else if( strcasecmp(token, "cores") == 0 || strcasecmp(token, "cpus") == 0 )
+		{
+			valid = parseCores(value, cores);
+		}
+		else if( strcasecmp(token, "policy") == 0 )
+		{
+			policy = policyFromStr(value);
+			valid  = (policy >= 0);
+		}
+		else if( strcasecmp(token, "priority") == 0 )
+		{
+			valid = parseInt(value, &priority) && priority >= 0 && priority <= 99;
+
+			if( valid && policy < 0 && priority > 0 )
+				policy = SCHED_FIFO;	// a priority implies a real-time policy
+		}
+		else if( strcasecmp(token, "nice") == 0 )
+		{
+			valid   = parseInt(value, &nice) && nice >= -20 && nice <= 19;
+			hasNice = valid;
+		}
+		else
+		{
+			printf(LOG_THREAD "unknown setting '%s'\n", token);
+			return false;
+		}
+
+		if( !valid )
+		{
+			printf(LOG_THREAD "invalid value '%s' of setting '%s'\n", value, token);
+			return false;
+		}
+
+		token = strtok_r(NULL, " ", &save);
+	}
+
+	if( (policy == SCHED_FIFO || policy == SCHED_RR) && priority == 0 )
+	{
+		printf(LOG_THREAD "the %s policy needs a priority between 1 and 99\n", policyToStr(policy));
+		return false;
+	}
+
+	return true;
+}
+
+
+// ToString
+std::string threadConfig::ToString() const
+{
+	std::string str;
+	char buffer[64];
+
+	if( !name.empty() )
+		str += "name=" + name + " ";
+
+	if( !cores.empty() )
+		str += "cores=" + coresToStr(cores) + " ";
+
+	if( policy >= 0 )
+	{
+		str += std::string("policy=") + policyToStr(policy) + " ";
+
+		if( policy == SCHED_FIFO || policy == SCHED_RR )
+		{
+			sprintf(buffer, "priority=%i ", priority);
+			str += buffer;
+		}
+	}
+
+	if( hasNice )
+	{
+		sprintf(buffer, "nice=%i ", nice);
+		str += buffer;
+	}
+
+	if( str.empty() )
+		return "(unchanged)";
+
+	str.erase(str.size() - 1);
+	return str;
+}
+
+
+// Apply
+bool threadConfig::Apply() const
+{
+	bool success = true;
+	int  result  = 0;
+
+	if( !name.empty() && (result = pthread_setname_np(pthread_self(), name.c_str())) != 0 )
+	{
+		printf(LOG_THREAD "failed to set the thread name to '%s' (%s)\n", name.c_str(), strerror(result));
+		success = false;
+	}
+
+	if( !cores.empty() )
+	{
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+
+		for( size_t n=0; n < cores.size(); n++ )
+			CPU_SET(cores[n], &cpus);
+
+		if( (result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus)) != 0 )
+		{
+			printf(LOG_THREAD "failed to pin the thread to cores %s (%s)\n", coresToStr(cores).c_str(), strerror(result));
+			success = false;
+		}
+	}
+
+	if( policy >= 0 )
+	{
+		struct sched_param param;
+		memset(&param, 0, sizeof(param));
+
+		if( policy == SCHED_FIFO || policy == SCHED_RR )
+			param.sched_priority = priority;
+
+		if( (result = pthread_setschedparam(pthread_self(), policy, &param)) != 0 )
+		{
+			printf(LOG_THREAD "failed to set the %s policy with priority %i (%s)%s\n", policyToStr(policy), param.sched_priority, strerror(result),
+				  (result == EPERM) ? " -- this requires CAP_SYS_NICE or an rtprio limit" : "");
+			success = false;
+		}
+	}
+
+	if( hasNice && setpriority(PRIO_PROCESS, currentThreadID(), nice) != 0 )
+	{
+		printf(LOG_THREAD "failed to set the nice value to %i (%s)%s\n", nice, strerror(errno),
+			  (errno == EACCES || errno == EPERM) ? " -- negative values require CAP_SYS_NICE or a nice limit" : "");
+		success = false;
+	}
+
+	return success;
+}
+
+
+// Current
+threadConfig threadConfig::Current()
+{
+	threadConfig config;
+
+	char name[16] = {0};
+
+	if( pthread_getname_np(pthread_self(), name, sizeof(name)) == 0 )
+		config.name = name;
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+
+	if( pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0 )
+	{
+		for( int n=0; n < CPU_SETSIZE; n++ )
+		{
+			if( CPU_ISSET(n, &cpus) )
+				config.cores.push_back(n);
+		}
+	}
+
+	struct sched_param param;
+
+	if( pthread_getschedparam(pthread_self(), &config.policy, &param) == 0 )
+		config.priority = param.sched_priority;
+	else
+		config.policy = -1;
+
+	errno = 0;
+	const int nice = getpriority(PRIO_PROCESS, currentThreadID());
+
+	if( errno == 0 )
+	{
+		config.nice    = nice;
+		config.hasNice = true;
+	}
+
+	return config;
+}
+
+
+// SetStage
+void threadConfig::SetStage( const char* stage, const threadConfig& config )
+{
+	if( !stage )
+		return;
+
+	pthread_mutex_lock(&gThreadMutex);
+
+	size_t n = 0;
+
+	while( n < gThreadStages.size() && strcasecmp(gThreadStages[n].stage.c_str(), stage) != 0 )
+		n++;
+
+	if( n == gThreadStages.size() )
+	{
+		gThreadStages.push_back(threadStage());
+		gThreadStages[n].stage = stage;
+	}
+
+	gThreadStages[n].config = config;
+
+	pthread_mutex_unlock(&gThreadMutex);
+}
+
+
+// GetStage
+bool threadConfig::GetStage( const char* stage, threadConfig* config )
+{
+	if( !stage )
+		return false;
+
+	bool found = false;
+
+	pthread_mutex_lock(&gThreadMutex);
+
+	for( size_t n=0; n < gThreadStages.size(); n++ )
+	{
+		if( strcasecmp(gThreadStages[n].stage.c_str(), stage) == 0 )
+		{
+			if( config != NULL )
+				*config = gThreadStages[n].config;
+
+			found = true;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&gThreadMutex);
+	return found;
+}
+
+
+// LoadFile
+bool threadConfig::LoadFile( const char* path )
+{
+	if( !path )
+		return false;
+
+	FILE* file = fopen(path, "r");
+
+	if( !file )
+	{
+		printf(LOG_THREAD "failed to open config file '%s'\n", path);
+		return false;
+	}
+
+	char line[512];
+	int  lineNumber = 0;
+	bool success = true;
+
+	while( fgets(line, sizeof(line), file) != NULL )
+	{
+		lineNumber++;
+
+		// strip comments
+		char* comment = strchr(line, '#');
+
+		if( comment != NULL )
+			*comment = 0;
+
+		// the first word is the stage, and the rest is the specification
+		char* stage = line;
+
+		while( isspace(*stage) )
+			stage++;
+
+		if( *stage == 0 )
+			continue;
+
+		char* spec = stage;
+
+		while( *spec != 0 && !isspace(*spec) )
+			spec++;
+
+		if( *spec != 0 )
+			*spec++ = 0;
+
+		threadConfig config;
+		GetStage(stage, &config);
+
+		if( !config.Parse(spec) )
+		{
+			printf(LOG_THREAD "invalid configuration of stage '%s' on line %i of '%s'\n", stage, lineNumber, path);
+			success = false;
+			continue;
+		}
+
+		SetStage(stage, config);
+	}
+
+	fclose(file);
+	return success;
+}
+
+
+// ParseArgs
+bool threadConfig::ParseArgs( int argc, char** argv )
+{
+	bool success = true;
+
+	// the config file is loaded first, so the flags can override it
+	for( int n=1; n < argc; n++ )
+	{
+		const char* arg = argv[n];
+
+		if( strncmp(arg, "--threads=", 10) == 0 && !LoadFile(arg + 10) )
+			success = false;
+	}
+
+	for( int n=1; n < argc; n++ )
+	{
+		const char* arg = argv[n];
+
+		if( strncmp(arg, "--thread-", 9) != 0 && strncmp(arg, "--thread_", 9) != 0 )
+			continue;
+
+		const char* value = strchr(arg, '=');
+
+		if( !value || value == arg + 9 )
+		{
+			printf(LOG_THREAD "invalid argument '%s' (expected --thread-STAGE=SPEC)\n", arg);
+			success = false;
+			continue;
+		}
+
+		const std::string stage(arg + 9, value - (arg + 9));
+
+		threadConfig config;
+		GetStage(stage.c_str(), &config);
+
+		if( !config.Parse(value + 1) )
+		{
+			printf(LOG_THREAD "invalid configuration of stage '%s' in '%s'\n", stage.c_str(), arg);
+			success = false;
+			continue;
+		}
+
+		SetStage(stage.c_str(), config);
+	}
+
+	return success;
+}
+
+
+// ApplyStage
+bool threadConfig::ApplyStage( const char* stage, const char* name )
+{
+	if( !stage )
+		return false;
+
+	threadConfig config;
+	GetStage(stage, &config);
+
+	if( config.name.empty() && name != NULL )
+		config.name = std::string(name).substr(0, 15);
+
+	threadRecord record;
+
+	record.stage     = stage;
+	record.tid       = currentThreadID();
+	record.requested = config;
+	record.success   = config.Apply();
+	record.effective = Current();
+
+	printf(LOG_THREAD "%s thread %i -- %s%s\n", stage, (int)record.tid, record.effective.ToString().c_str(), record.success ? "" : " (not all settings were applied)");
+
+	pthread_mutex_lock(&gThreadMutex);
+	gThreadRecords.push_back(record);
+	pthread_mutex_unlock(&gThreadMutex);
+
+	return record.success;
+}
+
+
+// Report
+void threadConfig::Report()
+{
+	pthread_mutex_lock(&gThreadMutex);
+
+	printf(LOG_THREAD "----------------------------------------------\n");
+	printf(LOG_THREAD "Thread Configuration\n");
+	printf(LOG_THREAD "----------------------------------------------\n");
+
+	const long numCores = sysconf(_SC_NPROCESSORS_ONLN);
+
+	for( size_t n=0; n < gThreadRecords.size(); n++ )
+	{
+		const threadRecord& r = gThreadRecords[n];
+		const threadConfig& e = r.effective;
+
+		printf(LOG_THREAD "%-10s tid %-7i name %-15s cores %-10s policy %-5s priority %-3i nice %-3i%s\n",
+			  r.stage.c_str(), (int)r.tid, e.name.c_str(), 
+			  ((long)e.cores.size() >= numCores) ? "all" : coresToStr(e.cores).c_str(),
+			  policyToStr(e.policy), e.priority, e.nice, r.success ? "" : "  (failed)");
+
+		if( !r.success )
+			printf(LOG_THREAD "%-10s requested %s\n", "", r.requested.ToString().c_str());
+	}
+
+	if( gThreadRecords.size() == 0 )
+		printf(LOG_THREAD "no threads were configured\n");
+
+	printf(LOG_THREAD "----------------------------------------------\n\n");
+
+	pthread_mutex_unlock(&gThreadMutex);
+}
+
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __THREAD_CONFIG_H__
+#define __THREAD_CONFIG_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+/**
+ * Prefix used for logging thread configuration messages.
+ * @ingroup threadConfig
+ */
+#define LOG_THREAD "[thread] "
+
+
+/**
+ * Scheduling settings of a thread -- its name, the cores it's pinned to, its
+ * scheduling policy and real-time priority, and its nice value.  The settings
+ * that aren't specified are left unchanged when the configuration is applied.
+ *
+ * Each kind of thread (the stage of the pipeline it runs) is configured by
+ * name, from a config file (--threads=FILE) or flags (--thread-STAGE=SPEC),
+ * and applies its configuration when it starts with threadConfig::ApplyStage().
+ * A specification is a list of settings, separated by spaces or semicolons:
+ *
+ *    cores=4-5        cores to pin the thread to (i.e. 2,4-5)
+ *    policy=fifo      scheduling policy: other, batch, idle, fifo or rr
+ *    priority=80      real-time priority (1-99) of the fifo and rr policies
+ *    nice=-5          nice value (-20 to 19) of the other and batch policies
+ *    name=infer       name of the thread (up to 15 characters)
+ *
+ * The config file has one stage per line followed by its specification, for example:
+ *
+ *    # stage      settings
+ *    inference    cores=4-5 policy=fifo priority=80 name=infer
+ *    scheduler    cores=3 policy=rr priority=60
+ *    pipeline     cores=2 nice=-10
+ *
+ * The stages used by this project are "pipeline" (the main loop of the camera
+ * apps), "inference" (the network threads of trt-bench),
+ * "scheduler" (the request batcher of inference-daemon), "dag" (the stream
+ * threads of dagExecutor), "decode" and "writer" (the workers of decodePool and
+ * imageWriter) and "bench" and "load" (jitter-bench).
+ *
+ * Real-time policies and negative nice values require CAP_SYS_NICE (or an
+ * rtprio/nice limit in /etc/security/limits.conf).  A setting that fails is
+ * reported and skipped, and the thread keeps running with the other settings.
+ * This file doesn't depend on CUDA or TensorRT.
+ * @ingroup threadConfig
+ */
+struct threadConfig
+{
+	/**
+	 * Constructor (all of the settings are left unchanged).
+	 */
+	threadConfig();
+
+	/**
+	 * Parse a specification of settings, on top of the current ones.
+	 * @returns false if the specification is invalid.
+	 */
+	bool Parse( const char* spec );
+
+	/**
+	 * Apply the settings to the calling thread.
+	 * @returns false if a setting couldn't be applied (the others still are).
+	 */
+	bool Apply() const;
+
+	/**
+	 * Describe the settings (i.e. "name=infer cores=4-5 policy=fifo priority=80").
+	 */
+	std::string ToString() const;
+
+	/**
+	 * Retrieve the effective settings of the calling thread.
+	 */
+	static threadConfig Current();
+
+	/**
+	 * Set the configuration of a stage, replacing any previous one.
+	 */
+	static void SetStage( const char* stage, const threadConfig& config );
+
+	/**
+	 * Retrieve the configuration of a stage.
+	 * @returns false if the stage isn't configured.
+	 */
+	static bool GetStage( const char* stage, threadConfig* config );
+
+	/**
+	 * Load the configuration of the stages from a file.
+	 */
+	static bool LoadFile( const char* path );
+
+	/**
+	 * Configure the stages from the command line -- a config file from --threads=FILE,
+	 * then each --thread-STAGE=SPEC on top of it.  The other arguments are ignored.
+	 * @returns false if the file or a specification is invalid.
+	 */
+	static bool ParseArgs( int argc, char** argv );
+
+	/**
+	 * Apply the configuration of a stage to the calling thread, and record the effective
+	 * settings for Report().  Threads should call this when they start.
+	 * @param stage the stage that the thread runs
+	 * @param name name to give the thread if the configuration doesn't have one (or NULL)
+	 * @returns false if a setting couldn't be applied.
+	 */
+	static bool ApplyStage( const char* stage, const char* name=NULL );
+
+	/**
+	 * Print the effective settings of each thread that called ApplyStage().
+	 */
+	static void Report();
+
+	std::string name;			/**< thread name (empty to leave unchanged) */
+	std::vector<int> cores;		/**< cores to pin to (empty to leave unchanged) */
+	int  policy;				/**< SCHED_OTHER, SCHED_BATCH, SCHED_IDLE, SCHED_FIFO or SCHED_RR (-1 to leave unchanged) */
+	int  priority;				/**< real-time priority of SCHED_FIFO and SCHED_RR */
+	int  nice;				/**< nice value (only applied if hasNice is set) */
+	bool hasNice;				/**< true if the nice value is set */
+};
+
+#endif
@@ -0,0 +1,938 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#include "videoFile.h"
+
+#include "cudaMappedMemory.h"
+
+#include <string.h>
+#include <strings.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+
+
+#define VIDEO_DUMP_MAGIC   "RGBADUMP"
+#define VIDEO_DUMP_VERSION 1
+
+#define VIDEO_SOURCE_BUFFERS 4
+#define VIDEO_SINK_BUFFERS   3
+
+
+// header at the beginning of a raw RGBA dump, followed by the 8-bit RGBA frames
+struct videoDumpHeader
+{
+	char     magic[8];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	float    fps;
+	uint32_t reserved[2];
+};
+
+
+// current time in seconds
+static inline double timeSeconds()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+
+// quote a filename for the shell that runs ffmpeg
+static std::string shellQuote( const char* str )
+{
+	std::string quoted = "'";
+
+	for( const char* c=str; *c != '\0'; c++ )
+	{
+		if( *c == '\'' )
+			quoted += "'\\''";
+		else
+			quoted += *c;
+	}
+
+	return quoted + "'";
+}
+
+
+// return true if the filename is a raw RGBA dump
+static inline bool isRawDump( const char* filename )
+{
+	const char* dot = strrchr(filename, '.');
+	return dot != NULL && strcasecmp(dot, ".rgba") == 0;
+}
+
+
+// clamp a float channel to 8 bits
+static inline uint8_t clampPixel( float v )
+{
+	return (v <= 0.0f) ? 0 : (v >= 255.0f) ? 255 : (uint8_t)(v + 0.5f);
+}
+
+
+//---------------------------------------------------------------------------------------
+// videoSource
+//---------------------------------------------------------------------------------------
+
+// constructor
+videoSource::videoSource()
+{
+	mFile       = NULL;
+	mPipe       = false;
+	mRawDump    = false;
+	mDataOffset = 0;
+	mWidth      = 0;
+	mHeight     = 0;
+	mFPS        = 0.0f;
+	mLoop       = false;
+	mHeld       = -1;
+	mStreaming  = false;
+	mStop       = false;
+	mEOS        = false;
+	mDecoded    = 0;
+	mDelivered  = 0;
+	mDropped    = 0;
+	mDecodeTime = 0.0;
+	mWaitTime   = 0.0;
+
+	pthread_mutex_init(&mMutex, NULL);
+	pthread_cond_init(&mCond, NULL);
+}
+
+
+// destructor
+videoSource::~videoSource()
+{
+	Close();
+
+	for( size_t n=0; n < mBuffers.size(); n++ )
+	{
+		if( mBuffers[n].cpu != NULL )
+			CUDA(cudaFreeHost(mBuffers[n].cpu));
+	}
+
+	pthread_cond_destroy(&mCond);
+	pthread_mutex_destroy(&mMutex);
+}
+
+
+// Create
+videoSource* videoSource::Create( const char* filename, uint32_t width, uint32_t height, float fps, bool loop )
+{
+	if( !filename )
+		return NULL;
+
+	videoSource* source = new videoSource();
+
+	if( !source->init(filename, width, height, fps, loop) )
+	{
+		printf(LOG_VIDEO "failed to open video '%s'\n", filename);
+		delete source;
+		return NULL;
+	}
+
+	return source;
+}
+
+
+// init
+bool videoSource::init( const char* filename, uint32_t width, uint32_t height, float fps, bool loop )
+{
+	mFilename = filename;
+	mFPS      = (fps > 0.0f) ? fps : 0.0f;
+	mLoop     = loop;
+	mRawDump  = isRawDump(filename);
+
+	// determine the size of the frames
+	if( mRawDump )
+	{
+		FILE* file = fopen(filename, "rb");
+
+		if( !file )
+			return false;
+
+		videoDumpHeader header;
+		const bool valid = (fread(&header, sizeof(header), 1, file) == 1) &&
+					    memcmp(header.magic, VIDEO_DUMP_MAGIC, 8) == 0 &&
+					    header.version == VIDEO_DUMP_VERSION &&
+					    header.width > 0 && header.height > 0;
+
+		fclose(file);
+
+		if( !valid )
+		{
+			printf(LOG_VIDEO "'%s' isn't a valid RGBA dump\n", filename);
+			return false;
+		}
+
+		if( (width != 0 && width != header.width) || (height != 0 && height != header.height) )
+			printf(LOG_VIDEO "RGBA dumps can't be scaled, using %ux%u\n", header.width, header.height);
+
+		mWidth      = header.width;
+		mHeight     = header.height;
+		mDataOffset = sizeof(videoDumpHeader);
+	}
+	else if( width > 0 && height > 0 )
+	{
+		// ffmpeg scales the frames to the requested size
+		mWidth  = width;
+		mHeight = height;
+	}
+	else
+	{
+		const std::string cmd = "ffprobe -v error -select_streams v:0 -show_entries stream=width,height -of csv=p=0:s=x " + shellQuote(filename);
+		FILE* probe = popen(cmd.c_str(), "r");
+
+		if( !probe )
+		{
+			printf(LOG_VIDEO "failed to run ffprobe (is ffmpeg installed?)\n");
+			return false;
+		}
+
+		if( fscanf(probe, "%ux%u", &mWidth, &mHeight) != 2 )
+			mWidth = mHeight = 0;
+
+		pclose(probe);
+
+		if( mWidth == 0 || mHeight == 0 )
+		{
+			printf(LOG_VIDEO "failed to probe the size of '%s' with ffprobe\n", filename);
+			return false;
+		}
+	}
+
+	// allocate the ring of frame buffers
+	const size_t size = size_t(mWidth) * size_t(mHeight) * sizeof(float4);
+
+	mBuffers.resize(VIDEO_SOURCE_BUFFERS);
+
+	for( size_t n=0; n < mBuffers.size(); n++ )
+	{
+		mBuffers[n].cpu = NULL;
+		mBuffers[n].gpu = NULL;
+	}
+
+	for( size_t n=0; n < mBuffers.size(); n++ )
+	{
+		if( !cudaAllocMapped((void**)&mBuffers[n].cpu, (void**)&mBuffers[n].gpu, size) )
+			return false;
+	}
+
+	printf(LOG_VIDEO "opened '%s' (%ux%u, %s%s)\n", filename, mWidth, mHeight,
+		  (mFPS > 0.0f) ? "paced" : "every frame", mLoop ? ", looping" : "");
+
+	return true;
+}
+
+
+// openStream
+bool videoSource::openStream()
+{
+	if( mRawDump )
+	{
+		mFile = fopen(mFilename.c_str(), "rb");
+		mPipe = false;
+
+		if( !mFile || fseek(mFile, mDataOffset, SEEK_SET) != 0 )
+		{
+			printf(LOG_VIDEO "failed to open '%s'\n", mFilename.c_str());
+			closeStream();
+			return false;
+		}
+
+		return true;
+	}
+
+	char scale[64] = "";
+
+	snprintf(scale, sizeof(scale), "-vf scale=%u:%u", mWidth, mHeight);
+
+	const std::string cmd = std::string("ffmpeg -v error -nostdin ") + (mLoop ? "-stream_loop -1 " : "") +
+					    "-i " + shellQuote(mFilename.c_str()) + " " + scale + " -f rawvideo -pix_fmt rgba -";
+
+	mFile = popen(cmd.c_str(), "r");
+	mPipe = true;
+
+	if( !mFile )
+	{
+		printf(LOG_VIDEO "failed to run ffmpeg (is it installed?)\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+// closeStream
+void videoSource::closeStream()
+{
+	if( !mFile )
+		return;
+
+	if( mPipe )
+		pclose(mFile);
+	else
+		fclose(mFile);
+
+	mFile = NULL;
+}
+
+
+// readFrame
+bool videoSource::readFrame( uint8_t* frame )
+{
+	const size_t size = size_t(mWidth) * size_t(mHeight) * 4;
+
+	if( fread(frame, 1, size, mFile) == size )
+		return true;
+
+	// ffmpeg loops the video itself, but the raw dumps are rewound here
+	if( mLoop && !mPipe && fseek(mFile, mDataOffset, SEEK_SET) == 0 )
+		return fread(frame, 1, size, mFile) == size;
+
+	return false;
+}
+
+
+// Open
+bool videoSource::Open()
+{
+	if( mStreaming )
+		return true;
+
+	if( !openStream() )
+		return false;
+
+	pthread_mutex_lock(&mMutex);
+
+	mFree.clear();
+	mReady.clear();
+	mHeld = -1;
+	mStop = false;
+	mEOS  = false;
+
+	for( size_t n=0; n < mBuffers.size(); n++ )
+		mFree.push_back(n);
+
+	pthread_mutex_unlock(&mMutex);
+
+	if( pthread_create(&mThread, NULL, threadEntry, this) != 0 )
+	{
+		printf(LOG_VIDEO "failed to create decode thread\n");
+		closeStream();
+		return false;
+	}
+
+	mStreaming = true;
+	return true;
+}
+
+
+// Close
+void videoSource::Close()
+{
+	if( !mStreaming )
+		return;
+
+	pthread_mutex_lock(&mMutex);
+	mStop = true;
+	pthread_cond_broadcast(&mCond);
+	pthread_mutex_unlock(&mMutex);
+
+	pthread_join(mThread, NULL);
+	closeStream();
+
+	mStreaming = false;
+	PrintStats();
+}
+
+
+// IsEOS
+bool videoSource::IsEOS() const
+{
+	pthread_mutex_lock(&mMutex);
+	const bool eos = mEOS && mReady.size() == 0;
+	pthread_mutex_unlock(&mMutex);
+
+	return eos;
+}
+
+
+// CaptureRGBA
+bool videoSource::CaptureRGBA( float** image, uint64_t timeout, bool zeroCopy )
+{
+	if( !image || !mStreaming )
+		return false;
+
+	struct timespec deadline;
+	const bool wait = (timeout != ULONG_MAX);
+
+	if( wait )
+	{
+		clock_gettime(CLOCK_REALTIME, &deadline);
+
+		deadline.tv_sec  += timeout / 1000;
+		deadline.tv_nsec += (timeout % 1000) * 1000000;
+
+		if( deadline.tv_nsec >= 1000000000 )
+		{
+			deadline.tv_sec  += 1;
+			deadline.tv_nsec -= 1000000000;
+		}
+	}
+
+	const double begin = timeSeconds();
+
+	pthread_mutex_lock(&mMutex);
+
+	// the previous frame is no longer in use
+	if( mHeld >= 0 )
+	{
+		mFree.push_back(mHeld);
+		mHeld = -1;
+		pthread_cond_broadcast(&mCond);
+	}
+
+	while( mReady.size() == 0 && !mEOS )
+	{
+		if( !wait )
+			pthread_cond_wait(&mCond, &mMutex);
+		else if( pthread_cond_timedwait(&mCond, &mMutex, &deadline) == ETIMEDOUT )
+			break;
+	}
+
+	mWaitTime += timeSeconds() - begin;
+
+	if( mReady.size() == 0 )
+	{
+		pthread_mutex_unlock(&mMutex);
+		return false;
+	}
+
+	mHeld = mReady.front();
+	mReady.pop_front();
+	mDelivered++;
+
+	pthread_mutex_unlock(&mMutex);
+
+	*image = (float*)mBuffers[mHeld].gpu;
+	return true;
+}
+
+
+// threadEntry
+void* videoSource::threadEntry( void* param )
+{
+	((videoSource*)param)->run();
+	return NULL;
+}
+
+
+// run
+void videoSource::run()
+{
+	const size_t pixels = size_t(mWidth) * size_t(mHeight);
+	std::vector<uint8_t> frame(pixels * 4);
+
+	double nextFrame = timeSeconds();
+
+	while( true )
+	{
+		// pace the frames like a camera would
+		if( mFPS > 0.0f )
+		{
+			const double delay = nextFrame - timeSeconds();
+
+			if( delay > 0.0 )
+			{
+				struct timespec ts;
+				ts.tv_sec  = (time_t)delay;
+				ts.tv_nsec = (long)((delay - ts.tv_sec) * 1e9);
+				nanosleep(&ts, NULL);
+			}
+
+			nextFrame += 1.0 / mFPS;
+
+			// don't try to catch up after a stall
+			if( nextFrame < timeSeconds() - 1.0 / mFPS )
+				nextFrame = timeSeconds();
+		}
+
+		const double begin = timeSeconds();
+
+		if( !readFrame(frame.data()) )
+			break;
+
+		// wait for a free buffer -- or when paced, recycle the oldest frame that wasn't captured
+		pthread_mutex_lock(&mMutex);
+
+		while( !mStop && mFree.size() == 0 && (mFPS <= 0.0f || mReady.size() == 0) )
+			pthread_cond_wait(&mCond, &mMutex);
+
+		if( mStop )
+		{
+			pthread_mutex_unlock(&mMutex);
+			return;
+		}
+
+		int index = -1;
+
+		if( mFree.size() > 0 )
+		{
+			index = mFree.back();
+			mFree.pop_back();
+		}
+		else
+		{
+			index = mReady.front();
+			mReady.pop_front();
+			mDropped++;
+		}
+
+		pthread_mutex_unlock(&mMutex);
+
+		// expand to float4 RGBA
+		const uint8_t* in = frame.data();
+		float* out = (float*)mBuffers[index].cpu;
+
+		for( size_t n=0; n < pixels * 4; n++ )
+			out[n] = in[n];
+
+		const double elapsed = timeSeconds() - begin;
+
+		pthread_mutex_lock(&mMutex);
+
+		mReady.push_back(index);
+		mDecoded++;
+		mDecodeTime += elapsed;
+
+		pthread_cond_broadcast(&mCond);
+		pthread_mutex_unlock(&mMutex);
+	}
+
+	// end of the file (or the decoder failed)
+	pthread_mutex_lock(&mMutex);
+	mEOS = true;
+	pthread_cond_broadcast(&mCond);
+	pthread_mutex_unlock(&mMutex);
+
+	printf(LOG_VIDEO "end of '%s' after %llu frames\n", mFilename.c_str(), (unsigned long long)mDecoded);
+}
+
+
+// PrintStats
+void videoSource::PrintStats() const
+{
+	pthread_mutex_lock(&mMutex);
+
+	printf(LOG_VIDEO "'%s' -- %llu frames decoded, %llu captured, %llu dropped\n", mFilename.c_str(),
+		  (unsigned long long)mDecoded, (unsigned long long)mDelivered, (unsigned long long)mDropped);
+
+	printf(LOG_VIDEO "decode %.2f ms per frame, capture waited %.3f s in total\n",
+		  (mDecoded > 0) ? mDecodeTime * 1000.0 / mDecoded : 0.0, mWaitTime);
+
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+//---------------------------------------------------------------------------------------
+// videoSink
+//---------------------------------------------------------------------------------------
+
+// constructor
+videoSink::videoSink()
+{
+	mFile          = NULL;
+	mPipe          = false;
+	mFPS           = 30.0f;
+	mWidth         = 0;
+	mHeight        = 0;
+	mThreadStarted = false;
+	mStop          = false;
+	mFailed        = false;
+	mWritten       = 0;
+	mWriteTime     = 0.0;
+	mWaitTime      = 0.0;
+	mLastFrame     = 0.0;
+	mLastTitle     = 0.0;
+	mAvgFPS        = 0.0f;
+
+	pthread_mutex_init(&mMutex, NULL);
+	pthread_cond_init(&mCond, NULL);
+}
+
+
+// destructor
+videoSink::~videoSink()
+{
+	if( mThreadStarted )
+	{
+		// the queued frames are written before the thread exits
+		pthread_mutex_lock(&mMutex);
+		mStop = true;
+		pthread_cond_broadcast(&mCond);
+		pthread_mutex_unlock(&mMutex);
+
+		pthread_join(mThread, NULL);
+	}
+
+	closeStream();
+	PrintStats();
+
+	for( size_t n=0; n < mFrames.size(); n++ )
+	{
+		if( mFrames[n].cpu != NULL )
+			CUDA(cudaFreeHost(mFrames[n].cpu));
+	}
+
+	pthread_cond_destroy(&mCond);
+	pthread_mutex_destroy(&mMutex);
+}
+
+
+// Create
+videoSink* videoSink::Create( const char* filename, float fps )
+{
+	videoSink* sink = new videoSink();
+
+	if( !sink->init(filename, fps) )
+	{
+		printf(LOG_VIDEO "failed to create video output '%s'\n", filename);
+		delete sink;
+		return NULL;
+	}
+
+	return sink;
+}
+
+
+// init
+bool videoSink::init( const char* filename, float fps )
+{
+	mFilename = (filename != NULL) ? filename : "";
+	mFPS      = (fps > 0.0f) ? fps : 30.0f;
+
+	// frames are only copied and written if there's a file
+	if( mFilename.size() == 0 )
+	{
+		printf(LOG_VIDEO "headless output, discarding the frames\n");
+		return true;
+	}
+
+	mFrames.resize(VIDEO_SINK_BUFFERS);
+
+	for( size_t n=0; n < mFrames.size(); n++ )
+	{
+		mFrames[n].cpu    = NULL;
+		mFrames[n].gpu    = NULL;
+		mFrames[n].size   = 0;
+		mFrames[n].width  = 0;
+		mFrames[n].height = 0;
+
+		mFree.push_back(n);
+	}
+
+	if( pthread_create(&mThread, NULL, threadEntry, this) != 0 )
+	{
+		printf(LOG_VIDEO "failed to create encoder thread\n");
+		return false;
+	}
+
+	mThreadStarted = true;
+	printf(LOG_VIDEO "writing the output to '%s'\n", filename);
+
+	return true;
+}
+
+
+// openStream
+bool videoSink::openStream( uint32_t width, uint32_t height )
+{
+	mWidth  = width;
+	mHeight = height;
+
+	if( isRawDump(mFilename.c_str()) )
+	{
+		mFile = fopen(mFilename.c_str(), "wb");
+		mPipe = false;
+
+		if( !mFile )
+		{
+			printf(LOG_VIDEO "failed to open '%s' for writing\n", mFilename.c_str());
+			return false;
+		}
+
+		videoDumpHeader header;
+
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, VIDEO_DUMP_MAGIC, 8);
+
+		header.version = VIDEO_DUMP_VERSION;
+		header.width   = width;
+		header.height  = height;
+		header.fps     = mFPS;
+
+		return fwrite(&header, sizeof(header), 1, mFile) == 1;
+	}
+
+	// a failed encoder should show up as a write error, not kill the process
+	signal(SIGPIPE, SIG_IGN);
+
+	char input[128];
+	snprintf(input, sizeof(input), "-f rawvideo -pix_fmt rgba -s %ux%u -r %g -i - ", width, height, mFPS);
+
+	const std::string cmd = std::string("ffmpeg -v error -y ") + input + "-pix_fmt yuv420p " + shellQuote(mFilename.c_str());
+
+	mFile = popen(cmd.c_str(), "w");
+	mPipe = true;
+
+	if( !mFile )
+	{
+		printf(LOG_VIDEO "failed to run ffmpeg (is it installed?)\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+// closeStream
+void videoSink::closeStream()
+{
+	if( !mFile )
+		return;
+
+	if( mPipe )
+	{
+		if( pclose(mFile) != 0 )
+			printf(LOG_VIDEO "ffmpeg failed to encode '%s'\n", mFilename.c_str());
+	}
+	else if( fclose(mFile) != 0 )
+	{
+		printf(LOG_VIDEO "failed to write '%s'\n", mFilename.c_str());
+	}
+
+	mFile = NULL;
+}
+
+
+// RenderOnce
+void videoSink::RenderOnce( float* image, uint32_t width, uint32_t height )
+{
+	// measure the frame rate, smoothed like glDisplay's
+	const double now = timeSeconds();
+
+	if( mLastFrame > 0.0 && now > mLastFrame )
+	{
+		const float fps = 1.0f / (now - mLastFrame);
+		mAvgFPS = (mAvgFPS > 0.0f) ? mAvgFPS * 0.9f + fps * 0.1f : fps;
+	}
+
+	mLastFrame = now;
+
+	if( !mThreadStarted || !image || width == 0 || height == 0 )
+		return;
+
+	// wait for a free buffer (this is the backpressure from the encoder)
+	pthread_mutex_lock(&mMutex);
+
+	while( mFree.size() == 0 && !mFailed )
+		pthread_cond_wait(&mCond, &mMutex);
+
+	if( mFailed )
+	{
+		pthread_mutex_unlock(&mMutex);
+		return;
+	}
+
+	const int index = mFree.back();
+	mFree.pop_back();
+
+	mWaitTime += timeSeconds() - now;
+
+	pthread_mutex_unlock(&mMutex);
+
+	// copy the frame into the buffer (the buffer is only touched by this thread until it's queued)
+	frame& f = mFrames[index];
+	const size_t size = size_t(width) * size_t(height) * sizeof(float4);
+
+	if( size > f.size )
+	{
+		if( f.cpu != NULL )
+			CUDA(cudaFreeHost(f.cpu));
+
+		f.cpu  = NULL;
+		f.gpu  = NULL;
+		f.size = 0;
+
+		if( !cudaAllocMapped((void**)&f.cpu, (void**)&f.gpu, size) )
+		{
+			pthread_mutex_lock(&mMutex);
+			mFree.push_back(index);
+			mFailed = true;
+			pthread_mutex_unlock(&mMutex);
+			return;
+		}
+
+		f.size = size;
+	}
+
+	f.width  = width;
+	f.height = height;
+
+	if( CUDA_FAILED(cudaMemcpy(f.gpu, image, size, cudaMemcpyDeviceToDevice)) )
+	{
+		pthread_mutex_lock(&mMutex);
+		mFree.push_back(index);
+		pthread_mutex_unlock(&mMutex);
+		return;
+	}
+
+	pthread_mutex_lock(&mMutex);
+	mQueue.push_back(index);
+	pthread_cond_broadcast(&mCond);
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// threadEntry
+void* videoSink::threadEntry( void* param )
+{
+	((videoSink*)param)->run();
+	return NULL;
+}
+
+
+// run
+void videoSink::run()
+{
+	pthread_mutex_lock(&mMutex);
+
+	while( true )
+	{
+		while( !mStop && mQueue.size() == 0 )
+			pthread_cond_wait(&mCond, &mMutex);
+
+		if( mQueue.size() == 0 )
+			break;
+
+		const int index = mQueue.front();
+		mQueue.pop_front();
+
+		bool success = !mFailed;
+
+		pthread_mutex_unlock(&mMutex);
+
+		const double begin = timeSeconds();
+		const frame& f = mFrames[index];
+		bool written = false;
+
+		// the stream is opened with the size of the first frame
+		if( success && !mFile && !openStream(f.width, f.height) )
+			success = false;
+
+		if( success && (f.width != mWidth || f.height != mHeight) )
+		{
+			printf(LOG_VIDEO "dropping %ux%u frame, the video is %ux%u\n", f.width, f.height, mWidth, mHeight);
+		}
+		else if( success )
+		{
+			const size_t count = size_t(f.width) * size_t(f.height) * 4;
+			const float* in = (const float*)f.cpu;
+
+			mScratch.resize(count);
+
+			for( size_t n=0; n < count; n++ )
+				mScratch[n] = clampPixel(in[n]);
+
+			if( fwrite(mScratch.data(), 1, count, mFile) != count )
+			{
+				printf(LOG_VIDEO "failed to write frame to '%s'\n", mFilename.c_str());
+				success = false;
+			}
+			else
+				written = true;
+		}
+
+		const double elapsed = timeSeconds() - begin;
+
+		pthread_mutex_lock(&mMutex);
+
+		mFree.push_back(index);
+		mWriteTime += elapsed;
+
+		if( !success )
+			mFailed = true;
+		else if( written )
+			mWritten++;
+
+		pthread_cond_broadcast(&mCond);
+	}
+
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// SetTitle
+void videoSink::SetTitle( const char* title )
+{
+	const double now = timeSeconds();
+
+	if( !title || now - mLastTitle < 1.0 )
+		return;
+
+	printf(LOG_VIDEO "%s\n", title);
+	mLastTitle = now;
+}
+
+
+// IsClosed
+bool videoSink::IsClosed() const
+{
+	pthread_mutex_lock(&mMutex);
+	const bool failed = mFailed;
+	pthread_mutex_unlock(&mMutex);
+
+	return failed;
+}
+
+
+// PrintStats
+void videoSink::PrintStats() const
+{
+	if( mFilename.size() == 0 )
+	{
+		printf(LOG_VIDEO "headless output -- %.1f FPS\n", mAvgFPS);
+		return;
+	}
+
+	pthread_mutex_lock(&mMutex);
+
+	printf(LOG_VIDEO "'%s' -- %llu frames written, %.2f ms per frame, rendering waited %.3f s in total\n",
+		  mFilename.c_str(), (unsigned long long)mWritten, (mWritten > 0) ? mWriteTime * 1000.0 / mWritten : 0.0, mWaitTime);
+
+	pthread_mutex_unlock(&mMutex);
+}
+
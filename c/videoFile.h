@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+ 
+#ifndef __VIDEO_FILE_H__
+#define __VIDEO_FILE_H__
+
+#include "frameSource.h"
+#include "frameSink.h"
+#include "cudaUtility.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <deque>
+
+
+/**
+ * Prefix used for logging video file messages.
+ * @ingroup frameSource
+ */
+#define LOG_VIDEO "[video] "
+
+
+/**
+ * frameSource that decodes a video file on a background thread, so that the camera
+ * examples can run on recorded footage and in containers without a camera.
+ *
+ * Compressed video (mp4, mkv, avi, ...) is decoded by an ffmpeg child process, which
+ * needs to be on the PATH.  A raw RGBA dump written by videoSink (.rgba) is read
+ * directly, without ffmpeg.
+ *
+ * The frames are converted to float4 RGBA in a small ring of mapped buffers.  With
+ * a frame rate, the file is paced like a live camera, and frames that the consumer
+ * doesn't capture in time are dropped.  Without one (the default), every frame is
+ * delivered, as fast as the consumer captures them -- for benchmarking.
+ * @ingroup frameSource
+ */
+class videoSource : public frameSource
+{
+public:
+	/**
+	 * Create a video source.
+	 * @param filename the video file, or a raw RGBA dump (.rgba)
+	 * @param width width to scale the frames to (or 0 to keep the size of the video)
+	 * @param height height to scale the frames to (or 0 to keep the size of the video)
+	 * @param fps rate to deliver the frames at (or 0 for every frame, as fast as they're captured)
+	 * @param loop restart the file when it reaches the end
+	 * @returns NULL if the file couldn't be opened.
+	 */
+	static videoSource* Create( const char* filename, uint32_t width=0, uint32_t height=0, float fps=0.0f, bool loop=false );
+
+	/**
+	 * Destructor
+	 */
+	virtual ~videoSource();
+
+	/**
+	 * @see frameSource::Open()
+	 */
+	virtual bool Open();
+
+	/**
+	 * @see frameSource::Close()
+	 */
+	virtual void Close();
+
+	/**
+	 * @see frameSource::CaptureRGBA() -- the frames are always in mapped memory.
+	 */
+	virtual bool CaptureRGBA( float** image, uint64_t timeout=ULONG_MAX, bool zeroCopy=false );
+
+	/**
+	 * @see frameSource::GetWidth()
+	 */
+	virtual uint32_t GetWidth() const		{ return mWidth; }
+
+	/**
+	 * @see frameSource::GetHeight()
+	 */
+	virtual uint32_t GetHeight() const		{ return mHeight; }
+
+	/**
+	 * @see frameSource::GetPixelDepth()
+	 */
+	virtual uint32_t GetPixelDepth() const	{ return 32; }
+
+	/**
+	 * @see frameSource::IsEOS()
+	 */
+	virtual bool IsEOS() const;
+
+	/**
+	 * Print the number of frames decoded, delivered and dropped, the decode
+	 * time per frame, and how long the consumer waited for frames.
+	 */
+	void PrintStats() const;
+
+protected:
+	videoSource();
+	bool init( const char* filename, uint32_t width, uint32_t height, float fps, bool loop );
+
+	bool openStream();
+	void closeStream();
+	bool readFrame( uint8_t* frame );
+
+	static void* threadEntry( void* param );
+	void run();
+
+	struct buffer
+	{
+		float4* cpu;
+		float4* gpu;
+	};
+
+	std::string mFilename;
+	FILE*       mFile;
+	bool        mPipe;		// mFile is an ffmpeg pipe rather than a raw dump
+	bool        mRawDump;
+	long        mDataOffset;	// start of the frames in a raw dump
+
+	uint32_t mWidth;
+	uint32_t mHeight;
+	float    mFPS;
+	bool     mLoop;
+
+	std::vector<buffer> mBuffers;
+	std::vector<int>    mFree;
+	std::deque<int>     mReady;
+	int                 mHeld;		// buffer of the last captured frame
+
+	pthread_t mThread;
+	bool      mStreaming;
+	bool      mStop;
+	bool      mEOS;
+
+	uint64_t mDecoded;
+	uint64_t mDelivered;
+	uint64_t mDropped;
+	double   mDecodeTime;
+	double   mWaitTime;
+
+	mutable pthread_mutex_t mMutex;
+	pthread_cond_t mCond;
+};
+
+
+/**
+ * Headless frameSink that encodes the rendered frames to a video file on a
+ * background thread, instead of drawing them to an OpenGL window.
+ *
+ * Compressed video (the codec follows the extension, i.e. mp4 or mkv) is encoded by
+ * an ffmpeg child process.  A raw RGBA dump (.rgba) is written directly -- it's the
+ * fastest, and can be played back by videoSource.  Without a filename, the frames
+ * are discarded and only the frame rate is measured.
+ *
+ * RenderOnce() copies the frame into one of a few buffers and returns, and blocks
+ * only while every buffer is waiting to be written.  The title is printed once a
+ * second, since there's no window to show it.
+ * @ingroup frameSink
+ */
+class videoSink : public frameSink
+{
+public:
+	/**
+	 * Create a video sink.
+	 * @param filename the video file or raw RGBA dump (.rgba) to write, or NULL to discard the frames
+	 * @param fps frame rate of the encoded video
+	 */
+	static videoSink* Create( const char* filename, float fps=30.0f );
+
+	/**
+	 * Destructor -- writes the queued frames and closes the file.
+	 */
+	virtual ~videoSink();
+
+	/**
+	 * @see frameSink::RenderOnce()
+	 */
+	virtual void RenderOnce( float* image, uint32_t width, uint32_t height );
+
+	/**
+	 * @see frameSink::SetTitle()
+	 */
+	virtual void SetTitle( const char* title );
+
+	/**
+	 * @see frameSink::IsClosed()
+	 */
+	virtual bool IsClosed() const;
+
+	/**
+	 * @see frameSink::GetFPS()
+	 */
+	virtual float GetFPS() const			{ return mAvgFPS; }
+
+	/**
+	 * Print the number of frames written, the conversion and write time per frame,
+	 * and how long the renderer waited on the writer.
+	 */
+	void PrintStats() const;
+
+protected:
+	videoSink();
+	bool init( const char* filename, float fps );
+
+	bool openStream( uint32_t width, uint32_t height );
+	void closeStream();
+
+	static void* threadEntry( void* param );
+	void run();
+
+	struct frame
+	{
+		float4*  cpu;
+		float4*  gpu;
+		size_t   size;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	std::string mFilename;
+	FILE*       mFile;
+	bool        mPipe;
+	float       mFPS;
+
+	uint32_t mWidth;		// size of the stream, set by the first frame
+	uint32_t mHeight;
+
+	std::vector<frame>   mFrames;
+	std::vector<int>     mFree;
+	std::deque<int>      mQueue;
+	std::vector<uint8_t> mScratch;
+
+	pthread_t mThread;
+	bool      mThreadStarted;
+	bool      mStop;
+	bool      mFailed;
+
+	uint64_t mWritten;
+	double   mWriteTime;
+	double   mWaitTime;
+
+	double mLastFrame;
+	double mLastTitle;
+	float  mAvgFPS;
+
+	mutable pthread_mutex_t mMutex;
+	pthread_cond_t mCond;
+};
+
+
+#endif
+
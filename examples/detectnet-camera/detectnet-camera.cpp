@@ -20,11 +20,12 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
-#include "gstCamera.h"
-#include "glDisplay.h"
+#include "frameSource.h"
+#include "frameSink.h"
 
 #include "detectNet.h"
 #include "commandLine.h"
+#include "threadConfig.h"
 
 #include <signal.h>
 
@@ -43,15 +44,17 @@ void sig_handler(int signo)
 int usage()
 {
 	printf("usage: detectnet-camera [-h] [--network NETWORK] [--camera CAMERA]\n");
-	printf("                        [--width WIDTH] [--height HEIGHT]\n\n");
+	printf("                        [--width WIDTH] [--height HEIGHT]\n");
+	printf("                        [--input FILE] [--output FILE] [--headless]\n");
+	printf("                        [--threads FILE] [--thread-pipeline SPEC]\n\n");
 	printf("Locate objects in a live camera stream using an object detection DNN.\n\n");
 	printf("optional arguments:\n");
 	printf("  --help           show this help message and exit\n");
-	printf("  --camera CAMERA  index of the MIPI CSI camera to use (NULL for CSI camera 0),\n");
-	printf("                   or for VL42 cameras the /dev/video node to use (/dev/video0).\n");
-     printf("                   by default, MIPI CSI camera 0 will be used.\n");
-	printf("  --width WIDTH    desired width of camera stream (default is 1280 pixels)\n");
-	printf("  --height HEIGHT  desired height of camera stream (default is 720 pixels)\n\n");
+	printf("  --threads FILE   thread configuration file (see threadConfig.h)\n");
+	printf("  --thread-pipeline SPEC  configuration of the processing thread, for example\n");
+	printf("                   \"cores=2 policy=fifo priority=50\"\n\n");
+	printf("%s\n", frameSource::Usage());
+	printf("%s\n", frameSink::Usage());
 	printf("%s\n", detectNet::Usage());
 
 	return 0;
@@ -68,6 +71,16 @@ int main( int argc, char** argv )
 		return usage();
 
 
+	/*
+	 * load the thread configuration
+	 */
+	if( !threadConfig::ParseArgs(argc, argv) )
+	{
+		printf("detectnet-camera:  invalid thread configuration\n");
+		return 0;
+	}
+
+
 	/*
 	 * attach signal handler
 	 */
@@ -78,9 +91,7 @@ int main( int argc, char** argv )
 	/*
 	 * create the camera device
 	 */
-	gstCamera* camera = gstCamera::Create(cmdLine.GetInt("width", gstCamera::DefaultWidth),
-								   cmdLine.GetInt("height", gstCamera::DefaultHeight),
-								   cmdLine.GetString("camera"));
+	frameSource* camera = frameSource::Create(argc, argv);
 
 	if( !camera )
 	{
@@ -109,7 +120,7 @@ int main( int argc, char** argv )
 	/*
 	 * create openGL window
 	 */
-	glDisplay* display = glDisplay::Create();
+	frameSink* display = frameSink::Create(argc, argv);
 
 	if( !display ) 
 		printf("detectnet-camera:  failed to create openGL display\n");
@@ -125,6 +136,13 @@ int main( int argc, char** argv )
 	}
 	
 	printf("detectnet-camera:  camera open for streaming\n");
+
+
+	/*
+	 * configure the pipeline thread (after the camera and network
+	 * have started their own threads, so they don't inherit it)
+	 */
+	threadConfig::ApplyStage("pipeline", "detectnet-camera");
 	
 	
 	/*
@@ -138,7 +156,12 @@ int main( int argc, char** argv )
 		float* imgRGBA = NULL;
 		
 		if( !camera->CaptureRGBA(&imgRGBA, 1000) )
+		{
+			if( camera->IsEOS() )
+				break;
+
 			printf("detectnet-camera:  failed to capture RGBA image from camera\n");
+		}
 
 		// detect objects in the frame
 		detectNet::Detection* detections = NULL;
@@ -159,8 +182,11 @@ int main( int argc, char** argv )
 		// update display
 		if( display != NULL )
 		{
-			// render the image
-			display->RenderOnce(imgRGBA, camera->GetWidth(), camera->GetHeight());
+			// render the image (or the overlayed preview, if --preview was set)
+			if( net->GetPreview() != NULL )
+				display->RenderOnce(net->GetPreview(), net->GetPreviewWidth(), net->GetPreviewHeight());
+			else
+				display->RenderOnce(imgRGBA, camera->GetWidth(), camera->GetHeight());
 
 			// update the status bar
 			char str[256];
@@ -180,6 +206,7 @@ int main( int argc, char** argv )
 	/*
 	 * destroy resources
 	 */
+	threadConfig::Report();
 	printf("detectnet-camera:  shutting down...\n");
 	
 	SAFE_DELETE(camera);
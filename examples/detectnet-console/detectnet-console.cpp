@@ -21,6 +21,8 @@
  */
 
 #include "detectNet.h"
+#include "decodePool.h"
+#include "imageWriter.h"
 #include "loadImage.h"
 
 #include "commandLine.h"
@@ -30,18 +32,114 @@
 int usage()
 {
 	printf("usage: detectnet-console [-h] [--network NETWORK] [--threshold THRESHOLD]\n");
-	printf("                         file_in [file_out]\n\n");
+	printf("                         [--decode-threads N] [--writer-threads N]\n");
+	printf("                         [--output-format FORMAT] file_in [file_out]\n\n");
 	printf("Locate objects in an image using an object detection DNN.\n\n");
 	printf("positional arguments:\n");
-	printf("  file_in              filename of the input image to process\n");
-	printf("  file_out             filename of the output image to save (optional)\n\n");
+	printf("  file_in              filename of the input image to process, or a directory\n");
+	printf("                       or list file (.txt) of images to process\n");
+	printf("  file_out             filename of the output image to save, or the directory\n");
+	printf("                       to save the images of a directory or list to (optional)\n\n");
 	printf("optional arguments:\n");
-	printf("  --help               show this help message and exit\n\n");
+	printf("  --help               show this help message and exit\n");
+	printf("  --decode-threads N   threads decoding the images of a directory or list\n");
+	printf("                       (default is one per CPU core)\n");
+	printf("  --writer-threads N   threads encoding and saving the output images of a\n");
+	printf("                       directory or list in the background (default is 2)\n");
+	printf("  --output-format FORMAT  format of those output images: jpg, png or raw\n");
+	printf("                       (default is the format of each input image)\n\n");
 	printf("%s\n", detectNet::Usage());
 
 	return 0;
 }
 
+
+// run detection on a directory or list of images, decoded ahead on a pool of threads
+int detectImages( detectNet* net, const char* path, const commandLine& cmdLine )
+{
+	std::vector<std::string> filenames;
+
+	if( !decodePool::ListImages(path, filenames) )
+		return 0;
+
+	decodePool* pool = decodePool::Create(cmdLine.GetInt("decode-threads", 0));
+
+	if( !pool )
+		return 0;
+
+	// the annotated images are saved in the background, if an output directory was given
+	const char* outputDir = cmdLine.GetPosition(1);
+	imageWriter* writer = NULL;
+
+	if( outputDir != NULL )
+	{
+		writer = imageWriter::Create(cmdLine.GetInt("writer-threads", 2));
+
+		if( !writer )
+		{
+			delete pool;
+			return 0;
+		}
+	}
+
+	pool->Submit(filenames);
+	pool->Close();
+
+	decodedImage image;
+	uint32_t totalDetections = 0;
+
+	while( pool->Next(&image) )
+	{
+		if( !image.success )
+		{
+			printf("detectnet-console:  failed to load image '%s'\n", image.filename.c_str());
+			pool->Release(&image);
+			continue;
+		}
+
+		detectNet::Detection* detections = NULL;
+
+		const int numDetections = net->Detect((float*)image.gpu, image.width, image.height, &detections);
+
+		printf("'%s'  %i objects detected\n", image.filename.c_str(), numDetections);
+
+		for( int n=0; n < numDetections; n++ )
+		{
+			printf("detected obj %u  class #%u (%s)  confidence=%f\n", detections[n].Instance, detections[n].ClassID, net->GetClassDesc(detections[n].ClassID), detections[n].Confidence);
+			printf("bounding box %u  (%f, %f)  (%f, %f)  w=%f  h=%f\n", detections[n].Instance, detections[n].Left, detections[n].Top, detections[n].Right, detections[n].Bottom, detections[n].Width(), detections[n].Height()); 
+		}
+
+		if( numDetections > 0 )
+			totalDetections += numDetections;
+
+		// the copy is queued, and encoded and written while the next image is processed
+		if( writer != NULL )
+		{
+			CUDA(cudaDeviceSynchronize());
+
+			const std::string outputFilename = imageWriter::OutputPath(outputDir, image.filename.c_str(), cmdLine.GetString("output-format"));
+			writer->WriteCopy(outputFilename.c_str(), image.cpu, image.width, image.height);
+		}
+
+		// the buffer can be reused once Detect() returns
+		pool->Release(&image);
+	}
+
+	printf("detectnet-console:  %u objects detected in %zu images\n", totalDetections, filenames.size());
+
+	if( writer != NULL )
+	{
+		writer->Flush();
+		writer->PrintStats();
+	}
+
+	SAFE_DELETE(writer);
+
+	delete pool;
+	return 0;
+}
+
+
 int main( int argc, char** argv )
 {
 	/*
@@ -78,6 +176,20 @@ int main( int argc, char** argv )
 
 	//net->EnableLayerProfiler();
 	
+
+	/*
+	 * process a directory or list of images
+	 */
+	if( decodePool::IsImageList(imgFilename) )
+	{
+		detectImages(net, imgFilename, cmdLine);
+
+		printf("detectnet-console:  shutting down...\n");
+		SAFE_DELETE(net);
+		printf("detectnet-console:  shutdown complete\n");
+		return 0;
+	}
+
 	
 	/*
 	 * load image from disk
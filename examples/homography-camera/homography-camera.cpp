@@ -20,12 +20,13 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
-#include "gstCamera.h"
-#include "glDisplay.h"
+#include "frameSource.h"
+#include "frameSink.h"
 
 #include "cudaWarp.h"
 #include "cudaMappedMemory.h"
 #include "commandLine.h"
+#include "threadConfig.h"
 
 #include "homographyNet.h"
 #include "mat33.h"
@@ -49,6 +50,16 @@ int main( int argc, char** argv )
 {
 	commandLine cmdLine(argc, argv);
 
+	/*
+	 * load the thread configuration
+	 */
+	if( !threadConfig::ParseArgs(argc, argv) )
+	{
+		printf("homography-camera:  invalid thread configuration\n");
+		return 0;
+	}
+
+
 	/*
 	 * setup exit signal handler
 	 */
@@ -59,9 +70,7 @@ int main( int argc, char** argv )
 	/*
 	 * create the camera device
 	 */
-	gstCamera* camera = gstCamera::Create(cmdLine.GetInt("width", gstCamera::DefaultWidth),
-								   cmdLine.GetInt("height", gstCamera::DefaultHeight),
-								   cmdLine.GetString("camera"));
+	frameSource* camera = frameSource::Create(argc, argv);
 
 	if( !camera )
 	{
@@ -106,7 +115,7 @@ int main( int argc, char** argv )
 	/*
 	 * create openGL window
 	 */
-	glDisplay* display = glDisplay::Create();
+	frameSink* display = frameSink::Create(argc, argv);
 	
 	if( !display )
 		printf("homography-camera:  failed to create openGL display\n");
@@ -122,6 +131,13 @@ int main( int argc, char** argv )
 	}
 	
 	printf("homography-camera:  camera open for streaming\n");
+
+
+	/*
+	 * configure the pipeline thread (after the camera and network
+	 * have started their own threads, so they don't inherit it)
+	 */
+	threadConfig::ApplyStage("pipeline", "homography-camera");
 	
 	
 	/*
@@ -138,7 +154,12 @@ int main( int argc, char** argv )
 		float* imgRGBA = NULL;
 
 		if( !camera->CaptureRGBA(&imgRGBA, 1000) )
+		{
+			if( camera->IsEOS() )
+				break;
+
 			printf("homography-camera:  failed to capture frame\n");
+		}
 
 		// make sure we have 2 frames to use
 		if( !lastImg )
@@ -203,6 +224,7 @@ int main( int argc, char** argv )
 	/*
 	 * destroy resources
 	 */
+	threadConfig::Report();
 	printf("homography-camera:  shutting down...\n");
 	
 	SAFE_DELETE(camera);
@@ -20,12 +20,13 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
-#include "gstCamera.h"
-#include "glDisplay.h"
+#include "frameSource.h"
+#include "frameSink.h"
 #include "cudaFont.h"
 
 #include "imageNet.h"
 #include "commandLine.h"
+#include "threadConfig.h"
 
 #include <signal.h>
 
@@ -44,15 +45,17 @@ void sig_handler(int signo)
 int usage()
 {
 	printf("usage: imagenet-camera [-h] [--network NETWORK] [--camera CAMERA]\n");
-	printf("                       [--width WIDTH] [--height HEIGHT]\n\n");
+	printf("                       [--width WIDTH] [--height HEIGHT]\n");
+	printf("                       [--input FILE] [--output FILE] [--headless]\n");
+	printf("                       [--threads FILE] [--thread-pipeline SPEC]\n\n");
 	printf("Classify a live camera stream using an image recognition DNN.\n\n");
 	printf("optional arguments:\n");
 	printf("  --help           show this help message and exit\n");
-	printf("  --camera CAMERA  index of the MIPI CSI camera to use (NULL for CSI camera 0),\n");
-	printf("                   or for VL42 cameras the /dev/video node to use (/dev/video0).\n");
-     printf("                   by default, MIPI CSI camera 0 will be used.\n");
-	printf("  --width WIDTH    desired width of camera stream (default is 1280 pixels)\n");
-	printf("  --height HEIGHT  desired height of camera stream (default is 720 pixels)\n\n");
+	printf("  --threads FILE   thread configuration file (see threadConfig.h)\n");
+	printf("  --thread-pipeline SPEC  configuration of the processing thread, for example\n");
+	printf("                   \"cores=2 policy=fifo priority=50\"\n\n");
+	printf("%s\n", frameSource::Usage());
+	printf("%s\n", frameSink::Usage());
 	printf("%s\n", imageNet::Usage());
 
 	return 0;
@@ -69,6 +72,16 @@ int main( int argc, char** argv )
 		return usage();
 
 	
+	/*
+	 * load the thread configuration
+	 */
+	if( !threadConfig::ParseArgs(argc, argv) )
+	{
+		printf("imagenet-camera:  invalid thread configuration\n");
+		return 0;
+	}
+
+
 	/*
 	 * attach signal handler
 	 */
@@ -79,9 +92,7 @@ int main( int argc, char** argv )
 	/*
 	 * create the camera device
 	 */
-	gstCamera* camera = gstCamera::Create(cmdLine.GetInt("width", gstCamera::DefaultWidth),
-								   cmdLine.GetInt("height", gstCamera::DefaultHeight),
-								   cmdLine.GetString("camera"));
+	frameSource* camera = frameSource::Create(argc, argv);
 	
 	if( !camera )
 	{
@@ -110,7 +121,7 @@ int main( int argc, char** argv )
 	/*
 	 * create display window and overlay font
 	 */
-	glDisplay* display = glDisplay::Create();
+	frameSink* display = frameSink::Create(argc, argv);
 	cudaFont*  font    = cudaFont::Create();
 	
 
@@ -124,6 +135,13 @@ int main( int argc, char** argv )
 	}
 	
 	printf("\nimagenet-camera:  camera open for streaming\n");
+
+
+	/*
+	 * configure the pipeline thread (after the camera and network
+	 * have started their own threads, so they don't inherit it)
+	 */
+	threadConfig::ApplyStage("pipeline", "imagenet-camera");
 	
 	
 	/*
@@ -137,7 +155,12 @@ int main( int argc, char** argv )
 		
 		// get the latest frame
 		if( !camera->CaptureRGBA(&imgRGBA, 1000) )
+		{
+			if( camera->IsEOS() )
+				break;
+
 			printf("\nimagenet-camera:  failed to capture frame\n");
+		}
 
 		// classify image
 		const int img_class = net->Classify(imgRGBA, camera->GetWidth(), camera->GetHeight(), &confidence);
@@ -178,6 +201,7 @@ int main( int argc, char** argv )
 	/*
 	 * destroy resources
 	 */
+	threadConfig::Report();
 	printf("imagenet-camera:  shutting down...\n");
 	
 	SAFE_DELETE(camera);
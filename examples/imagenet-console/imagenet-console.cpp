@@ -21,6 +21,8 @@
  */
 
 #include "imageNet.h"
+#include "decodePool.h"
+#include "imageWriter.h"
 
 #include "commandLine.h"
 #include "loadImage.h"
@@ -29,19 +31,124 @@
 
 int usage()
 {
-	printf("usage: imagenet-console [h] [--network NETWORK]\n");
+	printf("usage: imagenet-console [h] [--network NETWORK] [--decode-threads N]\n");
+	printf("                        [--writer-threads N] [--output-format FORMAT]\n");
 	printf("                        file_in [file_out]\n\n");
 	printf("Classify an image using an image recognition DNN.\n\n");
 	printf("positional arguments:\n");
-	printf("  file_in              filename of the input image to process\n");
-	printf("  file_out             filename of the output image to save (optional)\n\n");
+	printf("  file_in              filename of the input image to process, or a directory\n");
+	printf("                       or list file (.txt) of images to classify\n");
+	printf("  file_out             filename of the output image to save, or the directory\n");
+	printf("                       to save the images of a directory or list to (optional)\n\n");
 	printf("optional arguments:\n");
-	printf("  --help               show this help message and exit\n\n");
+	printf("  --help               show this help message and exit\n");
+	printf("  --decode-threads N   threads decoding the images of a directory or list\n");
+	printf("                       (default is one per CPU core)\n");
+	printf("  --writer-threads N   threads encoding and saving the output images of a\n");
+	printf("                       directory or list in the background (default is 2)\n");
+	printf("  --output-format FORMAT  format of those output images: jpg, png or raw\n");
+	printf("                       (default is the format of each input image)\n\n");
 	printf("%s\n", imageNet::Usage());
 
 	return 0;
 }
 
+
+// classify a directory or list of images, decoded ahead on a pool of threads
+int classifyImages( imageNet* net, const char* path, const commandLine& cmdLine )
+{
+	std::vector<std::string> filenames;
+
+	if( !decodePool::ListImages(path, filenames) )
+		return 0;
+
+	decodePool* pool = decodePool::Create(cmdLine.GetInt("decode-threads", 0));
+
+	if( !pool )
+		return 0;
+
+	// the annotated images are saved in the background, if an output directory was given
+	const char* outputDir = cmdLine.GetPosition(1);
+
+	imageWriter* writer = NULL;
+	cudaFont* font = NULL;
+
+	if( outputDir != NULL )
+	{
+		writer = imageWriter::Create(cmdLine.GetInt("writer-threads", 2));
+
+		if( !writer )
+		{
+			delete pool;
+			return 0;
+		}
+	}
+
+	pool->Submit(filenames);
+	pool->Close();
+
+	decodedImage image;
+	uint32_t classified = 0;
+
+	while( pool->Next(&image) )
+	{
+		if( image.success )
+		{
+			float confidence = 0.0f;
+			const int img_class = net->Classify((float*)image.gpu, image.width, image.height, &confidence);
+
+			if( img_class >= 0 )
+			{
+				printf("imagenet-console:  '%s' -> %2.5f%% class #%i (%s)\n", image.filename.c_str(), confidence * 100.0f, img_class, net->GetClassDesc(img_class));
+				classified++;
+
+				if( writer != NULL )
+				{
+					if( !font )
+						font = cudaFont::Create(adaptFontSize(image.width));
+
+					if( font != NULL )
+					{
+						char str[512];
+						sprintf(str, "%2.3f%% %s", confidence * 100.0f, net->GetClassDesc(img_class));
+
+						font->OverlayText(image.gpu, image.width, image.height, (const char*)str, 10, 10,
+									   make_float4(255, 255, 255, 255), make_float4(0, 0, 0, 100));
+					}
+
+					// the copy is queued, and encoded and written while the next image is classified
+					CUDA(cudaDeviceSynchronize());
+
+					const std::string outputFilename = imageWriter::OutputPath(outputDir, image.filename.c_str(), cmdLine.GetString("output-format"));
+					writer->WriteCopy(outputFilename.c_str(), image.cpu, image.width, image.height);
+				}
+			}
+			else
+				printf("imagenet-console:  failed to classify '%s'  (result=%i)\n", image.filename.c_str(), img_class);
+		}
+		else
+			printf("imagenet-console:  failed to load image '%s'\n", image.filename.c_str());
+
+		// the buffer can be reused once Classify() returns
+		pool->Release(&image);
+	}
+
+	printf("imagenet-console:  classified %u of %zu images\n", classified, filenames.size());
+
+	if( writer != NULL )
+	{
+		writer->Flush();
+		writer->PrintStats();
+	}
+
+	SAFE_DELETE(writer);
+	SAFE_DELETE(font);
+
+	delete pool;
+	return 0;
+}
+
+
 int main( int argc, char** argv )
 {
 	/*
@@ -79,6 +186,20 @@ int main( int argc, char** argv )
 	//net->EnableLayerProfiler();
 	
 
+	/*
+	 * classify a directory or list of images
+	 */
+	if( decodePool::IsImageList(imgFilename) )
+	{
+		classifyImages(net, imgFilename, cmdLine);
+
+		printf("imagenet-console:  shutting down...\n");
+		SAFE_DELETE(net);
+		printf("imagenet-console:  shutdown complete\n");
+		return 0;
+	}
+
+
 	/*
 	 * load image from disk
 	 */
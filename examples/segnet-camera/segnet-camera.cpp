@@ -20,10 +20,11 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
-#include "gstCamera.h"
-#include "glDisplay.h"
+#include "frameSource.h"
+#include "frameSink.h"
 
 #include "commandLine.h"
+#include "threadConfig.h"
 #include "cudaMappedMemory.h"
 
 #include "segNet.h"
@@ -47,6 +48,16 @@ int main( int argc, char** argv )
 {
 	commandLine cmdLine(argc, argv);
 	
+	/*
+	 * load the thread configuration
+	 */
+	if( !threadConfig::ParseArgs(argc, argv) )
+	{
+		printf("segnet-camera:  invalid thread configuration\n");
+		return 0;
+	}
+
+
 	/*
 	 * attach signal handler
 	 */
@@ -57,9 +68,7 @@ int main( int argc, char** argv )
 	/*
 	 * create the camera device
 	 */
-	gstCamera* camera = gstCamera::Create(cmdLine.GetInt("width", gstCamera::DefaultWidth),
-								   cmdLine.GetInt("height", gstCamera::DefaultHeight),
-								   cmdLine.GetString("camera"));
+	frameSource* camera = frameSource::Create(argc, argv);
 
 	if( !camera )
 	{
@@ -101,7 +110,7 @@ int main( int argc, char** argv )
 	/*
 	 * create openGL window
 	 */
-	glDisplay* display = glDisplay::Create();
+	frameSink* display = frameSink::Create(argc, argv);
 	
 	if( !display )
 		printf("segnet-camera:  failed to create openGL display\n");
@@ -117,6 +126,13 @@ int main( int argc, char** argv )
 	}
 	
 	printf("segnet-camera:  camera open for streaming\n");
+
+
+	/*
+	 * configure the pipeline thread (after the camera and network
+	 * have started their own threads, so they don't inherit it)
+	 */
+	threadConfig::ApplyStage("pipeline", "segnet-camera");
 	
 	
 	/*
@@ -130,7 +146,12 @@ int main( int argc, char** argv )
 		float* imgRGBA = NULL;
 		
 		if( !camera->CaptureRGBA(&imgRGBA, 1000, true) )
+		{
+			if( camera->IsEOS() )
+				break;
+
 			printf("segnet-camera:  failed to convert from NV12 to RGBA\n");
+		}
 
 		// process the segmentation network
 		if( !net->Process(imgRGBA, camera->GetWidth(), camera->GetHeight()) )
@@ -167,6 +188,7 @@ int main( int argc, char** argv )
 	/*
 	 * destroy resources
 	 */
+	threadConfig::Report();
 	printf("segnet-camera:  shutting down...\n");
 	
 	SAFE_DELETE(camera);
@@ -21,12 +21,82 @@
  */
 
 #include "segNet.h"
+#include "decodePool.h"
+#include "imageWriter.h"
 
 #include "loadImage.h"
 #include "commandLine.h"
 #include "cudaMappedMemory.h"
 
 
+// segment a directory or list of images into an output directory -- the images are decoded
+// ahead on a pool of threads, and the overlays are rendered straight into the frame buffers
+// of the writer, which encodes and saves them in the background
+int segmentImages( segNet* net, const char* path, const char* outputDir, const commandLine& cmdLine )
+{
+	std::vector<std::string> filenames;
+
+	if( !decodePool::ListImages(path, filenames) )
+		return 0;
+
+	decodePool* pool = decodePool::Create(cmdLine.GetInt("decode-threads", 0));
+	imageWriter* writer = imageWriter::Create(cmdLine.GetInt("writer-threads", 2));
+
+	if( !pool || !writer )
+	{
+		SAFE_DELETE(pool);
+		SAFE_DELETE(writer);
+		return 0;
+	}
+
+	pool->Submit(filenames);
+	pool->Close();
+
+	decodedImage image;
+	uint32_t segmented = 0;
+
+	while( pool->Next(&image) )
+	{
+		float4* outCPU  = NULL;
+		float4* outCUDA = NULL;
+
+		if( !image.success )
+			printf("segnet-console:  failed to load image '%s'\n", image.filename.c_str());
+		else if( !net->Process((float*)image.gpu, image.width, image.height) )
+			printf("segnet-console:  failed to process segmentation of '%s'\n", image.filename.c_str());
+		else if( writer->Acquire(image.width, image.height, &outCPU, &outCUDA) )
+		{
+			if( net->Overlay((float*)outCUDA, image.width, image.height, segNet::FILTER_LINEAR) )
+			{
+				// the overlay is encoded and written while the next image is processed
+				CUDA(cudaDeviceSynchronize());
+
+				const std::string outputFilename = imageWriter::OutputPath(outputDir, image.filename.c_str(), cmdLine.GetString("output-format"));
+
+				if( writer->Write(outputFilename.c_str(), outCPU, image.width, image.height) )
+					segmented++;
+			}
+			else
+			{
+				printf("segnet-console:  failed to generate overlay of '%s'\n", image.filename.c_str());
+				writer->Discard(outCPU);
+			}
+		}
+
+		pool->Release(&image);
+	}
+
+	printf("segnet-console:  segmented %u of %zu images\n", segmented, filenames.size());
+
+	writer->Flush();
+	writer->PrintStats();
+
+	delete writer;
+	delete pool;
+	return 0;
+}
+
+
 int main( int argc, char** argv )
 {
 	commandLine cmdLine(argc, argv);
@@ -41,6 +111,7 @@ int main( int argc, char** argv )
 	if( !imgFilename || !outFilename )
 	{
 		printf("segnet-console:   input and output image filenames required\n");
+		printf("                  (or a directory or list of input images, and an output directory)\n");
 		return 0;
 	}
 
@@ -58,6 +129,23 @@ int main( int argc, char** argv )
 	
 	//net->EnableLayerProfiler();
 
+	// set alpha blending value for classes that don't explicitly already have an alpha	
+	net->SetGlobalAlpha(120);
+
+
+	/*
+	 * segment a directory or list of images into the output directory
+	 */
+	if( decodePool::IsImageList(imgFilename) )
+	{
+		segmentImages(net, imgFilename, outFilename, cmdLine);
+
+		printf("segnet-console:  shutting down...\n");
+		SAFE_DELETE(net);
+		printf("segnet-console:  shutdown complete\n");
+		return 0;
+	}
+
 
 	/*
 	 * load image from disk
@@ -86,10 +174,6 @@ int main( int argc, char** argv )
 		return 0;
 	}
 
-	// set alpha blending value for classes that don't explicitly already have an alpha	
-	net->SetGlobalAlpha(120);
-
-
 	/*
 	 * perform the segmentation
 	 */
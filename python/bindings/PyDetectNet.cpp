@@ -22,6 +22,7 @@
 
 #include "PyTensorNet.h"
 #include "PyDetectNet.h"
+#include "PyInferenceFuture.h"
 
 #include "detectNet.h"
 
@@ -568,6 +569,174 @@ static int PyDetectNet_Init( PyDetectNet_Object* self, PyObject *args, PyObject
 }
 
 
+// detectImages (called without the GIL)
+static bool detectImages( detectNet* net, float** images, uint32_t numImages, uint32_t width, uint32_t height, uint32_t overlay,
+					 std::vector< std::vector<detectNet::Detection> >& results )
+{
+	const uint32_t maxBatchSize = net->GetMaxBatchSize();
+
+	std::vector<detectNet::Detection*> detections(maxBatchSize);
+	std::vector<int> numDetections(maxBatchSize);
+
+	results.resize(numImages);
+
+	// split the list into batches of the size that the network was loaded with
+	for( uint32_t n=0; n < numImages; n += maxBatchSize )
+	{
+		const uint32_t batchSize = (numImages - n < maxBatchSize) ? (numImages - n) : maxBatchSize;
+
+		if( !net->DetectBatch(images + n, width, height, batchSize, &detections[0], &numDetections[0], overlay) )
+			return false;
+
+		// copy the results out of the network's ring of detection sets
+		for( uint32_t b=0; b < batchSize; b++ )
+		{
+			if( numDetections[b] < 0 )
+				return false;
+
+			results[n+b].assign(detections[b], detections[b] + numDetections[b]);
+		}
+	}
+
+	return true;
+}
+
+
+// detectionList
+static PyObject* detectionList( const detectNet::Detection* detections, int numDetections )
+{
+	PyObject* list = PyList_New(numDetections);
+
+	if( !list )
+		return NULL;
+
+	for( int n=0; n < numDetections; n++ )
+	{
+		PyDetection_Object* pyDetection = PyObject_New(PyDetection_Object, &pyDetection_Type);
+
+		if( !pyDetection )
+		{
+			PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "detectNet failed to create a new detectNet.Detection object");
+			Py_DECREF(list);
+			return NULL;
+		}
+
+		pyDetection->det = detections[n];
+		PyList_SET_ITEM(list, n, (PyObject*)pyDetection);
+	}
+
+	return list;
+}
+
+
+// detectionLists
+static PyObject* detectionLists( const std::vector< std::vector<detectNet::Detection> >& results )
+{
+	const size_t numImages = results.size();
+	PyObject* list = PyList_New(numImages);
+
+	if( !list )
+		return NULL;
+
+	for( size_t n=0; n < numImages; n++ )
+	{
+		PyObject* detections = detectionList(results[n].empty() ? NULL : &results[n][0], results[n].size());
+
+		if( !detections )
+		{
+			Py_DECREF(list);
+			return NULL;
+		}
+
+		PyList_SET_ITEM(list, n, detections);
+	}
+
+	return list;
+}
+
+
+// parseBatchArgs
+static bool parseBatchArgs( PyObject* args, PyObject* kwds, bool batch, const char* function,
+					   PyObject** images, std::vector<float*>& imagePtrs, int* width, int* height, int* overlay )
+{
+	static char* kwlist_batch[]  = {"images", "width", "height", "overlay", NULL};
+	static char* kwlist_single[] = {"image", "width", "height", "overlay", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "Oii|i", batch ? kwlist_batch : kwlist_single, images, width, height, overlay))
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s failed to parse args tuple", function);
+		return false;
+	}
+
+	if( *width <= 0 || *height <= 0 )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s image dimensions are invalid", function);
+		return false;
+	}
+
+	if( batch )
+		return PyInference_ParseImageList(*images, imagePtrs, function);
+
+	void* img = PyCUDA_GetPointer(*images);
+
+	if( !img )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s failed to get image pointer from PyCapsule container", function);
+		return false;
+	}
+
+	imagePtrs.assign(1, (float*)img);
+	return true;
+}
+
+
+// overlayFlags
+static inline uint32_t overlayFlags( int overlay )
+{
+	return overlay > 0 ? detectNet::OVERLAY_BOX/*|detectNet::OVERLAY_LABEL*/ : detectNet::OVERLAY_NONE;
+}
+
+
+// Asynchronous detection request
+class PyDetectJob : public PyInferenceJob
+{
+public:
+	PyDetectJob( detectNet* net, const std::vector<float*>& images, uint32_t width, uint32_t height, uint32_t overlay, bool batch )
+		: mNet(net), mImages(images), mWidth(width), mHeight(height), mOverlay(overlay), mBatch(batch)
+	{
+	}
+
+	virtual bool Execute()
+	{
+		if( !detectImages(mNet, &mImages[0], mImages.size(), mWidth, mHeight, mOverlay, mResults) )
+		{
+			mError = "detectNet async request encountered an error processing the image";
+			return false;
+		}
+
+		return true;
+	}
+
+	virtual PyObject* Result()
+	{
+		if( !mBatch )
+			return detectionList(mResults[0].empty() ? NULL : &mResults[0][0], mResults[0].size());
+
+		return detectionLists(mResults);
+	}
+
+private:
+	detectNet* mNet;
+	std::vector<float*> mImages;
+	std::vector< std::vector<detectNet::Detection> > mResults;
+
+	uint32_t mWidth;
+	uint32_t mHeight;
+	uint32_t mOverlay;
+	bool     mBatch;
+};
+
+
 #define DOC_DETECT   "Detect objects in an RGBA image and return a list of detections.\n\n" \
 				 "Parameters:\n" \
 				 "  image   (capsule) -- CUDA memory capsule\n" \
@@ -619,8 +788,13 @@ static PyObject* PyDetectNet_Detect( PyDetectNet_Object* self, PyObject* args, P
 
 	// run the object detection
 	detectNet::Detection* detections = NULL;
+	int numDetections = 0;
 
-	const int numDetections = self->net->Detect((float*)img, width, height, &detections, overlay > 0 ? detectNet::OVERLAY_BOX/*|detectNet::OVERLAY_LABEL*/ : detectNet::OVERLAY_NONE);
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	numDetections = self->net->Detect((float*)img, width, height, &detections, overlayFlags(overlay));
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
 
 	if( numDetections < 0 )
 	{
@@ -629,23 +803,128 @@ static PyObject* PyDetectNet_Detect( PyDetectNet_Object* self, PyObject* args, P
 	}
 
 	// create output objects
-	PyObject* list = PyList_New(numDetections);
+	return detectionList(detections, numDetections);
+}
+
 
-	for( uint32_t n=0; n < numDetections; n++ )
+#define DOC_DETECT_BATCH "Detect objects in a list of RGBA images, processing them in batches of up to the max batch size\n" \
+					"of the network, and return a list of detections for each image.\n\n" \
+					"Parameters:\n" \
+					"  images  (list) -- list of CUDA memory capsules, all with the same dimensions\n" \
+					"  width   (int)  -- width of the images (in pixels)\n" \
+					"  height  (int)  -- height of the images (in pixels)\n" \
+					"  overlay (bool) -- true to overlay the bounding boxes (default is true)\n\n" \
+					"Returns:\n" \
+					"  [[Detections]] -- list containing a list of the detected objects for each image"
+
+// DetectBatch
+static PyObject* PyDetectNet_DetectBatch( PyDetectNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
 	{
-		PyDetection_Object* pyDetection = PyObject_New(PyDetection_Object, &pyDetection_Type);
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "detectNet invalid object instance");
+		return NULL;
+	}
 
-		if( !pyDetection )
-		{
-			PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "detectNet.Detect() failed to create a new detectNet.Detection object");
-			return NULL;
-		}
+	PyObject* images = NULL;
+	std::vector<float*> imagePtrs;
 
-		pyDetection->det = detections[n];
-		PyList_SET_ITEM(list, n, (PyObject*)pyDetection);
+	int width = 0;
+	int height = 0;
+	int overlay = 1;
+
+	if( !parseBatchArgs(args, kwds, true, "detectNet.DetectBatch()", &images, imagePtrs, &width, &height, &overlay) )
+		return NULL;
+
+	// run the object detection without holding the GIL
+	std::vector< std::vector<detectNet::Detection> > results;
+	bool result = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	result = detectImages(self->net, &imagePtrs[0], imagePtrs.size(), width, height, overlayFlags(overlay), results);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	if( !result )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "detectNet.DetectBatch() encountered an error processing the images");
+		return NULL;
 	}
 
-	return list;
+	return detectionLists(results);
+}
+
+
+#define DOC_DETECT_ASYNC "Asynchronously detect objects in an RGBA image.  The image is processed by a native worker\n" \
+					"thread of the network, so the image memory should not be modified until it completes.\n\n" \
+					"Parameters:\n" \
+					"  image   (capsule) -- CUDA memory capsule\n" \
+					"  width   (int)  -- width of the image (in pixels)\n" \
+					"  height  (int)  -- height of the image (in pixels)\n" \
+					"  overlay (bool) -- true to overlay the bounding boxes (default is true)\n\n" \
+					"Returns:\n" \
+					"  (inferenceFuture) -- future whose result() is the list of detections"
+
+// DetectAsync
+static PyObject* PyDetectNet_DetectAsync( PyDetectNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "detectNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* image = NULL;
+	std::vector<float*> imagePtrs;
+
+	int width = 0;
+	int height = 0;
+	int overlay = 1;
+
+	if( !parseBatchArgs(args, kwds, false, "detectNet.DetectAsync()", &image, imagePtrs, &width, &height, &overlay) )
+		return NULL;
+
+	PyDetectJob* job = new PyDetectJob(self->net, imagePtrs, width, height, overlayFlags(overlay), false);
+	job->KeepAlive(image);
+
+	return PyInferenceFuture_Submit(&self->base, job);
+}
+
+
+#define DOC_DETECT_BATCH_ASYNC "Asynchronously detect objects in a list of RGBA images, like DetectBatch().  The images are processed\n" \
+						  "by a native worker thread of the network, so their memory should not be modified until it completes.\n\n" \
+						  "Parameters:\n" \
+						  "  images  (list) -- list of CUDA memory capsules, all with the same dimensions\n" \
+						  "  width   (int)  -- width of the images (in pixels)\n" \
+						  "  height  (int)  -- height of the images (in pixels)\n" \
+						  "  overlay (bool) -- true to overlay the bounding boxes (default is true)\n\n" \
+						  "Returns:\n" \
+						  "  (inferenceFuture) -- future whose result() is a list of detections for each image"
+
+// DetectBatchAsync
+static PyObject* PyDetectNet_DetectBatchAsync( PyDetectNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "detectNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* images = NULL;
+	std::vector<float*> imagePtrs;
+
+	int width = 0;
+	int height = 0;
+	int overlay = 1;
+
+	if( !parseBatchArgs(args, kwds, true, "detectNet.DetectBatchAsync()", &images, imagePtrs, &width, &height, &overlay) )
+		return NULL;
+
+	PyDetectJob* job = new PyDetectJob(self->net, imagePtrs, width, height, overlayFlags(overlay), true);
+	job->KeepAlive(images);
+
+	return PyInferenceFuture_Submit(&self->base, job);
 }
 
 
@@ -799,6 +1078,9 @@ static PyTypeObject pyDetectNet_Type =
 static PyMethodDef pyDetectNet_Methods[] =
 {
 	{ "Detect", (PyCFunction)PyDetectNet_Detect, METH_VARARGS|METH_KEYWORDS, DOC_DETECT},
+	{ "DetectBatch", (PyCFunction)PyDetectNet_DetectBatch, METH_VARARGS|METH_KEYWORDS, DOC_DETECT_BATCH},
+	{ "DetectAsync", (PyCFunction)PyDetectNet_DetectAsync, METH_VARARGS|METH_KEYWORDS, DOC_DETECT_ASYNC},
+	{ "DetectBatchAsync", (PyCFunction)PyDetectNet_DetectBatchAsync, METH_VARARGS|METH_KEYWORDS, DOC_DETECT_BATCH_ASYNC},
 	{ "GetThreshold", (PyCFunction)PyDetectNet_GetThreshold, METH_NOARGS, DOC_GET_THRESHOLD},
 	{ "SetThreshold", (PyCFunction)PyDetectNet_SetThreshold, METH_VARARGS, DOC_SET_THRESHOLD},
 	{ "GetNumClasses", (PyCFunction)PyDetectNet_GetNumClasses, METH_NOARGS, DOC_GET_NUM_CLASSES},
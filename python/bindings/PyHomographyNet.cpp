@@ -0,0 +1,595 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "PyTensorNet.h"
+#include "PyHomographyNet.h"
+#include "PyInferenceFuture.h"
+
+#include "homographyNet.h"
+
+#include "../../utils/python/bindings/PyCUDA.h"
+
+
+typedef struct {
+    PyTensorNet_Object base;
+    homographyNet* net;	// object instance
+} PyHomographyNet_Object;
+
+
+#define DOC_HOMOGRAPHYNET "Homography Estimation DNN - finds the perspective warp between two images\n\n" \
+				  "__init__(...)\n" \
+				  "     Loads a homography estimation model.\n\n" \
+				  "     Parameters:\n" \
+				  "       network (string) -- name of a built-in network to use ('coco_128' or 'webcam_320').\n" \
+				  "                           the default is 'webcam_320'\n\n" \
+				  "       argv (strings) -- command line arguments passed to homographyNet\n" \
+				  "                         (--model, --input_blob, --output_blob, --batch_size)\n\n"
+
+
+// Init
+static int PyHomographyNet_Init( PyHomographyNet_Object* self, PyObject *args, PyObject *kwds )
+{
+	printf(LOG_PY_INFERENCE "PyHomographyNet_Init()\n");
+
+	// parse arguments
+	PyObject* argList     = NULL;
+	const char* network   = "webcam_320";
+	static char* kwlist[] = {"network", "argv", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "|sO", kwlist, &network, &argList))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.__init()__ failed to parse args tuple");
+		return -1;
+	}
+
+	// determine whether to use argv or built-in network
+	if( argList != NULL && PyList_Check(argList) && PyList_Size(argList) > 0 )
+	{
+		printf(LOG_PY_INFERENCE "homographyNet loading network using argv command line params\n");
+
+		// parse the python list into char**
+		const size_t argc = PyList_Size(argList);
+
+		char** argv = (char**)malloc(sizeof(char*) * argc);
+
+		if( !argv )
+		{
+			PyErr_SetString(PyExc_MemoryError, LOG_PY_INFERENCE "homographyNet.__init()__ failed to malloc memory for argv list");
+			return -1;
+		}
+
+		for( size_t n=0; n < argc; n++ )
+		{
+			PyObject* item = PyList_GetItem(argList, n);
+
+			if( !PyArg_Parse(item, "s", &argv[n]) )
+			{
+				PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.__init()__ failed to parse argv list");
+				free(argv);
+				return -1;
+			}
+
+			printf(LOG_PY_INFERENCE "homographyNet.__init__() argv[%zu] = '%s'\n", n, argv[n]);
+		}
+
+		// load the network using (argc, argv)
+		self->net = homographyNet::Create(argc, argv);
+
+		// free the arguments array
+		free(argv);
+	}
+	else
+	{
+		printf(LOG_PY_INFERENCE "homographyNet loading build-in network '%s'\n", network);
+
+		// parse the selected built-in network
+		homographyNet::NetworkType networkType = homographyNet::NetworkTypeFromStr(network);
+
+		if( networkType == homographyNet::CUSTOM )
+		{
+			PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet invalid built-in network was requested");
+			printf(LOG_PY_INFERENCE "homographyNet invalid built-in network was requested ('%s')\n", network);
+			return -1;
+		}
+
+		// load the built-in network
+		self->net = homographyNet::Create(networkType);
+	}
+
+	// confirm the network loaded
+	if( !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet failed to load network");
+		printf(LOG_PY_INFERENCE "homographyNet failed to load network '%s'\n", network);
+		return -1;
+	}
+
+	self->base.net = self->net;
+	return 0;
+}
+
+
+// matrixToList
+static PyObject* matrixToList( const float H[3][3] )
+{
+	return Py_BuildValue("[[fff][fff][fff]]", H[0][0], H[0][1], H[0][2],
+									  H[1][0], H[1][1], H[1][2],
+									  H[2][0], H[2][1], H[2][2]);
+}
+
+
+// homographyResult
+static PyObject* homographyResult( const float H[3][3], const float H_inv[3][3] )
+{
+	PyObject* pyH    = matrixToList(H);
+	PyObject* pyHinv = matrixToList(H_inv);
+
+	PyObject* tuple = NULL;
+
+	if( pyH != NULL && pyHinv != NULL )
+		tuple = PyTuple_Pack(2, pyH, pyHinv);
+
+	Py_XDECREF(pyH);
+	Py_XDECREF(pyHinv);
+
+	return tuple;
+}
+
+
+// parseImagePair
+static bool parseImagePair( PyObject* args, PyObject* kwds, const char* function, float** imageA, float** imageB, int* width, int* height )
+{
+	PyObject* capsuleA = NULL;
+	PyObject* capsuleB = NULL;
+
+	static char* kwlist[] = {"imageA", "imageB", "width", "height", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "OOii", kwlist, &capsuleA, &capsuleB, width, height))
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s failed to parse args tuple", function);
+		return false;
+	}
+
+	if( *width <= 0 || *height <= 0 )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s image dimensions are invalid", function);
+		return false;
+	}
+
+	*imageA = (float*)PyCUDA_GetPointer(capsuleA);
+	*imageB = (float*)PyCUDA_GetPointer(capsuleB);
+
+	if( !*imageA || !*imageB )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s failed to get image pointer from PyCapsule container", function);
+		return false;
+	}
+
+	return true;
+}
+
+
+// findHomographies (called without the GIL)
+static bool findHomographies( homographyNet* net, float** imagesA, float** imagesB, uint32_t numPairs, uint32_t width, uint32_t height,
+					     std::vector<float>& H, std::vector<float>& H_inv )
+{
+	const uint32_t maxBatchSize = net->GetMaxBatchSize();
+
+	H.resize(numPairs * 9);
+	H_inv.resize(numPairs * 9);
+
+	// split the pairs into batches of the size that the network was loaded with
+	for( uint32_t n=0; n < numPairs; n += maxBatchSize )
+	{
+		const uint32_t batchSize = (numPairs - n < maxBatchSize) ? (numPairs - n) : maxBatchSize;
+
+		if( !net->FindHomographyBatch(imagesA + n, imagesB + n, width, height, batchSize,
+								(float(*)[3][3])&H[n * 9], (float(*)[3][3])&H_inv[n * 9]) )
+			return false;
+	}
+
+	return true;
+}
+
+
+// homographyResultList
+static PyObject* homographyResultList( const std::vector<float>& H, const std::vector<float>& H_inv )
+{
+	const size_t numPairs = H.size() / 9;
+	PyObject* list = PyList_New(numPairs);
+
+	if( !list )
+		return NULL;
+
+	for( size_t n=0; n < numPairs; n++ )
+	{
+		PyObject* tuple = homographyResult((const float(*)[3])&H[n * 9], (const float(*)[3])&H_inv[n * 9]);
+
+		if( !tuple )
+		{
+			Py_DECREF(list);
+			return NULL;
+		}
+
+		PyList_SET_ITEM(list, n, tuple);
+	}
+
+	return list;
+}
+
+
+#define DOC_FIND_DISPLACEMENT "Find the displacement of the four corners from imageA to imageB.\n\n" \
+					    "Parameters:\n" \
+					    "  imageA (capsule) -- CUDA memory capsule (RGBA)\n" \
+					    "  imageB (capsule) -- CUDA memory capsule (RGBA), with the same dimensions as imageA\n" \
+					    "  width  (int) -- width of the images (in pixels)\n" \
+					    "  height (int) -- height of the images (in pixels)\n\n" \
+					    "Returns:\n" \
+					    "  [float] -- list of the 8 (x,y) corner displacements, in pixels of the network's input"
+
+// FindDisplacement
+static PyObject* PyHomographyNet_FindDisplacement( PyHomographyNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet invalid object instance");
+		return NULL;
+	}
+
+	float* imageA = NULL;
+	float* imageB = NULL;
+
+	int width  = 0;
+	int height = 0;
+
+	if( !parseImagePair(args, kwds, "homographyNet.FindDisplacement()", &imageA, &imageB, &width, &height) )
+		return NULL;
+
+	float displacement[8];
+	bool result = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	result = self->net->FindDisplacement(imageA, imageB, width, height, displacement);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	if( !result )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.FindDisplacement() encountered an error processing the images");
+		return NULL;
+	}
+
+	return Py_BuildValue("[ffffffff]", displacement[0], displacement[1], displacement[2], displacement[3],
+								displacement[4], displacement[5], displacement[6], displacement[7]);
+}
+
+
+#define DOC_FIND_HOMOGRAPHY "Find the homography that warps imageA to imageB.\n\n" \
+					  "Parameters:\n" \
+					  "  imageA (capsule) -- CUDA memory capsule (RGBA)\n" \
+					  "  imageB (capsule) -- CUDA memory capsule (RGBA), with the same dimensions as imageA\n" \
+					  "  width  (int) -- width of the images (in pixels)\n" \
+					  "  height (int) -- height of the images (in pixels)\n\n" \
+					  "Returns:\n" \
+					  "  (H, H_inv) -- tuple of the 3x3 homography and its inverse (as nested lists)"
+
+// FindHomography
+static PyObject* PyHomographyNet_FindHomography( PyHomographyNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet invalid object instance");
+		return NULL;
+	}
+
+	float* imageA = NULL;
+	float* imageB = NULL;
+
+	int width  = 0;
+	int height = 0;
+
+	if( !parseImagePair(args, kwds, "homographyNet.FindHomography()", &imageA, &imageB, &width, &height) )
+		return NULL;
+
+	float H[3][3];
+	float H_inv[3][3];
+
+	bool result = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	result = self->net->FindHomography(imageA, imageB, width, height, H, H_inv);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	if( !result )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.FindHomography() encountered an error processing the images");
+		return NULL;
+	}
+
+	return homographyResult(H, H_inv);
+}
+
+
+#define DOC_COMPUTE_HOMOGRAPHY "Compute the homography from the displacement returned by FindDisplacement().\n\n" \
+					     "Parameters:\n" \
+					     "  displacement ([float]) -- sequence of the 8 corner displacements\n\n" \
+					     "Returns:\n" \
+					     "  (H, H_inv) -- tuple of the 3x3 homography and its inverse (as nested lists)"
+
+// ComputeHomography
+static PyObject* PyHomographyNet_ComputeHomography( PyHomographyNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* pyDisplacement = NULL;
+	static char* kwlist[] = {"displacement", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &pyDisplacement))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.ComputeHomography() failed to parse args tuple");
+		return NULL;
+	}
+
+	PyObject* seq = PySequence_Fast(pyDisplacement, "homographyNet.ComputeHomography() expects a sequence of 8 floats");
+
+	if( !seq )
+		return NULL;
+
+	if( PySequence_Fast_GET_SIZE(seq) != 8 )
+	{
+		Py_DECREF(seq);
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.ComputeHomography() expects a sequence of 8 floats");
+		return NULL;
+	}
+
+	float displacement[8];
+
+	for( uint32_t n=0; n < 8; n++ )
+		displacement[n] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(seq, n));
+
+	Py_DECREF(seq);
+
+	if( PyErr_Occurred() )
+		return NULL;
+
+	float H[3][3];
+	float H_inv[3][3];
+
+	bool result = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	result = self->net->ComputeHomography(displacement, H, H_inv);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	if( !result )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.ComputeHomography() failed to compute the homography");
+		return NULL;
+	}
+
+	return homographyResult(H, H_inv);
+}
+
+
+#define DOC_FIND_HOMOGRAPHY_BATCH "Find the homographies for lists of image pairs, processing them in batches of up to the\n" \
+						    "max batch size of the network.\n\n" \
+						    "Parameters:\n" \
+						    "  imagesA (list) -- list of CUDA memory capsules (RGBA)\n" \
+						    "  imagesB (list) -- list of CUDA memory capsules (RGBA), the same length as imagesA\n" \
+						    "  width   (int) -- width of the images (in pixels)\n" \
+						    "  height  (int) -- height of the images (in pixels)\n\n" \
+						    "Returns:\n" \
+						    "  [(H, H_inv)] -- list of the homographies that warp imagesA[n] to imagesB[n]"
+
+// FindHomographyBatch
+static PyObject* PyHomographyNet_FindHomographyBatch( PyHomographyNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* listA = NULL;
+	PyObject* listB = NULL;
+
+	int width  = 0;
+	int height = 0;
+
+	static char* kwlist[] = {"imagesA", "imagesB", "width", "height", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "OOii", kwlist, &listA, &listB, &width, &height))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.FindHomographyBatch() failed to parse args tuple");
+		return NULL;
+	}
+
+	if( width <= 0 || height <= 0 )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.FindHomographyBatch() image dimensions are invalid");
+		return NULL;
+	}
+
+	std::vector<float*> imagesA;
+	std::vector<float*> imagesB;
+
+	if( !PyInference_ParseImageList(listA, imagesA, "homographyNet.FindHomographyBatch()") ||
+	    !PyInference_ParseImageList(listB, imagesB, "homographyNet.FindHomographyBatch()") )
+		return NULL;
+
+	if( imagesA.size() != imagesB.size() )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.FindHomographyBatch() imagesA and imagesB should be the same length");
+		return NULL;
+	}
+
+	std::vector<float> H;
+	std::vector<float> H_inv;
+
+	bool result = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	result = findHomographies(self->net, &imagesA[0], &imagesB[0], imagesA.size(), width, height, H, H_inv);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	if( !result )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.FindHomographyBatch() encountered an error processing the images");
+		return NULL;
+	}
+
+	return homographyResultList(H, H_inv);
+}
+
+
+#define DOC_FIND_HOMOGRAPHY_SEQUENCE "Find the homographies between each pair of consecutive frames of a video sequence,\n" \
+						       "processing them in batches of up to the max batch size of the network.\n\n" \
+						       "Parameters:\n" \
+						       "  frames (list) -- list of CUDA memory capsules (RGBA), in the order they were captured\n" \
+						       "  width  (int) -- width of the frames (in pixels)\n" \
+						       "  height (int) -- height of the frames (in pixels)\n\n" \
+						       "Returns:\n" \
+						       "  [(H, H_inv)] -- list of len(frames)-1 homographies that warp frames[n] to frames[n+1]"
+
+// FindHomographySequence
+static PyObject* PyHomographyNet_FindHomographySequence( PyHomographyNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* list = NULL;
+
+	int width  = 0;
+	int height = 0;
+
+	static char* kwlist[] = {"frames", "width", "height", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "Oii", kwlist, &list, &width, &height))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.FindHomographySequence() failed to parse args tuple");
+		return NULL;
+	}
+
+	if( width <= 0 || height <= 0 )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.FindHomographySequence() image dimensions are invalid");
+		return NULL;
+	}
+
+	std::vector<float*> frames;
+
+	if( !PyInference_ParseImageList(list, frames, "homographyNet.FindHomographySequence()") )
+		return NULL;
+
+	if( frames.size() < 2 )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.FindHomographySequence() requires at least 2 frames");
+		return NULL;
+	}
+
+	// pair each frame with the one after it
+	const uint32_t numPairs = frames.size() - 1;
+
+	std::vector<float> H;
+	std::vector<float> H_inv;
+
+	bool result = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	result = findHomographies(self->net, &frames[0], &frames[1], numPairs, width, height, H, H_inv);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	if( !result )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "homographyNet.FindHomographySequence() encountered an error processing the frames");
+		return NULL;
+	}
+
+	return homographyResultList(H, H_inv);
+}
+
+
+//-------------------------------------------------------------------------------
+static PyTypeObject pyHomographyNet_Type =
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+};
+
+static PyMethodDef pyHomographyNet_Methods[] =
+{
+	{ "FindDisplacement", (PyCFunction)PyHomographyNet_FindDisplacement, METH_VARARGS|METH_KEYWORDS, DOC_FIND_DISPLACEMENT},
+	{ "FindHomography", (PyCFunction)PyHomographyNet_FindHomography, METH_VARARGS|METH_KEYWORDS, DOC_FIND_HOMOGRAPHY},
+	{ "ComputeHomography", (PyCFunction)PyHomographyNet_ComputeHomography, METH_VARARGS|METH_KEYWORDS, DOC_COMPUTE_HOMOGRAPHY},
+	{ "FindHomographyBatch", (PyCFunction)PyHomographyNet_FindHomographyBatch, METH_VARARGS|METH_KEYWORDS, DOC_FIND_HOMOGRAPHY_BATCH},
+	{ "FindHomographySequence", (PyCFunction)PyHomographyNet_FindHomographySequence, METH_VARARGS|METH_KEYWORDS, DOC_FIND_HOMOGRAPHY_SEQUENCE},
+	{NULL}  /* Sentinel */
+};
+
+// Register type
+bool PyHomographyNet_Register( PyObject* module )
+{
+	if( !module )
+		return false;
+
+	pyHomographyNet_Type.tp_name		= PY_INFERENCE_MODULE_NAME ".homographyNet";
+	pyHomographyNet_Type.tp_basicsize	= sizeof(PyHomographyNet_Object);
+	pyHomographyNet_Type.tp_flags		= Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+	pyHomographyNet_Type.tp_base		= PyTensorNet_Type();
+	pyHomographyNet_Type.tp_methods	= pyHomographyNet_Methods;
+	pyHomographyNet_Type.tp_new		= NULL;
+	pyHomographyNet_Type.tp_init		= (initproc)PyHomographyNet_Init;
+	pyHomographyNet_Type.tp_dealloc	= NULL;
+	pyHomographyNet_Type.tp_doc		= DOC_HOMOGRAPHYNET;
+
+	if( PyType_Ready(&pyHomographyNet_Type) < 0 )
+	{
+		printf(LOG_PY_INFERENCE "homographyNet PyType_Ready() failed\n");
+		return false;
+	}
+
+	Py_INCREF(&pyHomographyNet_Type);
+
+	if( PyModule_AddObject(module, "homographyNet", (PyObject*)&pyHomographyNet_Type) < 0 )
+	{
+		printf(LOG_PY_INFERENCE "homographyNet PyModule_AddObject('homographyNet') failed\n");
+		return false;
+	}
+
+	return true;
+}
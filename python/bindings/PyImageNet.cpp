@@ -22,6 +22,7 @@
 
 #include "PyTensorNet.h"
 #include "PyImageNet.h"
+#include "PyInferenceFuture.h"
 
 #include "imageNet.h"
 
@@ -138,6 +139,142 @@ static int PyImageNet_Init( PyImageNet_Object* self, PyObject *args, PyObject *k
 }
 
 
+// classifyImages (called without the GIL)
+static bool classifyImages( imageNet* net, float** images, uint32_t numImages, uint32_t width, uint32_t height, int* classes, float* confidence )
+{
+	const uint32_t maxBatchSize = net->GetMaxBatchSize();
+
+	// split the list into batches of the size that the network was loaded with
+	for( uint32_t n=0; n < numImages; n += maxBatchSize )
+	{
+		const uint32_t batchSize = (numImages - n < maxBatchSize) ? (numImages - n) : maxBatchSize;
+
+		if( !net->ClassifyBatch(images + n, width, height, batchSize, classes + n, confidence + n) )
+			return false;
+	}
+
+	return true;
+}
+
+
+// classifyResult
+static PyObject* classifyResult( int img_class, float confidence )
+{
+	PyObject* pyClass = PYLONG_FROM_LONG(img_class);
+	PyObject* pyConf  = PyFloat_FromDouble(confidence);
+
+	PyObject* tuple = PyTuple_Pack(2, pyClass, pyConf);
+
+	Py_DECREF(pyClass);
+	Py_DECREF(pyConf);
+
+	return tuple;
+}
+
+
+// classifyResultList
+static PyObject* classifyResultList( const std::vector<int>& classes, const std::vector<float>& confidence )
+{
+	const size_t numImages = classes.size();
+	PyObject* list = PyList_New(numImages);
+
+	if( !list )
+		return NULL;
+
+	for( size_t n=0; n < numImages; n++ )
+	{
+		PyObject* tuple = classifyResult(classes[n], confidence[n]);
+
+		if( !tuple )
+		{
+			Py_DECREF(list);
+			return NULL;
+		}
+
+		PyList_SET_ITEM(list, n, tuple);
+	}
+
+	return list;
+}
+
+
+// parseBatchArgs
+static bool parseBatchArgs( PyObject* args, PyObject* kwds, bool batch, const char* function,
+					   PyObject** images, std::vector<float*>& imagePtrs, int* width, int* height )
+{
+	static char* kwlist_batch[]  = {"images", "width", "height", NULL};
+	static char* kwlist_single[] = {"image", "width", "height", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "Oii", batch ? kwlist_batch : kwlist_single, images, width, height))
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s failed to parse args tuple", function);
+		return false;
+	}
+
+	if( *width <= 0 || *height <= 0 )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s image dimensions are invalid", function);
+		return false;
+	}
+
+	if( batch )
+		return PyInference_ParseImageList(*images, imagePtrs, function);
+
+	void* img = PyCUDA_GetPointer(*images);
+
+	if( !img )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s failed to get image pointer from PyCapsule container", function);
+		return false;
+	}
+
+	imagePtrs.assign(1, (float*)img);
+	return true;
+}
+
+
+// Asynchronous classification request
+class PyClassifyJob : public PyInferenceJob
+{
+public:
+	PyClassifyJob( imageNet* net, const std::vector<float*>& images, uint32_t width, uint32_t height, bool batch )
+		: mNet(net), mImages(images), mWidth(width), mHeight(height), mBatch(batch)
+	{
+		mClasses.resize(images.size());
+		mConfidence.resize(images.size());
+	}
+
+	virtual bool Execute()
+	{
+		if( !classifyImages(mNet, &mImages[0], mImages.size(), mWidth, mHeight, &mClasses[0], &mConfidence[0]) )
+		{
+			mError = "imageNet async request encountered an error classifying the image";
+			return false;
+		}
+
+		return true;
+	}
+
+	virtual PyObject* Result()
+	{
+		if( !mBatch )
+			return classifyResult(mClasses[0], mConfidence[0]);
+
+		return classifyResultList(mClasses, mConfidence);
+	}
+
+private:
+	imageNet* mNet;
+	std::vector<float*> mImages;
+	std::vector<int>    mClasses;
+	std::vector<float>  mConfidence;
+
+	uint32_t mWidth;
+	uint32_t mHeight;
+	bool     mBatch;
+};
+
+
 #define DOC_CLASSIFY "Classify an RGBA image and return the object's class and confidence.\n\n" \
 				 "Parameters:\n" \
 				 "  image  (capsule) -- CUDA memory capsule\n" \
@@ -188,8 +325,13 @@ static PyObject* PyImageNet_Classify( PyImageNet_Object* self, PyObject* args, P
 
 	// classify the image
 	float confidence = 0.0f;
+	int img_class = -1;
 
-	const int img_class = self->net->Classify((float*)img, width, height, &confidence);
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	img_class = self->net->Classify((float*)img, width, height, &confidence);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
 
 	if( img_class < 0 )
 	{
@@ -197,18 +339,127 @@ static PyObject* PyImageNet_Classify( PyImageNet_Object* self, PyObject* args, P
 		return NULL;
 	}
 
-	// create output objects
-	PyObject* pyClass = PYLONG_FROM_LONG(img_class);
-	PyObject* pyConf  = PyFloat_FromDouble(confidence);
+	// return (class, confidence) tuple
+	return classifyResult(img_class, confidence);
+}
 
-	// return tuple
-	PyObject* tuple = PyTuple_Pack(2, pyClass, pyConf);
 
-	Py_DECREF(pyClass);
-	Py_DECREF(pyConf);
+#define DOC_CLASSIFY_BATCH "Classify a list of RGBA images, processing them in batches of up to the max batch size\n" \
+					  "of the network, and return the class and confidence of each image.\n\n" \
+					  "Parameters:\n" \
+					  "  images (list) -- list of CUDA memory capsules, all with the same dimensions\n" \
+					  "  width  (int) -- width of the images (in pixels)\n" \
+					  "  height (int) -- height of the images (in pixels)\n\n" \
+					  "Returns:\n" \
+					  "  [(int, float)] -- list of (class index, confidence) tuples, one per image"
 
-	return tuple;
+// ClassifyBatch
+static PyObject* PyImageNet_ClassifyBatch( PyImageNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "imageNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* images = NULL;
+	std::vector<float*> imagePtrs;
+
+	int width = 0;
+	int height = 0;
+
+	if( !parseBatchArgs(args, kwds, true, "imageNet.ClassifyBatch()", &images, imagePtrs, &width, &height) )
+		return NULL;
+
+	// classify the images without holding the GIL
+	const size_t numImages = imagePtrs.size();
+
+	std::vector<int>   classes(numImages);
+	std::vector<float> confidence(numImages);
+
+	bool result = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	result = classifyImages(self->net, &imagePtrs[0], numImages, width, height, &classes[0], &confidence[0]);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	if( !result )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "imageNet.ClassifyBatch() encountered an error classifying the images");
+		return NULL;
+	}
+
+	return classifyResultList(classes, confidence);
+}
+
+
+#define DOC_CLASSIFY_ASYNC "Asynchronously classify an RGBA image.  The image is processed by a native worker\n" \
+					  "thread of the network, so the image memory should not be modified until it completes.\n\n" \
+					  "Parameters:\n" \
+					  "  image  (capsule) -- CUDA memory capsule\n" \
+					  "  width  (int) -- width of the image (in pixels)\n" \
+					  "  height (int) -- height of the image (in pixels)\n\n" \
+					  "Returns:\n" \
+					  "  (inferenceFuture) -- future whose result() is the (int, float) class index and confidence tuple"
+
+// ClassifyAsync
+static PyObject* PyImageNet_ClassifyAsync( PyImageNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "imageNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* image = NULL;
+	std::vector<float*> imagePtrs;
+
+	int width = 0;
+	int height = 0;
+
+	if( !parseBatchArgs(args, kwds, false, "imageNet.ClassifyAsync()", &image, imagePtrs, &width, &height) )
+		return NULL;
+
+	PyClassifyJob* job = new PyClassifyJob(self->net, imagePtrs, width, height, false);
+	job->KeepAlive(image);
+
+	return PyInferenceFuture_Submit(&self->base, job);
+}
+
+
+#define DOC_CLASSIFY_BATCH_ASYNC "Asynchronously classify a list of RGBA images, like ClassifyBatch().  The images are processed\n" \
+						    "by a native worker thread of the network, so their memory should not be modified until it completes.\n\n" \
+						    "Parameters:\n" \
+						    "  images (list) -- list of CUDA memory capsules, all with the same dimensions\n" \
+						    "  width  (int) -- width of the images (in pixels)\n" \
+						    "  height (int) -- height of the images (in pixels)\n\n" \
+						    "Returns:\n" \
+						    "  (inferenceFuture) -- future whose result() is the list of (class index, confidence) tuples"
+
+// ClassifyBatchAsync
+static PyObject* PyImageNet_ClassifyBatchAsync( PyImageNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "imageNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* images = NULL;
+	std::vector<float*> imagePtrs;
+
+	int width = 0;
+	int height = 0;
+
+	if( !parseBatchArgs(args, kwds, true, "imageNet.ClassifyBatchAsync()", &images, imagePtrs, &width, &height) )
+		return NULL;
+
+	PyClassifyJob* job = new PyClassifyJob(self->net, imagePtrs, width, height, true);
+	job->KeepAlive(images);
 
+	return PyInferenceFuture_Submit(&self->base, job);
 }
 
 
@@ -336,6 +587,9 @@ static PyTypeObject pyImageNet_Type =
 static PyMethodDef pyImageNet_Methods[] =
 {
 	{ "Classify", (PyCFunction)PyImageNet_Classify, METH_VARARGS|METH_KEYWORDS, DOC_CLASSIFY},
+	{ "ClassifyBatch", (PyCFunction)PyImageNet_ClassifyBatch, METH_VARARGS|METH_KEYWORDS, DOC_CLASSIFY_BATCH},
+	{ "ClassifyAsync", (PyCFunction)PyImageNet_ClassifyAsync, METH_VARARGS|METH_KEYWORDS, DOC_CLASSIFY_ASYNC},
+	{ "ClassifyBatchAsync", (PyCFunction)PyImageNet_ClassifyBatchAsync, METH_VARARGS|METH_KEYWORDS, DOC_CLASSIFY_BATCH_ASYNC},
 	{ "GetNetworkName", (PyCFunction)PyImageNet_GetNetworkName, METH_NOARGS, DOC_GET_NETWORK_NAME},
      { "GetNumClasses", (PyCFunction)PyImageNet_GetNumClasses, METH_NOARGS, DOC_GET_NUM_CLASSES},
 	{ "GetClassDesc", (PyCFunction)PyImageNet_GetClassDesc, METH_VARARGS, DOC_GET_CLASS_DESC},
@@ -22,15 +22,99 @@
 
 #include "PyInference.h"
 
+#include "PyInferenceFuture.h"
 #include "PyTensorNet.h"
 #include "PyImageNet.h"
 #include "PyDetectNet.h"
 #include "PySegNet.h"
+#include "PyHomographyNet.h"
+#include "PySuperResNet.h"
 
+#include "inferenceMetrics.h"
+
+
+// StartMetricsServer
+static PyObject* PyInference_StartMetricsServer( PyObject* self, PyObject* args, PyObject* kwds )
+{
+	int port = 9400;
+	const char* address = "127.0.0.1";
+	static char* kwlist[] = {"port", "address", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "|is", kwlist, &port, &address))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "StartMetricsServer() failed to parse args tuple");
+		return NULL;
+	}
+
+	if( port < 0 || port > 65535 )
+	{
+		PyErr_SetString(PyExc_ValueError, LOG_PY_INFERENCE "StartMetricsServer() invalid port");
+		return NULL;
+	}
+
+	if( !inferenceMetrics::StartServer(port, address) )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "StartMetricsServer() failed to start the HTTP server");
+		return NULL;
+	}
+
+	return PyLong_FromLong(inferenceMetrics::GetServerPort());
+}
+
+
+// StartMetricsTextfile
+static PyObject* PyInference_StartMetricsTextfile( PyObject* self, PyObject* args, PyObject* kwds )
+{
+	const char* path = NULL;
+	int interval = 5000;
+	static char* kwlist[] = {"path", "interval_ms", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "s|i", kwlist, &path, &interval))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "StartMetricsTextfile() failed to parse args tuple");
+		return NULL;
+	}
+
+	if( interval <= 0 || !inferenceMetrics::StartTextfile(path, interval) )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "StartMetricsTextfile() failed to start writing the metrics file");
+		return NULL;
+	}
+
+	Py_RETURN_NONE;
+}
+
+
+// StopMetrics
+static PyObject* PyInference_StopMetrics( PyObject* self )
+{
+	Py_BEGIN_ALLOW_THREADS
+	inferenceMetrics::Stop();
+	Py_END_ALLOW_THREADS
+
+	Py_RETURN_NONE;
+}
+
+
+// GetMetrics
+static PyObject* PyInference_GetMetrics( PyObject* self )
+{
+	std::string metrics;
+
+	Py_BEGIN_ALLOW_THREADS
+	metrics = inferenceMetrics::Format();
+	Py_END_ALLOW_THREADS
+
+	return PYSTRING_FROM_STRING(metrics.c_str());
+}
 
 
 static PyMethodDef pyInferenceFunctions[] =
 {
+	{ "StartMetricsServer", (PyCFunction)PyInference_StartMetricsServer, METH_VARARGS|METH_KEYWORDS, "Serve the inference metrics over HTTP in the Prometheus format, and return the port (port=0 picks a free port)"},
+	{ "StartMetricsTextfile", (PyCFunction)PyInference_StartMetricsTextfile, METH_VARARGS|METH_KEYWORDS, "Periodically write the inference metrics in the Prometheus format to a file (for the node_exporter textfile collector)"},
+	{ "StopMetrics", (PyCFunction)PyInference_StopMetrics, METH_NOARGS, "Stop the metrics HTTP server and textfile writer"},
+	{ "GetMetrics", (PyCFunction)PyInference_GetMetrics, METH_NOARGS, "Return the inference metrics in the Prometheus text format"},
 	{ NULL, NULL, 0, NULL }
 };
 
@@ -40,6 +124,9 @@ bool PyInference_Register( PyObject* module )
 {
 	printf(LOG_PY_INFERENCE "registering module types...\n");
 
+	if( !PyInferenceFuture_Register(module) )
+		printf(LOG_PY_INFERENCE "failed to register inferenceFuture type\n");
+
 	if( !PyTensorNet_Register(module) )
 		printf(LOG_PY_INFERENCE "failed to register tensorNet type\n");
 
@@ -52,6 +139,12 @@ bool PyInference_Register( PyObject* module )
 	if( !PySegNet_Register(module) )
 		printf(LOG_PY_INFERENCE "failed to register segNet type\n");
 
+	if( !PyHomographyNet_Register(module) )
+		printf(LOG_PY_INFERENCE "failed to register homographyNet type\n");
+
+	if( !PySuperResNet_Register(module) )
+		printf(LOG_PY_INFERENCE "failed to register superResNet type\n");
+
 
 	printf(LOG_PY_INFERENCE "done registering module types\n");
 	return true;
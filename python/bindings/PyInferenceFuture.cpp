@@ -0,0 +1,531 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PyInferenceFuture.h"
+#include "inferenceMetrics.h"
+
+#include "../../utils/python/bindings/PyCUDA.h"
+
+#include <time.h>
+#include <errno.h>
+
+
+// number of async jobs waiting for the worker threads (across all networks)
+static metricGauge* gQueueDepth = inferenceMetrics::Gauge("jetson_inference_queue_depth", "Number of requests waiting to be processed", "source=\"python\"");
+
+
+//-----------------------------------------------------------------------------------------
+// PyInferenceJob
+//-----------------------------------------------------------------------------------------
+
+// constructor
+PyInferenceJob::PyInferenceJob()
+{
+	mComplete = false;
+	mSuccess  = false;
+
+	pthread_mutex_init(&mMutex, NULL);
+	pthread_cond_init(&mCond, NULL);
+}
+
+
+// destructor
+PyInferenceJob::~PyInferenceJob()
+{
+	const size_t numReferences = mReferences.size();
+
+	for( size_t n=0; n < numReferences; n++ )
+		Py_DECREF(mReferences[n]);
+
+	pthread_cond_destroy(&mCond);
+	pthread_mutex_destroy(&mMutex);
+}
+
+
+// KeepAlive
+void PyInferenceJob::KeepAlive( PyObject* object )
+{
+	if( !object )
+		return;
+
+	Py_INCREF(object);
+	mReferences.push_back(object);
+}
+
+
+// IsComplete
+bool PyInferenceJob::IsComplete()
+{
+	pthread_mutex_lock(&mMutex);
+	const bool complete = mComplete;
+	pthread_mutex_unlock(&mMutex);
+
+	return complete;
+}
+
+
+// WaitComplete
+bool PyInferenceJob::WaitComplete( int64_t timeout_ms )
+{
+	pthread_mutex_lock(&mMutex);
+
+	if( timeout_ms < 0 )
+	{
+		while( !mComplete )
+			pthread_cond_wait(&mCond, &mMutex);
+	}
+	else
+	{
+		timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+
+		deadline.tv_sec  += timeout_ms / 1000;
+		deadline.tv_nsec += (timeout_ms % 1000) * 1000000;
+
+		if( deadline.tv_nsec >= 1000000000 )
+		{
+			deadline.tv_sec  += 1;
+			deadline.tv_nsec -= 1000000000;
+		}
+
+		while( !mComplete )
+		{
+			if( pthread_cond_timedwait(&mCond, &mMutex, &deadline) == ETIMEDOUT )
+				break;
+		}
+	}
+
+	const bool complete = mComplete;
+	pthread_mutex_unlock(&mMutex);
+
+	return complete;
+}
+
+
+// SetComplete
+void PyInferenceJob::SetComplete( bool success )
+{
+	pthread_mutex_lock(&mMutex);
+
+	mSuccess  = success;
+	mComplete = true;
+
+	pthread_cond_broadcast(&mCond);
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+//-----------------------------------------------------------------------------------------
+// PyInferenceWorker
+//-----------------------------------------------------------------------------------------
+
+// constructor
+PyInferenceWorker::PyInferenceWorker()
+{
+	mThreadStarted = false;
+	mStop = false;
+
+	pthread_mutex_init(&mQueueMutex, NULL);
+	pthread_mutex_init(&mExecMutex, NULL);
+	pthread_cond_init(&mQueueCond, NULL);
+}
+
+
+// destructor
+PyInferenceWorker::~PyInferenceWorker()
+{
+	if( mThreadStarted )
+	{
+		// the thread drains any queued jobs before exiting
+		pthread_mutex_lock(&mQueueMutex);
+		mStop = true;
+		pthread_cond_signal(&mQueueCond);
+		pthread_mutex_unlock(&mQueueMutex);
+
+		pthread_join(mThread, NULL);
+	}
+
+	pthread_cond_destroy(&mQueueCond);
+	pthread_mutex_destroy(&mExecMutex);
+	pthread_mutex_destroy(&mQueueMutex);
+}
+
+
+// Submit
+bool PyInferenceWorker::Submit( PyInferenceJob* job )
+{
+	if( !job )
+		return false;
+
+	pthread_mutex_lock(&mQueueMutex);
+
+	if( !mThreadStarted )
+	{
+		if( pthread_create(&mThread, NULL, threadEntry, this) != 0 )
+		{
+			pthread_mutex_unlock(&mQueueMutex);
+			printf(LOG_PY_INFERENCE "failed to start the async worker thread\n");
+			return false;
+		}
+
+		mThreadStarted = true;
+	}
+
+	mQueue.push_back(job);
+	gQueueDepth->Add(1);
+
+	pthread_cond_signal(&mQueueCond);
+	pthread_mutex_unlock(&mQueueMutex);
+
+	return true;
+}
+
+
+// Lock
+void PyInferenceWorker::Lock()
+{
+	pthread_mutex_lock(&mExecMutex);
+}
+
+
+// Unlock
+void PyInferenceWorker::Unlock()
+{
+	pthread_mutex_unlock(&mExecMutex);
+}
+
+
+// threadEntry
+void* PyInferenceWorker::threadEntry( void* param )
+{
+	((PyInferenceWorker*)param)->run();
+	return NULL;
+}
+
+
+// run
+void PyInferenceWorker::run()
+{
+	while( true )
+	{
+		pthread_mutex_lock(&mQueueMutex);
+
+		while( mQueue.empty() && !mStop )
+			pthread_cond_wait(&mQueueCond, &mQueueMutex);
+
+		if( mQueue.empty() )
+		{
+			pthread_mutex_unlock(&mQueueMutex);
+			break;
+		}
+
+		PyInferenceJob* job = mQueue.front();
+		mQueue.pop_front();
+		gQueueDepth->Add(-1);
+
+		pthread_mutex_unlock(&mQueueMutex);
+
+		// run the job without the GIL, serialized with the synchronous calls
+		pthread_mutex_lock(&mExecMutex);
+		const bool success = job->Execute();
+		pthread_mutex_unlock(&mExecMutex);
+
+		job->SetComplete(success);
+	}
+}
+
+
+//-----------------------------------------------------------------------------------------
+// inferenceFuture
+//-----------------------------------------------------------------------------------------
+typedef struct {
+	PyObject_HEAD
+	PyInferenceJob* job;
+	PyObject* result;		// cached result, once it has been retrieved
+} PyInferenceFuture_Object;
+
+
+#define DOC_INFERENCE_FUTURE "Pending result of an asynchronous inference request\n\n" \
+					    "The request is processed by a native worker thread of the network\n" \
+					    "without holding the GIL, in the order that requests were submitted.\n" \
+					    "Objects of this type are returned by the *Async() functions, like\n" \
+					    "imageNet.ClassifyAsync(), detectNet.DetectAsync(), segNet.ProcessAsync()\n\n" \
+					    "----------------------------------------------------------------------\n" \
+					    "Methods defined here:\n\n" \
+					    "done()\n" \
+					    "     Return True if the request has completed.\n\n" \
+					    "wait(timeout=-1)\n" \
+					    "     Block until the request completes, or the timeout (in seconds) expires.\n" \
+					    "     Returns True if the request has completed.\n\n" \
+					    "result(timeout=-1)\n" \
+					    "     Block until the request completes and return its result, which is the\n" \
+					    "     same as the return value of the synchronous version of the function.\n" \
+					    "     Raises an exception if the request failed or the timeout expired.\n"
+
+
+// timeoutToMS
+static int64_t timeoutToMS( double timeout )
+{
+	if( timeout < 0.0 )
+		return -1;
+
+	return (int64_t)(timeout * 1000.0);
+}
+
+
+// waitJob
+static bool waitJob( PyInferenceJob* job, int64_t timeout_ms )
+{
+	if( job->IsComplete() )
+		return true;
+
+	bool complete = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	complete = job->WaitComplete(timeout_ms);
+	Py_END_ALLOW_THREADS
+
+	return complete;
+}
+
+
+// Deallocate
+static void PyInferenceFuture_Dealloc( PyInferenceFuture_Object* self )
+{
+	if( self->job != NULL )
+	{
+		// the worker may still be using the job, so it must finish first
+		waitJob(self->job, -1);
+
+		delete self->job;
+		self->job = NULL;
+	}
+
+	Py_XDECREF(self->result);
+	self->result = NULL;
+
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+
+// done
+static PyObject* PyInferenceFuture_Done( PyInferenceFuture_Object* self )
+{
+	if( !self || !self->job )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "inferenceFuture invalid object instance");
+		return NULL;
+	}
+
+	PY_RETURN_BOOL(self->job->IsComplete());
+}
+
+
+// wait
+static PyObject* PyInferenceFuture_Wait( PyInferenceFuture_Object* self, PyObject* args, PyObject* kwds )
+{
+	if( !self || !self->job )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "inferenceFuture invalid object instance");
+		return NULL;
+	}
+
+	double timeout = -1.0;
+	static char* kwlist[] = {"timeout", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "|d", kwlist, &timeout))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "inferenceFuture.wait() failed to parse args tuple");
+		return NULL;
+	}
+
+	PY_RETURN_BOOL(waitJob(self->job, timeoutToMS(timeout)));
+}
+
+
+// result
+static PyObject* PyInferenceFuture_Result( PyInferenceFuture_Object* self, PyObject* args, PyObject* kwds )
+{
+	if( !self || !self->job )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "inferenceFuture invalid object instance");
+		return NULL;
+	}
+
+	double timeout = -1.0;
+	static char* kwlist[] = {"timeout", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "|d", kwlist, &timeout))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "inferenceFuture.result() failed to parse args tuple");
+		return NULL;
+	}
+
+	if( !waitJob(self->job, timeoutToMS(timeout)) )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "inferenceFuture.result() timed out waiting for the request to complete");
+		return NULL;
+	}
+
+	if( !self->job->Success() )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s", self->job->Error());
+		return NULL;
+	}
+
+	// convert the native results the first time they are retrieved
+	if( !self->result )
+	{
+		self->result = self->job->Result();
+
+		if( !self->result )
+			return NULL;
+	}
+
+	Py_INCREF(self->result);
+	return self->result;
+}
+
+
+//-------------------------------------------------------------------------------
+static PyTypeObject pyInferenceFuture_Type =
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+};
+
+static PyMethodDef pyInferenceFuture_Methods[] =
+{
+	{ "done", (PyCFunction)PyInferenceFuture_Done, METH_NOARGS, "Return True if the request has completed"},
+	{ "wait", (PyCFunction)PyInferenceFuture_Wait, METH_VARARGS|METH_KEYWORDS, "Wait for the request to complete, with optional timeout (in seconds)"},
+	{ "result", (PyCFunction)PyInferenceFuture_Result, METH_VARARGS|METH_KEYWORDS, "Wait for the request to complete and return its result"},
+	{NULL}  /* Sentinel */
+};
+
+
+// PyInferenceFuture_Submit
+PyObject* PyInferenceFuture_Submit( PyTensorNet_Object* net, PyInferenceJob* job )
+{
+	if( !net || !net->worker || !job )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "invalid network object for async request");
+		delete job;
+		return NULL;
+	}
+
+	PyInferenceFuture_Object* future = PyObject_New(PyInferenceFuture_Object, &pyInferenceFuture_Type);
+
+	if( !future )
+	{
+		PyErr_SetString(PyExc_MemoryError, LOG_PY_INFERENCE "failed to allocate inferenceFuture object");
+		delete job;
+		return NULL;
+	}
+
+	future->job    = NULL;
+	future->result = NULL;
+
+	// the network must outlive the request
+	job->KeepAlive((PyObject*)net);
+
+	if( !net->worker->Submit(job) )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "failed to submit async request to the worker thread");
+		delete job;
+		Py_DECREF(future);
+		return NULL;
+	}
+
+	future->job = job;
+	return (PyObject*)future;
+}
+
+
+// PyInference_ParseImageList
+bool PyInference_ParseImageList( PyObject* list, std::vector<float*>& images, const char* function )
+{
+	if( !list || !PySequence_Check(list) )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s expected a list of image capsules", function);
+		return false;
+	}
+
+	const Py_ssize_t numImages = PySequence_Size(list);
+
+	if( numImages <= 0 )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s was passed an empty list of images", function);
+		return false;
+	}
+
+	images.resize(numImages);
+
+	for( Py_ssize_t n=0; n < numImages; n++ )
+	{
+		PyObject* item = PySequence_GetItem(list, n);
+
+		if( !item )
+			return false;
+
+		images[n] = (float*)PyCUDA_GetPointer(item);
+		Py_DECREF(item);	// the list keeps the capsule alive
+
+		if( !images[n] )
+		{
+			PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s failed to get image pointer from PyCapsule container (index %zd)", function, n);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+// Register type
+bool PyInferenceFuture_Register( PyObject* module )
+{
+	if( !module )
+		return false;
+
+	pyInferenceFuture_Type.tp_name	 = PY_INFERENCE_MODULE_NAME ".inferenceFuture";
+	pyInferenceFuture_Type.tp_basicsize = sizeof(PyInferenceFuture_Object);
+	pyInferenceFuture_Type.tp_flags	 = Py_TPFLAGS_DEFAULT;
+	pyInferenceFuture_Type.tp_methods	 = pyInferenceFuture_Methods;
+	pyInferenceFuture_Type.tp_new	 = NULL;	/* only created by the *Async() functions */
+	pyInferenceFuture_Type.tp_dealloc	 = (destructor)PyInferenceFuture_Dealloc;
+	pyInferenceFuture_Type.tp_doc	 = DOC_INFERENCE_FUTURE;
+
+	if( PyType_Ready(&pyInferenceFuture_Type) < 0 )
+	{
+		printf(LOG_PY_INFERENCE "inferenceFuture PyType_Ready() failed\n");
+		return false;
+	}
+
+	Py_INCREF(&pyInferenceFuture_Type);
+
+	if( PyModule_AddObject(module, "inferenceFuture", (PyObject*)&pyInferenceFuture_Type) < 0 )
+	{
+		printf(LOG_PY_INFERENCE "inferenceFuture PyModule_AddObject('inferenceFuture') failed\n");
+		return false;
+	}
+
+	return true;
+}
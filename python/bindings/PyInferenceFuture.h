@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __PYTHON_BINDINGS_INFERENCE_FUTURE__
+#define __PYTHON_BINDINGS_INFERENCE_FUTURE__
+
+#include "PyTensorNet.h"
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+
+
+/*
+ * Unit of native work that is queued to a network's PyInferenceWorker.
+ *
+ * Execute() runs on the worker thread without holding the GIL, so it may only
+ * touch native data.  Result() converts the native results into Python objects,
+ * and is only called by the interpreter (with the GIL held) when the result is
+ * retrieved from the inferenceFuture object.
+ */
+class PyInferenceJob
+{
+public:
+	PyInferenceJob();
+	virtual ~PyInferenceJob();		// must be called with the GIL held
+
+	virtual bool Execute() = 0;		// worker thread, GIL released
+	virtual PyObject* Result() = 0;	// interpreter thread, GIL held
+
+	// hold a reference to a Python object (i.e. an image capsule) until the job is destroyed
+	void KeepAlive( PyObject* object );
+
+	// completion status
+	bool IsComplete();
+	bool WaitComplete( int64_t timeout_ms );	// negative timeout waits forever
+	void SetComplete( bool success );
+
+	inline bool Success() const		{ return mSuccess; }
+	inline const char* Error() const	{ return mError.c_str(); }
+
+protected:
+	std::string mError;
+
+private:
+	std::vector<PyObject*> mReferences;
+
+	pthread_mutex_t mMutex;
+	pthread_cond_t  mCond;
+
+	bool mComplete;
+	bool mSuccess;
+};
+
+
+/*
+ * Per-network worker thread that executes PyInferenceJob's in submission order.
+ * The same lock also serializes the synchronous methods with the queued jobs,
+ * so that a network is never used from two threads at once.
+ */
+class PyInferenceWorker
+{
+public:
+	PyInferenceWorker();
+	~PyInferenceWorker();
+
+	// queue a job to the worker thread (started on first use)
+	bool Submit( PyInferenceJob* job );
+
+	// lock/unlock the network for a synchronous call (release the GIL first)
+	void Lock();
+	void Unlock();
+
+private:
+	static void* threadEntry( void* param );
+	void run();
+
+	pthread_t mThread;
+	bool mThreadStarted;
+	bool mStop;
+
+	pthread_mutex_t mQueueMutex;
+	pthread_cond_t  mQueueCond;
+	pthread_mutex_t mExecMutex;
+
+	std::deque<PyInferenceJob*> mQueue;
+};
+
+
+// Submit a job to the network's worker and return a new inferenceFuture object (or NULL on error)
+PyObject* PyInferenceFuture_Submit( PyTensorNet_Object* net, PyInferenceJob* job );
+
+// Parse a list or tuple of CUDA memory capsules into image pointers (sets a Python exception on error)
+bool PyInference_ParseImageList( PyObject* list, std::vector<float*>& images, const char* function );
+
+// Register the inferenceFuture type
+bool PyInferenceFuture_Register( PyObject* module );
+
+#endif
@@ -22,6 +22,7 @@
 
 #include "PyTensorNet.h"
 #include "PySegNet.h"
+#include "PyInferenceFuture.h"
 
 #include "segNet.h"
 
@@ -282,7 +283,13 @@ static PyObject* PySegNet_Process( PySegNet_Object* self, PyObject* args, PyObje
 	//detectNet::Detection* detections = NULL;
 
 	//const int numDetections = self->net->Detect((float*)img, width, height, &detections, overlay > 0 ? detectNet::OVERLAY_BOX/*|detectNet::OVERLAY_LABEL*/ : detectNet::OVERLAY_NONE);
-	const bool success = self->net->Process((float*)img, width, height);
+	bool success = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	success = self->net->Process((float*)img, width, height);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
 
 	if( !success )
 	{
@@ -317,10 +324,11 @@ static PyObject* PySegNet_Overlay( PySegNet_Object* self, PyObject* args, PyObje
 	int width = 0;
 	int height = 0;
 	int mask = 0;
+	int batch_index = 0;
 
-	static char* kwlist[] = {"image", "width", "height", "mask", NULL};
+	static char* kwlist[] = {"image", "width", "height", "mask", "batch_index", NULL};
 
-	if( !PyArg_ParseTupleAndKeywords(args, kwds, "Oiip|", kwlist, &capsule, &width, &height, &mask))
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "Oiip|i", kwlist, &capsule, &width, &height, &mask, &batch_index))
 	{
 		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "segNet.Process() failed to parse args tuple");
 		return NULL;
@@ -347,7 +355,20 @@ static PyObject* PySegNet_Overlay( PySegNet_Object* self, PyObject* args, PyObje
 
 	//const int numDetections = self->net->Detect((float*)img, width, height, &detections, overlay > 0 ? detectNet::OVERLAY_BOX/*|detectNet::OVERLAY_LABEL*/ : detectNet::OVERLAY_NONE);
 
-	const bool success = mask > 0 ? self->net->Mask((float*)img, width, height) : self->net->Overlay((float*)img, width, height);
+	if( batch_index < 0 || batch_index >= (int)self->net->GetMaxBatchSize() )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "segNet.Overlay() batch_index is out of range");
+		return NULL;
+	}
+
+	bool success = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	success = mask > 0 ? self->net->Mask((float*)img, width, height, segNet::FILTER_LINEAR, batch_index)
+				    : self->net->Overlay((float*)img, width, height, segNet::FILTER_LINEAR, batch_index);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
 
 	//const bool success = self->net->Overlay((float*)img, width, height);
 
@@ -374,6 +395,328 @@ static PyObject* PySegNet_Overlay( PySegNet_Object* self, PyObject* args, PyObje
 	return tuple;
 }
 
+// segmentImages (called without the GIL)
+static bool segmentImages( segNet* net, float** images, float** overlays, uint32_t numImages, uint32_t width, uint32_t height,
+					  const char* ignore_class, bool mask, segNet::FilterMode filter )
+{
+	const uint32_t maxBatchSize = net->GetMaxBatchSize();
+
+	// split the list into batches of the size that the network was loaded with
+	for( uint32_t n=0; n < numImages; n += maxBatchSize )
+	{
+		const uint32_t batchSize = (numImages - n < maxBatchSize) ? (numImages - n) : maxBatchSize;
+
+		if( !net->ProcessBatch(images + n, width, height, batchSize, ignore_class) )
+			return false;
+
+		// the class maps are overwritten by the next batch, so render the overlays now
+		if( !overlays )
+			continue;
+
+		for( uint32_t b=0; b < batchSize; b++ )
+		{
+			float* output = overlays[n+b];
+
+			if( !(mask ? net->Mask(output, width, height, filter, b) : net->Overlay(output, width, height, filter, b)) )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
+// parseBatchArgs
+static bool parseBatchArgs( PyObject* args, PyObject* kwds, bool batch, const char* function,
+					   PyObject** images, std::vector<float*>& imagePtrs, int* width, int* height, const char** ignore_class,
+					   PyObject** overlays, std::vector<float*>& overlayPtrs, int* mask, segNet::FilterMode* filter )
+{
+	static char* kwlist_batch[]  = {"images", "width", "height", "ignore_class", "overlays", "mask", "filter_mode", NULL};
+	static char* kwlist_single[] = {"image", "width", "height", "ignore_class", "overlay", "mask", "filter_mode", NULL};
+
+	const char* filter_str = "linear";
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "Oii|sOps", batch ? kwlist_batch : kwlist_single, images, width, height, ignore_class, overlays, mask, &filter_str))
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s failed to parse args tuple", function);
+		return false;
+	}
+
+	if( *width <= 0 || *height <= 0 )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s image dimensions are invalid", function);
+		return false;
+	}
+
+	*filter = segNet::FilterModeFromStr(filter_str);
+
+	if( *overlays == Py_None )
+		*overlays = NULL;
+
+	if( batch )
+	{
+		if( !PyInference_ParseImageList(*images, imagePtrs, function) )
+			return false;
+
+		if( *overlays != NULL )
+		{
+			if( !PyInference_ParseImageList(*overlays, overlayPtrs, function) )
+				return false;
+
+			if( overlayPtrs.size() != imagePtrs.size() )
+			{
+				PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s requires the same number of overlays as images", function);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void* img = PyCUDA_GetPointer(*images);
+
+	if( !img )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s failed to get image pointer from PyCapsule container", function);
+		return false;
+	}
+
+	imagePtrs.assign(1, (float*)img);
+
+	if( *overlays != NULL )
+	{
+		void* overlay = PyCUDA_GetPointer(*overlays);
+
+		if( !overlay )
+		{
+			PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s failed to get overlay pointer from PyCapsule container", function);
+			return false;
+		}
+
+		overlayPtrs.assign(1, (float*)overlay);
+	}
+
+	return true;
+}
+
+
+// Asynchronous segmentation request
+class PySegmentJob : public PyInferenceJob
+{
+public:
+	PySegmentJob( segNet* net, const std::vector<float*>& images, const std::vector<float*>& overlays, uint32_t width, uint32_t height,
+			    const char* ignore_class, bool mask, segNet::FilterMode filter )
+		: mNet(net), mImages(images), mOverlays(overlays), mWidth(width), mHeight(height), mIgnoreClass(ignore_class), mMask(mask), mFilter(filter)
+	{
+	}
+
+	virtual bool Execute()
+	{
+		if( !segmentImages(mNet, &mImages[0], mOverlays.empty() ? NULL : &mOverlays[0], mImages.size(),
+					    mWidth, mHeight, mIgnoreClass.c_str(), mMask, mFilter) )
+		{
+			mError = "segNet async request encountered an error processing the image";
+			return false;
+		}
+
+		return true;
+	}
+
+	virtual PyObject* Result()
+	{
+		Py_RETURN_NONE;
+	}
+
+private:
+	segNet* mNet;
+	std::vector<float*> mImages;
+	std::vector<float*> mOverlays;
+
+	uint32_t mWidth;
+	uint32_t mHeight;
+
+	std::string mIgnoreClass;
+	bool mMask;
+	segNet::FilterMode mFilter;
+};
+
+
+#define DOC_PROCESS_BATCH "Segment a list of RGBA images, processing them in batches of up to the max batch size of the network.\n" \
+					 "If overlays are provided, the segmentation overlay (or mask) of each image is rendered into them.\n" \
+					 "Otherwise the list may not exceed the max batch size, and Overlay() can be called with a batch_index.\n\n" \
+					 "Parameters:\n" \
+					 "  images       (list) -- list of CUDA memory capsules, all with the same dimensions\n" \
+					 "  width        (int)  -- width of the images (in pixels)\n" \
+					 "  height       (int)  -- height of the images (in pixels)\n" \
+					 "  ignore_class (str)  -- label of the class to ignore in the classification (default is 'void')\n" \
+					 "  overlays     (list) -- optional list of CUDA memory capsules to render into (same dimensions as the images)\n" \
+					 "  mask         (bool) -- render the class mask instead of the blended overlay (default is false)\n" \
+					 "  filter_mode  (str)  -- 'point' or 'linear' filtering of the overlays (default is 'linear')\n\n" \
+					 "Returns:\n" \
+					 "  None"
+
+// ProcessBatch
+static PyObject* PySegNet_ProcessBatch( PySegNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "segNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* images   = NULL;
+	PyObject* overlays = NULL;
+
+	std::vector<float*> imagePtrs;
+	std::vector<float*> overlayPtrs;
+
+	int width  = 0;
+	int height = 0;
+	int mask   = 0;
+
+	const char* ignore_class = "void";
+	segNet::FilterMode filter = segNet::FILTER_LINEAR;
+
+	if( !parseBatchArgs(args, kwds, true, "segNet.ProcessBatch()", &images, imagePtrs, &width, &height,
+					&ignore_class, &overlays, overlayPtrs, &mask, &filter) )
+		return NULL;
+
+	if( overlayPtrs.empty() && imagePtrs.size() > self->net->GetMaxBatchSize() )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "segNet.ProcessBatch() -- %zu images exceeds the max batch size of %u (provide overlays to process longer lists)", imagePtrs.size(), self->net->GetMaxBatchSize());
+		return NULL;
+	}
+
+	// run the segmentation without holding the GIL
+	bool result = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	result = segmentImages(self->net, &imagePtrs[0], overlayPtrs.empty() ? NULL : &overlayPtrs[0], imagePtrs.size(),
+					   width, height, ignore_class, mask > 0, filter);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	if( !result )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "segNet.ProcessBatch() encountered an error processing the images");
+		return NULL;
+	}
+
+	Py_RETURN_NONE;
+}
+
+
+#define DOC_PROCESS_ASYNC "Asynchronously segment an RGBA image and render its overlay.  The image is processed by a native\n" \
+					 "worker thread of the network, so the image memory should not be modified until it completes.\n\n" \
+					 "Parameters:\n" \
+					 "  image        (capsule) -- CUDA memory capsule\n" \
+					 "  width        (int)  -- width of the image (in pixels)\n" \
+					 "  height       (int)  -- height of the image (in pixels)\n" \
+					 "  ignore_class (str)  -- label of the class to ignore in the classification (default is 'void')\n" \
+					 "  overlay      (capsule) -- CUDA memory capsule to render into (same dimensions as the image)\n" \
+					 "  mask         (bool) -- render the class mask instead of the blended overlay (default is false)\n" \
+					 "  filter_mode  (str)  -- 'point' or 'linear' filtering of the overlay (default is 'linear')\n\n" \
+					 "Returns:\n" \
+					 "  (inferenceFuture) -- future whose result() is None once the overlay has been rendered"
+
+// ProcessAsync
+static PyObject* PySegNet_ProcessAsync( PySegNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "segNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* image   = NULL;
+	PyObject* overlay = NULL;
+
+	std::vector<float*> imagePtrs;
+	std::vector<float*> overlayPtrs;
+
+	int width  = 0;
+	int height = 0;
+	int mask   = 0;
+
+	const char* ignore_class = "void";
+	segNet::FilterMode filter = segNet::FILTER_LINEAR;
+
+	if( !parseBatchArgs(args, kwds, false, "segNet.ProcessAsync()", &image, imagePtrs, &width, &height,
+					&ignore_class, &overlay, overlayPtrs, &mask, &filter) )
+		return NULL;
+
+	// the class map may be overwritten by later requests, so the overlay is required
+	if( overlayPtrs.empty() )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "segNet.ProcessAsync() requires an overlay image to render into");
+		return NULL;
+	}
+
+	PySegmentJob* job = new PySegmentJob(self->net, imagePtrs, overlayPtrs, width, height, ignore_class, mask > 0, filter);
+
+	job->KeepAlive(image);
+	job->KeepAlive(overlay);
+
+	return PyInferenceFuture_Submit(&self->base, job);
+}
+
+
+#define DOC_PROCESS_BATCH_ASYNC "Asynchronously segment a list of RGBA images and render their overlays, like ProcessBatch().\n" \
+						   "The images are processed by a native worker thread of the network, so their memory should\n" \
+						   "not be modified until it completes.\n\n" \
+						   "Parameters:\n" \
+						   "  images       (list) -- list of CUDA memory capsules, all with the same dimensions\n" \
+						   "  width        (int)  -- width of the images (in pixels)\n" \
+						   "  height       (int)  -- height of the images (in pixels)\n" \
+						   "  ignore_class (str)  -- label of the class to ignore in the classification (default is 'void')\n" \
+						   "  overlays     (list) -- list of CUDA memory capsules to render into (same dimensions as the images)\n" \
+						   "  mask         (bool) -- render the class masks instead of the blended overlays (default is false)\n" \
+						   "  filter_mode  (str)  -- 'point' or 'linear' filtering of the overlays (default is 'linear')\n\n" \
+						   "Returns:\n" \
+						   "  (inferenceFuture) -- future whose result() is None once the overlays have been rendered"
+
+// ProcessBatchAsync
+static PyObject* PySegNet_ProcessBatchAsync( PySegNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "segNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* images   = NULL;
+	PyObject* overlays = NULL;
+
+	std::vector<float*> imagePtrs;
+	std::vector<float*> overlayPtrs;
+
+	int width  = 0;
+	int height = 0;
+	int mask   = 0;
+
+	const char* ignore_class = "void";
+	segNet::FilterMode filter = segNet::FILTER_LINEAR;
+
+	if( !parseBatchArgs(args, kwds, true, "segNet.ProcessBatchAsync()", &images, imagePtrs, &width, &height,
+					&ignore_class, &overlays, overlayPtrs, &mask, &filter) )
+		return NULL;
+
+	if( overlayPtrs.empty() )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "segNet.ProcessBatchAsync() requires a list of overlay images to render into");
+		return NULL;
+	}
+
+	PySegmentJob* job = new PySegmentJob(self->net, imagePtrs, overlayPtrs, width, height, ignore_class, mask > 0, filter);
+
+	job->KeepAlive(images);
+	job->KeepAlive(overlays);
+
+	return PyInferenceFuture_Submit(&self->base, job);
+}
+
+
 //-------------------------------------------------------------------------------
 static PyTypeObject pySegNet_Type =
 {
@@ -384,6 +727,9 @@ static PyMethodDef pySegNet_Methods[] =
 {
 	{ "Process", (PyCFunction)PySegNet_Process, METH_VARARGS|METH_KEYWORDS, DOC_SEGNET},
 	{ "Overlay", (PyCFunction)PySegNet_Overlay, METH_VARARGS|METH_KEYWORDS, DOC_SEGNET},
+	{ "ProcessBatch", (PyCFunction)PySegNet_ProcessBatch, METH_VARARGS|METH_KEYWORDS, DOC_PROCESS_BATCH},
+	{ "ProcessAsync", (PyCFunction)PySegNet_ProcessAsync, METH_VARARGS|METH_KEYWORDS, DOC_PROCESS_ASYNC},
+	{ "ProcessBatchAsync", (PyCFunction)PySegNet_ProcessBatchAsync, METH_VARARGS|METH_KEYWORDS, DOC_PROCESS_BATCH_ASYNC},
 	{NULL}  /* Sentinel */
 };
 
@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "PyTensorNet.h"
+#include "PySuperResNet.h"
+#include "PyInferenceFuture.h"
+
+#include "superResNet.h"
+
+#include "../../utils/python/bindings/PyCUDA.h"
+
+
+typedef struct {
+    PyTensorNet_Object base;
+    superResNet* net;	// object instance
+} PySuperResNet_Object;
+
+
+#define DOC_SUPERRESNET "Super Resolution DNN - upscales an image\n\n" \
+				    "__init__()\n" \
+				    "     Loads the super resolution model.\n\n"
+
+
+// Init
+static int PySuperResNet_Init( PySuperResNet_Object* self, PyObject *args, PyObject *kwds )
+{
+	printf(LOG_PY_INFERENCE "PySuperResNet_Init()\n");
+
+	static char* kwlist[] = {NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "", kwlist))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet.__init()__ failed to parse args tuple");
+		return -1;
+	}
+
+	self->net = superResNet::Create();
+
+	// confirm the network loaded
+	if( !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet failed to load network");
+		printf(LOG_PY_INFERENCE "superResNet failed to load network\n");
+		return -1;
+	}
+
+	self->base.net = self->net;
+	return 0;
+}
+
+
+// upscaleImages (called without the GIL)
+static bool upscaleImages( superResNet* net, float** inputs, float** outputs, uint32_t numImages,
+					  uint32_t width, uint32_t height, uint32_t outputWidth, uint32_t outputHeight, float maxPixel )
+{
+	for( uint32_t n=0; n < numImages; n++ )
+	{
+		if( !net->UpscaleRGBA(inputs[n], width, height, outputs[n], outputWidth, outputHeight, maxPixel) )
+			return false;
+	}
+
+	return true;
+}
+
+
+#define DOC_UPSCALE "Upscale an RGBA image.\n\n" \
+				"Parameters:\n" \
+				"  input         (capsule) -- CUDA memory capsule of the input image\n" \
+				"  width         (int) -- width of the input image (in pixels)\n" \
+				"  height        (int) -- height of the input image (in pixels)\n" \
+				"  output        (capsule) -- CUDA memory capsule of the output image\n" \
+				"  output_width  (int) -- width of the output image (in pixels)\n" \
+				"  output_height (int) -- height of the output image (in pixels)\n" \
+				"  max_pixel     (float) -- maximum pixel value of the images (default is 255.0)\n\n" \
+				"Returns:\n" \
+				"  None"
+
+// UpscaleRGBA
+static PyObject* PySuperResNet_UpscaleRGBA( PySuperResNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* inputCapsule  = NULL;
+	PyObject* outputCapsule = NULL;
+
+	int width  = 0;
+	int height = 0;
+	int outputWidth  = 0;
+	int outputHeight = 0;
+
+	float maxPixel = 255.0f;
+
+	static char* kwlist[] = {"input", "width", "height", "output", "output_width", "output_height", "max_pixel", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "OiiOii|f", kwlist, &inputCapsule, &width, &height, &outputCapsule, &outputWidth, &outputHeight, &maxPixel))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet.UpscaleRGBA() failed to parse args tuple");
+		return NULL;
+	}
+
+	if( width <= 0 || height <= 0 || outputWidth <= 0 || outputHeight <= 0 )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet.UpscaleRGBA() image dimensions are invalid");
+		return NULL;
+	}
+
+	float* input  = (float*)PyCUDA_GetPointer(inputCapsule);
+	float* output = (float*)PyCUDA_GetPointer(outputCapsule);
+
+	if( !input || !output )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet.UpscaleRGBA() failed to get image pointer from PyCapsule container");
+		return NULL;
+	}
+
+	bool result = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	result = self->net->UpscaleRGBA(input, width, height, output, outputWidth, outputHeight, maxPixel);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	if( !result )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet.UpscaleRGBA() encountered an error processing the image");
+		return NULL;
+	}
+
+	Py_RETURN_NONE;
+}
+
+
+#define DOC_UPSCALE_BATCH "Upscale a list of RGBA images (i.e. the frames of a video sequence), with the GIL released for\n" \
+					 "the whole list.\n\n" \
+					 "Parameters:\n" \
+					 "  inputs        (list) -- list of CUDA memory capsules of the input images\n" \
+					 "  width         (int) -- width of the input images (in pixels)\n" \
+					 "  height        (int) -- height of the input images (in pixels)\n" \
+					 "  outputs       (list) -- list of CUDA memory capsules of the output images, the same length as inputs\n" \
+					 "  output_width  (int) -- width of the output images (in pixels)\n" \
+					 "  output_height (int) -- height of the output images (in pixels)\n" \
+					 "  max_pixel     (float) -- maximum pixel value of the images (default is 255.0)\n\n" \
+					 "Returns:\n" \
+					 "  None"
+
+// UpscaleBatch
+static PyObject* PySuperResNet_UpscaleBatch( PySuperResNet_Object* self, PyObject* args, PyObject *kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* inputList  = NULL;
+	PyObject* outputList = NULL;
+
+	int width  = 0;
+	int height = 0;
+	int outputWidth  = 0;
+	int outputHeight = 0;
+
+	float maxPixel = 255.0f;
+
+	static char* kwlist[] = {"inputs", "width", "height", "outputs", "output_width", "output_height", "max_pixel", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "OiiOii|f", kwlist, &inputList, &width, &height, &outputList, &outputWidth, &outputHeight, &maxPixel))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet.UpscaleBatch() failed to parse args tuple");
+		return NULL;
+	}
+
+	if( width <= 0 || height <= 0 || outputWidth <= 0 || outputHeight <= 0 )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet.UpscaleBatch() image dimensions are invalid");
+		return NULL;
+	}
+
+	std::vector<float*> inputs;
+	std::vector<float*> outputs;
+
+	if( !PyInference_ParseImageList(inputList, inputs, "superResNet.UpscaleBatch()") ||
+	    !PyInference_ParseImageList(outputList, outputs, "superResNet.UpscaleBatch()") )
+		return NULL;
+
+	if( inputs.size() != outputs.size() )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet.UpscaleBatch() inputs and outputs should be the same length");
+		return NULL;
+	}
+
+	bool result = false;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->base.worker->Lock();
+	result = upscaleImages(self->net, &inputs[0], &outputs[0], inputs.size(), width, height, outputWidth, outputHeight, maxPixel);
+	self->base.worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	if( !result )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet.UpscaleBatch() encountered an error processing the images");
+		return NULL;
+	}
+
+	Py_RETURN_NONE;
+}
+
+
+// GetInputWidth
+static PyObject* PySuperResNet_GetInputWidth( PySuperResNet_Object* self )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet invalid object instance");
+		return NULL;
+	}
+
+	return PYLONG_FROM_UNSIGNED_LONG(self->net->GetInputWidth());
+}
+
+
+// GetInputHeight
+static PyObject* PySuperResNet_GetInputHeight( PySuperResNet_Object* self )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet invalid object instance");
+		return NULL;
+	}
+
+	return PYLONG_FROM_UNSIGNED_LONG(self->net->GetInputHeight());
+}
+
+
+// GetOutputWidth
+static PyObject* PySuperResNet_GetOutputWidth( PySuperResNet_Object* self )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet invalid object instance");
+		return NULL;
+	}
+
+	return PYLONG_FROM_UNSIGNED_LONG(self->net->GetOutputWidth());
+}
+
+
+// GetOutputHeight
+static PyObject* PySuperResNet_GetOutputHeight( PySuperResNet_Object* self )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet invalid object instance");
+		return NULL;
+	}
+
+	return PYLONG_FROM_UNSIGNED_LONG(self->net->GetOutputHeight());
+}
+
+
+// GetScaleFactor
+static PyObject* PySuperResNet_GetScaleFactor( PySuperResNet_Object* self )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "superResNet invalid object instance");
+		return NULL;
+	}
+
+	return PYLONG_FROM_UNSIGNED_LONG(self->net->GetScaleFactor());
+}
+
+
+//-------------------------------------------------------------------------------
+static PyTypeObject pySuperResNet_Type =
+{
+    PyVarObject_HEAD_INIT(NULL, 0)
+};
+
+static PyMethodDef pySuperResNet_Methods[] =
+{
+	{ "UpscaleRGBA", (PyCFunction)PySuperResNet_UpscaleRGBA, METH_VARARGS|METH_KEYWORDS, DOC_UPSCALE},
+	{ "UpscaleBatch", (PyCFunction)PySuperResNet_UpscaleBatch, METH_VARARGS|METH_KEYWORDS, DOC_UPSCALE_BATCH},
+	{ "GetInputWidth", (PyCFunction)PySuperResNet_GetInputWidth, METH_NOARGS, "Return the width of the network's input (in pixels)"},
+	{ "GetInputHeight", (PyCFunction)PySuperResNet_GetInputHeight, METH_NOARGS, "Return the height of the network's input (in pixels)"},
+	{ "GetOutputWidth", (PyCFunction)PySuperResNet_GetOutputWidth, METH_NOARGS, "Return the width of the network's output (in pixels)"},
+	{ "GetOutputHeight", (PyCFunction)PySuperResNet_GetOutputHeight, METH_NOARGS, "Return the height of the network's output (in pixels)"},
+	{ "GetScaleFactor", (PyCFunction)PySuperResNet_GetScaleFactor, METH_NOARGS, "Return the scale factor between the network's input and output"},
+	{NULL}  /* Sentinel */
+};
+
+// Register type
+bool PySuperResNet_Register( PyObject* module )
+{
+	if( !module )
+		return false;
+
+	pySuperResNet_Type.tp_name		= PY_INFERENCE_MODULE_NAME ".superResNet";
+	pySuperResNet_Type.tp_basicsize	= sizeof(PySuperResNet_Object);
+	pySuperResNet_Type.tp_flags		= Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+	pySuperResNet_Type.tp_base		= PyTensorNet_Type();
+	pySuperResNet_Type.tp_methods		= pySuperResNet_Methods;
+	pySuperResNet_Type.tp_new		= NULL;
+	pySuperResNet_Type.tp_init		= (initproc)PySuperResNet_Init;
+	pySuperResNet_Type.tp_dealloc		= NULL;
+	pySuperResNet_Type.tp_doc		= DOC_SUPERRESNET;
+
+	if( PyType_Ready(&pySuperResNet_Type) < 0 )
+	{
+		printf(LOG_PY_INFERENCE "superResNet PyType_Ready() failed\n");
+		return false;
+	}
+
+	Py_INCREF(&pySuperResNet_Type);
+
+	if( PyModule_AddObject(module, "superResNet", (PyObject*)&pySuperResNet_Type) < 0 )
+	{
+		printf(LOG_PY_INFERENCE "superResNet PyModule_AddObject('superResNet') failed\n");
+		return false;
+	}
+
+	return true;
+}
@@ -21,6 +21,8 @@
  */
 
 #include "PyTensorNet.h"
+#include "PyInferenceFuture.h"
+
 #include "tensorNet.h"
 
 
@@ -39,7 +41,9 @@ static PyObject* PyTensorNet_New( PyTypeObject *type, PyObject *args, PyObject *
 		return NULL;
 	}
 	
-	self->net = NULL;
+	self->net    = NULL;
+	self->worker = new PyInferenceWorker();
+
 	return (PyObject*)self;
 }
 
@@ -49,6 +53,13 @@ static void PyTensorNet_Dealloc( PyTensorNet_Object* self )
 {
 	printf("PyTensorNet_Dealloc()\n");
 
+	// stop the async worker thread
+	if( self->worker != NULL )
+	{
+		delete self->worker;
+		self->worker = NULL;
+	}
+
 	// free the network
 	if( self->net != NULL )
 	{
@@ -155,12 +166,389 @@ static PyObject* PyTensorNet_GetPrototxtPath( PyTensorNet_Object* self )
 }
 
 
+// GetMaxBatchSize
+static PyObject* PyTensorNet_GetMaxBatchSize( PyTensorNet_Object* self )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet invalid object instance");
+		return NULL;
+	}
+	
+	return PYLONG_FROM_UNSIGNED_LONG(self->net->GetMaxBatchSize());
+}
+
+
+// GetEngineSet
+static PyObject* PyTensorNet_GetEngineSet( PyTensorNet_Object* self )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet invalid object instance");
+		return NULL;
+	}
+
+	const std::vector<uint32_t>& engineSet = self->net->GetEngineSet();
+	PyObject* list = PyList_New(engineSet.size());
+
+	for( size_t n=0; n < engineSet.size(); n++ )
+		PyList_SET_ITEM(list, n, PYLONG_FROM_UNSIGNED_LONG(engineSet[n]));
+
+	return list;
+}
+
+
+// GetStream
+static PyObject* PyTensorNet_GetStream( PyTensorNet_Object* self )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet invalid object instance");
+		return NULL;
+	}
+	
+	return PyLong_FromVoidPtr(self->net->GetStream());
+}
+
+
+// CreateStream
+static PyObject* PyTensorNet_CreateStream( PyTensorNet_Object* self, PyObject* args, PyObject* kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet invalid object instance");
+		return NULL;
+	}
+
+	int nonBlocking = 1;
+	static char* kwlist[] = {"nonBlocking", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "|i", kwlist, &nonBlocking))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet.CreateStream() failed to parse args tuple");
+		return NULL;
+	}
+
+	cudaStream_t stream = NULL;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->worker->Lock();
+	stream = self->net->CreateStream(nonBlocking > 0);
+	self->worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	if( !stream )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet.CreateStream() failed to create CUDA stream");
+		return NULL;
+	}
+
+	return PyLong_FromVoidPtr(stream);
+}
+
+
+// SetStream
+static PyObject* PyTensorNet_SetStream( PyTensorNet_Object* self, PyObject* args, PyObject* kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet invalid object instance");
+		return NULL;
+	}
+
+	PyObject* pyStream = NULL;
+	static char* kwlist[] = {"stream", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &pyStream))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet.SetStream() failed to parse args tuple");
+		return NULL;
+	}
+
+	// None or 0 selects the default stream
+	cudaStream_t stream = NULL;
+
+	if( pyStream != Py_None )
+	{
+		stream = (cudaStream_t)PyLong_AsVoidPtr(pyStream);
+
+		if( PyErr_Occurred() )
+			return NULL;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	self->worker->Lock();
+	self->net->SetStream(stream);
+	self->worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	Py_RETURN_NONE;
+}
+
+
+// parseProfilerArgs
+static bool parseProfilerArgs( PyObject* args, PyObject* kwds, const char* function, const char* defaultQuery, profilerQuery* query, profilerDevice* device )
+{
+	const char* queryStr  = defaultQuery;
+	const char* deviceStr = "cuda";
+
+	static char* kwlist[] = {"query", "device", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "|ss", kwlist, &queryStr, &deviceStr))
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s failed to parse args tuple", function);
+		return false;
+	}
+
+	*query = profilerQueryFromStr(queryStr);
+
+	if( *query == PROFILER_TOTAL && strcasecmp(queryStr, profilerQueryToStr(PROFILER_TOTAL)) != 0 )
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s invalid profiler query '%s'", function, queryStr);
+		return false;
+	}
+
+	if( strcasecmp(deviceStr, profilerDeviceToStr(PROFILER_CPU)) == 0 )
+		*device = PROFILER_CPU;
+	else if( strcasecmp(deviceStr, profilerDeviceToStr(PROFILER_CUDA)) == 0 )
+		*device = PROFILER_CUDA;
+	else
+	{
+		PyErr_Format(PyExc_Exception, LOG_PY_INFERENCE "%s invalid profiler device '%s' (should be 'cpu' or 'cuda')", function, deviceStr);
+		return false;
+	}
+
+	return true;
+}
+
+
+// GetProfilerTime
+static PyObject* PyTensorNet_GetProfilerTime( PyTensorNet_Object* self, PyObject* args, PyObject* kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet invalid object instance");
+		return NULL;
+	}
+
+	profilerQuery  query  = PROFILER_TOTAL;
+	profilerDevice device = PROFILER_CUDA;
+
+	if( !parseProfilerArgs(args, kwds, "tensorNet.GetProfilerTime()", "total", &query, &device) )
+		return NULL;
+
+	return PyFloat_FromDouble(self->net->GetProfilerTime(query, device));
+}
+
+
+// GetProfilerHistogram
+static PyObject* PyTensorNet_GetProfilerHistogram( PyTensorNet_Object* self, PyObject* args, PyObject* kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet invalid object instance");
+		return NULL;
+	}
+
+	profilerQuery  query  = PROFILER_NETWORK;
+	profilerDevice device = PROFILER_CUDA;
+
+	if( !parseProfilerArgs(args, kwds, "tensorNet.GetProfilerHistogram()", "network", &query, &device) )
+		return NULL;
+
+	const profilerHistogram& histogram = self->net->GetProfilerHistogram(query, device);
+
+	// list of (upper limit in ms, count) for the non-empty buckets
+	PyObject* buckets = PyList_New(0);
+
+	if( !buckets )
+		return NULL;
+
+	for( uint32_t n=0; n < profilerHistogram::NumBuckets; n++ )
+	{
+		const uint64_t count = histogram.GetBucketCount(n);
+
+		if( count == 0 )
+			continue;
+
+		PyObject* bucket = Py_BuildValue("(dK)", (double)profilerHistogram::GetBucketLimit(n), (unsigned long long)count);
+
+		if( !bucket || PyList_Append(buckets, bucket) < 0 )
+		{
+			Py_XDECREF(bucket);
+			Py_DECREF(buckets);
+			return NULL;
+		}
+
+		Py_DECREF(bucket);
+	}
+
+	return Py_BuildValue("{s:K,s:d,s:d,s:d,s:d,s:d,s:N}",
+					 "count", (unsigned long long)histogram.GetCount(),
+					 "mean", (double)histogram.GetMean(),
+					 "max", (double)histogram.GetMax(),
+					 "p50", (double)histogram.GetPercentile(0.50f),
+					 "p90", (double)histogram.GetPercentile(0.90f),
+					 "p99", (double)histogram.GetPercentile(0.99f),
+					 "buckets", buckets);
+}
+
+
+// ResetProfilerHistograms
+static PyObject* PyTensorNet_ResetProfilerHistograms( PyTensorNet_Object* self )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet invalid object instance");
+		return NULL;
+	}
+
+	self->net->ResetProfilerHistograms();
+	Py_RETURN_NONE;
+}
+
+
+// Warmup
+static PyObject* PyTensorNet_Warmup( PyTensorNet_Object* self, PyObject* args, PyObject* kwds )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet invalid object instance");
+		return NULL;
+	}
+
+	int iterations = WARMUP_DEFAULT_ITERATIONS;
+	float tolerance = 0.1f;
+	static char* kwlist[] = {"iterations", "tolerance", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "|if", kwlist, &iterations, &tolerance))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet.Warmup() failed to parse args tuple");
+		return NULL;
+	}
+
+	if( iterations <= 0 )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet.Warmup() iterations must be positive");
+		return NULL;
+	}
+
+	uint32_t result = 0;
+
+	Py_BEGIN_ALLOW_THREADS
+	self->worker->Lock();
+	result = self->net->Warmup(iterations, tolerance);
+	self->worker->Unlock();
+	Py_END_ALLOW_THREADS
+
+	if( result == 0 )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet.Warmup() failed to run the network");
+		return NULL;
+	}
+
+	// return the latency of each iteration
+	const std::vector<float>& curve = self->net->GetWarmupCurve();
+	PyObject* list = PyList_New(curve.size());
+
+	for( size_t n=0; n < curve.size(); n++ )
+		PyList_SET_ITEM(list, n, PyFloat_FromDouble(curve[n]));
+
+	return list;
+}
+
+
 //-------------------------------------------------------------------------------
 static PyTypeObject pyTensorNet_Type = 
 {
     PyVarObject_HEAD_INIT(NULL, 0)
 };
 
+
+// GetLoadReport
+static PyObject* PyTensorNet_GetLoadReport( PyTensorNet_Object* self )
+{
+	if( !self || !self->net )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet invalid object instance");
+		return NULL;
+	}
+
+	const tensorLoadReport& report = self->net->GetLoadReport();
+
+	return Py_BuildValue("{s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:d,s:O,s:O}",
+					 "plugins", (double)report.plugins,
+					 "locate", (double)report.locate,
+					 "precision", (double)report.precision,
+					 "autotune", (double)report.autotune,
+					 "cache_read", (double)report.cacheRead,
+					 "parse", (double)report.parse,
+					 "build", (double)report.build,
+					 "serialize", (double)report.serialize,
+					 "cache_write", (double)report.cacheWrite,
+					 "deserialize", (double)report.deserialize,
+					 "context", (double)report.context,
+					 "buffers", (double)report.buffers,
+					 "engine_set", (double)report.engineSet,
+					 "total", (double)report.total,
+					 "cache_hit", report.cacheHit ? Py_True : Py_False,
+					 "capability_cached", report.capabilityCached ? Py_True : Py_False);
+}
+
+
+// SetCapabilityCache
+static PyObject* PyTensorNet_SetCapabilityCache( PyObject* cls, PyObject* args, PyObject* kwds )
+{
+	const char* path = NULL;
+	static char* kwlist[] = {"path", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "z", kwlist, &path))
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet.SetCapabilityCache() failed to parse args tuple");
+		return NULL;
+	}
+
+	tensorNet::SetCapabilityCache(path);
+	Py_RETURN_NONE;
+}
+
+
+// SetEngineSet
+static PyObject* PyTensorNet_SetEngineSet( PyObject* cls, PyObject* args, PyObject* kwds )
+{
+	PyObject* list = NULL;
+	static char* kwlist[] = {"batch_sizes", NULL};
+
+	if( !PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &list) || !PySequence_Check(list) )
+	{
+		PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet.SetEngineSet() failed to parse args (expected a list of batch sizes)");
+		return NULL;
+	}
+
+	std::vector<uint32_t> batchSizes;
+	const Py_ssize_t size = PySequence_Size(list);
+
+	for( Py_ssize_t n=0; n < size; n++ )
+	{
+		PyObject* item = PySequence_GetItem(list, n);
+		const long batchSize = item != NULL ? PyLong_AsLong(item) : -1;
+
+		Py_XDECREF(item);
+
+		if( batchSize <= 0 )
+		{
+			PyErr_SetString(PyExc_Exception, LOG_PY_INFERENCE "tensorNet.SetEngineSet() -- the batch sizes should be positive integers");
+			return NULL;
+		}
+
+		batchSizes.push_back(batchSize);
+	}
+
+	tensorNet::SetEngineSet(batchSizes);
+	Py_RETURN_NONE;
+}
+
+
 static PyMethodDef pyTensorNet_Methods[] = 
 {
 	{ "EnableDebug", (PyCFunction)PyTensorNet_EnableDebug, METH_NOARGS, "Enable TensorRT debug messages and device synchronization"},
@@ -170,6 +558,18 @@ static PyMethodDef pyTensorNet_Methods[] =
 	{ "GetModelType", (PyCFunction)PyTensorNet_GetModelType, METH_NOARGS, "Return the type of model format (caffe, ONNX, UFF, or custom)"},
 	{ "GetModelPath", (PyCFunction)PyTensorNet_GetModelPath, METH_NOARGS, "Return the path to the network model file on disk"},
 	{ "GetPrototxtPath", (PyCFunction)PyTensorNet_GetPrototxtPath, METH_NOARGS, "Return the path to the network prototxt file on disk"},
+	{ "GetMaxBatchSize", (PyCFunction)PyTensorNet_GetMaxBatchSize, METH_NOARGS, "Return the maximum batch size that the network was loaded with"},
+	{ "GetEngineSet", (PyCFunction)PyTensorNet_GetEngineSet, METH_NOARGS, "Return the batch sizes of the engines that the network loaded, in increasing order (the last is the max batch size)"},
+	{ "GetStream", (PyCFunction)PyTensorNet_GetStream, METH_NOARGS, "Return the CUDA stream that the network runs on, as an integer handle (0 is the default stream)"},
+	{ "CreateStream", (PyCFunction)PyTensorNet_CreateStream, METH_VARARGS|METH_KEYWORDS, "Create a new CUDA stream (non-blocking by default), run the network on it, and return its handle"},
+	{ "SetStream", (PyCFunction)PyTensorNet_SetStream, METH_VARARGS|METH_KEYWORDS, "Run the network on the stream handle returned by GetStream() or CreateStream() of another network (None or 0 for the default stream)"},
+	{ "GetProfilerTime", (PyCFunction)PyTensorNet_GetProfilerTime, METH_VARARGS|METH_KEYWORDS, "Return the runtime (in milliseconds) of the last run of a profiler query ('pre-process', 'network', 'post-process', 'visualize' or 'total') on a device ('cpu' or 'cuda')"},
+	{ "GetProfilerHistogram", (PyCFunction)PyTensorNet_GetProfilerHistogram, METH_VARARGS|METH_KEYWORDS, "Return a dict with the count, mean, max, p50/p90/p99 and (limit, count) buckets of the runtimes of a profiler query over every request (default is 'network' on 'cuda')"},
+	{ "ResetProfilerHistograms", (PyCFunction)PyTensorNet_ResetProfilerHistograms, METH_NOARGS, "Clear the profiler histograms"},
+	{ "GetLoadReport", (PyCFunction)PyTensorNet_GetLoadReport, METH_NOARGS, "Return a dict with the time (in milliseconds) spent in each stage of loading the network, and whether the engine and device capabilities were cached"},
+	{ "Warmup", (PyCFunction)PyTensorNet_Warmup, METH_VARARGS|METH_KEYWORDS, "Run the network on synthetic frames until its latency converges (up to iterations, default 50), and return the latency of each iteration (in milliseconds)"},
+	{ "SetCapabilityCache", (PyCFunction)PyTensorNet_SetCapabilityCache, METH_VARARGS|METH_KEYWORDS|METH_STATIC, "Persist the native precisions probed for each device to a file (None to disable), so that later processes skip probing them"},
+	{ "SetEngineSet", (PyCFunction)PyTensorNet_SetEngineSet, METH_VARARGS|METH_KEYWORDS|METH_STATIC, "Set the smaller batch sizes that networks loaded afterwards build engines for, so that each batch runs on the smallest engine that fits it (an empty list disables)"},
 	{NULL}  /* Sentinel */
 };
 
@@ -28,12 +28,14 @@
 
 // forward declarations
 class tensorNet;
+class PyInferenceWorker;
 
 
 // PyTensorNet container
 typedef struct {
     PyObject_HEAD
     tensorNet* net;	// object instance
+    PyInferenceWorker* worker;	// runs async requests and serializes access to the network
 } PyTensorNet_Object;
 
 
@@ -0,0 +1,183 @@
+#
+# Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+# DEALINGS IN THE SOFTWARE.
+#
+
+"""
+Client of inference-daemon, for processes that share the daemon's networks
+instead of loading their own copy.  This module is pure Python (3.8+) and
+doesn't require CUDA in the client process.
+
+Frames are written into a ring of shared-memory slots that is passed to the
+daemon when connecting.  The daemon processes each frame in place and writes
+the results back into the same slot:
+
+	client = jetson.inference.client.inferenceClient(1280, 720)
+	client.GetImage(0)[:] = frame	# RGBA float32, width*height*4 values
+	results = client.Process(0, jetson.inference.client.DETECT, 1280, 720)
+"""
+
+import mmap
+import os
+import socket
+import struct
+
+
+DEFAULT_SOCKET = "/tmp/jetson-inference.sock"
+
+# must match inferenceProtocol.h
+PROTOCOL_MAGIC = 0x4a494e46
+MAX_RESULTS    = 128
+IMAGE_OFFSET   = 4096
+
+MSG_ATTACH       = 1
+MSG_ATTACH_REPLY = 2
+MSG_REQUEST      = 3
+MSG_RESPONSE     = 4
+
+CLASSIFY = 0
+DETECT   = 1
+
+FLAG_OVERLAY = 1
+
+_message = struct.Struct("<IIIiIIIIIIIIQ")
+_result  = struct.Struct("<ifffff")
+
+
+def slotSize(width, height):
+	"""Size of a shared-memory slot holding an RGBA float4 frame (rounded up to a page)"""
+	size = IMAGE_OFFSET + width * height * 16
+	return (size + 4095) & ~4095
+
+
+class inferenceClient:
+	"""
+	Connection to inference-daemon, with a ring of num_slots shared-memory
+	slots that each hold one frame of up to max_width x max_height.
+	"""
+	def __init__(self, max_width, max_height, num_slots=4, socket_path=DEFAULT_SOCKET):
+		self.max_width  = max_width
+		self.max_height = max_height
+		self.num_slots  = num_slots
+		self.slot_size  = slotSize(max_width, max_height)
+		self.sequence   = 0
+		self.pending    = 0
+
+		# allocate and map the ring
+		self.memory = os.memfd_create("jetson-inference", os.MFD_CLOEXEC)
+		os.ftruncate(self.memory, self.slot_size * num_slots)
+		self.mapping = mmap.mmap(self.memory, self.slot_size * num_slots)
+		self.view = memoryview(self.mapping)
+
+		# connect and pass the ring to the daemon
+		self.socket = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+		self.socket.connect(socket_path)
+
+		self._send(MSG_ATTACH, width=max_width, height=max_height, numSlots=num_slots, slotSize=self.slot_size, fd=self.memory)
+		reply = self._recv()
+
+		if reply['type'] != MSG_ATTACH_REPLY or reply['status'] != 0:
+			raise RuntimeError("inference daemon failed to attach shared memory ({:s})".format(os.strerror(-reply['status'])))
+
+	def close(self):
+		"""Disconnect from the daemon and release the shared memory"""
+		if self.socket is not None:
+			self.socket.close()
+			self.view.release()
+
+			try:
+				self.mapping.close()
+			except BufferError:
+				pass	# images from GetImage() are still referenced, the mapping is freed with them
+			os.close(self.memory)
+			self.socket = None
+
+	def __enter__(self):
+		return self
+
+	def __exit__(self, *args):
+		self.close()
+
+	def GetImage(self, slot):
+		"""Retrieve a float32 memoryview of the slot's RGBA image, to write the frame into"""
+		offset = self.slot_size * slot + IMAGE_OFFSET
+		return self.view[offset:offset + self.max_width * self.max_height * 16].cast('f')
+
+	def GetResults(self, slot, num_results):
+		"""Retrieve the results of a slot, as a list of (classID, confidence, left, top, right, bottom)"""
+		offset = self.slot_size * slot
+		return [_result.unpack_from(self.view, offset + n * _result.size) for n in range(min(num_results, MAX_RESULTS))]
+
+	def Submit(self, slot, network, width, height, flags=0):
+		"""Queue the frame in a slot for processing, without waiting"""
+		if slot >= self.num_slots or width > self.max_width or height > self.max_height:
+			raise ValueError("invalid slot {:d} or frame size {:d}x{:d}".format(slot, width, height))
+
+		self._send(MSG_REQUEST, slot=slot, network=network, width=width, height=height, flags=flags)
+		self.pending += 1
+
+	def Receive(self):
+		"""Wait for the next response, and return (slot, results)"""
+		if self.pending == 0:
+			raise RuntimeError("no requests are pending")
+
+		reply = self._recv()
+		self.pending -= 1
+
+		if reply['type'] != MSG_RESPONSE:
+			raise RuntimeError("unexpected message from the inference daemon")
+
+		if reply['status'] != 0:
+			raise RuntimeError("request failed ({:s})".format(os.strerror(-reply['status'])))
+
+		return reply['slot'], self.GetResults(reply['slot'], reply['numResults'])
+
+	def Process(self, slot, network, width, height, flags=0):
+		"""Process the frame in a slot, and return the list of results"""
+		self.Submit(slot, network, width, height, flags)
+		return self.Receive()[1]
+
+	def _send(self, type, slot=0, network=0, width=0, height=0, flags=0, numSlots=0, slotSize=0, fd=None):
+		msg = _message.pack(PROTOCOL_MAGIC, type, self.sequence, 0, slot, network, width, height, flags, 0, numSlots, 0, slotSize)
+		self.sequence += 1
+
+		if fd is not None:
+			self.socket.sendmsg([msg], [(socket.SOL_SOCKET, socket.SCM_RIGHTS, struct.pack("i", fd))])
+		else:
+			self.socket.sendall(msg)
+
+	def _recv(self):
+		data = b''
+
+		while len(data) < _message.size:
+			chunk = self.socket.recv(_message.size - len(data))
+
+			if not chunk:
+				raise ConnectionError("lost connection to the inference daemon")
+
+			data += chunk
+
+		fields = _message.unpack(data)
+
+		if fields[0] != PROTOCOL_MAGIC:
+			raise RuntimeError("invalid message from the inference daemon")
+
+		return dict(zip(('magic', 'type', 'sequence', 'status', 'slot', 'network', 'width', 'height',
+					   'flags', 'numResults', 'numSlots', 'reserved', 'slotSize'), fields))
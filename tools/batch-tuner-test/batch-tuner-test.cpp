@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "batchTuner.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+
+/*
+ * Test of the batch size selection and of the engine set selection of
+ * batchTuner, which don't depend on CUDA or TensorRT, so that it runs
+ * without a GPU (i.e. in CI).
+ *
+ * The exit status is the number of checks that failed.
+ */
+int usage()
+{
+	printf("usage: batch-tuner-test [-h] [--verbose]\n\n");
+	printf("Check the parsing and selection of engine sets, and the selection and\n");
+	printf("persistence of batch sizes.  The exit status is the number of checks that failed.\n\n");
+	printf("optional arguments:\n");
+	printf("  --help             show this help message and exit\n");
+	printf("  --verbose          print the checks that passed too\n\n");
+
+	return 0;
+}
+
+
+static int  numChecks = 0;
+static int  numFailed = 0;
+static bool verbose   = false;
+
+
+// check
+static void check( bool condition, const char* test, const char* description )
+{
+	numChecks++;
+
+	if( !condition )
+		numFailed++;
+
+	if( !condition || verbose )
+		printf("%s  %-10s %s\n", condition ? "[pass]" : "[FAIL]", test, description);
+}
+
+
+// list of batch sizes
+static std::vector<uint32_t> sizes( const char* str )
+{
+	std::vector<uint32_t> list;
+
+	while( str != NULL && *str != '\0' )
+	{
+		char* end = NULL;
+		list.push_back(strtoul(str, &end, 10));
+		str = (*end == ',') ? end + 1 : end;
+	}
+
+	return list;
+}
+
+
+//-----------------------------------------------------------------------------
+// ParseEngineSet() accepts lists of positive sizes only
+static void testParse()
+{
+	std::vector<uint32_t> parsed;
+
+	check(batchTuner::ParseEngineSet("1,2,4,8", parsed) && parsed == sizes("1,2,4,8"), "parse", "a list of sizes is parsed");
+	check(batchTuner::ParseEngineSet("4,1,4", parsed) && parsed == sizes("4,1,4"), "parse", "the order and duplicates are left to EngineSet()");
+	check(batchTuner::ParseEngineSet("16", parsed) && parsed == sizes("16"), "parse", "a single size is parsed");
+
+	parsed = sizes("7");
+
+	check(!batchTuner::ParseEngineSet("1,2,", parsed), "parse", "a trailing comma is rejected");
+	check(!batchTuner::ParseEngineSet("1,,2", parsed) && !batchTuner::ParseEngineSet(",1", parsed), "parse", "an empty entry is rejected");
+	check(!batchTuner::ParseEngineSet("1,0", parsed) && !batchTuner::ParseEngineSet("-2", parsed), "parse", "sizes that aren't positive are rejected");
+	check(!batchTuner::ParseEngineSet("1,x", parsed) && !batchTuner::ParseEngineSet("2 4", parsed), "parse", "sizes that aren't integers are rejected");
+	check(!batchTuner::ParseEngineSet("", parsed) && !batchTuner::ParseEngineSet(NULL, parsed), "parse", "an empty list is rejected");
+	check(!batchTuner::ParseEngineSet("99999999999", parsed), "parse", "a size that doesn't fit 32 bits is rejected");
+	check(parsed == sizes("7"), "parse", "a rejected list leaves the output unchanged");
+}
+
+
+//-----------------------------------------------------------------------------
+// EngineSet() sorts the sizes below the max, and ends with the max
+static void testEngineSet()
+{
+	check(batchTuner::EngineSet(sizes("4,1,2,2,4"), 8) == sizes("1,2,4,8"), "engineset", "the sizes are sorted without duplicates");
+	check(batchTuner::EngineSet(sizes("1,8,16"), 8) == sizes("1,8"), "engineset", "sizes at or above the max batch size are dropped");
+	check(batchTuner::EngineSet(sizes("0,2"), 4) == sizes("2,4"), "engineset", "a size of 0 is dropped");
+	check(batchTuner::EngineSet(std::vector<uint32_t>(), 4) == sizes("4"), "engineset", "the max batch size is always the last engine");
+	check(batchTuner::EngineSet(sizes("1,2"), 1) == sizes("1"), "engineset", "a max batch size of 1 is the only engine");
+	check(batchTuner::EngineSet(sizes("1,2"), 0).empty(), "engineset", "a max batch size of 0 has no engines");
+}
+
+
+//-----------------------------------------------------------------------------
+// SelectEngine() picks the smallest engine that fits the batch
+static void testSelectEngine()
+{
+	const std::vector<uint32_t> set = batchTuner::EngineSet(sizes("1,2,4"), 8);
+
+	check(batchTuner::SelectEngine(set, 1) == 0, "select", "a batch of 1 runs on the smallest engine");
+	check(batchTuner::SelectEngine(set, 2) == 1 && batchTuner::SelectEngine(set, 4) == 2, "select", "a batch the size of an engine runs on it");
+	check(batchTuner::SelectEngine(set, 3) == 2 && batchTuner::SelectEngine(set, 5) == 3, "select", "a batch runs on the next larger engine");
+	check(batchTuner::SelectEngine(set, 8) == 3, "select", "a full batch runs on the max engine");
+	check(batchTuner::SelectEngine(set, 9) == -1, "select", "a batch larger than the max returns -1");
+	check(batchTuner::SelectEngine(std::vector<uint32_t>(), 1) == -1, "select", "an empty set returns -1");
+}
+
+
+//-----------------------------------------------------------------------------
+// Select() and FlushTimeout() of the measured batch sizes, and their persistence
+static void testProfiles()
+{
+	const batchProfile measured[] = { { 1, 2.0f, 3.0f, 500.0f },
+							    { 2, 3.0f, 4.0f, 666.0f },
+							    { 4, 5.0f, 7.0f, 800.0f },
+							    { 8, 9.0f, 12.0f, 888.0f } };
+
+	const std::vector<batchProfile> profiles(measured, measured + sizeof(measured) / sizeof(measured[0]));
+
+	check(batchTuner::Candidates(8) == sizes("1,2,4,8") && batchTuner::Candidates(6) == sizes("1,2,4,6"), "profiles", "the candidates are powers of two and the max");
+	check(batchTuner::Select(profiles, 10.0f) == 4, "profiles", "the highest throughput under the target is selected");
+	check(batchTuner::Select(profiles, 1.0f) == 1, "profiles", "the lowest latency is selected if none meets the target");
+	check(batchTuner::Select(std::vector<batchProfile>(), 10.0f) == 0, "profiles", "no profiles select 0");
+	check(batchTuner::FlushTimeout(profiles, 4, 10.0f) == 3.0f && batchTuner::FlushTimeout(profiles, 8, 10.0f) == 0.0f, "profiles", "the flush timeout is the time left over");
+
+	char path[] = "/tmp/batch-tuner-test.XXXXXX";
+	const int fd = mkstemp(path);
+
+	if( fd < 0 )
+	{
+		check(false, "profiles", "a temporary file is created");
+		return;
+	}
+
+	close(fd);
+
+	std::vector<batchProfile> loaded;
+
+	check(batchTuner::Save(path, "TensorRT-8.0.0/gpu/sm72", profiles), "profiles", "the profiles are saved");
+	check(batchTuner::Load(path, "TensorRT-8.0.0/gpu/sm72", loaded) && loaded.size() == profiles.size() &&
+		 loaded[2].batchSize == 4 && loaded[2].latencyP99 == 7.0f, "profiles", "the profiles are loaded with the same key");
+	check(!batchTuner::Load(path, "TensorRT-8.0.0/gpu/sm87", loaded), "profiles", "the profiles of another key aren't loaded");
+
+	unlink(path);
+}
+
+
+int main( int argc, char** argv )
+{
+	for( int n=1; n < argc; n++ )
+	{
+		if( strcmp(argv[n], "--help") == 0 || strcmp(argv[n], "-h") == 0 )
+			return usage();
+		else if( strcmp(argv[n], "--verbose") == 0 )
+			verbose = true;
+		else
+			return usage();
+	}
+
+	testParse();
+	testEngineSet();
+	testSelectEngine();
+	testProfiles();
+
+	printf("batch-tuner-test:  %i of %i checks passed\n", numChecks - numFailed, numChecks);
+	return numFailed;
+}
@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "dagPlanner.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+
+/*
+ * Test of the scheduling and buffer planning of dagPlanner on small graphs
+ * whose plan is known, and on random graphs against the invariants that
+ * dagExecutor relies on.  It doesn't depend on CUDA, so it runs without a
+ * GPU (i.e. in CI).
+ *
+ * The exit status is the number of checks that failed.
+ */
+int usage()
+{
+	printf("usage: dag-planner-test [-h] [--verbose]\n\n");
+	printf("Check the topological order, stream assignment, waits and arena packing\n");
+	printf("of the DAG planner.  The exit status is the number of checks that failed.\n\n");
+	printf("optional arguments:\n");
+	printf("  --help             show this help message and exit\n");
+	printf("  --verbose          print the checks that passed too, and the plans\n\n");
+
+	return 0;
+}
+
+
+static int  numChecks = 0;
+static int  numFailed = 0;
+static bool verbose   = false;
+
+
+// check
+static void check( bool condition, const char* test, const char* description )
+{
+	numChecks++;
+
+	if( !condition )
+		numFailed++;
+
+	if( !condition || verbose )
+		printf("%s  %-8s %s\n", condition ? "[pass]" : "[FAIL]", test, description);
+}
+
+
+// list of buffer indices
+static std::vector<int> list()							{ return std::vector<int>(); }
+static std::vector<int> list( int a )						{ return std::vector<int>(1, a); }
+static std::vector<int> list( int a, int b )					{ std::vector<int> v(1, a); v.push_back(b); return v; }
+
+
+// check that every node is issued after the nodes it depends on
+static bool isTopological( const dagPlanner& dag )
+{
+	const std::vector<int>& order = dag.GetOrder();
+
+	if( order.size() != dag.GetNumNodes() )
+		return false;
+
+	std::vector<int> position(dag.GetNumNodes(), -1);
+
+	for( size_t i=0; i < order.size(); i++ )
+		position[order[i]] = i;
+
+	for( uint32_t n=0; n < dag.GetNumNodes(); n++ )
+	{
+		const std::vector<int>& deps = dag.GetNodeDependencies(n);
+
+		for( size_t d=0; d < deps.size(); d++ )
+		{
+			if( position[n] < 0 || position[deps[d]] >= position[n] )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
+// check that the waits are exactly the dependencies on other streams, and that those record events
+static bool waitsMatchStreams( const dagPlanner& dag )
+{
+	for( uint32_t n=0; n < dag.GetNumNodes(); n++ )
+	{
+		const std::vector<int>& deps  = dag.GetNodeDependencies(n);
+		const std::vector<int>& waits = dag.GetNodeWaits(n);
+
+		if( dag.GetNodeStream(n) >= dag.GetNumStreams() )
+			return false;
+
+		for( size_t d=0; d < deps.size(); d++ )
+		{
+			const bool crosses = (dag.GetNodeStream(deps[d]) != dag.GetNodeStream(n));
+			const bool waited  = (std::find(waits.begin(), waits.end(), deps[d]) != waits.end());
+
+			if( crosses != waited || (crosses && !dag.IsNodeWaitedOn(deps[d])) )
+				return false;
+		}
+
+		if( waits.size() > deps.size() )
+			return false;
+	}
+
+	return true;
+}
+
+
+// the nodes that use a buffer last -- its readers, or its writer if nothing reads it
+static std::vector<int> lastUses( const dagPlanner& dag, int buffer, int producer )
+{
+	std::vector<int> uses;
+
+	for( uint32_t n=0; n < dag.GetNumNodes(); n++ )
+	{
+		const std::vector<int>& inputs = dag.GetNodeInputs(n);
+
+		if( std::find(inputs.begin(), inputs.end(), buffer) != inputs.end() )
+			uses.push_back(n);
+	}
+
+	if( uses.empty() )
+		uses.push_back(producer);
+
+	return uses;
+}
+
+
+// check that arena buffers which overlap in memory are ordered by HappensBefore
+static bool overlapsAreOrdered( const dagPlanner& dag )
+{
+	const int numBuffers = dag.GetNumBuffers();
+	std::vector<int> producers(numBuffers, -1);
+
+	for( uint32_t n=0; n < dag.GetNumNodes(); n++ )
+	{
+		const std::vector<int>& outputs = dag.GetNodeOutputs(n);
+
+		for( size_t o=0; o < outputs.size(); o++ )
+			producers[outputs[o]] = n;
+	}
+
+	for( int a=0; a < numBuffers; a++ )
+	{
+		if( dag.IsBufferExternal(a) || producers[a] < 0 )
+			continue;
+
+		if( dag.GetBufferOffset(a) + dag.GetBufferSize(a) > dag.GetArenaSize() )
+			return false;
+
+		for( int b=a+1; b < numBuffers; b++ )
+		{
+			if( dag.IsBufferExternal(b) || producers[b] < 0 )
+				continue;
+
+			const bool overlap = dag.GetBufferOffset(a) < dag.GetBufferOffset(b) + dag.GetBufferSize(b) &&
+							 dag.GetBufferOffset(b) < dag.GetBufferOffset(a) + dag.GetBufferSize(a);
+
+			if( !overlap )
+				continue;
+
+			// either every use of a finishes before b is written, or the other way around
+			const std::vector<int> usesA = lastUses(dag, a, producers[a]);
+			const std::vector<int> usesB = lastUses(dag, b, producers[b]);
+
+			bool aFirst = true;
+			bool bFirst = true;
+
+			for( size_t u=0; u < usesA.size(); u++ )
+				aFirst = aFirst && dag.HappensBefore(usesA[u], producers[b]);
+
+			for( size_t u=0; u < usesB.size(); u++ )
+				bFirst = bFirst && dag.HappensBefore(usesB[u], producers[a]);
+
+			if( !aFirst && !bFirst )
+			{
+				printf("buffers '%s' and '%s' overlap but aren't ordered\n", dag.GetBufferName(a), dag.GetBufferName(b));
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+// a chain stays on one stream, and its intermediate buffers reuse memory
+static void testChain()
+{
+	dagPlanner dag;
+
+	const int input  = dag.AddBuffer("input", 1000, true);
+	const int a      = dag.AddBuffer("a", 1000);
+	const int b      = dag.AddBuffer("b", 1000);
+	const int c      = dag.AddBuffer("c", 1000);
+	const int output = dag.AddBuffer("output", 1000, true);
+
+	// added out of order, so the order has to come from the dependencies
+	const int n3 = dag.AddNode("n3", list(c), list(output));
+	const int n2 = dag.AddNode("n2", list(b), list(c));
+	const int n1 = dag.AddNode("n1", list(a), list(b));
+	const int n0 = dag.AddNode("n0", list(input), list(a));
+
+	check(dag.Plan(4, 256), "chain", "the chain is planned");
+
+	if( verbose )
+		dag.Print();
+
+	const std::vector<int>& order = dag.GetOrder();
+
+	check(order.size() == 4 && order[0] == n0 && order[1] == n1 && order[2] == n2 && order[3] == n3, "chain", "the nodes are ordered by their dependencies");
+	check(dag.GetNumStreams() == 1 && dag.GetNodeWaits(n3).empty() && !dag.IsNodeWaitedOn(n0), "chain", "a chain is issued on one stream without events");
+	check(dag.GetBufferOffset(a) == dag.GetBufferOffset(c) && dag.GetBufferOffset(a) != dag.GetBufferOffset(b), "chain", "a and c share memory, b doesn't");
+	check(dag.GetArenaSize() == 2 * 1024 && dag.GetUnpackedSize() == 3 * 1024, "chain", "the arena is packed and aligned");
+	check(dag.HappensBefore(n0, n3) && !dag.HappensBefore(n3, n0) && !dag.HappensBefore(n1, n1), "chain", "HappensBefore() follows the dependencies");
+	check(overlapsAreOrdered(dag), "chain", "overlapping buffers are ordered");
+}
+
+
+//-----------------------------------------------------------------------------
+// the branches of a fork run on their own streams, and the join waits for them
+static void testDiamond()
+{
+	dagPlanner dag;
+
+	const int input  = dag.AddBuffer("input", 4096, true);
+	const int split  = dag.AddBuffer("split", 4096);
+	const int left   = dag.AddBuffer("left", 4096);
+	const int right  = dag.AddBuffer("right", 4096);
+	const int output = dag.AddBuffer("output", 4096, true);
+
+	const int nSplit = dag.AddNode("split", list(input), list(split));
+	const int nLeft  = dag.AddNode("left", list(split), list(left));
+	const int nRight = dag.AddNode("right", list(split), list(right));
+	const int nJoin  = dag.AddNode("join", list(left, right), list(output));
+
+	check(dag.Plan(4, 256), "diamond", "the diamond is planned");
+
+	if( verbose )
+		dag.Print();
+
+	check(isTopological(dag) && dag.GetOrder().front() == nSplit && dag.GetOrder().back() == nJoin, "diamond", "the order is topological");
+	check(dag.GetNumStreams() == 2 && dag.GetNodeStream(nLeft) != dag.GetNodeStream(nRight), "diamond", "the branches run on different streams");
+	check(dag.GetNodeStream(nSplit) == dag.GetNodeStream(nLeft) && dag.GetNodeStream(nJoin) == dag.GetNodeStream(nLeft), "diamond", "the chain continues on the first stream");
+	check(dag.GetNodeWaits(nRight) == list(nSplit) && dag.GetNodeWaits(nJoin) == list(nRight), "diamond", "the dependencies across streams are waited for");
+	check(dag.IsNodeWaitedOn(nSplit) && dag.IsNodeWaitedOn(nRight) && !dag.IsNodeWaitedOn(nLeft), "diamond", "only the nodes that are waited for record events");
+	check(waitsMatchStreams(dag), "diamond", "the waits are the dependencies on other streams");
+	check(!dag.HappensBefore(nLeft, nRight) && !dag.HappensBefore(nRight, nLeft), "diamond", "the branches are concurrent");
+
+	// left and right are live at the same time, and split is read by both
+	check(dag.GetBufferOffset(left) != dag.GetBufferOffset(right) && dag.GetBufferOffset(split) != dag.GetBufferOffset(left) &&
+		 dag.GetBufferOffset(split) != dag.GetBufferOffset(right), "diamond", "buffers of concurrent nodes don't share memory");
+	check(overlapsAreOrdered(dag), "diamond", "overlapping buffers are ordered");
+
+	// with one stream, everything is issued in order without events
+	check(dag.Plan(1, 256) && dag.GetNumStreams() == 1 && dag.GetNodeWaits(nJoin).empty() && dag.GetNodeWaits(nRight).empty(), "diamond", "one stream needs no waits");
+	check(waitsMatchStreams(dag) && overlapsAreOrdered(dag), "diamond", "one stream keeps the invariants");
+}
+
+
+//-----------------------------------------------------------------------------
+// graphs that can't be scheduled are rejected
+static void testInvalid()
+{
+	{
+		dagPlanner dag;
+
+		const int x = dag.AddBuffer("x", 16);
+		const int y = dag.AddBuffer("y", 16);
+
+		dag.AddNode("a", list(x), list(y));
+		dag.AddNode("b", list(y), list(x));
+
+		check(!dag.Plan(), "invalid", "a cycle is rejected");
+	}
+
+	{
+		dagPlanner dag;
+
+		const int x = dag.AddBuffer("x", 16);
+		const int y = dag.AddBuffer("y", 16);
+
+		dag.AddNode("a", list(x), list(y));
+
+		check(!dag.Plan(), "invalid", "a read of a buffer that's never written is rejected");
+	}
+
+	{
+		dagPlanner dag;
+
+		const int x = dag.AddBuffer("x", 16, true);
+		const int y = dag.AddBuffer("y", 16);
+
+		dag.AddNode("a", list(x), list(y));
+
+		check(dag.Plan() && dag.GetArenaSize() == 256, "invalid", "a read of an external buffer that's never written is allowed");
+	}
+
+	{
+		dagPlanner dag;
+
+		const int x = dag.AddBuffer("x", 16, true);
+		const int y = dag.AddBuffer("y", 16);
+
+		check(dag.AddNode("a", list(x), list(y)) == 0, "invalid", "a node is added");
+		check(dag.AddNode("b", list(x), list(y)) < 0, "invalid", "a second writer of a buffer is rejected");
+		check(dag.AddNode("c", list(5), list()) < 0 && dag.AddNode("d", list(), list(-1)) < 0, "invalid", "an invalid buffer index is rejected");
+		check(dag.GetNumNodes() == 1, "invalid", "the rejected nodes aren't added");
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// random graphs keep the invariants for any number of streams
+static uint32_t randomState = 1;
+
+static inline uint32_t randomInt()
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static void testRandom()
+{
+	bool planned  = true;
+	bool ordered  = true;
+	bool waits    = true;
+	bool overlaps = true;
+	bool packed   = true;
+
+	randomState = 84;
+
+	for( int graph=0; graph < 200; graph++ )
+	{
+		dagPlanner dag;
+
+		const int numNodes = 2 + randomInt() % 14;
+		std::vector<int> outputs;
+
+		const int input = dag.AddBuffer("input", 1 + randomInt() % 4096, true);
+
+		// each node reads one or two of the earlier buffers, and writes one or two new ones
+		for( int n=0; n < numNodes; n++ )
+		{
+			std::vector<int> reads(1, (outputs.size() > 0 && (randomInt() % 4) != 0) ? outputs[randomInt() % outputs.size()] : input);
+
+			if( outputs.size() > 1 && (randomInt() % 2) == 0 )
+				reads.push_back(outputs[randomInt() % outputs.size()]);
+
+			std::vector<int> writes(1, dag.AddBuffer("buffer", 1 + randomInt() % 65536, (randomInt() % 8) == 0));
+
+			if( (randomInt() % 3) == 0 )
+				writes.push_back(dag.AddBuffer("buffer", 1 + randomInt() % 65536));
+
+			dag.AddNode("node", reads, writes);
+			outputs.insert(outputs.end(), writes.begin(), writes.end());
+		}
+
+		if( !dag.Plan(1 + randomInt() % 4, 256) )
+		{
+			planned = false;
+			continue;
+		}
+
+		ordered  = ordered && isTopological(dag);
+		waits    = waits && waitsMatchStreams(dag);
+		overlaps = overlaps && overlapsAreOrdered(dag);
+		packed   = packed && dag.GetArenaSize() <= dag.GetUnpackedSize();
+	}
+
+	check(planned, "random", "every random graph is planned");
+	check(ordered, "random", "the order is topological");
+	check(waits, "random", "the waits are the dependencies on other streams");
+	check(overlaps, "random", "overlapping buffers are ordered by HappensBefore()");
+	check(packed, "random", "the arena is never bigger than the unpacked buffers");
+}
+
+
+int main( int argc, char** argv )
+{
+	for( int n=1; n < argc; n++ )
+	{
+		if( strcmp(argv[n], "--help") == 0 || strcmp(argv[n], "-h") == 0 )
+			return usage();
+		else if( strcmp(argv[n], "--verbose") == 0 )
+			verbose = true;
+		else
+			return usage();
+	}
+
+	testChain();
+	testDiamond();
+	testInvalid();
+	testRandom();
+
+	printf("dag-planner-test:  %i of %i checks passed\n", numChecks - numFailed, numChecks);
+	return numFailed;
+}
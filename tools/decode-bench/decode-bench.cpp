@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "decodePool.h"
+#include "threadConfig.h"
+
+#include "commandLine.h"
+#include "loadImage.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+
+/*
+ * Benchmark of decoding a set of images into mapped memory, comparing the serial
+ * loadImageRGBA() path used by the console examples (which allocates and frees the
+ * buffers of every image) with decodePool at different numbers of worker threads.
+ * Only the CPU-side decode is measured -- the images aren't run through a network.
+ */
+int usage()
+{
+	printf("usage: decode-bench [-h] [--workers=N,N,...] [--buffers=N] [--unordered]\n");
+	printf("                    [--repeat=N] [--no-baseline] [--threads=FILE] [--thread-decode=SPEC]\n");
+	printf("                    path\n\n");
+	printf("Measure the throughput of decoding images with loadImageRGBA() and with decodePool.\n\n");
+	printf("positional arguments:\n");
+	printf("  path               directory of images, list file (.txt) or a single image\n\n");
+	printf("optional arguments:\n");
+	printf("  --help             show this help message and exit\n");
+	printf("  --workers=N,N,...  numbers of decode threads to benchmark (default: 1,2,4,<cores>)\n");
+	printf("  --buffers=N        number of buffers in the pool (default: twice the workers)\n");
+	printf("  --unordered        return the images as they complete instead of in order\n");
+	printf("  --repeat=N         decode the set of images N times per run (default: 1)\n");
+	printf("  --no-baseline      skip the serial loadImageRGBA() run\n");
+	printf("  --threads=FILE     thread configuration file (see threadConfig.h)\n");
+	printf("  --thread-decode=SPEC  affinity and priority of the decode threads\n\n");
+
+	return 0;
+}
+
+
+// current time in seconds
+static double timeSeconds()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+
+// print one row of results
+static void printResult( const char* name, uint32_t images, uint32_t failed, double pixels, double seconds )
+{
+	printf("%-24s %8u %8u %10.3f %10.1f %10.1f\n", name, images, failed, seconds,
+		  images / seconds, pixels / seconds * 1e-6);
+}
+
+
+// decode the images serially with loadImageRGBA()
+static void benchBaseline( const std::vector<std::string>& filenames, uint32_t repeat )
+{
+	uint32_t images = 0;
+	uint32_t failed = 0;
+	double   pixels = 0.0;
+
+	const double begin = timeSeconds();
+
+	for( uint32_t r=0; r < repeat; r++ )
+	{
+		for( size_t n=0; n < filenames.size(); n++ )
+		{
+			float4* cpu    = NULL;
+			float4* gpu    = NULL;
+			int     width  = 0;
+			int     height = 0;
+
+			images++;
+
+			if( !loadImageRGBA(filenames[n].c_str(), &cpu, &gpu, &width, &height) )
+			{
+				failed++;
+				continue;
+			}
+
+			pixels += double(width) * double(height);
+			CUDA(cudaFreeHost(cpu));
+		}
+	}
+
+	printResult("loadImageRGBA", images, failed, pixels, timeSeconds() - begin);
+}
+
+
+// decode the images with a pool of the given size
+static void benchPool( const std::vector<std::string>& filenames, uint32_t repeat, uint32_t workers, uint32_t buffers, decodeOrder order )
+{
+	decodePool* pool = decodePool::Create(workers, buffers, order);
+
+	if( !pool )
+		return;
+
+	uint32_t images = 0;
+	uint32_t failed = 0;
+	double   pixels = 0.0;
+
+	const double begin = timeSeconds();
+
+	for( uint32_t r=0; r < repeat; r++ )
+		pool->Submit(filenames);
+
+	pool->Close();
+
+	decodedImage image;
+
+	while( pool->Next(&image) )
+	{
+		images++;
+
+		if( image.success )
+			pixels += double(image.width) * double(image.height);
+		else
+			failed++;
+
+		pool->Release(&image);
+	}
+
+	const double elapsed = timeSeconds() - begin;
+
+	char name[64];
+	snprintf(name, sizeof(name), "decodePool (%u threads)", pool->GetNumThreads());
+	printResult(name, images, failed, pixels, elapsed);
+
+	delete pool;
+}
+
+
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	const char* path = cmdLine.GetPosition(0);
+
+	if( !path )
+	{
+		printf("decode-bench:  a directory or list of images is required\n\n");
+		return usage();
+	}
+
+	if( !threadConfig::ParseArgs(argc, argv) )
+	{
+		printf("decode-bench:  invalid thread configuration\n");
+		return 0;
+	}
+
+	std::vector<std::string> filenames;
+
+	if( !decodePool::ListImages(path, filenames) )
+		return 0;
+
+	const int repeatArg  = cmdLine.GetInt("repeat", 1);
+	const int buffersArg = cmdLine.GetInt("buffers", 0);
+
+	const uint32_t repeat  = (repeatArg > 0) ? repeatArg : 1;
+	const uint32_t buffers = (buffersArg > 0) ? buffersArg : 0;
+	const decodeOrder order = cmdLine.GetFlag("unordered") ? DECODE_UNORDERED : DECODE_ORDERED;
+
+	// parse the list of worker counts
+	std::vector<uint32_t> workers;
+	const char* workerList = cmdLine.GetString("workers");
+
+	if( workerList != NULL )
+	{
+		const char* str = workerList;
+
+		while( *str != '\0' )
+		{
+			char* end = NULL;
+			const long n = strtol(str, &end, 10);
+
+			if( end == str || n <= 0 )
+			{
+				printf("decode-bench:  invalid --workers '%s'\n", workerList);
+				return 0;
+			}
+
+			workers.push_back(n);
+			str = (*end == ',') ? end + 1 : end;
+		}
+	}
+	else
+	{
+		const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+		for( long n=1; n < cores; n *= 2 )
+			workers.push_back(n);
+
+		workers.push_back((cores > 0) ? cores : 1);
+	}
+
+	printf("decode-bench:  %zu images x %u, %s completion\n\n", filenames.size(), repeat,
+		  (order == DECODE_ORDERED) ? "ordered" : "unordered");
+
+	printf("%-24s %8s %8s %10s %10s %10s\n", "decoder", "images", "failed", "seconds", "images/s", "MP/s");
+
+	if( !cmdLine.GetFlag("no-baseline") )
+		benchBaseline(filenames, repeat);
+
+	for( size_t n=0; n < workers.size(); n++ )
+		benchPool(filenames, repeat, workers[n], buffers, order);
+
+	threadConfig::Report();
+	return 0;
+}
+
@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "detectionDecoder.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <vector>
+
+
+/*
+ * CPU test of the anchor and YOLO detection decoders, against synthetic tensors
+ * whose detections are known, and of the decoder registry under concurrent use.  It only builds the decoders, which don't depend
+ * on CUDA or TensorRT, so that it can run on any machine (i.e. CI).
+ *
+ * The exit status is the number of checks that failed.
+ */
+int usage()
+{
+	printf("usage: decoder-test [-h] [--verbose]\n\n");
+	printf("Check the detections of the anchor and YOLO decoders on synthetic tensors,\n");
+	printf("and the decoder registry while decoders are registered from another thread.\n");
+	printf("The exit status is the number of checks that failed.\n\n");
+	printf("optional arguments:\n");
+	printf("  --help             show this help message and exit\n");
+	printf("  --verbose          print the checks that passed too\n\n");
+
+	return 0;
+}
+
+
+static int  numChecks = 0;
+static int  numFailed = 0;
+static bool verbose   = false;
+
+
+// check
+static void check( bool condition, const char* test, const char* description )
+{
+	numChecks++;
+
+	if( !condition )
+		numFailed++;
+
+	if( !condition || verbose )
+		printf("%s  %-8s %s\n", condition ? "[pass]" : "[FAIL]", test, description);
+}
+
+
+// near
+static bool near( float value, float expected )
+{
+	return fabsf(value - expected) <= 1e-3f * fmaxf(1.0f, fabsf(expected));
+}
+
+
+// deterministic generator, so that every run sees the same tensors
+static uint32_t randomState = 1;
+
+static inline void randomSeed( uint32_t seed )	{ randomState = seed ? seed : 1; }
+
+static inline uint32_t randomInt()
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static inline float randomFloat( float min, float max )
+{
+	return min + (max - min) * (randomInt() / 4294967296.0f);
+}
+
+
+// makeTensor
+static detectionTensor makeTensor( const std::vector<float>& data, uint32_t rows, uint32_t columns )
+{
+	detectionTensor tensor;
+
+	tensor.data    = data.empty() ? NULL : &data[0];
+	tensor.dims[0] = 1;
+	tensor.dims[1] = rows;
+	tensor.dims[2] = columns;
+
+	return tensor;
+}
+
+
+// decode
+static int decode( const char* name, const std::vector<detectionTensor>& outputs, uint32_t inputWidth, uint32_t inputHeight,
+			    uint32_t width, uint32_t height, float threshold, float overlapThreshold, std::vector<detectionResult>& detections )
+{
+	detectionDecoder* decoder = detectionDecoder::Create(name);
+
+	if( !decoder )
+		return -1;
+
+	int numDetections = -1;
+
+	if( decoder->Configure(outputs, inputWidth, inputHeight) )
+	{
+		decoder->SetOverlapThreshold(overlapThreshold);
+		detections.resize(decoder->GetMaxDetections());
+		numDetections = decoder->Decode(outputs, width, height, threshold, &detections[0]);
+	}
+
+	delete decoder;
+	return numDetections;
+}
+
+
+//-----------------------------------------------------------------------------
+// anchor scores [N,classes] (class 0 is the background) and corner boxes [N,4] in [0,1]
+static void testAnchor()
+{
+	const uint32_t anchors = 4;
+	const uint32_t classes = 21;
+
+	std::vector<float> scores(anchors * classes, 0.01f);
+	std::vector<float> boxes(anchors * 4);
+
+	// anchor 0 is class 7, anchor 1 is the background, anchor 2 is class 20 (the last
+	// score of the row, past the SIMD loop) and overlaps anchor 3 (also class 20, but
+	// with a lower score)
+	scores[0 * classes + 7]  = 0.9f;
+	scores[1 * classes + 0]  = 0.95f;
+	scores[2 * classes + 20] = 0.8f;
+	scores[3 * classes + 20] = 0.7f;
+
+	const float coords[anchors][4] = { { 0.10f, 0.20f, 0.30f, 0.40f },
+								{ 0.50f, 0.50f, 0.60f, 0.60f },
+								{ 0.60f, 0.10f, 0.90f, 0.50f },
+								{ 0.61f, 0.11f, 0.90f, 0.50f } };
+
+	memcpy(&boxes[0], coords, sizeof(coords));
+
+	std::vector<detectionTensor> outputs;
+	outputs.push_back(makeTensor(scores, anchors, classes));
+	outputs.push_back(makeTensor(boxes, anchors, 4));
+
+	std::vector<detectionResult> d;
+	const int n = decode("anchor", outputs, 300, 300, 640, 480, 0.5f, 0.45f, d);
+
+	check(n == 2, "anchor", "the background and the overlapping box are dropped");
+
+	if( n != 2 )
+		return;
+
+	check(d[0].ClassID == 7 && near(d[0].Confidence, 0.9f), "anchor", "the class with the max score is selected");
+	check(near(d[0].Left, 64.0f) && near(d[0].Top, 96.0f) && near(d[0].Right, 192.0f) && near(d[0].Bottom, 192.0f),
+		 "anchor", "the box is scaled to the image");
+	check(d[1].ClassID == 20 && near(d[1].Confidence, 0.8f) && near(d[1].Left, 384.0f), "anchor", "the box with the higher score is kept");
+	check(d[0].Instance == 0 && d[1].Instance == 1, "anchor", "the detections are renumbered");
+
+	check(decode("anchor", outputs, 300, 300, 640, 480, 0.85f, 0.45f, d) == 1 && d[0].ClassID == 7, "anchor", "the threshold is applied");
+	check(decode("anchor", outputs, 300, 300, 640, 480, 0.5f, 1.0f, d) == 3, "anchor", "boxes aren't suppressed above an overlap of 1");
+}
+
+
+//-----------------------------------------------------------------------------
+// YOLO rows of [cx, cy, w, h, objectness, class scores...] in input pixels
+static void testYOLO()
+{
+	const uint32_t rows    = 4;
+	const uint32_t classes = 80;
+	const uint32_t columns = classes + 5;
+
+	std::vector<float> data(rows * columns, 0.0f);
+
+	float* row = &data[0];
+
+	// row 0 is class 79 with confidence 0.9 * 0.8
+	row[0] = 320.0f; row[1] = 160.0f; row[2] = 64.0f; row[3] = 32.0f; row[4] = 0.9f;
+	row[5 + 79] = 0.8f;
+	row[5 + 3]  = 0.5f;
+
+	// row 1 has a high class score, but its objectness is below the threshold
+	row += columns;
+	row[0] = 100.0f; row[1] = 100.0f; row[2] = 50.0f; row[3] = 50.0f; row[4] = 0.3f;
+	row[5 + 1] = 1.0f;
+
+	// row 2 is past the top-left corner, so its box is clamped to the image
+	row += columns;
+	row[0] = 10.0f; row[1] = 10.0f; row[2] = 40.0f; row[3] = 40.0f; row[4] = 1.0f;
+	row[5 + 0] = 0.6f;
+
+	// row 3 has a high objectness, but confidence (objectness * class) below the threshold
+	row += columns;
+	row[0] = 500.0f; row[1] = 300.0f; row[2] = 20.0f; row[3] = 20.0f; row[4] = 0.9f;
+	row[5 + 2] = 0.4f;
+
+	std::vector<detectionTensor> outputs;
+	outputs.push_back(makeTensor(data, rows, columns));
+
+	std::vector<detectionResult> d;
+	const int n = decode("yolo", outputs, 640, 640, 1280, 720, 0.5f, 0.45f, d);
+
+	check(n == 2, "yolo", "rows below the objectness or the confidence are dropped");
+
+	if( n != 2 )
+		return;
+
+	check(d[0].ClassID == 79 && near(d[0].Confidence, 0.72f), "yolo", "the confidence is objectness * class score");
+	check(near(d[0].Left, 576.0f) && near(d[0].Top, 162.0f) && near(d[0].Right, 704.0f) && near(d[0].Bottom, 198.0f),
+		 "yolo", "the center box is converted to corners and scaled to the image");
+	check(d[1].ClassID == 0 && near(d[1].Confidence, 0.6f), "yolo", "the first class is found");
+	check(near(d[1].Left, 0.0f) && near(d[1].Top, 0.0f) && near(d[1].Right, 60.0f) && near(d[1].Bottom, 33.75f),
+		 "yolo", "the box is clamped to the image");
+}
+
+
+//-----------------------------------------------------------------------------
+// random YOLO rows against a scalar reference of the decoding
+static void testYOLORandom()
+{
+	const uint32_t classes[] = { 1, 3, 4, 5, 8, 13, 80 };
+	const float threshold = 0.3f;
+
+	bool matched = true;
+
+	randomSeed(80);
+
+	for( uint32_t c=0; c < sizeof(classes) / sizeof(classes[0]); c++ )
+	{
+		const uint32_t rows    = 64;
+		const uint32_t columns = classes[c] + 5;
+
+		std::vector<float> data(rows * columns);
+
+		for( size_t n=0; n < data.size(); n++ )
+			data[n] = randomFloat(0.0f, 1.0f);
+
+		data[5 * columns + 5 + classes[c] / 2] = NAN;	// a NaN score is skipped
+
+		std::vector<detectionTensor> outputs;
+		outputs.push_back(makeTensor(data, rows, columns));
+
+		std::vector<detectionResult> d;
+		const int n = decode("yolo", outputs, 640, 640, 640, 640, threshold, 2.0f, d);
+
+		// overlapping boxes aren't suppressed, so there is one detection per row above the threshold
+		std::vector<detectionResult> expected;
+
+		for( uint32_t r=0; r < rows; r++ )
+		{
+			const float* row = &data[r * columns];
+
+			uint32_t classID = 0;
+
+			for( uint32_t k=1; k < classes[c]; k++ )
+			{
+				if( row[5+k] > row[5+classID] )
+					classID = k;
+			}
+
+			if( !(row[4] * row[5+classID] >= threshold) )
+				continue;
+
+			detectionResult e;
+
+			e.ClassID    = classID;
+			e.Confidence = row[4] * row[5+classID];
+
+			expected.push_back(e);
+		}
+
+		if( n != (int)expected.size() )
+		{
+			matched = false;
+			continue;
+		}
+
+		// the detections are sorted by confidence, so match them by confidence
+		for( size_t e=0; e < expected.size(); e++ )
+		{
+			bool found = false;
+
+			for( int i=0; i < n && !found; i++ )
+				found = (d[i].Confidence == expected[e].Confidence && d[i].ClassID == expected[e].ClassID);
+
+			matched = matched && found;
+		}
+	}
+
+	check(matched, "yolo", "random rows match the scalar reference for every number of classes");
+}
+
+
+//-----------------------------------------------------------------------------
+static const int numRegistered = 500;
+
+// a registered factory that goes through the registry itself
+static detectionDecoder* createAlias()
+{
+	return detectionDecoder::Create("yolo");
+}
+
+static void* registerThread( void* arg )
+{
+	char name[32];
+
+	for( int n=0; n < numRegistered; n++ )
+	{
+		sprintf(name, "alias-%i", n);
+		detectionDecoder::Register(name, createAlias);
+	}
+
+	return NULL;
+}
+
+// registration from one thread while another creates and lists decoders
+static void testRegister()
+{
+	const size_t numBuiltin = detectionDecoder::List().size();
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, registerThread, NULL);
+
+	bool created = true;
+
+	for( int n=0; n < numRegistered; n++ )
+	{
+		detectionDecoder* decoder = detectionDecoder::Create("yolo");
+
+		if( decoder != NULL )
+			delete decoder;
+		else
+			created = false;
+
+		detectionDecoder::List();
+	}
+
+	pthread_join(thread, NULL);
+
+	check(created, "register", "built-in decoders are created while others are registered");
+	check(detectionDecoder::List().size() == numBuiltin + numRegistered, "register", "every registered decoder is listed");
+
+	detectionDecoder* decoder = detectionDecoder::Create("ALIAS-499");
+	check(decoder != NULL, "register", "a factory can create a decoder through the registry");
+	delete decoder;
+
+	detectionDecoder::Register("alias-0", createAlias);
+	check(detectionDecoder::List().size() == numBuiltin + numRegistered, "register", "registering an existing name replaces it");
+}
+
+
+int main( int argc, char** argv )
+{
+	for( int n=1; n < argc; n++ )
+	{
+		if( strcmp(argv[n], "--help") == 0 || strcmp(argv[n], "-h") == 0 )
+			return usage();
+		else if( strcmp(argv[n], "--verbose") == 0 )
+			verbose = true;
+		else
+			return usage();
+	}
+
+	testAnchor();
+	testYOLO();
+	testYOLORandom();
+	testRegister();
+
+	printf("decoder-test:  %i of %i checks passed\n", numChecks - numFailed, numChecks);
+	return numFailed;
+}
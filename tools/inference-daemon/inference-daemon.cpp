@@ -0,0 +1,798 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "detectNet.h"
+#include "imageNet.h"
+#include "inferenceProtocol.h"
+#include "inferenceMetrics.h"
+
+#include "commandLine.h"
+#include "threadConfig.h"
+#include "cudaMappedMemory.h"
+#include "Thread.h"
+#include "Mutex.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+
+#include <atomic>
+#include <deque>
+#include <vector>
+
+
+// exit handler
+bool signal_recieved = false;
+
+void sig_handler(int signo)
+{
+	if( signo == SIGINT )
+	{
+		printf("received SIGINT\n");
+		signal_recieved = true;
+	}
+}
+
+int usage()
+{
+	printf("usage: inference-daemon [-h] [--socket=PATH] [--detectnet=NETWORK] [--imagenet=NETWORK]\n");
+	printf("                        [--batch-size=N] [--engine-set=N,N,...] [--latency-target=MS] [--batch-timeout=MS]\n");
+	printf("                        [--metrics-port=PORT] [--metrics-file=PATH] [--capability-cache=PATH]\n");
+	printf("                        [--threads=FILE] [--thread-scheduler=SPEC]\n\n");
+	printf("Load networks once and serve them to other processes over a Unix socket,\n");
+	printf("with the frames and results exchanged through shared memory.\n\n");
+	printf("optional arguments:\n");
+	printf("  --help             show this help message and exit\n");
+	printf("  --socket=PATH      path of the socket to listen on (default: %s)\n", INFERENCE_DEFAULT_SOCKET);
+	printf("  --detectnet=NAME   detectNet model to serve (e.g. ped-100, coco-dog)\n");
+	printf("  --imagenet=NAME    imageNet model to serve (e.g. googlenet, alexnet)\n");
+	printf("  --batch-size=N     maximum number of requests to run through a network at once (default: 1)\n");
+	printf("  --engine-set=N,N   also build engines for these smaller batch sizes (e.g. 1,2,4), and run\n");
+	printf("                     each batch on the smallest engine that fits the requests in it\n");
+	printf("  --latency-target=MS  tune the batch size to the highest throughput with a p99 latency\n");
+	printf("                       under MS milliseconds (the measurements are cached next to the engine)\n");
+	printf("  --batch-timeout=MS   how long a partial batch waits for more requests when no latency\n");
+	printf("                       target is given (default: 0, run whatever is queued)\n");
+	printf("  --metrics-port=N   serve Prometheus metrics over HTTP on localhost:N\n");
+	printf("  --metrics-file=P   write Prometheus metrics to a file for the textfile collector\n");
+	printf("  --capability-cache=P  persist the native precisions of the device, to skip probing\n");
+	printf("                        them the next time the daemon starts\n");
+	printf("  --threads=FILE     thread configuration file (see threadConfig.h)\n");
+	printf("  --thread-scheduler=SPEC  core pinning and priority of the batcher threads that run\n");
+	printf("                           the networks, e.g. \"cores=2,3 policy=fifo priority=60\"\n\n");
+	printf("At least one of --detectnet or --imagenet should be specified.\n");
+
+	return 0;
+}
+
+
+// networks shared by all the clients (each is only used by its batcher thread)
+detectNet* detector = NULL;
+imageNet*  classifier = NULL;
+
+
+// daemon statistics
+metricGauge*   clientsConnected = inferenceMetrics::Gauge("jetson_inference_daemon_clients", "Number of clients connected to the daemon");
+metricGauge*   queueDepth       = inferenceMetrics::Gauge("jetson_inference_queue_depth", "Number of requests waiting to be processed", "source=\"daemon\"");
+metricCounter* requestsTotal    = inferenceMetrics::Counter("jetson_inference_requests_total", "Number of requests received", "source=\"daemon\"");
+metricCounter* framesDropped    = inferenceMetrics::Counter("jetson_inference_frames_dropped_total", "Number of frames that failed to be processed", "source=\"daemon\"");
+metricCounter* batchesTotal     = inferenceMetrics::Counter("jetson_inference_batches_total", "Number of batches run by the daemon", "source=\"daemon\"");
+
+
+// per-client connection state
+struct clientContext
+{
+	int      socket;
+	int      memory;
+	uint8_t* mapping;	// CPU address of the shared-memory ring
+	uint8_t* device;	// GPU address of the shared-memory ring
+	size_t   size;
+	uint32_t numSlots;
+	size_t   slotSize;
+
+	Mutex sendMutex;		// responses are sent from the batcher threads
+	std::atomic<int> pending;	// requests queued to a batcher
+};
+
+
+// send a response to the client
+static void sendResponse( clientContext* client, inferenceMessage msg, int status )
+{
+	if( status < 0 )
+		framesDropped->Increment();
+
+	msg.type       = INFERENCE_MSG_RESPONSE;
+	msg.status     = (status < 0) ? status : 0;
+	msg.numResults = (status < 0) ? 0 : status;
+
+	client->sendMutex.Lock();
+	inferenceSendMessage(client->socket, msg);
+	client->sendMutex.Unlock();
+}
+
+
+// request waiting in a batcher's queue
+struct batchRequest
+{
+	clientContext*   client;
+	inferenceMessage msg;
+	timespec         received;
+};
+
+
+/*
+ * Collects the requests for one network from all the clients, and runs them
+ * through the network in batches.  A batch is run once it reaches the flush
+ * size, or once the oldest request has waited for the flush timeout.
+ * Only requests with the same image dimensions are batched together.
+ */
+class requestBatcher
+{
+public:
+	requestBatcher( inferenceNetwork network, uint32_t batchSize, float timeoutMS );
+	~requestBatcher();
+
+	bool Start();
+	void Stop();
+	void Submit( clientContext* client, const inferenceMessage& msg );
+
+private:
+	static void* threadEntry( void* param );
+	void run();
+	void process( std::vector<batchRequest>& batch );
+
+	inferenceNetwork mNetwork;
+	uint32_t mBatchSize;
+	float    mTimeout;
+
+	pthread_t       mThread;
+	pthread_mutex_t mMutex;
+	pthread_cond_t  mCond;
+	bool            mStarted;
+	bool            mStop;
+
+	std::deque<batchRequest> mQueue;
+};
+
+
+// constructor
+requestBatcher::requestBatcher( inferenceNetwork network, uint32_t batchSize, float timeoutMS )
+{
+	mNetwork   = network;
+	mBatchSize = (batchSize > 0) ? batchSize : 1;
+	mTimeout   = (timeoutMS > 0.0f) ? timeoutMS : 0.0f;
+	mStarted   = false;
+	mStop      = false;
+
+	pthread_mutex_init(&mMutex, NULL);
+	pthread_cond_init(&mCond, NULL);
+}
+
+
+// destructor
+requestBatcher::~requestBatcher()
+{
+	Stop();
+
+	pthread_cond_destroy(&mCond);
+	pthread_mutex_destroy(&mMutex);
+}
+
+
+// Start
+bool requestBatcher::Start()
+{
+	if( pthread_create(&mThread, NULL, threadEntry, this) != 0 )
+		return false;
+
+	mStarted = true;
+	return true;
+}
+
+
+// Stop
+void requestBatcher::Stop()
+{
+	if( !mStarted )
+		return;
+
+	pthread_mutex_lock(&mMutex);
+	mStop = true;
+	pthread_cond_signal(&mCond);
+	pthread_mutex_unlock(&mMutex);
+
+	pthread_join(mThread, NULL);
+	mStarted = false;
+}
+
+
+// Submit
+void requestBatcher::Submit( clientContext* client, const inferenceMessage& msg )
+{
+	batchRequest request;
+
+	request.client   = client;
+	request.msg      = msg;
+	request.received = timestamp();
+
+	client->pending++;
+	queueDepth->Add(1);
+
+	pthread_mutex_lock(&mMutex);
+	mQueue.push_back(request);
+	pthread_cond_signal(&mCond);
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// threadEntry
+void* requestBatcher::threadEntry( void* param )
+{
+	((requestBatcher*)param)->run();
+	return NULL;
+}
+
+
+// run
+void requestBatcher::run()
+{
+	const long timeoutNS = (long)(mTimeout * 1000000.0f);
+	std::vector<batchRequest> batch;
+
+	threadConfig::ApplyStage("scheduler", (mNetwork == INFERENCE_DETECT) ? "batch-detect" : "batch-classify");
+
+	pthread_mutex_lock(&mMutex);
+
+	while( true )
+	{
+		while( mQueue.empty() && !mStop )
+			pthread_cond_wait(&mCond, &mMutex);
+
+		if( mQueue.empty() )
+			break;
+
+		// give a partial batch until the oldest request times out to fill up
+		while( mQueue.size() < mBatchSize && timeoutNS > 0 && !mStop )
+		{
+			timespec deadline = mQueue.front().received;
+
+			deadline.tv_sec  += timeoutNS / 1000000000;
+			deadline.tv_nsec += timeoutNS % 1000000000;
+
+			if( deadline.tv_nsec >= 1000000000 )
+			{
+				deadline.tv_sec  += 1;
+				deadline.tv_nsec -= 1000000000;
+			}
+
+			if( pthread_cond_timedwait(&mCond, &mMutex, &deadline) == ETIMEDOUT )
+				break;
+		}
+
+		// take the requests with the same dimensions as the oldest one
+		const uint32_t width  = mQueue.front().msg.width;
+		const uint32_t height = mQueue.front().msg.height;
+
+		batch.clear();
+
+		for( std::deque<batchRequest>::iterator iter = mQueue.begin(); iter != mQueue.end() && batch.size() < mBatchSize; )
+		{
+			if( iter->msg.width == width && iter->msg.height == height )
+			{
+				batch.push_back(*iter);
+				iter = mQueue.erase(iter);
+			}
+			else
+			{
+				iter++;
+			}
+		}
+
+		pthread_mutex_unlock(&mMutex);
+		process(batch);
+		pthread_mutex_lock(&mMutex);
+	}
+
+	pthread_mutex_unlock(&mMutex);
+}
+
+
+// process
+void requestBatcher::process( std::vector<batchRequest>& batch )
+{
+	const uint32_t batchSize = batch.size();
+	const uint32_t width  = batch[0].msg.width;
+	const uint32_t height = batch[0].msg.height;
+
+	std::vector<float*> images(batchSize);
+	std::vector<inferenceResult*> results(batchSize);
+	std::vector<int> status(batchSize, -EIO);
+
+	for( uint32_t n=0; n < batchSize; n++ )
+	{
+		clientContext* client = batch[n].client;
+		const size_t offset = client->slotSize * batch[n].msg.slot;
+
+		images[n]  = (float*)(client->device + offset + INFERENCE_IMAGE_OFFSET);
+		results[n] = (inferenceResult*)(client->mapping + offset);
+	}
+
+	batchesTotal->Increment();
+
+	if( mNetwork == INFERENCE_DETECT )
+	{
+		std::vector<detectNet::Detection*> detections(batchSize);
+		std::vector<int> numDetections(batchSize);
+
+		if( detector->DetectBatch(images.data(), width, height, batchSize, detections.data(), numDetections.data(), detectNet::OVERLAY_NONE) )
+		{
+			for( uint32_t n=0; n < batchSize; n++ )
+			{
+				if( batch[n].msg.flags & INFERENCE_FLAG_OVERLAY )
+					detector->Overlay(images[n], images[n], width, height, detections[n], numDetections[n], detectNet::OVERLAY_BOX);
+
+				int numResults = 0;
+
+				for( int i=0; i < numDetections[n] && i < INFERENCE_MAX_RESULTS; i++ )
+				{
+					results[n][i].classID    = detections[n][i].ClassID;
+					results[n][i].confidence = detections[n][i].Confidence;
+					results[n][i].left       = detections[n][i].Left;
+					results[n][i].top        = detections[n][i].Top;
+					results[n][i].right      = detections[n][i].Right;
+					results[n][i].bottom     = detections[n][i].Bottom;
+
+					numResults++;
+				}
+
+				status[n] = numResults;
+			}
+		}
+	}
+	else if( mNetwork == INFERENCE_CLASSIFY )
+	{
+		std::vector<int> classID(batchSize);
+		std::vector<float> confidence(batchSize);
+
+		if( classifier->ClassifyBatch(images.data(), width, height, batchSize, classID.data(), confidence.data()) )
+		{
+			for( uint32_t n=0; n < batchSize; n++ )
+			{
+				if( classID[n] < 0 )
+					continue;
+
+				results[n][0].classID    = classID[n];
+				results[n][0].confidence = confidence[n];
+				results[n][0].left       = 0.0f;
+				results[n][0].top        = 0.0f;
+				results[n][0].right      = width;
+				results[n][0].bottom     = height;
+
+				status[n] = 1;
+			}
+		}
+	}
+
+	queueDepth->Add(-(int)batchSize);
+
+	for( uint32_t n=0; n < batchSize; n++ )
+	{
+		sendResponse(batch[n].client, batch[n].msg, status[n]);
+		batch[n].client->pending--;
+	}
+}
+
+
+// batchers of the networks being served
+requestBatcher* detectBatcher = NULL;
+requestBatcher* classifyBatcher = NULL;
+
+
+// attach the client's shared-memory ring, mapping it into the GPU's address space
+static int attachMemory( clientContext* client, const inferenceMessage& msg, int fd )
+{
+	client->memory = fd;	// closed when the client disconnects, even if it's rejected
+
+	if( fd < 0 || msg.numSlots == 0 || msg.slotSize < inferenceSlotSize(msg.width, msg.height) )
+		return -EINVAL;
+
+	// the ring has to fit in the file, or touching the mapping past its end raises SIGBUS
+	if( msg.slotSize > SIZE_MAX / msg.numSlots )
+		return -EINVAL;
+
+	const size_t size = msg.slotSize * msg.numSlots;
+	struct stat st;
+
+	if( fstat(fd, &st) != 0 )
+		return -errno;
+
+	if( st.st_size < 0 || (uint64_t)st.st_size < size )
+		return -EINVAL;
+
+	client->numSlots = msg.numSlots;
+	client->slotSize = msg.slotSize;
+	client->size     = size;
+
+	void* mapping = mmap(NULL, client->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if( mapping == MAP_FAILED )
+		return -errno;
+
+	client->mapping = (uint8_t*)mapping;
+
+	if( CUDA_FAILED(cudaHostRegister(client->mapping, client->size, cudaHostRegisterMapped)) )
+		return -ENOMEM;
+
+	void* device = NULL;
+
+	if( CUDA_FAILED(cudaHostGetDevicePointer(&device, client->mapping, 0)) )
+		return -ENOMEM;
+
+	client->device = (uint8_t*)device;
+	return 0;
+}
+
+
+// queue a request to the batcher of its network
+static int submitRequest( clientContext* client, const inferenceMessage& msg )
+{
+	if( msg.slot >= client->numSlots || msg.width == 0 || msg.height == 0 ||
+	    inferenceSlotSize(msg.width, msg.height) > client->slotSize )
+		return -EINVAL;
+
+	requestBatcher* batcher = NULL;
+
+	if( msg.network == INFERENCE_DETECT )
+		batcher = detectBatcher;
+	else if( msg.network == INFERENCE_CLASSIFY )
+		batcher = classifyBatcher;
+	else
+		return -EINVAL;
+
+	if( !batcher )
+		return -ENOENT;
+
+	batcher->Submit(client, msg);
+	return 0;
+}
+
+
+// client thread entry
+void* clientThread( void* param )
+{
+	clientContext* client = (clientContext*)param;
+
+	inferenceMessage msg;
+	int fd = -1;
+
+	// the first message attaches the shared-memory ring
+	if( inferenceRecvMessage(client->socket, &msg, &fd) && msg.type == INFERENCE_MSG_ATTACH )
+	{
+		msg.type   = INFERENCE_MSG_ATTACH_REPLY;
+		msg.status = attachMemory(client, msg, fd);
+
+		if( msg.status == 0 )
+			printf(LOG_INFERENCE_IPC "client %i attached %u slots of %zu bytes\n", client->socket, client->numSlots, client->slotSize);
+		else
+			printf(LOG_INFERENCE_IPC "client %i failed to attach shared memory (%s)\n", client->socket, strerror(-msg.status));
+
+		if( inferenceSendMessage(client->socket, msg) && msg.status == 0 )
+		{
+			// queue requests until the client disconnects (the responses are sent by the batchers)
+			while( !signal_recieved && inferenceRecvMessage(client->socket, &msg) )
+			{
+				if( msg.type != INFERENCE_MSG_REQUEST )
+					break;
+
+				requestsTotal->Increment();
+
+				const int status = submitRequest(client, msg);
+
+				if( status < 0 )
+					sendResponse(client, msg, status);
+			}
+		}
+	}
+	else if( fd >= 0 )
+	{
+		close(fd);
+	}
+
+	// the shared memory can't be released while its requests are still queued
+	while( client->pending > 0 )
+		usleep(1000);
+
+	printf(LOG_INFERENCE_IPC "client %i disconnected\n", client->socket);
+	clientsConnected->Add(-1);
+
+	// release the client's resources
+	if( client->device != NULL )
+		CUDA(cudaHostUnregister(client->mapping));
+
+	if( client->mapping != NULL )
+		munmap(client->mapping, client->size);
+
+	if( client->memory >= 0 )
+		close(client->memory);
+
+	close(client->socket);
+	delete client;
+	return NULL;
+}
+
+
+// determine the flush size and timeout of a network's batcher
+static requestBatcher* createBatcher( tensorNet* net, inferenceNetwork network, float latencyTarget, float batchTimeout )
+{
+	uint32_t batchSize = net->GetMaxBatchSize();
+	float timeout = batchTimeout;
+
+	if( latencyTarget > 0.0f && batchSize > 1 )
+	{
+		batchSize = net->TuneBatchSize(latencyTarget);
+
+		if( batchSize == 0 )
+			batchSize = 1;
+
+		timeout = batchTuner::FlushTimeout(net->GetBatchProfiles(), batchSize, latencyTarget);
+	}
+
+	printf(LOG_INFERENCE_IPC "%s requests are batched up to %u, waiting up to %.2f ms to fill a batch\n",
+		  (network == INFERENCE_DETECT) ? "detection" : "classification", batchSize, timeout);
+
+	requestBatcher* batcher = new requestBatcher(network, batchSize, timeout);
+
+	if( !batcher->Start() )
+	{
+		printf("inference-daemon:  failed to start batcher thread\n");
+		delete batcher;
+		return NULL;
+	}
+
+	return batcher;
+}
+
+
+// main entry point
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	if( !threadConfig::ParseArgs(argc, argv) )
+	{
+		printf("inference-daemon:  invalid thread configuration\n");
+		return 0;
+	}
+
+	const char* socketPath = cmdLine.GetString("socket", INFERENCE_DEFAULT_SOCKET);
+	const char* detectName = cmdLine.GetString("detectnet");
+	const char* imageName  = cmdLine.GetString("imagenet");
+
+	if( !detectName && !imageName )
+		return usage();
+
+	const int maxBatchSize = cmdLine.GetInt("batch-size", 1);
+	const float latencyTarget = cmdLine.GetFloat("latency-target", 0.0f);
+	const float batchTimeout = cmdLine.GetFloat("batch-timeout", 0.0f);
+
+	if( maxBatchSize <= 0 )
+	{
+		printf("inference-daemon:  invalid --batch-size=%i\n", maxBatchSize);
+		return 0;
+	}
+
+	const char* engineSet = cmdLine.GetString("engine-set");
+	std::vector<uint32_t> engineBatchSizes;
+
+	if( engineSet != NULL && !batchTuner::ParseEngineSet(engineSet, engineBatchSizes) )
+	{
+		printf("inference-daemon:  invalid --engine-set=%s\n", engineSet);
+		return 0;
+	}
+
+	const int metricsPort = cmdLine.GetInt("metrics-port", -1);
+	const char* metricsFile = cmdLine.GetString("metrics-file");
+
+
+	/*
+	 * attach signal handler
+	 */
+	if( signal(SIGINT, sig_handler) == SIG_ERR )
+		printf("\ncan't catch SIGINT\n");
+
+	// clients that disconnect shouldn't terminate the daemon
+	signal(SIGPIPE, SIG_IGN);
+
+
+	/*
+	 * load networks
+	 */
+	tensorNet::SetCapabilityCache(cmdLine.GetString("capability-cache"));
+	tensorNet::SetEngineSet(engineBatchSizes);
+
+	if( detectName != NULL )
+	{
+		const detectNet::NetworkType type = detectNet::NetworkTypeFromStr(detectName);
+
+		if( type == detectNet::CUSTOM )
+		{
+			printf("inference-daemon:  invalid detectNet model '%s'\n", detectName);
+			return 0;
+		}
+
+		detector = detectNet::Create(type, DETECTNET_DEFAULT_THRESHOLD, maxBatchSize);
+
+		if( !detector )
+		{
+			printf("inference-daemon:  failed to load detectNet model '%s'\n", detectName);
+			return 0;
+		}
+	}
+
+	if( imageName != NULL )
+	{
+		const imageNet::NetworkType type = imageNet::NetworkTypeFromStr(imageName);
+
+		if( type == imageNet::CUSTOM )
+		{
+			printf("inference-daemon:  invalid imageNet model '%s'\n", imageName);
+			return 0;
+		}
+
+		classifier = imageNet::Create(type, maxBatchSize);
+
+		if( !classifier )
+		{
+			printf("inference-daemon:  failed to load imageNet model '%s'\n", imageName);
+			return 0;
+		}
+	}
+
+
+	/*
+	 * start the batchers
+	 */
+	if( detector != NULL && !(detectBatcher = createBatcher(detector, INFERENCE_DETECT, latencyTarget, batchTimeout)) )
+		return 0;
+
+	if( classifier != NULL && !(classifyBatcher = createBatcher(classifier, INFERENCE_CLASSIFY, latencyTarget, batchTimeout)) )
+		return 0;
+
+
+	/*
+	 * open the socket
+	 */
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+
+	if( strlen(socketPath) >= sizeof(addr.sun_path) )
+	{
+		printf("inference-daemon:  socket path is too long (%s)\n", socketPath);
+		return 0;
+	}
+
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socketPath);
+	unlink(socketPath);
+
+	const int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	if( listener < 0 || bind(listener, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 16) != 0 )
+	{
+		printf("inference-daemon:  failed to listen on %s (%s)\n", socketPath, strerror(errno));
+		return 0;
+	}
+
+	printf(LOG_INFERENCE_IPC "inference-daemon listening on %s\n", socketPath);
+
+
+	/*
+	 * export metrics
+	 */
+	if( metricsPort >= 0 && !inferenceMetrics::StartServer(metricsPort) )
+		printf("inference-daemon:  failed to start metrics server on port %i\n", metricsPort);
+
+	if( metricsFile != NULL && !inferenceMetrics::StartTextfile(metricsFile) )
+		printf("inference-daemon:  failed to start writing metrics to %s\n", metricsFile);
+
+
+	/*
+	 * accept clients until SIGINT
+	 */
+	while( !signal_recieved )
+	{
+		struct pollfd pfd;
+
+		pfd.fd      = listener;
+		pfd.events  = POLLIN;
+		pfd.revents = 0;
+
+		if( poll(&pfd, 1, 250) <= 0 )
+			continue;
+
+		const int sock = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+
+		if( sock < 0 )
+			continue;
+
+		clientContext* client = new clientContext();
+
+		client->socket   = sock;
+		client->memory   = -1;
+		client->mapping  = NULL;
+		client->device   = NULL;
+		client->size     = 0;
+		client->numSlots = 0;
+		client->slotSize = 0;
+		client->pending  = 0;
+
+		Thread* thread = new Thread();
+		clientsConnected->Add(1);
+
+		if( !thread->StartThread(clientThread, client) )
+		{
+			printf("inference-daemon:  failed to start thread for client %i\n", sock);
+			clientsConnected->Add(-1);
+			close(sock);
+			delete client;
+			delete thread;
+			continue;
+		}
+
+		printf(LOG_INFERENCE_IPC "client %i connected\n", sock);
+	}
+
+
+	/*
+	 * shutdown
+	 */
+	printf("inference-daemon:  shutting down...\n");
+	threadConfig::Report();
+
+	close(listener);
+	unlink(socketPath);
+
+	inferenceMetrics::Stop();
+
+	SAFE_DELETE(detectBatcher);
+	SAFE_DELETE(classifyBatcher);
+
+	SAFE_DELETE(detector);
+	SAFE_DELETE(classifier);
+
+	printf("inference-daemon:  shutdown complete.\n");
+	return 0;
+}
+
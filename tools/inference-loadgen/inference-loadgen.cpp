@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "inferenceClient.h"
+#include "profilerHistogram.h"
+
+#include "commandLine.h"
+#include "timespec.h"
+#include "Thread.h"
+
+#include <signal.h>
+#include <unistd.h>
+#include <string.h>
+
+#include <atomic>
+#include <vector>
+
+
+// exit handler
+bool signal_recieved = false;
+
+void sig_handler(int signo)
+{
+	if( signo == SIGINT )
+	{
+		printf("received SIGINT\n");
+		signal_recieved = true;
+	}
+}
+
+int usage()
+{
+	printf("usage: inference-loadgen [-h] [--socket=PATH] [--network=detect|classify]\n");
+	printf("                         [--clients=N] [--depth=N] [--width=N] [--height=N]\n");
+	printf("                         [--seconds=N] [--overlay]\n\n");
+	printf("Generate load against inference-daemon from several local clients,\n");
+	printf("and report the throughput and request latency.\n\n");
+	printf("optional arguments:\n");
+	printf("  --help             show this help message and exit\n");
+	printf("  --socket=PATH      path of the daemon's socket (default: %s)\n", INFERENCE_DEFAULT_SOCKET);
+	printf("  --network=NAME     network to run, 'detect' or 'classify' (default: detect)\n");
+	printf("  --clients=N        number of client connections, one thread each (default: 4)\n");
+	printf("  --depth=N          number of requests each client keeps in flight (default: 2)\n");
+	printf("  --width=N          width of the frames (default: 1280)\n");
+	printf("  --height=N         height of the frames (default: 720)\n");
+	printf("  --seconds=N        duration of the run (default: 10)\n");
+	printf("  --overlay          request the detection overlay to be rendered\n\n");
+
+	return 0;
+}
+
+
+// options shared by the client threads
+const char*      socketPath = INFERENCE_DEFAULT_SOCKET;
+inferenceNetwork network    = INFERENCE_DETECT;
+uint32_t         depth      = 2;
+uint32_t         width      = 1280;
+uint32_t         height     = 720;
+uint32_t         flags      = 0;
+
+profilerHistogram   latency;
+std::atomic<uint64_t> failures(0);
+
+
+// fill a slot with a synthetic gradient frame
+static void fillFrame( float* image, uint32_t width, uint32_t height, uint32_t seed )
+{
+	for( uint32_t y=0; y < height; y++ )
+	{
+		for( uint32_t x=0; x < width; x++ )
+		{
+			float* px = image + (y * width + x) * 4;
+
+			px[0] = (x + seed) % 256;
+			px[1] = (y + seed) % 256;
+			px[2] = (x + y) % 256;
+			px[3] = 255.0f;
+		}
+	}
+}
+
+
+// client thread entry
+void* clientThread( void* param )
+{
+	inferenceClient* client = (inferenceClient*)param;
+
+	std::vector<timespec> submitted(depth);
+
+	for( uint32_t n=0; n < depth; n++ )
+		fillFrame(client->GetImage(n), width, height, n * 64);
+
+	// prime the pipeline with one request per slot
+	for( uint32_t n=0; n < depth; n++ )
+	{
+		timestamp(&submitted[n]);
+
+		if( !client->Submit(n, network, width, height, flags) )
+			return NULL;
+	}
+
+	// resubmit each slot as soon as its response arrives
+	while( client->GetPending() > 0 )
+	{
+		uint32_t slot = 0;
+		const int numResults = client->Receive(&slot);
+
+		const timespec now = timestamp();
+
+		if( numResults < 0 )
+		{
+			failures++;
+
+			if( slot >= depth )
+				break;
+		}
+
+		latency.Add(timeFloat(timeDiff(submitted[slot], now)));
+
+		if( signal_recieved )
+			continue;
+
+		submitted[slot] = now;
+
+		if( !client->Submit(slot, network, width, height, flags) )
+			break;
+	}
+
+	return NULL;
+}
+
+
+// main entry point
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	socketPath = cmdLine.GetString("socket", INFERENCE_DEFAULT_SOCKET);
+	depth      = cmdLine.GetInt("depth", 2);
+	width      = cmdLine.GetInt("width", 1280);
+	height     = cmdLine.GetInt("height", 720);
+
+	const uint32_t numClients = cmdLine.GetInt("clients", 4);
+	const uint32_t seconds    = cmdLine.GetInt("seconds", 10);
+	const char*    netName    = cmdLine.GetString("network", "detect");
+
+	if( strcasecmp(netName, "detect") == 0 )
+		network = INFERENCE_DETECT;
+	else if( strcasecmp(netName, "classify") == 0 )
+		network = INFERENCE_CLASSIFY;
+	else
+		return usage();
+
+	if( cmdLine.GetFlag("overlay") )
+		flags |= INFERENCE_FLAG_OVERLAY;
+
+	if( numClients == 0 || depth == 0 || width == 0 || height == 0 )
+		return usage();
+
+
+	/*
+	 * attach signal handler
+	 */
+	if( signal(SIGINT, sig_handler) == SIG_ERR )
+		printf("\ncan't catch SIGINT\n");
+
+
+	/*
+	 * connect the clients
+	 */
+	std::vector<inferenceClient*> clients;
+
+	for( uint32_t n=0; n < numClients; n++ )
+	{
+		inferenceClient* client = inferenceClient::Create(width, height, depth, socketPath);
+
+		if( !client )
+		{
+			printf("inference-loadgen:  failed to connect client %u to %s\n", n, socketPath);
+			return 0;
+		}
+
+		clients.push_back(client);
+	}
+
+
+	/*
+	 * spin up threads
+	 */
+	printf("\ninference-loadgen:  %u clients x %u requests in flight, %ux%u %s, for %u seconds\n\n",
+		  numClients, depth, width, height, netName, seconds);
+
+	std::vector<Thread*> threads;
+	const timespec begin = timestamp();
+
+	for( uint32_t n=0; n < numClients; n++ )
+	{
+		Thread* thread = new Thread();
+
+		if( !thread->StartThread(clientThread, clients[n]) )
+		{
+			printf("inference-loadgen:  failed to start thread for client %u\n", n);
+			delete thread;
+			continue;
+		}
+
+		threads.push_back(thread);
+	}
+
+	for( uint32_t n=0; n < seconds * 10 && !signal_recieved; n++ )
+		usleep(100 * 1000);
+
+	signal_recieved = true;
+
+	for( size_t n=0; n < threads.size(); n++ )
+		pthread_join(*threads[n]->GetThreadID(), NULL);
+
+	const float elapsed = timeFloat(timeDiff(begin, timestamp())) * 0.001f;
+
+
+	/*
+	 * print the report
+	 */
+	const uint64_t requests = latency.GetCount();
+
+	printf("inference-loadgen:  %lu requests in %.2f seconds (%lu failed)\n", (unsigned long)requests, elapsed, (unsigned long)failures.load());
+	printf("   -- throughput  %.2f frames/sec\n", requests / elapsed);
+	printf("   -- latency     mean %.3f ms, p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n\n",
+		  latency.GetMean(), latency.GetPercentile(0.5f), latency.GetPercentile(0.9f),
+		  latency.GetPercentile(0.99f), latency.GetMax());
+
+	for( size_t n=0; n < clients.size(); n++ )
+		delete clients[n];
+
+	for( size_t n=0; n < threads.size(); n++ )
+		delete threads[n];
+
+	return 0;
+}
+
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "threadConfig.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+
+/*
+ * Latency-jitter benchmark of a periodic thread, like the one feeding the
+ * network from the camera.  The thread wakes up on a fixed period and spins
+ * for a fixed amount of work, while optional load threads compete for the
+ * cores and write log lines.  The wakeup latency and the time the work takes
+ * show the effect of the thread configuration (@see threadConfig), and the
+ * benchmark runs on any Linux machine.
+ */
+int usage()
+{
+	printf("usage: jitter-bench [-h] [--period=US] [--work=US] [--seconds=N] [--load=N]\n");
+	printf("                    [--threads=FILE] [--thread-bench=SPEC] [--thread-load=SPEC]\n\n");
+	printf("Measure the wakeup latency and runtime jitter of a periodic thread,\n");
+	printf("with the scheduling settings of the 'bench' and 'load' thread stages.\n\n");
+	printf("optional arguments:\n");
+	printf("  --help             show this help message and exit\n");
+	printf("  --period=US        period of the thread in microseconds (default: 1000)\n");
+	printf("  --work=US          work done each period in microseconds (default: 200)\n");
+	printf("  --seconds=N        duration of the run (default: 10)\n");
+	printf("  --load=N           number of load threads that spin and log (default: 0)\n");
+	printf("  --threads=FILE     config file with the settings of each thread stage\n");
+	printf("  --thread-STAGE=SPEC  settings of a stage, i.e. \"cores=3 policy=fifo priority=80\"\n\n");
+
+	return 0;
+}
+
+
+bool signal_recieved = false;
+
+void sig_handler(int signo)
+{
+	if( signo == SIGINT )
+	{
+		printf("received SIGINT\n");
+		signal_recieved = true;
+	}
+}
+
+
+// options
+uint32_t periodUS  = 1000;
+uint32_t workUS    = 200;
+uint32_t seconds   = 10;
+uint32_t numLoad   = 0;
+
+std::atomic<bool> stopLoad(false);
+
+
+// current time in nanoseconds
+static inline uint64_t timeNS()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+// spin for the given time
+static inline void spin( uint64_t ns )
+{
+	const uint64_t end = timeNS() + ns;
+
+	while( timeNS() < end )
+		;
+}
+
+
+// load thread, which spins and logs in bursts
+void* loadThread( void* param )
+{
+	char name[16];
+	sprintf(name, "load-%u", (uint32_t)(size_t)param);
+
+	threadConfig::ApplyStage("load", name);
+
+	FILE* log = fopen("/dev/null", "w");
+	uint64_t lines = 0;
+
+	while( !stopLoad )
+	{
+		spin(2000000);	// 2ms
+
+		for( int n=0; n < 64 && log != NULL; n++ )
+			fprintf(log, "load thread %s -- log line %lu\n", name, (unsigned long)lines++);
+
+		if( log != NULL )
+			fflush(log);
+
+		usleep(500);
+	}
+
+	if( log != NULL )
+		fclose(log);
+
+	return NULL;
+}
+
+
+// results of the periodic thread
+struct benchResults
+{
+	std::vector<float> wakeup;	// microseconds after the deadline that the thread woke up
+	std::vector<float> work;	// microseconds that the work took
+	uint64_t missed;			// periods where the work finished after the next deadline
+	uint64_t migrations;		// number of times the thread changed cores
+};
+
+
+// periodic thread
+void* benchThread( void* param )
+{
+	benchResults* results = (benchResults*)param;
+
+	threadConfig::ApplyStage("bench", "jitter-bench");
+
+	const uint64_t period = (uint64_t)periodUS * 1000;
+	const uint64_t work   = (uint64_t)workUS * 1000;
+	const uint64_t count  = (uint64_t)seconds * 1000000 / periodUS;
+
+	results->wakeup.reserve(count);
+	results->work.reserve(count);
+	results->missed     = 0;
+	results->migrations = 0;
+
+	int core = sched_getcpu();
+
+	struct timespec next;
+	clock_gettime(CLOCK_MONOTONIC, &next);
+
+	uint64_t deadline = (uint64_t)next.tv_sec * 1000000000ULL + next.tv_nsec;
+
+	for( uint64_t n=0; n < count && !signal_recieved; n++ )
+	{
+		deadline += period;
+
+		next.tv_sec  = deadline / 1000000000ULL;
+		next.tv_nsec = deadline % 1000000000ULL;
+
+		while( clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) != 0 && !signal_recieved )
+			;
+
+		const uint64_t wake = timeNS();
+		spin(work);
+		const uint64_t done = timeNS();
+
+		results->wakeup.push_back((wake - deadline) * 0.001f);
+		results->work.push_back((done - wake) * 0.001f);
+
+		if( done > deadline + period )
+			results->missed++;
+
+		const int c = sched_getcpu();
+
+		if( c != core )
+		{
+			results->migrations++;
+			core = c;
+		}
+	}
+
+	return NULL;
+}
+
+
+// print the distribution of the samples (in microseconds)
+static void printStats( const char* name, std::vector<float>& samples )
+{
+	if( samples.size() == 0 )
+		return;
+
+	std::sort(samples.begin(), samples.end());
+
+	double sum = 0.0;
+
+	for( size_t n=0; n < samples.size(); n++ )
+		sum += samples[n];
+
+	#define PERCENTILE(p) samples[std::min(samples.size() - 1, (size_t)(samples.size() * p))]
+
+	printf("   -- %-8s mean %8.1f us  p50 %8.1f us  p99 %8.1f us  p99.9 %8.1f us  max %8.1f us\n", name,
+		  sum / samples.size(), PERCENTILE(0.5), PERCENTILE(0.99), PERCENTILE(0.999), samples.back());
+}
+
+
+// main entry point
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	for( int n=1; n < argc; n++ )
+	{
+		const char* arg = argv[n];
+
+		if( strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0 )
+			return usage();
+		else if( strncmp(arg, "--period=", 9) == 0 )
+			periodUS = atoi(arg + 9);
+		else if( strncmp(arg, "--work=", 7) == 0 )
+			workUS = atoi(arg + 7);
+		else if( strncmp(arg, "--seconds=", 10) == 0 )
+			seconds = atoi(arg + 10);
+		else if( strncmp(arg, "--load=", 7) == 0 )
+			numLoad = atoi(arg + 7);
+		else if( strncmp(arg, "--thread", 8) != 0 )
+			return usage();
+	}
+
+	if( periodUS == 0 || seconds == 0 || workUS >= periodUS )
+		return usage();
+
+	if( !threadConfig::ParseArgs(argc, argv) )
+		return 0;
+
+	if( signal(SIGINT, sig_handler) == SIG_ERR )
+		printf("\ncan't catch SIGINT\n");
+
+
+	/*
+	 * run the load and periodic threads
+	 */
+	printf("\njitter-bench:  period %u us, work %u us, %u load threads, for %u seconds\n\n", periodUS, workUS, numLoad, seconds);
+
+	std::vector<pthread_t> load(numLoad);
+
+	for( uint32_t n=0; n < numLoad; n++ )
+	{
+		if( pthread_create(&load[n], NULL, loadThread, (void*)(size_t)n) != 0 )
+		{
+			printf("jitter-bench:  failed to start load thread %u\n", n);
+			return 0;
+		}
+	}
+
+	benchResults results;
+	pthread_t thread;
+
+	if( pthread_create(&thread, NULL, benchThread, &results) != 0 )
+	{
+		printf("jitter-bench:  failed to start the periodic thread\n");
+		return 0;
+	}
+
+	pthread_join(thread, NULL);
+
+	stopLoad = true;
+
+	for( uint32_t n=0; n < numLoad; n++ )
+		pthread_join(load[n], NULL);
+
+
+	/*
+	 * print the report
+	 */
+	printf("\n");
+	threadConfig::Report();
+
+	printf("jitter-bench:  %zu periods, %lu missed deadlines, %lu core migrations\n",
+		  results.wakeup.size(), (unsigned long)results.missed, (unsigned long)results.migrations);
+
+	printStats("wakeup", results.wakeup);
+	printStats("work", results.work);
+	printf("\n");
+
+	return 0;
+}
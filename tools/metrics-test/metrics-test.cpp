@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "inferenceMetrics.h"
+#include "profilerHistogram.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+
+/*
+ * Scrape test of the metrics exporter:  it starts the HTTP server on a free
+ * port (or the one given), requests /metrics from 127.0.0.1 like Prometheus
+ * would, and checks the response and the exposition text of a counter, a
+ * labeled gauge and a histogram.  It doesn't depend on CUDA or TensorRT.
+ *
+ * The exit status is the number of checks that failed.
+ */
+int usage()
+{
+	printf("usage: metrics-test [-h] [--port=N] [--verbose]\n\n");
+	printf("Start the metrics HTTP server, scrape it from 127.0.0.1, and check the\n");
+	printf("exposition text.  The exit status is the number of checks that failed.\n\n");
+	printf("optional arguments:\n");
+	printf("  --help             show this help message and exit\n");
+	printf("  --port=N           port to serve the metrics on (default: 0, any free port)\n");
+	printf("  --verbose          print the response and the checks that passed too\n\n");
+
+	return 0;
+}
+
+
+static int  numChecks = 0;
+static int  numFailed = 0;
+static bool verbose   = false;
+
+
+// check
+static void check( bool condition, const char* description )
+{
+	numChecks++;
+
+	if( !condition )
+		numFailed++;
+
+	if( !condition || verbose )
+		printf("%s  %s\n", condition ? "[pass]" : "[FAIL]", description);
+}
+
+
+// contains
+static bool contains( const std::string& text, const char* line )
+{
+	return text.find(line) != std::string::npos;
+}
+
+
+// send a request to the server and read the response, until the server closes the connection
+static bool request( uint16_t port, const char* method, std::string& response )
+{
+	response.clear();
+
+	const int sock = socket(AF_INET, SOCK_STREAM, 0);
+
+	if( sock < 0 )
+		return false;
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+
+	addr.sin_family = AF_INET;
+	addr.sin_port   = htons(port);
+
+	inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+	// don't hang if the server stops responding
+	struct timeval timeout;
+
+	timeout.tv_sec  = 5;
+	timeout.tv_usec = 0;
+
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	if( connect(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0 )
+	{
+		close(sock);
+		return false;
+	}
+
+	char header[256];
+	snprintf(header, sizeof(header), "%s /metrics HTTP/1.0\r\nHost: 127.0.0.1:%u\r\n\r\n", method, port);
+
+	if( send(sock, header, strlen(header), MSG_NOSIGNAL) != (ssize_t)strlen(header) )
+	{
+		close(sock);
+		return false;
+	}
+
+	char buffer[4096];
+
+	while( true )
+	{
+		const ssize_t bytes = recv(sock, buffer, sizeof(buffer), 0);
+
+		if( bytes < 0 )
+		{
+			close(sock);
+			return false;
+		}
+
+		if( bytes == 0 )
+			break;
+
+		response.append(buffer, bytes);
+	}
+
+	close(sock);
+	return true;
+}
+
+
+// collector that exports a histogram at scrape time, like tensorNet does
+static void collectHistogram( std::string& output, void* user )
+{
+	inferenceMetrics::FormatHeader(output, "metrics_test_latency_seconds", "Latency of the test runs", "histogram");
+	inferenceMetrics::FormatHistogram(output, "metrics_test_latency_seconds", "stage=\"test\"", *(const profilerHistogram*)user);
+}
+
+
+int main( int argc, char** argv )
+{
+	uint16_t port = 0;
+
+	for( int n=1; n < argc; n++ )
+	{
+		if( strcmp(argv[n], "--help") == 0 || strcmp(argv[n], "-h") == 0 )
+			return usage();
+		else if( strncmp(argv[n], "--port=", 7) == 0 )
+			port = atoi(argv[n] + 7);
+		else if( strcmp(argv[n], "--verbose") == 0 )
+			verbose = true;
+		else
+			return usage();
+	}
+
+
+	/*
+	 * register the metrics
+	 */
+	metricCounter* counter = inferenceMetrics::Counter("metrics_test_requests_total", "Requests of the test");
+	metricGauge*   gauge   = inferenceMetrics::Gauge("metrics_test_queue_depth", "Queue depth of the test", "queue=\"input\"");
+
+	counter->Increment(3);
+	gauge->Set(-2);
+
+	profilerHistogram histogram;
+
+	for( uint32_t n=0; n < 10; n++ )
+		histogram.Add(2.0f);	// milliseconds
+
+	inferenceMetrics::AddCollector(collectHistogram, &histogram);
+
+
+	/*
+	 * start the server and scrape it
+	 */
+	const bool started = inferenceMetrics::StartServer(port);
+
+	check(started, "the server starts");
+
+	if( !started )
+		return numFailed;
+
+	const uint16_t serverPort = inferenceMetrics::GetServerPort();
+
+	check(serverPort != 0 && (port == 0 || serverPort == port), "the server reports the port it listens on");
+
+	std::string response;
+
+	check(request(serverPort, "GET", response), "GET /metrics is answered");
+
+	if( verbose )
+		printf("\n%s\n", response.c_str());
+
+	const size_t headerEnd = response.find("\r\n\r\n");
+	const std::string body = (headerEnd != std::string::npos) ? response.substr(headerEnd + 4) : std::string();
+
+	char contentLength[64];
+	snprintf(contentLength, sizeof(contentLength), "Content-Length: %zu\r\n", body.size());
+
+	check(response.compare(0, 17, "HTTP/1.0 200 OK\r\n") == 0, "the status is 200");
+	check(contains(response, "Content-Type: text/plain; version=0.0.4"), "the content type is the text exposition format");
+	check(headerEnd != std::string::npos && contains(response.substr(0, headerEnd + 4), contentLength), "the content length matches the body");
+
+	check(contains(body, "# HELP metrics_test_requests_total Requests of the test\n"), "the counter has a HELP line");
+	check(contains(body, "# TYPE metrics_test_requests_total counter\n"), "the counter has a TYPE line");
+	check(contains(body, "\nmetrics_test_requests_total 3\n"), "the counter has its value");
+
+	check(contains(body, "# TYPE metrics_test_queue_depth gauge\n"), "the gauge has a TYPE line");
+	check(contains(body, "\nmetrics_test_queue_depth{queue=\"input\"} -2\n"), "the gauge has its labels and value");
+
+	check(contains(body, "# TYPE metrics_test_latency_seconds histogram\n"), "the histogram has a TYPE line");
+	check(contains(body, "\nmetrics_test_latency_seconds_bucket{stage=\"test\",le=\"+Inf\"} 10\n"), "the histogram has the +Inf bucket");
+	check(contains(body, "\nmetrics_test_latency_seconds_count{stage=\"test\"} 10\n"), "the histogram has its count");
+	check(contains(body, "\nmetrics_test_latency_seconds_sum{stage=\"test\"} 0.02"), "the histogram has its sum (in seconds)");
+
+	// values are read at scrape time
+	counter->Increment();
+
+	check(request(serverPort, "GET", response) && contains(response, "\nmetrics_test_requests_total 4\n"), "a second scrape sees the new value");
+	check(request(serverPort, "POST", response) && response.compare(0, 13, "HTTP/1.0 405 ") == 0, "methods other than GET are refused");
+
+
+	/*
+	 * the server can be stopped and started again
+	 */
+	inferenceMetrics::Stop();
+
+	check(!request(serverPort, "GET", response), "the server stops listening");
+	check(inferenceMetrics::StartServer(port) && request(inferenceMetrics::GetServerPort(), "GET", response) &&
+		 contains(response, "\nmetrics_test_requests_total 4\n"), "the server restarts");
+
+	inferenceMetrics::Stop();
+	inferenceMetrics::RemoveCollector(collectHistogram, &histogram);
+
+	printf("metrics-test:  %i of %i checks passed\n", numChecks - numFailed, numChecks);
+	return numFailed;
+}
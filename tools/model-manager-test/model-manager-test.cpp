@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "modelManager.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+/*
+ * Test of the model manager's scheduling and eviction policy, with a fake
+ * backend whose networks are only tokens of a given size, so that it runs
+ * without a GPU (i.e. in CI).
+ *
+ * The exit status is the number of checks that failed.
+ */
+int usage()
+{
+	printf("usage: model-manager-test [-h] [--verbose]\n\n");
+	printf("Check the LRU eviction, reference counting and statistics of the model\n");
+	printf("manager with a fake backend.  The exit status is the number of checks that failed.\n\n");
+	printf("optional arguments:\n");
+	printf("  --help             show this help message and exit\n");
+	printf("  --verbose          print the checks that passed too\n\n");
+
+	return 0;
+}
+
+
+static int  numChecks = 0;
+static int  numFailed = 0;
+static bool verbose   = false;
+
+
+// check
+static void check( bool condition, const char* test, const char* description )
+{
+	numChecks++;
+
+	if( !condition )
+		numFailed++;
+
+	if( !condition || verbose )
+		printf("%s  %-11s %s\n", condition ? "[pass]" : "[FAIL]", test, description);
+}
+
+
+/*
+ * Log of the loads and unloads of a backend, in order.  It's owned by the test,
+ * as the manager deletes the backend.
+ */
+class fakeLog
+{
+public:
+	fakeLog()		{ pthread_mutex_init(&mMutex, NULL); }
+	~fakeLog()	{ pthread_mutex_destroy(&mMutex); }
+
+	void Add( const char* event, const char* name )
+	{
+		pthread_mutex_lock(&mMutex);
+		mEvents.push_back(std::string(event) + " " + name);
+		pthread_mutex_unlock(&mMutex);
+	}
+
+	// the events since the last call, separated by commas
+	std::string Events()
+	{
+		std::string events;
+
+		pthread_mutex_lock(&mMutex);
+
+		for( size_t n=0; n < mEvents.size(); n++ )
+			events += (n > 0 ? ", " : "") + mEvents[n];
+
+		mEvents.clear();
+		pthread_mutex_unlock(&mMutex);
+
+		return events;
+	}
+
+private:
+	std::vector<std::string> mEvents;
+	pthread_mutex_t mMutex;
+};
+
+
+/*
+ * Backend whose networks are tokens with a fixed size per name.
+ * Names that have no size fail to load.
+ */
+class fakeBackend : public modelBackend
+{
+public:
+	fakeBackend( fakeLog* log, useconds_t loadDelay=0 ) : mLog(log), mLoadDelay(loadDelay)	{ }
+
+	void SetSize( const char* name, size_t size )	{ mSizes[name] = size; }
+
+	virtual tensorNet* Load( const char* name )
+	{
+		if( mLoadDelay > 0 )
+			usleep(mLoadDelay);
+
+		if( mSizes.find(name) == mSizes.end() )
+			return NULL;
+
+		mLog->Add("load", name);
+		return (tensorNet*)new size_t(mSizes[name]);	// never dereferenced by the manager
+	}
+
+	virtual void Unload( const char* name, tensorNet* network )
+	{
+		mLog->Add("unload", name);
+		delete (size_t*)network;
+	}
+
+	virtual size_t GetMemoryUsage( tensorNet* network )
+	{
+		return *(size_t*)network;
+	}
+
+private:
+	fakeLog*   mLog;
+	useconds_t mLoadDelay;
+	std::map<std::string, size_t> mSizes;
+};
+
+
+// use
+static tensorNet* use( modelManager* manager, const char* name )
+{
+	tensorNet* network = manager->Acquire(name);
+
+	if( network != NULL )
+		manager->Release(name);
+
+	return network;
+}
+
+
+//-----------------------------------------------------------------------------
+// the least-recently used idle model is evicted first
+static void testLRU()
+{
+	fakeLog log;
+	fakeBackend* backend = new fakeBackend(&log);
+
+	backend->SetSize("a", 100);
+	backend->SetSize("b", 100);
+	backend->SetSize("c", 100);
+
+	modelManager* manager = modelManager::Create(250, backend);
+
+	use(manager, "a");
+	use(manager, "b");
+	use(manager, "a");	// b is now the least recently used
+
+	check(log.Events() == "load a, load b", "lru", "models are loaded on first use only");
+
+	use(manager, "c");
+
+	check(log.Events() == "load c, unload b", "lru", "the least-recently used model is evicted");
+	check(manager->IsLoaded("a") && !manager->IsLoaded("b") && manager->IsLoaded("c"), "lru", "the recently used models stay loaded");
+	check(manager->GetMemoryUsage() == 200, "lru", "the memory in use is under the budget");
+
+	// b has been loaded before, so its size is reserved and the eviction happens ahead of the load
+	use(manager, "b");
+
+	check(log.Events() == "unload a, load b", "lru", "a model that was loaded before evicts ahead of loading");
+
+	manager->SetMemoryBudget(100);
+
+	check(log.Events() == "unload c" && manager->GetMemoryUsage() == 100, "lru", "lowering the budget evicts idle models");
+
+	delete manager;
+
+	check(log.Events() == "unload b", "lru", "the remaining models are unloaded with the manager");
+}
+
+
+//-----------------------------------------------------------------------------
+// acquired models are never evicted, and the budget is restored once they're released
+static void testAcquired()
+{
+	fakeLog log;
+	fakeBackend* backend = new fakeBackend(&log);
+
+	backend->SetSize("a", 100);
+	backend->SetSize("b", 100);
+	backend->SetSize("c", 100);
+
+	modelManager* manager = modelManager::Create(250, backend);
+
+	tensorNet* a = manager->Acquire("a");
+	tensorNet* b = manager->Acquire("b");
+	tensorNet* c = manager->Acquire("c");
+
+	check(a != NULL && b != NULL && c != NULL, "acquired", "the models are loaded");
+	check(log.Events() == "load a, load b, load c", "acquired", "acquired models aren't evicted to make room");
+	check(manager->GetMemoryUsage() == 300, "acquired", "the budget is exceeded while every model is acquired");
+	check(!manager->Evict("a"), "acquired", "Evict() refuses an acquired model");
+
+	manager->Release("c");
+
+	check(!manager->IsLoaded("c") && manager->GetMemoryUsage() == 200, "acquired", "a release trims back under the budget");
+
+	manager->Release("a");
+	manager->Release("b");
+
+	check(log.Events() == "unload c" && manager->GetMemoryUsage() == 200, "acquired", "the other releases don't evict under the budget");
+
+	// a model acquired twice stays acquired until it's released twice
+	manager->Acquire("a");
+	manager->Acquire("a");
+	manager->Release("a");
+
+	check(!manager->Evict("a"), "acquired", "a model is acquired until every Acquire() is released");
+
+	manager->Release("a");
+
+	check(manager->Evict("a") && !manager->IsLoaded("a") && manager->GetMemoryUsage() == 100, "acquired", "Evict() unloads an idle model");
+
+	delete manager;
+}
+
+
+//-----------------------------------------------------------------------------
+// concurrent Acquire() of the same model loads it once
+struct acquireThreadArgs
+{
+	modelManager* manager;
+	tensorNet*    network;
+};
+
+static void* acquireThread( void* param )
+{
+	acquireThreadArgs* args = (acquireThreadArgs*)param;
+	args->network = args->manager->Acquire("x");
+	return NULL;
+}
+
+static void testConcurrent()
+{
+	const int numThreads = 8;
+
+	fakeLog log;
+	fakeBackend* backend = new fakeBackend(&log, 50 * 1000);	// the load takes 50ms, so the threads overlap
+	backend->SetSize("x", 100);
+
+	modelManager* manager = modelManager::Create(0, backend);
+
+	pthread_t threads[numThreads];
+	acquireThreadArgs args[numThreads];
+
+	for( int n=0; n < numThreads; n++ )
+	{
+		args[n].manager = manager;
+		args[n].network = NULL;
+
+		pthread_create(&threads[n], NULL, acquireThread, &args[n]);
+	}
+
+	bool same = true;
+
+	for( int n=0; n < numThreads; n++ )
+	{
+		pthread_join(threads[n], NULL);
+		same = same && (args[n].network != NULL && args[n].network == args[0].network);
+	}
+
+	modelStats stats;
+	memset(&stats, 0, sizeof(stats));
+
+	check(same, "concurrent", "every thread gets the same network");
+	check(manager->GetStats("x", &stats) && stats.loads == 1 && stats.hits == numThreads - 1, "concurrent", "the model is loaded once, and the other threads hit it");
+	check(log.Events() == "load x", "concurrent", "the backend loads the model once");
+
+	for( int n=0; n < numThreads; n++ )
+		manager->Release("x");
+
+	check(manager->Evict("x"), "concurrent", "the model is idle after every thread released it");
+
+	delete manager;
+}
+
+
+//-----------------------------------------------------------------------------
+// the hit, load, eviction and failure counts
+static void testStats()
+{
+	fakeLog log;
+	fakeBackend* backend = new fakeBackend(&log);
+
+	backend->SetSize("a", 100);
+	backend->SetSize("b", 150);
+
+	modelManager* manager = modelManager::Create(200, backend);
+
+	use(manager, "a");
+	use(manager, "a");
+	use(manager, "a");
+	use(manager, "b");	// evicts a
+	use(manager, "a");	// evicts b
+
+	check(use(manager, "missing") == NULL, "stats", "a model that fails to load returns NULL");
+
+	modelStats a, b, missing;
+
+	memset(&a, 0, sizeof(a));
+	memset(&b, 0, sizeof(b));
+	memset(&missing, 0, sizeof(missing));
+
+	check(manager->GetStats("a", &a) && a.hits == 2 && a.loads == 2 && a.evictions == 1 && a.memoryUsage == 100, "stats", "the counts of a");
+	check(manager->GetStats("b", &b) && b.hits == 0 && b.loads == 1 && b.evictions == 1 && b.memoryUsage == 0, "stats", "the counts of b");
+	check(manager->GetStats("missing", &missing) && missing.loads == 0 && missing.failures == 1, "stats", "the failed load is counted");
+	check(manager->GetMemoryUsage() == 100, "stats", "a failed load doesn't hold memory");
+
+	const modelStats total = manager->GetStats();
+
+	check(total.hits == 2 && total.loads == 3 && total.evictions == 2 && total.failures == 1 && total.memoryUsage == 100, "stats", "the totals of the models");
+
+	delete manager;
+}
+
+
+int main( int argc, char** argv )
+{
+	for( int n=1; n < argc; n++ )
+	{
+		if( strcmp(argv[n], "--help") == 0 || strcmp(argv[n], "-h") == 0 )
+			return usage();
+		else if( strcmp(argv[n], "--verbose") == 0 )
+			verbose = true;
+		else
+			return usage();
+	}
+
+	testLRU();
+	testAcquired();
+	testConcurrent();
+	testStats();
+
+	printf("model-manager-test:  %i of %i checks passed\n", numChecks - numFailed, numChecks);
+	return numFailed;
+}
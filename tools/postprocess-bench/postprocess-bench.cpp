@@ -0,0 +1,619 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "detectionDecoder.h"
+#include "hostPostProcess.h"
+#include "halfConvert.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+
+/*
+ * Microbenchmark of the host-side post-processing that runs on every frame,
+ * against synthetic tensors the size of the shipped models' outputs.  It only
+ * builds the sources that don't depend on CUDA or TensorRT, so that it can
+ * run on any machine (i.e. CI) to track regressions in these paths.
+ *
+ * The inputs are generated from fixed seeds, so the runs are comparable.
+ */
+int usage()
+{
+	printf("usage: postprocess-bench [-h] [--filter=NAME] [--seconds=N] [--csv]\n\n");
+	printf("Benchmark the host-side post-processing of the networks on synthetic\n");
+	printf("tensors, and report the time per operation and the bytes processed per second.\n\n");
+	printf("optional arguments:\n");
+	printf("  --help             show this help message and exit\n");
+	printf("  --filter=NAME      only run the benchmarks whose name contains NAME\n");
+	printf("  --seconds=N        minimum time to run each benchmark for (default: 0.5)\n");
+	printf("  --csv              print the results as CSV\n\n");
+
+	return 0;
+}
+
+
+// deterministic generator, so that every run sees the same tensors
+static uint32_t randomState = 1;
+
+static inline void randomSeed( uint32_t seed )	{ randomState = seed ? seed : 1; }
+
+static inline uint32_t randomInt()
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static inline float randomFloat( float min, float max )
+{
+	return min + (max - min) * (randomInt() / 4294967296.0f);
+}
+
+
+// current time in nanoseconds
+static inline uint64_t timeNS()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+
+// keep the results alive, so the work isn't optimized away
+static volatile uint64_t resultSink = 0;
+
+
+/*
+ * A benchmark runs one operation of the post-processing, on inputs of a fixed size.
+ */
+class benchmark
+{
+public:
+	benchmark( const char* name, const char* shape ) : mName(name), mShape(shape), mBytes(0)	{ }
+	virtual ~benchmark()		{ }
+
+	virtual void Setup() = 0;		// generate the inputs (and set mBytes)
+	virtual uint64_t Run() = 0;		// one operation, returning a value that depends on the results
+
+	inline const char* GetName() const	{ return mName; }
+	inline const char* GetShape() const	{ return mShape; }
+	inline size_t GetBytes() const		{ return mBytes; }
+
+protected:
+	const char* mName;
+	const char* mShape;
+	size_t      mBytes;	// size of the inputs that one operation reads
+};
+
+
+// measure the time per operation (in nanoseconds), as the best of several rounds
+static double measure( benchmark* bench, double seconds )
+{
+	// warm up, and estimate the number of operations per round
+	uint64_t iterations = 1;
+
+	while( true )
+	{
+		const uint64_t begin = timeNS();
+
+		for( uint64_t n=0; n < iterations; n++ )
+			resultSink += bench->Run();
+
+		const uint64_t elapsed = timeNS() - begin;
+
+		if( elapsed > 10000000 || iterations >= (1ULL << 30) )	// 10ms
+		{
+			iterations = (uint64_t)(iterations * (seconds * 0.2e9 / elapsed)) + 1;
+			break;
+		}
+
+		iterations *= 2;
+	}
+
+	// keep the fastest of the rounds
+	double best = 0.0;
+
+	for( int round=0; round < 5; round++ )
+	{
+		const uint64_t begin = timeNS();
+
+		for( uint64_t n=0; n < iterations; n++ )
+			resultSink += bench->Run();
+
+		const double ns = double(timeNS() - begin) / double(iterations);
+
+		if( round == 0 || ns < best )
+			best = ns;
+	}
+
+	return best;
+}
+
+
+//-----------------------------------------------------------------------------
+// detectNet clustering of the multiped-500 coverage grid (1024x512 input, 64x32 grid, 2 classes)
+class detectNetBench : public benchmark
+{
+public:
+	detectNetBench( const char* name, float density ) : benchmark(name, "cvg 2x32x64, bbox 4x32x64"), mDensity(density), mDecoder(NULL)	{ }
+	~detectNetBench()		{ delete mDecoder; }
+
+	virtual void Setup()
+	{
+		const uint32_t classes = 2, width = 64, height = 32, cell = 16;
+
+		mCoverage.resize(classes * width * height);
+		mBoxes.resize(4 * width * height);
+
+		randomSeed(500);
+
+		// objects are blobs of cells above the threshold, whose boxes all cover the object
+		for( size_t n=0; n < mCoverage.size(); n++ )
+			mCoverage[n] = randomFloat(0.0f, 0.3f);
+
+		const uint32_t numObjects = mDensity * width * height / 6;
+
+		for( uint32_t n=0; n < numObjects; n++ )
+		{
+			const uint32_t c = randomInt() % classes;
+			const uint32_t x = randomInt() % (width - 2);
+			const uint32_t y = randomInt() % (height - 3);
+
+			const float w = randomFloat(24.0f, 48.0f);
+			const float h = randomFloat(48.0f, 96.0f);
+
+			for( uint32_t j=y; j < y + 3; j++ )
+			{
+				for( uint32_t i=x; i < x + 2; i++ )
+				{
+					const uint32_t k = j * width + i;
+
+					mCoverage[c * width * height + k] = randomFloat(0.6f, 1.0f);
+
+					mBoxes[0 * width * height + k] = (x - i) * float(cell) + randomFloat(-2.0f, 2.0f);
+					mBoxes[1 * width * height + k] = (y - j) * float(cell) + randomFloat(-2.0f, 2.0f);
+					mBoxes[2 * width * height + k] = (x - i) * float(cell) + w + randomFloat(-2.0f, 2.0f);
+					mBoxes[3 * width * height + k] = (y - j) * float(cell) + h + randomFloat(-2.0f, 2.0f);
+				}
+			}
+		}
+
+		detectionTensor cvg  = { mCoverage.data(), { classes, height, width } };
+		detectionTensor bbox = { mBoxes.data(), { 4, height, width } };
+
+		mOutputs.push_back(cvg);
+		mOutputs.push_back(bbox);
+
+		mDecoder = detectionDecoder::Create("detectnet");
+		mDecoder->Configure(mOutputs, 1024, 512);
+
+		mDetections.resize(mDecoder->GetMaxDetections());
+		mBytes = (mCoverage.size() + mBoxes.size()) * sizeof(float);
+	}
+
+	virtual uint64_t Run()
+	{
+		return mDecoder->Decode(mOutputs, 1920, 1080, 0.5f, mDetections.data());
+	}
+
+protected:
+	float mDensity;
+
+	std::vector<float> mCoverage;
+	std::vector<float> mBoxes;
+	std::vector<detectionTensor> mOutputs;
+	std::vector<detectionResult> mDetections;
+
+	detectionDecoder* mDecoder;
+};
+
+
+//-----------------------------------------------------------------------------
+// parsing of the UFF SSD output (ssd-mobilenet-v2, 100 rows of 7 values)
+class ssdBench : public benchmark
+{
+public:
+	ssdBench() : benchmark("ssd-parse", "100x7, count"), mDecoder(NULL), mCount(100)		{ }
+	~ssdBench()	{ delete mDecoder; }
+
+	virtual void Setup()
+	{
+		const uint32_t rows = 100;
+
+		mRows.resize(rows * 7);
+		randomSeed(7);
+
+		// the rows are sorted by confidence, with a few above the threshold
+		for( uint32_t n=0; n < rows; n++ )
+		{
+			float* row = mRows.data() + n * 7;
+
+			const float x = randomFloat(0.0f, 0.8f);
+			const float y = randomFloat(0.0f, 0.8f);
+
+			row[0] = 0.0f;
+			row[1] = 1 + randomInt() % 90;
+			row[2] = 1.0f - float(n) / float(rows) * 1.5f;
+			row[3] = x;
+			row[4] = y;
+			row[5] = x + randomFloat(0.05f, 0.2f);
+			row[6] = y + randomFloat(0.05f, 0.2f);
+		}
+
+		detectionTensor output = { mRows.data(), { 1, rows, 7 } };
+		detectionTensor count  = { (const float*)&mCount, { 1, 1, 1 } };
+
+		mOutputs.push_back(output);
+		mOutputs.push_back(count);
+
+		mDecoder = detectionDecoder::Create("ssd");
+		mDecoder->Configure(mOutputs, 300, 300);
+
+		mDetections.resize(mDecoder->GetMaxDetections());
+		mBytes = mRows.size() * sizeof(float);
+	}
+
+	virtual uint64_t Run()
+	{
+		return mDecoder->Decode(mOutputs, 1920, 1080, 0.5f, mDetections.data());
+	}
+
+protected:
+	std::vector<float> mRows;
+	std::vector<detectionTensor> mOutputs;
+	std::vector<detectionResult> mDetections;
+
+	detectionDecoder* mDecoder;
+	int mCount;
+};
+
+
+//-----------------------------------------------------------------------------
+// segNet argmax classification of the Cityscapes-HD scores (21 classes over a 64x32 grid)
+class classifyGridBench : public benchmark
+{
+public:
+	classifyGridBench() : benchmark("segnet-classify", "21x32x64") 	{ }
+
+	virtual void Setup()
+	{
+		mScores.resize(21 * 32 * 64);
+		mClassMap.resize(32 * 64);
+
+		randomSeed(21);
+
+		for( size_t n=0; n < mScores.size(); n++ )
+			mScores[n] = randomFloat(-10.0f, 10.0f);
+
+		mBytes = mScores.size() * sizeof(float);
+	}
+
+	virtual uint64_t Run()
+	{
+		classifyGrid(mScores.data(), 64, 32, 21, 0, mClassMap.data());
+		return mClassMap[randomInt() % mClassMap.size()];
+	}
+
+protected:
+	std::vector<float>   mScores;
+	std::vector<uint8_t> mClassMap;
+};
+
+
+//-----------------------------------------------------------------------------
+// segNet binary mask of the Cityscapes-HD grid, at the input resolution (2048x1024)
+class classMapBench : public benchmark
+{
+public:
+	classMapBench() : benchmark("segnet-mask", "32x64 -> 1024x2048")	{ }
+
+	virtual void Setup()
+	{
+		mClassMap.resize(32 * 64);
+		mMask.resize(1024 * 2048);
+
+		randomSeed(64);
+
+		for( size_t n=0; n < mClassMap.size(); n++ )
+			mClassMap[n] = randomInt() % 21;
+
+		mBytes = mMask.size();		// dominated by the output
+	}
+
+	virtual uint64_t Run()
+	{
+		resizeClassMap(mClassMap.data(), 64, 32, mMask.data(), 2048, 1024);
+		return mMask[randomInt() % mMask.size()];
+	}
+
+protected:
+	std::vector<uint8_t> mClassMap;
+	std::vector<uint8_t> mMask;
+};
+
+
+//-----------------------------------------------------------------------------
+// imageNet scan for the top class of the 1000 ImageNet classes
+class classifyScoresBench : public benchmark
+{
+public:
+	classifyScoresBench() : benchmark("imagenet-classify", "1000") 	{ }
+
+	virtual void Setup()
+	{
+		mScores.resize(1000);
+		randomSeed(1000);
+
+		for( size_t n=0; n < mScores.size(); n++ )
+			mScores[n] = randomFloat(0.0f, 0.001f);
+
+		mScores[randomInt() % mScores.size()] = 0.9f;
+		mBytes = mScores.size() * sizeof(float);
+	}
+
+	virtual uint64_t Run()
+	{
+		float confidence = 0.0f;
+		return classifyScores(mScores.data(), mScores.size(), &confidence);
+	}
+
+protected:
+	std::vector<float> mScores;
+};
+
+
+//-----------------------------------------------------------------------------
+// reading the class labels of the 1000 ImageNet classes (i.e. ilsvrc12_synset_words.txt)
+class classInfoBench : public benchmark
+{
+public:
+	classInfoBench() : benchmark("class-labels", "1000 lines")	{ }
+
+	virtual void Setup()
+	{
+		randomSeed(12);
+
+		char line[128];
+
+		for( uint32_t n=0; n < 1000; n++ )
+		{
+			sprintf(line, "n%08u label%u, alternate label %u\n", randomInt() % 100000000, n, randomInt() % 1000);
+			mText += line;
+		}
+
+		mBytes = mText.size();
+	}
+
+	virtual uint64_t Run()
+	{
+		FILE* file = fmemopen((void*)mText.data(), mText.size(), "r");
+
+		if( !file )
+			return 0;
+
+		std::vector<std::string> descriptions;
+		std::vector<std::string> synsets;
+		uint32_t customClasses = 0;
+
+		const uint32_t numClasses = readClassInfo(file, descriptions, synsets, &customClasses);
+
+		fclose(file);
+		return numClasses;
+	}
+
+protected:
+	std::string mText;
+};
+
+
+//-----------------------------------------------------------------------------
+// merging overlapping boxes with detectionResult::Expand(), as the clustering does
+class expandBench : public benchmark
+{
+public:
+	expandBench() : benchmark("detection-expand", "64 x 64 boxes")	{ }
+
+	virtual void Setup()
+	{
+		mBoxes.resize(64);
+		randomSeed(64);
+
+		for( size_t n=0; n < mBoxes.size(); n++ )
+		{
+			mBoxes[n].Left   = randomFloat(0.0f, 1800.0f);
+			mBoxes[n].Top    = randomFloat(0.0f, 960.0f);
+			mBoxes[n].Right  = mBoxes[n].Left + randomFloat(20.0f, 120.0f);
+			mBoxes[n].Bottom = mBoxes[n].Top + randomFloat(40.0f, 120.0f);
+		}
+
+		mBytes = mBoxes.size() * mBoxes.size() * sizeof(detectionResult);
+	}
+
+	virtual uint64_t Run()
+	{
+		uint64_t merged = 0;
+
+		for( size_t i=0; i < mBoxes.size(); i++ )
+		{
+			detectionResult det = mBoxes[i];
+
+			for( size_t j=0; j < mBoxes.size(); j++ )
+				merged += det.Expand(mBoxes[j]);
+		}
+
+		return merged;
+	}
+
+protected:
+	std::vector<detectionResult> mBoxes;
+};
+
+
+//-----------------------------------------------------------------------------
+// conversion of FP16 outputs to float (the Cityscapes-HD scores)
+class halfBench : public benchmark
+{
+public:
+	halfBench() : benchmark("fp16-outputs", "21x32x64")	{ }
+
+	virtual void Setup()
+	{
+		mHalf.resize(21 * 32 * 64);
+		mFloat.resize(mHalf.size());
+
+		randomSeed(16);
+
+		for( size_t n=0; n < mHalf.size(); n++ )
+			mHalf[n] = floatToHalf(randomFloat(-10.0f, 10.0f));
+
+		mBytes = mHalf.size() * sizeof(uint16_t);
+	}
+
+	virtual uint64_t Run()
+	{
+		halfToFloat(mHalf.data(), mFloat.data(), mHalf.size());
+		return mFloat[randomInt() % mFloat.size()] > 0.0f;
+	}
+
+protected:
+	std::vector<uint16_t> mHalf;
+	std::vector<float>    mFloat;
+};
+
+
+#ifdef HAS_OPENCV
+//-----------------------------------------------------------------------------
+// homographyNet's estimation of the homography from the corner displacements
+class homographyBench : public benchmark
+{
+public:
+	homographyBench() : benchmark("homography", "8 displacements")	{ }
+
+	virtual void Setup()
+	{
+		randomSeed(8);
+
+		for( uint32_t n=0; n < 8; n++ )
+			mDisplacement[n] = randomFloat(-16.0f, 16.0f);
+
+		mBytes = sizeof(mDisplacement);
+	}
+
+	virtual uint64_t Run()
+	{
+		float H[3][3];
+		float H_inv[3][3];
+
+		return computeHomography(mDisplacement, 128.0f, 128.0f, H, H_inv);
+	}
+
+protected:
+	float mDisplacement[8];
+};
+#endif
+
+
+// main entry point
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	const char* filter  = NULL;
+	double      seconds = 0.5;
+	bool        csv     = false;
+
+	for( int n=1; n < argc; n++ )
+	{
+		if( strcmp(argv[n], "--help") == 0 || strcmp(argv[n], "-h") == 0 )
+			return usage();
+		else if( strncmp(argv[n], "--filter=", 9) == 0 )
+			filter = argv[n] + 9;
+		else if( strncmp(argv[n], "--seconds=", 10) == 0 )
+			seconds = atof(argv[n] + 10);
+		else if( strcmp(argv[n], "--csv") == 0 )
+			csv = true;
+		else
+			return usage();
+	}
+
+	if( seconds <= 0.0 )
+		return usage();
+
+
+	/*
+	 * run the benchmarks
+	 */
+	std::vector<benchmark*> benchmarks;
+
+	benchmarks.push_back(new detectNetBench("detectnet-cluster", 0.02f));
+	benchmarks.push_back(new detectNetBench("detectnet-cluster-crowded", 0.25f));
+	benchmarks.push_back(new ssdBench());
+	benchmarks.push_back(new classifyGridBench());
+	benchmarks.push_back(new classMapBench());
+	benchmarks.push_back(new classifyScoresBench());
+	benchmarks.push_back(new classInfoBench());
+	benchmarks.push_back(new expandBench());
+	benchmarks.push_back(new halfBench());
+#ifdef HAS_OPENCV
+	benchmarks.push_back(new homographyBench());
+#endif
+
+	if( csv )
+		printf("name,shape,ns_per_op,bytes_per_op,bytes_per_sec\n");
+	else
+		printf("\n%-28s %-22s %14s %14s\n", "benchmark", "shape", "ns/op", "MB/s");
+
+	for( size_t n=0; n < benchmarks.size(); n++ )
+	{
+		benchmark* bench = benchmarks[n];
+
+		if( filter != NULL && strstr(bench->GetName(), filter) == NULL )
+			continue;
+
+		bench->Setup();
+
+		const double ns   = measure(bench, seconds);
+		const double rate = bench->GetBytes() / (ns * 1e-9);
+
+		if( csv )
+			printf("%s,%s,%.1f,%zu,%.0f\n", bench->GetName(), bench->GetShape(), ns, bench->GetBytes(), rate);
+		else
+			printf("%-28s %-22s %14.1f %14.1f\n", bench->GetName(), bench->GetShape(), ns, rate / (1024.0 * 1024.0));
+	}
+
+	if( !csv )
+		printf("\n");
+
+	for( size_t n=0; n < benchmarks.size(); n++ )
+		delete benchmarks[n];
+
+	return 0;
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "detectNet.h"
+#include "segNet.h"
+#include "tensorRecord.h"
+#include "profilerHistogram.h"
+
+#include "commandLine.h"
+#include "timespec.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+
+int usage()
+{
+	printf("usage: tensor-replay [-h] [--segnet] [--repeat=N] [--ignore_class=NAME]\n");
+	printf("                     [--csv=FILE] [--top=N] [network options] RECORDING\n\n");
+	printf("Replay the output tensors recorded with --record through the post-processing\n");
+	printf("of detectNet (or segNet), without running the network, and report the latency\n");
+	printf("of the post-processing for each frame.\n\n");
+	printf("positional arguments:\n");
+	printf("  RECORDING          recording made with --record (or tensorNet::EnableRecording())\n\n");
+	printf("optional arguments:\n");
+	printf("  --help             show this help message and exit\n");
+	printf("  --segnet           replay through segNet::Classify() instead of detectNet\n");
+	printf("  --repeat=N         number of times to post-process each frame (default: 1)\n");
+	printf("  --ignore_class=NAME class that segNet ignores (default: void)\n");
+	printf("  --csv=FILE         write the latency of each frame to a CSV file\n");
+	printf("  --top=N            number of slowest frames to report (default: 5)\n\n");
+	printf("The network is loaded with the same options as detectnet-console or\n");
+	printf("segnet-console (i.e. --network, --model, --decoder), and must be the\n");
+	printf("same model that the outputs were recorded from.\n\n");
+	printf("%s\n", detectNet::Usage());
+
+	return 0;
+}
+
+
+// post-processing latency of one entry of a recorded frame
+struct replaySample
+{
+	uint32_t frame;
+	uint32_t batchIndex;
+	int      results;	// number of detections (or -1 on error)
+	float    ms;		// fastest of the repeats
+};
+
+
+// main entry point
+int main( int argc, char** argv )
+{
+	/*
+	 * parse command line
+	 */
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	const char* path = cmdLine.GetPosition(0);
+
+	if( !path )
+		return usage();
+
+	if( cmdLine.GetString("record") != NULL )
+	{
+		printf("tensor-replay:  --record can't be used while replaying a recording\n");
+		return 0;
+	}
+
+	const bool     segmentation = cmdLine.GetFlag("segnet");
+	const char*    ignoreClass  = cmdLine.GetString("ignore_class", "void");
+	const char*    csvPath      = cmdLine.GetString("csv");
+	const uint32_t repeat       = std::max(cmdLine.GetInt("repeat", 1), 1);
+	const uint32_t top          = cmdLine.GetInt("top", 5);
+
+
+	/*
+	 * open the recording
+	 */
+	tensorRecording* recording = tensorRecording::Open(path);
+
+	if( !recording )
+		return 0;
+
+	const uint32_t numFrames = recording->GetNumFrames();
+
+	if( numFrames == 0 )
+	{
+		printf("tensor-replay:  '%s' doesn't contain any complete frames\n", path);
+		return 0;
+	}
+
+
+	/*
+	 * load the network
+	 */
+	tensorNet* net = NULL;
+	detectNet* detector = NULL;
+	segNet*    segmenter = NULL;
+
+	if( segmentation )
+		net = segmenter = segNet::Create(argc, argv);
+	else
+		net = detector = detectNet::Create(argc, argv);
+
+	if( !net )
+	{
+		printf("tensor-replay:  failed to load the network\n");
+		return 0;
+	}
+
+
+	/*
+	 * replay the frames
+	 */
+	printf("\ntensor-replay:  replaying %u frames from '%s' through %s, %u times each\n\n",
+		  numFrames, path, segmentation ? "segNet::Classify()" : "detectNet::PostProcess()", repeat);
+
+	profilerHistogram latency;
+	std::vector<replaySample> samples;
+
+	uint64_t failures = 0;
+
+	for( uint32_t f=0; f < numFrames; f++ )
+	{
+		tensorFrame frame;
+
+		if( !recording->GetFrame(f, &frame) || !net->ReplayOutputs(frame) )
+		{
+			printf("tensor-replay:  failed to replay frame %u\n", f);
+			failures++;
+			continue;
+		}
+
+		for( uint32_t b=0; b < frame.batchSize; b++ )
+		{
+			replaySample sample;
+
+			sample.frame      = f;
+			sample.batchIndex = b;
+			sample.results    = 0;
+			sample.ms         = 0.0f;
+
+			for( uint32_t r=0; r < repeat; r++ )
+			{
+				const timespec begin = timestamp();
+
+				if( segmenter != NULL )
+				{
+					sample.results = segmenter->Classify(ignoreClass, b) ? 0 : -1;
+				}
+				else
+				{
+					detectNet::Detection* detections = NULL;
+					sample.results = detector->PostProcess(frame.inputWidth, frame.inputHeight, &detections, b);
+				}
+
+				const float ms = timeFloat(timeDiff(begin, timestamp()));
+
+				if( r == 0 || ms < sample.ms )
+					sample.ms = ms;
+			}
+
+			if( sample.results < 0 )
+				failures++;
+
+			latency.Add(sample.ms);
+			samples.push_back(sample);
+		}
+	}
+
+
+	/*
+	 * write the latency of each frame
+	 */
+	if( csvPath != NULL )
+	{
+		FILE* csv = fopen(csvPath, "w");
+
+		if( csv != NULL )
+		{
+			fprintf(csv, "frame,batch_index,results,ms\n");
+
+			for( size_t n=0; n < samples.size(); n++ )
+				fprintf(csv, "%u,%u,%i,%.4f\n", samples[n].frame, samples[n].batchIndex, samples[n].results, samples[n].ms);
+
+			fclose(csv);
+		}
+		else
+		{
+			printf("tensor-replay:  failed to open '%s' for writing\n", csvPath);
+		}
+	}
+
+
+	/*
+	 * print the report
+	 */
+	printf("\ntensor-replay:  post-processed %lu entries from %u frames (%lu failed)\n",
+		  (unsigned long)latency.GetCount(), numFrames, (unsigned long)failures);
+	printf("   -- latency     mean %.3f ms, p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+		  latency.GetMean(), latency.GetPercentile(0.5f), latency.GetPercentile(0.9f),
+		  latency.GetPercentile(0.99f), latency.GetMax());
+
+	std::sort(samples.begin(), samples.end(), [](const replaySample& a, const replaySample& b) { return a.ms > b.ms; });
+
+	for( size_t n=0; n < samples.size() && n < top; n++ )
+	{
+		printf("   -- slowest     frame %u (batch index %u)  %.3f ms", samples[n].frame, samples[n].batchIndex, samples[n].ms);
+
+		if( detector != NULL )
+			printf("  %i detections", samples[n].results);
+
+		printf("\n");
+	}
+
+	printf("\n");
+
+	delete net;
+	delete recording;
+
+	return 0;
+}
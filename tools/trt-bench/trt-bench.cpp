@@ -27,6 +27,7 @@
 #include "commandLine.h"
 #include "timespec.h"
 #include "Thread.h"
+#include "threadConfig.h"
 
 #include <signal.h>
 #include <unistd.h>
@@ -61,6 +62,10 @@ void* process( void* param )
 	deviceType dev = net->GetDevice();
 	const char* str = deviceTypeToStr(dev);
 
+	char threadName[16];
+	snprintf(threadName, sizeof(threadName), "trt-%s", str);
+	threadConfig::ApplyStage("inference", threadName);
+
 	printf("%s thread started\n", str);
 
 	while( !signal_recieved )
@@ -81,6 +86,7 @@ void* process( void* param )
 int main( int argc, char** argv )
 {
 	printf("\ntrt-bench usage: --image=<path> [--GPU=FP16|INT8] [--DLA_0=FP16] [--DLA_1=FP16] [--allowGPUFallback]\n");
+	printf("                 [--threads=<file>] [--thread-inference=\"cores=1 policy=fifo priority=50\"]\n");
 
 
 	/*
@@ -102,6 +108,13 @@ int main( int argc, char** argv )
 	 */
 	commandLine cmdLine(argc, argv);
 
+	// configure the thread affinity and scheduling of the network threads
+	if( !threadConfig::ParseArgs(argc, argv) )
+	{
+		printf("invalid thread configuration\n");
+		return 0;
+	}
+
 	// get the input image filename
 	const char* imgPath = cmdLine.GetString("image");
 
@@ -258,6 +271,7 @@ int main( int argc, char** argv )
 	 */
 	printf("\nwaiting for threads to stop...\n");
 	sleep(1);
+	threadConfig::Report();
 	printf("shutting down...\n");
 
 
@@ -20,14 +20,92 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include "imageNet.h"
+#include "commandLine.h"
+
 #include <stdio.h>
 
 
+int usage()
+{
+	printf("usage: trt-console [-h] [--network NETWORK] [--device DEVICE]\n");
+	printf("                   [--precision PRECISION] [--allowGPUFallback]\n");
+	printf("                   [--iterations N] [--print-layers]\n\n");
+	printf("Load a network and report which of its layers run on the DLA and which fall\n");
+	printf("back to the GPU, the DLA/GPU transitions, and the per-layer timings.\n\n");
+	printf("optional arguments:\n");
+	printf("  --help                show this help message and exit\n");
+	printf("  --network NETWORK     pre-trained imageNet model to load (default is googlenet),\n");
+	printf("                        or a custom caffemodel with --prototxt, --labels,\n");
+	printf("                        --input_blob and --output_blob\n");
+	printf("  --device DEVICE       device to build the engine for:  GPU, DLA_0 or DLA_1\n");
+	printf("                        (default is DLA_0)\n");
+	printf("  --precision TYPE      precision of the engine (default is fastest)\n");
+	printf("  --allowGPUFallback    run the layers that the DLA doesn't support on the GPU\n");
+	printf("  --iterations N        number of runs to average the layer timings over (default is 10)\n");
+	printf("  --print-layers        print the time of each layer as it's run\n\n");
+
+	return 0;
+}
+
 
 // main entry point
 int main( int argc, char** argv )
 {
-	return 0;
-}
+	commandLine cmdLine(argc, argv);
+
+	if( cmdLine.GetFlag("help") )
+		return usage();
+
+	const deviceType device = deviceTypeFromStr(cmdLine.GetString("device", "DLA_0"));
+	const precisionType precision = precisionTypeFromStr(cmdLine.GetString("precision", "fastest"));
+	const bool allowGPUFallback = cmdLine.GetFlag("allowGPUFallback");
+	const int iterations = cmdLine.GetInt("iterations", 10);
 
 
+	/*
+	 * load the network
+	 */
+	const char* modelName = cmdLine.GetString("network", cmdLine.GetString("model", "googlenet"));
+	const imageNet::NetworkType type = imageNet::NetworkTypeFromStr(modelName);
+
+	imageNet* net = NULL;
+
+	if( type == imageNet::CUSTOM )
+	{
+		net = imageNet::Create(cmdLine.GetString("prototxt"), modelName, NULL, cmdLine.GetString("labels"),
+						   cmdLine.GetString("input_blob", IMAGENET_DEFAULT_INPUT),
+						   cmdLine.GetString("output_blob", IMAGENET_DEFAULT_OUTPUT),
+						   1, precision, device, allowGPUFallback);
+	}
+	else
+	{
+		net = imageNet::Create(type, 1, precision, device, allowGPUFallback);
+	}
+
+	if( !net )
+	{
+		printf("trt-console:  failed to load %s on device %s\n", modelName, deviceTypeToStr(device));
+		return 0;
+	}
+
+
+	/*
+	 * measure the layer timings (the input is whatever is in the network's buffer)
+	 */
+	net->EnableLayerProfiler(cmdLine.GetFlag("print-layers"));
+
+	for( int n=0; n < iterations; n++ )
+	{
+		if( !net->ProcessBindings(1) )
+		{
+			printf("trt-console:  failed to run the network\n");
+			break;
+		}
+	}
+
+	net->PrintLayerPlacement();
+
+	delete net;
+	return 0;
+}